@@ -11,6 +11,43 @@ class App : public Application {
 public:
     App() : Application() {}
 
+    /**
+     * @brief Starts the import of a scene asset, the scene is built with its placeholder meanwhile.
+     *
+     * With --sync-loading each import is waited for before the next one is requested, the
+     * startup baseline of --benchmark-startup.
+     */
+    template<typename T>
+    ResourceHandle<T> request(const std::string& alias, ResourceInfo* resourceInfo = nullptr) {
+        auto& rm = getResourceManager();
+
+        ResourceHandle<T> handle = rm.getAsync<T>(alias, resourceInfo);
+        if (getLaunchOptions().syncLoading) {
+            rm.wait(handle);
+        }
+        return handle;
+    }
+
+    /**
+     * @brief Starts the import of a tangent space normal map, cooked with its x and y only.
+     */
+    ResourceHandle<Image> requestNormalMap(const std::string& alias) {
+        ImageInfo normalInfo{};
+        normalInfo.format = RGBA8_LINEAR;
+        normalInfo.usage = NORMAL_MAP;
+
+        return request<Image>(alias, &normalInfo);
+    }
+
+    /**
+     * @brief Gives the mesh to the entity once it is loaded, the entity is not drawn until then.
+     */
+    static void addMesh(Entity entity, const ResourceHandle<Mesh>& mesh) {
+        mesh.onReady([entity](const Shared<Mesh>& loadedMesh) mutable {
+            entity.add<MeshComponent>(loadedMesh);
+        });
+    }
+
     void prepareEnvironment() {
         std::array<std::string, 6> skyboxTextures;
         skyboxTextures[CubeFace::BACK] = TEXTURES_PATH + "skybox/bluecloud_bk.jpg";
@@ -51,43 +88,43 @@ public:
         ImageInfo albedoInfo{};
         albedoInfo.format = RGBA8_SRGB;
 
-        auto quad = rm.get<Mesh>(MODELS_PATH + "quad.obj");
+        auto quad = request<Mesh>(MODELS_PATH + "quad.obj");
 		auto stylizedStoneMaterial = Material::Builder()
-			.setAlbedoMap(rm.get<Image>(TEXTURES_PATH + "laminated_wood/albedo.png", &albedoInfo))
-			.setNormalMap(rm.get<Image>(TEXTURES_PATH + "laminated_wood/normal.png"))
-            .setMetallicMap(rm.get<Image>(TEXTURES_PATH + "laminated_wood/metallic.png"))
-			.setRoughnessMap(rm.get<Image>(TEXTURES_PATH + "laminated_wood/roughness.png"))
-			.setAmbientOcclusionMap(rm.get<Image>(TEXTURES_PATH + "laminated_wood/ao.png"))
+			.setAlbedoMap(request<Image>(TEXTURES_PATH + "laminated_wood/albedo.png", &albedoInfo))
+			.setNormalMap(requestNormalMap(TEXTURES_PATH + "laminated_wood/normal.png"))
+            .setMetallicMap(request<Image>(TEXTURES_PATH + "laminated_wood/metallic.png"))
+			.setRoughnessMap(request<Image>(TEXTURES_PATH + "laminated_wood/roughness.png"))
+			.setAmbientOcclusionMap(request<Image>(TEXTURES_PATH + "laminated_wood/ao.png"))
 			.build();
 		rm.add(stylizedStoneMaterial, "floor_material");
 
         Entity entity = getScene().createEntity("Floor")
             .add<TransformComponent>(glm::vec3{0.f, 1.0f, 0.f}, glm::vec3{1.f, 1.f, 1.f}, glm::vec3{0.0f, 0.0f, 0.0f})
-            .add<MeshComponent>(quad)
 			.add<MaterialComponent>(MaterialComponent::Builder()
 				.setMaterial(stylizedStoneMaterial)
                 .setTilingFactor(2.0f)
 				.build());
+        addMesh(entity, quad);
 
         entity = getScene().createEntity("Left Wall")
-            .add<TransformComponent>(glm::vec3{ -1.f, 0.f, 0.f }, glm::vec3{ 1.f, 1.f, 1.f }, glm::vec3{ 0.0f, 0.0f, glm::pi<float>() / 2 })
-            .add<MeshComponent>(quad);
+            .add<TransformComponent>(glm::vec3{ -1.f, 0.f, 0.f }, glm::vec3{ 1.f, 1.f, 1.f }, glm::vec3{ 0.0f, 0.0f, glm::pi<float>() / 2 });
+        addMesh(entity, quad);
         entity.addAndGet<MaterialComponent>().tint = glm::vec3{ 1.0f, 0.f, 0.f };
 
         entity = getScene().createEntity("Right Wall")
-            .add<TransformComponent>(glm::vec3{ 1.f, 0.f, 0.f }, glm::vec3{ 1.f, 1.f, 1.f }, glm::vec3{ 0.0f, 0.0f, -glm::pi<float>() / 2 })
-            .add<MeshComponent>(quad);
+            .add<TransformComponent>(glm::vec3{ 1.f, 0.f, 0.f }, glm::vec3{ 1.f, 1.f, 1.f }, glm::vec3{ 0.0f, 0.0f, -glm::pi<float>() / 2 });
+        addMesh(entity, quad);
 		entity.addAndGet<MaterialComponent>().tint = glm::vec3{ 0.f, 1.0f, 0.f };
 
         entity = getScene().createEntity("Front Wall")
             .add<TransformComponent>(glm::vec3{ 0.f, 0.f, 1.f }, glm::vec3{ 1.f, 1.f, 1.f }, glm::vec3{ glm::pi<float>() / 2, 0.0f, 0.0f })
-            .add<MeshComponent>(quad)
             .add<MaterialComponent>();
+        addMesh(entity, quad);
 
         entity = getScene().createEntity("Roof")
             .add<TransformComponent>(glm::vec3{ 0.f, -1.f, 0.f }, glm::vec3{ 1.f, 1.f, 1.f }, glm::vec3{ glm::pi<float>(), 0.0f, 0.0f })
-            .add<MeshComponent>(quad)
             .add<MaterialComponent>();
+        addMesh(entity, quad);
     }
 
     void createTeapotAndVases(int count) {
@@ -98,67 +135,67 @@ public:
         std::uniform_real_distribution<float> rotDist(0.0f, glm::two_pi<float>());
 
         auto& rm = getResourceManager();
-        auto vaseMesh = rm.get<Mesh>(MODELS_PATH + "smooth_vase.obj");
-        auto teapotMesh = rm.get<Mesh>(MODELS_PATH + "utah_teapot.obj");
+        auto vaseMesh = request<Mesh>(MODELS_PATH + "smooth_vase.obj");
+        auto teapotMesh = request<Mesh>(MODELS_PATH + "utah_teapot.obj");
 
         ImageInfo albedoInfo{};
         albedoInfo.format = RGBA8_SRGB;
 
         auto metallicMaterial = Material::Builder()
-            .setRoughnessMap(rm.get<Image>(TEXTURES_PATH + "/gold/roughness.png"))
-            .setMetallicMap(rm.get<Image>(TEXTURES_PATH + "/gold/metallic.png"))
-            .setNormalMap(rm.get<Image>(TEXTURES_PATH + "/gold/normal.png"))
+            .setRoughnessMap(request<Image>(TEXTURES_PATH + "/gold/roughness.png"))
+            .setMetallicMap(request<Image>(TEXTURES_PATH + "/gold/metallic.png"))
+            .setNormalMap(requestNormalMap(TEXTURES_PATH + "/gold/normal.png"))
             .build();
         rm.add(metallicMaterial, "metallic_material");
 
         auto graniteMaterial = Material::Builder()
-            .setAlbedoMap(rm.get<Image>(TEXTURES_PATH + "granite/albedo.png", &albedoInfo))
-            .setRoughnessMap(rm.get<Image>(TEXTURES_PATH + "granite/roughness.png"))
-            .setMetallicMap(rm.get<Image>(TEXTURES_PATH + "granite/metallic.png"))
-            .setNormalMap(rm.get<Image>(TEXTURES_PATH + "granite/normal.png"))
-            .setAmbientOcclusionMap(rm.get<Image>(TEXTURES_PATH + "granite/ao.png"))
+            .setAlbedoMap(request<Image>(TEXTURES_PATH + "granite/albedo.png", &albedoInfo))
+            .setRoughnessMap(request<Image>(TEXTURES_PATH + "granite/roughness.png"))
+            .setMetallicMap(request<Image>(TEXTURES_PATH + "granite/metallic.png"))
+            .setNormalMap(requestNormalMap(TEXTURES_PATH + "granite/normal.png"))
+            .setAmbientOcclusionMap(request<Image>(TEXTURES_PATH + "granite/ao.png"))
             .build();
         rm.add(graniteMaterial, "brown_granite");
 
         Entity entity = getScene().createEntity("vase")
-            .add<TransformComponent>(glm::vec3{ -0.75f, 1.0f, 0.1f }, glm::vec3{ 1.0f, 1.0f, 1.0f }, glm::vec3{0.0f, glm::pi<float>()/4, 0.0f})
-            .add<MeshComponent>(vaseMesh);
+            .add<TransformComponent>(glm::vec3{ -0.75f, 1.0f, 0.1f }, glm::vec3{ 1.0f, 1.0f, 1.0f }, glm::vec3{0.0f, glm::pi<float>()/4, 0.0f});
+        addMesh(entity, vaseMesh);
         entity.addAndGet<MaterialComponent>(MaterialComponent::Builder()
             .setMaterial(graniteMaterial).build());
 
         entity = getScene().createEntity("teapot")
-            .add<TransformComponent>(glm::vec3{ 0.5f, 1.0f, 0.7f }, glm::vec3{ 0.15f, 0.15f, 0.15f }, glm::vec3{ glm::pi<float>(), -glm::pi<float>()/1.6, 0.0f })
-            .add<MeshComponent>(teapotMesh);
+            .add<TransformComponent>(glm::vec3{ 0.5f, 1.0f, 0.7f }, glm::vec3{ 0.15f, 0.15f, 0.15f }, glm::vec3{ glm::pi<float>(), -glm::pi<float>()/1.6, 0.0f });
+        addMesh(entity, teapotMesh);
         entity.addAndGet<MaterialComponent>(MaterialComponent::Builder()
             .setMaterial(metallicMaterial).build()).tint = glm::vec3(0.737, 0.776, 0.8);
 
         entity = getScene().createEntity("vase")
-            .add<TransformComponent>(glm::vec3{ -0.65f, 1.0f, 0.4f }, glm::vec3{ 1.8f, 1.4f, 1.8f }, glm::vec3{ 0.0f, 0.0f, 0.0f })
-            .add<MeshComponent>(vaseMesh);
+            .add<TransformComponent>(glm::vec3{ -0.65f, 1.0f, 0.4f }, glm::vec3{ 1.8f, 1.4f, 1.8f }, glm::vec3{ 0.0f, 0.0f, 0.0f });
+        addMesh(entity, vaseMesh);
         entity.addAndGet<MaterialComponent>(MaterialComponent::Builder()
             .setMaterial(graniteMaterial).build()).tint = glm::vec3(0.13f, 0.24f, 0.35f);
 	}
 
     void createRubikCube() {
         auto& rm = getResourceManager();
-        auto rubikMesh = rm.get<Mesh>(MODELS_PATH + "rubik.obj");
+        auto rubikMesh = request<Mesh>(MODELS_PATH + "rubik.obj");
 
         ImageInfo albedoInfo{};
         albedoInfo.format = RGBA8_SRGB;
 
         auto rubikMaterial = Material::Builder()
-            .setAlbedoMap(rm.get<Image>(TEXTURES_PATH + "/rubik/albedo.jpg", &albedoInfo))
-            .setRoughnessMap(rm.get<Image>(TEXTURES_PATH + "/rubik/roughness.jpg"))
-            .setNormalMap(rm.get<Image>(TEXTURES_PATH + "/rubik/normal.jpg"))
-            .setAmbientOcclusionMap(rm.get<Image>(TEXTURES_PATH + "/rubik/ao.jpg"))
+            .setAlbedoMap(request<Image>(TEXTURES_PATH + "/rubik/albedo.jpg", &albedoInfo))
+            .setRoughnessMap(request<Image>(TEXTURES_PATH + "/rubik/roughness.jpg"))
+            .setNormalMap(requestNormalMap(TEXTURES_PATH + "/rubik/normal.jpg"))
+            .setAmbientOcclusionMap(request<Image>(TEXTURES_PATH + "/rubik/ao.jpg"))
             .build();
         rm.add(rubikMaterial, "rubik_material");
 
         Entity entity = getScene().createEntity("rubik")
             .add<TransformComponent>(glm::vec3{ -0.75f, 0.9f, -0.3f }, glm::vec3{ 0.1f, 0.1f, 0.1f }, glm::vec3{ 0.0f, -glm::pi<float>()/2.5, 0.0f})
-            .add<MeshComponent>(rubikMesh)
             .add<MaterialComponent>(MaterialComponent::Builder()
                 .setMaterial(rubikMaterial).build());
+        addMesh(entity, rubikMesh);
 
     }
 
@@ -169,22 +206,22 @@ public:
         albedoInfo.format = RGBA8_SRGB;
 
         auto lampMaterial = Material::Builder()
-            .setAlbedoMap(rm.get<Image>(TEXTURES_PATH + "/lamp/albedo.png", &albedoInfo))
-            .setRoughnessMap(rm.get<Image>(TEXTURES_PATH + "/lamp/roughness.png"))
-            .setMetallicMap(rm.get<Image>(TEXTURES_PATH + "/lamp/metallic.png"))
-            .setNormalMap(rm.get<Image>(TEXTURES_PATH + "/lamp/normal.png"))
-            .setEmissiveMap(rm.get<Image>(TEXTURES_PATH + "white_pixel.png"))//"/lamp/emissive.png"))
+            .setAlbedoMap(request<Image>(TEXTURES_PATH + "/lamp/albedo.png", &albedoInfo))
+            .setRoughnessMap(request<Image>(TEXTURES_PATH + "/lamp/roughness.png"))
+            .setMetallicMap(request<Image>(TEXTURES_PATH + "/lamp/metallic.png"))
+            .setNormalMap(requestNormalMap(TEXTURES_PATH + "/lamp/normal.png"))
+            .setEmissiveMap(request<Image>(TEXTURES_PATH + "white_pixel.png"))//"/lamp/emissive.png"))
             .setEmissiveColor(glm::vec4{ 1.0f, 1.0f, 1.0f, 6.0f })
             .build();
         rm.add(lampMaterial, "lamp_material");
 
-        auto lampMesh = rm.get<Mesh>(MODELS_PATH + "lamp.obj");
+        auto lampMesh = request<Mesh>(MODELS_PATH + "lamp.obj");
 
         Entity entity = getScene().createEntity("lamp")
             .add<TransformComponent>(glm::vec3{ 0.6f, 1.0f, 0.6f }, glm::vec3{ 2.4f, 2.8f, 2.4f }, glm::vec3{ glm::pi<float>(), glm::pi<float>() / 4, 0.0f })
-            .add<MeshComponent>(lampMesh)
             .add<MaterialComponent>(MaterialComponent::Builder()
                 .setMaterial(lampMaterial).build());
+        addMesh(entity, lampMesh);
     }
 
     void createRoofLight() {
@@ -194,18 +231,18 @@ public:
         albedoInfo.format = RGBA8_SRGB;
 
         auto roofLightMaterial = Material::Builder()
-            .setEmissiveMap(rm.get<Image>(TEXTURES_PATH + "white_pixel.png"))
+            .setEmissiveMap(request<Image>(TEXTURES_PATH + "white_pixel.png"))
             .setEmissiveColor(glm::vec4{ 1.0f, 1.0f, 1.0f, 12.0f})
             .build();
         rm.add(roofLightMaterial, "roof_light_material");
 
-        auto roofLightMesh = rm.get<Mesh>(MODELS_PATH + "cube.obj");
+        auto roofLightMesh = request<Mesh>(MODELS_PATH + "cube.obj");
 
         Entity entity = getScene().createEntity("lamp")
             .add<TransformComponent>(glm::vec3{ 0.0f, -0.995f, 0.0f }, glm::vec3{ 0.25f, 0.01f, 0.25f }, glm::vec3{ glm::pi<float>(), 0.0, 0.0})
-            .add<MeshComponent>(roofLightMesh)
             .add<MaterialComponent>(MaterialComponent::Builder()
                 .setMaterial(roofLightMaterial).build());
+        addMesh(entity, roofLightMesh);
     }
 
     void createPencilAndPen() {
@@ -215,26 +252,26 @@ public:
         albedoInfo.format = RGBA8_SRGB;
 
         auto pencilMaterial = Material::Builder()
-            .setAlbedoMap(rm.get<Image>(TEXTURES_PATH + "/pencil/albedo.png", &albedoInfo))
-            .setRoughnessMap(rm.get<Image>(TEXTURES_PATH + "/pencil/roughness.png"))
-			.setMetallicMap(rm.get<Image>(TEXTURES_PATH + "/pencil/metallic.png"))
-            .setNormalMap(rm.get<Image>(TEXTURES_PATH + "/pencil/normal.png"))
+            .setAlbedoMap(request<Image>(TEXTURES_PATH + "/pencil/albedo.png", &albedoInfo))
+            .setRoughnessMap(request<Image>(TEXTURES_PATH + "/pencil/roughness.png"))
+			.setMetallicMap(request<Image>(TEXTURES_PATH + "/pencil/metallic.png"))
+            .setNormalMap(requestNormalMap(TEXTURES_PATH + "/pencil/normal.png"))
             .build();
         rm.add(pencilMaterial, "pencil_material");
 
-        auto pencilMesh = rm.get<Mesh>(MODELS_PATH + "pencil.obj");
+        auto pencilMesh = request<Mesh>(MODELS_PATH + "pencil.obj");
 
         Entity entity = getScene().createEntity("pencil")
             .add<TransformComponent>(glm::vec3{ 0.65f, 0.985f, -0.1f }, glm::vec3{ 0.1f, 0.1f, 0.1f }, glm::vec3{ 0.0f, -glm::pi<float>() / 10, 0.0f })
-            .add<MeshComponent>(pencilMesh)
             .add<MaterialComponent>(MaterialComponent::Builder()
                 .setMaterial(pencilMaterial).build());
+        addMesh(entity, pencilMesh);
 
         entity = getScene().createEntity("pencil2")
             .add<TransformComponent>(glm::vec3{ 0.55f, 0.985f, 0.0f }, glm::vec3{ 0.1f, 0.1f, 0.1f }, glm::vec3{ 0.0f, -glm::pi<float>() / 12, 0.0f })
-            .add<MeshComponent>(pencilMesh)
             .add<MaterialComponent>(MaterialComponent::Builder()
                 .setMaterial(pencilMaterial).build());
+        addMesh(entity, pencilMesh);
         
     }
 
@@ -257,6 +294,40 @@ public:
 #endif
     }
 
+    /**
+     * @brief Fills the room with a grid of small props, to stress the draw paths of the raster renderers.
+     *
+     * The props cycle through a few meshes and tints in the order they are created, so the render
+     * list has to sort them back into one instanced draw per mesh while the per object path of the
+     * material renderer records one draw per prop.
+     */
+    void createStressGrid(const uint32_t count) {
+        const std::array meshes = {
+            request<Mesh>(MODELS_PATH + "cube.obj"),
+            request<Mesh>(MODELS_PATH + "smooth_vase.obj"),
+            request<Mesh>(MODELS_PATH + "pencil.obj")
+        };
+
+        const std::array tints = {
+            glm::vec3{ 0.9f, 0.3f, 0.3f }, glm::vec3{ 0.3f, 0.9f, 0.3f }, glm::vec3{ 0.3f, 0.3f, 0.9f }, glm::vec3{ 0.9f, 0.9f, 0.9f }
+        };
+
+        // a cube of props inside the room
+        const uint32_t side = static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<float>(count))));
+        const float spacing = 1.6f / static_cast<float>(side);
+        const float scale = spacing * 0.25f;
+
+        for (uint32_t i = 0; i < count; i++) {
+            const glm::vec3 cell = glm::vec3(i % side, (i / side) % side, i / (side * side));
+            const glm::vec3 translation = cell * spacing - glm::vec3{ 0.8f - spacing * 0.5f };
+
+            Entity entity = getScene().createEntity("stress_prop")
+                .add<TransformComponent>(translation, glm::vec3{ scale }, glm::vec3{ 0.0f });
+            addMesh(entity, meshes[i % meshes.size()]);
+            entity.addAndGet<MaterialComponent>().tint = tints[i % tints.size()];
+        }
+    }
+
     void loadScene() override {
 		prepareEnvironment();
         createCameraEntity();
@@ -268,35 +339,40 @@ public:
         createPencilAndPen();
         createLights();
 
+        // --stress-entities 10000-100000 compares the indirect and the per object draws of the material renderer
+        if (const uint32_t stressEntityCount = getLaunchOptions().stressEntityCount; stressEntityCount > 0) {
+            createStressGrid(stressEntityCount);
+        }
+
         auto& rm = getResourceManager();
 
         ImageInfo albedoInfo{};
         albedoInfo.format = RGBA8_SRGB;
 
-        auto bunny = rm.get<Mesh>(MODELS_PATH + "bunny/bunny.obj");
+        auto bunny = request<Mesh>(MODELS_PATH + "bunny/bunny.obj");
         /*auto bunnyMaterial = Material::Builder()
-            .setAlbedoMap(rm.get<Image>(MODELS_PATH + "bunny/terracotta.jpg", &albedoInfo))
-            //.setAlbedoMap(rm.get<Image>(TEXTURES_PATH + "granite/albedo.png", &albedoInfo))
-            .setRoughnessMap(rm.get<Image>(TEXTURES_PATH + "granite/roughness.png"))
-            .setMetallicMap(rm.get<Image>(TEXTURES_PATH + "granite/metallic.png"))
-            .setNormalMap(rm.get<Image>(TEXTURES_PATH + "granite/normal.png"))
-            .setAmbientOcclusionMap(rm.get<Image>(TEXTURES_PATH + "granite/ao.png"))
+            .setAlbedoMap(request<Image>(MODELS_PATH + "bunny/terracotta.jpg", &albedoInfo))
+            //.setAlbedoMap(request<Image>(TEXTURES_PATH + "granite/albedo.png", &albedoInfo))
+            .setRoughnessMap(request<Image>(TEXTURES_PATH + "granite/roughness.png"))
+            .setMetallicMap(request<Image>(TEXTURES_PATH + "granite/metallic.png"))
+            .setNormalMap(requestNormalMap(TEXTURES_PATH + "granite/normal.png"))
+            .setAmbientOcclusionMap(request<Image>(TEXTURES_PATH + "granite/ao.png"))
             .build();*/
         auto bunnyMaterial = Material::Builder()
-            .setRoughnessMap(rm.get<Image>(TEXTURES_PATH + "/gold/roughness.png"))
-            .setMetallicMap(rm.get<Image>(TEXTURES_PATH + "/gold/metallic.png"))
-            .setNormalMap(rm.get<Image>(TEXTURES_PATH + "/gold/normal.png"))
+            .setRoughnessMap(request<Image>(TEXTURES_PATH + "/gold/roughness.png"))
+            .setMetallicMap(request<Image>(TEXTURES_PATH + "/gold/metallic.png"))
+            .setNormalMap(requestNormalMap(TEXTURES_PATH + "/gold/normal.png"))
             .build();
 		rm.add(bunnyMaterial, "bunny_material");
 
         Entity entity = getScene().createEntity("Bunny")
             .add<TransformComponent>(glm::vec3{ 0.0f, 0.99f, 0.0f }, glm::vec3{ 2.5f, 2.5f, 2.5f }, glm::vec3{ glm::pi<float>(), 0.0f, 0.0f })
-            .add<MeshComponent>(bunny)
             .add<MaterialComponent>(MaterialComponent::Builder()
                 .setMaterial(bunnyMaterial)
                 .setTint(glm::vec3(1.0, 0.812, 0.408))
                 //.setTilingFactor(5.0f)
                 .build());
+        addMesh(entity, bunny);
     }
 
     
@@ -4,11 +4,14 @@
 #include "core/events/event_dispatcher.hpp"
 #include "core/events/window_event.hpp"
 #include "core/diagnostics.hpp"
+#include "core/jobs/job_system.hpp"
 #include "scene/ecs/component.hpp"
 #include "scene/ecs/entity.hpp"
 #include "scene/camera.hpp"
 #include "graphics/render_systems/master_render_system.hpp"
+#include "graphics/memory/geometry_arena.hpp"
 #include "graphics/resources/texture2d.hpp"
+#include "graphics/resources/sampler_tables.hpp"
 
 #include "tracy/Tracy.hpp"
 
@@ -18,9 +21,13 @@ namespace PXTEngine {
 
     Application::Application() {
         m_instance = this;
+
+        JobSystem::init();
     }
 
-    Application::~Application() {};
+    Application::~Application() {
+        JobSystem::shutdown();
+    }
 
     void Application::start() {
         PXT_PROFILE_FN();
@@ -33,6 +40,11 @@ namespace PXTEngine {
         }
         registerResources();
 
+        // the imports still running are registered when they end, the frames keep the placeholders until then
+        m_resourceManager.setResourceAddedCallback([this](const Shared<Resource>& resource) {
+            registerResource(resource);
+        });
+
         // create the pool manager, ubo buffers, and global descriptor sets
         createDescriptorPoolAllocator();
         createUboBuffers();
@@ -61,7 +73,8 @@ namespace PXTEngine {
 			m_materialRegistry,
 			m_blasRegistry,
             m_globalSetLayout,
-            m_scene.getEnvironment()
+            m_scene.getEnvironment(),
+            m_resourceManager.get<Image>(BLUE_NOISE_TEXTURE)
         );
 
         m_window.setEventCallback([this]<typename E>(E&& event) {
@@ -73,7 +86,7 @@ namespace PXTEngine {
 		// for now we have one ubo and a lot of textures
 		std::vector<PoolSizeRatio> ratios = {
 			{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f},
-			{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<float>(m_textureRegistry.getTextureCount())},
+			{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<float>(TextureRegistry::MAX_TEXTURE_COUNT)},
             {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f},
             {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f},
 			{VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, 2.0f}
@@ -142,6 +155,18 @@ namespace PXTEngine {
             m_resourceManager.add(image, name);
         }
 
+        // threshold map of the low discrepancy sampler of the path tracer
+        BlueNoiseTexture blueNoise;
+        const std::vector<uint8_t> blueNoiseTexels = blueNoise.getRgba8Texels();
+
+        ImageInfo blueNoiseInfo;
+        blueNoiseInfo.width = blueNoise.getSize();
+        blueNoiseInfo.height = blueNoise.getSize();
+        blueNoiseInfo.channels = 4;
+        blueNoiseInfo.format = RGBA8_LINEAR;
+
+        m_resourceManager.add(createShared<Texture2D>(m_context, blueNoiseInfo, std::span<const uint8_t>(blueNoiseTexels)), BLUE_NOISE_TEXTURE);
+
         auto defaultMaterial = Material::Builder()
             .setAlbedoColor(glm::vec4(1.0f))
             .setAlbedoMap(m_resourceManager.get<Image>(WHITE_PIXEL))
@@ -158,25 +183,39 @@ namespace PXTEngine {
     }
 
     void Application::registerResources() {
-		// iterate over resource and register images
+        // the defaults first, index 0 is the fallback of the registries
+        registerResource(m_resourceManager.get(WHITE_PIXEL));
+        registerResource(ResourceManager::defaultMaterial);
+
 		m_resourceManager.foreach([&](const Shared<Resource>& resource) {
-            if (resource->getType() == Resource::Type::Image) {
-                const auto image = std::static_pointer_cast<Image>(resource);
-                m_textureRegistry.add(image);
-            }
-			else if (resource->getType() == Resource::Type::Mesh) {
-				auto mesh = std::static_pointer_cast<Mesh>(resource);
-				m_blasRegistry.getOrCreateBLAS(mesh);
-			}
+            registerResource(resource);
 		});
 
-        m_resourceManager.foreach([&](const Shared<Resource>& resource) {
-            if (resource->getType() == Resource::Type::Material) {
-                auto material = std::static_pointer_cast<Material>(resource);
+        // every BLAS in a single submission, then compacted
+        m_blasRegistry.buildPending();
+    }
 
+    void Application::registerResource(const Shared<Resource>& resource) {
+        switch (resource->getType()) {
+            case Resource::Type::Image: {
+                const auto image = std::static_pointer_cast<Image>(resource);
+                m_textureRegistry.add(image);
+                break;
+            }
+            case Resource::Type::Mesh: {
+                // built by the next buildPending, with the other meshes of the same frame
+                auto mesh = std::static_pointer_cast<Mesh>(resource);
+                m_blasRegistry.add(mesh);
+                break;
+            }
+            case Resource::Type::Material: {
+                const auto material = std::static_pointer_cast<Material>(resource);
                 m_materialRegistry.add(material);
+                break;
             }
-        });
+            default:
+                break;
+        }
     }
 
     void Application::run() {
@@ -188,8 +227,17 @@ namespace PXTEngine {
         m_scene.onStart();
         uint32_t frameCount = 0;
         while (isRunning()) {
+            const auto frameStart = std::chrono::high_resolution_clock::now();
+
             glfwPollEvents();
 
+            // the geometry freed more than the frames in flight ago can be reused
+            m_context.getGeometryArena().advanceFrame();
+
+            // swap in the resources whose background import ended
+            m_resourceManager.processCompletedLoads();
+            m_blasRegistry.buildPending();
+
             auto newTime = std::chrono::high_resolution_clock::now();
             float elapsedTime = std::chrono::duration<float>(newTime - currentTime).count();
             currentTime = newTime;
@@ -197,10 +245,17 @@ namespace PXTEngine {
             m_scene.onUpdate(elapsedTime);
 
             updateCamera(camera);
+
+            const auto beginFrameStart = std::chrono::high_resolution_clock::now();
             
             if (auto commandBuffer = m_renderer.beginFrame()) {
+                const auto recordStart = std::chrono::high_resolution_clock::now();
                 int frameIndex = m_renderer.getFrameIndex();
 
+                // the frame is no longer in use by the GPU, its sets get the textures and materials loaded since
+                m_textureRegistry.update(frameIndex);
+                m_materialRegistry.update(frameIndex);
+
                 FrameInfo frameInfo = {
                     frameIndex,
                     elapsedTime,
@@ -222,6 +277,15 @@ namespace PXTEngine {
 				m_masterRenderSystem->doRenderPasses(frameInfo);
 
                 m_renderer.endFrame();
+
+                updateStartupTimings();
+
+                if (m_launchOptions.benchmarkFrameCount > 0) {
+                    // the wait for the frame in flight in beginFrame is GPU time, it is left out
+                    const float cpuSeconds = std::chrono::duration<float>(beginFrameStart - frameStart).count() +
+                        std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - recordStart).count();
+                    updateFrameBenchmark(cpuSeconds);
+                }
             }
 
             // tracy end frame mark
@@ -231,6 +295,171 @@ namespace PXTEngine {
         vkDeviceWaitIdle(m_context.getDevice());
     }
 
+    void Application::updateStartupTimings() {
+        if (m_firstFrameTime > 0.0f && m_assetsLoadedTime > 0.0f) {
+            return;
+        }
+
+        const float elapsedTime = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - m_startTime).count();
+        const char* loading = m_launchOptions.syncLoading ? "sync" : "async";
+
+        if (m_firstFrameTime == 0.0f) {
+            m_firstFrameTime = elapsedTime;
+            PXT_INFO("Startup ({} loading): first frame after {:.3f} s", loading, m_firstFrameTime);
+        }
+
+        if (m_assetsLoadedTime == 0.0f && !m_resourceManager.hasPendingLoads()) {
+            m_assetsLoadedTime = elapsedTime;
+            PXT_INFO("Startup ({} loading): every asset loaded after {:.3f} s", loading, m_assetsLoadedTime);
+
+            if (m_launchOptions.benchmarkStartup) {
+                m_running = false;
+            }
+        }
+    }
+
+    void Application::updateFrameBenchmark(const float cpuSeconds) {
+        // the BLAS builds and the registry updates of the last assets are done in the following frames
+        static constexpr uint32_t WARMUP_FRAME_COUNT = 60;
+
+        if (m_assetsLoadedTime == 0.0f) {
+            return;
+        }
+
+        if (m_benchmarkWarmupFrameCount < WARMUP_FRAME_COUNT) {
+            if (++m_benchmarkWarmupFrameCount == WARMUP_FRAME_COUNT) {
+                m_benchmarkHostWaitCount = m_context.getUploader().getHostWaitCount();
+            }
+            return;
+        }
+
+        const MaterialDrawStats& drawStats = m_masterRenderSystem->getMaterialDrawStats();
+        m_benchmarkDrawStats.renderListMs += drawStats.renderListMs;
+        m_benchmarkDrawStats.prepareMs += drawStats.prepareMs;
+        m_benchmarkDrawStats.recordMs += drawStats.recordMs;
+        m_benchmarkDrawStats.gpuMs += drawStats.gpuMs;
+        m_benchmarkDrawStats.bindCount = drawStats.bindCount;
+        m_benchmarkDrawStats.drawCount = drawStats.drawCount;
+        m_benchmarkDrawStats.indirectCallCount = drawStats.indirectCallCount;
+        m_benchmarkDrawStats.instanceCount = drawStats.instanceCount;
+
+        m_benchmarkFrameTimes.push_back(cpuSeconds * 1e3f);
+        if (m_benchmarkFrameTimes.size() < m_launchOptions.benchmarkFrameCount) {
+            return;
+        }
+
+        std::vector<float> sortedTimes = m_benchmarkFrameTimes;
+        std::sort(sortedTimes.begin(), sortedTimes.end());
+
+        const float frameCount = static_cast<float>(sortedTimes.size());
+        const float averageTime = std::accumulate(sortedTimes.begin(), sortedTimes.end(), 0.0f) / frameCount;
+        const float percentileTime = sortedTimes[sortedTimes.size() * 99 / 100];
+        const bool isIndirectDrawEnabled = m_masterRenderSystem->isIndirectDrawEnabled();
+        const char* drawPath = isIndirectDrawEnabled ? "indirect draws" : "per object draws";
+
+        PXT_INFO("Frames ({}): {} frames, CPU {:.3f} ms average, {:.3f} ms median, {:.3f} ms 99th percentile, {:.3f} ms max",
+            drawPath, sortedTimes.size(), averageTime, sortedTimes[sortedTimes.size() / 2], percentileTime, sortedTimes.back());
+        PXT_INFO("Frames ({}): {} entities in {} binds, {} draws, {} indirect calls, average render list {:.3f} ms, "
+            "prepare {:.3f} ms, record {:.3f} ms, GPU {:.3f} ms",
+            drawPath, m_benchmarkDrawStats.instanceCount, m_benchmarkDrawStats.bindCount, m_benchmarkDrawStats.drawCount,
+            m_benchmarkDrawStats.indirectCallCount,
+            m_benchmarkDrawStats.renderListMs / frameCount, m_benchmarkDrawStats.prepareMs / frameCount,
+            m_benchmarkDrawStats.recordMs / frameCount, m_benchmarkDrawStats.gpuMs / frameCount);
+        PXT_INFO("Frames ({}): {} waits for the GPU outside of the frame fences",
+            drawPath, m_context.getUploader().getHostWaitCount() - m_benchmarkHostWaitCount);
+
+        if (!isIndirectDrawEnabled) {
+            m_running = false;
+            return;
+        }
+
+        // the same frames again with the per object draws, the GPU times read in the first frames are still
+        // the ones of the indirect draws
+        m_masterRenderSystem->setIndirectDrawEnabled(false);
+        m_benchmarkWarmupFrameCount = WARMUP_FRAME_COUNT - SwapChain::MAX_FRAMES_IN_FLIGHT - 1;
+        m_benchmarkFrameTimes.clear();
+        m_benchmarkDrawStats = {};
+    }
+
+    void Application::benchmarkUploads() {
+        constexpr uint32_t bufferCount = 512;
+        constexpr VkDeviceSize bufferSize = 256 * 1024;
+        constexpr uint32_t imageCount = 64;
+        constexpr uint32_t imageSize = 512;
+
+        VkDevice device = m_context.getDevice();
+        Uploader& uploader = m_context.getUploader();
+
+        const std::vector<uint8_t> data(std::max<size_t>(bufferSize, imageSize * imageSize * 4), 0x5A);
+
+        std::vector<std::pair<VkBuffer, GpuAllocation>> buffers(bufferCount);
+        for (auto& [buffer, allocation] : buffers) {
+            m_context.createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, allocation);
+        }
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+        imageInfo.extent = { imageSize, imageSize, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        std::vector<std::pair<VkImage, GpuAllocation>> images(imageCount);
+        for (auto& [image, allocation] : images) {
+            m_context.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, allocation);
+        }
+
+        VkBufferImageCopy region{};
+        region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+        region.imageExtent = { imageSize, imageSize, 1 };
+        const VkImageSubresourceRange range{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+        // uploads every resource, waiting after each one like the single time commands did, or once at the end
+        auto uploadAll = [&](const bool waitEveryResource) {
+            const auto start = std::chrono::high_resolution_clock::now();
+
+            for (const auto& [buffer, allocation] : buffers) {
+                uploader.copyToBuffer(buffer, data.data(), bufferSize);
+                if (waitEveryResource) uploader.waitIdle();
+            }
+            for (const auto& [image, allocation] : images) {
+                uploader.copyToImage(image, data.data(), imageSize * imageSize * 4, std::span(&region, 1), range);
+                if (waitEveryResource) uploader.waitIdle();
+            }
+            uploader.waitIdle();
+
+            return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        };
+
+        const double totalMegabytes = (bufferCount * bufferSize + imageCount * imageSize * imageSize * 4.0) / (1024.0 * 1024.0);
+
+        // the first run warms up the ring and the batches
+        uploadAll(false);
+        for (const bool waitEveryResource : { true, false }) {
+            const double seconds = uploadAll(waitEveryResource);
+
+            PXT_INFO("Uploads ({}): {} buffers and {} images, {:.1f} MB in {:.2f} ms ({:.0f} MB/s, {} transfer queue)",
+                waitEveryResource ? "wait per resource" : "batched", bufferCount, imageCount, totalMegabytes,
+                seconds * 1e3, totalMegabytes / seconds, uploader.hasDedicatedTransferQueue() ? "dedicated" : "graphics");
+        }
+
+        for (auto& [buffer, allocation] : buffers) {
+            vkDestroyBuffer(device, buffer, nullptr);
+            m_context.getAllocator().free(allocation);
+        }
+        for (auto& [image, allocation] : images) {
+            vkDestroyImage(device, image, nullptr);
+            m_context.getAllocator().free(allocation);
+        }
+    }
+
     bool Application::isRunning() {
         return !m_window.shouldClose() && m_running;
     }
@@ -262,16 +491,48 @@ namespace PXTEngine {
 
 }
 
-int main() {
+namespace {
+
+    PXTEngine::LaunchOptions parseLaunchOptions(const int argc, char** argv) {
+        PXTEngine::LaunchOptions options;
+
+        for (int i = 1; i < argc; i++) {
+            const std::string_view argument = argv[i];
+
+            if (argument == "--sync-loading") {
+                options.syncLoading = true;
+            } else if (argument == "--benchmark-startup") {
+                options.benchmarkStartup = true;
+            } else if (argument == "--benchmark-uploads") {
+                options.benchmarkUploads = true;
+            } else if (argument == "--benchmark-frames" && i + 1 < argc) {
+                options.benchmarkFrameCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (argument == "--stress-entities" && i + 1 < argc) {
+                options.stressEntityCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else {
+                PXT_WARN("Unknown launch option '{}'", argument);
+            }
+        }
+
+        return options;
+    }
+}
+
+int main(int argc, char** argv) {
 
 	PXTEngine::Logger::init();
 
     try {
 
         auto app = PXTEngine::initApplication();
+        app->m_launchOptions = parseLaunchOptions(argc, argv);
 
-        app->start();
-        app->run();
+        if (app->m_launchOptions.benchmarkUploads) {
+            app->benchmarkUploads();
+        } else {
+            app->start();
+            app->run();
+        }
 
         delete app;
     } catch (const std::exception& e) {
@@ -15,10 +15,34 @@
 #include "resources/types/material.hpp"
 #include "scene/scene.hpp"
 
-int main();
+int main(int argc, char** argv);
 
 namespace PXTEngine {
 
+    /**
+     * @struct LaunchOptions
+     *
+     * @brief The options given on the command line.
+     */
+    struct LaunchOptions {
+        // --sync-loading: every scene asset is imported before the first frame, the baseline of the async startup
+        bool syncLoading = false;
+
+        // --benchmark-startup: quit once every asset is loaded and report the startup timings
+        bool benchmarkStartup = false;
+
+        // --benchmark-uploads: compare waiting for every upload with a single batched submission, then quit
+        bool benchmarkUploads = false;
+
+        // --benchmark-frames <count>: once every asset is loaded, time this many frames with the indirect draws of
+        // the material pass, then as many with its per object draws, report their CPU time, the material pass
+        // costs and the waits for the GPU outside of the frame fences, then quit
+        uint32_t benchmarkFrameCount = 0;
+
+        // --stress-entities <count>: number of props the scene adds to stress the renderers
+        uint32_t stressEntityCount = 0;
+    };
+
     class Application {
     public:
         Application();
@@ -46,6 +70,10 @@ namespace PXTEngine {
 			return m_descriptorAllocator;
 		}
 
+        const LaunchOptions& getLaunchOptions() const {
+            return m_launchOptions;
+        }
+
     protected:
         virtual void loadScene() {}
     private:
@@ -54,6 +82,10 @@ namespace PXTEngine {
         void createGlobalDescriptorSet();
         void createDefaultResources();
         void registerResources();
+        void registerResource(const Shared<Resource>& resource);
+        void updateStartupTimings();
+        void updateFrameBenchmark(float cpuSeconds);
+        void benchmarkUploads();
 
         void start();
         void run();
@@ -63,6 +95,20 @@ namespace PXTEngine {
 
         bool m_running = true;
 
+        LaunchOptions m_launchOptions{};
+
+        // from the construction of the application, to measure the time to the first frame and to the last asset
+        std::chrono::high_resolution_clock::time_point m_startTime = std::chrono::high_resolution_clock::now();
+        float m_firstFrameTime = 0.0f;
+        float m_assetsLoadedTime = 0.0f;
+
+        // --benchmark-frames: the frames skipped once the assets are loaded, then the CPU time of the measured ones
+        // and the sum of their material pass costs
+        uint32_t m_benchmarkWarmupFrameCount = 0;
+        uint32_t m_benchmarkHostWaitCount = 0;
+        std::vector<float> m_benchmarkFrameTimes;
+        MaterialDrawStats m_benchmarkDrawStats{};
+
         Window m_window{WindowData()};
         Context m_context{m_window};
 
@@ -84,7 +130,7 @@ namespace PXTEngine {
 
         static Application* m_instance;
 
-        friend int ::main();
+        friend int ::main(int argc, char** argv);
     };
 
     Application* initApplication();
@@ -12,6 +12,7 @@ const std::string WHITE_PIXEL_LINEAR = "pixel_0xFFFFFFFF_RGBA8_LINEAR";
 const std::string GRAY_PIXEL_LINEAR = "pixel_0xFF808080_RGBA8_LINEAR";
 const std::string BLACK_PIXEL_LINEAR = "pixel_0xFF000000_RGBA8_LINEAR";
 const std::string NORMAL_PIXEL_LINEAR = "pixel_0xFFFF8080_RGBA8_LINEAR";
+const std::string BLUE_NOISE_TEXTURE = "blue_noise_RGBA8_LINEAR";
 
 const std::string DEFAULT_MATERIAL = "default_material";
 
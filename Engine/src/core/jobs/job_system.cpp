@@ -0,0 +1,214 @@
+#include "core/jobs/job_system.hpp"
+
+#include "core/jobs/work_stealing_queue.hpp"
+
+namespace PXTEngine {
+
+	namespace {
+		struct QueuedJob {
+			Job job;
+			JobCounter* counter = nullptr;
+		};
+
+		// queue 0 belongs to the thread that called init (the main thread)
+		std::vector<Unique<WorkStealingQueue<QueuedJob>>> s_queues;
+		std::vector<std::thread> s_workers;
+
+		std::atomic<bool> s_running = false;
+		std::atomic<uint32_t> s_queuedJobs = 0;
+		std::atomic<uint32_t> s_nextExternalQueue = 0;
+
+		std::mutex s_sleepMutex;
+		std::condition_variable s_wakeUp;
+
+		// index of the queue owned by the current thread, -1 for threads not known by the system
+		thread_local int32_t t_threadIndex = -1;
+	}
+
+	void JobSystem::init(uint32_t workerCount) {
+		PXT_ASSERT(!s_running, "JobSystem already initialized");
+
+		if (workerCount == 0) {
+			workerCount = std::max(1u, std::thread::hardware_concurrency() - 1);
+		}
+
+		s_queues.clear();
+		for (uint32_t i = 0; i <= workerCount; i++) {
+			s_queues.push_back(createUnique<WorkStealingQueue<QueuedJob>>());
+		}
+
+		t_threadIndex = 0;
+		s_running = true;
+
+		for (uint32_t i = 1; i <= workerCount; i++) {
+			s_workers.emplace_back(workerLoop, i);
+		}
+
+		PXT_INFO("Job system started with {} worker threads", workerCount);
+	}
+
+	void JobSystem::shutdown() {
+		if (!s_running) return;
+
+		// drain what is left before stopping the workers
+		while (s_queuedJobs > 0) {
+			if (!tryRunOne()) std::this_thread::yield();
+		}
+
+		{
+			std::lock_guard lock(s_sleepMutex);
+			s_running = false;
+		}
+		s_wakeUp.notify_all();
+
+		for (auto& worker : s_workers) {
+			worker.join();
+		}
+
+		s_workers.clear();
+		s_queues.clear();
+		t_threadIndex = -1;
+	}
+
+	uint32_t JobSystem::getWorkerCount() {
+		return static_cast<uint32_t>(s_workers.size());
+	}
+
+	void JobSystem::run(Job job, JobCounter* counter, JobCounter* dependency) {
+		if (counter) {
+			counter->m_pending.fetch_add(1);
+		}
+
+		if (dependency) {
+			std::unique_lock lock(dependency->m_mutex);
+
+			// the dependency is decremented under this lock, so it can't end between the check and the push
+			if (dependency->m_pending.load() > 0) {
+				dependency->m_continuations.push_back({ std::move(job), counter });
+				return;
+			}
+		}
+
+		schedule(std::move(job), counter);
+	}
+
+	void JobSystem::parallelFor(const size_t count, size_t grainSize,
+		const std::function<void(size_t begin, size_t end)>& function, JobCounter& counter) {
+
+		if (count == 0) return;
+
+		grainSize = std::max<size_t>(1, grainSize);
+
+		// the jobs can outlive the caller, so they share a copy of the function
+		auto sharedFunction = createShared<std::function<void(size_t, size_t)>>(function);
+
+		for (size_t begin = 0; begin < count; begin += grainSize) {
+			const size_t end = std::min(begin + grainSize, count);
+
+			run([sharedFunction, begin, end]() { (*sharedFunction)(begin, end); }, &counter);
+		}
+	}
+
+	void JobSystem::parallelFor(const size_t count, const size_t grainSize,
+		const std::function<void(size_t begin, size_t end)>& function) {
+
+		JobCounter counter;
+		parallelFor(count, grainSize, function, counter);
+		wait(counter);
+	}
+
+	void JobSystem::wait(const JobCounter& counter) {
+		while (!counter.isDone()) {
+			if (!tryRunOne()) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void JobSystem::schedule(Job job, JobCounter* counter) {
+		if (!s_running) {
+			execute(job, counter);
+			return;
+		}
+
+		const uint32_t queueIndex = t_threadIndex >= 0
+			? static_cast<uint32_t>(t_threadIndex)
+			: s_nextExternalQueue++ % static_cast<uint32_t>(s_queues.size());
+
+		// counted before it is visible to the thieves, whose decrement must never come first
+		s_queuedJobs++;
+		s_queues[queueIndex]->push({ std::move(job), counter });
+
+		// taking the lock makes sure a worker can't miss the notification between its check and its wait
+		{
+			std::lock_guard lock(s_sleepMutex);
+		}
+		s_wakeUp.notify_one();
+	}
+
+	void JobSystem::execute(Job& job, JobCounter* counter) {
+		try {
+			job();
+		} catch (const std::exception& e) {
+			PXT_ERROR("Job failed: {}", e.what());
+		}
+
+		if (counter) {
+			finish(counter);
+		}
+	}
+
+	void JobSystem::finish(JobCounter* counter) {
+		std::vector<JobCounter::Continuation> continuations;
+
+		counter->m_finishing.fetch_add(1);
+		{
+			std::lock_guard lock(counter->m_mutex);
+
+			if (counter->m_pending.fetch_sub(1) == 1) {
+				continuations.swap(counter->m_continuations);
+			}
+		}
+		// last access to the counter, a waiter is free to destroy it from now on
+		counter->m_finishing.fetch_sub(1);
+
+		for (auto& continuation : continuations) {
+			schedule(std::move(continuation.job), continuation.counter);
+		}
+	}
+
+	bool JobSystem::tryRunOne() {
+		if (s_queues.empty()) return false;
+
+		const uint32_t queueCount = static_cast<uint32_t>(s_queues.size());
+		const uint32_t ownIndex = t_threadIndex >= 0 ? static_cast<uint32_t>(t_threadIndex) : 0;
+
+		QueuedJob queued;
+		bool found = t_threadIndex >= 0 && s_queues[ownIndex]->pop(queued);
+
+		// steal starting from the next queue, so that thieves spread over the victims
+		for (uint32_t i = 1; !found && i <= queueCount; i++) {
+			found = s_queues[(ownIndex + i) % queueCount]->steal(queued);
+		}
+
+		if (!found) return false;
+
+		s_queuedJobs--;
+		execute(queued.job, queued.counter);
+
+		return true;
+	}
+
+	void JobSystem::workerLoop(const uint32_t threadIndex) {
+		t_threadIndex = static_cast<int32_t>(threadIndex);
+
+		while (true) {
+			if (tryRunOne()) continue;
+
+			std::unique_lock lock(s_sleepMutex);
+			s_wakeUp.wait(lock, []() { return s_queuedJobs > 0 || !s_running; });
+
+			if (!s_running && s_queuedJobs == 0) return;
+		}
+	}
+}
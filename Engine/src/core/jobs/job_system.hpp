@@ -0,0 +1,119 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+namespace PXTEngine {
+
+	using Job = std::function<void()>;
+
+	/**
+	 * @class JobCounter
+	 *
+	 * @brief Tracks a group of jobs and lets other jobs or threads wait for them.
+	 *
+	 * The counter is incremented when a job is submitted with it and decremented when the
+	 * job ends, so it reaches zero when the whole group is done. Jobs submitted with a
+	 * counter as dependency are started only once that counter is done.
+	 *
+	 * The counter must outlive the jobs that reference it.
+	 */
+	class JobCounter {
+	public:
+		JobCounter() = default;
+
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		/**
+		 * @brief Returns true if every job submitted with this counter has ended.
+		 */
+		bool isDone() const { return m_pending.load() == 0 && m_finishing.load() == 0; }
+
+	private:
+		struct Continuation {
+			Job job;
+			JobCounter* counter;
+		};
+
+		std::atomic<uint32_t> m_pending = 0;
+		// threads still touching the counter after decrementing it, the counter
+		// can be destroyed by a waiter only once they are gone
+		std::atomic<uint32_t> m_finishing = 0;
+
+		std::mutex m_mutex;
+		std::vector<Continuation> m_continuations;
+
+		friend class JobSystem;
+	};
+
+	/**
+	 * @class JobSystem
+	 *
+	 * @brief Fixed pool of worker threads running small jobs.
+	 *
+	 * Every worker (and the main thread) owns a work stealing queue: jobs are pushed on
+	 * the queue of the submitting thread and idle threads steal from the others.
+	 * Threads waiting on a counter keep running jobs instead of blocking.
+	 *
+	 * If the system is not initialized every job runs inline on the submitting thread,
+	 * so code using it also works in tools that don't start the workers.
+	 */
+	class JobSystem {
+	public:
+		/**
+		 * @brief Starts the worker threads.
+		 *
+		 * @param workerCount Number of workers, 0 to use one worker per hardware thread
+		 *                    except the calling one.
+		 */
+		static void init(uint32_t workerCount = 0);
+
+		/**
+		 * @brief Waits for the queued jobs to end and stops the worker threads.
+		 */
+		static void shutdown();
+
+		/**
+		 * @brief Returns the number of worker threads, not counting the main thread.
+		 */
+		static uint32_t getWorkerCount();
+
+		/**
+		 * @brief Submits a job.
+		 *
+		 * @param job The function to run.
+		 * @param counter Counter incremented now and decremented when the job ends, can be null.
+		 * @param dependency Counter that must be done before the job starts, can be null.
+		 */
+		static void run(Job job, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+		/**
+		 * @brief Splits [0, count) into ranges of at most grainSize elements and submits a job per range.
+		 *
+		 * @param count Number of elements.
+		 * @param grainSize Maximum number of elements processed by a single job.
+		 * @param function Called with the [begin, end) range of every job.
+		 * @param counter Counter tracking the submitted jobs.
+		 */
+		static void parallelFor(size_t count, size_t grainSize,
+			const std::function<void(size_t begin, size_t end)>& function, JobCounter& counter);
+
+		/**
+		 * @brief Blocking version of parallelFor, returns when every range has been processed.
+		 */
+		static void parallelFor(size_t count, size_t grainSize,
+			const std::function<void(size_t begin, size_t end)>& function);
+
+		/**
+		 * @brief Waits for a counter, running queued jobs in the meantime.
+		 */
+		static void wait(const JobCounter& counter);
+
+	private:
+		static void schedule(Job job, JobCounter* counter);
+		static void execute(Job& job, JobCounter* counter);
+		static void finish(JobCounter* counter);
+		static bool tryRunOne();
+		static void workerLoop(uint32_t threadIndex);
+	};
+}
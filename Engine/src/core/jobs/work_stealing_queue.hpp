@@ -0,0 +1,61 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+#include <deque>
+
+namespace PXTEngine {
+
+	/**
+	 * @class WorkStealingQueue
+	 *
+	 * @brief Double ended job queue owned by a single thread.
+	 *
+	 * The owner pushes and pops at the back (LIFO, good for cache locality of nested jobs),
+	 * while other threads steal from the front (FIFO, they take the oldest and usually
+	 * biggest pieces of work). Accesses are serialized by a small lock, contention is low
+	 * since every thread works on its own queue most of the time.
+	 *
+	 * @tparam T The type of the stored jobs.
+	 */
+	template<typename T>
+	class WorkStealingQueue {
+	public:
+		void push(T item) {
+			std::lock_guard lock(m_mutex);
+			m_items.push_back(std::move(item));
+		}
+
+		/**
+		 * @brief Pops the most recently pushed item, called by the owner thread.
+		 *
+		 * @return true if an item has been popped.
+		 */
+		bool pop(T& item) {
+			std::lock_guard lock(m_mutex);
+			if (m_items.empty()) return false;
+
+			item = std::move(m_items.back());
+			m_items.pop_back();
+			return true;
+		}
+
+		/**
+		 * @brief Steals the oldest item, called by the other threads.
+		 *
+		 * @return true if an item has been stolen.
+		 */
+		bool steal(T& item) {
+			std::lock_guard lock(m_mutex);
+			if (m_items.empty()) return false;
+
+			item = std::move(m_items.front());
+			m_items.pop_front();
+			return true;
+		}
+
+	private:
+		std::mutex m_mutex;
+		std::deque<T> m_items;
+	};
+}
@@ -0,0 +1,109 @@
+#include "core/mapped_file.hpp"
+
+#if defined(PXT_PLATFORM_WINDOWS)
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace PXTEngine {
+
+#if defined(PXT_PLATFORM_WINDOWS)
+
+	MappedFile::MappedFile(const std::filesystem::path& filePath) {
+		HANDLE file = CreateFileW(filePath.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE) {
+			throw std::runtime_error("failed to open file for mapping: " + filePath.string());
+		}
+		m_fileHandle = file;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+			release();
+			throw std::runtime_error("failed to map empty or unreadable file: " + filePath.string());
+		}
+		m_size = static_cast<size_t>(fileSize.QuadPart);
+
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr) {
+			release();
+			throw std::runtime_error("failed to create file mapping: " + filePath.string());
+		}
+		m_mappingHandle = mapping;
+
+		m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		if (m_data == nullptr) {
+			release();
+			throw std::runtime_error("failed to map view of file: " + filePath.string());
+		}
+	}
+
+	void MappedFile::release() {
+		if (m_data) {
+			UnmapViewOfFile(m_data);
+			m_data = nullptr;
+		}
+		if (m_mappingHandle) {
+			CloseHandle(m_mappingHandle);
+			m_mappingHandle = nullptr;
+		}
+		if (m_fileHandle) {
+			CloseHandle(m_fileHandle);
+			m_fileHandle = nullptr;
+		}
+		m_size = 0;
+	}
+
+#else
+
+	MappedFile::MappedFile(const std::filesystem::path& filePath) {
+		m_fileDescriptor = open(filePath.c_str(), O_RDONLY);
+		if (m_fileDescriptor < 0) {
+			throw std::runtime_error("failed to open file for mapping: " + filePath.string());
+		}
+
+		struct stat fileStat {};
+		if (fstat(m_fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0) {
+			release();
+			throw std::runtime_error("failed to map empty or unreadable file: " + filePath.string());
+		}
+		m_size = static_cast<size_t>(fileStat.st_size);
+
+		void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fileDescriptor, 0);
+		if (mapping == MAP_FAILED) {
+			release();
+			throw std::runtime_error("failed to mmap file: " + filePath.string());
+		}
+
+		// the whole file is read front to back when it is copied into the staging buffer
+		madvise(mapping, m_size, MADV_WILLNEED);
+
+		m_data = static_cast<const uint8_t*>(mapping);
+	}
+
+	void MappedFile::release() {
+		if (m_data) {
+			munmap(const_cast<uint8_t*>(m_data), m_size);
+			m_data = nullptr;
+		}
+		if (m_fileDescriptor >= 0) {
+			close(m_fileDescriptor);
+			m_fileDescriptor = -1;
+		}
+		m_size = 0;
+	}
+
+#endif
+
+	MappedFile::~MappedFile() {
+		release();
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "core/platform.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class MappedFile
+	 *
+	 * @brief Read-only memory mapping of a file.
+	 *
+	 * The file contents are mapped into the address space of the process, so they can be
+	 * read (and copied into GPU staging buffers) without an intermediate heap allocation.
+	 * The mapping is released when the object is destroyed.
+	 */
+	class MappedFile {
+	public:
+		/**
+		 * @brief Maps the whole file in read-only mode.
+		 *
+		 * @param filePath The path of the file to map.
+		 *
+		 * @throws std::runtime_error if the file cannot be opened or mapped.
+		 */
+		explicit MappedFile(const std::filesystem::path& filePath);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/**
+		 * @brief Returns a pointer to the first byte of the mapping.
+		 */
+		const uint8_t* data() const { return m_data; }
+
+		/**
+		 * @brief Returns the size in bytes of the mapping.
+		 */
+		size_t size() const { return m_size; }
+
+		/**
+		 * @brief Reinterprets the bytes at the given offset as a T.
+		 *
+		 * @tparam T The type stored at the offset.
+		 * @param offset Byte offset from the beginning of the file.
+		 */
+		template<typename T>
+		const T* get(const size_t offset = 0) const {
+			return reinterpret_cast<const T*>(m_data + offset);
+		}
+
+	private:
+		void release();
+
+		const uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+
+#if defined(PXT_PLATFORM_WINDOWS)
+		void* m_fileHandle = nullptr;
+		void* m_mappingHandle = nullptr;
+#else
+		int m_fileDescriptor = -1;
+#endif
+	};
+}
@@ -7,6 +7,7 @@
 #include <memory>        // For smart pointers (e.g., std::unique_ptr, std::shared_ptr) for memory management
 #include <utility>       // For std::pair, std::move, std::forward, and other utility functions
 #include <algorithm>     // For various algorithms (e.g., sort, find, min, max)
+#include <numeric>       // For numeric algorithms (e.g., iota, accumulate)
 #include <functional>    // For std::function, std::bind, and other function-related utilities
 #include <chrono>        // For time-related utilities (durations, time points, clocks)
 #include <limits>        // For numeric_limits, providing properties of fundamental types
@@ -20,12 +21,22 @@
 #include <unordered_set>    // For std::unordered_set, a hash table-based set
 #include <set>              // For std::set, a sorted associative container (balanced binary search tree)
 #include <map>              // For std::map, a sorted associative container of key-value pairs (balanced binary search tree)
+#include <deque>            // For std::deque, a double-ended queue
+#include <optional>         // For std::optional, a value that may or may not be present
 
 // Standard Library Headers - Low-level Utilities and C-style Compatibility
 // These headers offer lower-level functionalities, often inherited from C.
 #include <cstdint>       // For fixed-width integer types (e.g., int32_t, uint64_t)
 #include <cstring>       // For C-style string manipulation functions (e.g., strcpy, memset)
 #include <cassert>       // For assert macro, used for debugging to check conditions
+#include <bit>           // For std::bit_width, std::countr_zero and other bit manipulation functions (C++20)
+
+// Standard Library Headers - Concurrency
+#include <thread>              // For std::thread and std::thread::hardware_concurrency
+#include <atomic>              // For std::atomic, lock-free shared counters and flags
+#include <mutex>               // For std::mutex and std::lock_guard
+#include <shared_mutex>        // For std::shared_mutex, many readers or a single writer
+#include <condition_variable>  // For std::condition_variable, to put threads to sleep
 
 // Standard Library Headers - Error Handling
 // These headers provide mechanisms for handling errors and exceptions.
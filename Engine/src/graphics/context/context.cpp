@@ -1,5 +1,7 @@
 #include "graphics/context/context.hpp"
 
+#include "graphics/memory/geometry_arena.hpp"
+
 namespace PXTEngine {
 
     Context::Context(Window& window)
@@ -7,9 +9,15 @@ namespace PXTEngine {
         m_instance{ "PXT Engine" },
         m_surface{ m_window, m_instance },
         m_physicalDevice{ m_instance, m_surface },
-        m_device{ m_window, m_instance, m_surface, m_physicalDevice } {
+        m_device{ m_window, m_instance, m_surface, m_physicalDevice },
+        m_allocator{ createUnique<GpuAllocator>(
+            createUnique<VulkanMemoryBackend>(m_physicalDevice.getDevice(), m_device.getDevice())) },
+        m_uploader{ createUnique<Uploader>(m_device.getDevice(), m_physicalDevice.findQueueFamilies(),
+            m_device.getTransferQueue(), m_device.getGraphicsQueue(), *m_allocator) } {
 
 		createCommandPool();
+
+        m_geometryArena = createUnique<GeometryArena>(*this);
     }
 
 	Context::~Context() {
@@ -32,22 +40,11 @@ namespace PXTEngine {
     }
 
     uint32_t Context::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
-        VkPhysicalDeviceMemoryProperties memProperties;
-        vkGetPhysicalDeviceMemoryProperties(m_physicalDevice.getDevice(), &memProperties);
-
-        for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-            if ((typeFilter & (1 << i)) &&
-                (memProperties.memoryTypes[i].propertyFlags & properties) ==
-                properties) {
-                return i;
-            }
-        }
-
-        throw std::runtime_error("failed to find suitable memory type!");
+        return m_allocator->findMemoryType(typeFilter, properties);
     }
 
 	void Context::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
-                               VkBuffer &buffer, VkDeviceMemory &bufferMemory) {
+                               VkBuffer &buffer, GpuAllocation &allocation) {
         VkBufferCreateInfo bufferInfo{};
         bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         bufferInfo.size = size;
@@ -59,29 +56,13 @@ namespace PXTEngine {
             throw std::runtime_error("failed to create buffer!");
         }
 
-        VkMemoryRequirements memRequirements;
-        vkGetBufferMemoryRequirements(m_device.getDevice(), buffer, &memRequirements);
-
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-		VkMemoryAllocateFlagsInfo flagsInfo{};
-		if (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
-			flagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
-			flagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
-			// Chain the flagsInfo structure to the allocation info
-			allocInfo.pNext = &flagsInfo;
-		}
-
-        if (vkAllocateMemory(m_device.getDevice(), &allocInfo, nullptr, &bufferMemory) !=
-            VK_SUCCESS) {
-            throw std::runtime_error(
-                "failed to allocate buffer memory!");
+        try {
+            allocation = m_allocator->allocateBuffer(buffer, properties);
+        } catch (...) {
+            vkDestroyBuffer(m_device.getDevice(), buffer, nullptr);
+            buffer = VK_NULL_HANDLE;
+            throw;
         }
-
-        vkBindBufferMemory(m_device.getDevice(), buffer, bufferMemory, 0);
     }
 
     VkCommandBuffer Context::beginSingleTimeCommands() {
@@ -106,75 +87,25 @@ namespace PXTEngine {
     void Context::endSingleTimeCommands(VkCommandBuffer commandBuffer) {
         vkEndCommandBuffer(commandBuffer);
 
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
-
-        vkQueueSubmit(m_device.getGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(m_device.getGraphicsQueue());
+        // after the pending uploads, waiting for these commands only and not for the frames in flight
+        m_uploader->submitAndWait(commandBuffer);
 
         vkFreeCommandBuffers(m_device.getDevice(), m_commandPool, 1, &commandBuffer);
     }
 
 
-    void Context::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
-        // TODO: we can try to implement a memory barrier to avoid waiting the copy
-        //       to be finished before we can start rendering again.
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-        VkBufferCopy copyRegion{};
-        copyRegion.srcOffset = 0;  // Optional
-        copyRegion.dstOffset = 0;  // Optional
-        copyRegion.size = size;
-        vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-        endSingleTimeCommands(commandBuffer);
-    }
-
-    void Context::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount) {
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-        VkBufferImageCopy region{};
-        region.bufferOffset = 0;
-        region.bufferRowLength = 0;
-        region.bufferImageHeight = 0;
-
-        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel = 0;
-        region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount = layerCount;
-
-        region.imageOffset = {0, 0, 0};
-        region.imageExtent = {width, height, 1};
-
-        vkCmdCopyBufferToImage(commandBuffer, buffer, image,
-                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
-                               &region);
-
-        endSingleTimeCommands(commandBuffer);
-    }
-
     void Context::createImageWithInfo(const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags properties,
-                                      VkImage &image, VkDeviceMemory &imageMemory) {
+                                      VkImage &image, GpuAllocation &allocation) {
         if (vkCreateImage(m_device.getDevice(), &imageInfo, nullptr, &image) != VK_SUCCESS) {
             throw std::runtime_error("failed to create image!");
         }
 
-        VkMemoryRequirements memRequirements;
-        vkGetImageMemoryRequirements(m_device.getDevice(), image, &memRequirements);
-
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(m_device.getDevice(), &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-            throw std::runtime_error("failed to allocate image memory!");
-        }
-
-        if (vkBindImageMemory(m_device.getDevice(), image, imageMemory, 0) != VK_SUCCESS) {
-            throw std::runtime_error("failed to bind image memory!");
+        try {
+            allocation = m_allocator->allocateImage(image, properties);
+        } catch (...) {
+            vkDestroyImage(m_device.getDevice(), image, nullptr);
+            image = VK_NULL_HANDLE;
+            throw;
         }
     }
 
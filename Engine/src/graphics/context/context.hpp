@@ -5,9 +5,13 @@
 #include "graphics/context/surface.hpp"
 #include "graphics/context/physical_device.hpp"
 #include "graphics/context/logical_device.hpp"
+#include "graphics/memory/gpu_allocator.hpp"
+#include "graphics/memory/uploader.hpp"
 
 namespace PXTEngine {
 
+	class GeometryArena;
+
 	/**
 	 * @class Context
 	 * 
@@ -45,6 +49,26 @@ namespace PXTEngine {
 
 		VkQueue getGraphicsQueue() { return m_device.getGraphicsQueue(); }
 		VkQueue getPresentQueue() { return m_device.getPresentQueue(); }
+		VkQueue getTransferQueue() { return m_device.getTransferQueue(); }
+
+		bool supportsBlockCompression() const { return m_device.supportsBlockCompression(); }
+		bool supportsDrawIndirectFirstInstance() const { return m_device.supportsDrawIndirectFirstInstance(); }
+		bool supportsMultiDrawIndirect() const { return m_device.supportsMultiDrawIndirect(); }
+
+		/**
+		 * @brief Returns the allocator every buffer and image gets its memory from.
+		 */
+		GpuAllocator& getAllocator() { return *m_allocator; }
+
+		/**
+		 * @brief Returns the uploader that batches the copies of data into device local buffers and images.
+		 */
+		Uploader& getUploader() { return *m_uploader; }
+
+		/**
+		 * @brief Returns the vertex and index buffers every mesh is sub-allocated from.
+		 */
+		GeometryArena& getGeometryArena() { return *m_geometryArena; }
 
 		/* ----------------------- Buffer Helper Functions ----------------------- */
 
@@ -64,15 +88,16 @@ namespace PXTEngine {
 		 * @brief Creates a buffer.
 		 *
 		 * This function creates a buffer with the given size, usage, and memory properties.
+		 * The memory is sub-allocated by the GpuAllocator.
 		 *
 		 * @param size The size of the buffer.
 		 * @param usage The usage of the buffer.
 		 * @param properties The memory properties of the buffer.
 		 * @param buffer The buffer handle.
-		 * @param bufferMemory The buffer memory handle.
+		 * @param allocation The memory bound to the buffer, to be freed with the GpuAllocator.
 		 */
 		void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
-						  VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+						  VkBuffer& buffer, GpuAllocation& allocation);
 
 		/**
 		* @brief Begins single-time commands.
@@ -86,48 +111,26 @@ namespace PXTEngine {
 		/**
 		* @brief Ends single-time commands.
 		*
-		* This function ends a command buffer for single-time commands and submits it to the graphics queue.
+		* This function ends a command buffer for single-time commands and submits it to the graphics queue,
+		* after the pending uploads so that the commands can use the uploaded resources, and waits for it
+		* through a fence of the Uploader.
 		*
 		* @param commandBuffer The command buffer handle.
 		*/
 		void endSingleTimeCommands(VkCommandBuffer commandBuffer);
 
-		/**
-		* @brief Copies data from a source buffer to a destination buffer.
-		*
-		* This function copies data from a source buffer to a destination buffer using a command buffer.
-		*
-		* @param srcBuffer The source buffer handle.
-		* @param dstBuffer The destination buffer handle.
-		* @param size The size of the data to copy.
-		*/
-		void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
-
-		/**
-		* @brief Copies data from a buffer to an image.
-		*
-		* This function copies data from a buffer to an image using a command buffer.
-		*
-		* @param buffer The source buffer handle.
-		* @param image The destination image handle.
-		* @param width The width of the image.
-		* @param height The height of the image.
-		* @param layerCount The number of image layers.
-		*/
-		void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount = 1);
-
 		/**
 		* @brief Creates an image with the given create info and memory properties.
 		*
-		* This function creates an image and allocates memory for it.
+		* This function creates an image and allocates memory for it through the GpuAllocator.
 		*
 		* @param imageInfo The image create info.
 		* @param properties The memory properties.
 		* @param image The image handle.
-		* @param imageMemory The image memory handle.
+		* @param allocation The memory bound to the image, to be freed with the GpuAllocator.
 		*/
 		void createImageWithInfo(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties,
-								 VkImage& image, VkDeviceMemory& imageMemory);
+								 VkImage& image, GpuAllocation& allocation);
 
 		/**
 		* @brief Creates an image view for an image.
@@ -206,7 +209,14 @@ namespace PXTEngine {
 		PhysicalDevice m_physicalDevice;
 		LogicalDevice m_device;
 
+		// declared after the device so that it is destroyed before it
+		Unique<GpuAllocator> m_allocator;
+		Unique<Uploader> m_uploader;
+
 		VkCommandPool m_commandPool;
 
+		// after the allocator and the uploader, so that it is destroyed before them
+		Unique<GeometryArena> m_geometryArena;
+
 	};
 }
\ No newline at end of file
@@ -18,7 +18,7 @@ namespace PXTEngine {
         QueueFamilyIndices indices = m_physicalDevice.findQueueFamilies();
 
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-        std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily, indices.presentFamily};
+        std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily, indices.presentFamily, indices.transferFamily};
 
         float queuePriority = 1.0f;
         for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -108,6 +108,13 @@ namespace PXTEngine {
 			throw std::runtime_error("Required features are not supported!");
 		}
 
+        // optional, textures fall back to uncompressed formats without it
+        m_blockCompressionSupported = deviceFeatures2.features.textureCompressionBC == VK_TRUE;
+
+        // optional, the material renderer records direct draws without it
+        m_drawIndirectFirstInstanceSupported = deviceFeatures2.features.drawIndirectFirstInstance == VK_TRUE;
+        m_multiDrawIndirectSupported = deviceFeatures2.features.multiDrawIndirect == VK_TRUE;
+
         if (!accelStructFeatures.accelerationStructure) {
             throw std::runtime_error("Required accelerationStructure feature is not supported!");
         }
@@ -150,5 +157,10 @@ namespace PXTEngine {
 
         vkGetDeviceQueue(m_device, indices.graphicsFamily, 0, &m_graphicsQueue);
         vkGetDeviceQueue(m_device, indices.presentFamily, 0, &m_presentQueue);
+        vkGetDeviceQueue(m_device, indices.transferFamily, 0, &m_transferQueue);
+
+        if (indices.hasDedicatedTransferFamily()) {
+            PXT_INFO("Uploads use the dedicated transfer queue family {}", indices.transferFamily);
+        }
     }
 }
\ No newline at end of file
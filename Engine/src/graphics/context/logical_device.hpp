@@ -36,12 +36,32 @@ namespace PXTEngine {
         VkQueue getGraphicsQueue() { return m_graphicsQueue; }
         VkQueue getPresentQueue() { return m_presentQueue; }
 
+        /**
+         * @brief Returns the queue uploads are submitted to, it is the graphics queue if the device has no separate transfer family.
+         */
+        VkQueue getTransferQueue() { return m_transferQueue; }
+
+        /**
+         * @brief Returns true if BC compressed textures (BC1-BC7) can be sampled.
+         */
+        bool supportsBlockCompression() const { return m_blockCompressionSupported; }
+
+        /**
+         * @brief Returns true if indirect draw commands can start from an instance other than 0.
+         */
+        bool supportsDrawIndirectFirstInstance() const { return m_drawIndirectFirstInstanceSupported; }
+
+        /**
+         * @brief Returns true if a single indirect draw call can read more than one draw command.
+         */
+        bool supportsMultiDrawIndirect() const { return m_multiDrawIndirectSupported; }
+
     private:
         /**
          * @brief Creates a logical device.
          *
          * This function creates a logical device, which is used to interact with the physical device.
-         * It also creates the graphics and present queues.
+         * It also creates the graphics, present and transfer queues.
          */
         void createLogicalDevice();
 
@@ -54,6 +74,11 @@ namespace PXTEngine {
         
         VkQueue m_graphicsQueue;
         VkQueue m_presentQueue;
+        VkQueue m_transferQueue;
+
+        bool m_blockCompressionSupported = false;
+        bool m_drawIndirectFirstInstanceSupported = false;
+        bool m_multiDrawIndirectSupported = false;
     };
 
 }
\ No newline at end of file
@@ -236,6 +236,38 @@ namespace PXTEngine {
             i++;
         }
 
+        if (!indices.graphicsFamilyHasValue) {
+            return indices;
+        }
+
+        // graphics and compute queues support transfers as well, so the graphics family is the fallback
+        indices.transferFamily = indices.graphicsFamily;
+        int bestScore = 0;
+
+        for (uint32_t family = 0; family < queueFamilyCount; family++) {
+            const VkQueueFlags flags = queueFamilies[family].queueFlags;
+
+            if (queueFamilies[family].queueCount == 0 || (flags & VK_QUEUE_GRAPHICS_BIT)) continue;
+
+            // the uploads copy mips and block compressed regions of any extent, which a coarser granularity,
+            // or (0,0,0) that only allows whole mips, doesn't guarantee: the graphics family always has (1,1,1)
+            const VkExtent3D& granularity = queueFamilies[family].minImageTransferGranularity;
+            if (granularity.width != 1 || granularity.height != 1 || granularity.depth != 1) continue;
+
+            // a transfer only family is a DMA engine, an async compute family comes next
+            int score = 0;
+            if (flags & VK_QUEUE_COMPUTE_BIT) {
+                score = 1;
+            } else if (flags & VK_QUEUE_TRANSFER_BIT) {
+                score = 2;
+            }
+
+            if (score > bestScore) {
+                bestScore = score;
+                indices.transferFamily = family;
+            }
+        }
+
         return indices;
     }
 
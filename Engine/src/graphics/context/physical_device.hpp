@@ -81,6 +81,16 @@ namespace PXTEngine {
          */
         uint32_t presentFamily;
 
+        /**
+         * @brief Index of the queue family used for uploads.
+         *
+         * A family with `VK_QUEUE_TRANSFER_BIT` and without graphics (and if possible without compute)
+         * is preferred, so that copies run on the DMA engines concurrently with rendering.
+         * Its minImageTransferGranularity must be (1,1,1) so that any image region can be copied.
+         * When the device has no such family it is the graphics family.
+         */
+        uint32_t transferFamily;
+
         /**
          * @brief Indicates if a valid graphics queue family index has been found.
          *
@@ -95,6 +105,15 @@ namespace PXTEngine {
          */
         bool presentFamilyHasValue = false;
 
+        /**
+         * @brief Checks if uploads run on a queue family different from the graphics one.
+         *
+         * @return `true` if resources written by the transfer queue need a queue family ownership transfer.
+         */
+        bool hasDedicatedTransferFamily() const {
+            return transferFamily != graphicsFamily;
+        }
+
         /**
          * @brief Checks if both required queue families have been found.
          *
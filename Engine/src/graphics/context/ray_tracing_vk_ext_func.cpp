@@ -7,10 +7,11 @@ PFN_vkCreateAccelerationStructureKHR vkCreateAccelerationStructureKHR_ = nullptr
 PFN_vkDestroyAccelerationStructureKHR vkDestroyAccelerationStructureKHR_ = nullptr;
 PFN_vkCmdBuildAccelerationStructuresKHR vkCmdBuildAccelerationStructuresKHR_ = nullptr;
 PFN_vkGetAccelerationStructureBuildSizesKHR vkGetAccelerationStructureBuildSizesKHR_ = nullptr;
+PFN_vkCmdCopyAccelerationStructureKHR vkCmdCopyAccelerationStructureKHR_ = nullptr;
+PFN_vkCmdWriteAccelerationStructuresPropertiesKHR vkCmdWriteAccelerationStructuresPropertiesKHR_ = nullptr;
 
 // add if needed later (^_^)
 /*
-PFN_vkCmdCopyAccelerationStructureKHR vkCmdCopyAccelerationStructureKHR_ = nullptr;
 PFN_vkCopyAccelerationStructureToMemoryKHR vkCopyAccelerationStructureToMemoryKHR_ = nullptr;
 PFN_vkCopyMemoryToAccelerationStructureKHR vkCopyMemoryToAccelerationStructureKHR_ = nullptr;
 PFN_vkWriteAccelerationStructuresPropertiesKHR vkWriteAccelerationStructuresPropertiesKHR_ = nullptr;
@@ -46,12 +47,16 @@ void g_loadRayTracingFunctions(VkDevice device) {
 		vkGetDeviceProcAddr(device, "vkGetAccelerationStructureBuildSizesKHR"));
 	if (!vkGetAccelerationStructureBuildSizesKHR_) throw std::runtime_error("Failed to load vkGetAccelerationStructureBuildSizesKHR");
 
-	// add if needed later (^_^)
-    /*
     vkCmdCopyAccelerationStructureKHR_ = reinterpret_cast<PFN_vkCmdCopyAccelerationStructureKHR>(
         vkGetDeviceProcAddr(device, "vkCmdCopyAccelerationStructureKHR"));
     if (!vkCmdCopyAccelerationStructureKHR_) throw std::runtime_error("Failed to load vkCmdCopyAccelerationStructureKHR");
 
+    vkCmdWriteAccelerationStructuresPropertiesKHR_ = reinterpret_cast<PFN_vkCmdWriteAccelerationStructuresPropertiesKHR>(
+        vkGetDeviceProcAddr(device, "vkCmdWriteAccelerationStructuresPropertiesKHR"));
+    if (!vkCmdWriteAccelerationStructuresPropertiesKHR_) throw std::runtime_error("Failed to load vkCmdWriteAccelerationStructuresPropertiesKHR");
+
+	// add if needed later (^_^)
+    /*
     vkCopyAccelerationStructureToMemoryKHR_ = reinterpret_cast<PFN_vkCopyAccelerationStructureToMemoryKHR>(
         vkGetDeviceProcAddr(device, "vkCopyAccelerationStructureToMemoryKHR"));
     if (!vkCopyAccelerationStructureToMemoryKHR_) throw std::runtime_error("Failed to load vkCopyAccelerationStructureToMemoryKHR");
@@ -13,10 +13,11 @@ extern PFN_vkCreateAccelerationStructureKHR vkCreateAccelerationStructureKHR_;
 extern PFN_vkDestroyAccelerationStructureKHR vkDestroyAccelerationStructureKHR_;
 extern PFN_vkCmdBuildAccelerationStructuresKHR vkCmdBuildAccelerationStructuresKHR_;
 extern PFN_vkGetAccelerationStructureBuildSizesKHR vkGetAccelerationStructureBuildSizesKHR_;
+extern PFN_vkCmdCopyAccelerationStructureKHR vkCmdCopyAccelerationStructureKHR_;
+extern PFN_vkCmdWriteAccelerationStructuresPropertiesKHR vkCmdWriteAccelerationStructuresPropertiesKHR_;
 
 // add if needed later (^_^)
 /*
-extern PFN_vkCmdCopyAccelerationStructureKHR vkCmdCopyAccelerationStructureKHR_;
 extern PFN_vkCopyAccelerationStructureToMemoryKHR vkCopyAccelerationStructureToMemoryKHR_;
 extern PFN_vkCopyMemoryToAccelerationStructureKHR vkCopyMemoryToAccelerationStructureKHR_;
 extern PFN_vkWriteAccelerationStructuresPropertiesKHR vkWriteAccelerationStructuresPropertiesKHR_;
@@ -41,10 +42,11 @@ extern PFN_vkCmdTraceRaysKHR vkCmdTraceRaysKHR_;
 #define vkDestroyAccelerationStructureKHR vkDestroyAccelerationStructureKHR_
 #define vkCmdBuildAccelerationStructuresKHR vkCmdBuildAccelerationStructuresKHR_
 #define vkGetAccelerationStructureBuildSizesKHR vkGetAccelerationStructureBuildSizesKHR_
+#define vkCmdCopyAccelerationStructureKHR vkCmdCopyAccelerationStructureKHR_
+#define vkCmdWriteAccelerationStructuresPropertiesKHR vkCmdWriteAccelerationStructuresPropertiesKHR_
 
 // add if needed later (^_^)
 /*
-#define vkCmdCopyAccelerationStructureKHR vkCmdCopyAccelerationStructureKHR_
 #define vkCopyAccelerationStructureToMemoryKHR vkCopyAccelerationStructureToMemoryKHR_
 #define vkCopyMemoryToAccelerationStructureKHR vkCopyMemoryToAccelerationStructureKHR_
 #define vkWriteAccelerationStructuresPropertiesKHR vkWriteAccelerationStructuresPropertiesKHR_
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @struct DenoiserSettings
+	 * @brief Parameters of the SVGF denoiser, shared by the compute passes and the CPU reference.
+	 *
+	 * filterIterations is the quality/performance knob: every iteration doubles the radius of the
+	 * wavelet and costs a full screen pass.
+	 */
+	struct DenoiserSettings {
+		bool enabled = true;
+		int filterIterations = 4;     // a-trous iterations, from 1 to MAX_FILTER_ITERATIONS
+		float temporalAlpha = 0.2f;   // minimum weight of the new frame in the color history
+		float momentsAlpha = 0.2f;    // minimum weight of the new frame in the moments history
+		float colorPhi = 4.0f;        // luminance edge stopping, in standard deviations
+		float normalPhi = 128.0f;     // normal edge stopping exponent
+		float depthPhi = 0.02f;       // relative depth edge stopping, per pixel of distance
+
+		static constexpr int MAX_FILTER_ITERATIONS = 5;
+	};
+
+	/**
+	 * @struct DenoiserTimings
+	 * @brief Time spent in each pass of the denoiser, in milliseconds.
+	 */
+	struct DenoiserTimings {
+		float reprojectMs = 0.0f;
+		float filterMs = 0.0f;
+		float modulateMs = 0.0f;
+
+		float getTotalMs() const { return reprojectMs + filterMs + modulateMs; }
+	};
+}
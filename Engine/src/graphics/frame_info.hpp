@@ -17,12 +17,15 @@ namespace PXTEngine {
         glm::mat4 projection{1.f};
         glm::mat4 view{1.f};
         glm::mat4 inverseView{1.f};
+        glm::mat4 previousProjectionView{1.f}; // projection * view of the previous frame
         glm::vec4 ambientLightColor{0.67f, 0.85f, 0.9f, .02f};
         PointLight pointLights[MAX_LIGHTS];
         int numLights;
         uint32_t frameCount;
         uint32_t ptAccumulationCount;
-        bool accumulationEnabled;
+        VkBool32 accumulationEnabled;     // GLSL bools are 4 bytes, a C++ bool would leave 3 bytes undefined
+        float convergenceThreshold;       // relative error under which a pixel stops being sampled
+        VkBool32 adaptiveSamplingEnabled;
     };
 
     struct FrameInfo {
@@ -0,0 +1,171 @@
+#include "graphics/memory/geometry_arena.hpp"
+
+#include "graphics/context/context.hpp"
+#include "graphics/resources/vk_buffer.hpp"
+#include "graphics/swap_chain.hpp"
+
+namespace PXTEngine {
+
+	GeometryArena::GeometryArena(Context& context, const uint32_t vertexCapacity, const uint32_t indexCapacity)
+		: m_context(context), m_ranges(vertexCapacity, indexCapacity, SwapChain::MAX_FRAMES_IN_FLIGHT) {
+		createBuffers(vertexCapacity, indexCapacity);
+	}
+
+	GeometryArena::~GeometryArena() = default;
+
+	void GeometryArena::createBuffers(const uint32_t vertexCapacity, const uint32_t indexCapacity) {
+		m_vertexBuffer = createUnique<VulkanBuffer>(
+			m_context,
+			sizeof(Mesh::Vertex),
+			vertexCapacity,
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |                                  // read by the hit shaders
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT |                                    // to read the geometry back and to compact
+			VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |                           // to create BLASes
+			VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, // to create BLASes
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+		);
+
+		m_indexBuffer = createUnique<VulkanBuffer>(
+			m_context,
+			sizeof(uint32_t),
+			indexCapacity,
+			VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+			VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+			VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+		);
+	}
+
+	GeometryArena::Handle GeometryArena::allocate(std::span<const Mesh::Vertex> vertices, std::span<const uint32_t> indices) {
+		const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+		const uint32_t indexCount = static_cast<uint32_t>(indices.size());
+
+		Handle handle = m_ranges.allocate(vertexCount, indexCount);
+
+		if (handle == INVALID_HANDLE) {
+			uint64_t vertexCapacity;
+			uint64_t indexCapacity;
+			m_ranges.calculateGrownCapacities(vertexCount, indexCount, vertexCapacity, indexCapacity);
+
+			if (vertexCapacity > std::numeric_limits<uint32_t>::max() || indexCapacity > std::numeric_limits<uint32_t>::max()) {
+				throw std::runtime_error("geometry arena out of memory!");
+			}
+
+			reallocate(static_cast<uint32_t>(vertexCapacity), static_cast<uint32_t>(indexCapacity));
+
+			handle = m_ranges.allocate(vertexCount, indexCount);
+			PXT_ASSERT(handle != INVALID_HANDLE, "The reallocated geometry arena must fit the mesh");
+		}
+
+		const GeometryRange& range = m_ranges.getRange(handle);
+
+		Uploader& uploader = m_context.getUploader();
+		uploader.copyToBuffer(m_vertexBuffer->getBuffer(), vertices.data(), sizeof(Mesh::Vertex) * vertexCount,
+			sizeof(Mesh::Vertex) * range.firstVertex);
+		uploader.copyToBuffer(m_indexBuffer->getBuffer(), indices.data(), sizeof(uint32_t) * indexCount,
+			sizeof(uint32_t) * range.firstIndex);
+
+		return handle;
+	}
+
+	void GeometryArena::free(const Handle handle) {
+		m_ranges.free(handle);
+	}
+
+	const GeometryRange& GeometryArena::getRange(const Handle handle) const {
+		return m_ranges.getRange(handle);
+	}
+
+	void GeometryArena::advanceFrame() {
+		m_ranges.advanceFrame();
+	}
+
+	void GeometryArena::compact() {
+		reallocate(m_ranges.getVertexCapacity(), m_ranges.getIndexCapacity());
+	}
+
+	void GeometryArena::reallocate(const uint32_t vertexCapacity, const uint32_t indexCapacity) {
+		PXT_PROFILE_FN();
+
+		// the frames in flight read the old buffers, and nothing uses the retired ranges anymore after this
+		vkDeviceWaitIdle(m_context.getDevice());
+
+		Unique<VulkanBuffer> oldVertexBuffer = std::move(m_vertexBuffer);
+		Unique<VulkanBuffer> oldIndexBuffer = std::move(m_indexBuffer);
+
+		createBuffers(vertexCapacity, indexCapacity);
+
+		std::vector<GeometryMove> moves;
+		m_ranges.repack(vertexCapacity, indexCapacity, moves);
+
+		std::vector<VkBufferCopy> vertexCopies;
+		std::vector<VkBufferCopy> indexCopies;
+
+		for (const GeometryMove& move : moves) {
+			vertexCopies.push_back({
+				sizeof(Mesh::Vertex) * move.source.firstVertex,
+				sizeof(Mesh::Vertex) * move.destination.firstVertex,
+				sizeof(Mesh::Vertex) * move.source.vertexCount
+			});
+			indexCopies.push_back({
+				sizeof(uint32_t) * move.source.firstIndex,
+				sizeof(uint32_t) * move.destination.firstIndex,
+				sizeof(uint32_t) * move.source.indexCount
+			});
+		}
+
+		if (!vertexCopies.empty()) {
+			// the single time commands are submitted after the pending uploads to the old buffers
+			VkCommandBuffer commandBuffer = m_context.beginSingleTimeCommands();
+
+			vkCmdCopyBuffer(commandBuffer, oldVertexBuffer->getBuffer(), m_vertexBuffer->getBuffer(),
+				static_cast<uint32_t>(vertexCopies.size()), vertexCopies.data());
+			vkCmdCopyBuffer(commandBuffer, oldIndexBuffer->getBuffer(), m_indexBuffer->getBuffer(),
+				static_cast<uint32_t>(indexCopies.size()), indexCopies.data());
+
+			m_context.endSingleTimeCommands(commandBuffer);
+		}
+
+		m_generation++;
+
+		PXT_INFO("Geometry arena reallocated: {} vertices, {} indices, {} meshes",
+			vertexCapacity, indexCapacity, vertexCopies.size());
+	}
+
+	void GeometryArena::bind(VkCommandBuffer commandBuffer) const {
+		VkBuffer buffers[] = { m_vertexBuffer->getBuffer() };
+		VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+
+		vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+	}
+
+	VkBuffer GeometryArena::getVertexBuffer() const {
+		return m_vertexBuffer->getBuffer();
+	}
+
+	VkBuffer GeometryArena::getIndexBuffer() const {
+		return m_indexBuffer->getBuffer();
+	}
+
+	VkDeviceAddress GeometryArena::getVertexBufferDeviceAddress() const {
+		return m_vertexBuffer->getDeviceAddress();
+	}
+
+	VkDeviceAddress GeometryArena::getIndexBufferDeviceAddress() const {
+		return m_indexBuffer->getDeviceAddress();
+	}
+
+	VkDescriptorBufferInfo GeometryArena::getVertexDescriptorInfo() const {
+		return m_vertexBuffer->descriptorInfo();
+	}
+
+	VkDescriptorBufferInfo GeometryArena::getIndexDescriptorInfo() const {
+		return m_indexBuffer->descriptorInfo();
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "graphics/memory/geometry_range_allocator.hpp"
+#include "resources/types/mesh.hpp"
+
+namespace PXTEngine {
+
+	class Context;
+	class VulkanBuffer;
+
+	/**
+	 * @class GeometryArena
+	 *
+	 * @brief A single device local vertex buffer and index buffer shared by every mesh.
+	 *
+	 * Meshes are ranges of the two buffers, sub-allocated by a GeometryRangeAllocator (in vertices and
+	 * in indices), so a pass binds the buffers once and draws any mesh by offset, and the ray tracing
+	 * shaders read any mesh from the same two storage buffers.
+	 *
+	 * Freed ranges are retired for the frames in flight before they can be reused, see advanceFrame.
+	 * When a range doesn't fit, the arena is reallocated with a bigger capacity, which also compacts
+	 * it: the live ranges are copied one after the other at the start of the new buffers. The ranges
+	 * move, so they are looked up by handle, and getGeneration changes to tell the users to refresh
+	 * the descriptors and the offsets they keep.
+	 *
+	 * It is meant to be used from the main thread, outside of the recording of a frame.
+	 */
+	class GeometryArena {
+	public:
+		using Handle = GeometryRangeAllocator::Handle;
+		static constexpr Handle INVALID_HANDLE = GeometryRangeAllocator::INVALID_HANDLE;
+
+		static constexpr uint32_t DEFAULT_VERTEX_CAPACITY = 1u << 20; // 64 MiB of vertices
+		static constexpr uint32_t DEFAULT_INDEX_CAPACITY = 1u << 22;  // 16 MiB of indices
+
+		GeometryArena(Context& context, uint32_t vertexCapacity = DEFAULT_VERTEX_CAPACITY,
+			uint32_t indexCapacity = DEFAULT_INDEX_CAPACITY);
+		~GeometryArena();
+
+		GeometryArena(const GeometryArena&) = delete;
+		GeometryArena& operator=(const GeometryArena&) = delete;
+
+		/**
+		 * @brief Allocates the ranges of a mesh and uploads its geometry, growing the arena if needed.
+		 *
+		 * @param vertices The vertices of the mesh.
+		 * @param indices The indices of the mesh, relative to its first vertex.
+		 *
+		 * @return The handle of the ranges, to be passed back to free.
+		 */
+		Handle allocate(std::span<const Mesh::Vertex> vertices, std::span<const uint32_t> indices);
+
+		/**
+		 * @brief Retires the ranges of a mesh, they are reused once the frames in flight are over.
+		 */
+		void free(Handle handle);
+
+		/**
+		 * @brief Returns the current ranges of a mesh, they change when the arena is compacted.
+		 */
+		const GeometryRange& getRange(Handle handle) const;
+
+		/**
+		 * @brief Counts a frame, giving back the ranges retired before the frames in flight.
+		 */
+		void advanceFrame();
+
+		/**
+		 * @brief Packs the live ranges at the start of the buffers, waiting for the device to be idle.
+		 */
+		void compact();
+
+		/**
+		 * @brief Binds the vertex and the index buffer.
+		 */
+		void bind(VkCommandBuffer commandBuffer) const;
+
+		VkBuffer getVertexBuffer() const;
+		VkBuffer getIndexBuffer() const;
+		VkDeviceAddress getVertexBufferDeviceAddress() const;
+		VkDeviceAddress getIndexBufferDeviceAddress() const;
+		VkDescriptorBufferInfo getVertexDescriptorInfo() const;
+		VkDescriptorBufferInfo getIndexDescriptorInfo() const;
+
+		/**
+		 * @brief Changes whenever the buffers are recreated and the ranges moved.
+		 */
+		uint64_t getGeneration() const { return m_generation; }
+
+		uint32_t getVertexCapacity() const { return m_ranges.getVertexCapacity(); }
+		uint32_t getIndexCapacity() const { return m_ranges.getIndexCapacity(); }
+		uint32_t getFreeVertexCount() const { return m_ranges.getFreeVertexCount(); }
+		uint32_t getFreeIndexCount() const { return m_ranges.getFreeIndexCount(); }
+
+	private:
+		void createBuffers(uint32_t vertexCapacity, uint32_t indexCapacity);
+
+		/**
+		 * @brief Moves the live ranges to new buffers with the given capacities.
+		 */
+		void reallocate(uint32_t vertexCapacity, uint32_t indexCapacity);
+
+		Context& m_context;
+
+		Unique<VulkanBuffer> m_vertexBuffer = nullptr;
+		Unique<VulkanBuffer> m_indexBuffer = nullptr;
+
+		GeometryRangeAllocator m_ranges;
+
+		uint64_t m_generation = 0;
+	};
+}
@@ -0,0 +1,131 @@
+#include "graphics/memory/geometry_range_allocator.hpp"
+
+namespace PXTEngine {
+
+	GeometryRangeAllocator::GeometryRangeAllocator(const uint32_t vertexCapacity, const uint32_t indexCapacity,
+		const uint32_t framesInFlight)
+		: m_vertexAllocator(vertexCapacity), m_indexAllocator(indexCapacity), m_framesInFlight(framesInFlight) {}
+
+	GeometryRangeAllocator::Handle GeometryRangeAllocator::allocate(const uint32_t vertexCount, const uint32_t indexCount) {
+		PXT_ASSERT(vertexCount > 0 && indexCount > 0, "A mesh needs vertices and indices");
+
+		const TlsfAllocator::Allocation vertexAllocation = m_vertexAllocator.allocate(vertexCount);
+		const TlsfAllocator::Allocation indexAllocation = m_indexAllocator.allocate(indexCount);
+
+		if (!vertexAllocation.isValid() || !indexAllocation.isValid()) {
+			if (vertexAllocation.isValid()) m_vertexAllocator.free(vertexAllocation);
+			if (indexAllocation.isValid()) m_indexAllocator.free(indexAllocation);
+			return INVALID_HANDLE;
+		}
+
+		Handle handle;
+		if (!m_unusedHandles.empty()) {
+			handle = m_unusedHandles.back();
+			m_unusedHandles.pop_back();
+		} else {
+			handle = static_cast<Handle>(m_entries.size());
+			m_entries.emplace_back();
+		}
+
+		Entry& entry = m_entries[handle];
+		entry.range.firstVertex = static_cast<uint32_t>(vertexAllocation.offset);
+		entry.range.vertexCount = vertexCount;
+		entry.range.firstIndex = static_cast<uint32_t>(indexAllocation.offset);
+		entry.range.indexCount = indexCount;
+		entry.vertexAllocation = vertexAllocation;
+		entry.indexAllocation = indexAllocation;
+		entry.isLive = true;
+
+		m_liveCount++;
+
+		return handle;
+	}
+
+	void GeometryRangeAllocator::free(const Handle handle) {
+		PXT_ASSERT(handle < m_entries.size() && m_entries[handle].isLive, "Invalid or already freed geometry handle");
+
+		// a frame in flight may still draw the mesh, its ranges can't be overwritten yet
+		m_entries[handle].isLive = false;
+		m_retiredHandles.push_back({ handle, m_frame });
+		m_liveCount--;
+	}
+
+	void GeometryRangeAllocator::release(const Handle handle) {
+		Entry& entry = m_entries[handle];
+		m_vertexAllocator.free(entry.vertexAllocation);
+		m_indexAllocator.free(entry.indexAllocation);
+		entry = {};
+
+		m_unusedHandles.push_back(handle);
+	}
+
+	const GeometryRange& GeometryRangeAllocator::getRange(const Handle handle) const {
+		PXT_ASSERT(handle < m_entries.size(), "Invalid geometry handle");
+		return m_entries[handle].range;
+	}
+
+	void GeometryRangeAllocator::advanceFrame() {
+		m_frame++;
+
+		while (!m_retiredHandles.empty() && m_retiredHandles.front().frame + m_framesInFlight < m_frame) {
+			release(m_retiredHandles.front().handle);
+			m_retiredHandles.pop_front();
+		}
+	}
+
+	void GeometryRangeAllocator::calculateGrownCapacities(const uint32_t vertexCount, const uint32_t indexCount,
+		uint64_t& vertexCapacity, uint64_t& indexCapacity) {
+		// the side that can't fit the mesh doubles, the other one keeps its capacity
+		const TlsfAllocator::Allocation vertexProbe = m_vertexAllocator.allocate(vertexCount);
+		const TlsfAllocator::Allocation indexProbe = m_indexAllocator.allocate(indexCount);
+
+		vertexCapacity = vertexProbe.isValid() ? m_vertexAllocator.getSize() : 2 * m_vertexAllocator.getSize();
+		indexCapacity = indexProbe.isValid() ? m_indexAllocator.getSize() : 2 * m_indexAllocator.getSize();
+
+		if (vertexProbe.isValid()) m_vertexAllocator.free(vertexProbe);
+		if (indexProbe.isValid()) m_indexAllocator.free(indexProbe);
+
+		// the repack drops the retired ranges and packs the live ones, so the capacities only have to fit them and the mesh
+		uint64_t liveVertexCount = vertexCount;
+		uint64_t liveIndexCount = indexCount;
+		for (const Entry& entry : m_entries) {
+			if (!entry.isLive) continue;
+			liveVertexCount += entry.range.vertexCount;
+			liveIndexCount += entry.range.indexCount;
+		}
+
+		while (vertexCapacity < liveVertexCount) vertexCapacity *= 2;
+		while (indexCapacity < liveIndexCount) indexCapacity *= 2;
+	}
+
+	void GeometryRangeAllocator::repack(const uint32_t vertexCapacity, const uint32_t indexCapacity,
+		std::vector<GeometryMove>& moves) {
+		while (!m_retiredHandles.empty()) {
+			release(m_retiredHandles.front().handle);
+			m_retiredHandles.pop_front();
+		}
+
+		// the new allocators are empty, the ranges are allocated one after the other
+		m_vertexAllocator = TlsfAllocator(vertexCapacity);
+		m_indexAllocator = TlsfAllocator(indexCapacity);
+
+		moves.clear();
+
+		for (Entry& entry : m_entries) {
+			if (!entry.isLive) continue;
+
+			entry.vertexAllocation = m_vertexAllocator.allocate(entry.range.vertexCount);
+			entry.indexAllocation = m_indexAllocator.allocate(entry.range.indexCount);
+
+			PXT_ASSERT(entry.vertexAllocation.isValid() && entry.indexAllocation.isValid(),
+				"The repacked geometry ranges must fit the new capacities");
+
+			GeometryMove& move = moves.emplace_back();
+			move.source = entry.range;
+
+			entry.range.firstVertex = static_cast<uint32_t>(entry.vertexAllocation.offset);
+			entry.range.firstIndex = static_cast<uint32_t>(entry.indexAllocation.offset);
+			move.destination = entry.range;
+		}
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "graphics/memory/tlsf_allocator.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @struct GeometryRange
+	 *
+	 * @brief Where the vertices and the indices of a mesh are in the GeometryArena.
+	 *
+	 * The indices are relative to firstVertex, as the vertexOffset of an indexed draw.
+	 */
+	struct GeometryRange {
+		uint32_t firstVertex = 0;
+		uint32_t vertexCount = 0;
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0;
+	};
+
+	/**
+	 * @struct GeometryMove
+	 *
+	 * @brief A live range moved by GeometryRangeAllocator::repack, the data must be copied from source to destination.
+	 */
+	struct GeometryMove {
+		GeometryRange source;
+		GeometryRange destination;
+	};
+
+	/**
+	 * @class GeometryRangeAllocator
+	 *
+	 * @brief The bookkeeping of the GeometryArena: the vertex and index ranges of every mesh, without the buffers.
+	 *
+	 * The ranges are sub-allocated with a TlsfAllocator each, counted in elements, and looked up by handle
+	 * since repack moves them. Freed ranges are retired for the frames in flight before they can be reused,
+	 * see advanceFrame.
+	 */
+	class GeometryRangeAllocator {
+	public:
+		using Handle = uint32_t;
+		static constexpr Handle INVALID_HANDLE = std::numeric_limits<Handle>::max();
+
+		/**
+		 * @param framesInFlight The number of frames that may still read a range after it is freed.
+		 */
+		GeometryRangeAllocator(uint32_t vertexCapacity, uint32_t indexCapacity, uint32_t framesInFlight);
+
+		/**
+		 * @brief Allocates the ranges of a mesh.
+		 *
+		 * @return The handle of the ranges, INVALID_HANDLE if they don't fit: see calculateGrownCapacities.
+		 */
+		Handle allocate(uint32_t vertexCount, uint32_t indexCount);
+
+		/**
+		 * @brief Retires the ranges of a mesh, they are reused once the frames in flight are over.
+		 */
+		void free(Handle handle);
+
+		/**
+		 * @brief Returns the current ranges of a mesh, they change when the ranges are repacked.
+		 */
+		const GeometryRange& getRange(Handle handle) const;
+
+		/**
+		 * @brief Counts a frame, giving back the ranges retired before the frames in flight.
+		 */
+		void advanceFrame();
+
+		/**
+		 * @brief Computes the capacities to repack to, so that a mesh that didn't fit does.
+		 *
+		 * The full side at least doubles, so that a growing scene doesn't repack at every mesh, and both
+		 * sides fit the live ranges and the mesh once packed.
+		 */
+		void calculateGrownCapacities(uint32_t vertexCount, uint32_t indexCount,
+			uint64_t& vertexCapacity, uint64_t& indexCapacity);
+
+		/**
+		 * @brief Gives back every retired range and packs the live ones one after the other from the start.
+		 *
+		 * Nothing may read the ranges anymore, the caller waits for the frames in flight first.
+		 *
+		 * @param moves Filled with the ranges that moved, in handle order.
+		 */
+		void repack(uint32_t vertexCapacity, uint32_t indexCapacity, std::vector<GeometryMove>& moves);
+
+		uint32_t getVertexCapacity() const { return static_cast<uint32_t>(m_vertexAllocator.getSize()); }
+		uint32_t getIndexCapacity() const { return static_cast<uint32_t>(m_indexAllocator.getSize()); }
+		uint32_t getFreeVertexCount() const { return static_cast<uint32_t>(m_vertexAllocator.getFreeSize()); }
+		uint32_t getFreeIndexCount() const { return static_cast<uint32_t>(m_indexAllocator.getFreeSize()); }
+		uint32_t getLiveCount() const { return m_liveCount; }
+		uint32_t getRetiredCount() const { return static_cast<uint32_t>(m_retiredHandles.size()); }
+
+	private:
+		struct Entry {
+			GeometryRange range;
+			TlsfAllocator::Allocation vertexAllocation;
+			TlsfAllocator::Allocation indexAllocation;
+			bool isLive = false;
+		};
+
+		struct RetiredHandle {
+			Handle handle;
+			uint64_t frame;
+		};
+
+		void release(Handle handle);
+
+		TlsfAllocator m_vertexAllocator;
+		TlsfAllocator m_indexAllocator;
+		uint32_t m_framesInFlight;
+
+		std::vector<Entry> m_entries;
+		std::vector<Handle> m_unusedHandles;
+		std::deque<RetiredHandle> m_retiredHandles;
+		uint32_t m_liveCount = 0;
+
+		uint64_t m_frame = 0;
+	};
+}
@@ -0,0 +1,317 @@
+#include "graphics/memory/gpu_allocator.hpp"
+
+namespace PXTEngine {
+
+    struct GpuMemoryBlock {
+        VkDeviceMemory memory;
+        VkDeviceSize size;
+        void* mapped;
+        uint32_t poolIndex;
+        TlsfAllocator allocator;
+
+        GpuMemoryBlock(VkDeviceMemory memory, const VkDeviceSize size, void* mapped, const uint32_t poolIndex)
+            : memory(memory), size(size), mapped(mapped), poolIndex(poolIndex), allocator(size) {}
+    };
+
+    namespace {
+        /**
+         * @brief Requirements with a VkMemoryDedicatedRequirements chained, filled by the backend.
+         */
+        struct ResourceRequirements {
+            VkMemoryDedicatedRequirements dedicated{};
+            VkMemoryRequirements2 requirements{};
+
+            ResourceRequirements() {
+                dedicated.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+                requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+                requirements.pNext = &dedicated;
+            }
+
+            ResourceRequirements(const ResourceRequirements&) = delete;
+            ResourceRequirements& operator=(const ResourceRequirements&) = delete;
+        };
+    }
+
+    GpuAllocator::GpuAllocator(Unique<GpuMemoryBackend> backend)
+        : m_backend(std::move(backend)), m_memoryProperties(m_backend->getMemoryProperties()),
+        m_nonCoherentAtomSize(m_backend->getNonCoherentAtomSize()) {}
+
+    GpuAllocator::~GpuAllocator() {
+        if (m_stats.allocationCount > 0) {
+            PXT_WARN("GpuAllocator destroyed with {} allocations still alive", m_stats.allocationCount);
+        }
+
+        for (auto& pool : m_pools) {
+            for (auto& block : pool) {
+                m_backend->freeMemory(block->memory);
+            }
+        }
+
+        for (VkDeviceMemory memory : m_dedicatedAllocations) {
+            m_backend->freeMemory(memory);
+        }
+    }
+
+    GpuAllocation GpuAllocator::allocateBuffer(VkBuffer buffer, const VkMemoryPropertyFlags properties) {
+        ResourceRequirements resource;
+        m_backend->getBufferMemoryRequirements(buffer, resource.requirements);
+
+        VkMemoryDedicatedAllocateInfo dedicatedInfo{};
+        dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+        dedicatedInfo.buffer = buffer;
+
+        GpuAllocation allocation = allocate(resource.requirements, properties, ResourceKind::Buffer, dedicatedInfo);
+
+        if (m_backend->bindBufferMemory(buffer, allocation.memory, allocation.offset) != VK_SUCCESS) {
+            free(allocation);
+            throw std::runtime_error("failed to bind buffer memory!");
+        }
+
+        return allocation;
+    }
+
+    GpuAllocation GpuAllocator::allocateImage(VkImage image, const VkMemoryPropertyFlags properties) {
+        ResourceRequirements resource;
+        m_backend->getImageMemoryRequirements(image, resource.requirements);
+
+        VkMemoryDedicatedAllocateInfo dedicatedInfo{};
+        dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+        dedicatedInfo.image = image;
+
+        GpuAllocation allocation = allocate(resource.requirements, properties, ResourceKind::Image, dedicatedInfo);
+
+        if (m_backend->bindImageMemory(image, allocation.memory, allocation.offset) != VK_SUCCESS) {
+            free(allocation);
+            throw std::runtime_error("failed to bind image memory!");
+        }
+
+        return allocation;
+    }
+
+    void GpuAllocator::free(GpuAllocation& allocation) {
+        if (!allocation.isValid()) return;
+
+        std::lock_guard lock(m_mutex);
+
+        m_stats.allocationCount--;
+        m_stats.usedBytes -= allocation.size;
+
+        if (allocation.block == nullptr) {
+            // freeing the memory also unmaps it
+            m_backend->freeMemory(allocation.memory);
+            m_dedicatedAllocations.erase(allocation.memory);
+
+            m_stats.dedicatedCount--;
+            m_stats.reservedBytes -= allocation.size;
+        } else {
+            GpuMemoryBlock& block = *allocation.block;
+            block.allocator.free(allocation.range);
+
+            // keep a single empty block per pool, so that a resource recreated every frame doesn't hit the driver
+            if (block.allocator.isEmpty()) {
+                auto& pool = m_pools[block.poolIndex];
+
+                const bool hasOtherEmptyBlock = std::any_of(pool.begin(), pool.end(), [&](const auto& other) {
+                    return other.get() != &block && other->allocator.isEmpty();
+                });
+
+                if (hasOtherEmptyBlock) {
+                    destroyBlock(block);
+                }
+            }
+        }
+
+        allocation = GpuAllocation{};
+    }
+
+    VkResult GpuAllocator::flush(const GpuAllocation& allocation, const VkDeviceSize offset, const VkDeviceSize size) {
+        if (isCoherent(allocation)) return VK_SUCCESS;
+
+        return m_backend->flushMappedMemoryRange(getMappedRange(allocation, offset, size));
+    }
+
+    VkResult GpuAllocator::invalidate(const GpuAllocation& allocation, const VkDeviceSize offset, const VkDeviceSize size) {
+        if (isCoherent(allocation)) return VK_SUCCESS;
+
+        return m_backend->invalidateMappedMemoryRange(getMappedRange(allocation, offset, size));
+    }
+
+    uint32_t GpuAllocator::findMemoryType(const uint32_t typeFilter, const VkMemoryPropertyFlags properties) const {
+        for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++) {
+            if ((typeFilter & (1 << i)) &&
+                (m_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+                return i;
+            }
+        }
+
+        throw std::runtime_error("failed to find suitable memory type!");
+    }
+
+    GpuAllocator::Stats GpuAllocator::getStats() {
+        std::lock_guard lock(m_mutex);
+        return m_stats;
+    }
+
+    GpuAllocation GpuAllocator::allocate(const VkMemoryRequirements2& resourceRequirements,
+        const VkMemoryPropertyFlags properties, const ResourceKind kind, const VkMemoryDedicatedAllocateInfo& dedicatedInfo) {
+
+        const VkMemoryRequirements& requirements = resourceRequirements.memoryRequirements;
+        const auto* dedicatedRequirements = static_cast<const VkMemoryDedicatedRequirements*>(resourceRequirements.pNext);
+
+        const uint32_t memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+        const VkDeviceSize blockSize = getBlockSize(memoryType);
+
+        // the driver can place a dedicated resource better (e.g. render targets with compression metadata)
+        const bool prefersDedicated = dedicatedRequirements->prefersDedicatedAllocation ||
+            dedicatedRequirements->requiresDedicatedAllocation;
+
+        if (prefersDedicated || requirements.size > blockSize / 2) {
+            return allocateDedicated(requirements, memoryType, kind, dedicatedInfo);
+        }
+
+        std::lock_guard lock(m_mutex);
+
+        const uint32_t poolIndex = memoryType * 2 + static_cast<uint32_t>(kind);
+        auto& pool = m_pools[poolIndex];
+
+        TlsfAllocator::Allocation range{};
+        GpuMemoryBlock* block = nullptr;
+
+        for (auto& candidate : pool) {
+            range = candidate->allocator.allocate(requirements.size, requirements.alignment);
+
+            if (range.isValid()) {
+                block = candidate.get();
+                break;
+            }
+        }
+
+        if (block == nullptr) {
+            void* mapped = nullptr;
+            VkDeviceMemory memory = allocateMemory(blockSize, memoryType, kind, nullptr, &mapped);
+
+            pool.push_back(createUnique<GpuMemoryBlock>(memory, blockSize, mapped, poolIndex));
+            m_stats.blockCount++;
+            m_stats.reservedBytes += blockSize;
+
+            block = pool.back().get();
+            range = block->allocator.allocate(requirements.size, requirements.alignment);
+
+            PXT_ASSERT(range.isValid(), "A new memory block must fit the allocation");
+        }
+
+        m_stats.allocationCount++;
+        m_stats.usedBytes += range.size;
+
+        GpuAllocation allocation{};
+        allocation.memory = block->memory;
+        allocation.offset = range.offset;
+        allocation.size = range.size;
+        allocation.mapped = block->mapped ? static_cast<uint8_t*>(block->mapped) + range.offset : nullptr;
+        allocation.memoryType = memoryType;
+        allocation.block = block;
+        allocation.range = range;
+
+        return allocation;
+    }
+
+    GpuAllocation GpuAllocator::allocateDedicated(const VkMemoryRequirements& requirements, const uint32_t memoryType,
+        const ResourceKind kind, const VkMemoryDedicatedAllocateInfo& dedicatedInfo) {
+
+        std::lock_guard lock(m_mutex);
+
+        GpuAllocation allocation{};
+        allocation.memory = allocateMemory(requirements.size, memoryType, kind, &dedicatedInfo, &allocation.mapped);
+        allocation.offset = 0;
+        allocation.size = requirements.size;
+        allocation.memoryType = memoryType;
+
+        m_dedicatedAllocations.insert(allocation.memory);
+
+        m_stats.dedicatedCount++;
+        m_stats.allocationCount++;
+        m_stats.reservedBytes += requirements.size;
+        m_stats.usedBytes += requirements.size;
+
+        return allocation;
+    }
+
+    VkDeviceMemory GpuAllocator::allocateMemory(const VkDeviceSize size, const uint32_t memoryType,
+        const ResourceKind kind, const VkMemoryDedicatedAllocateInfo* dedicatedInfo, void** mapped) {
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.pNext = dedicatedInfo;
+        allocInfo.allocationSize = size;
+        allocInfo.memoryTypeIndex = memoryType;
+
+        // any buffer sharing the block may need its device address (acceleration structures, SBT, geometry)
+        VkMemoryAllocateFlagsInfo flagsInfo{};
+        if (kind == ResourceKind::Buffer) {
+            flagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+            flagsInfo.pNext = allocInfo.pNext;
+            flagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+            allocInfo.pNext = &flagsInfo;
+        }
+
+        VkDeviceMemory memory;
+        if (m_backend->allocateMemory(allocInfo, memory) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate device memory!");
+        }
+
+        *mapped = nullptr;
+
+        if (m_memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+            if (m_backend->mapMemory(memory, mapped) != VK_SUCCESS) {
+                m_backend->freeMemory(memory);
+                throw std::runtime_error("failed to map device memory!");
+            }
+        }
+
+        return memory;
+    }
+
+    VkDeviceSize GpuAllocator::getBlockSize(const uint32_t memoryType) const {
+        const uint32_t heapIndex = m_memoryProperties.memoryTypes[memoryType].heapIndex;
+        const VkDeviceSize heapSize = m_memoryProperties.memoryHeaps[heapIndex].size;
+
+        // small heaps (e.g. the 256MB host visible device local one) get smaller blocks
+        return std::min(DEFAULT_BLOCK_SIZE, heapSize / 8);
+    }
+
+    void GpuAllocator::destroyBlock(GpuMemoryBlock& block) {
+        auto& pool = m_pools[block.poolIndex];
+
+        m_stats.blockCount--;
+        m_stats.reservedBytes -= block.size;
+
+        m_backend->freeMemory(block.memory);
+
+        std::erase_if(pool, [&](const auto& candidate) { return candidate.get() == &block; });
+    }
+
+    VkMappedMemoryRange GpuAllocator::getMappedRange(const GpuAllocation& allocation, const VkDeviceSize offset,
+        const VkDeviceSize size) const {
+
+        const VkDeviceSize memorySize = allocation.block ? allocation.block->size : allocation.size;
+        const VkDeviceSize rangeSize = size == VK_WHOLE_SIZE ? allocation.size - offset : size;
+
+        // ranges must be aligned to nonCoherentAtomSize or end with the memory
+        const VkDeviceSize begin = (allocation.offset + offset) / m_nonCoherentAtomSize * m_nonCoherentAtomSize;
+        const VkDeviceSize end = std::min(
+            (allocation.offset + offset + rangeSize + m_nonCoherentAtomSize - 1) / m_nonCoherentAtomSize * m_nonCoherentAtomSize,
+            memorySize);
+
+        VkMappedMemoryRange range{};
+        range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+        range.memory = allocation.memory;
+        range.offset = begin;
+        range.size = end - begin;
+
+        return range;
+    }
+
+    bool GpuAllocator::isCoherent(const GpuAllocation& allocation) const {
+        return m_memoryProperties.memoryTypes[allocation.memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    }
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "graphics/memory/gpu_memory_backend.hpp"
+#include "graphics/memory/tlsf_allocator.hpp"
+
+namespace PXTEngine {
+
+	struct GpuMemoryBlock;
+
+	/**
+	 * @struct GpuAllocation
+	 *
+	 * @brief A range of device memory owned by a buffer or an image.
+	 */
+	struct GpuAllocation {
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0; // offset of the range in memory, to be used when binding
+		VkDeviceSize size = 0;
+		void* mapped = nullptr;  // pointer to the first byte of the range, only for host visible memory
+		uint32_t memoryType = 0;
+
+		// the block the range comes from, null for dedicated allocations
+		GpuMemoryBlock* block = nullptr;
+		TlsfAllocator::Allocation range{};
+
+		bool isValid() const { return memory != VK_NULL_HANDLE; }
+	};
+
+	/**
+	 * @class GpuAllocator
+	 *
+	 * @brief Sub-allocates buffers and images from big device memory blocks.
+	 *
+	 * Every memory type has two pools of blocks, one for buffers and one for images, so that
+	 * linear and optimal resources never share a block and bufferImageGranularity never has
+	 * to be taken into account. Ranges inside a block are managed by a TlsfAllocator.
+	 * Resources bigger than half a block, and the ones the driver wants alone in their memory
+	 * (VkMemoryDedicatedRequirements), get their own dedicated vkAllocateMemory, with a
+	 * VkMemoryDedicatedAllocateInfo naming the resource.
+	 *
+	 * Host visible blocks are mapped once when they are created and stay mapped, as a memory
+	 * object can't be mapped twice by the resources sharing it.
+	 */
+	class GpuAllocator {
+	public:
+		/**
+		 * @struct Stats
+		 *
+		 * @brief Memory usage summary, for debugging.
+		 */
+		struct Stats {
+			uint32_t blockCount = 0;
+			uint32_t dedicatedCount = 0;
+			uint32_t allocationCount = 0;
+			VkDeviceSize reservedBytes = 0; // memory allocated from the driver
+			VkDeviceSize usedBytes = 0;     // memory handed out to resources
+		};
+
+		/**
+		 * @param backend The device calls, a VulkanMemoryBackend outside of the tests.
+		 */
+		explicit GpuAllocator(Unique<GpuMemoryBackend> backend);
+		~GpuAllocator();
+
+		GpuAllocator(const GpuAllocator&) = delete;
+		GpuAllocator& operator=(const GpuAllocator&) = delete;
+
+		/**
+		 * @brief Allocates memory for a buffer and binds it.
+		 */
+		GpuAllocation allocateBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties);
+
+		/**
+		 * @brief Allocates memory for an image and binds it.
+		 */
+		GpuAllocation allocateImage(VkImage image, VkMemoryPropertyFlags properties);
+
+		/**
+		 * @brief Gives the memory of an allocation back, the allocation is reset.
+		 */
+		void free(GpuAllocation& allocation);
+
+		/**
+		 * @brief Flushes a range of a host visible allocation, does nothing on coherent memory.
+		 *
+		 * @param offset Offset from the beginning of the allocation.
+		 * @param size Size of the range, VK_WHOLE_SIZE for the rest of the allocation.
+		 */
+		VkResult flush(const GpuAllocation& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+		/**
+		 * @brief Invalidates a range of a host visible allocation, does nothing on coherent memory.
+		 *
+		 * @param offset Offset from the beginning of the allocation.
+		 * @param size Size of the range, VK_WHOLE_SIZE for the rest of the allocation.
+		 */
+		VkResult invalidate(const GpuAllocation& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+		/**
+		 * @brief Finds a memory type allowed by typeFilter that has all the required properties.
+		 */
+		uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+		Stats getStats();
+
+	private:
+		enum class ResourceKind : uint32_t {
+			Buffer = 0,
+			Image = 1
+		};
+
+		static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+		/**
+		 * @param requirements The requirements of the resource, with a VkMemoryDedicatedRequirements chained.
+		 * @param dedicatedInfo The resource, chained to the allocation if it gets dedicated memory.
+		 */
+		GpuAllocation allocate(const VkMemoryRequirements2& requirements, VkMemoryPropertyFlags properties,
+			ResourceKind kind, const VkMemoryDedicatedAllocateInfo& dedicatedInfo);
+
+		GpuAllocation allocateDedicated(const VkMemoryRequirements& requirements, uint32_t memoryType,
+			ResourceKind kind, const VkMemoryDedicatedAllocateInfo& dedicatedInfo);
+
+		/**
+		 * @param dedicatedInfo Chained to the allocation, null for the blocks.
+		 */
+		VkDeviceMemory allocateMemory(VkDeviceSize size, uint32_t memoryType, ResourceKind kind,
+			const VkMemoryDedicatedAllocateInfo* dedicatedInfo, void** mapped);
+
+		VkDeviceSize getBlockSize(uint32_t memoryType) const;
+
+		void destroyBlock(GpuMemoryBlock& block);
+
+		VkMappedMemoryRange getMappedRange(const GpuAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) const;
+
+		bool isCoherent(const GpuAllocation& allocation) const;
+
+		Unique<GpuMemoryBackend> m_backend;
+		const VkPhysicalDeviceMemoryProperties& m_memoryProperties;
+		VkDeviceSize m_nonCoherentAtomSize = 1;
+
+		std::mutex m_mutex;
+
+		// one pool per memory type and resource kind
+		std::array<std::vector<Unique<GpuMemoryBlock>>, VK_MAX_MEMORY_TYPES * 2> m_pools;
+		std::unordered_set<VkDeviceMemory> m_dedicatedAllocations;
+
+		Stats m_stats{};
+	};
+}
@@ -0,0 +1,56 @@
+#include "graphics/memory/gpu_memory_backend.hpp"
+
+namespace PXTEngine {
+
+    VulkanMemoryBackend::VulkanMemoryBackend(VkPhysicalDevice physicalDevice, VkDevice device) : m_device(device) {
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_memoryProperties);
+
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        m_nonCoherentAtomSize = std::max<VkDeviceSize>(1, properties.limits.nonCoherentAtomSize);
+    }
+
+    void VulkanMemoryBackend::getBufferMemoryRequirements(VkBuffer buffer, VkMemoryRequirements2& requirements) {
+        VkBufferMemoryRequirementsInfo2 info{};
+        info.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+        info.buffer = buffer;
+
+        vkGetBufferMemoryRequirements2(m_device, &info, &requirements);
+    }
+
+    void VulkanMemoryBackend::getImageMemoryRequirements(VkImage image, VkMemoryRequirements2& requirements) {
+        VkImageMemoryRequirementsInfo2 info{};
+        info.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+        info.image = image;
+
+        vkGetImageMemoryRequirements2(m_device, &info, &requirements);
+    }
+
+    VkResult VulkanMemoryBackend::allocateMemory(const VkMemoryAllocateInfo& allocateInfo, VkDeviceMemory& memory) {
+        return vkAllocateMemory(m_device, &allocateInfo, nullptr, &memory);
+    }
+
+    void VulkanMemoryBackend::freeMemory(VkDeviceMemory memory) {
+        vkFreeMemory(m_device, memory, nullptr);
+    }
+
+    VkResult VulkanMemoryBackend::mapMemory(VkDeviceMemory memory, void** data) {
+        return vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, data);
+    }
+
+    VkResult VulkanMemoryBackend::bindBufferMemory(VkBuffer buffer, VkDeviceMemory memory, const VkDeviceSize offset) {
+        return vkBindBufferMemory(m_device, buffer, memory, offset);
+    }
+
+    VkResult VulkanMemoryBackend::bindImageMemory(VkImage image, VkDeviceMemory memory, const VkDeviceSize offset) {
+        return vkBindImageMemory(m_device, image, memory, offset);
+    }
+
+    VkResult VulkanMemoryBackend::flushMappedMemoryRange(const VkMappedMemoryRange& range) {
+        return vkFlushMappedMemoryRanges(m_device, 1, &range);
+    }
+
+    VkResult VulkanMemoryBackend::invalidateMappedMemoryRange(const VkMappedMemoryRange& range) {
+        return vkInvalidateMappedMemoryRanges(m_device, 1, &range);
+    }
+}
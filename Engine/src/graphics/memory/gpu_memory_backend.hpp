@@ -0,0 +1,77 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class GpuMemoryBackend
+	 *
+	 * @brief The device calls made by the GpuAllocator.
+	 *
+	 * The allocator only talks to the device through this interface, so that its pools can be
+	 * exercised on the CPU with a fake device.
+	 */
+	class GpuMemoryBackend {
+	public:
+		virtual ~GpuMemoryBackend() = default;
+
+		virtual const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const = 0;
+		virtual VkDeviceSize getNonCoherentAtomSize() const = 0;
+
+		/**
+		 * @brief Queries the requirements of a buffer, with the structures chained to requirements.pNext.
+		 */
+		virtual void getBufferMemoryRequirements(VkBuffer buffer, VkMemoryRequirements2& requirements) = 0;
+
+		/**
+		 * @brief Queries the requirements of an image, with the structures chained to requirements.pNext.
+		 */
+		virtual void getImageMemoryRequirements(VkImage image, VkMemoryRequirements2& requirements) = 0;
+
+		virtual VkResult allocateMemory(const VkMemoryAllocateInfo& allocateInfo, VkDeviceMemory& memory) = 0;
+		virtual void freeMemory(VkDeviceMemory memory) = 0;
+
+		/**
+		 * @brief Maps the whole memory object.
+		 */
+		virtual VkResult mapMemory(VkDeviceMemory memory, void** data) = 0;
+
+		virtual VkResult bindBufferMemory(VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize offset) = 0;
+		virtual VkResult bindImageMemory(VkImage image, VkDeviceMemory memory, VkDeviceSize offset) = 0;
+
+		virtual VkResult flushMappedMemoryRange(const VkMappedMemoryRange& range) = 0;
+		virtual VkResult invalidateMappedMemoryRange(const VkMappedMemoryRange& range) = 0;
+	};
+
+	/**
+	 * @class VulkanMemoryBackend
+	 *
+	 * @brief GpuMemoryBackend of a Vulkan device.
+	 */
+	class VulkanMemoryBackend : public GpuMemoryBackend {
+	public:
+		VulkanMemoryBackend(VkPhysicalDevice physicalDevice, VkDevice device);
+
+		const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const override { return m_memoryProperties; }
+		VkDeviceSize getNonCoherentAtomSize() const override { return m_nonCoherentAtomSize; }
+
+		void getBufferMemoryRequirements(VkBuffer buffer, VkMemoryRequirements2& requirements) override;
+		void getImageMemoryRequirements(VkImage image, VkMemoryRequirements2& requirements) override;
+
+		VkResult allocateMemory(const VkMemoryAllocateInfo& allocateInfo, VkDeviceMemory& memory) override;
+		void freeMemory(VkDeviceMemory memory) override;
+		VkResult mapMemory(VkDeviceMemory memory, void** data) override;
+
+		VkResult bindBufferMemory(VkBuffer buffer, VkDeviceMemory memory, VkDeviceSize offset) override;
+		VkResult bindImageMemory(VkImage image, VkDeviceMemory memory, VkDeviceSize offset) override;
+
+		VkResult flushMappedMemoryRange(const VkMappedMemoryRange& range) override;
+		VkResult invalidateMappedMemoryRange(const VkMappedMemoryRange& range) override;
+
+	private:
+		VkDevice m_device;
+		VkPhysicalDeviceMemoryProperties m_memoryProperties{};
+		VkDeviceSize m_nonCoherentAtomSize = 1;
+	};
+}
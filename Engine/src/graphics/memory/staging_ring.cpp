@@ -0,0 +1,41 @@
+#include "graphics/memory/staging_ring.hpp"
+
+namespace PXTEngine {
+
+    StagingRing::StagingRing(const uint64_t capacity) : m_capacity(capacity) {
+        PXT_ASSERT(capacity > 0, "Staging ring capacity must not be zero");
+    }
+
+    uint64_t StagingRing::allocate(uint64_t size, const uint64_t alignment) {
+        PXT_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+        PXT_ASSERT(m_capacity % alignment == 0, "Staging ring capacity must be a multiple of the alignment");
+
+        size = std::max<uint64_t>(size, 1);
+
+        if (size > m_capacity) {
+            return INVALID_OFFSET;
+        }
+
+        uint64_t start = (m_head + alignment - 1) & ~(alignment - 1);
+
+        // the range would cross the end of the buffer, start again from the beginning
+        const uint64_t offset = start % m_capacity;
+        if (offset + size > m_capacity) {
+            start += m_capacity - offset;
+        }
+
+        if (start + size - m_tail > m_capacity) {
+            return INVALID_OFFSET;
+        }
+
+        m_head = start + size;
+
+        return start % m_capacity;
+    }
+
+    void StagingRing::release(const uint64_t position) {
+        PXT_ASSERT(position <= m_head, "Released a position that was never allocated");
+
+        m_tail = std::max(m_tail, position);
+    }
+}
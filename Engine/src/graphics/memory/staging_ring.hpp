@@ -0,0 +1,53 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class StagingRing
+	 *
+	 * @brief Ring allocator of ranges inside a staging buffer.
+	 *
+	 * Like the TlsfAllocator it only manages offsets. Ranges are handed out in order from the head
+	 * and given back in the same order, by releasing everything allocated before a position
+	 * returned by getHead (e.g. once the GPU has consumed a submitted batch of copies).
+	 *
+	 * Positions grow monotonically, the offset in the buffer is the position modulo the capacity.
+	 * A range never wraps around the end of the buffer, the space left at the end is skipped.
+	 */
+	class StagingRing {
+	public:
+		static constexpr uint64_t INVALID_OFFSET = std::numeric_limits<uint64_t>::max();
+
+		/**
+		 * @param capacity The size of the managed buffer, must be a multiple of every alignment asked.
+		 */
+		explicit StagingRing(uint64_t capacity);
+
+		/**
+		 * @brief Allocates a range at the head of the ring.
+		 *
+		 * @param size The size of the range, at most the capacity.
+		 * @param alignment The alignment of the range offset, must be a power of two.
+		 *
+		 * @return The offset of the range in the buffer, INVALID_OFFSET if the ring is too full.
+		 */
+		uint64_t allocate(uint64_t size, uint64_t alignment = 1);
+
+		/**
+		 * @brief Gives back every range allocated before position.
+		 */
+		void release(uint64_t position);
+
+		uint64_t getHead() const { return m_head; }
+		uint64_t getCapacity() const { return m_capacity; }
+		uint64_t getUsedSize() const { return m_head - m_tail; }
+		bool isEmpty() const { return m_head == m_tail; }
+
+	private:
+		uint64_t m_capacity;
+		uint64_t m_head = 0;
+		uint64_t m_tail = 0;
+	};
+}
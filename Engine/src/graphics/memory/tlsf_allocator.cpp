@@ -0,0 +1,213 @@
+#include "graphics/memory/tlsf_allocator.hpp"
+
+namespace PXTEngine {
+
+    TlsfAllocator::TlsfAllocator(const uint64_t size) : m_size(size), m_freeSize(size) {
+        for (auto& lists : m_freeLists) {
+            lists.fill(INVALID_NODE);
+        }
+
+        const uint32_t root = createNode();
+        m_nodes[root].offset = 0;
+        m_nodes[root].size = size;
+
+        insertFree(root);
+    }
+
+    TlsfAllocator::Allocation TlsfAllocator::allocate(uint64_t size, const uint64_t alignment) {
+        PXT_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+
+        size = std::max<uint64_t>(size, 1);
+
+        // asking for the worst case padding makes any node of the found list fit once aligned
+        uint32_t node = findFreeNode(size + alignment - 1);
+        if (node == INVALID_NODE) {
+            return {};
+        }
+
+        removeFree(node);
+
+        const uint64_t alignedOffset = (m_nodes[node].offset + alignment - 1) & ~(alignment - 1);
+        const uint64_t padding = alignedOffset - m_nodes[node].offset;
+
+        // the padding in front stays free, its neighbour before can't be free as free nodes are always merged
+        if (padding > 0) {
+            const uint32_t rest = splitBack(node, padding);
+            insertFree(node);
+            node = rest;
+        }
+
+        if (m_nodes[node].size > size) {
+            insertFree(splitBack(node, size));
+        }
+
+        m_freeSize -= m_nodes[node].size;
+        m_allocationCount++;
+
+        return { m_nodes[node].offset, m_nodes[node].size, node };
+    }
+
+    void TlsfAllocator::free(const Allocation& allocation) {
+        uint32_t node = allocation.node;
+
+        PXT_ASSERT(node < m_nodes.size() && !m_nodes[node].free, "Invalid or already freed allocation");
+
+        m_freeSize += m_nodes[node].size;
+        m_allocationCount--;
+
+        const uint32_t previous = m_nodes[node].previousPhysical;
+        if (previous != INVALID_NODE && m_nodes[previous].free) {
+            removeFree(previous);
+
+            m_nodes[previous].size += m_nodes[node].size;
+            m_nodes[previous].nextPhysical = m_nodes[node].nextPhysical;
+            if (m_nodes[node].nextPhysical != INVALID_NODE) {
+                m_nodes[m_nodes[node].nextPhysical].previousPhysical = previous;
+            }
+
+            releaseNode(node);
+            node = previous;
+        }
+
+        const uint32_t next = m_nodes[node].nextPhysical;
+        if (next != INVALID_NODE && m_nodes[next].free) {
+            removeFree(next);
+
+            m_nodes[node].size += m_nodes[next].size;
+            m_nodes[node].nextPhysical = m_nodes[next].nextPhysical;
+            if (m_nodes[next].nextPhysical != INVALID_NODE) {
+                m_nodes[m_nodes[next].nextPhysical].previousPhysical = node;
+            }
+
+            releaseNode(next);
+        }
+
+        insertFree(node);
+    }
+
+    void TlsfAllocator::mapping(const uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel) {
+        // sizes smaller than the second level count get a linear bucket each
+        if (size < SECOND_LEVEL_COUNT) {
+            firstLevel = 0;
+            secondLevel = static_cast<uint32_t>(size);
+            return;
+        }
+
+        const uint32_t log2 = static_cast<uint32_t>(std::bit_width(size)) - 1;
+
+        firstLevel = log2 - SECOND_LEVEL_LOG2 + 1;
+        secondLevel = static_cast<uint32_t>(size >> (log2 - SECOND_LEVEL_LOG2)) - SECOND_LEVEL_COUNT;
+    }
+
+    uint32_t TlsfAllocator::findFreeNode(uint64_t size) const {
+        // round the size up to the next bucket, so that every node of the found list is big enough
+        if (size >= SECOND_LEVEL_COUNT) {
+            const uint32_t log2 = static_cast<uint32_t>(std::bit_width(size)) - 1;
+            size += (1ull << (log2 - SECOND_LEVEL_LOG2)) - 1;
+        }
+
+        uint32_t firstLevel, secondLevel;
+        mapping(size, firstLevel, secondLevel);
+
+        if (firstLevel >= FIRST_LEVEL_COUNT) {
+            return INVALID_NODE;
+        }
+
+        uint32_t secondLevelMap = m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel);
+
+        if (secondLevelMap == 0) {
+            const uint64_t firstLevelMap = firstLevel + 1 < 64 ? m_firstLevelBitmap & (~0ull << (firstLevel + 1)) : 0;
+            if (firstLevelMap == 0) {
+                return INVALID_NODE;
+            }
+
+            firstLevel = static_cast<uint32_t>(std::countr_zero(firstLevelMap));
+            secondLevelMap = m_secondLevelBitmaps[firstLevel];
+        }
+
+        secondLevel = static_cast<uint32_t>(std::countr_zero(secondLevelMap));
+
+        return m_freeLists[firstLevel][secondLevel];
+    }
+
+    uint32_t TlsfAllocator::createNode() {
+        if (!m_unusedNodes.empty()) {
+            const uint32_t node = m_unusedNodes.back();
+            m_unusedNodes.pop_back();
+            return node;
+        }
+
+        m_nodes.emplace_back();
+        return static_cast<uint32_t>(m_nodes.size() - 1);
+    }
+
+    void TlsfAllocator::releaseNode(const uint32_t node) {
+        m_nodes[node] = Node{};
+        m_unusedNodes.push_back(node);
+    }
+
+    void TlsfAllocator::insertFree(const uint32_t node) {
+        uint32_t firstLevel, secondLevel;
+        mapping(m_nodes[node].size, firstLevel, secondLevel);
+
+        const uint32_t head = m_freeLists[firstLevel][secondLevel];
+
+        m_nodes[node].free = true;
+        m_nodes[node].previousFree = INVALID_NODE;
+        m_nodes[node].nextFree = head;
+
+        if (head != INVALID_NODE) {
+            m_nodes[head].previousFree = node;
+        }
+
+        m_freeLists[firstLevel][secondLevel] = node;
+        m_secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+        m_firstLevelBitmap |= 1ull << firstLevel;
+    }
+
+    void TlsfAllocator::removeFree(const uint32_t node) {
+        uint32_t firstLevel, secondLevel;
+        mapping(m_nodes[node].size, firstLevel, secondLevel);
+
+        const uint32_t previous = m_nodes[node].previousFree;
+        const uint32_t next = m_nodes[node].nextFree;
+
+        if (previous != INVALID_NODE) m_nodes[previous].nextFree = next;
+        if (next != INVALID_NODE) m_nodes[next].previousFree = previous;
+
+        if (m_freeLists[firstLevel][secondLevel] == node) {
+            m_freeLists[firstLevel][secondLevel] = next;
+
+            if (next == INVALID_NODE) {
+                m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+
+                if (m_secondLevelBitmaps[firstLevel] == 0) {
+                    m_firstLevelBitmap &= ~(1ull << firstLevel);
+                }
+            }
+        }
+
+        m_nodes[node].free = false;
+        m_nodes[node].previousFree = INVALID_NODE;
+        m_nodes[node].nextFree = INVALID_NODE;
+    }
+
+    uint32_t TlsfAllocator::splitBack(const uint32_t node, const uint64_t size) {
+        // createNode can grow m_nodes, so no reference is kept across it
+        const uint32_t rest = createNode();
+
+        m_nodes[rest].offset = m_nodes[node].offset + size;
+        m_nodes[rest].size = m_nodes[node].size - size;
+        m_nodes[rest].previousPhysical = node;
+        m_nodes[rest].nextPhysical = m_nodes[node].nextPhysical;
+
+        if (m_nodes[node].nextPhysical != INVALID_NODE) {
+            m_nodes[m_nodes[node].nextPhysical].previousPhysical = rest;
+        }
+
+        m_nodes[node].size = size;
+        m_nodes[node].nextPhysical = rest;
+
+        return rest;
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class TlsfAllocator
+	 *
+	 * @brief Two-Level Segregated Fit allocator of ranges inside a block of memory.
+	 *
+	 * The allocator only manages offsets, it never touches the memory itself, so it can
+	 * sub-allocate GPU memory blocks (or anything else) and be exercised on the CPU alone.
+	 *
+	 * Free ranges are kept in lists bucketed by size: the first level is the power of two
+	 * of the size, the second level splits every power of two in SECOND_LEVEL_COUNT linear
+	 * steps. Two bitmaps track which lists are not empty, so both allocate and free run in
+	 * constant time. Freed ranges are merged with their free neighbours right away.
+	 */
+	class TlsfAllocator {
+	public:
+		static constexpr uint32_t INVALID_NODE = std::numeric_limits<uint32_t>::max();
+
+		/**
+		 * @struct Allocation
+		 *
+		 * @brief A range returned by allocate, to be passed back to free.
+		 */
+		struct Allocation {
+			uint64_t offset = 0;
+			uint64_t size = 0;
+			uint32_t node = INVALID_NODE;
+
+			bool isValid() const { return node != INVALID_NODE; }
+		};
+
+		/**
+		 * @param size The size of the managed block.
+		 */
+		explicit TlsfAllocator(uint64_t size);
+
+		/**
+		 * @brief Allocates a range.
+		 *
+		 * @param size The size of the range.
+		 * @param alignment The alignment of the range offset, must be a power of two.
+		 *
+		 * @return The allocated range, invalid if no free range is big enough.
+		 */
+		Allocation allocate(uint64_t size, uint64_t alignment = 1);
+
+		/**
+		 * @brief Gives a range back to the allocator.
+		 */
+		void free(const Allocation& allocation);
+
+		uint64_t getSize() const { return m_size; }
+		uint64_t getFreeSize() const { return m_freeSize; }
+		uint32_t getAllocationCount() const { return m_allocationCount; }
+		bool isEmpty() const { return m_allocationCount == 0; }
+
+	private:
+		static constexpr uint32_t SECOND_LEVEL_LOG2 = 4;
+		static constexpr uint32_t SECOND_LEVEL_COUNT = 1 << SECOND_LEVEL_LOG2;
+		static constexpr uint32_t FIRST_LEVEL_COUNT = 64 - SECOND_LEVEL_LOG2 + 1;
+
+		struct Node {
+			uint64_t offset = 0;
+			uint64_t size = 0;
+
+			// neighbours in memory
+			uint32_t previousPhysical = INVALID_NODE;
+			uint32_t nextPhysical = INVALID_NODE;
+
+			// neighbours in the free list, only meaningful for free nodes
+			uint32_t previousFree = INVALID_NODE;
+			uint32_t nextFree = INVALID_NODE;
+
+			bool free = false;
+		};
+
+		static void mapping(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+
+		uint32_t findFreeNode(uint64_t size) const;
+
+		uint32_t createNode();
+		void releaseNode(uint32_t node);
+
+		void insertFree(uint32_t node);
+		void removeFree(uint32_t node);
+
+		/**
+		 * @brief Shrinks a node to size bytes, the remainder becomes a new node (not in a free list).
+		 *
+		 * @return The index of the new node.
+		 */
+		uint32_t splitBack(uint32_t node, uint64_t size);
+
+		uint64_t m_size;
+		uint64_t m_freeSize;
+		uint32_t m_allocationCount = 0;
+
+		std::vector<Node> m_nodes;
+		std::vector<uint32_t> m_unusedNodes;
+
+		uint64_t m_firstLevelBitmap = 0;
+		std::array<uint32_t, FIRST_LEVEL_COUNT> m_secondLevelBitmaps{};
+		std::array<std::array<uint32_t, SECOND_LEVEL_COUNT>, FIRST_LEVEL_COUNT> m_freeLists;
+	};
+}
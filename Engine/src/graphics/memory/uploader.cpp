@@ -0,0 +1,477 @@
+#include "graphics/memory/uploader.hpp"
+
+namespace PXTEngine {
+
+    Uploader::Uploader(VkDevice device, const QueueFamilyIndices& queueFamilies, VkQueue transferQueue,
+        VkQueue graphicsQueue, GpuAllocator& allocator, const VkDeviceSize ringSize)
+        : m_device(device), m_transferQueue(transferQueue), m_graphicsQueue(graphicsQueue),
+        m_transferFamily(queueFamilies.transferFamily), m_graphicsFamily(queueFamilies.graphicsFamily),
+        m_allocator(allocator), m_ring(ringSize) {
+
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = m_transferFamily;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+        if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_commandPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload command pool!");
+        }
+
+        if (hasDedicatedTransferQueue()) {
+            poolInfo.queueFamilyIndex = m_graphicsFamily;
+
+            if (vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_acquireCommandPool) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create upload acquire command pool!");
+            }
+        }
+
+        VkBufferCreateInfo bufferInfo{};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = ringSize;
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(m_device, &bufferInfo, nullptr, &m_ringBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create staging ring buffer!");
+        }
+
+        m_ringAllocation = m_allocator.allocateBuffer(m_ringBuffer,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    }
+
+    Uploader::~Uploader() {
+        waitIdle();
+
+        auto destroyBatch = [&](UploadBatch& batch) {
+            releaseBatch(batch);
+            vkDestroyFence(m_device, batch.fence, nullptr);
+            vkDestroySemaphore(m_device, batch.semaphore, nullptr);
+        };
+
+        if (m_openBatch) {
+            destroyBatch(*m_openBatch);
+        }
+
+        for (auto& batch : m_freeBatches) {
+            destroyBatch(batch);
+        }
+
+        for (VkFence fence : m_freeFences) {
+            vkDestroyFence(m_device, fence, nullptr);
+        }
+
+        // frees the command buffers as well
+        vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+        vkDestroyCommandPool(m_device, m_acquireCommandPool, nullptr);
+
+        vkDestroyBuffer(m_device, m_ringBuffer, nullptr);
+        m_allocator.free(m_ringAllocation);
+    }
+
+    void Uploader::copyToBuffer(VkBuffer buffer, const void* data, const VkDeviceSize size, const VkDeviceSize dstOffset) {
+        if (size == 0) return;
+
+        std::lock_guard lock(m_mutex);
+
+        VkBuffer stagingBuffer;
+        VkDeviceSize stagingOffset;
+        stage(data, size, stagingBuffer, stagingOffset);
+
+        UploadBatch& batch = getOpenBatch();
+
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = stagingOffset;
+        copyRegion.dstOffset = dstOffset;
+        copyRegion.size = size;
+        vkCmdCopyBuffer(batch.commandBuffer, stagingBuffer, buffer, 1, &copyRegion);
+
+        // on a shared queue a single memory barrier covers every buffer copy of the batch
+        if (hasDedicatedTransferQueue()) {
+            VkBufferMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+            barrier.srcQueueFamilyIndex = m_transferFamily;
+            barrier.dstQueueFamilyIndex = m_graphicsFamily;
+            barrier.buffer = buffer;
+            barrier.offset = dstOffset;
+            barrier.size = size;
+
+            batch.bufferBarriers.push_back(barrier);
+        }
+
+        batch.copyCount++;
+    }
+
+    void Uploader::copyToImage(VkImage image, const void* data, const VkDeviceSize size,
+        std::span<const VkBufferImageCopy> regions, const VkImageSubresourceRange& subresourceRange,
+        const VkImageLayout finalLayout) {
+
+        std::lock_guard lock(m_mutex);
+
+        VkBuffer stagingBuffer;
+        VkDeviceSize stagingOffset;
+        stage(data, size, stagingBuffer, stagingOffset);
+
+        UploadBatch& batch = getOpenBatch();
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange = subresourceRange;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(batch.commandBuffer,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        std::vector<VkBufferImageCopy> stagedRegions(regions.begin(), regions.end());
+        for (auto& region : stagedRegions) {
+            region.bufferOffset += stagingOffset;
+        }
+
+        vkCmdCopyBufferToImage(batch.commandBuffer, stagingBuffer, image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(stagedRegions.size()), stagedRegions.data());
+
+        // the transition to the final layout (and the ownership transfer) is recorded with the others on submit
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = finalLayout;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+
+        if (hasDedicatedTransferQueue()) {
+            barrier.srcQueueFamilyIndex = m_transferFamily;
+            barrier.dstQueueFamilyIndex = m_graphicsFamily;
+        }
+
+        batch.imageBarriers.push_back(barrier);
+
+        batch.copyCount++;
+    }
+
+    void Uploader::flush() {
+        std::lock_guard lock(m_mutex);
+
+        submitOpenBatch();
+        reclaim(false);
+    }
+
+    void Uploader::waitIdle() {
+        std::lock_guard lock(m_mutex);
+
+        submitOpenBatch();
+
+        while (!m_batchesInFlight.empty()) {
+            reclaim(true);
+        }
+    }
+
+    void Uploader::submitAndWait(VkCommandBuffer commandBuffer) {
+        VkFence fence;
+
+        {
+            std::lock_guard lock(m_mutex);
+
+            // the commands may read resources whose upload is still recorded in the open batch
+            submitOpenBatch();
+
+            if (!m_freeFences.empty()) {
+                fence = m_freeFences.back();
+                m_freeFences.pop_back();
+            } else {
+                VkFenceCreateInfo fenceInfo{};
+                fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+                if (vkCreateFence(m_device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+                    throw std::runtime_error("failed to create submit fence!");
+                }
+            }
+
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &commandBuffer;
+
+            if (vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, fence) != VK_SUCCESS) {
+                m_freeFences.push_back(fence);
+                throw std::runtime_error("failed to submit command buffer!");
+            }
+        }
+
+        // waited without the lock, the other threads keep recording their uploads
+        m_hostWaitCount.fetch_add(1, std::memory_order_relaxed);
+        vkWaitForFences(m_device, 1, &fence, VK_TRUE, UINT64_MAX);
+        vkResetFences(m_device, 1, &fence);
+
+        std::lock_guard lock(m_mutex);
+        m_freeFences.push_back(fence);
+
+        // the batches submitted before the commands are done as well
+        reclaim(false);
+    }
+
+    VkResult Uploader::submitFrame(const VkSubmitInfo& submitInfo, const VkFence fence) {
+        std::lock_guard lock(m_mutex);
+
+        // the uploads recorded during the frame must be submitted before the frame that uses them
+        submitOpenBatch();
+        reclaim(false);
+
+        return vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, fence);
+    }
+
+    VkResult Uploader::present(const VkQueue presentQueue, const VkPresentInfoKHR& presentInfo) {
+        if (presentQueue != m_graphicsQueue && presentQueue != m_transferQueue) {
+            return vkQueuePresentKHR(presentQueue, &presentInfo);
+        }
+
+        std::lock_guard lock(m_mutex);
+        return vkQueuePresentKHR(presentQueue, &presentInfo);
+    }
+
+    void Uploader::stage(const void* data, const VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset) {
+        offset = m_ring.allocate(size, STAGING_ALIGNMENT);
+
+        if (offset == StagingRing::INVALID_OFFSET && size <= m_ring.getCapacity()) {
+            // the ring is full: submit what is recorded so far and wait for the oldest batches to free it
+            submitOpenBatch();
+
+            while (offset == StagingRing::INVALID_OFFSET && !m_batchesInFlight.empty()) {
+                reclaim(true);
+                offset = m_ring.allocate(size, STAGING_ALIGNMENT);
+            }
+        }
+
+        if (offset != StagingRing::INVALID_OFFSET) {
+            buffer = m_ringBuffer;
+            std::memcpy(static_cast<uint8_t*>(m_ringAllocation.mapped) + offset, data, size);
+            return;
+        }
+
+        // bigger than the whole ring, it gets a staging buffer of its own
+        VkBufferCreateInfo bufferInfo{};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = size;
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(m_device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create staging buffer!");
+        }
+
+        GpuAllocation allocation;
+        try {
+            allocation = m_allocator.allocateBuffer(buffer,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        } catch (...) {
+            vkDestroyBuffer(m_device, buffer, nullptr);
+            throw;
+        }
+
+        std::memcpy(allocation.mapped, data, size);
+        offset = 0;
+
+        getOpenBatch().dedicatedBuffers.emplace_back(buffer, allocation);
+    }
+
+    UploadBatch& Uploader::getOpenBatch() {
+        if (m_openBatch) {
+            return *m_openBatch;
+        }
+
+        if (!m_freeBatches.empty()) {
+            m_openBatch = std::move(m_freeBatches.back());
+            m_freeBatches.pop_back();
+        } else {
+            UploadBatch batch;
+
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandPool = m_commandPool;
+            allocInfo.commandBufferCount = 1;
+
+            if (vkAllocateCommandBuffers(m_device, &allocInfo, &batch.commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate upload command buffer!");
+            }
+
+            VkFenceCreateInfo fenceInfo{};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+            if (vkCreateFence(m_device, &fenceInfo, nullptr, &batch.fence) != VK_SUCCESS) {
+                vkFreeCommandBuffers(m_device, m_commandPool, 1, &batch.commandBuffer);
+                throw std::runtime_error("failed to create upload fence!");
+            }
+
+            if (hasDedicatedTransferQueue()) {
+                allocInfo.commandPool = m_acquireCommandPool;
+
+                VkSemaphoreCreateInfo semaphoreInfo{};
+                semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+                if (vkAllocateCommandBuffers(m_device, &allocInfo, &batch.acquireCommandBuffer) != VK_SUCCESS ||
+                    vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &batch.semaphore) != VK_SUCCESS) {
+                    throw std::runtime_error("failed to create upload acquire command buffer!");
+                }
+            }
+
+            m_openBatch = std::move(batch);
+        }
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        vkBeginCommandBuffer(m_openBatch->commandBuffer, &beginInfo);
+
+        return *m_openBatch;
+    }
+
+    void Uploader::submitOpenBatch() {
+        if (!m_openBatch || m_openBatch->copyCount == 0) return;
+
+        UploadBatch& batch = *m_openBatch;
+        batch.ringEnd = m_ring.getHead();
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        if (!hasDedicatedTransferQueue()) {
+            // make the copies visible to everything submitted to the queue after this batch
+            VkMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+
+            vkCmdPipelineBarrier(batch.commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                0, 1, &barrier, 0, nullptr,
+                static_cast<uint32_t>(batch.imageBarriers.size()), batch.imageBarriers.data());
+
+            vkEndCommandBuffer(batch.commandBuffer);
+
+            VkSubmitInfo submitInfo{};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &batch.commandBuffer;
+
+            if (vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, batch.fence) != VK_SUCCESS) {
+                throw std::runtime_error("failed to submit upload batch!");
+            }
+        } else {
+            // release: the access masks of the graphics side are ignored by the transfer queue
+            for (auto& barrier : batch.bufferBarriers) barrier.dstAccessMask = 0;
+            for (auto& barrier : batch.imageBarriers) barrier.dstAccessMask = 0;
+
+            vkCmdPipelineBarrier(batch.commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                0, 0, nullptr,
+                static_cast<uint32_t>(batch.bufferBarriers.size()), batch.bufferBarriers.data(),
+                static_cast<uint32_t>(batch.imageBarriers.size()), batch.imageBarriers.data());
+
+            vkEndCommandBuffer(batch.commandBuffer);
+
+            VkSubmitInfo transferSubmitInfo{};
+            transferSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            transferSubmitInfo.commandBufferCount = 1;
+            transferSubmitInfo.pCommandBuffers = &batch.commandBuffer;
+            transferSubmitInfo.signalSemaphoreCount = 1;
+            transferSubmitInfo.pSignalSemaphores = &batch.semaphore;
+
+            if (vkQueueSubmit(m_transferQueue, 1, &transferSubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+                throw std::runtime_error("failed to submit upload batch!");
+            }
+
+            // acquire: the same barriers, with the access masks of the graphics side
+            for (auto& barrier : batch.bufferBarriers) {
+                barrier.srcAccessMask = 0;
+                barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+            }
+            for (auto& barrier : batch.imageBarriers) {
+                barrier.srcAccessMask = 0;
+                barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+            }
+
+            vkBeginCommandBuffer(batch.acquireCommandBuffer, &beginInfo);
+
+            vkCmdPipelineBarrier(batch.acquireCommandBuffer,
+                VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                0, 0, nullptr,
+                static_cast<uint32_t>(batch.bufferBarriers.size()), batch.bufferBarriers.data(),
+                static_cast<uint32_t>(batch.imageBarriers.size()), batch.imageBarriers.data());
+
+            vkEndCommandBuffer(batch.acquireCommandBuffer);
+
+            // the graphics queue only waits for the copies where the acquire happens, the frames
+            // already submitted keep running while the transfer queue works
+            const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+            VkSubmitInfo acquireSubmitInfo{};
+            acquireSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            acquireSubmitInfo.waitSemaphoreCount = 1;
+            acquireSubmitInfo.pWaitSemaphores = &batch.semaphore;
+            acquireSubmitInfo.pWaitDstStageMask = &waitStage;
+            acquireSubmitInfo.commandBufferCount = 1;
+            acquireSubmitInfo.pCommandBuffers = &batch.acquireCommandBuffer;
+
+            // signaled after both submissions, as the acquire waits for the transfer
+            if (vkQueueSubmit(m_graphicsQueue, 1, &acquireSubmitInfo, batch.fence) != VK_SUCCESS) {
+                throw std::runtime_error("failed to submit upload acquire!");
+            }
+        }
+
+        m_batchesInFlight.push_back(std::move(batch));
+        m_openBatch.reset();
+    }
+
+    void Uploader::reclaim(bool waitOldest) {
+        while (!m_batchesInFlight.empty()) {
+            UploadBatch& batch = m_batchesInFlight.front();
+
+            if (waitOldest) {
+                m_hostWaitCount.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            const VkResult status = waitOldest
+                ? vkWaitForFences(m_device, 1, &batch.fence, VK_TRUE, UINT64_MAX)
+                : vkGetFenceStatus(m_device, batch.fence);
+
+            if (status != VK_SUCCESS) break;
+
+            // the following batches are only checked, not waited for
+            waitOldest = false;
+
+            releaseBatch(batch);
+            vkResetFences(m_device, 1, &batch.fence);
+
+            m_freeBatches.push_back(std::move(batch));
+            m_batchesInFlight.pop_front();
+        }
+    }
+
+    void Uploader::releaseBatch(UploadBatch& batch) {
+        m_ring.release(batch.ringEnd);
+
+        for (auto& [buffer, allocation] : batch.dedicatedBuffers) {
+            vkDestroyBuffer(m_device, buffer, nullptr);
+            m_allocator.free(allocation);
+        }
+
+        batch.dedicatedBuffers.clear();
+        batch.bufferBarriers.clear();
+        batch.imageBarriers.clear();
+        batch.copyCount = 0;
+
+        vkResetCommandBuffer(batch.commandBuffer, 0);
+        if (batch.acquireCommandBuffer != VK_NULL_HANDLE) {
+            vkResetCommandBuffer(batch.acquireCommandBuffer, 0);
+        }
+    }
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "graphics/context/physical_device.hpp"
+#include "graphics/memory/gpu_allocator.hpp"
+#include "graphics/memory/staging_ring.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @struct UploadBatch
+	 *
+	 * @brief The copies recorded in a single command buffer and submitted together.
+	 */
+	struct UploadBatch {
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE; // recorded for the transfer queue
+
+		// with a dedicated transfer family, the ownership acquire recorded for the graphics queue and
+		// the semaphore it waits for, signaled by the transfer submission
+		VkCommandBuffer acquireCommandBuffer = VK_NULL_HANDLE;
+		VkSemaphore semaphore = VK_NULL_HANDLE;
+
+		VkFence fence = VK_NULL_HANDLE;
+
+		// ring position to release once the fence is signaled
+		uint64_t ringEnd = 0;
+
+		// staging buffers for uploads that don't fit in the ring, destroyed once the fence is signaled
+		std::vector<std::pair<VkBuffer, GpuAllocation>> dedicatedBuffers;
+
+		// barriers recorded after the copies when the batch is submitted: final image layouts
+		// and, with a dedicated transfer family, the queue family ownership transfers
+		std::vector<VkBufferMemoryBarrier> bufferBarriers;
+		std::vector<VkImageMemoryBarrier> imageBarriers;
+
+		uint32_t copyCount = 0;
+	};
+
+	/**
+	 * @class Uploader
+	 *
+	 * @brief Uploads data to device local buffers and images through a persistent staging ring.
+	 *
+	 * The data is copied into a mapped ring buffer right away and the GPU copies are recorded in the
+	 * open UploadBatch, so any number of uploads end up in a single command buffer. The batch is
+	 * submitted by flush, which doesn't wait: a fence per batch tells when its part of the ring
+	 * can be reused. Only when the ring is full the oldest batches are waited for.
+	 *
+	 * Batches are submitted to the transfer queue, so that the copies run on the DMA engines while the
+	 * graphics queue keeps rendering the frames already submitted. The destination buffers and images
+	 * are then released to the graphics family and acquired by a small command buffer submitted to the
+	 * graphics queue, which waits for the transfer through a semaphore. Anything submitted to the
+	 * graphics queue after a flush sees the uploaded data: the Context flushes before any other
+	 * submission, so resources can be used right after their upload is recorded.
+	 *
+	 * Without a separate transfer family the batches are submitted to the graphics queue directly.
+	 */
+	class Uploader {
+	public:
+		static constexpr VkDeviceSize DEFAULT_RING_SIZE = 64ull * 1024 * 1024;
+
+		Uploader(VkDevice device, const QueueFamilyIndices& queueFamilies, VkQueue transferQueue, VkQueue graphicsQueue,
+			GpuAllocator& allocator, VkDeviceSize ringSize = DEFAULT_RING_SIZE);
+		~Uploader();
+
+		Uploader(const Uploader&) = delete;
+		Uploader& operator=(const Uploader&) = delete;
+
+		/**
+		 * @brief Records a copy of data into a buffer.
+		 *
+		 * @param buffer The destination buffer, created with VK_BUFFER_USAGE_TRANSFER_DST_BIT and not in use by the GPU.
+		 * @param data The data to copy, it can be released as soon as this returns.
+		 * @param size The size of the data.
+		 * @param dstOffset The offset of the copy in the destination buffer.
+		 */
+		void copyToBuffer(VkBuffer buffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+
+		/**
+		 * @brief Records a copy of data into an image, with the layout transitions around it.
+		 *
+		 * The previous content of the image is discarded (it is transitioned from VK_IMAGE_LAYOUT_UNDEFINED).
+		 *
+		 * @param image The destination image, created with VK_IMAGE_USAGE_TRANSFER_DST_BIT.
+		 * @param data The data to copy, it can be released as soon as this returns.
+		 * @param size The size of the data.
+		 * @param regions The regions to copy, their bufferOffset is relative to data.
+		 * @param subresourceRange The subresources covered by the regions.
+		 * @param finalLayout The layout of the image once the copy is done.
+		 */
+		void copyToImage(VkImage image, const void* data, VkDeviceSize size,
+			std::span<const VkBufferImageCopy> regions, const VkImageSubresourceRange& subresourceRange,
+			VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+		/**
+		 * @brief Submits the open batch, if it has any copy, without waiting for it.
+		 */
+		void flush();
+
+		/**
+		 * @brief Submits the open batch and waits for every batch in flight.
+		 */
+		void waitIdle();
+
+		/**
+		 * @brief Submits a graphics command buffer after the open batch and waits for it alone.
+		 *
+		 * The command buffer can use every resource uploaded so far. The wait is on a fence of the
+		 * uploader, so the frames and the uploads already submitted to the graphics queue are not
+		 * waited for, and the graphics queue is only accessed under the uploader lock.
+		 *
+		 * @param commandBuffer The ended command buffer, allocated from a graphics family pool.
+		 */
+		void submitAndWait(VkCommandBuffer commandBuffer);
+
+		/**
+		 * @brief Submits the open batch, then a frame to the graphics queue, both under the uploader lock.
+		 *
+		 * The loading threads submit their uploads to the graphics queue as well, and Vulkan requires
+		 * the submissions to a queue to be externally synchronized.
+		 *
+		 * @return The result of vkQueueSubmit for the frame.
+		 */
+		VkResult submitFrame(const VkSubmitInfo& submitInfo, VkFence fence);
+
+		/**
+		 * @brief Presents on a queue, under the uploader lock when the uploads are submitted to the same queue.
+		 */
+		VkResult present(VkQueue presentQueue, const VkPresentInfoKHR& presentInfo);
+
+		/**
+		 * @brief Returns true if uploads run on a queue other than the graphics one.
+		 */
+		bool hasDedicatedTransferQueue() const { return m_transferFamily != m_graphicsFamily; }
+
+		/**
+		 * @brief Returns how many times the CPU waited for the GPU in submitAndWait, waitIdle or on a full ring.
+		 *
+		 * Besides the frame fences these are the only waits of the frame loop, none is expected once
+		 * every asset is loaded.
+		 */
+		uint32_t getHostWaitCount() const { return m_hostWaitCount.load(std::memory_order_relaxed); }
+
+	private:
+		// staging offsets must satisfy the texel block size of compressed formats
+		static constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+		/**
+		 * @brief Copies data to staging memory that stays valid until the open batch completes.
+		 */
+		void stage(const void* data, VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset);
+
+		UploadBatch& getOpenBatch();
+		void submitOpenBatch();
+
+		/**
+		 * @brief Recycles the batches in flight, in submission order.
+		 *
+		 * @param waitOldest Waits for the oldest batch if it isn't completed yet.
+		 */
+		void reclaim(bool waitOldest);
+		void releaseBatch(UploadBatch& batch);
+
+		VkDevice m_device;
+		VkQueue m_transferQueue;
+		VkQueue m_graphicsQueue;
+		uint32_t m_transferFamily;
+		uint32_t m_graphicsFamily;
+		GpuAllocator& m_allocator;
+
+		VkCommandPool m_commandPool = VK_NULL_HANDLE;        // transfer family
+		VkCommandPool m_acquireCommandPool = VK_NULL_HANDLE; // graphics family, only with a dedicated transfer family
+
+		VkBuffer m_ringBuffer = VK_NULL_HANDLE;
+		GpuAllocation m_ringAllocation{};
+		StagingRing m_ring;
+
+		std::mutex m_mutex;
+
+		std::optional<UploadBatch> m_openBatch;
+		std::deque<UploadBatch> m_batchesInFlight;
+		std::vector<UploadBatch> m_freeBatches;
+
+		// unsignaled fences for submitAndWait
+		std::vector<VkFence> m_freeFences;
+
+		std::atomic<uint32_t> m_hostWaitCount = 0;
+	};
+}
@@ -21,6 +21,11 @@ namespace PXTEngine {
 		VulkanShader(m_context, SPV_SHADERS_PATH + "material_shader.vert.spv");
 	}
 
+	Pipeline::Pipeline(Context& context, const ComputePipelineConfigInfo& configInfo)
+		: m_context(context) {
+		createComputePipeline(configInfo);
+	}
+
 	Pipeline::~Pipeline() {
 		for (const auto shaderModule : m_shaderModules) {
 			vkDestroyShaderModule(m_context.getDevice(), shaderModule, nullptr);
@@ -247,6 +252,35 @@ namespace PXTEngine {
 		m_shaderModules.clear();
 	}
 
+	void Pipeline::createComputePipeline(const ComputePipelineConfigInfo& configInfo) {
+		auto shaderCode = readFile(configInfo.shaderFilePath);
+
+		VkShaderModule shaderModule;
+		createShaderModule(shaderCode, &shaderModule);
+
+		VkPipelineShaderStageCreateInfo shaderStageInfo{};
+		shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		shaderStageInfo.module = shaderModule;
+		shaderStageInfo.pName = "main";
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage = shaderStageInfo;
+		pipelineInfo.layout = configInfo.pipelineLayout;
+
+		const VkResult result = vkCreateComputePipelines(m_context.getDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline);
+
+		// the module is not needed once the pipeline is created
+		vkDestroyShaderModule(m_context.getDevice(), shaderModule, nullptr);
+
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error("failed to create compute pipeline!");
+		}
+
+		m_pipelineBindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
+	}
+
 	void Pipeline::bind(VkCommandBuffer commandBuffer) {
         vkCmdBindPipeline(commandBuffer, m_pipelineBindPoint, m_pipeline);
     }
@@ -27,6 +27,19 @@ namespace PXTEngine {
         uint32_t maxPipelineRayRecursionDepth = 1;
     };
 
+    /**
+     * @struct ComputePipelineConfigInfo
+     * @brief Configuration information for a COMPUTE pipeline: a single compute shader and its layout.
+     */
+    struct ComputePipelineConfigInfo {
+        ComputePipelineConfigInfo() = default;
+        ComputePipelineConfigInfo(const ComputePipelineConfigInfo&) = delete;
+        ComputePipelineConfigInfo& operator=(const ComputePipelineConfigInfo&) = delete;
+
+        std::string shaderFilePath;
+        VkPipelineLayout pipelineLayout = nullptr;
+    };
+
     /**
      * @struct RasterizationPipelineConfigInfo
      * @brief Configuration information for the GRAPHICS pipeline.
@@ -67,6 +80,7 @@ namespace PXTEngine {
         Pipeline(Context& context, const std::vector<std::string>& shaderFilePaths,
                  const RasterizationPipelineConfigInfo& configInfo);
 		Pipeline(Context& context, const RayTracingPipelineConfigInfo& configInfo);
+		Pipeline(Context& context, const ComputePipelineConfigInfo& configInfo);
                  
         ~Pipeline();
 
@@ -89,6 +103,8 @@ namespace PXTEngine {
 
 		void createRayTracingPipeline(const RayTracingPipelineConfigInfo& configInfo);
 
+		void createComputePipeline(const ComputePipelineConfigInfo& configInfo);
+
         void createShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule);
 
         Context& m_context;
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "graphics/reference/reference_random.hpp"
+
+/*
+ * CPU port of shaders/material/pbr/bsdf.glsl and of the helpers it uses from common/math.glsl
+ * and common/geometry.glsl. Keep the two in sync: the reference renderer is only a ground truth
+ * as long as it evaluates the same BSDF as the shaders.
+ */
+namespace PXTEngine {
+
+	// FLT_EPSILON of common/math.glsl, not the one of <cfloat>
+	inline constexpr float SHADER_EPSILON = 1e-5f;
+
+	inline constexpr float PI = glm::pi<float>();
+	inline constexpr float TWO_PI = glm::two_pi<float>();
+	inline constexpr float INV_PI = glm::one_over_pi<float>();
+
+	struct SurfaceData {
+		glm::mat3 tbn;
+		glm::vec3 albedo;
+		glm::vec3 reflectance;
+		float metalness;
+		float roughness;
+		float specularProbability;
+	};
+
+	inline float pow2(const float x) {
+		return x * x;
+	}
+
+	inline float pow5(const float x) {
+		const float x2 = x * x;
+		return x2 * x2 * x;
+	}
+
+	inline float maxComponent(const glm::vec3& v) {
+		return std::max(std::max(v.r, v.g), v.b);
+	}
+
+	inline float cosThetaTangent(const glm::vec3& v) {
+		// in tangent space the normal is the z axis
+		return std::max(v.z, 0.0f);
+	}
+
+	inline float cosTheta(const glm::vec3& v, const glm::vec3& u) {
+		return std::max(glm::dot(v, u), 0.0f);
+	}
+
+	inline glm::vec3 tangentToWorld(const glm::mat3& tbn, const glm::vec3& tangentVector) {
+		return tbn * tangentVector;
+	}
+
+	inline glm::vec3 worldToTangent(const glm::mat3& tbn, const glm::vec3& worldVector) {
+		return glm::inverse(tbn) * worldVector;
+	}
+
+	inline float luminance(const glm::vec3& color) {
+		return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+	}
+
+	inline float calculateSpecularProbability(const glm::vec3& albedo, const float metalness, const glm::vec3& reflectance) {
+		const float weightSpecular = luminance(reflectance);
+		const float weightDiffuse = glm::mix(luminance(albedo), 0.0f, metalness);
+
+		return std::min(weightSpecular / (weightDiffuse + weightSpecular + SHADER_EPSILON), 1.0f);
+	}
+
+	inline glm::vec3 calculateReflectance(const glm::vec3& albedo, const float metalness) {
+		// F0 of dielectrics, metals reflect their albedo
+		return glm::mix(glm::vec3(0.04f), albedo, metalness);
+	}
+
+	inline glm::vec3 sampleCosineWeightedHemisphere(const glm::vec2& u) {
+		const float r = std::sqrt(u.x);
+		const float theta = TWO_PI * u.y;
+
+		const glm::vec2 d = r * glm::vec2(std::cos(theta), std::sin(theta));
+
+		return { d.x, d.y, std::sqrt(1.0f - d.x * d.x - d.y * d.y) };
+	}
+
+	inline float D_GGX(const float NoH, const float roughness) {
+		const float a2 = pow2(roughness);
+		const float d = pow2(NoH) * (a2 - 1.0f) + 1.0f;
+
+		return a2 / (PI * pow2(d));
+	}
+
+	inline float G_Schlick_GGX(const float cosTheta, const float roughness) {
+		const float r = pow2(roughness) + 1.0f;
+		const float k = pow2(r) / 8.0f;
+
+		return cosTheta / (cosTheta * (1.0f - k) + k);
+	}
+
+	inline float G_Smith(const float NoO, const float NoI, const float roughness) {
+		return G_Schlick_GGX(NoO, roughness) * G_Schlick_GGX(NoI, roughness);
+	}
+
+	inline glm::vec3 F_Schlick(const glm::vec3& f0, const float HoO) {
+		return f0 + (glm::vec3(1.0f) - f0) * pow5(1.0f - HoO);
+	}
+
+	inline float pdfD_GGX(const float NoH, const float roughness) {
+		return D_GGX(NoH, roughness) * NoH;
+	}
+
+	inline float pdfCosineWeightedHemisphere(const float cosTheta) {
+		return cosTheta * INV_PI;
+	}
+
+	inline glm::vec3 importanceSampleGGX(const glm::vec2& r, const float roughness) {
+		const float alpha2 = pow2(roughness);
+		const float phi = TWO_PI * r.x;
+		const float cosTheta = std::sqrt((1.0f - r.y) / (1.0f + (alpha2 - 1.0f + SHADER_EPSILON) * r.y));
+		const float sinTheta = std::sqrt(1.0f - pow2(cosTheta));
+
+		return { std::cos(phi) * sinTheta, std::sin(phi) * sinTheta, cosTheta };
+	}
+
+	inline glm::vec3 evaluateBSDF(const SurfaceData& surface, const glm::vec3& outLightDir,
+		const glm::vec3& inLightDir, const glm::vec3& halfVector) {
+		const float NoH = cosThetaTangent(halfVector);
+		const float NoI = cosThetaTangent(inLightDir);
+		const float NoO = cosThetaTangent(outLightDir);
+
+		const float HoO = cosTheta(halfVector, outLightDir);
+
+		const float D = D_GGX(NoH, surface.roughness);
+		const float G = G_Smith(NoO, NoI, surface.roughness);
+		const glm::vec3 F = F_Schlick(surface.reflectance, HoO);
+
+		const glm::vec3 kd = glm::mix(glm::vec3(1.0f) - F, glm::vec3(0.0f), surface.metalness);
+
+		const float specularDenominator = 4.0f * NoO * NoI + SHADER_EPSILON;
+		const glm::vec3 specular = D * F * G / specularDenominator;
+
+		const glm::vec3 diffuse = surface.albedo * kd * INV_PI;
+
+		return diffuse + specular;
+	}
+
+	inline float pdfBSDF(const SurfaceData& surface, const glm::vec3& outLightDir,
+		const glm::vec3& inLightDir, const glm::vec3& halfVector) {
+		const float NoH = cosThetaTangent(halfVector);
+		const float NoI = cosThetaTangent(inLightDir);
+
+		const float IoH = glm::dot(inLightDir, halfVector);
+
+		const float specularPdf = pdfD_GGX(NoH, surface.roughness) / std::max(4.0f * IoH, SHADER_EPSILON);
+		const float diffusePdf = pdfCosineWeightedHemisphere(NoI);
+
+		return glm::mix(diffusePdf, specularPdf, surface.specularProbability);
+	}
+
+	/**
+	 * @brief Samples the incoming direction of the next bounce, as sampleBSDF of bsdf.glsl.
+	 *
+	 * @param lobeSample A random number in [0, 1) choosing the lobe.
+	 * @param directionSample Two random numbers in [0, 1) sampling the direction in the lobe.
+	 * @return The BSDF times the cosine over the pdf of the sample, zero if the sample is unusable.
+	 */
+	inline glm::vec3 sampleBSDF(const SurfaceData& surface, const glm::vec3& outLightDir, glm::vec3& inLightDir,
+		float& pdf, bool& isSpecular, const float lobeSample, const glm::vec2& directionSample) {
+		glm::vec3 halfVector;
+
+		isSpecular = false;
+
+		if (lobeSample < surface.specularProbability) {
+			halfVector = importanceSampleGGX(directionSample, surface.roughness);
+			inLightDir = -glm::reflect(outLightDir, halfVector);
+			isSpecular = true;
+		} else {
+			inLightDir = sampleCosineWeightedHemisphere(directionSample);
+			halfVector = glm::normalize(outLightDir + inLightDir);
+		}
+
+		const float cosine = cosThetaTangent(inLightDir);
+
+		pdf = pdfBSDF(surface, outLightDir, inLightDir, halfVector);
+
+		if (pdf < SHADER_EPSILON) {
+			return glm::vec3(0.0f);
+		}
+
+		const glm::vec3 bsdf = evaluateBSDF(surface, outLightDir, inLightDir, halfVector);
+
+		return bsdf * cosine / pdf;
+	}
+
+	inline float powerHeuristic(const float pdfA, const float pdfB) {
+		const float pdfASq = pow2(pdfA);
+		const float pdfBSq = pow2(pdfB);
+
+		return pdfASq / (pdfASq + pdfBSq);
+	}
+}
@@ -0,0 +1,327 @@
+#include "graphics/reference/reference_denoiser.hpp"
+
+#include "core/jobs/job_system.hpp"
+
+namespace PXTEngine {
+
+	// svgf.glsl
+	static constexpr float MIN_HISTORY_LENGTH = 4.0f;
+
+	// svgf_reproject.comp
+	static constexpr float REPROJECTION_DEPTH_TOLERANCE = 0.1f;
+	static constexpr float REPROJECTION_NORMAL_TOLERANCE = 0.9f;
+	static constexpr int VARIANCE_ESTIMATE_RADIUS = 2;
+
+	// svgf_atrous.comp
+	static constexpr std::array<float, 3> KERNEL_WEIGHTS = { 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };
+
+	static bool hasPrimaryHit(const glm::vec4& normalDepth) {
+		return normalDepth.w > 0.0f;
+	}
+
+	static glm::vec3 demodulate(const glm::vec3& radiance, const glm::vec3& albedo) {
+		return radiance / glm::max(albedo, glm::vec3(1e-3f));
+	}
+
+	static bool isConsistent(const glm::vec4& normalDepth, const glm::vec4& previousNormalDepth) {
+		return hasPrimaryHit(previousNormalDepth) &&
+			std::abs(normalDepth.w - previousNormalDepth.w) < REPROJECTION_DEPTH_TOLERANCE * normalDepth.w &&
+			glm::dot(glm::vec3(normalDepth), glm::vec3(previousNormalDepth)) > REPROJECTION_NORMAL_TOLERANCE;
+	}
+
+	/**
+	 * @brief Runs a pass for every pixel, a row per job.
+	 *
+	 * @return The time spent, in milliseconds.
+	 */
+	static float runPass(const uint32_t width, const uint32_t height, const std::function<void(uint32_t x, uint32_t y)>& pass) {
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		JobSystem::parallelFor(height, 1, [&](const size_t begin, const size_t end) {
+			for (size_t y = begin; y < end; y++) {
+				for (uint32_t x = 0; x < width; x++) {
+					pass(x, static_cast<uint32_t>(y));
+				}
+			}
+		});
+
+		return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	ReferenceDenoiser::ReferenceDenoiser() : ReferenceDenoiser(DenoiserSettings{}) {}
+
+	ReferenceDenoiser::ReferenceDenoiser(const DenoiserSettings& settings) : m_settings(settings) {}
+
+	void ReferenceDenoiser::resize(const uint32_t width, const uint32_t height) {
+		if (width == m_width && height == m_height) {
+			return;
+		}
+
+		m_width = width;
+		m_height = height;
+
+		const size_t pixelCount = static_cast<size_t>(width) * height;
+		m_previousNormalDepth.assign(pixelCount, glm::vec4(0.0f));
+		m_historyColor.assign(pixelCount, glm::vec4(0.0f));
+		m_historyMoments.assign(pixelCount, glm::vec4(0.0f));
+		m_integratedMoments.assign(pixelCount, glm::vec4(0.0f));
+		m_filterPing.assign(pixelCount, glm::vec4(0.0f));
+		m_filterPong.assign(pixelCount, glm::vec4(0.0f));
+
+		m_isHistoryValid = false;
+	}
+
+	DenoiserTimings ReferenceDenoiser::denoise(const ReferencePathTracer::Features& features, const uint32_t width,
+		const uint32_t height, std::vector<glm::vec4>& output) {
+		PXT_PROFILE_FN();
+
+		PXT_ASSERT(features.radiance.size() == static_cast<size_t>(width) * height, "The features do not match the size of the image");
+
+		resize(width, height);
+		output.resize(static_cast<size_t>(width) * height);
+
+		const int iterations = std::clamp(m_settings.filterIterations, 1, DenoiserSettings::MAX_FILTER_ITERATIONS);
+
+		DenoiserTimings timings;
+
+		timings.reprojectMs = runPass(width, height, [&](const uint32_t x, const uint32_t y) {
+			reproject(features, x, y);
+		});
+
+		// the reprojection writes the ping image, then the iterations alternate between ping and pong
+		for (int i = 0; i < iterations; i++) {
+			const bool readPong = i % 2 == 1;
+			const std::vector<glm::vec4>& input = readPong ? m_filterPong : m_filterPing;
+			std::vector<glm::vec4>& filtered = readPong ? m_filterPing : m_filterPong;
+
+			timings.filterMs += runPass(width, height, [&](const uint32_t x, const uint32_t y) {
+				atrous(features, input, filtered, 1 << i, i == 0, x, y);
+			});
+		}
+
+		const std::vector<glm::vec4>& filtered = iterations % 2 == 1 ? m_filterPong : m_filterPing;
+
+		timings.modulateMs = runPass(width, height, [&](const uint32_t x, const uint32_t y) {
+			modulate(features, filtered, output, x, y);
+		});
+
+		m_isHistoryValid = true;
+
+		return timings;
+	}
+
+	float ReferenceDenoiser::computeRmse(const std::vector<glm::vec4>& image, const std::vector<glm::vec4>& reference) {
+		PXT_ASSERT(image.size() == reference.size(), "The images do not have the same size");
+
+		if (image.empty()) {
+			return 0.0f;
+		}
+
+		double squaredErrorSum = 0.0;
+		for (size_t i = 0; i < image.size(); i++) {
+			const glm::vec3 difference = glm::vec3(image[i]) - glm::vec3(reference[i]);
+			squaredErrorSum += glm::dot(difference, difference);
+		}
+
+		return static_cast<float>(std::sqrt(squaredErrorSum / (static_cast<double>(image.size()) * 3.0)));
+	}
+
+	float ReferenceDenoiser::geometryWeight(const glm::vec4& normalDepth, const glm::vec4& otherNormalDepth, const float distance) const {
+		const float normalWeight = std::pow(std::max(glm::dot(glm::vec3(normalDepth), glm::vec3(otherNormalDepth)), 0.0f), m_settings.normalPhi);
+		const float depthWeight = std::exp(-std::abs(normalDepth.w - otherNormalDepth.w) / (m_settings.depthPhi * normalDepth.w * distance + 1e-4f));
+
+		return normalWeight * depthWeight;
+	}
+
+	float ReferenceDenoiser::estimateSpatialVariance(const ReferencePathTracer::Features& features, const int x, const int y,
+		const glm::vec4& normalDepth) const {
+		glm::vec2 moments(0.0f);
+		float weightSum = 0.0f;
+
+		for (int offsetY = -VARIANCE_ESTIMATE_RADIUS; offsetY <= VARIANCE_ESTIMATE_RADIUS; offsetY++) {
+			for (int offsetX = -VARIANCE_ESTIMATE_RADIUS; offsetX <= VARIANCE_ESTIMATE_RADIUS; offsetX++) {
+				const int neighbourX = x + offsetX;
+				const int neighbourY = y + offsetY;
+				if (!isInsideImage(neighbourX, neighbourY)) continue;
+
+				const size_t neighbour = getIndex(neighbourX, neighbourY);
+				if (!hasPrimaryHit(features.normalDepth[neighbour])) continue;
+
+				const float weight = geometryWeight(normalDepth, features.normalDepth[neighbour], glm::length(glm::vec2(offsetX, offsetY)));
+				const glm::vec3 color = demodulate(glm::vec3(features.radiance[neighbour]), glm::vec3(features.albedo[neighbour]));
+				const float neighbourLuminance = luminance(color);
+
+				moments += glm::vec2(neighbourLuminance, pow2(neighbourLuminance)) * weight;
+				weightSum += weight;
+			}
+		}
+
+		moments /= std::max(weightSum, 1e-4f);
+
+		return std::max(moments.y - pow2(moments.x), 0.0f);
+	}
+
+	void ReferenceDenoiser::reproject(const ReferencePathTracer::Features& features, const uint32_t x, const uint32_t y) {
+		const size_t pixel = getIndex(x, y);
+
+		const glm::vec3 radiance(features.radiance[pixel]);
+		const glm::vec4& normalDepth = features.normalDepth[pixel];
+
+		// the sky is not noisy, it goes through the filter unchanged
+		if (!hasPrimaryHit(normalDepth)) {
+			m_filterPing[pixel] = glm::vec4(radiance, 0.0f);
+			m_integratedMoments[pixel] = glm::vec4(0.0f);
+			return;
+		}
+
+		const glm::vec3 color = demodulate(radiance, glm::vec3(features.albedo[pixel]));
+		const float colorLuminance = luminance(color);
+
+		// bilinear reprojection, the taps on a different surface are left out
+		const glm::vec2 previousPosition = glm::vec2(x, y) + glm::vec2(features.motion[pixel]);
+		const glm::ivec2 previousPixel(glm::floor(previousPosition));
+		const glm::vec2 fraction = previousPosition - glm::vec2(previousPixel);
+
+		glm::vec3 previousColor(0.0f);
+		glm::vec3 previousMoments(0.0f);
+		float previousWeight = 0.0f;
+
+		if (m_isHistoryValid) {
+			for (int tap = 0; tap < 4; tap++) {
+				const glm::ivec2 offset(tap & 1, tap >> 1);
+				const glm::ivec2 tapPixel = previousPixel + offset;
+				if (!isInsideImage(tapPixel.x, tapPixel.y)) continue;
+
+				const size_t tapIndex = getIndex(tapPixel.x, tapPixel.y);
+				if (!isConsistent(normalDepth, m_previousNormalDepth[tapIndex])) continue;
+
+				const glm::vec2 bilinear = glm::mix(1.0f - fraction, fraction, glm::vec2(offset));
+				const float weight = bilinear.x * bilinear.y;
+
+				previousColor += glm::vec3(m_historyColor[tapIndex]) * weight;
+				previousMoments += glm::vec3(m_historyMoments[tapIndex]) * weight;
+				previousWeight += weight;
+			}
+		}
+
+		const bool isHistoryValid = previousWeight > 0.01f;
+
+		float historyLength = 1.0f;
+		glm::vec3 integratedColor = color;
+		glm::vec2 moments(colorLuminance, pow2(colorLuminance));
+
+		if (isHistoryValid) {
+			previousColor /= previousWeight;
+			previousMoments /= previousWeight;
+
+			// an exponential moving average, which is a plain average while the history is short
+			historyLength = std::min(previousMoments.z + 1.0f, 255.0f);
+			const float colorAlpha = std::max(m_settings.temporalAlpha, 1.0f / historyLength);
+			const float momentsAlpha = std::max(m_settings.momentsAlpha, 1.0f / historyLength);
+
+			integratedColor = glm::mix(previousColor, color, colorAlpha);
+			moments = glm::mix(glm::vec2(previousMoments), moments, momentsAlpha);
+		}
+
+		float variance = std::max(moments.y - pow2(moments.x), 0.0f);
+		if (historyLength < MIN_HISTORY_LENGTH) {
+			// boosted while the history is short, to filter more the pixels that were just disoccluded
+			variance = estimateSpatialVariance(features, x, y, normalDepth) * MIN_HISTORY_LENGTH / historyLength;
+		}
+
+		m_filterPing[pixel] = glm::vec4(integratedColor, variance);
+		m_integratedMoments[pixel] = glm::vec4(moments, historyLength, 0.0f);
+	}
+
+	float ReferenceDenoiser::prefilterVariance(const std::vector<glm::vec4>& input, const int x, const int y) const {
+		const std::array<float, 2> weights = { 1.0f / 4.0f, 1.0f / 8.0f };
+
+		float variance = 0.0f;
+		float weightSum = 0.0f;
+
+		for (int offsetY = -1; offsetY <= 1; offsetY++) {
+			for (int offsetX = -1; offsetX <= 1; offsetX++) {
+				if (!isInsideImage(x + offsetX, y + offsetY)) continue;
+
+				const float weight = weights[std::abs(offsetX)] * weights[std::abs(offsetY)];
+				variance += input[getIndex(x + offsetX, y + offsetY)].a * weight;
+				weightSum += weight;
+			}
+		}
+
+		return variance / weightSum;
+	}
+
+	void ReferenceDenoiser::atrous(const ReferencePathTracer::Features& features, const std::vector<glm::vec4>& input,
+		std::vector<glm::vec4>& filtered, const int stepSize, const bool writeHistory, const uint32_t x, const uint32_t y) {
+		const size_t pixel = getIndex(x, y);
+
+		const glm::vec4& center = input[pixel];
+		const glm::vec4& normalDepth = features.normalDepth[pixel];
+
+		glm::vec4 result = center;
+
+		if (hasPrimaryHit(normalDepth)) {
+			const float centerLuminance = luminance(glm::vec3(center));
+			const float luminanceScale = m_settings.colorPhi * std::sqrt(prefilterVariance(input, x, y)) + 1e-4f;
+
+			// the center has weight KERNEL_WEIGHTS[0]^2
+			glm::vec3 colorSum = glm::vec3(center) * pow2(KERNEL_WEIGHTS[0]);
+			float varianceSum = center.a * pow2(pow2(KERNEL_WEIGHTS[0]));
+			float weightSum = pow2(KERNEL_WEIGHTS[0]);
+
+			for (int offsetY = -2; offsetY <= 2; offsetY++) {
+				for (int offsetX = -2; offsetX <= 2; offsetX++) {
+					if (offsetX == 0 && offsetY == 0) continue;
+
+					const int neighbourX = static_cast<int>(x) + offsetX * stepSize;
+					const int neighbourY = static_cast<int>(y) + offsetY * stepSize;
+					if (!isInsideImage(neighbourX, neighbourY)) continue;
+
+					const size_t neighbour = getIndex(neighbourX, neighbourY);
+					const glm::vec4& neighbourNormalDepth = features.normalDepth[neighbour];
+					if (!hasPrimaryHit(neighbourNormalDepth)) continue;
+
+					const glm::vec4& neighbourColor = input[neighbour];
+
+					const float luminanceWeight = std::exp(-std::abs(centerLuminance - luminance(glm::vec3(neighbourColor))) / luminanceScale);
+					const float edgeWeight = geometryWeight(normalDepth, neighbourNormalDepth,
+						glm::length(glm::vec2(offsetX, offsetY)) * static_cast<float>(stepSize)) * luminanceWeight;
+					const float weight = KERNEL_WEIGHTS[std::abs(offsetX)] * KERNEL_WEIGHTS[std::abs(offsetY)] * edgeWeight;
+
+					colorSum += glm::vec3(neighbourColor) * weight;
+					varianceSum += neighbourColor.a * pow2(weight);
+					weightSum += weight;
+				}
+			}
+
+			// the variance of a weighted average of independent samples
+			result = glm::vec4(colorSum / weightSum, varianceSum / pow2(weightSum));
+		}
+
+		filtered[pixel] = result;
+
+		if (writeHistory) {
+			m_historyColor[pixel] = glm::vec4(glm::vec3(result), 0.0f);
+		}
+	}
+
+	void ReferenceDenoiser::modulate(const ReferencePathTracer::Features& features, const std::vector<glm::vec4>& filtered,
+		std::vector<glm::vec4>& output, const uint32_t x, const uint32_t y) {
+		const size_t pixel = getIndex(x, y);
+
+		const glm::vec4& normalDepth = features.normalDepth[pixel];
+		const glm::vec3 filteredColor(filtered[pixel]);
+
+		// the albedo removed before filtering is put back, the sky was not demodulated
+		glm::vec3 color = hasPrimaryHit(normalDepth) ? filteredColor * glm::vec3(features.albedo[pixel]) : filteredColor;
+
+		color = glm::clamp(color, 0.0f, 1.0f);
+
+		output[pixel] = glm::vec4(color, 1.0f);
+
+		// this pass becomes the history of the next one
+		m_previousNormalDepth[pixel] = normalDepth;
+		m_historyMoments[pixel] = m_integratedMoments[pixel];
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "graphics/denoiser_settings.hpp"
+#include "graphics/reference/reference_path_tracer.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class ReferenceDenoiser
+	 *
+	 * @brief CPU port of the SVGF compute shaders in shaders/denoiser.
+	 *
+	 * It filters the features of a ReferencePathTracer pass with the same reprojection, variance estimate
+	 * and a-trous iterations as DenoiserRenderSystem, keeping its history between calls. The passes run
+	 * as JobSystem jobs, a row per job. It is meant for headless renders and to measure the error of
+	 * the denoiser against a high sample count reference, with computeRmse().
+	 *
+	 * The images are kept in full floats, where the GPU stores half floats.
+	 */
+	class ReferenceDenoiser {
+	public:
+		ReferenceDenoiser();
+		ReferenceDenoiser(const DenoiserSettings& settings);
+
+		/**
+		 * @brief Filters the last pass of the path tracer and adds it to the history.
+		 *
+		 * The history is cleared if the size of the image changes.
+		 *
+		 * @param features The features of the pass, see ReferencePathTracer::getFeatures().
+		 * @param width The width of the image.
+		 * @param height The height of the image.
+		 * @param output The denoised image, row by row, saturated as the scene image of the GPU.
+		 * @return The time spent in each pass.
+		 */
+		DenoiserTimings denoise(const ReferencePathTracer::Features& features, uint32_t width, uint32_t height,
+			std::vector<glm::vec4>& output);
+
+		void resetHistory() { m_isHistoryValid = false; }
+
+		void setSettings(const DenoiserSettings& settings) { m_settings = settings; }
+		const DenoiserSettings& getSettings() const { return m_settings; }
+
+		/**
+		 * @brief Root mean squared error of the RGB channels of an image against a reference of the same size.
+		 */
+		static float computeRmse(const std::vector<glm::vec4>& image, const std::vector<glm::vec4>& reference);
+
+	private:
+		void resize(uint32_t width, uint32_t height);
+
+		// svgf_reproject.comp
+		void reproject(const ReferencePathTracer::Features& features, uint32_t x, uint32_t y);
+		float estimateSpatialVariance(const ReferencePathTracer::Features& features, int x, int y, const glm::vec4& normalDepth) const;
+
+		// svgf_atrous.comp
+		void atrous(const ReferencePathTracer::Features& features, const std::vector<glm::vec4>& input,
+			std::vector<glm::vec4>& filtered, int stepSize, bool writeHistory, uint32_t x, uint32_t y);
+		float prefilterVariance(const std::vector<glm::vec4>& input, int x, int y) const;
+
+		// svgf_modulate.comp
+		void modulate(const ReferencePathTracer::Features& features, const std::vector<glm::vec4>& filtered,
+			std::vector<glm::vec4>& output, uint32_t x, uint32_t y);
+
+		float geometryWeight(const glm::vec4& normalDepth, const glm::vec4& otherNormalDepth, float distance) const;
+
+		bool isInsideImage(const int x, const int y) const {
+			return x >= 0 && y >= 0 && x < static_cast<int>(m_width) && y < static_cast<int>(m_height);
+		}
+
+		size_t getIndex(const int x, const int y) const {
+			return static_cast<size_t>(y) * m_width + static_cast<size_t>(x);
+		}
+
+		DenoiserSettings m_settings;
+
+		uint32_t m_width = 0;
+		uint32_t m_height = 0;
+
+		std::vector<glm::vec4> m_previousNormalDepth;
+		std::vector<glm::vec4> m_historyColor;
+		std::vector<glm::vec4> m_historyMoments;
+		std::vector<glm::vec4> m_integratedMoments;
+		std::vector<glm::vec4> m_filterPing;
+		std::vector<glm::vec4> m_filterPong;
+		bool m_isHistoryValid = false;
+	};
+}
@@ -0,0 +1,631 @@
+#include "graphics/reference/reference_path_tracer.hpp"
+
+#include "core/jobs/job_system.hpp"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+namespace PXTEngine {
+
+	// common/ray.glsl
+	static constexpr float RAY_T_MIN = 0.001f;
+	static constexpr float RAY_T_MAX = 10000.0f;
+
+	// pathtracing.rchit
+	static constexpr uint32_t MIN_DEPTH = 3;
+
+	// sky.glsl
+	static constexpr bool USE_SKY_AS_NEE_EMITTER = true;
+
+	// pathtracing.rgen
+	static constexpr float MIN_CONVERGENCE_SAMPLES = 16.0f;
+	static constexpr uint32_t MAX_ADAPTIVE_SAMPLES = 4;
+	static constexpr float CONVERGENCE_MIN_LUMINANCE = 0.05f;
+
+	// the values of the default pixels, sampled when a material has no map
+	static const glm::vec4 DEFAULT_ALBEDO{ 1.0f };
+	static const glm::vec4 DEFAULT_NORMAL{ 128.0f / 255.0f, 128.0f / 255.0f, 1.0f, 1.0f };
+	static const glm::vec4 DEFAULT_METALLIC{ 0.0f, 0.0f, 0.0f, 1.0f };
+	static const glm::vec4 DEFAULT_ROUGHNESS{ 128.0f / 255.0f, 128.0f / 255.0f, 128.0f / 255.0f, 1.0f };
+	static const glm::vec4 DEFAULT_EMISSIVE{ 0.0f, 0.0f, 0.0f, 1.0f };
+
+	/*
+	 * Triangle helpers of common/geometry.glsl, barycentrics weight the second and third vertex.
+	 */
+
+	struct Triangle {
+		const Mesh::Vertex& v0;
+		const Mesh::Vertex& v1;
+		const Mesh::Vertex& v2;
+	};
+
+	static Triangle getTriangle(const ReferenceScene::MeshData& mesh, const uint32_t faceIndex) {
+		return {
+			mesh.vertices[mesh.indices[faceIndex * 3 + 0]],
+			mesh.vertices[mesh.indices[faceIndex * 3 + 1]],
+			mesh.vertices[mesh.indices[faceIndex * 3 + 2]]
+		};
+	}
+
+	template <typename T>
+	static T barycentricLerp(const T& a, const T& b, const T& c, const glm::vec2& barycentrics) {
+		const float bZ = 1.0f - barycentrics.x - barycentrics.y;
+		return bZ * a + barycentrics.x * b + barycentrics.y * c;
+	}
+
+	static glm::vec2 getTextureCoords(const Triangle& triangle, const glm::vec2& barycentrics) {
+		return barycentricLerp(glm::vec2(triangle.v0.uv), glm::vec2(triangle.v1.uv), glm::vec2(triangle.v2.uv), barycentrics);
+	}
+
+	static glm::vec3 getPosition(const Triangle& triangle, const glm::vec2& barycentrics) {
+		return barycentricLerp(glm::vec3(triangle.v0.position), glm::vec3(triangle.v1.position), glm::vec3(triangle.v2.position), barycentrics);
+	}
+
+	static glm::vec3 getNormal(const Triangle& triangle, const glm::vec2& barycentrics) {
+		return glm::normalize(barycentricLerp(glm::vec3(triangle.v0.normal), glm::vec3(triangle.v1.normal), glm::vec3(triangle.v2.normal), barycentrics));
+	}
+
+	static glm::vec4 getTangent(const Triangle& triangle, const glm::vec2& barycentrics) {
+		return glm::normalize(barycentricLerp(triangle.v0.tangent, triangle.v1.tangent, triangle.v2.tangent, barycentrics));
+	}
+
+	static float calculateWorldSpaceTriangleArea(const Triangle& triangle, const glm::mat3& objectToWorld) {
+		const glm::vec3 v0 = objectToWorld * glm::vec3(triangle.v0.position);
+		const glm::vec3 v1 = objectToWorld * glm::vec3(triangle.v1.position);
+		const glm::vec3 v2 = objectToWorld * glm::vec3(triangle.v2.position);
+		return 0.5f * glm::length(glm::cross(v1 - v0, v2 - v0));
+	}
+
+	static glm::mat3 calculateTBN(const Triangle& triangle, const glm::mat3& objectToWorld, const glm::vec2& barycentrics) {
+		const glm::vec3 objectNormal = getNormal(triangle, barycentrics);
+		const glm::vec4 objectTangent = getTangent(triangle, barycentrics);
+
+		const glm::vec3 worldNormal = glm::normalize(objectToWorld * objectNormal);
+		const glm::vec3 worldTangent = glm::normalize(objectToWorld * glm::vec3(objectTangent));
+		const float handedness = objectTangent.w;
+
+		const glm::vec3 N = worldNormal;
+		const glm::vec3 T = glm::normalize(worldTangent - glm::dot(worldNormal, worldTangent) * worldNormal);
+		const glm::vec3 B = glm::normalize(glm::cross(N, T) * handedness);
+
+		return glm::mat3(T, B, N);
+	}
+
+	static glm::vec4 sampleMap(const ReferenceTexture* map, const glm::vec2& uv, const glm::vec4& fallback) {
+		return map ? map->sample(uv) : fallback;
+	}
+
+	static glm::vec3 getEmission(const ReferenceScene::MaterialData& material, const glm::vec2& uv) {
+		const glm::vec3 emissive = sampleMap(material.emissiveMap, uv, DEFAULT_EMISSIVE);
+
+		// the alpha channel is the intensity
+		return emissive * glm::vec3(material.emissiveColor) * material.emissiveColor.a;
+	}
+
+	/**
+	 * @brief Relative standard error of the mean luminance of a pixel, getRelativeError of pathtracing.rgen.
+	 */
+	static float getRelativeError(const glm::vec4& pixelStats) {
+		const float mean = pixelStats.x / pixelStats.z;
+		const float variance = std::max(pixelStats.y / pixelStats.z - mean * mean, 0.0f);
+
+		return std::sqrt(variance / pixelStats.z) / std::max(mean, CONVERGENCE_MIN_LUMINANCE);
+	}
+
+	ReferencePathTracer::ReferencePathTracer() : ReferencePathTracer(Settings{}) {}
+
+	ReferencePathTracer::ReferencePathTracer(const Settings& settings) : m_settings(settings) {}
+
+	void ReferencePathTracer::resize(const uint32_t width, const uint32_t height) {
+		if (width == m_width && height == m_height) {
+			return;
+		}
+
+		m_width = width;
+		m_height = height;
+		m_tileCountX = (width + m_settings.tileSize - 1) / m_settings.tileSize;
+		m_tileCountY = (height + m_settings.tileSize - 1) / m_settings.tileSize;
+
+		m_radianceSum.resize(static_cast<size_t>(width) * height);
+		m_pixelStats.resize(m_radianceSum.size());
+
+		m_features.radiance.assign(m_radianceSum.size(), glm::vec4(0.0f));
+		m_features.normalDepth.assign(m_radianceSum.size(), glm::vec4(0.0f));
+		m_features.albedo.assign(m_radianceSum.size(), glm::vec4(0.0f));
+		m_features.motion.assign(m_radianceSum.size(), glm::vec4(0.0f));
+		m_hasPreviousProjectionView = false;
+
+		resetAccumulation();
+	}
+
+	void ReferencePathTracer::resetAccumulation() {
+		std::fill(m_radianceSum.begin(), m_radianceSum.end(), glm::vec3(0.0f));
+		std::fill(m_pixelStats.begin(), m_pixelStats.end(), glm::vec4(0.0f));
+		m_accumulatedSamples = 0;
+	}
+
+	ReferencePathTracer::PassStats ReferencePathTracer::render(const ReferenceScene& scene, const Camera& camera, const uint32_t frameIndex) {
+		PXT_PROFILE_FN();
+
+		const auto start = std::chrono::high_resolution_clock::now();
+
+		// as MasterRenderSystem, the first pass reprojects with its own camera
+		const glm::mat4 projectionView = camera.getProjectionMatrix() * camera.getViewMatrix();
+
+		const CameraRays cameraRays{
+			glm::vec3(camera.getInverseViewMatrix() * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)),
+			glm::inverse(camera.getProjectionMatrix()),
+			camera.getInverseViewMatrix(),
+			m_hasPreviousProjectionView ? m_previousProjectionView : projectionView
+		};
+
+		m_previousProjectionView = projectionView;
+		m_hasPreviousProjectionView = true;
+
+		PassCounters counters;
+
+		// a tile per job, tiles are small enough to balance the uneven cost of the paths
+		JobSystem::parallelFor(static_cast<size_t>(m_tileCountX) * m_tileCountY, 1, [&](const size_t begin, const size_t end) {
+			for (size_t tile = begin; tile < end; tile++) {
+				renderTile(scene, cameraRays, static_cast<uint32_t>(tile), frameIndex, counters);
+			}
+		});
+
+		m_accumulatedSamples += m_settings.samplesPerPixel;
+
+		PassStats stats;
+		stats.accumulatedSamples = m_accumulatedSamples;
+		stats.invalidSamples = counters.invalidSamples.load();
+		stats.tracedSamples = counters.tracedSamples.load();
+		stats.activePixelCount = counters.activePixelCount.load();
+		stats.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		stats.samplesPerSecond = stats.seconds > 0.0 ? static_cast<double>(stats.tracedSamples) / stats.seconds : 0.0;
+
+		return stats;
+	}
+
+	void ReferencePathTracer::resolve(std::vector<glm::vec4>& image) const {
+		image.resize(m_radianceSum.size());
+
+		const float weight = m_accumulatedSamples > 0 ? 1.0f / static_cast<float>(m_accumulatedSamples) : 0.0f;
+		for (size_t i = 0; i < m_radianceSum.size(); i++) {
+			const float sampleCount = m_pixelStats[i].z;
+			const float pixelWeight = !m_settings.useAdaptiveSampling ? weight : sampleCount > 0.0f ? 1.0f / sampleCount : 0.0f;
+			image[i] = glm::vec4(m_radianceSum[i] * pixelWeight, 1.0f);
+		}
+	}
+
+	void ReferencePathTracer::saveHdr(const std::filesystem::path& path) const {
+		std::vector<glm::vec4> image;
+		resolve(image);
+
+		if (!stbi_write_hdr(path.string().c_str(), static_cast<int>(m_width), static_cast<int>(m_height), 4,
+			reinterpret_cast<const float*>(image.data()))) {
+			throw std::runtime_error("failed to write reference image " + path.string() + "!");
+		}
+	}
+
+	void ReferencePathTracer::renderTile(const ReferenceScene& scene, const CameraRays& camera, const uint32_t tileIndex,
+		const uint32_t frameIndex, PassCounters& counters) {
+		const uint32_t tileX = (tileIndex % m_tileCountX) * m_settings.tileSize;
+		const uint32_t tileY = (tileIndex / m_tileCountX) * m_settings.tileSize;
+		const uint32_t endX = std::min(tileX + m_settings.tileSize, m_width);
+		const uint32_t endY = std::min(tileY + m_settings.tileSize, m_height);
+
+		uint64_t tileInvalidSamples = 0;
+		uint64_t tileTracedSamples = 0;
+		uint32_t tileActivePixelCount = 0;
+
+		for (uint32_t y = tileY; y < endY; y++) {
+			for (uint32_t x = tileX; x < endX; x++) {
+				const size_t pixelIndex = static_cast<size_t>(y) * m_width + x;
+				glm::vec4& pixelStats = m_pixelStats[pixelIndex];
+
+				// a converged pixel keeps its accumulated color, and its features of the last pass it was sampled
+				if (m_settings.useAdaptiveSampling && pixelStats.w > 0.0f) {
+					continue;
+				}
+
+				const uint32_t sampleCount = m_settings.useAdaptiveSampling ? getAdaptiveSampleCount(pixelStats) : m_settings.samplesPerPixel;
+
+				// the adaptive pixels index the low discrepancy samples with their own sample count
+				const uint32_t firstSampleIndex = m_settings.useAdaptiveSampling ? static_cast<uint32_t>(pixelStats.z) : m_accumulatedSamples;
+
+				glm::vec3 passSum(0.0f);
+				glm::vec2 luminanceMoments(0.0f);
+				PixelFeatures features;
+
+				for (uint32_t sample = 0; sample < sampleCount; sample++) {
+					// the features of the last sample, as pathtracing.rgen
+					const bool isLastSample = sample == sampleCount - 1;
+					const glm::vec3 radiance = tracePath(scene, camera, x, y, frameIndex + sample, firstSampleIndex + sample,
+						isLastSample ? &features : nullptr);
+
+					// the shaders paint these magenta, here they are left out and reported
+					if (glm::any(glm::isnan(radiance)) || glm::any(glm::isinf(radiance))) {
+						tileInvalidSamples++;
+						continue;
+					}
+
+					passSum += radiance;
+
+					const float sampleLuminance = luminance(radiance);
+					luminanceMoments += glm::vec2(sampleLuminance, sampleLuminance * sampleLuminance);
+				}
+
+				m_radianceSum[pixelIndex] += passSum;
+				tileTracedSamples += sampleCount;
+
+				if (m_settings.useAdaptiveSampling) {
+					pixelStats.x += luminanceMoments.x;
+					pixelStats.y += luminanceMoments.y;
+					pixelStats.z += static_cast<float>(sampleCount);
+
+					const bool isConverged = pixelStats.z >= MIN_CONVERGENCE_SAMPLES && getRelativeError(pixelStats) < m_settings.convergenceThreshold;
+					pixelStats.w = isConverged ? 1.0f : 0.0f;
+				}
+
+				if (pixelStats.w == 0.0f) {
+					tileActivePixelCount++;
+				}
+
+				m_features.radiance[pixelIndex] = glm::vec4(passSum / static_cast<float>(sampleCount), 1.0f);
+				m_features.normalDepth[pixelIndex] = features.normalDepth;
+				m_features.albedo[pixelIndex] = features.albedo;
+				m_features.motion[pixelIndex] = features.motion;
+			}
+		}
+
+		if (tileInvalidSamples > 0) {
+			counters.invalidSamples += tileInvalidSamples;
+		}
+		counters.tracedSamples += tileTracedSamples;
+		counters.activePixelCount += tileActivePixelCount;
+	}
+
+	uint32_t ReferencePathTracer::getAdaptiveSampleCount(const glm::vec4& pixelStats) const {
+		// one pass until the error is measurable, then more the further the error is from the threshold
+		if (pixelStats.z < MIN_CONVERGENCE_SAMPLES) {
+			return m_settings.samplesPerPixel;
+		}
+
+		const float errorRatio = getRelativeError(pixelStats) / m_settings.convergenceThreshold;
+		return m_settings.samplesPerPixel * static_cast<uint32_t>(std::clamp(std::ceil(errorRatio), 1.0f, static_cast<float>(MAX_ADAPTIVE_SAMPLES)));
+	}
+
+	glm::vec3 ReferencePathTracer::tracePath(const ReferenceScene& scene, const CameraRays& camera,
+		const uint32_t x, const uint32_t y, const uint32_t frameIndex, const uint32_t sampleIndex, PixelFeatures* features) const {
+		// pathtracing.rgen
+		Payload payload;
+		payload.seed = tea(y * m_width + x, frameIndex);
+		payload.sampleDimension = 0;
+		payload.pixel = glm::uvec2(x, y);
+		payload.sampleIndex = sampleIndex;
+
+		const glm::vec2 pixelCenter = glm::vec2(x, y) + glm::vec2(0.5f);
+		const glm::vec2 jitter = nextSample2D(payload) - 0.5f;
+		const glm::vec2 ndc = (pixelCenter + jitter) / glm::vec2(m_width, m_height) * 2.0f - 1.0f;
+
+		const glm::vec4 target = camera.inverseProjection * glm::vec4(ndc.x, ndc.y, 1.0f, 1.0f);
+
+		payload.radiance = glm::vec3(0.0f);
+		payload.throughput = glm::vec3(1.0f);
+		payload.origin = camera.origin;
+		payload.direction = glm::normalize(glm::vec3(camera.inverseView * glm::vec4(glm::normalize(glm::vec3(target) / target.w), 0.0f)));
+		payload.depth = 0;
+		payload.done = false;
+		payload.isSpecularBounce = false;
+		payload.bsdfPdf = 0.0f;
+		payload.primaryNormal = glm::vec3(0.0f);
+		payload.primaryDistance = 0.0f;
+		payload.primaryAlbedo = glm::vec3(1.0f);
+
+		const glm::vec3 cameraDirection = payload.direction;
+
+		while (!payload.done && payload.depth < m_settings.maxBounces) {
+			const Ray ray{ payload.origin, RAY_T_MIN, payload.direction, RAY_T_MAX };
+
+			RayHit hit;
+			if (scene.getBvh().intersect(ray, hit)) {
+				closestHit(scene, hit, payload);
+				continue;
+			}
+
+			// pathtracing.rmiss, after a bounce the sky could also have been sampled explicitly
+			float weight = 1.0f;
+			if (USE_SKY_AS_NEE_EMITTER && payload.depth > 0 && scene.getSkyDistribution()) {
+				const float skyPdf = scene.getSkyDistribution()->pdf(payload.direction) /
+					static_cast<float>(scene.getEmitters().size() + 1);
+				weight = powerHeuristic(payload.bsdfPdf, skyPdf);
+			}
+
+			payload.radiance += getSkyRadiance(scene, payload.direction) * payload.throughput * weight;
+
+			payload.done = true;
+		}
+
+		if (features) {
+			features->normalDepth = glm::vec4(payload.primaryNormal, payload.primaryDistance);
+			// stored as rgba8 by the shaders
+			features->albedo = glm::vec4(glm::clamp(payload.primaryAlbedo, 0.0f, 1.0f), 1.0f);
+			features->motion = glm::vec4(getMotionVector(camera, cameraDirection, payload.primaryDistance, x, y), 0.0f, 0.0f);
+		}
+
+		return payload.radiance;
+	}
+
+	glm::vec2 ReferencePathTracer::getMotionVector(const CameraRays& camera, const glm::vec3& direction,
+		const float primaryDistance, const uint32_t x, const uint32_t y) const {
+		// camera rays that missed are reprojected as directions
+		const glm::vec4 previousPoint = primaryDistance > 0.0f ?
+			glm::vec4(camera.origin + direction * primaryDistance, 1.0f) :
+			glm::vec4(direction, 0.0f);
+
+		const glm::vec4 previousClip = camera.previousProjectionView * previousPoint;
+		const glm::vec2 previousPixel = (glm::vec2(previousClip) / previousClip.w * 0.5f + 0.5f) * glm::vec2(m_width, m_height);
+
+		return previousPixel - (glm::vec2(x, y) + glm::vec2(0.5f));
+	}
+
+	void ReferencePathTracer::closestHit(const ReferenceScene& scene, const RayHit& hit, Payload& payload) const {
+		// pathtracing.rchit
+		const ReferenceScene::Instance& instance = scene.getInstances()[hit.instanceIndex];
+		const ReferenceScene::MaterialData& material = *instance.material;
+		const Triangle triangle = getTriangle(*instance.mesh, hit.primitiveIndex);
+		const glm::vec2 barycentrics(hit.u, hit.v);
+
+		const glm::vec2 uv = getTextureCoords(triangle, barycentrics) * instance.tilingFactor;
+
+		glm::mat3 tbn = calculateTBN(triangle, glm::mat3(instance.objectToWorld), barycentrics);
+
+		// two channel normal maps: z is reconstructed from x and y
+		glm::vec3 normalMapValue = glm::vec3(sampleMap(material.normalMap, uv, DEFAULT_NORMAL)) * 2.0f - 1.0f;
+		if (material.normalMap && material.normalMapChannels == 2) {
+			const glm::vec2 normalXY(normalMapValue);
+			normalMapValue.z = std::sqrt(std::max(1.0f - glm::dot(normalXY, normalXY), 0.0f));
+		}
+		const glm::vec3 surfaceNormal = glm::normalize(tbn * normalMapValue);
+
+		SurfaceData surface;
+		surface.tbn = tbn;
+		surface.albedo = glm::vec3(sampleMap(material.albedoMap, uv, DEFAULT_ALBEDO)) * instance.tint;
+		surface.metalness = sampleMap(material.metallicMap, uv, DEFAULT_METALLIC).r;
+		surface.roughness = pow2(sampleMap(material.roughnessMap, uv, DEFAULT_ROUGHNESS).r);
+		surface.reflectance = calculateReflectance(surface.albedo, surface.metalness);
+		surface.specularProbability = calculateSpecularProbability(surface.albedo, surface.metalness, surface.reflectance);
+
+		const glm::vec3 emission = getEmission(material, uv);
+
+		if (payload.depth == 0) {
+			// emitters are not modulated by their albedo, the denoiser takes them as they are
+			payload.primaryNormal = surfaceNormal;
+			payload.primaryDistance = hit.t;
+			payload.primaryAlbedo = maxComponent(emission) > 0.0f ? glm::vec3(1.0f) : surface.albedo;
+		}
+
+		if (maxComponent(emission) > 0.0f) {
+			// lights are only seen directly or through a mirror bounce, NEE accounts for the rest
+			if (payload.depth == 0 || payload.isSpecularBounce) {
+				payload.radiance += emission * payload.throughput;
+			}
+
+			payload.done = true;
+			return;
+		}
+
+		const glm::vec3 worldPosition = payload.origin + payload.direction * hit.t;
+
+		glm::vec3 outgoingLightDirection = worldToTangent(tbn, -payload.direction);
+		glm::vec3 incomingLightDirection(0.0f);
+
+		directLighting(scene, surface, worldPosition, outgoingLightDirection, payload);
+
+		indirectLighting(surface, outgoingLightDirection, incomingLightDirection, payload);
+
+		// the next direction follows the normal map, the origin offset the geometric normal
+		const glm::vec3 geometricNormal = tbn[2];
+		tbn[2] = surfaceNormal;
+
+		outgoingLightDirection = tangentToWorld(tbn, incomingLightDirection);
+
+		payload.depth++;
+		payload.origin = worldPosition + geometricNormal * SHADER_EPSILON;
+		payload.direction = outgoingLightDirection;
+	}
+
+	float ReferencePathTracer::nextSample1D(Payload& payload) const {
+		if (!m_settings.useLowDiscrepancySamples) {
+			return randomFloat(payload.seed);
+		}
+
+		return m_sampler.sample1D(payload.pixel, payload.sampleIndex, payload.sampleDimension, payload.seed);
+	}
+
+	glm::vec2 ReferencePathTracer::nextSample2D(Payload& payload) const {
+		if (!m_settings.useLowDiscrepancySamples) {
+			return randomVec2(payload.seed);
+		}
+
+		return m_sampler.sample2D(payload.pixel, payload.sampleIndex, payload.sampleDimension, payload.seed);
+	}
+
+	void ReferencePathTracer::sampleEmitter(const ReferenceScene& scene, const SurfaceData& surface,
+		const glm::vec3& worldPosition, Payload& payload, EmitterSample& sample) const {
+		sample = {};
+		sample.lightDistance = RAY_T_MAX;
+
+		const auto& emitters = scene.getEmitters();
+		const uint32_t emitterCount = static_cast<uint32_t>(emitters.size());
+
+		const uint32_t samplableEmitterCount = emitterCount + (USE_SKY_AS_NEE_EMITTER ? 1 : 0);
+
+		if (samplableEmitterCount == 0) {
+			return;
+		}
+
+		// the point on the emitter is drawn first, so that both branches use the same sample dimensions
+		const glm::vec2 emitterPointSample = nextSample2D(payload);
+
+		const uint32_t emitterIndex = nextUint(payload.seed, samplableEmitterCount);
+
+		glm::vec3 worldInLightDir(0.0f);
+
+		if (emitterIndex == emitterCount) {
+			// the sky, proportionally to its luminance
+			const EnvironmentDistribution* skyDistribution = scene.getSkyDistribution();
+			if (!skyDistribution) {
+				return;
+			}
+
+			const uint32_t cellCount = static_cast<uint32_t>(skyDistribution->getCells().size());
+			const uint32_t cellIndex = nextUint(payload.seed, cellCount);
+			const float coin = randomFloat(payload.seed);
+
+			float skyPdf;
+			worldInLightDir = skyDistribution->sampleDirection(cellIndex, coin, emitterPointSample, skyPdf);
+
+			sample.inLightDir = worldToTangent(surface.tbn, worldInLightDir);
+
+			if (sample.inLightDir.z <= 0.0f) {
+				return;
+			}
+
+			sample.pdf = skyPdf / samplableEmitterCount;
+			sample.radiance = getSkyRadiance(scene, worldInLightDir);
+
+			if (sample.radiance == glm::vec3(0.0f)) {
+				return;
+			}
+		} else {
+			uint32_t sampledEmitterIndex = emitterIndex;
+			uint32_t faceIndex;
+			float selectionPdf;
+
+			if (m_settings.useEmitterAliasTables) {
+				// the emitter and its face are picked proportionally to their power with the alias tables
+				const AliasTableEntry& emitterEntry = emitters[emitterIndex].aliasEntry;
+				sampledEmitterIndex = randomFloat(payload.seed) < emitterEntry.probability ? emitterIndex : emitterEntry.alias;
+
+				const EmitterData& emitter = emitters[sampledEmitterIndex];
+				const std::span<const AliasTableEntry> faceTable =
+					std::span(scene.getEmitterFaceTable()).subspan(emitter.faceTableOffset, emitter.numberOfFaces);
+
+				faceIndex = nextUint(payload.seed, emitter.numberOfFaces);
+				faceIndex = sampleAliasTable(faceTable, faceIndex, randomFloat(payload.seed));
+
+				selectionPdf = emitter.aliasEntry.pdf * faceTable[faceIndex].pdf *
+					static_cast<float>(emitterCount) / static_cast<float>(samplableEmitterCount);
+			} else {
+				const uint32_t faceCount = emitters[sampledEmitterIndex].numberOfFaces;
+				faceIndex = nextUint(payload.seed, faceCount);
+				selectionPdf = 1.0f / static_cast<float>(samplableEmitterCount * faceCount);
+			}
+
+			const EmitterData& emitter = emitters[sampledEmitterIndex];
+			const ReferenceScene::Instance& instance = scene.getInstances()[emitter.instanceIndex];
+
+			const float xSqrt = std::sqrt(emitterPointSample.x);
+			const glm::vec2 emitterBarycentrics(1.0f - xSqrt, emitterPointSample.y * xSqrt);
+
+			const Triangle triangle = getTriangle(*instance.mesh, faceIndex);
+			const glm::vec2 uv = getTextureCoords(triangle, emitterBarycentrics) * instance.tilingFactor;
+
+			sample.radiance = getEmission(*instance.material, uv);
+
+			if (sample.radiance == glm::vec3(0.0f)) {
+				return;
+			}
+
+			const glm::vec3 emitterPosition = glm::vec3(instance.objectToWorld * glm::vec4(getPosition(triangle, emitterBarycentrics), 1.0f));
+			// the shaders use the upper 3x3 of the world to object matrix as the normal matrix
+			const glm::vec3 emitterNormal = glm::normalize(glm::mat3(instance.worldToObject) * getNormal(triangle, emitterBarycentrics));
+
+			const glm::vec3 outLightVec = worldPosition - emitterPosition;
+
+			sample.lightDistance = glm::length(outLightVec);
+
+			const float areaWorld = calculateWorldSpaceTriangleArea(triangle, glm::mat3(instance.objectToWorld));
+
+			if (areaWorld <= 0.0f || sample.lightDistance <= 0.0f) {
+				return;
+			}
+
+			const glm::vec3 outLightDir = outLightVec / sample.lightDistance;
+
+			const float emitterCosTheta = cosTheta(emitterNormal, outLightDir);
+			if (emitterCosTheta <= 0.0f) {
+				return;
+			}
+
+			worldInLightDir = -outLightDir;
+			sample.inLightDir = worldToTangent(surface.tbn, worldInLightDir);
+			sample.pdf = pow2(sample.lightDistance) * selectionPdf / (emitterCosTheta * areaWorld);
+		}
+
+		// visibility.rchit/.rmiss: any hit before the emitter occludes it
+		const Ray shadowRay{ worldPosition, RAY_T_MIN, worldInLightDir, std::max(0.0f, sample.lightDistance - SHADER_EPSILON) };
+		sample.isVisible = !scene.getBvh().isOccluded(shadowRay);
+	}
+
+	void ReferencePathTracer::directLighting(const ReferenceScene& scene, const SurfaceData& surface,
+		const glm::vec3& worldPosition, const glm::vec3& outLightDir, Payload& payload) const {
+		EmitterSample emitterSample;
+
+		sampleEmitter(scene, surface, worldPosition, payload, emitterSample);
+
+		if (!emitterSample.isVisible || emitterSample.radiance == glm::vec3(0.0f)) {
+			return;
+		}
+
+		const glm::vec3 halfVector = glm::normalize(outLightDir + emitterSample.inLightDir);
+		const float receiverCos = cosThetaTangent(emitterSample.inLightDir);
+
+		const glm::vec3 bsdf = evaluateBSDF(surface, outLightDir, emitterSample.inLightDir, halfVector);
+		const float bsdfPdf = pdfBSDF(surface, outLightDir, emitterSample.inLightDir, halfVector);
+
+		const glm::vec3 contribution = (emitterSample.radiance * bsdf * receiverCos) / emitterSample.pdf;
+
+		const float weight = powerHeuristic(emitterSample.pdf, bsdfPdf);
+
+		payload.radiance += contribution * payload.throughput * weight;
+	}
+
+	void ReferencePathTracer::indirectLighting(const SurfaceData& surface, const glm::vec3& outLightDir,
+		glm::vec3& inLightDir, Payload& payload) const {
+		float pdf;
+		bool isSpecular;
+		const float lobeSample = nextSample1D(payload);
+		const glm::vec2 directionSample = nextSample2D(payload);
+		const glm::vec3 bsdfMultiplier = sampleBSDF(surface, outLightDir, inLightDir, pdf, isSpecular, lobeSample, directionSample);
+
+		if (bsdfMultiplier == glm::vec3(0.0f)) {
+			payload.done = true;
+			return;
+		}
+
+		// Russian roulette, with a survival probability following the throughput
+		float russianRouletteProbability = 1.0f;
+		if (payload.depth > MIN_DEPTH) {
+			russianRouletteProbability = maxComponent(payload.throughput);
+
+			if (randomFloat(payload.seed) > russianRouletteProbability) {
+				payload.done = true;
+				return;
+			}
+		}
+
+		payload.isSpecularBounce = isSpecular;
+		payload.bsdfPdf = pdf;
+		payload.throughput *= bsdfMultiplier / russianRouletteProbability;
+	}
+
+	glm::vec3 ReferencePathTracer::getSkyRadiance(const ReferenceScene& scene, const glm::vec3& direction) const {
+		const ReferenceCubeMap* sky = scene.getSky();
+		if (!sky) {
+			return glm::vec3(0.0f);
+		}
+
+		const glm::vec4& ambientLight = scene.getAmbientLight();
+		return glm::vec3(sky->sample(direction)) * glm::vec3(ambientLight) * ambientLight.w;
+	}
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "scene/camera.hpp"
+#include "graphics/reference/reference_bsdf.hpp"
+#include "graphics/reference/reference_sampler.hpp"
+#include "graphics/reference/reference_scene.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class ReferencePathTracer
+	 *
+	 * @brief Multithreaded CPU path tracer reproducing the pathtracing ray tracing shaders.
+	 *
+	 * It follows pathtracing.rgen/.rchit/.rmiss step by step (same payload updates, BSDF, emitter and sky
+	 * next event estimation with MIS, Russian roulette and sky lookups) and seeds every path like
+	 * the shaders do, so it is a ground truth for the ray tracing mode on any machine, and a
+	 * headless render backend.
+	 *
+	 * The image is split in tiles rendered as JobSystem jobs. Every render() call adds a pass of
+	 * samples to the accumulation, until resetAccumulation() is called (e.g. when the camera moves).
+	 */
+	class ReferencePathTracer {
+	public:
+		struct Settings {
+			uint32_t samplesPerPixel = 1; // samples per pixel added by every pass
+			uint32_t maxBounces = 3;      // maxBounces of pathtracing.rgen
+			uint32_t tileSize = 16;       // width and height of the tile rendered by a job
+
+			// emitters and their faces picked proportionally to their power with the alias tables,
+			// uniformly otherwise (as before the tables), to compare the convergence of both
+			bool useEmitterAliasTables = true;
+
+			// camera, emitter and BSDF samples from ReferenceSampler, from the tea seeded white noise
+			// generator otherwise (as before the sampler), to compare the convergence of both
+			bool useLowDiscrepancySamples = true;
+
+			// adaptive sampling of pathtracing.rgen: a pixel stops being sampled once the relative error of its
+			// mean luminance is under convergenceThreshold, the noisy ones get up to 4 times samplesPerPixel
+			bool useAdaptiveSampling = false;
+			float convergenceThreshold = 0.01f;
+		};
+
+		struct PassStats {
+			uint32_t accumulatedSamples = 0; // per pixel, this pass included
+			uint64_t invalidSamples = 0;     // NaN or infinite samples of this pass, counted as black
+			uint64_t tracedSamples = 0;      // samples of this pass, over all pixels
+			uint32_t activePixelCount = 0;   // pixels still sampled after this pass, all of them without adaptive sampling
+			double seconds = 0.0;
+			double samplesPerSecond = 0.0;
+		};
+
+		// the inputs of the denoiser written by pathtracing.rgen, row by row
+		struct Features {
+			std::vector<glm::vec4> radiance;    // radiance of the last pass alone (alpha is 1)
+			std::vector<glm::vec4> normalDepth; // world normal and distance of the primary hit, 0 if none
+			std::vector<glm::vec4> albedo;      // albedo of the primary hit
+			std::vector<glm::vec4> motion;      // offset in pixels to the position in the previous pass
+		};
+
+		ReferencePathTracer();
+		ReferencePathTracer(const Settings& settings);
+
+		/**
+		 * @brief Sets the size of the image, clearing the accumulation if it changes.
+		 */
+		void resize(uint32_t width, uint32_t height);
+
+		void resetAccumulation();
+
+		/**
+		 * @brief Renders a pass of samples and adds it to the accumulation.
+		 *
+		 * @param frameIndex The frameCount of the first sample, consecutive samples use the next ones.
+		 *                   Matching the frameCount of the GPU makes the paths draw the same random numbers.
+		 *                   The low discrepancy samples are indexed by the accumulated samples, as the shaders
+		 *                   do with accumulation enabled.
+		 */
+		PassStats render(const ReferenceScene& scene, const Camera& camera, uint32_t frameIndex);
+
+		/**
+		 * @brief The features of the last pass. The motion reprojects with the camera of the previous
+		 *        render() call, as the shaders do with the camera of the previous frame.
+		 */
+		const Features& getFeatures() const { return m_features; }
+
+		/**
+		 * @brief Writes the average radiance of every pixel, row by row (alpha is 1). With adaptive sampling,
+		 *        every pixel is averaged over its own sample count.
+		 */
+		void resolve(std::vector<glm::vec4>& image) const;
+
+		/**
+		 * @brief Writes the resolved image as a Radiance HDR file.
+		 */
+		void saveHdr(const std::filesystem::path& path) const;
+
+		uint32_t getWidth() const { return m_width; }
+		uint32_t getHeight() const { return m_height; }
+		uint32_t getAccumulatedSamples() const { return m_accumulatedSamples; }
+		const Settings& getSettings() const { return m_settings; }
+
+	private:
+		// PathTracePayload of the shaders
+		struct Payload {
+			glm::vec3 radiance;
+			glm::vec3 throughput;
+			uint32_t depth;
+			glm::vec3 origin;
+			glm::vec3 direction;
+			bool done;
+			uint32_t seed;
+			uint32_t sampleDimension;
+			bool isSpecularBounce;
+			float bsdfPdf;
+
+			// gl_LaunchIDEXT and getSampleIndex() of the shaders
+			glm::uvec2 pixel;
+			uint32_t sampleIndex;
+
+			glm::vec3 primaryNormal;
+			float primaryDistance;
+			glm::vec3 primaryAlbedo;
+		};
+
+		struct PixelFeatures {
+			glm::vec4 normalDepth;
+			glm::vec4 albedo;
+			glm::vec4 motion;
+		};
+
+		struct EmitterSample {
+			glm::vec3 radiance{ 0.0f };
+			glm::vec3 inLightDir{ 0.0f };
+			float lightDistance = 0.0f;
+			float pdf = 0.0f;
+			bool isVisible = false;
+		};
+
+		struct CameraRays {
+			glm::vec3 origin;
+			glm::mat4 inverseProjection;
+			glm::mat4 inverseView;
+			glm::mat4 previousProjectionView;
+		};
+
+		// the counters of a pass, summed over the tiles
+		struct PassCounters {
+			std::atomic<uint64_t> invalidSamples = 0;
+			std::atomic<uint64_t> tracedSamples = 0;
+			std::atomic<uint32_t> activePixelCount = 0;
+		};
+
+		void renderTile(const ReferenceScene& scene, const CameraRays& camera, uint32_t tileIndex,
+			uint32_t frameIndex, PassCounters& counters);
+
+		// getAdaptiveSampleCount of pathtracing.rgen
+		uint32_t getAdaptiveSampleCount(const glm::vec4& pixelStats) const;
+
+		glm::vec3 tracePath(const ReferenceScene& scene, const CameraRays& camera, uint32_t x, uint32_t y,
+			uint32_t frameIndex, uint32_t sampleIndex, PixelFeatures* features = nullptr) const;
+
+		// getMotionVector of pathtracing.rgen
+		glm::vec2 getMotionVector(const CameraRays& camera, const glm::vec3& direction, float primaryDistance,
+			uint32_t x, uint32_t y) const;
+
+		// nextSample1D and nextSample2D of pathtracing.rchit
+		float nextSample1D(Payload& payload) const;
+		glm::vec2 nextSample2D(Payload& payload) const;
+
+		void closestHit(const ReferenceScene& scene, const RayHit& hit, Payload& payload) const;
+
+		void sampleEmitter(const ReferenceScene& scene, const SurfaceData& surface, const glm::vec3& worldPosition,
+			Payload& payload, EmitterSample& sample) const;
+
+		void directLighting(const ReferenceScene& scene, const SurfaceData& surface, const glm::vec3& worldPosition,
+			const glm::vec3& outLightDir, Payload& payload) const;
+
+		void indirectLighting(const SurfaceData& surface, const glm::vec3& outLightDir, glm::vec3& inLightDir, Payload& payload) const;
+
+		glm::vec3 getSkyRadiance(const ReferenceScene& scene, const glm::vec3& direction) const;
+
+		Settings m_settings;
+		ReferenceSampler m_sampler;
+
+		uint32_t m_width = 0;
+		uint32_t m_height = 0;
+		uint32_t m_tileCountX = 0;
+		uint32_t m_tileCountY = 0;
+
+		std::vector<glm::vec3> m_radianceSum;
+		uint32_t m_accumulatedSamples = 0;
+
+		// the convergence image of the shaders: luminance sum, squared luminance sum, sample count and
+		// converged flag of every pixel, with adaptive sampling
+		std::vector<glm::vec4> m_pixelStats;
+
+		Features m_features;
+		glm::mat4 m_previousProjectionView{ 1.0f };
+		bool m_hasPreviousProjectionView = false;
+	};
+}
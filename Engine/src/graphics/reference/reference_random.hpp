@@ -0,0 +1,63 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+/*
+ * CPU port of shaders/common/random.glsl, the reference renderer draws the same
+ * sequence of random numbers as the shaders for the same pixel, frame and seed.
+ */
+namespace PXTEngine {
+
+	// 1 / UINT_MAX, the factor turning a random uint into a float in [0, 1]
+	inline constexpr float INV_UINT_MAX = 2.3283064365386963e-10f;
+
+	/**
+	 * @brief Tiny Encryption Algorithm hash, used to seed a path from its pixel and frame.
+	 */
+	inline uint32_t tea(uint32_t v0, uint32_t v1) {
+		uint32_t s0 = 0;
+		for (uint32_t n = 0; n < 4; n++) {
+			s0 += 0x9e3779b9;
+			v0 += ((v1 << 4) + 0xa341316c) ^ (v1 + s0) ^ ((v1 >> 5) + 0xc8013ea4);
+			v1 += ((v0 << 4) + 0xad90777d) ^ (v0 + s0) ^ ((v0 >> 5) + 0x7e95761e);
+		}
+		return v0;
+	}
+
+	inline uint32_t pcgHash(const uint32_t x) {
+		const uint32_t state = x * 747796405u + 2891336453u;
+		const uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+
+		return (word >> 22u) ^ word;
+	}
+
+	inline float randomFloat(uint32_t& seed) {
+		const uint32_t result = pcgHash(seed);
+
+		seed++;
+
+		return static_cast<float>(result) * INV_UINT_MAX;
+	}
+
+	inline uint32_t nextUint(uint32_t& seed, const uint32_t max) {
+		const uint32_t result = pcgHash(seed);
+
+		seed++;
+
+		return result % max;
+	}
+
+	// the arguments of a glsl constructor are evaluated left to right, they are here as well
+	inline glm::vec2 randomVec2(uint32_t& seed) {
+		const float x = randomFloat(seed);
+		const float y = randomFloat(seed);
+		return { x, y };
+	}
+
+	inline glm::vec3 randomVec3(uint32_t& seed) {
+		const float x = randomFloat(seed);
+		const float y = randomFloat(seed);
+		const float z = randomFloat(seed);
+		return { x, y, z };
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "graphics/resources/sampler_tables.hpp"
+#include "graphics/reference/reference_random.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class ReferenceSampler
+	 *
+	 * @brief CPU port of shaders/common/sampler.glsl.
+	 *
+	 * The tables are generated with the same defaults as the ones uploaded for the shaders, so the
+	 * reference renderer draws the same low discrepancy samples for the same pixel, sample and dimension.
+	 */
+	class ReferenceSampler {
+	public:
+		float sampleDimension(const glm::uvec2& pixel, const uint32_t sampleIndex, const uint32_t dimension, uint32_t& seed) const {
+			if (dimension >= m_sobolTable.getDimensionCount()) {
+				return randomFloat(seed);
+			}
+
+			const uint32_t passIndex = sampleIndex / m_sobolTable.getSampleCount();
+			const uint32_t tableSample = m_sobolTable.get(sampleIndex % m_sobolTable.getSampleCount(), dimension);
+
+			const uint32_t value = tableSample + blueNoiseThreshold(pixel, dimension) + pcgHash(passIndex * m_sobolTable.getDimensionCount() + dimension);
+
+			// 24 bits keep the float strictly under 1
+			return static_cast<float>(value >> 8) * (1.0f / 16777216.0f);
+		}
+
+		float sample1D(const glm::uvec2& pixel, const uint32_t sampleIndex, uint32_t& dimension, uint32_t& seed) const {
+			return sampleDimension(pixel, sampleIndex, dimension++, seed);
+		}
+
+		glm::vec2 sample2D(const glm::uvec2& pixel, const uint32_t sampleIndex, uint32_t& dimension, uint32_t& seed) const {
+			dimension = (dimension + 1) & ~1u;
+
+			const float x = sampleDimension(pixel, sampleIndex, dimension, seed);
+			const float y = sampleDimension(pixel, sampleIndex, dimension + 1, seed);
+			dimension += 2;
+
+			return { x, y };
+		}
+
+	private:
+		uint32_t blueNoiseThreshold(const glm::uvec2& pixel, const uint32_t dimension) const {
+			// R2 sequence, offsets the blue noise of every dimension
+			const glm::vec2 r2Offset(0.75487766624f, 0.56984029099f);
+
+			const uint32_t size = m_blueNoise.getSize();
+			const glm::uvec2 offset(glm::fract(static_cast<float>(dimension) * r2Offset) * static_cast<float>(size));
+			const glm::uvec2 texel = (pixel + offset) % size;
+
+			return static_cast<uint32_t>(m_blueNoise.getThreshold(texel.x, texel.y)) << 16;
+		}
+
+		SobolTable m_sobolTable;
+		BlueNoiseTexture m_blueNoise;
+	};
+}
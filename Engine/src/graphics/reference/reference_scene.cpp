@@ -0,0 +1,48 @@
+#include "graphics/reference/reference_scene.hpp"
+
+namespace PXTEngine {
+
+	Unique<ReferenceScene::MeshData> ReferenceScene::createMeshData(std::vector<Mesh::Vertex> vertices, std::vector<uint32_t> indices) {
+		auto data = createUnique<MeshData>();
+		data->vertices = std::move(vertices);
+		data->indices = std::move(indices);
+
+		if (data->indices.empty()) {
+			data->indices.resize(data->vertices.size());
+			std::iota(data->indices.begin(), data->indices.end(), 0);
+		}
+
+		EmitterTableBuilder::calculateFaceAreaVectors(data->vertices, data->indices, data->faceAreaVectors);
+		data->bvh.build(data->vertices, data->indices);
+
+		return data;
+	}
+
+	void ReferenceScene::clearInstances() {
+		m_instances.clear();
+		m_emitterTables.clear();
+	}
+
+	void ReferenceScene::addInstance(const Instance& instance, const bool isEmissive) {
+		if (isEmissive) {
+			m_emitterTables.addEmitter(static_cast<uint32_t>(m_instances.size()), instance.mesh->faceAreaVectors,
+				instance.objectToWorld, instance.material->emissiveColor);
+		}
+
+		m_instances.push_back(instance);
+	}
+
+	void ReferenceScene::build() {
+		PXT_PROFILE_FN();
+
+		m_emitterTables.build();
+
+		std::vector<BvhInstance> bvhInstances;
+		bvhInstances.reserve(m_instances.size());
+		for (const Instance& instance : m_instances) {
+			bvhInstances.push_back({ &instance.mesh->bvh, instance.objectToWorld });
+		}
+
+		m_bvh.build(bvhInstances);
+	}
+}
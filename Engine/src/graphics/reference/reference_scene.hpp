@@ -0,0 +1,118 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "resources/types/material.hpp"
+#include "resources/types/mesh.hpp"
+#include "scene/scene.hpp"
+#include "scene/spatial/scene_bvh.hpp"
+#include "graphics/resources/emitter_tables.hpp"
+#include "graphics/resources/environment_distribution.hpp"
+#include "graphics/reference/reference_texture.hpp"
+
+namespace PXTEngine {
+
+	class RenderList;
+
+	/**
+	 * @class ReferenceScene
+	 *
+	 * @brief Host copy of everything the path tracing shaders read: geometry, materials, instances,
+	 * emitters and sky, with a SceneBvh standing in for the TLAS.
+	 *
+	 * Meshes and textures live on the device only, they are read back the first time an instance uses
+	 * them and cached for the next updates, so only the instances are gathered again on every update.
+	 *
+	 * Scenes can also be made of host data without any device, with addInstance() and build(), e.g. by the
+	 * benchmarks. update() and the read back are defined in reference_scene_readback.cpp, the rest of the
+	 * class makes no Vulkan call.
+	 */
+	class ReferenceScene {
+	public:
+		struct MeshData {
+			std::vector<Mesh::Vertex> vertices;
+			std::vector<uint32_t> indices; // always indexed, like the shaders expect
+			std::vector<glm::vec3> faceAreaVectors;
+			Bvh bvh;
+		};
+
+		struct MaterialData {
+			// null when the material has no map, the value of the matching default pixel is used instead
+			const ReferenceTexture* albedoMap = nullptr;
+			const ReferenceTexture* normalMap = nullptr;
+			const ReferenceTexture* metallicMap = nullptr;
+			const ReferenceTexture* roughnessMap = nullptr;
+			const ReferenceTexture* emissiveMap = nullptr;
+			glm::vec4 emissiveColor{ 0.0f };
+			uint16_t normalMapChannels = 4; // 2 if z is reconstructed from x and y
+		};
+
+		// MeshInstanceDescription of the shaders
+		struct Instance {
+			const MeshData* mesh;
+			const MaterialData* material;
+			glm::mat4 objectToWorld;
+			glm::mat4 worldToObject;
+			glm::vec3 tint;
+			float tilingFactor;
+		};
+
+		/**
+		 * @brief Gathers the instances of a render list, reading back the meshes and textures seen for the first time.
+		 *
+		 * @param scene The scene the render list was built from.
+		 */
+		void update(Scene& scene, const RenderList& renderList);
+
+		/**
+		 * @brief Computes the face area vectors and the BVH of host geometry.
+		 *
+		 * @param indices Three indices per triangle, if empty every three vertices make a triangle.
+		 */
+		static Unique<MeshData> createMeshData(std::vector<Mesh::Vertex> vertices, std::vector<uint32_t> indices);
+
+		/**
+		 * @brief Removes every instance and emitter, the cached meshes and materials are kept.
+		 */
+		void clearInstances();
+
+		/**
+		 * @brief Adds an instance, an emissive one is also added to the emitter tables.
+		 *
+		 * The mesh and the material must outlive the scene. Call build() once every instance is added.
+		 */
+		void addInstance(const Instance& instance, bool isEmissive);
+
+		/**
+		 * @brief Builds the emitter tables and the instance BVH of the added instances.
+		 */
+		void build();
+
+		const SceneBvh& getBvh() const { return m_bvh; }
+		const std::vector<Instance>& getInstances() const { return m_instances; }
+		// EmitterData and face alias tables of the shaders
+		const std::vector<EmitterData>& getEmitters() const { return m_emitterTables.getEmitters(); }
+		const std::vector<AliasTableEntry>& getEmitterFaceTable() const { return m_emitterTables.getFaceTable(); }
+
+		const ReferenceCubeMap* getSky() const { return m_sky.get(); }
+		const EnvironmentDistribution* getSkyDistribution() const { return m_skyDistribution; }
+		const glm::vec4& getAmbientLight() const { return m_ambientLight; }
+
+	private:
+		const MeshData* getMeshData(const Shared<Mesh>& mesh);
+		const MaterialData* getMaterialData(const Shared<Material>& material);
+		const ReferenceTexture* getTexture(const Shared<Image>& image);
+
+		std::unordered_map<ResourceId, Unique<MeshData>> m_meshes;
+		std::unordered_map<ResourceId, Unique<MaterialData>> m_materials;
+		std::unordered_map<ResourceId, Unique<ReferenceTexture>> m_textures;
+
+		std::vector<Instance> m_instances;
+		EmitterTableBuilder m_emitterTables;
+		SceneBvh m_bvh;
+
+		const Skybox* m_skybox = nullptr;
+		Unique<ReferenceCubeMap> m_sky;
+		const EnvironmentDistribution* m_skyDistribution = nullptr;
+		glm::vec4 m_ambientLight{ 0.0f };
+	};
+}
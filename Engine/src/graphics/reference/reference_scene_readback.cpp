@@ -0,0 +1,116 @@
+#include "graphics/reference/reference_scene.hpp"
+
+#include "scene/ecs/component.hpp"
+#include "graphics/render_list.hpp"
+#include "graphics/resources/vk_mesh.hpp"
+#include "graphics/resources/vk_skybox.hpp"
+
+namespace PXTEngine {
+
+	void ReferenceScene::update(Scene& scene, const RenderList& renderList) {
+		PXT_PROFILE_FN();
+
+		clearInstances();
+
+		// the render list order, as RayTracingSceneManagerSystem, so that instances and emitters get the same indices
+		auto view = scene.getEntitiesWith<WorldTransformComponent, MeshComponent, MaterialComponent>();
+
+		const std::span<const entt::entity> entities = renderList.getEntities();
+		const std::span<const glm::mat4> worldMatrices = renderList.getWorldMatrices();
+		const std::span<const glm::vec3> tints = renderList.getTints();
+		const std::span<const float> tilingFactors = renderList.getTilingFactors();
+		const std::span<const uint32_t> flags = renderList.getFlags();
+
+		for (uint32_t i = 0; i < renderList.getInstanceCount(); i++) {
+			const auto& [worldTransform, meshComponent, materialComponent] = view.get<WorldTransformComponent, MeshComponent, MaterialComponent>(entities[i]);
+
+			addInstance({
+				getMeshData(meshComponent.mesh),
+				getMaterialData(materialComponent.material),
+				worldMatrices[i],
+				worldTransform.inverse,
+				tints[i],
+				tilingFactors[i]
+			}, (flags[i] & RenderList::FLAG_EMISSIVE) != 0);
+		}
+
+		build();
+
+		const Shared<Environment> environment = scene.getEnvironment();
+		m_ambientLight = environment->getAmbientLight();
+
+		const Shared<Skybox>& skybox = environment->getSkybox();
+		if (skybox.get() != m_skybox) {
+			m_skybox = skybox.get();
+			m_sky = nullptr;
+			m_skyDistribution = nullptr;
+
+			if (skybox) {
+				const auto vulkanSkybox = std::static_pointer_cast<VulkanSkybox>(skybox);
+				VulkanImage& cubeMap = vulkanSkybox->getCubeMap();
+
+				std::vector<ReferenceTexture> faces;
+				faces.reserve(6);
+				for (uint32_t face = 0; face < 6; face++) {
+					faces.emplace_back(cubeMap.getWidth(), cubeMap.getHeight(), cubeMap.readTexels(face));
+				}
+
+				m_sky = createUnique<ReferenceCubeMap>(std::move(faces));
+				m_skyDistribution = &vulkanSkybox->getDistribution();
+			}
+		}
+	}
+
+	const ReferenceScene::MeshData* ReferenceScene::getMeshData(const Shared<Mesh>& mesh) {
+		auto it = m_meshes.find(mesh->id);
+		if (it != m_meshes.end()) {
+			return it->second.get();
+		}
+
+		std::vector<Mesh::Vertex> vertices;
+		std::vector<uint32_t> indices;
+		std::static_pointer_cast<VulkanMesh>(mesh)->readGeometry(vertices, indices);
+
+		return m_meshes.emplace(mesh->id, createMeshData(std::move(vertices), std::move(indices))).first->second.get();
+	}
+
+	const ReferenceScene::MaterialData* ReferenceScene::getMaterialData(const Shared<Material>& material) {
+		auto it = m_materials.find(material->id);
+		if (it != m_materials.end()) {
+			return it->second.get();
+		}
+
+		auto data = createUnique<MaterialData>();
+		data->albedoMap = getTexture(material->getAlbedoMap());
+		data->normalMap = getTexture(material->getNormalMap());
+		data->metallicMap = getTexture(material->getMetallicMap());
+		data->roughnessMap = getTexture(material->getRoughnessMap());
+		data->emissiveMap = getTexture(material->getEmissiveMap());
+		data->emissiveColor = material->getEmissiveColor();
+		data->normalMapChannels = material->getNormalMap()->getChannels();
+
+		return m_materials.emplace(material->id, std::move(data)).first->second.get();
+	}
+
+	const ReferenceTexture* ReferenceScene::getTexture(const Shared<Image>& image) {
+		if (!image) {
+			return nullptr;
+		}
+
+		auto it = m_textures.find(image->id);
+		if (it != m_textures.end()) {
+			return it->second.get();
+		}
+
+		Unique<ReferenceTexture> texture = nullptr;
+		try {
+			auto& vulkanImage = *std::static_pointer_cast<VulkanImage>(image);
+			texture = createUnique<ReferenceTexture>(vulkanImage.getWidth(), vulkanImage.getHeight(), vulkanImage.readTexels());
+		} catch (const std::runtime_error& error) {
+			// the format may not be readable on this device, the default pixel is used instead
+			PXT_WARN("Reference renderer can't read texture {}: {}", image->id.toString(), error.what());
+		}
+
+		return m_textures.emplace(image->id, std::move(texture)).first->second.get();
+	}
+}
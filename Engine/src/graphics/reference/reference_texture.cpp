@@ -0,0 +1,103 @@
+#include "graphics/reference/reference_texture.hpp"
+
+#include <glm/gtc/packing.hpp>
+
+namespace PXTEngine {
+
+	// every half float value converted once, a texel fetch is then four lookups
+	static const std::vector<float>& getHalfToFloatTable() {
+		static const std::vector<float> table = [] {
+			std::vector<float> values(1 << 16);
+			for (uint32_t i = 0; i < values.size(); i++) {
+				values[i] = glm::unpackHalf1x16(static_cast<uint16_t>(i));
+			}
+			return values;
+		}();
+
+		return table;
+	}
+
+	ReferenceTexture::ReferenceTexture(const uint32_t width, const uint32_t height, std::vector<uint16_t> texels)
+		: m_width(width), m_height(height), m_texels(std::move(texels)) {
+		PXT_ASSERT(m_texels.size() == static_cast<size_t>(width) * height * 4, "A reference texture has four channels per texel");
+	}
+
+	glm::vec4 ReferenceTexture::sample(const glm::vec2& uv) const {
+		return sampleBilinear(uv, [](const int32_t coordinate, const uint32_t size) {
+			const int32_t wrapped = coordinate % static_cast<int32_t>(size);
+			return static_cast<uint32_t>(wrapped < 0 ? wrapped + static_cast<int32_t>(size) : wrapped);
+		});
+	}
+
+	glm::vec4 ReferenceTexture::sampleClamped(const glm::vec2& uv) const {
+		return sampleBilinear(uv, [](const int32_t coordinate, const uint32_t size) {
+			return static_cast<uint32_t>(std::clamp(coordinate, 0, static_cast<int32_t>(size) - 1));
+		});
+	}
+
+	glm::vec4 ReferenceTexture::fetch(const uint32_t x, const uint32_t y) const {
+		const std::vector<float>& halfToFloat = getHalfToFloatTable();
+		const uint16_t* texel = &m_texels[(static_cast<size_t>(y) * m_width + x) * 4];
+
+		return { halfToFloat[texel[0]], halfToFloat[texel[1]], halfToFloat[texel[2]], halfToFloat[texel[3]] };
+	}
+
+	template <typename WrapFunction>
+	glm::vec4 ReferenceTexture::sampleBilinear(const glm::vec2& uv, WrapFunction&& wrap) const {
+		// texel centers are at half integer coordinates
+		const glm::vec2 position = uv * glm::vec2(m_width, m_height) - 0.5f;
+		const glm::vec2 base = glm::floor(position);
+		const glm::vec2 weight = position - base;
+
+		const int32_t x = static_cast<int32_t>(base.x);
+		const int32_t y = static_cast<int32_t>(base.y);
+
+		const uint32_t x0 = wrap(x, m_width);
+		const uint32_t x1 = wrap(x + 1, m_width);
+		const uint32_t y0 = wrap(y, m_height);
+		const uint32_t y1 = wrap(y + 1, m_height);
+
+		const glm::vec4 top = glm::mix(fetch(x0, y0), fetch(x1, y0), weight.x);
+		const glm::vec4 bottom = glm::mix(fetch(x0, y1), fetch(x1, y1), weight.x);
+
+		return glm::mix(top, bottom, weight.y);
+	}
+
+	ReferenceCubeMap::ReferenceCubeMap(std::vector<ReferenceTexture> faces) : m_faces(std::move(faces)) {
+		PXT_ASSERT(m_faces.size() == 6, "A cube map has 6 faces");
+	}
+
+	glm::vec4 ReferenceCubeMap::sample(const glm::vec3& direction) const {
+		const glm::vec3 absolute = glm::abs(direction);
+
+		// face selection of the Vulkan specification: the major axis picks the face,
+		// the other two components give its coordinates
+		uint32_t face;
+		float sc, tc, ma;
+
+		if (absolute.x >= absolute.y && absolute.x >= absolute.z) {
+			face = direction.x >= 0.0f ? 0 : 1;
+			sc = direction.x >= 0.0f ? -direction.z : direction.z;
+			tc = -direction.y;
+			ma = absolute.x;
+		} else if (absolute.y >= absolute.z) {
+			face = direction.y >= 0.0f ? 2 : 3;
+			sc = direction.x;
+			tc = direction.y >= 0.0f ? direction.z : -direction.z;
+			ma = absolute.y;
+		} else {
+			face = direction.z >= 0.0f ? 4 : 5;
+			sc = direction.z >= 0.0f ? direction.x : -direction.x;
+			tc = -direction.y;
+			ma = absolute.z;
+		}
+
+		if (ma == 0.0f) {
+			return glm::vec4(0.0f);
+		}
+
+		const glm::vec2 uv = 0.5f * (glm::vec2(sc, tc) / ma + 1.0f);
+
+		return m_faces[face].sampleClamped(uv);
+	}
+}
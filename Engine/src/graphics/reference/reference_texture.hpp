@@ -0,0 +1,63 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class ReferenceTexture
+	 *
+	 * @brief Host copy of the biggest mip level of a texture, sampled by the CPU reference renderer.
+	 *
+	 * The texels are kept as linear RGBA half floats, as read back by VulkanImage::readTexels.
+	 * Sampling is bilinear on that level, like the hit shaders (they have no derivatives to pick another one).
+	 */
+	class ReferenceTexture {
+	public:
+		/**
+		 * @param texels Four half floats per texel, row by row, e.g. a layer read back by VulkanImage::readTexels.
+		 */
+		ReferenceTexture(uint32_t width, uint32_t height, std::vector<uint16_t> texels);
+
+		/**
+		 * @brief Bilinear sample with repeating texture coordinates, as the Texture2D sampler.
+		 */
+		glm::vec4 sample(const glm::vec2& uv) const;
+
+		/**
+		 * @brief Bilinear sample with texture coordinates clamped to the edges.
+		 */
+		glm::vec4 sampleClamped(const glm::vec2& uv) const;
+
+		uint32_t getWidth() const { return m_width; }
+		uint32_t getHeight() const { return m_height; }
+
+	private:
+		glm::vec4 fetch(uint32_t x, uint32_t y) const;
+
+		template <typename WrapFunction>
+		glm::vec4 sampleBilinear(const glm::vec2& uv, WrapFunction&& wrap) const;
+
+		uint32_t m_width = 0;
+		uint32_t m_height = 0;
+		std::vector<uint16_t> m_texels;
+	};
+
+	/**
+	 * @class ReferenceCubeMap
+	 *
+	 * @brief Host copy of the six faces of a cube map, looked up by direction like a samplerCube.
+	 */
+	class ReferenceCubeMap {
+	public:
+		/**
+		 * @param faces The six faces in layer order.
+		 */
+		ReferenceCubeMap(std::vector<ReferenceTexture> faces);
+
+		glm::vec4 sample(const glm::vec3& direction) const;
+
+	private:
+		std::vector<ReferenceTexture> m_faces; // in layer order: +x, -x, +y, -y, +z, -z
+	};
+}
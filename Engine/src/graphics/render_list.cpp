@@ -0,0 +1,85 @@
+#include "graphics/render_list.hpp"
+
+#include "core/jobs/job_system.hpp"
+#include "utils/radix_sort.hpp"
+
+namespace PXTEngine {
+
+	void RenderList::build(Scene& scene, const MaterialRegistry& materialRegistry) {
+		PXT_PROFILE_FN();
+
+		const auto buildBegin = std::chrono::high_resolution_clock::now();
+
+		m_sortKeys.clear();
+		m_walk.clear();
+
+		// the only serial walk of the scene, the rest is done on the packed entries
+		auto view = scene.getEntitiesWith<WorldTransformComponent, MeshComponent, MaterialComponent>();
+		for (auto entity : view) {
+			auto [transform, meshComponent, material] = view.get<WorldTransformComponent, MeshComponent, MaterialComponent>(entity);
+			auto* mesh = static_cast<VulkanMesh*>(meshComponent.mesh.get());
+
+			const uint64_t walkIndex = m_walk.size();
+			m_sortKeys.push_back(static_cast<uint64_t>(mesh->getGeometryHandle()) << 32 | walkIndex);
+
+			m_walk.push_back({ entity, &transform, &material, mesh });
+		}
+
+		// only the mesh is sorted, the walk index below it keeps the walk order within a batch
+		radixSort(m_sortKeys, m_sortScratch, 32);
+
+		const size_t count = m_sortKeys.size();
+		m_entities.resize(count);
+		m_worldMatrices.resize(count);
+		m_normalMatrices.resize(count);
+		m_worldBounds.resize(count);
+		m_meshes.resize(count);
+		m_materials.resize(count);
+		m_materialIndices.resize(count);
+		m_tints.resize(count);
+		m_tilingFactors.resize(count);
+		m_flags.resize(count);
+
+		// every instance writes only its own elements
+		if (count < PARALLEL_EXTRACTION_THRESHOLD) {
+			extract(0, count, materialRegistry);
+		} else {
+			JobSystem::parallelFor(count, EXTRACTION_GRAIN_SIZE, [&](const size_t begin, const size_t end) {
+				extract(begin, end, materialRegistry);
+			});
+		}
+
+		m_batches.clear();
+		for (uint32_t i = 0; i < count; i++) {
+			if (m_batches.empty() || m_batches.back().mesh != m_meshes[i]) {
+				m_batches.push_back({ m_meshes[i], i, 0 });
+			}
+			m_batches.back().instanceCount++;
+		}
+
+		m_buildMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - buildBegin).count();
+	}
+
+	void RenderList::extract(const size_t begin, const size_t end, const MaterialRegistry& materialRegistry) {
+		for (size_t i = begin; i < end; i++) {
+			const WalkEntry& entry = m_walk[static_cast<uint32_t>(m_sortKeys[i])];
+			const WorldTransformComponent& transform = *entry.transform;
+			const MaterialComponent& materialComponent = *entry.material;
+
+			const glm::mat4& world = transform.matrix;
+
+			Material* material = materialComponent.material.get();
+
+			m_entities[i] = entry.entity;
+			m_worldMatrices[i] = world;
+			m_normalMatrices[i] = glm::mat4(transform.normalMatrix);
+			m_worldBounds[i] = entry.mesh->getLocalBounds().transformed(world);
+			m_meshes[i] = entry.mesh;
+			m_materials[i] = material;
+			m_materialIndices[i] = materialRegistry.getIndex(material->id);
+			m_tints[i] = materialComponent.tint;
+			m_tilingFactors[i] = materialComponent.tilingFactor;
+			m_flags[i] = material->isEmissive() ? FLAG_EMISSIVE : FLAG_NONE;
+		}
+	}
+}
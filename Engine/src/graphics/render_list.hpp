@@ -0,0 +1,112 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "graphics/resources/vk_mesh.hpp"
+#include "graphics/resources/material_registry.hpp"
+#include "scene/spatial/aabb.hpp"
+#include "scene/scene.hpp"
+#include "scene/ecs/component.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class RenderList
+	 *
+	 * @brief The drawable entities of a frame, extracted from the scene once for every render system.
+	 *
+	 * It is built at the start of the frame: the scene is walked once, then the per entity data
+	 * is gathered in parallel and stored as a structure of arrays (world and normal matrices,
+	 * world bounds, mesh, material index...), the n-th element of every array being instance n.
+	 * The matrices are the cached WorldTransformComponent ones, so the scene world transforms
+	 * must be up to date. The render systems read the arrays they need instead of walking the scene.
+	 *
+	 * The entities are sorted by a key made of their mesh (the geometry arena handle, dense and
+	 * unique among the live meshes) with a radix sort, so that the entities sharing a mesh are
+	 * contiguous and each group is a single instanced draw.
+	 * Every raster pass uses a single pipeline for all its draws, so the pipeline doesn't take
+	 * part in the key yet; it would go in the bits above the mesh.
+	 */
+	class RenderList {
+	public:
+		// consecutive instances drawn with the same mesh
+		struct Batch {
+			VulkanMesh* mesh;
+			uint32_t firstInstance;
+			uint32_t instanceCount;
+		};
+
+		enum Flags : uint32_t {
+			FLAG_NONE = 0,
+			FLAG_EMISSIVE = 1 << 0,
+		};
+
+		/**
+		 * @brief Extracts the entities with a transform, a mesh and a material.
+		 *
+		 * @param scene The scene to walk, its components must not change during the build.
+		 * @param materialRegistry Gives the GPU index of the materials.
+		 */
+		void build(Scene& scene, const MaterialRegistry& materialRegistry);
+
+		uint32_t getInstanceCount() const { return static_cast<uint32_t>(m_entities.size()); }
+
+		std::span<const Batch> getBatches() const { return m_batches; }
+
+		// the entities, for the data that isn't extracted (e.g. to create the BLAS of a mesh)
+		std::span<const entt::entity> getEntities() const { return m_entities; }
+
+		std::span<const glm::mat4> getWorldMatrices() const { return m_worldMatrices; }
+		std::span<const glm::mat4> getNormalMatrices() const { return m_normalMatrices; }
+		std::span<const Aabb> getWorldBounds() const { return m_worldBounds; }
+		std::span<VulkanMesh* const> getMeshes() const { return m_meshes; }
+		std::span<Material* const> getMaterials() const { return m_materials; }
+		std::span<const uint32_t> getMaterialIndices() const { return m_materialIndices; }
+		std::span<const glm::vec3> getTints() const { return m_tints; }
+		std::span<const float> getTilingFactors() const { return m_tilingFactors; }
+		std::span<const uint32_t> getFlags() const { return m_flags; }
+
+		/**
+		 * @brief Returns the CPU time of the last build.
+		 */
+		float getBuildMs() const { return m_buildMs; }
+
+	private:
+		// entities below this count are extracted on the calling thread
+		static constexpr size_t PARALLEL_EXTRACTION_THRESHOLD = 4096;
+		static constexpr size_t EXTRACTION_GRAIN_SIZE = 1024;
+
+		/**
+		 * @brief Fills the arrays of the instances in [begin, end).
+		 */
+		void extract(size_t begin, size_t end, const MaterialRegistry& materialRegistry);
+
+		// the mesh handle in the high bits, the index of the entity in the scene walk in the low bits
+		std::vector<uint64_t> m_sortKeys;
+		std::vector<uint64_t> m_sortScratch;
+
+		// in scene walk order, the components stay in place while the list is built
+		struct WalkEntry {
+			entt::entity entity;
+			const WorldTransformComponent* transform;
+			const MaterialComponent* material;
+			VulkanMesh* mesh;
+		};
+		std::vector<WalkEntry> m_walk;
+
+		// in instance order
+		std::vector<entt::entity> m_entities;
+		std::vector<glm::mat4> m_worldMatrices;
+		std::vector<glm::mat4> m_normalMatrices;
+		std::vector<Aabb> m_worldBounds;
+		std::vector<VulkanMesh*> m_meshes;
+		std::vector<Material*> m_materials;
+		std::vector<uint32_t> m_materialIndices;
+		std::vector<glm::vec3> m_tints;
+		std::vector<float> m_tilingFactors;
+		std::vector<uint32_t> m_flags;
+
+		std::vector<Batch> m_batches;
+
+		float m_buildMs = 0.0f;
+	};
+}
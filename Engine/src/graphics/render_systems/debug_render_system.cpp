@@ -6,20 +6,28 @@
 namespace PXTEngine {
 
     struct DebugPushConstantData {
+        uint32_t enableWireframe{0};
+		uint32_t enableNormals{0};
+    };
+
+    /**
+     * @brief Per entity data read by debug_shader.vert and debug_shader.frag, matching DebugInstance.
+     */
+    struct alignas(16) DebugInstanceData {
         glm::mat4 modelMatrix{1.f};
         glm::mat4 normalMatrix{1.f};
 		glm::vec4 color{ 1.f };
-        uint32_t enableWireframe{0};
-		uint32_t enableNormals{0};
 		int textureIndex = 0;
 		int normalMapIndex = 1;
 		int ambientOcclusionMapIndex = 0;
 		float tilingFactor = 1.0f;
+		int normalMapChannels = 4;
     };
 
     DebugRenderSystem::DebugRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, TextureRegistry& textureRegistry, VkRenderPass renderPass, DescriptorSetLayout& globalSetLayout)
 		: m_context(context), m_descriptorAllocator(descriptorAllocator), m_textureRegistry(textureRegistry),
-		m_renderPassHandle(renderPass) {
+		m_renderPassHandle(renderPass),
+		m_instanceBuffer(context, descriptorAllocator, sizeof(DebugInstanceData), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT) {
         createPipelineLayout(globalSetLayout);
         createPipelines();
     }
@@ -30,13 +38,14 @@ namespace PXTEngine {
 
     void DebugRenderSystem::createPipelineLayout(DescriptorSetLayout& globalSetLayout) {
         VkPushConstantRange pushConstantRange{};
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
         pushConstantRange.offset = 0;
         pushConstantRange.size = sizeof(DebugPushConstantData);
 
         std::vector<VkDescriptorSetLayout> descriptorSetLayouts{
             globalSetLayout.getDescriptorSetLayout(),
-			m_textureRegistry.getDescriptorSetLayout()
+			m_textureRegistry.getDescriptorSetLayout(),
+			m_instanceBuffer.getDescriptorSetLayout().getDescriptorSetLayout()
         };
 
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
@@ -84,7 +93,34 @@ namespace PXTEngine {
 		);
     }
 
-    void DebugRenderSystem::render(FrameInfo& frameInfo) {
+    void DebugRenderSystem::render(FrameInfo& frameInfo, const RenderList& renderList) {
+		const uint32_t frameIndex = static_cast<uint32_t>(frameInfo.frameIndex);
+
+		// the fence of this frame slot was waited, its instance buffer can be rewritten while recording
+		auto* instances = static_cast<DebugInstanceData*>(m_instanceBuffer.reserve(frameIndex, renderList.getInstanceCount()));
+
+		const std::span<const glm::mat4> worldMatrices = renderList.getWorldMatrices();
+		const std::span<const glm::mat4> normalMatrices = renderList.getNormalMatrices();
+		const std::span<Material* const> materials = renderList.getMaterials();
+		const std::span<const glm::vec3> tints = renderList.getTints();
+		const std::span<const float> tilingFactors = renderList.getTilingFactors();
+
+		for (uint32_t i = 0; i < renderList.getInstanceCount(); i++) {
+			const Material* material = materials[i];
+
+			DebugInstanceData instance{};
+			instance.modelMatrix = worldMatrices[i];
+			instance.normalMatrix = normalMatrices[i];
+			instance.color = material->getAlbedoColor() * glm::vec4(tints[i], 1.0f);
+			instance.textureIndex = m_isAlbedoMapEnabled ? m_textureRegistry.getIndex(material->getAlbedoMap()->id) : -1;
+			instance.normalMapIndex = m_isNormalMapEnabled ? m_textureRegistry.getIndex(material->getNormalMap()->id) : -1;
+			instance.ambientOcclusionMapIndex = m_isAOMapEnabled ? m_textureRegistry.getIndex(material->getAmbientOcclusionMap()->id) : -1;
+			instance.tilingFactor = tilingFactors[i];
+			instance.normalMapChannels = material->getNormalMap()->getChannels();
+
+			instances[i] = instance;
+		}
+
 		if (m_renderMode == Wireframe) {
 			m_pipelineWireframe->bind(frameInfo.commandBuffer);
 		}
@@ -92,7 +128,11 @@ namespace PXTEngine {
 			m_pipelineSolid->bind(frameInfo.commandBuffer);
 		}
 
-        std::array<VkDescriptorSet, 2> descriptorSets = {frameInfo.globalDescriptorSet, m_textureRegistry.getDescriptorSet()};
+        std::array<VkDescriptorSet, 3> descriptorSets = {
+			frameInfo.globalDescriptorSet,
+			m_textureRegistry.getDescriptorSet(frameIndex),
+			m_instanceBuffer.getDescriptorSet(frameIndex)
+		};
 
         vkCmdBindDescriptorSets(
             frameInfo.commandBuffer,
@@ -105,39 +145,26 @@ namespace PXTEngine {
             nullptr
         );
 
-        auto view = frameInfo.scene.getEntitiesWith<TransformComponent, MeshComponent, MaterialComponent>();
-        for (auto entity : view) {
-
-            const auto&[transform, meshComponent, materialComponent] = view.get<TransformComponent, MeshComponent, MaterialComponent>(entity);
-
-			auto material = materialComponent.material;
-            auto vulkanMesh = std::static_pointer_cast<VulkanMesh>(meshComponent.mesh);
-
-            DebugPushConstantData push{};
-            push.modelMatrix = transform.mat4();
-            push.normalMatrix = transform.normalMatrix();
-			push.color = material->getAlbedoColor() * glm::vec4(materialComponent.tint, 1.0f);
-			push.textureIndex = m_isAlbedoMapEnabled ? m_textureRegistry.getIndex(material->getAlbedoMap()->id) : -1;
-			push.normalMapIndex = m_isNormalMapEnabled ? m_textureRegistry.getIndex(material->getNormalMap()->id) : -1;
-			push.ambientOcclusionMapIndex = m_isAOMapEnabled ? m_textureRegistry.getIndex(material->getAmbientOcclusionMap()->id) : -1;
-			push.tilingFactor = materialComponent.tilingFactor;
-
-            push.enableWireframe = (uint32_t)(m_renderMode == Wireframe);
-			push.enableNormals = (uint32_t)m_isNormalColorEnabled;
-            
-
-            vkCmdPushConstants(
-                frameInfo.commandBuffer,
-                m_pipelineLayout,
-                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                0,
-                sizeof(DebugPushConstantData),
-                &push);
-            
-            vulkanMesh->bind(frameInfo.commandBuffer);
-            vulkanMesh->draw(frameInfo.commandBuffer);
-
-        }
+		DebugPushConstantData push{};
+		push.enableWireframe = (uint32_t)(m_renderMode == Wireframe);
+		push.enableNormals = (uint32_t)m_isNormalColorEnabled;
+
+		vkCmdPushConstants(
+			frameInfo.commandBuffer,
+			m_pipelineLayout,
+			VK_SHADER_STAGE_FRAGMENT_BIT,
+			0,
+			sizeof(DebugPushConstantData),
+			&push);
+
+        // every mesh is drawn from the geometry arena
+        m_context.getGeometryArena().bind(frameInfo.commandBuffer);
+
+		for (const RenderList::Batch& batch : renderList.getBatches()) {
+			const GeometryRange& range = batch.mesh->getGeometryRange();
+			vkCmdDrawIndexed(frameInfo.commandBuffer, range.indexCount, batch.instanceCount, range.firstIndex,
+				static_cast<int32_t>(range.firstVertex), batch.firstInstance);
+		}
     }
 
     void DebugRenderSystem::updateUi() {
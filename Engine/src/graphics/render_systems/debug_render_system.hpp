@@ -7,6 +7,8 @@
 #include "graphics/frame_info.hpp"
 #include "graphics/descriptors/descriptors.hpp"
 #include "graphics/resources/texture_registry.hpp"
+#include "graphics/resources/instance_buffer.hpp"
+#include "graphics/render_list.hpp"
 #include "scene/scene.hpp"
 
 namespace PXTEngine {
@@ -23,7 +25,10 @@ namespace PXTEngine {
         DebugRenderSystem(const DebugRenderSystem&) = delete;
         DebugRenderSystem& operator=(const DebugRenderSystem&) = delete;
 
-        void render(FrameInfo& frameInfo);
+        /**
+         * @brief Draws the render list with an instanced draw per mesh.
+         */
+        void render(FrameInfo& frameInfo, const RenderList& renderList);
         void updateUi();
 		void reloadShaders();
 
@@ -0,0 +1,274 @@
+#include "graphics/render_systems/denoiser_render_system.hpp"
+
+namespace PXTEngine {
+
+	// local_size of svgf.glsl
+	static constexpr uint32_t WORKGROUP_SIZE = 8;
+
+	DenoiserRenderSystem::DenoiserRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, Shared<VulkanImage> sceneImage, const PathTracingFeatures& features)
+		: m_context(context),
+		m_descriptorAllocator(descriptorAllocator),
+		m_sceneImage(sceneImage),
+		m_features(features)
+	{
+		createHistoryImages();
+		createDescriptorSet();
+		createPipelineLayout();
+		createPipelines();
+		createQueryPools();
+	}
+
+	DenoiserRenderSystem::~DenoiserRenderSystem() {
+		for (VkQueryPool queryPool : m_queryPools) {
+			vkDestroyQueryPool(m_context.getDevice(), queryPool, nullptr);
+		}
+
+		vkDestroyPipelineLayout(m_context.getDevice(), m_pipelineLayout, nullptr);
+	}
+
+	void DenoiserRenderSystem::createHistoryImages() {
+		const VkExtent2D extent = m_sceneImage->getExtent();
+
+		m_previousNormalDepthImage = VulkanImage::createStorageImage2D(m_context, extent, VK_FORMAT_R16G16B16A16_SFLOAT);
+		m_historyColorImage = VulkanImage::createStorageImage2D(m_context, extent, VK_FORMAT_R16G16B16A16_SFLOAT);
+		m_historyMomentsImage = VulkanImage::createStorageImage2D(m_context, extent, VK_FORMAT_R16G16B16A16_SFLOAT);
+		m_integratedMomentsImage = VulkanImage::createStorageImage2D(m_context, extent, VK_FORMAT_R16G16B16A16_SFLOAT);
+		m_filterPingImage = VulkanImage::createStorageImage2D(m_context, extent, VK_FORMAT_R16G16B16A16_SFLOAT);
+		m_filterPongImage = VulkanImage::createStorageImage2D(m_context, extent, VK_FORMAT_R16G16B16A16_SFLOAT);
+
+		m_isHistoryValid = false;
+	}
+
+	void DenoiserRenderSystem::createDescriptorSet() {
+		DescriptorSetLayout::Builder builder(m_context);
+		for (uint32_t binding = 0; binding <= 10; binding++) {
+			builder.addBinding(binding, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+		}
+		m_descriptorSetLayout = builder.build();
+
+		m_descriptorAllocator->allocate(m_descriptorSetLayout->getDescriptorSetLayout(), m_descriptorSet);
+
+		updateDescriptorSet();
+	}
+
+	void DenoiserRenderSystem::updateDescriptorSet() {
+		// in the order of the bindings of svgf.glsl
+		const std::array<Shared<VulkanImage>, 11> images = {
+			m_features.radiance,
+			m_features.normalDepth,
+			m_features.albedo,
+			m_features.motion,
+			m_previousNormalDepthImage,
+			m_historyColorImage,
+			m_historyMomentsImage,
+			m_integratedMomentsImage,
+			m_filterPingImage,
+			m_filterPongImage,
+			m_sceneImage
+		};
+
+		std::array<VkDescriptorImageInfo, 11> imageInfos{};
+		DescriptorWriter writer(m_context, *m_descriptorSetLayout);
+
+		for (uint32_t i = 0; i < images.size(); i++) {
+			imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			imageInfos[i].imageView = images[i]->getImageView();
+			imageInfos[i].sampler = VK_NULL_HANDLE;
+
+			writer.writeImage(i, &imageInfos[i]);
+		}
+
+		writer.updateSet(m_descriptorSet);
+	}
+
+	void DenoiserRenderSystem::updateImages(Shared<VulkanImage> sceneImage, const PathTracingFeatures& features) {
+		m_sceneImage = sceneImage;
+		m_features = features;
+
+		createHistoryImages();
+		updateDescriptorSet();
+	}
+
+	void DenoiserRenderSystem::createPipelineLayout() {
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(PushConstantData);
+
+		VkDescriptorSetLayout descriptorSetLayout = m_descriptorSetLayout->getDescriptorSetLayout();
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(m_context.getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create denoiser pipeline layout!");
+		}
+	}
+
+	void DenoiserRenderSystem::createPipelines() {
+		PXT_ASSERT(m_pipelineLayout != nullptr, "Cannot create denoiser pipelines before pipelineLayout");
+
+		auto createComputePipeline = [this](const std::string& shaderName) {
+			ComputePipelineConfigInfo pipelineConfig{};
+			pipelineConfig.shaderFilePath = SPV_SHADERS_PATH + shaderName + ".spv";
+			pipelineConfig.pipelineLayout = m_pipelineLayout;
+
+			return createUnique<Pipeline>(m_context, pipelineConfig);
+		};
+
+		m_reprojectPipeline = createComputePipeline("svgf_reproject.comp");
+		m_atrousPipeline = createComputePipeline("svgf_atrous.comp");
+		m_modulatePipeline = createComputePipeline("svgf_modulate.comp");
+	}
+
+	void DenoiserRenderSystem::createQueryPools() {
+		m_areTimestampsSupported = m_context.getPhysicalDeviceProperties().limits.timestampComputeAndGraphics;
+		if (!m_areTimestampsSupported) {
+			PXT_WARN("Timestamp queries are not supported, the denoiser passes will not be timed");
+			return;
+		}
+
+		VkQueryPoolCreateInfo queryPoolInfo{};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = TIMESTAMP_COUNT;
+
+		for (VkQueryPool& queryPool : m_queryPools) {
+			if (vkCreateQueryPool(m_context.getDevice(), &queryPoolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create denoiser timestamp query pool!");
+			}
+		}
+	}
+
+	void DenoiserRenderSystem::readTimings(const uint32_t frameIndex) {
+		if (!m_areTimestampsWritten[frameIndex]) return;
+
+		// the fence of this frame slot was waited, the timestamps of its last use are ready
+		std::array<uint64_t, TIMESTAMP_COUNT> timestamps{};
+		if (vkGetQueryPoolResults(m_context.getDevice(), m_queryPools[frameIndex], 0, TIMESTAMP_COUNT,
+			sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+			return;
+		}
+
+		const float msPerTick = m_context.getPhysicalDeviceProperties().limits.timestampPeriod / 1e6f;
+		auto elapsedMs = [&](const Timestamp begin, const Timestamp end) {
+			return static_cast<float>(timestamps[end] - timestamps[begin]) * msPerTick;
+		};
+
+		m_timings.reprojectMs = elapsedMs(BEGIN, REPROJECTED);
+		m_timings.filterMs = elapsedMs(REPROJECTED, FILTERED);
+		m_timings.modulateMs = elapsedMs(FILTERED, MODULATED);
+	}
+
+	void DenoiserRenderSystem::computeBarrier(VkCommandBuffer commandBuffer, const VkPipelineStageFlags sourceStage, const VkPipelineStageFlags destinationStage) {
+		// every image is in VK_IMAGE_LAYOUT_GENERAL, a memory barrier orders the accesses of all of them
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			sourceStage, destinationStage,
+			0,
+			1, &barrier,
+			0, nullptr,
+			0, nullptr
+		);
+	}
+
+	void DenoiserRenderSystem::dispatch(VkCommandBuffer commandBuffer, Pipeline& pipeline, const PushConstantData& push) {
+		pipeline.bind(commandBuffer);
+
+		vkCmdPushConstants(
+			commandBuffer,
+			m_pipelineLayout,
+			VK_SHADER_STAGE_COMPUTE_BIT,
+			0,
+			sizeof(PushConstantData),
+			&push
+		);
+
+		const VkExtent2D extent = m_sceneImage->getExtent();
+		vkCmdDispatch(
+			commandBuffer,
+			(extent.width + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE,
+			(extent.height + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE,
+			1
+		);
+	}
+
+	void DenoiserRenderSystem::render(FrameInfo& frameInfo, const DenoiserSettings& settings) {
+		PXT_PROFILE_FN();
+
+		VkCommandBuffer commandBuffer = frameInfo.commandBuffer;
+		const uint32_t frameIndex = static_cast<uint32_t>(frameInfo.frameIndex);
+
+		if (m_areTimestampsSupported) {
+			readTimings(frameIndex);
+			vkCmdResetQueryPool(commandBuffer, m_queryPools[frameIndex], 0, TIMESTAMP_COUNT);
+		}
+
+		auto writeTimestamp = [&](const Timestamp timestamp) {
+			if (m_areTimestampsSupported) {
+				vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, m_queryPools[frameIndex], timestamp);
+			}
+		};
+
+		const int iterations = std::clamp(settings.filterIterations, 1, DenoiserSettings::MAX_FILTER_ITERATIONS);
+
+		PushConstantData push{};
+		push.historyValid = m_isHistoryValid ? 1 : 0;
+		push.temporalAlpha = settings.temporalAlpha;
+		push.momentsAlpha = settings.momentsAlpha;
+		push.colorPhi = settings.colorPhi;
+		push.normalPhi = settings.normalPhi;
+		push.depthPhi = settings.depthPhi;
+
+		vkCmdBindDescriptorSets(
+			commandBuffer,
+			VK_PIPELINE_BIND_POINT_COMPUTE,
+			m_pipelineLayout,
+			0,
+			1,
+			&m_descriptorSet,
+			0,
+			nullptr
+		);
+
+		// the path tracer wrote the features, the previous frame wrote the history
+		computeBarrier(commandBuffer, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		writeTimestamp(BEGIN);
+
+		dispatch(commandBuffer, *m_reprojectPipeline, push);
+		writeTimestamp(REPROJECTED);
+
+		// the reprojection writes the ping image, then the iterations alternate between ping and pong
+		for (int i = 0; i < iterations; i++) {
+			computeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+			push.stepSize = 1 << i;
+			push.readPong = i % 2;
+			push.writeHistory = i == 0 ? 1 : 0; // the first iteration is the history, as in the SVGF paper
+			dispatch(commandBuffer, *m_atrousPipeline, push);
+		}
+		writeTimestamp(FILTERED);
+
+		computeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+		push.readPong = iterations % 2;
+		dispatch(commandBuffer, *m_modulatePipeline, push);
+		writeTimestamp(MODULATED);
+
+		// the scene image is transitioned for imgui after the ray tracing stage, and the next frame
+		// path tracer overwrites the features read here
+		computeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+		m_areTimestampsWritten[frameIndex] = m_areTimestampsSupported;
+		m_isHistoryValid = true;
+	}
+}
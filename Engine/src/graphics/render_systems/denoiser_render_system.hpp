@@ -0,0 +1,114 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "graphics/context/context.hpp"
+#include "graphics/pipeline.hpp"
+#include "graphics/swap_chain.hpp"
+#include "graphics/frame_info.hpp"
+#include "graphics/denoiser_settings.hpp"
+#include "graphics/descriptors/descriptors.hpp"
+#include "graphics/resources/vk_image.hpp"
+#include "graphics/render_systems/raytracing_render_system.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class DenoiserRenderSystem
+	 *
+	 * @brief Spatiotemporal variance-guided filtering (SVGF) of the path traced scene image.
+	 *
+	 * It runs the compute shaders in shaders/denoiser after the path tracer, reading the radiance and
+	 * the features it writes and overwriting the scene image with the filtered result:
+	 * - svgf_reproject: accumulates the demodulated radiance with the reprojected history and estimates its variance;
+	 * - svgf_atrous: a-trous wavelet iterations guided by the variance, normals and depth;
+	 * - svgf_modulate: puts the albedo back and keeps the features of the frame as the next history.
+	 *
+	 * The GPU time of every pass is measured with timestamp queries and read back when the frame slot is reused.
+	 */
+	class DenoiserRenderSystem {
+	public:
+		DenoiserRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, Shared<VulkanImage> sceneImage, const PathTracingFeatures& features);
+		~DenoiserRenderSystem();
+
+		DenoiserRenderSystem(const DenoiserRenderSystem&) = delete;
+		DenoiserRenderSystem& operator=(const DenoiserRenderSystem&) = delete;
+
+		/**
+		 * @brief Records the passes of the denoiser. The scene image and the features have to be in VK_IMAGE_LAYOUT_GENERAL.
+		 */
+		void render(FrameInfo& frameInfo, const DenoiserSettings& settings);
+
+		/**
+		 * @brief Recreates the history with the size of the new images, the device has to be idle.
+		 */
+		void updateImages(Shared<VulkanImage> sceneImage, const PathTracingFeatures& features);
+
+		/**
+		 * @brief Discards the history, the next frame is filtered only spatially.
+		 */
+		void resetHistory() { m_isHistoryValid = false; }
+
+		const DenoiserTimings& getTimings() const { return m_timings; }
+
+	private:
+		// DenoiserPushConstants of svgf.glsl
+		struct PushConstantData {
+			int stepSize;
+			uint32_t readPong;
+			uint32_t writeHistory;
+			uint32_t historyValid;
+			float temporalAlpha;
+			float momentsAlpha;
+			float colorPhi;
+			float normalPhi;
+			float depthPhi;
+		};
+
+		// timestamps written around the passes
+		enum Timestamp : uint32_t {
+			BEGIN = 0,
+			REPROJECTED,
+			FILTERED,
+			MODULATED,
+			TIMESTAMP_COUNT
+		};
+
+		void createHistoryImages();
+		void createDescriptorSet();
+		void updateDescriptorSet();
+		void createPipelineLayout();
+		void createPipelines();
+		void createQueryPools();
+
+		void readTimings(uint32_t frameIndex);
+		void dispatch(VkCommandBuffer commandBuffer, Pipeline& pipeline, const PushConstantData& push);
+		void computeBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags sourceStage, VkPipelineStageFlags destinationStage);
+
+		Context& m_context;
+		Shared<DescriptorAllocatorGrowable> m_descriptorAllocator = nullptr;
+
+		Shared<VulkanImage> m_sceneImage = nullptr;
+		PathTracingFeatures m_features{};
+
+		Shared<VulkanImage> m_previousNormalDepthImage = nullptr;
+		Shared<VulkanImage> m_historyColorImage = nullptr;
+		Shared<VulkanImage> m_historyMomentsImage = nullptr;
+		Shared<VulkanImage> m_integratedMomentsImage = nullptr;
+		Shared<VulkanImage> m_filterPingImage = nullptr;
+		Shared<VulkanImage> m_filterPongImage = nullptr;
+		bool m_isHistoryValid = false;
+
+		VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
+		Unique<DescriptorSetLayout> m_descriptorSetLayout = nullptr;
+
+		VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+		Unique<Pipeline> m_reprojectPipeline = nullptr;
+		Unique<Pipeline> m_atrousPipeline = nullptr;
+		Unique<Pipeline> m_modulatePipeline = nullptr;
+
+		bool m_areTimestampsSupported = false;
+		std::array<VkQueryPool, SwapChain::MAX_FRAMES_IN_FLIGHT> m_queryPools{};
+		std::array<bool, SwapChain::MAX_FRAMES_IN_FLIGHT> m_areTimestampsWritten{};
+		DenoiserTimings m_timings{};
+	};
+}
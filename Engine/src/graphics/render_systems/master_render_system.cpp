@@ -8,7 +8,8 @@ namespace PXTEngine {
 			TextureRegistry& textureRegistry, MaterialRegistry& materialRegistry, 
 			BLASRegistry& blasRegistry,
 			Shared<DescriptorSetLayout> globalSetLayout,
-			Shared<Environment> environment)
+			Shared<Environment> environment,
+			Shared<Image> blueNoiseTexture)
 		:	m_context(context), 
 			m_renderer(renderer),
 			m_descriptorAllocator(std::move(descriptorAllocator)),
@@ -16,7 +17,8 @@ namespace PXTEngine {
 		    m_materialRegistry(materialRegistry),
 			m_blasRegistry(blasRegistry),
 			m_globalSetLayout(std::move(globalSetLayout)),
-			m_environment(std::move(environment))
+			m_environment(std::move(environment)),
+			m_blueNoiseTexture(std::move(blueNoiseTexture))
 	{
 		m_offscreenColorFormat = m_context.findSupportedFormat(
 			{ VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_R8G8B8A8_UNORM },
@@ -288,6 +290,7 @@ namespace PXTEngine {
 			m_context,
 			m_descriptorAllocator,
 			m_textureRegistry,
+			m_materialRegistry,
 			*m_globalSetLayout,
 			m_offscreenRenderPass->getHandle(),
 			m_shadowMapRenderSystem->getShadowMapImageInfo()
@@ -320,9 +323,17 @@ namespace PXTEngine {
 			m_materialRegistry,
 			m_blasRegistry,
 			m_environment,
+			m_blueNoiseTexture,
 			*m_globalSetLayout,
 			m_sceneImage
 		);
+
+		m_denoiserRenderSystem = createUnique<DenoiserRenderSystem>(
+			m_context,
+			m_descriptorAllocator,
+			m_sceneImage,
+			m_rayTracingRenderSystem->getFeatures()
+		);
 	}
 
 	void MasterRenderSystem::reloadShaders() {
@@ -351,6 +362,7 @@ namespace PXTEngine {
 
 			// update scene image for raytracing
 			m_rayTracingRenderSystem->updateSceneImage(m_sceneImage);
+			m_denoiserRenderSystem->updateImages(m_sceneImage, m_rayTracingRenderSystem->getFeatures());
 			m_lastFrameSwapChainExtent = swapChainExtent;
 		}
 
@@ -366,23 +378,52 @@ namespace PXTEngine {
 		ubo.view = frameInfo.camera.getViewMatrix();
 		ubo.inverseView = frameInfo.camera.getInverseViewMatrix();
 
+		// the reprojection of the denoiser needs where the camera was in the previous frame
+		const glm::mat4 projectionView = ubo.projection * ubo.view;
+		const bool hasCameraMoved = m_hasPreviousProjectionView && projectionView != m_previousProjectionView;
+		ubo.previousProjectionView = m_hasPreviousProjectionView ? m_previousProjectionView : projectionView;
+		m_previousProjectionView = projectionView;
+		m_hasPreviousProjectionView = true;
+
 		// update light values into ubo
 		m_pointLightSystem->update(frameInfo, ubo);
 
-		// update shadow map
-		m_shadowMapRenderSystem->update(frameInfo, ubo);
+		// the drawable entities, extracted from the scene once for every render system
+		m_renderList.build(frameInfo.scene, m_materialRegistry);
+
+		if (!m_isRaytracingEnabled) {
+			// update shadow map
+			m_shadowMapRenderSystem->update(frameInfo, ubo, m_renderList);
+
+			// fill the instances and draw commands of the material pass
+			if (!m_isDebugEnabled) {
+				m_materialRenderSystem->update(frameInfo, m_renderList);
+			}
+		}
 
 		// update raytracing scene
 		if (m_isRaytracingEnabled) {
+			m_rayTracingRenderSystem->setAdaptiveSamplingEnabled(m_isAccumulationEnabled && m_isAdaptiveSamplingEnabled);
+
+			// the accumulation restarts when the camera or the sampling change, update() checks the scene
+			if (hasCameraMoved || m_isAccumulationResetRequested) {
+				m_rayTracingRenderSystem->resetPathTracingAccumulationFrameCount();
+				m_isAccumulationResetRequested = false;
+			}
+
+			m_rayTracingRenderSystem->update(frameInfo, m_renderList);
+
 			if (m_isAccumulationEnabled) {
-				ubo.accumulationEnabled = true;
+				ubo.accumulationEnabled = VK_TRUE;
 				ubo.ptAccumulationCount = m_rayTracingRenderSystem->getAndIncrementPathTracingAccumulationFrameCount();
 			} else {
-				ubo.accumulationEnabled = false;
+				ubo.accumulationEnabled = VK_FALSE;
 				ubo.ptAccumulationCount = 0;
 				m_rayTracingRenderSystem->resetPathTracingAccumulationFrameCount();
 			}
-			m_rayTracingRenderSystem->update(frameInfo);
+
+			ubo.adaptiveSamplingEnabled = m_isAdaptiveSamplingEnabled ? VK_TRUE : VK_FALSE;
+			ubo.convergenceThreshold = m_convergenceThreshold;
 		}
 	}
 
@@ -393,6 +434,17 @@ namespace PXTEngine {
 		// render to offscreen main render pass
 		if (m_isRaytracingEnabled) {
 			m_rayTracingRenderSystem->render(frameInfo, m_renderer);
+
+			// the accumulation already converges the image, the denoiser is for the interactive frames
+			const bool isDenoiserEnabled = m_denoiserSettings.enabled && !m_isAccumulationEnabled;
+			if (isDenoiserEnabled) {
+				if (!m_wasDenoisedLastFrame) {
+					m_denoiserRenderSystem->resetHistory();
+				}
+				m_denoiserRenderSystem->render(frameInfo, m_denoiserSettings);
+			}
+			m_wasDenoisedLastFrame = isDenoiserEnabled;
+
 			// this transitions the scene image back to shader_read_only_optimal for the next
 			// renderpass (for now only point light billboards)
 			m_rayTracingRenderSystem->transitionImageToShaderReadOnlyOptimal(frameInfo);
@@ -408,7 +460,7 @@ namespace PXTEngine {
 			// render shadow cube map
 			// the render function of the shadow map render system will
 			// do how many passes it needs to do (6 in this case - 1 point light)
-			m_shadowMapRenderSystem->render(frameInfo, m_renderer);
+			m_shadowMapRenderSystem->render(frameInfo, m_renderer, m_renderList);
 
 			//begin offscreen render pass
 			m_renderer.beginRenderPass(frameInfo.commandBuffer, *m_offscreenRenderPass,
@@ -418,10 +470,10 @@ namespace PXTEngine {
 
 			// choose if debug or not
 			if (m_isDebugEnabled) {
-				m_debugRenderSystem->render(frameInfo);
+				m_debugRenderSystem->render(frameInfo, m_renderList);
 			}
 			else {
-				m_materialRenderSystem->render(frameInfo);
+				m_materialRenderSystem->render(frameInfo, m_renderList);
 			}
 
 			m_pointLightSystem->render(frameInfo);
@@ -523,6 +575,47 @@ namespace PXTEngine {
 		ImGui::Checkbox("Enable Raytracing", &m_isRaytracingEnabled);
 		if (m_isRaytracingEnabled) {
 			ImGui::Checkbox("Enable Accumulation", &m_isAccumulationEnabled);
+
+			if (m_isAccumulationEnabled) {
+				ImGui::Checkbox("Adaptive Sampling", &m_isAdaptiveSamplingEnabled);
+
+				if (m_isAdaptiveSamplingEnabled) {
+					// a looser threshold converges the image sooner
+					if (ImGui::SliderFloat("Convergence Threshold", &m_convergenceThreshold, 0.001f, 0.1f, "%.3f", ImGuiSliderFlags_Logarithmic)) {
+						m_isAccumulationResetRequested = true;
+					}
+
+					const ConvergenceStats& stats = m_rayTracingRenderSystem->getConvergenceStats();
+					const VkExtent2D extent = m_sceneImage->getExtent();
+					const float activePercentage = 100.0f * static_cast<float>(stats.activePixelCount) / static_cast<float>(extent.width * extent.height);
+
+					if (stats.isConverged) {
+						ImGui::Text("Converged in %.2f s, %u frames", stats.elapsedSeconds, stats.convergedFrameCount);
+					} else {
+						ImGui::Text("Sampling %.1f%% of the pixels, %.2f s", activePercentage, stats.elapsedSeconds);
+					}
+				}
+			}
+
+			if (ImGui::CollapsingHeader("Denoiser (SVGF)", ImGuiTreeNodeFlags_DefaultOpen)) {
+				ImGui::Checkbox("Enable Denoiser", &m_denoiserSettings.enabled);
+				ImGui::SliderInt("Filter Iterations", &m_denoiserSettings.filterIterations, 1, DenoiserSettings::MAX_FILTER_ITERATIONS);
+				ImGui::SliderFloat("Temporal Alpha", &m_denoiserSettings.temporalAlpha, 0.01f, 1.0f);
+				ImGui::SliderFloat("Moments Alpha", &m_denoiserSettings.momentsAlpha, 0.01f, 1.0f);
+				ImGui::SliderFloat("Color Phi", &m_denoiserSettings.colorPhi, 0.1f, 16.0f);
+				ImGui::SliderFloat("Normal Phi", &m_denoiserSettings.normalPhi, 1.0f, 256.0f);
+				ImGui::SliderFloat("Depth Phi", &m_denoiserSettings.depthPhi, 0.001f, 0.2f, "%.3f");
+
+				if (m_isAccumulationEnabled) {
+					ImGui::Text("The denoiser is paused while accumulating");
+				}
+
+				const DenoiserTimings& timings = m_denoiserRenderSystem->getTimings();
+				ImGui::Text("Reproject: %.3f ms", timings.reprojectMs);
+				ImGui::Text("Filter: %.3f ms", timings.filterMs);
+				ImGui::Text("Modulate: %.3f ms", timings.modulateMs);
+				ImGui::Text("Total: %.3f ms", timings.getTotalMs());
+			}
 		}
 		
 		ImGui::End();
@@ -547,6 +640,10 @@ namespace PXTEngine {
 
 		if (!m_isRaytracingEnabled) {
 			m_shadowMapRenderSystem->updateUi();
+
+			if (!m_isDebugEnabled) {
+				m_materialRenderSystem->updateUi();
+			}
 		}
 	}
 }
\ No newline at end of file
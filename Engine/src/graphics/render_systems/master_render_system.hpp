@@ -5,6 +5,7 @@
 #include "graphics/renderer.hpp"
 #include "graphics/descriptors/descriptors.hpp"
 #include "graphics/frame_info.hpp"
+#include "graphics/render_list.hpp"
 #include "graphics/resources/texture_registry.hpp"
 #include "graphics/resources/material_registry.hpp"
 #include "graphics/resources/blas_registry.hpp"
@@ -16,6 +17,8 @@
 #include "graphics/render_systems/debug_render_system.hpp"
 #include "graphics/render_systems/skybox_render_system.hpp"
 #include "graphics/render_systems/raytracing_render_system.hpp"
+#include "graphics/render_systems/denoiser_render_system.hpp"
+#include "graphics/denoiser_settings.hpp"
 #include "graphics/render_pass.hpp"
 #include "graphics/frame_buffer.hpp"
 
@@ -32,7 +35,8 @@ namespace PXTEngine {
 						   MaterialRegistry& materialRegistry,
 						   BLASRegistry& blasRegistry,
 						   Shared<DescriptorSetLayout> globalSetLayout,
-						   Shared<Environment> environment);
+						   Shared<Environment> environment,
+						   Shared<Image> blueNoiseTexture);
 
 		~MasterRenderSystem();
 
@@ -44,6 +48,14 @@ namespace PXTEngine {
 		void onUpdate(FrameInfo& frameInfo, GlobalUbo& ubo);
 		void doRenderPasses(FrameInfo& frameInfo);
 
+		const MaterialDrawStats& getMaterialDrawStats() const { return m_materialRenderSystem->getStats(); }
+
+		/**
+		 * @brief Switches the material pass between the indirect draws and the per object draws, to compare them.
+		 */
+		bool isIndirectDrawEnabled() const { return m_materialRenderSystem->isIndirectDrawEnabled(); }
+		void setIndirectDrawEnabled(const bool isEnabled) { m_materialRenderSystem->setIndirectDrawEnabled(isEnabled); }
+
 	private:
 		void recreateViewportResources();
 		void createRenderPass();
@@ -73,8 +85,13 @@ namespace PXTEngine {
 
 		Shared<Environment> m_environment;
 
+		Shared<Image> m_blueNoiseTexture;
+
 		std::array<Unique<VulkanBuffer>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_uboBuffers;
 
+		// built in onUpdate for the raster passes
+		RenderList m_renderList;
+
 		Unique<MaterialRenderSystem> m_materialRenderSystem = nullptr;
 		Unique<PointLightSystem> m_pointLightSystem = nullptr;
 		Unique<ShadowMapRenderSystem> m_shadowMapRenderSystem = nullptr;
@@ -82,6 +99,7 @@ namespace PXTEngine {
 		Unique<DebugRenderSystem> m_debugRenderSystem = nullptr;
 		Unique<SkyboxRenderSystem> m_skyboxRenderSystem = nullptr;
 		Unique<RayTracingRenderSystem> m_rayTracingRenderSystem = nullptr;
+		Unique<DenoiserRenderSystem> m_denoiserRenderSystem = nullptr;
 
 		Unique<RenderPass> m_offscreenRenderPass;
 		Unique<FrameBuffer> m_offscreenFb;
@@ -94,11 +112,18 @@ namespace PXTEngine {
 		Unique<DescriptorSetLayout> m_sceneDescriptorSetLayout = nullptr;
 
 		VkExtent2D m_lastFrameSwapChainExtent;
+		glm::mat4 m_previousProjectionView{1.f};
+		bool m_hasPreviousProjectionView = false;
 		ImVec2 m_sceneImageExtentInWindow = { 960, 540 };
 
 		bool m_isDebugEnabled = false;
 		bool m_isRaytracingEnabled = true;
 		bool m_isAccumulationEnabled = false;
+		bool m_isAdaptiveSamplingEnabled = true;
+		float m_convergenceThreshold = 0.01f;
+		bool m_isAccumulationResetRequested = false;
+		DenoiserSettings m_denoiserSettings{};
+		bool m_wasDenoisedLastFrame = false;
 		bool m_isReloadShadersButtonPressed = false;
 	};
 }
\ No newline at end of file
@@ -1,38 +1,41 @@
 #include "graphics/render_systems/material_render_system.hpp"
 
-#include "graphics/resources/vk_mesh.hpp"
 #include "scene/ecs/entity.hpp"
 
 namespace PXTEngine {
 
-    struct MaterialPushConstantData {
-        glm::mat4 modelMatrix{1.f};
-        glm::mat4 normalMatrix{1.f};
-        glm::vec4 color{1.f};
-        float specularIntensity = 0.0f;
-        float shininess = 1.0f;
-        int textureIndex = 0;
-        int normalMapIndex = 1;
-        int ambientOcclusionMapIndex = 0;
-        int metallicMapIndex = 0;
-		int roughnessMapIndex = 0;
-		float tilingFactor = 1.0f;
-    };
-
     MaterialRenderSystem::MaterialRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator,
-    	TextureRegistry& textureRegistry, DescriptorSetLayout& globalSetLayout,
+    	TextureRegistry& textureRegistry, MaterialRegistry& materialRegistry, DescriptorSetLayout& globalSetLayout,
     	VkRenderPass renderPass, VkDescriptorImageInfo shadowMapImageInfo)
         : m_context(context),
         m_descriptorAllocator(descriptorAllocator),
         m_textureRegistry(textureRegistry),
-        m_renderPassHandle(renderPass)
+        m_materialRegistry(materialRegistry),
+        m_renderPassHandle(renderPass),
+        m_instanceBuffer(context, descriptorAllocator, sizeof(MaterialInstanceData), VK_SHADER_STAGE_VERTEX_BIT)
     {
+        // without it every batch is recorded as a direct instanced draw
+        m_isDrawIndirectFirstInstanceSupported = m_context.supportsDrawIndirectFirstInstance();
+        if (!m_isDrawIndirectFirstInstanceSupported) {
+            PXT_WARN("drawIndirectFirstInstance is not supported, the material renderer falls back to direct draws");
+        }
+
+        // without it every batch is a vkCmdDrawIndexedIndirect of its own
+        m_maxDrawsPerIndirectCall = m_context.supportsMultiDrawIndirect()
+            ? std::max(1u, m_context.getPhysicalDeviceProperties().limits.maxDrawIndirectCount)
+            : 1u;
+
 		createDescriptorSets(shadowMapImageInfo);
         createPipelineLayout(globalSetLayout);
         createPipeline();
+        createQueryPools();
     }
 
     MaterialRenderSystem::~MaterialRenderSystem() {
+        for (VkQueryPool queryPool : m_queryPools) {
+            vkDestroyQueryPool(m_context.getDevice(), queryPool, nullptr);
+        }
+
         vkDestroyPipelineLayout(m_context.getDevice(), m_pipelineLayout, nullptr);
     }
 
@@ -50,23 +53,20 @@ namespace PXTEngine {
     }
 
     void MaterialRenderSystem::createPipelineLayout(DescriptorSetLayout& globalSetLayout) {
-        VkPushConstantRange pushConstantRange{};
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-        pushConstantRange.offset = 0;
-        pushConstantRange.size = sizeof(MaterialPushConstantData);
-
         std::vector<VkDescriptorSetLayout> descriptorSetLayouts{
             globalSetLayout.getDescriptorSetLayout(),
             m_textureRegistry.getDescriptorSetLayout(),
-            m_shadowMapDescriptorSetLayout->getDescriptorSetLayout()
+            m_shadowMapDescriptorSetLayout->getDescriptorSetLayout(),
+            m_instanceBuffer.getDescriptorSetLayout().getDescriptorSetLayout(),
+            m_materialRegistry.getDescriptorSetLayout()
         };
 
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
         pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
-        pipelineLayoutInfo.pushConstantRangeCount = 1;
-        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+        pipelineLayoutInfo.pushConstantRangeCount = 0;
+        pipelineLayoutInfo.pPushConstantRanges = nullptr;
 
         if (vkCreatePipelineLayout(m_context.getDevice(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
             throw std::runtime_error("failed to create pipeline layout!");
@@ -96,13 +96,145 @@ namespace PXTEngine {
         );
     }
 
-    void MaterialRenderSystem::render(FrameInfo& frameInfo) {
-        m_pipeline->bind(frameInfo.commandBuffer);
+    void MaterialRenderSystem::createQueryPools() {
+        m_areTimestampsSupported = m_context.getPhysicalDeviceProperties().limits.timestampComputeAndGraphics;
+        if (!m_areTimestampsSupported) {
+            PXT_WARN("Timestamp queries are not supported, the material pass will not be timed");
+            return;
+        }
+
+        VkQueryPoolCreateInfo queryPoolInfo{};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInfo.queryCount = TIMESTAMP_COUNT;
+
+        for (VkQueryPool& queryPool : m_queryPools) {
+            if (vkCreateQueryPool(m_context.getDevice(), &queryPoolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create material timestamp query pool!");
+            }
+        }
+    }
+
+    void MaterialRenderSystem::readGpuTime(const uint32_t frameIndex) {
+        if (!m_areTimestampsWritten[frameIndex]) return;
+
+        // the fence of this frame slot was waited, the timestamps of its last use are ready
+        std::array<uint64_t, TIMESTAMP_COUNT> timestamps{};
+        if (vkGetQueryPoolResults(m_context.getDevice(), m_queryPools[frameIndex], 0, TIMESTAMP_COUNT,
+            sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+            return;
+        }
+
+        const float msPerTick = m_context.getPhysicalDeviceProperties().limits.timestampPeriod / 1e6f;
+        m_stats.gpuMs = static_cast<float>(timestamps[END] - timestamps[BEGIN]) * msPerTick;
+    }
+
+    void MaterialRenderSystem::reserveDrawCommands(FrameDrawData& frameData, const uint32_t drawCount) {
+        if (frameData.drawCommandBuffer && drawCount <= frameData.drawCommandCapacity) return;
+
+        const uint32_t capacity = std::max({ drawCount, frameData.drawCommandCapacity * 2, 16u });
+
+        frameData.drawCommandBuffer = createUnique<VulkanBuffer>(
+            m_context,
+            sizeof(VkDrawIndexedIndirectCommand),
+            capacity,
+            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+        frameData.drawCommandBuffer->map();
+        frameData.drawCommandCapacity = capacity;
+    }
+
+    void MaterialRenderSystem::writeInstances(FrameInfo& frameInfo, const RenderList& renderList, FrameDrawData& frameData) {
+        const uint32_t frameIndex = static_cast<uint32_t>(frameInfo.frameIndex);
+        auto* instances = static_cast<MaterialInstanceData*>(m_instanceBuffer.reserve(frameIndex, renderList.getInstanceCount()));
 
-        std::array<VkDescriptorSet, 3> descriptorSets = { frameInfo.globalDescriptorSet, m_textureRegistry.getDescriptorSet(), m_shadowMapDescriptorSet};
+        // the render list is in instance order, the instances of a batch are contiguous
+        const std::span<const glm::mat4> worldMatrices = renderList.getWorldMatrices();
+        const std::span<const glm::mat4> normalMatrices = renderList.getNormalMatrices();
+        const std::span<const glm::vec3> tints = renderList.getTints();
+        const std::span<const uint32_t> materialIndices = renderList.getMaterialIndices();
+        const std::span<const float> tilingFactors = renderList.getTilingFactors();
+
+        for (uint32_t i = 0; i < renderList.getInstanceCount(); i++) {
+            MaterialInstanceData instance{};
+            instance.modelMatrix = worldMatrices[i];
+            instance.normalMatrix = normalMatrices[i];
+            instance.tint = glm::vec4(tints[i], 1.0f);
+            instance.materialIndex = materialIndices[i];
+            instance.tilingFactor = tilingFactors[i];
+
+            // written once in a block, the mapped memory is write combined
+            instances[i] = instance;
+        }
+
+        auto* drawCommands = static_cast<VkDrawIndexedIndirectCommand*>(frameData.drawCommandBuffer->getMappedMemory());
+
+        const std::span<const RenderList::Batch> batches = renderList.getBatches();
+        for (size_t i = 0; i < batches.size(); i++) {
+            const RenderList::Batch& batch = batches[i];
+            const GeometryRange& range = batch.mesh->getGeometryRange();
+
+            VkDrawIndexedIndirectCommand drawCommand{};
+            drawCommand.indexCount = range.indexCount;
+            drawCommand.instanceCount = batch.instanceCount;
+            drawCommand.firstIndex = range.firstIndex;
+            drawCommand.vertexOffset = static_cast<int32_t>(range.firstVertex);
+            drawCommand.firstInstance = batch.firstInstance;
+
+            drawCommands[i] = drawCommand;
+        }
+    }
+
+    void MaterialRenderSystem::update(FrameInfo& frameInfo, const RenderList& renderList) {
+        PXT_PROFILE_FN();
+
+        const auto prepareBegin = std::chrono::high_resolution_clock::now();
+        const uint32_t frameIndex = static_cast<uint32_t>(frameInfo.frameIndex);
+
+        // the query pool can't be reset inside the render pass
+        if (m_areTimestampsSupported) {
+            readGpuTime(frameIndex);
+            vkCmdResetQueryPool(frameInfo.commandBuffer, m_queryPools[frameIndex], 0, TIMESTAMP_COUNT);
+            m_areTimestampsWritten[frameIndex] = false;
+        }
+
+        FrameDrawData& frameData = m_frameDrawData[frameIndex];
+        reserveDrawCommands(frameData, static_cast<uint32_t>(renderList.getBatches().size()));
+        writeInstances(frameInfo, renderList, frameData);
+
+        m_stats.prepareMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - prepareBegin).count();
+    }
+
+    void MaterialRenderSystem::render(FrameInfo& frameInfo, const RenderList& renderList) {
+        PXT_PROFILE_FN();
+
+        const auto recordBegin = std::chrono::high_resolution_clock::now();
+
+        VkCommandBuffer commandBuffer = frameInfo.commandBuffer;
+        const uint32_t frameIndex = static_cast<uint32_t>(frameInfo.frameIndex);
+        const FrameDrawData& frameData = m_frameDrawData[frameIndex];
+
+        // update() was not called for this frame slot yet
+        const VkDescriptorSet instanceDescriptorSet = m_instanceBuffer.getDescriptorSet(frameIndex);
+        if (instanceDescriptorSet == VK_NULL_HANDLE) return;
+
+        if (m_areTimestampsSupported) {
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPools[frameIndex], BEGIN);
+        }
+
+        m_pipeline->bind(commandBuffer);
+
+        std::array<VkDescriptorSet, 5> descriptorSets = {
+            frameInfo.globalDescriptorSet,
+            m_textureRegistry.getDescriptorSet(frameIndex),
+            m_shadowMapDescriptorSet,
+            instanceDescriptorSet,
+            m_materialRegistry.getDescriptorSet(frameIndex)
+        };
 
         vkCmdBindDescriptorSets(
-            frameInfo.commandBuffer,
+            commandBuffer,
             VK_PIPELINE_BIND_POINT_GRAPHICS,
             m_pipelineLayout,
             0,
@@ -112,42 +244,90 @@ namespace PXTEngine {
             nullptr
         );
 
-        auto view = frameInfo.scene.getEntitiesWith<TransformComponent, MeshComponent, MaterialComponent>();
-        for (auto entity : view) {
-
-            const auto&[transform, meshComponent, materialComponent] = view.get<TransformComponent, MeshComponent, MaterialComponent>(entity);
-
-			auto material = materialComponent.material;
-            auto vulkanMesh = std::static_pointer_cast<VulkanMesh>(meshComponent.mesh);
-
-            MaterialPushConstantData push{};
-            push.modelMatrix = transform.mat4();
-            push.normalMatrix = transform.normalMatrix();
-            push.color = material->getAlbedoColor() * glm::vec4(materialComponent.tint, 1.0f);
-            push.specularIntensity = 0.0f;
-            push.shininess = 1.0f;
-            push.textureIndex = m_textureRegistry.getIndex(material->getAlbedoMap()->id);
-            push.normalMapIndex = m_textureRegistry.getIndex(material->getNormalMap()->id);
-			//push.metallicMapIndex = m_textureRegistry.getIndex(material->getMetallicMap()->id);
-			//push.roughnessMapIndex = m_textureRegistry.getIndex(material->getRoughnessMap()->id);
-            push.ambientOcclusionMapIndex = m_textureRegistry.getIndex(material->getAmbientOcclusionMap()->id);
-            push.tilingFactor = materialComponent.tilingFactor;
-
-            vkCmdPushConstants(
-                frameInfo.commandBuffer,
-                m_pipelineLayout,
-                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                0,
-                sizeof(MaterialPushConstantData),
-                &push);
-            
-            vulkanMesh->bind(frameInfo.commandBuffer);
-            vulkanMesh->draw(frameInfo.commandBuffer);
+        const std::span<const RenderList::Batch> batches = renderList.getBatches();
+        const uint32_t batchCount = static_cast<uint32_t>(batches.size());
+        uint32_t drawCount = batchCount;
+        uint32_t bindCount = 1;
+
+        if (!m_isIndirectDrawEnabled) {
+            // the per object path, as the pass was recorded before the instancing
+            for (const RenderList::Batch& batch : batches) {
+                const GeometryRange& range = batch.mesh->getGeometryRange();
+
+                for (uint32_t instance = batch.firstInstance; instance < batch.firstInstance + batch.instanceCount; instance++) {
+                    batch.mesh->bind(commandBuffer);
+                    vkCmdDrawIndexed(commandBuffer, range.indexCount, 1, range.firstIndex,
+                        static_cast<int32_t>(range.firstVertex), instance);
+                }
+            }
+            drawCount = renderList.getInstanceCount();
+            bindCount = drawCount;
+        } else if (m_isDrawIndirectFirstInstanceSupported) {
+            // every mesh is in the geometry arena, all the batches are read from the same buffers
+            m_context.getGeometryArena().bind(commandBuffer);
+
+            for (uint32_t firstDraw = 0; firstDraw < batchCount; firstDraw += m_maxDrawsPerIndirectCall) {
+                vkCmdDrawIndexedIndirect(
+                    commandBuffer,
+                    frameData.drawCommandBuffer->getBuffer(),
+                    firstDraw * sizeof(VkDrawIndexedIndirectCommand),
+                    std::min(m_maxDrawsPerIndirectCall, batchCount - firstDraw),
+                    sizeof(VkDrawIndexedIndirectCommand)
+                );
+            }
+        } else {
+            m_context.getGeometryArena().bind(commandBuffer);
 
+            for (const RenderList::Batch& batch : batches) {
+                const GeometryRange& range = batch.mesh->getGeometryRange();
+                vkCmdDrawIndexed(commandBuffer, range.indexCount, batch.instanceCount, range.firstIndex,
+                    static_cast<int32_t>(range.firstVertex), batch.firstInstance);
+            }
         }
+
+        if (m_areTimestampsSupported) {
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPools[frameIndex], END);
+            m_areTimestampsWritten[frameIndex] = true;
+        }
+
+        m_stats.bindCount = bindCount;
+        m_stats.drawCount = drawCount;
+        m_stats.indirectCallCount = m_isIndirectDrawEnabled && m_isDrawIndirectFirstInstanceSupported
+            ? (batchCount + m_maxDrawsPerIndirectCall - 1) / m_maxDrawsPerIndirectCall
+            : 0;
+        m_stats.instanceCount = renderList.getInstanceCount();
+        m_stats.renderListMs = renderList.getBuildMs();
+        m_stats.recordMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - recordBegin).count();
     }
 
     void MaterialRenderSystem::reloadShaders() {
 		createPipeline(false);
     }
-}
\ No newline at end of file
+
+    void MaterialRenderSystem::updateUi() {
+        ImGui::Begin("Material Renderer");
+
+        ImGui::Checkbox("Indirect Draws", &m_isIndirectDrawEnabled);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("An instanced indirect draw per mesh, otherwise a bind and a draw per entity");
+        }
+
+        ImGui::Text("Entities: %u, binds: %u, draws: %u", m_stats.instanceCount, m_stats.bindCount, m_stats.drawCount);
+        if (m_isIndirectDrawEnabled) {
+            ImGui::Text("Indirect draw calls: %u", m_stats.indirectCallCount);
+        }
+        ImGui::Text("CPU render list (%u instances): %.3f ms", m_stats.instanceCount, m_stats.renderListMs);
+        ImGui::Text("CPU prepare: %.3f ms", m_stats.prepareMs);
+        ImGui::Text("CPU record: %.3f ms", m_stats.recordMs);
+        ImGui::Text("GPU: %.3f ms", m_stats.gpuMs);
+
+        const GeometryArena& geometryArena = m_context.getGeometryArena();
+        ImGui::Separator();
+        ImGui::Text("Geometry arena vertices: %u / %u",
+            geometryArena.getVertexCapacity() - geometryArena.getFreeVertexCount(), geometryArena.getVertexCapacity());
+        ImGui::Text("Geometry arena indices: %u / %u",
+            geometryArena.getIndexCapacity() - geometryArena.getFreeIndexCount(), geometryArena.getIndexCapacity());
+
+        ImGui::End();
+    }
+}
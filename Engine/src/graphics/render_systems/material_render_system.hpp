@@ -7,28 +7,103 @@
 #include "graphics/frame_info.hpp"
 #include "graphics/descriptors/descriptors.hpp"
 #include "graphics/resources/texture_registry.hpp"
+#include "graphics/resources/material_registry.hpp"
+#include "graphics/resources/instance_buffer.hpp"
+#include "graphics/resources/vk_buffer.hpp"
+#include "graphics/render_list.hpp"
 #include "scene/scene.hpp"
 
 namespace PXTEngine {
 
+    /**
+     * @struct MaterialInstanceData
+     *
+     * @brief Per entity data read by material_shader.vert with gl_InstanceIndex.
+     *
+     * @note alignas(16) matches the std430 layout of MaterialInstance in the shader.
+     */
+    struct alignas(16) MaterialInstanceData {
+        glm::mat4 modelMatrix;
+        glm::mat4 normalMatrix;
+        glm::vec4 tint;
+        uint32_t materialIndex;
+        float tilingFactor;
+    };
+
+    /**
+     * @struct MaterialDrawStats
+     * @brief CPU and GPU cost of the material pass, to compare the draw paths.
+     */
+    struct MaterialDrawStats {
+        float renderListMs = 0.0f; // extracting and sorting the entities, shared by every render system
+        float prepareMs = 0.0f; // filling the instance and draw command buffers
+        float recordMs = 0.0f;  // recording the draw calls
+        float gpuMs = 0.0f;     // GPU time between the first and the last draw
+        uint32_t bindCount = 0;         // vertex and index buffer binds, once per pass with the geometry arena
+        uint32_t drawCount = 0;         // draws, one per mesh with the instancing
+        uint32_t indirectCallCount = 0; // vkCmdDrawIndexedIndirect calls recorded for them
+        uint32_t instanceCount = 0;
+    };
+
+    /**
+     * @class MaterialRenderSystem
+     *
+     * @brief Draws the entities with a mesh and a material in the rasterized view.
+     *
+     * The per entity data lives in a persistently mapped storage buffer and the materials are read
+     * from the MaterialRegistry buffer, so no push constants are needed between draws.
+     * The entities are grouped by mesh by the RenderList and every group is an instanced draw command. Every mesh is a
+     * range of the GeometryArena, so the arena is bound once and all the commands are read by a
+     * single vkCmdDrawIndexedIndirect (split by maxDrawIndirectCount, or one per command without multiDrawIndirect).
+     * The per object path, a bind and a draw for every entity, is kept to measure the difference.
+     */
     class MaterialRenderSystem {
     public:
-        MaterialRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, TextureRegistry& textureRegistry, DescriptorSetLayout& globalSetLayout, VkRenderPass renderPass, VkDescriptorImageInfo shadowMapImageInfo);
+        MaterialRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, TextureRegistry& textureRegistry, MaterialRegistry& materialRegistry, DescriptorSetLayout& globalSetLayout, VkRenderPass renderPass, VkDescriptorImageInfo shadowMapImageInfo);
         ~MaterialRenderSystem();
 
         MaterialRenderSystem(const MaterialRenderSystem&) = delete;
         MaterialRenderSystem& operator=(const MaterialRenderSystem&) = delete;
 
-        void render(FrameInfo& frameInfo);
+        /**
+         * @brief Fills the instance and draw command buffers of the frame, it has to be called outside of the render pass.
+         */
+        void update(FrameInfo& frameInfo, const RenderList& renderList);
+
+        void render(FrameInfo& frameInfo, const RenderList& renderList);
         void reloadShaders();
+        void updateUi();
+
+        const MaterialDrawStats& getStats() const { return m_stats; }
+
+        bool isIndirectDrawEnabled() const { return m_isIndirectDrawEnabled; }
+        void setIndirectDrawEnabled(const bool isEnabled) { m_isIndirectDrawEnabled = isEnabled; }
 
     private:
+        struct FrameDrawData {
+            Unique<VulkanBuffer> drawCommandBuffer = nullptr;
+            uint32_t drawCommandCapacity = 0;
+        };
+
+        // timestamps written around the draws
+        enum Timestamp : uint32_t {
+            BEGIN = 0,
+            END,
+            TIMESTAMP_COUNT
+        };
+
         void createDescriptorSets(VkDescriptorImageInfo shadowMapImageInfo);
         void createPipelineLayout(DescriptorSetLayout& globalSetLayout);
         void createPipeline(bool useCompiledSpirvFiles = true);
-        
+        void createQueryPools();
+
+        void writeInstances(FrameInfo& frameInfo, const RenderList& renderList, FrameDrawData& frameData);
+        void reserveDrawCommands(FrameDrawData& frameData, uint32_t drawCount);
+        void readGpuTime(uint32_t frameIndex);
+
         Context& m_context;
         TextureRegistry& m_textureRegistry;
+        MaterialRegistry& m_materialRegistry;
 
 		VkRenderPass m_renderPassHandle;
         Unique<Pipeline> m_pipeline;
@@ -39,9 +114,21 @@ namespace PXTEngine {
         Unique<DescriptorSetLayout> m_shadowMapDescriptorSetLayout{};
         VkDescriptorSet m_shadowMapDescriptorSet{};
 
+        InstanceBuffer m_instanceBuffer;
+        std::array<FrameDrawData, SwapChain::MAX_FRAMES_IN_FLIGHT> m_frameDrawData{};
+
+        bool m_isIndirectDrawEnabled = true;
+        bool m_isDrawIndirectFirstInstanceSupported = false;
+        uint32_t m_maxDrawsPerIndirectCall = 1;
+
+        bool m_areTimestampsSupported = false;
+        std::array<VkQueryPool, SwapChain::MAX_FRAMES_IN_FLIGHT> m_queryPools{};
+        std::array<bool, SwapChain::MAX_FRAMES_IN_FLIGHT> m_areTimestampsWritten{};
+        MaterialDrawStats m_stats{};
+
         std::array<const std::string, 2> m_shaderFilePaths = {
             "material_shader.vert",
             "material_shader.frag"
         };
     };
-}
\ No newline at end of file
+}
@@ -1,10 +1,12 @@
 #include "graphics/render_systems/raytracing_render_system.hpp"
 
+#include "graphics/resources/sampler_tables.hpp"
+
 namespace PXTEngine {
 	RayTracingRenderSystem::RayTracingRenderSystem(
 		Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator,
 		TextureRegistry& textureRegistry, MaterialRegistry& materialRegistry,
-		BLASRegistry& blasRegistry, Shared<Environment> environment,
+		BLASRegistry& blasRegistry, Shared<Environment> environment, Shared<Image> blueNoiseTexture,
 		DescriptorSetLayout& globalSetLayout, Shared<VulkanImage> sceneImage)
 		: m_context(context),
 		m_textureRegistry(textureRegistry),
@@ -15,8 +17,10 @@ namespace PXTEngine {
 		m_sceneImage(sceneImage)
 	{
 		m_skybox = std::static_pointer_cast<VulkanSkybox>(m_environment->getSkybox());
+		m_blueNoiseTexture = std::static_pointer_cast<Texture2D>(blueNoiseTexture);
 
 		createDescriptorSets();
+		createSamplerDescriptorSet();
 		defineShaderGroups();
 		createPipelineLayout(globalSetLayout);
 		createPipeline();
@@ -29,42 +33,173 @@ namespace PXTEngine {
 
 
 	void RayTracingRenderSystem::createDescriptorSets() {
-		// Create storage image descriptor set
+		// Create storage image descriptor set: the scene image and the features for the denoiser
 		m_storageImageDescriptorSetLayout = DescriptorSetLayout::Builder(m_context)
 			.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
 				VK_SHADER_STAGE_RAYGEN_BIT_KHR,
 				1)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
+			.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
+			.addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
+			.addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
+			.addBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
+			.addBinding(6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
 			.build();
 
-		VkDescriptorImageInfo descriptorImageInfo;
-		descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-		descriptorImageInfo.imageView = m_sceneImage->getImageView();
-		descriptorImageInfo.sampler = VK_NULL_HANDLE;
-
 		m_descriptorAllocator->allocate(m_storageImageDescriptorSetLayout->getDescriptorSetLayout(), m_storageImageDescriptorSet);
 
-		DescriptorWriter(m_context, *m_storageImageDescriptorSetLayout)
-			.writeImage(0, &descriptorImageInfo)
-			.updateSet(m_storageImageDescriptorSet);
+		createFeatureImages();
+		createConvergenceBuffers();
+		updateStorageImageDescriptorSet();
+	}
+
+	void RayTracingRenderSystem::createFeatureImages() {
+		const VkExtent2D extent = m_sceneImage->getExtent();
+
+		m_features.radiance = VulkanImage::createStorageImage2D(m_context, extent, VK_FORMAT_R16G16B16A16_SFLOAT);
+		m_features.normalDepth = VulkanImage::createStorageImage2D(m_context, extent, VK_FORMAT_R16G16B16A16_SFLOAT);
+		m_features.albedo = VulkanImage::createStorageImage2D(m_context, extent, VK_FORMAT_R8G8B8A8_UNORM);
+		m_features.motion = VulkanImage::createStorageImage2D(m_context, extent, VK_FORMAT_R16G16B16A16_SFLOAT);
+
+		// sums of many samples, full floats keep their precision
+		m_convergenceImage = VulkanImage::createStorageImage2D(m_context, extent, VK_FORMAT_R32G32B32A32_SFLOAT);
+	}
+
+	void RayTracingRenderSystem::createConvergenceBuffers() {
+		m_activePixelCountBuffer = createUnique<VulkanBuffer>(
+			m_context,
+			sizeof(uint32_t),
+			1,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+		);
+
+		for (auto& readback : m_activePixelCountReadbacks) {
+			readback = createUnique<VulkanBuffer>(
+				m_context,
+				sizeof(uint32_t),
+				1,
+				VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+			);
+			readback->map();
+		}
+	}
+
+	void RayTracingRenderSystem::updateStorageImageDescriptorSet() {
+		const std::array<Shared<VulkanImage>, 6> images = {
+			m_sceneImage,
+			m_features.radiance,
+			m_features.normalDepth,
+			m_features.albedo,
+			m_features.motion,
+			m_convergenceImage
+		};
+
+		std::array<VkDescriptorImageInfo, 6> imageInfos{};
+		DescriptorWriter writer(m_context, *m_storageImageDescriptorSetLayout);
+
+		for (uint32_t i = 0; i < images.size(); i++) {
+			imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			imageInfos[i].imageView = images[i]->getImageView();
+			imageInfos[i].sampler = VK_NULL_HANDLE;
+
+			writer.writeImage(i, &imageInfos[i]);
+		}
+
+		VkDescriptorBufferInfo activePixelCountInfo = m_activePixelCountBuffer->descriptorInfo();
+		writer.writeBuffer(6, &activePixelCountInfo);
+
+		writer.updateSet(m_storageImageDescriptorSet);
+	}
+
+	void RayTracingRenderSystem::createSamplerDescriptorSet() {
+		const SobolTable sobolTable;
+
+		// header of sobolSSBO (sampler.glsl) followed by the samples
+		const std::array<uint32_t, 2> header = { sobolTable.getSampleCount(), sobolTable.getDimensionCount() };
+		const VkDeviceSize samplesSize = sobolTable.getSamples().size() * sizeof(uint32_t);
+
+		m_sobolBuffer = createUnique<VulkanBuffer>(
+			m_context,
+			sizeof(header) + samplesSize,
+			1,
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+		);
+
+		m_context.getUploader().copyToBuffer(m_sobolBuffer->getBuffer(), header.data(), sizeof(header));
+		m_context.getUploader().copyToBuffer(m_sobolBuffer->getBuffer(), sobolTable.getSamples().data(), samplesSize, sizeof(header));
+
+		m_samplerDescriptorSetLayout = DescriptorSetLayout::Builder(m_context)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR)
+			.build();
+
+		VkDescriptorImageInfo blueNoiseInfo{};
+		blueNoiseInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		blueNoiseInfo.imageView = m_blueNoiseTexture->getImageView();
+		blueNoiseInfo.sampler = m_blueNoiseTexture->getImageSampler();
+
+		VkDescriptorBufferInfo sobolInfo = m_sobolBuffer->descriptorInfo();
+
+		m_descriptorAllocator->allocate(m_samplerDescriptorSetLayout->getDescriptorSetLayout(), m_samplerDescriptorSet);
+
+		DescriptorWriter(m_context, *m_samplerDescriptorSetLayout)
+			.writeImage(0, &blueNoiseInfo)
+			.writeBuffer(1, &sobolInfo)
+			.updateSet(m_samplerDescriptorSet);
 	}
 
 	void RayTracingRenderSystem::updateSceneImage(Shared<VulkanImage> sceneImage) {
-		VkDescriptorImageInfo descriptorImageInfo;
-		descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-		descriptorImageInfo.imageView = sceneImage->getImageView();
-		descriptorImageInfo.sampler = VK_NULL_HANDLE;
-
-		DescriptorWriter(m_context, *m_storageImageDescriptorSetLayout)
-			.writeImage(0, &descriptorImageInfo)
-			.updateSet(m_storageImageDescriptorSet);
-		
 		m_sceneImage = sceneImage;
+
+		// the features follow the size of the scene image
+		createFeatureImages();
+		updateStorageImageDescriptorSet();
+
+		resetPathTracingAccumulationFrameCount();
+	}
+
+	void RayTracingRenderSystem::resetPathTracingAccumulationFrameCount() {
+		m_ptAccumulationFrameCount = 0;
+
+		// the pixel statistics restart with the accumulation, the counts of the frames in flight are stale
+		m_accumulationEpoch++;
+		m_convergenceStats = {};
+		m_accumulationStart = std::chrono::high_resolution_clock::now();
 	}
 
 	uint32_t RayTracingRenderSystem::getAndIncrementPathTracingAccumulationFrameCount() {		
 		return m_ptAccumulationFrameCount++;
 	}
 
+	void RayTracingRenderSystem::setAdaptiveSamplingEnabled(const bool enabled) {
+		if (enabled == m_isAdaptiveSamplingEnabled) return;
+
+		m_isAdaptiveSamplingEnabled = enabled;
+		resetPathTracingAccumulationFrameCount();
+	}
+
+	void RayTracingRenderSystem::readConvergence(const uint32_t frameIndex) {
+		if (!m_convergenceStats.isConverged) {
+			m_convergenceStats.elapsedSeconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - m_accumulationStart).count();
+		}
+
+		// the fence of this frame was waited, its count is ready
+		if (!m_isAdaptiveSamplingEnabled || m_readbackEpochs[frameIndex] != m_accumulationEpoch) return;
+		m_readbackEpochs[frameIndex] = 0;
+
+		m_convergenceStats.activePixelCount = *static_cast<const uint32_t*>(m_activePixelCountReadbacks[frameIndex]->getMappedMemory());
+
+		if (m_convergenceStats.activePixelCount == 0 && !m_convergenceStats.isConverged) {
+			m_convergenceStats.isConverged = true;
+			m_convergenceStats.convergedFrameCount = m_ptAccumulationFrameCount;
+
+			PXT_INFO("Path tracing converged in {:.2f} s, {} frames", m_convergenceStats.elapsedSeconds, m_ptAccumulationFrameCount);
+		}
+	}
+
 	void RayTracingRenderSystem::defineShaderGroups() {
 		// for rgen e miss there can be one shader per group
 		m_shaderGroups = {
@@ -125,7 +260,8 @@ namespace PXTEngine {
 			m_materialRegistry.getDescriptorSetLayout(),
 			m_skybox->getDescriptorSetLayout(),
 			m_rtSceneManager.getMeshInstanceDescriptorSetLayout(),
-			m_rtSceneManager.getEmittersDescriptorSetLayout()
+			m_rtSceneManager.getEmittersDescriptorSetLayout(),
+			m_samplerDescriptorSetLayout->getDescriptorSetLayout()
 		};
 
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
@@ -275,18 +411,6 @@ namespace PXTEngine {
 			handleIdx++;
 		}
 
-		VulkanBuffer stagingBuffer{
-			m_context,
-			sbtSize,
-			1,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-		};
-
-		stagingBuffer.map();
-		stagingBuffer.writeToBuffer(sbtBufferData.data(), sbtSize);
-		stagingBuffer.unmap();
-
 		// Create final SBT buffer on GPU
 		m_sbtBuffer = createUnique<VulkanBuffer>(
 			m_context,
@@ -296,7 +420,7 @@ namespace PXTEngine {
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
 		);
 
-		m_context.copyBuffer(stagingBuffer.getBuffer(), m_sbtBuffer->getBuffer(), sbtSize);
+		m_context.getUploader().copyToBuffer(m_sbtBuffer->getBuffer(), sbtBufferData.data(), sbtSize);
 
 		// Get SBT buffer device address, start of SBT
 		VkDeviceAddress sbtAddress = m_sbtBuffer->getDeviceAddress();
@@ -320,8 +444,17 @@ namespace PXTEngine {
 		m_callableRegion.size = 0;
 	}
 	
-	void RayTracingRenderSystem::update(FrameInfo& frameInfo) {
-		m_rtSceneManager.createTLAS(frameInfo);
+	void RayTracingRenderSystem::update(FrameInfo& frameInfo, const RenderList& renderList) {
+		m_rtSceneManager.buildTLAS(frameInfo, renderList);
+
+		// the accumulation is no longer valid once something moved
+		const uint64_t sceneChangeGeneration = m_rtSceneManager.getSceneChangeGeneration();
+		if (sceneChangeGeneration != m_sceneChangeGeneration) {
+			m_sceneChangeGeneration = sceneChangeGeneration;
+			resetPathTracingAccumulationFrameCount();
+		}
+
+		readConvergence(frameInfo.frameIndex);
 
 		m_sceneImage->transitionImageLayout(
 			frameInfo.commandBuffer,
@@ -332,17 +465,23 @@ namespace PXTEngine {
 	}
 
 	void RayTracingRenderSystem::render(FrameInfo& frameInfo, Renderer& renderer) {
+		// every pixel converged, the scene image already holds the final image
+		if (m_isAdaptiveSamplingEnabled && m_convergenceStats.isConverged) {
+			return;
+		}
+
 		m_pipeline->bind(frameInfo.commandBuffer);
 
-		std::array<VkDescriptorSet, 8> descriptorSets = { 
+		std::array<VkDescriptorSet, 9> descriptorSets = { 
 			frameInfo.globalDescriptorSet, 
-			m_rtSceneManager.getTLASDescriptorSet(), 
-			m_textureRegistry.getDescriptorSet(),
+			m_rtSceneManager.getTLASDescriptorSet(frameInfo.frameIndex), 
+			m_textureRegistry.getDescriptorSet(frameInfo.frameIndex),
 			m_storageImageDescriptorSet,
-			m_materialRegistry.getDescriptorSet(),
+			m_materialRegistry.getDescriptorSet(frameInfo.frameIndex),
 			m_skybox->getDescriptorSet(),
-			m_rtSceneManager.getMeshInstanceDescriptorSet(),
-			m_rtSceneManager.getEmittersDescriptorSet()
+			m_rtSceneManager.getMeshInstanceDescriptorSet(frameInfo.frameIndex),
+			m_rtSceneManager.getEmittersDescriptorSet(frameInfo.frameIndex),
+			m_samplerDescriptorSet
 		};
 	
 		vkCmdBindDescriptorSets(
@@ -356,6 +495,26 @@ namespace PXTEngine {
 			nullptr
 		);
 
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+
+		if (m_isAdaptiveSamplingEnabled) {
+			// the pixels still sampled count themselves, after the previous frame copied its count
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(frameInfo.commandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+			vkCmdFillBuffer(frameInfo.commandBuffer, m_activePixelCountBuffer->getBuffer(), 0, sizeof(uint32_t), 0);
+
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			vkCmdPipelineBarrier(frameInfo.commandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+				0, 1, &barrier, 0, nullptr, 0, nullptr);
+		}
+
 		vkCmdTraceRaysKHR(
 			frameInfo.commandBuffer,
 			&m_raygenRegion,
@@ -366,6 +525,28 @@ namespace PXTEngine {
 			renderer.getSwapChainExtent().height,
 			1
 		);
+
+		if (m_isAdaptiveSamplingEnabled) {
+			// the count is read back once the fence of this frame is waited
+			barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			vkCmdPipelineBarrier(frameInfo.commandBuffer,
+				VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+			VkBufferCopy copyRegion{};
+			copyRegion.size = sizeof(uint32_t);
+			vkCmdCopyBuffer(frameInfo.commandBuffer, m_activePixelCountBuffer->getBuffer(),
+				m_activePixelCountReadbacks[frameInfo.frameIndex]->getBuffer(), 1, &copyRegion);
+
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+			vkCmdPipelineBarrier(frameInfo.commandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+				0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+			m_readbackEpochs[frameInfo.frameIndex] = m_accumulationEpoch;
+		}
 	}
 
 	void RayTracingRenderSystem::transitionImageToShaderReadOnlyOptimal(FrameInfo& frameInfo) {
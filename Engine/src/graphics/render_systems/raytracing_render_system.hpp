@@ -8,6 +8,7 @@
 #include "graphics/resources/texture_registry.hpp"
 #include "graphics/resources/material_registry.hpp"
 #include "graphics/resources/vk_skybox.hpp"
+#include "graphics/resources/texture2d.hpp"
 #include "graphics/render_systems/raytracing_scene_manager_system.hpp"
 #include "graphics/renderer.hpp"
 #include "scene/scene.hpp"
@@ -15,25 +16,60 @@
 
 namespace PXTEngine {
 
+    /**
+     * @struct PathTracingFeatures
+     * @brief Images written by pathtracing.rgen beside the scene image, they guide the denoiser.
+     */
+    struct PathTracingFeatures {
+        Shared<VulkanImage> radiance = nullptr;     // radiance of the frame, before the accumulation
+        Shared<VulkanImage> normalDepth = nullptr;  // world normal and distance of the primary hit
+        Shared<VulkanImage> albedo = nullptr;       // albedo of the primary hit
+        Shared<VulkanImage> motion = nullptr;       // offset in pixels to the position in the previous frame
+    };
+
+    /**
+     * @struct ConvergenceStats
+     * @brief Progress of the adaptive sampling of the accumulation.
+     */
+    struct ConvergenceStats {
+        uint32_t activePixelCount = 0;  // pixels still sampled in the last frame read back
+        bool isConverged = false;       // no pixel is sampled anymore, the rays are not traced
+        float elapsedSeconds = 0.0f;    // since the accumulation started, until it converged
+        uint32_t convergedFrameCount = 0;
+    };
+
     class RayTracingRenderSystem {
     public:
-        RayTracingRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, TextureRegistry& textureRegistry, MaterialRegistry& materialRegistry, BLASRegistry& blasRegistry, Shared<Environment> environment, DescriptorSetLayout& globalSetLayout, Shared<VulkanImage> sceneImage);
+        RayTracingRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, TextureRegistry& textureRegistry, MaterialRegistry& materialRegistry, BLASRegistry& blasRegistry, Shared<Environment> environment, Shared<Image> blueNoiseTexture, DescriptorSetLayout& globalSetLayout, Shared<VulkanImage> sceneImage);
         ~RayTracingRenderSystem();
 
         RayTracingRenderSystem(const RayTracingRenderSystem&) = delete;
         RayTracingRenderSystem& operator=(const RayTracingRenderSystem&) = delete;
 
-        void update(FrameInfo& frameInfo);
+        void update(FrameInfo& frameInfo, const RenderList& renderList);
         void render(FrameInfo& frameInfo, Renderer& renderer);
 		void transitionImageToShaderReadOnlyOptimal(FrameInfo& frameInfo);
 
         void updateSceneImage(Shared<VulkanImage> sceneImage);
+        const PathTracingFeatures& getFeatures() const { return m_features; }
 
-        void resetPathTracingAccumulationFrameCount() { m_ptAccumulationFrameCount = 0; }
+        void resetPathTracingAccumulationFrameCount();
         uint32_t getAndIncrementPathTracingAccumulationFrameCount();
 
+        /**
+         * @brief Lets the accumulation spend its samples on the noisy pixels and stop when all converged.
+         *        The accumulation restarts when the state changes.
+         */
+        void setAdaptiveSamplingEnabled(bool enabled);
+        const ConvergenceStats& getConvergenceStats() const { return m_convergenceStats; }
+
     private:
 		void createDescriptorSets();
+		void createFeatureImages();
+		void createConvergenceBuffers();
+		void readConvergence(uint32_t frameIndex);
+		void updateStorageImageDescriptorSet();
+		void createSamplerDescriptorSet();
 		void defineShaderGroups();
         void createPipelineLayout(DescriptorSetLayout& setLayout);
         void createPipeline();
@@ -63,7 +99,26 @@ namespace PXTEngine {
         Shared<VulkanImage> m_sceneImage = nullptr;
 		VkDescriptorSet m_storageImageDescriptorSet = VK_NULL_HANDLE;
 		Unique<DescriptorSetLayout> m_storageImageDescriptorSetLayout = nullptr;
+		PathTracingFeatures m_features{};
+
+		// low discrepancy sampler: blue noise thresholds and Owen scrambled Sobol table
+		Shared<Texture2D> m_blueNoiseTexture = nullptr;
+		Unique<VulkanBuffer> m_sobolBuffer = nullptr;
+		VkDescriptorSet m_samplerDescriptorSet = VK_NULL_HANDLE;
+		Unique<DescriptorSetLayout> m_samplerDescriptorSetLayout = nullptr;
 
         uint32_t m_ptAccumulationFrameCount = 0;
+
+		// adaptive sampling: per pixel statistics, and a count of the pixels still sampled read back
+		// by every frame in flight. The epoch tells the counts of the current accumulation apart
+		Shared<VulkanImage> m_convergenceImage = nullptr;
+		Unique<VulkanBuffer> m_activePixelCountBuffer = nullptr;
+		std::array<Unique<VulkanBuffer>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_activePixelCountReadbacks{};
+		std::array<uint64_t, SwapChain::MAX_FRAMES_IN_FLIGHT> m_readbackEpochs{};
+		uint64_t m_accumulationEpoch = 1;
+		uint64_t m_sceneChangeGeneration = 0;
+		bool m_isAdaptiveSamplingEnabled = false;
+		std::chrono::high_resolution_clock::time_point m_accumulationStart = std::chrono::high_resolution_clock::now();
+		ConvergenceStats m_convergenceStats{};
     };
 }
\ No newline at end of file
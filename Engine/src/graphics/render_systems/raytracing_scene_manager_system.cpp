@@ -1,6 +1,7 @@
 #include "graphics/render_systems/raytracing_scene_manager_system.hpp"
 
 #include "scene/ecs/component.hpp"
+#include "utils/hash_func.hpp"
 
 namespace PXTEngine {
 	RayTracingSceneManagerSystem::RayTracingSceneManagerSystem(Context& context, MaterialRegistry& materialRegistry, 
@@ -9,245 +10,361 @@ namespace PXTEngine {
 		m_materialRegistry(materialRegistry),
 		m_blasRegistry(blasRegistry), 
 		m_descriptorAllocator(allocator) {
-		createTLASDescriptorSet();
-		createMeshInstanceDescriptorSet();
-		createEmittersDescriptorSet();
+		VkPhysicalDeviceAccelerationStructurePropertiesKHR accelStructProps{};
+		accelStructProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR;
+		VkPhysicalDeviceProperties2 deviceProps2{};
+		deviceProps2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		deviceProps2.pNext = &accelStructProps;
+		vkGetPhysicalDeviceProperties2(m_context.getPhysicalDevice(), &deviceProps2);
+
+		m_scratchAlignment = std::max<VkDeviceSize>(1, accelStructProps.minAccelerationStructureScratchOffsetAlignment);
+
+		createTLASDescriptorSets();
+		createMeshInstanceDescriptorSets();
+		createEmittersDescriptorSets();
 	}
 
 	RayTracingSceneManagerSystem::~RayTracingSceneManagerSystem() {
-		destroyTLAS();
+		for (auto& frameTlas : m_frameTLASes) {
+			destroyTLAS(frameTlas);
+		}
 	}
 
 
-	void RayTracingSceneManagerSystem::createTLAS(FrameInfo& frameInfo) {
+	void RayTracingSceneManagerSystem::buildTLAS(FrameInfo& frameInfo, const RenderList& renderList) {
+		PXT_PROFILE_FN();
+
+		FrameTLAS& frameTlas = m_frameTLASes[frameInfo.frameIndex];
+
+		gatherInstances(frameInfo.scene, renderList);
+
+		updateEmittersDescriptorSet(m_frameEmitters[frameInfo.frameIndex]);
+
+		const uint32_t instanceCount = m_changeTracker.getInstanceCount();
+
+		// the slots changed since this frame TLAS was last synced, the other frame may have seen some of them already
+		bool rebuild = !m_changeTracker.collectChangedSlots(frameTlas.syncedGeneration, m_changedSlots);
+
+		// the buffers of this frame are only recreated when the scene outgrows them
+		if (frameTlas.handle == VK_NULL_HANDLE || instanceCount > frameTlas.instanceCapacity) {
+			reserveTLAS(frameTlas, instanceCount);
+			rebuild = true;
+		}
+
+		frameTlas.syncedGeneration = m_changeTracker.getGeneration();
+
+		// the geometry arena was reallocated since this frame was last rendered
+		if (frameTlas.geometryGeneration != m_context.getGeometryArena().getGeneration()) {
+			updateMeshInstanceDescriptorSet(frameTlas);
+		}
+
+		// nothing moved, the TLAS built the last time this frame was rendered is still valid
+		if (!rebuild && m_changedSlots.empty()) {
+			return;
+		}
+
+		if (frameTlas.refitCount >= MAX_TLAS_REFITS) {
+			rebuild = true;
+		}
+
+		if (rebuild) {
+			m_changedSlots.resize(instanceCount);
+			std::iota(m_changedSlots.begin(), m_changedSlots.end(), 0);
+			frameTlas.refitCount = 0;
+		} else {
+			frameTlas.refitCount++;
+		}
+
+		// the previous use of this frame resources is over (the frame fence was waited for),
+		// host writes are made visible to the device by the queue submission
+		writeInstances(frameInfo.commandBuffer, frameTlas, m_changedSlots);
+
+		VkAccelerationStructureGeometryKHR TLASGeometry{};
+		TLASGeometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+		TLASGeometry.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR;
+		TLASGeometry.geometry.instances.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
+		TLASGeometry.geometry.instances.arrayOfPointers = VK_FALSE; // Instance data is tightly packed
+		TLASGeometry.geometry.instances.data.deviceAddress = frameTlas.instanceBuffer->getDeviceAddress();
+
+		// a refit updates the TLAS in place, it is only valid while the instances stay the same
+		VkAccelerationStructureBuildGeometryInfoKHR buildInfo{};
+		buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+		buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
+		buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+			VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+		buildInfo.mode = rebuild ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR : VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
+		buildInfo.geometryCount = 1;
+		buildInfo.pGeometries = &TLASGeometry;
+		buildInfo.srcAccelerationStructure = rebuild ? VK_NULL_HANDLE : frameTlas.handle;
+		buildInfo.dstAccelerationStructure = frameTlas.handle;
+		buildInfo.scratchData.deviceAddress = frameTlas.scratchAddress;
 
-		VkAccelerationStructureKHR newTlas = VK_NULL_HANDLE;
+		// Define the build range (how many instances to build)
+		VkAccelerationStructureBuildRangeInfoKHR buildRangeInfos{};
+		buildRangeInfos.primitiveCount = instanceCount;
+		buildRangeInfos.primitiveOffset = 0;
+		buildRangeInfos.firstVertex = 0;
+		buildRangeInfos.transformOffset = 0;
+		const VkAccelerationStructureBuildRangeInfoKHR* pBuildRangeInfos = &buildRangeInfos;
 
-		//  Create a acceleration structure instance vector 
-		std::vector<VkAccelerationStructureInstanceKHR> instances;
-	
-		//  Get all BLAS and components from entities that have transform & mesh components 
-		auto view = frameInfo.scene.getEntitiesWith<TransformComponent, MeshComponent, MaterialComponent>();
+		// Record the build in the frame command buffer, the frame waits for nothing
+		vkCmdBuildAccelerationStructuresKHR(
+			frameInfo.commandBuffer,
+			1,               // buildInfoCount
+			&buildInfo,      // pBuildInfo
+			&pBuildRangeInfos // ppBuildRangeInfos
+		);
 
-		int instanceIndex = 0;
-		for (auto entity : view) {
-			const auto& [transformComponent, meshComponent, materialComponent] = view.get<TransformComponent, MeshComponent, MaterialComponent>(entity);
-			
-			auto material = materialComponent.material;
-			auto mesh = meshComponent.mesh;
+		// the TLAS and the instance data must be written before vkCmdTraceRaysKHR reads them
+		VkMemoryBarrier memoryBarrier = {};
+		memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR | VK_ACCESS_TRANSFER_WRITE_BIT;
+		memoryBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_SHADER_READ_BIT;
 
-			Shared<BLAS> blas = m_blasRegistry.getOrCreateBLAS(mesh);
+		vkCmdPipelineBarrier(
+			frameInfo.commandBuffer,
+			VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_TRANSFER_BIT, // Source stage
+			VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,           // Destination stage
+			0, // Dependency flags
+			1, &memoryBarrier, // Memory barriers
+			0, nullptr, // Buffer memory barriers
+			0, nullptr  // Image memory barriers
+		);
+	}
 
-			VkAccelerationStructureDeviceAddressInfoKHR addressInfo{};
-			addressInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR;
-			addressInfo.accelerationStructure = blas->handle;
-			VkDeviceAddress blasAddress = blas->buffer->getDeviceAddress();
+	void RayTracingSceneManagerSystem::gatherInstances(Scene& scene, const RenderList& renderList) {
+		// the emitter tables are rebuilt when an emitter slot changes, or stops being one, and when instances are added or removed
+		bool emittersChanged = false;
 
-			// convert glm::mat4 to VkTransformMatrixKHR
-			VkTransformMatrixKHR transformMatrix = glmToVkTransformMatrix(transformComponent.mat4());
+		m_changeTracker.beginWalk();
 
-			// Define the instance
-			VkAccelerationStructureInstanceKHR instance{};
-			instance.transform = transformMatrix;
+		// the instances are the render list ones, in the same order, the slot of an instance is its index in the list
+		const std::span<const entt::entity> entities = renderList.getEntities();
+		const std::span<const glm::mat4> worldMatrices = renderList.getWorldMatrices();
+		const std::span<VulkanMesh* const> meshes = renderList.getMeshes();
+		const std::span<Material* const> materials = renderList.getMaterials();
+		const std::span<const uint32_t> materialIndices = renderList.getMaterialIndices();
+		const std::span<const glm::vec3> tints = renderList.getTints();
+		const std::span<const float> tilingFactors = renderList.getTilingFactors();
+		const std::span<const uint32_t> flags = renderList.getFlags();
 
-			auto vkMesh = static_pointer_cast<VulkanMesh>(mesh);
+		// only looked up for the changed slots and the emitters, which need the shared mesh or the inverse transform
+		auto meshView = scene.getEntitiesWith<MeshComponent>();
+		auto worldTransformView = scene.getEntitiesWith<WorldTransformComponent>();
 
-			MeshInstanceData meshInstanceData{};
-			meshInstanceData.vertexBufferAddress = vkMesh->getVertexBufferDeviceAddress();
-			meshInstanceData.indexBufferAddress = vkMesh->getIndexBufferDeviceAddress();
-			meshInstanceData.materialIndex = m_materialRegistry.getIndex(material->id);
-			meshInstanceData.textureTintColor = glm::vec4(materialComponent.tint, 1.0f);
-			meshInstanceData.textureTilingFactor = materialComponent.tilingFactor;
+		const uint32_t instanceCount = renderList.getInstanceCount();
+		m_instances.resize(instanceCount);
+		m_meshInstanceData.resize(instanceCount);
 
+		for (uint32_t instanceIndex = 0; instanceIndex < instanceCount; instanceIndex++) {
 			// TODO: may be passed as mat4x3 in the shader for memory bandwidth optimization
-			glm::mat4 transform = transformComponent.mat4();
+			const glm::mat4& transform = worldMatrices[instanceIndex];
+
+			// the ranges move when the geometry arena is compacted, the slots holding them are refreshed
+			const GeometryRange& geometryRange = meshes[instanceIndex]->getGeometryRange();
+
+			// a different mesh, or the mesh moving in the arena, means the slot holds a different instance
+			std::size_t geometry = 0;
+			hashCombine(geometry, meshes[instanceIndex], geometryRange.firstVertex, geometryRange.firstIndex);
+
+			// the rest of the instance data only needs its slot rewritten
+			std::size_t content = 0;
+			hashCombine(content, materialIndices[instanceIndex], tints[instanceIndex], tilingFactors[instanceIndex]);
+
+			const entt::entity entity = entities[instanceIndex];
 
-			meshInstanceData.objectToWorldMatrix = transform;
-			meshInstanceData.worldToObjectMatrix = glm::inverse(transform);
+			if (m_changeTracker.track(entt::to_integral(entity), transform, geometry, content)) {
+				const bool wasEmitter = instanceIndex < m_emitterSlots.size() && m_emitterSlots[instanceIndex];
+				emittersChanged |= wasEmitter || (flags[instanceIndex] & RenderList::FLAG_EMISSIVE);
 
-			m_meshInstanceData.push_back(meshInstanceData);
+				Shared<BLAS> blas = m_blasRegistry.getOrCreateBLAS(meshView.get<MeshComponent>(entity).mesh);
 
-			// register entities with emissive materials
-			if (materialComponent.material->isEmissive()) {
-				EmitterData emitterData{};
-				emitterData.instanceIndex = instanceIndex;
-				emitterData.numberOfFaces = vkMesh->getIndexCount() / 3; 
-				m_emitters.push_back(emitterData);
+				VkDeviceAddress blasAddress = blas->buffer->getDeviceAddress();
+
+				// Define the instance
+				VkAccelerationStructureInstanceKHR& instance = m_instances[instanceIndex];
+				instance = {};
+				instance.transform = glmToVkTransformMatrix(transform);
+
+				// we can get it in the shader via InstanceCustomIndexKHR
+				instance.instanceCustomIndex = instanceIndex; // Unique index for each instance
+
+				instance.mask = 0xFF; // Visible to all rays initially
+				instance.instanceShaderBindingTableRecordOffset = 0; // this is 0 for every instance for now
+				                                                     // it is the offset in the SBT hit region
+				                                                     // (which hit shader the instance should use)
+				instance.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR; // Example flags
+				instance.accelerationStructureReference = blasAddress;
+
+				MeshInstanceData& meshInstanceData = m_meshInstanceData[instanceIndex];
+				meshInstanceData = {};
+				meshInstanceData.firstVertex = geometryRange.firstVertex;
+				meshInstanceData.firstIndex = geometryRange.firstIndex;
+				meshInstanceData.materialIndex = materialIndices[instanceIndex];
+				meshInstanceData.textureTintColor = glm::vec4(tints[instanceIndex], 1.0f);
+				meshInstanceData.textureTilingFactor = tilingFactors[instanceIndex];
+
+				meshInstanceData.objectToWorldMatrix = transform;
+				meshInstanceData.worldToObjectMatrix = worldTransformView.get<WorldTransformComponent>(entity).inverse;
 			}
+		}
+
+		m_changeTracker.endWalk();
 
+		// the slots of the emitters shift when instances are added or removed
+		if (m_changeTracker.getStructureGeneration() != m_emittersStructureGeneration) {
+			m_emittersStructureGeneration = m_changeTracker.getStructureGeneration();
+			emittersChanged = true;
+		}
 
-			// we can get it in the shader via InstanceCustomIndexKHR
-			instance.instanceCustomIndex = instanceIndex++; // Unique index for each instance
+		if (!emittersChanged) {
+			return;
+		}
 
+		// register entities with emissive materials
+		m_emitterTables.clear();
+		m_emitterSlots.assign(instanceCount, false);
 
-			instance.mask = 0xFF; // Visible to all rays initially
-			instance.instanceShaderBindingTableRecordOffset = 0; // this is 0 for every instance for now
-			                                                     // it is the offset in the SBT hit region
-			                                                     // (which hit shader the instance should use)
-			instance.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR; // Example flags
-			instance.accelerationStructureReference = blasAddress;
+		for (uint32_t instanceIndex = 0; instanceIndex < instanceCount; instanceIndex++) {
+			if (!(flags[instanceIndex] & RenderList::FLAG_EMISSIVE)) {
+				continue;
+			}
 
-			instances.push_back(instance);
+			m_emitterTables.addEmitter(instanceIndex, getFaceAreaVectors(meshView.get<MeshComponent>(entities[instanceIndex]).mesh),
+				worldMatrices[instanceIndex], materials[instanceIndex]->getEmissiveColor());
+			m_emitterSlots[instanceIndex] = true;
 		}
 
-		//TODO: maybe move from here?
-		updateMeshInstanceDescriptorSet();
-		updateEmittersDescriptorSet();
+		m_emitterTables.build();
+		m_emittersGeneration++;
+	}
 
-		// Upload Instance Data 
-		uint32_t instanceCount = static_cast<uint32_t>(instances.size());
-		VkDeviceSize instanceDataSize = sizeof(VkAccelerationStructureInstanceKHR) * instanceCount;
-		Unique<VulkanBuffer> instanceBuffer;
-		Unique<VulkanBuffer> stagingBuffer;
+	void RayTracingSceneManagerSystem::writeInstances(VkCommandBuffer commandBuffer, FrameTLAS& frameTlas,
+		std::span<const uint32_t> slots) {
+		m_meshInstanceCopies.clear();
 
-		// Create staging buffer
-		stagingBuffer = createUnique<VulkanBuffer>(
-			m_context,
-			sizeof(VkAccelerationStructureInstanceKHR),
-			instanceCount,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		for (const uint32_t slot : slots) {
+			frameTlas.instanceBuffer->writeToBuffer(&m_instances[slot],
+				sizeof(VkAccelerationStructureInstanceKHR), sizeof(VkAccelerationStructureInstanceKHR) * slot);
+
+			const VkDeviceSize offset = sizeof(MeshInstanceData) * slot;
+			frameTlas.meshInstanceStagingBuffer->writeToBuffer(&m_meshInstanceData[slot], sizeof(MeshInstanceData), offset);
+
+			// slots come in increasing order, consecutive ones are merged in a single region
+			if (!m_meshInstanceCopies.empty() &&
+				m_meshInstanceCopies.back().srcOffset + m_meshInstanceCopies.back().size == offset) {
+				m_meshInstanceCopies.back().size += sizeof(MeshInstanceData);
+			} else {
+				m_meshInstanceCopies.push_back({ offset, offset, sizeof(MeshInstanceData) });
+			}
+		}
+
+		if (m_meshInstanceCopies.empty()) {
+			return;
+		}
+
+		vkCmdCopyBuffer(
+			commandBuffer,
+			frameTlas.meshInstanceStagingBuffer->getBuffer(),
+			frameTlas.meshInstanceBuffer->getBuffer(),
+			static_cast<uint32_t>(m_meshInstanceCopies.size()),
+			m_meshInstanceCopies.data()
 		);
+	}
 
-		stagingBuffer->map();
-		stagingBuffer->writeToBuffer((void*)instances.data());
+	void RayTracingSceneManagerSystem::reserveTLAS(FrameTLAS& frameTlas, const uint32_t instanceCount) {
+		// grow geometrically so that a slowly growing scene doesn't recreate the TLAS every frame
+		const uint32_t capacity = std::max({ instanceCount, frameTlas.instanceCapacity * 2, 16u });
 
-		// Create instance buffer on GPU
-		instanceBuffer = createUnique<VulkanBuffer>(
+		destroyTLAS(frameTlas);
+
+		frameTlas.instanceBuffer = createUnique<VulkanBuffer>(
 			m_context,
 			sizeof(VkAccelerationStructureInstanceKHR),
-			instanceCount,
-			VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+			capacity,
 			VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
 			VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
 		);
+		frameTlas.instanceBuffer->map();
+		frameTlas.instanceCapacity = capacity;
 
-		// Copy instance data to GPU
-		m_context.copyBuffer(stagingBuffer->getBuffer(), instanceBuffer->getBuffer(), instanceDataSize);
+		frameTlas.meshInstanceStagingBuffer = createUnique<VulkanBuffer>(
+			m_context,
+			sizeof(MeshInstanceData),
+			capacity,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		);
+		frameTlas.meshInstanceStagingBuffer->map();
 
-		// Query Build Sizes
-		VkDeviceAddress instanceBufferAddr = instanceBuffer->getDeviceAddress();
-		
-		VkAccelerationStructureGeometryInstancesDataKHR instancesGeometryData{};
-		instancesGeometryData.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
-		instancesGeometryData.arrayOfPointers = VK_FALSE; // Instance data is tightly packed
-		instancesGeometryData.data.deviceAddress = instanceBufferAddr;
+		frameTlas.meshInstanceBuffer = createUnique<VulkanBuffer>(
+			m_context,
+			sizeof(MeshInstanceData),
+			capacity,
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+		);
 
 		VkAccelerationStructureGeometryKHR TLASGeometry{};
 		TLASGeometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
 		TLASGeometry.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR;
-		TLASGeometry.geometry.instances = instancesGeometryData;
-		// Flags like VK_GEOMETRY_OPAQUE_BIT_KHR could be set here if needed
+		TLASGeometry.geometry.instances.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
+		TLASGeometry.geometry.instances.arrayOfPointers = VK_FALSE;
 
 		VkAccelerationStructureBuildGeometryInfoKHR buildInfo{};
 		buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
 		buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
-		buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR; // Or other flags
+		buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+			VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
 		buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
 		buildInfo.geometryCount = 1;
 		buildInfo.pGeometries = &TLASGeometry;
 
-		uint32_t numInstances = static_cast<uint32_t>(instances.size());
-		VkAccelerationStructureBuildSizesInfoKHR m_buildSizeInfo{};
-		m_buildSizeInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+		// sizes for the capacity are enough for any build with fewer instances
+		VkAccelerationStructureBuildSizesInfoKHR buildSizeInfo{};
+		buildSizeInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
 		vkGetAccelerationStructureBuildSizesKHR(
 			m_context.getDevice(),
 			VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
 			&buildInfo,
-			&numInstances, // Pointer to the number of primitives (instances)
-			&m_buildSizeInfo);
+			&capacity,
+			&buildSizeInfo);
 
-
-		// 4. Allocate BLAS Buffer and Scratch Buffer
-		m_tlasBuffer = createUnique<VulkanBuffer>(
+		frameTlas.buffer = createUnique<VulkanBuffer>(
 			m_context, 
-			m_buildSizeInfo.accelerationStructureSize,
+			buildSizeInfo.accelerationStructureSize,
 			1,
 			VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
 		);
 
-		Unique<VulkanBuffer> scratchBuffer = createUnique<VulkanBuffer>(
+		// the same scratch serves builds and refits, buffers are sub-allocated so its address is aligned by hand
+		frameTlas.scratchBuffer = createUnique<VulkanBuffer>(
 			m_context,
-			m_buildSizeInfo.buildScratchSize,
+			std::max(buildSizeInfo.buildScratchSize, buildSizeInfo.updateScratchSize) + m_scratchAlignment,
 			1,
 			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
 		);
 
-		VkDeviceAddress scratchBufferAddr = scratchBuffer->getDeviceAddress();
+		const VkDeviceAddress scratchAddress = frameTlas.scratchBuffer->getDeviceAddress();
+		frameTlas.scratchAddress = (scratchAddress + m_scratchAlignment - 1) / m_scratchAlignment * m_scratchAlignment;
 
-		//  5. Create TLAS Object 
-		VkAccelerationStructureCreateInfoKHR m_createInfo{};
-		m_createInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
-		m_createInfo.buffer = m_tlasBuffer->getBuffer();
-		m_createInfo.offset = 0;
-		m_createInfo.size = m_buildSizeInfo.accelerationStructureSize;
-		m_createInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
-		// createInfo.deviceAddress = // Optional: if using buffer device address capture/replay
+		VkAccelerationStructureCreateInfoKHR createInfo{};
+		createInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+		createInfo.buffer = frameTlas.buffer->getBuffer();
+		createInfo.offset = 0;
+		createInfo.size = buildSizeInfo.accelerationStructureSize;
+		createInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
 
-		if (vkCreateAccelerationStructureKHR(m_context.getDevice(), &m_createInfo, nullptr, &newTlas) != VK_SUCCESS) {
+		if (vkCreateAccelerationStructureKHR(m_context.getDevice(), &createInfo, nullptr, &frameTlas.handle) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create top-level acceleration structure!");
 		}
 
-		//  6. Build TLAS Command 
-		VkCommandBuffer commandBuffer = m_context.beginSingleTimeCommands();
-
-		// Update build info with destination and scratch
-		buildInfo.dstAccelerationStructure = newTlas;
-		buildInfo.scratchData.deviceAddress = scratchBufferAddr;
-
-		// Define the build range (how many instances to build)
-		VkAccelerationStructureBuildRangeInfoKHR buildRangeInfos{};
-		buildRangeInfos.primitiveCount = numInstances;
-		buildRangeInfos.primitiveOffset = 0;
-		buildRangeInfos.firstVertex = 0;
-		buildRangeInfos.transformOffset = 0;
-		const VkAccelerationStructureBuildRangeInfoKHR* pBuildRangeInfos = &buildRangeInfos;
-
-		// Record the build command
-		vkCmdBuildAccelerationStructuresKHR(
-			commandBuffer,
-			1,               // buildInfoCount
-			&buildInfo,      // pBuildInfo
-			&pBuildRangeInfos // ppBuildRangeInfos
-		);
-
-		// Add a barrier to ensure BLAS builds are complete and instance buffer write is complete
-		VkMemoryBarrier memoryBarrier = {};
-		memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-		memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR; // Instance buffer copy + BLAS builds
-		memoryBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR; // TLAS build reads instance buffer & BLASes
-
-		vkCmdPipelineBarrier(
-			commandBuffer,
-			VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, // Source stages
-			VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,                                 // Destination stage
-			0, // Dependency flags
-			1, &memoryBarrier, // Memory barriers
-			0, nullptr, // Buffer memory barriers
-			0, nullptr  // Image memory barriers
-		);
-
-		m_context.endSingleTimeCommands(commandBuffer); // Submits and waits
-
-		//  Cleanup 
-		// Destroy the scratch buffer (it's only needed during build) and other buffers like
-		// instance buffer or staging buffer. we can potentially keep the instance buffer for reuse.
-		// Buffers will be deleted after end of this function cause they are Unique.
-
-		// Update descriptor set for TLAS
-		updateTLASDescriptorSet(newTlas);
-
-		// Then destroy old one and assign the new one
-		destroyTLAS();
-
-		// If not done in this order it will give a validation error
-		// because the TLAS is still in use by the descriptor when we destroy it.
-		// TODO: add a list of SWAPCHAIN::MAX_FRAMES_IN_FLIGHT tlases with their descriptor sets
-
-		m_tlas = newTlas;
+		// the descriptor sets of this frame aren't in use, they can point to the new buffers right away
+		updateTLASDescriptorSet(frameTlas);
+		updateMeshInstanceDescriptorSet(frameTlas);
 	}
 
 	VkTransformMatrixKHR RayTracingSceneManagerSystem::glmToVkTransformMatrix(const glm::mat4& glmMatrix) {
@@ -269,127 +386,173 @@ namespace PXTEngine {
 		return vkMatrix;
 	}
 
-	void RayTracingSceneManagerSystem::createTLASDescriptorSet() {
+	void RayTracingSceneManagerSystem::createTLASDescriptorSets() {
 		// TLAS DESCRIPTOR SET LAYOUT
 		// needed for raytracing pipeline layout
 		m_tlasDescriptorSetLayout = DescriptorSetLayout::Builder(m_context)
 			.addBinding(0, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR)
 			.build();
 
-		m_descriptorAllocator->allocate(m_tlasDescriptorSetLayout->getDescriptorSetLayout(), m_tlasDescriptorSet);
+		// one per frame in flight, each one points to the TLAS of its frame
+		for (auto& frameTlas : m_frameTLASes) {
+			m_descriptorAllocator->allocate(m_tlasDescriptorSetLayout->getDescriptorSetLayout(), frameTlas.descriptorSet);
+		}
 	}
 
-	void RayTracingSceneManagerSystem::updateTLASDescriptorSet(VkAccelerationStructureKHR& newTlas) {
+	void RayTracingSceneManagerSystem::updateTLASDescriptorSet(FrameTLAS& frameTlas) {
 		VkWriteDescriptorSetAccelerationStructureKHR tlasInfo{};
 		tlasInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
 		tlasInfo.accelerationStructureCount = 1;
-		tlasInfo.pAccelerationStructures = &newTlas;
+		tlasInfo.pAccelerationStructures = &frameTlas.handle;
 
 		DescriptorWriter(m_context, *m_tlasDescriptorSetLayout)
 			.writeTLAS(0, tlasInfo)
-			.updateSet(m_tlasDescriptorSet);
+			.updateSet(frameTlas.descriptorSet);
 	}
 
-	void RayTracingSceneManagerSystem::destroyTLAS() {
-		if (m_tlas != VK_NULL_HANDLE) {
-			vkDestroyAccelerationStructureKHR(m_context.getDevice(), m_tlas, nullptr);
-			m_tlas = VK_NULL_HANDLE;
+	void RayTracingSceneManagerSystem::destroyTLAS(FrameTLAS& frameTlas) {
+		if (frameTlas.handle != VK_NULL_HANDLE) {
+			vkDestroyAccelerationStructureKHR(m_context.getDevice(), frameTlas.handle, nullptr);
+			frameTlas.handle = VK_NULL_HANDLE;
 		}
+
+		frameTlas.buffer = nullptr;
+		frameTlas.scratchBuffer = nullptr;
+		frameTlas.scratchAddress = 0;
+		frameTlas.instanceBuffer = nullptr;
+		frameTlas.meshInstanceBuffer = nullptr;
+		frameTlas.meshInstanceStagingBuffer = nullptr;
 	}
 
 
-	void RayTracingSceneManagerSystem::createMeshInstanceDescriptorSet() {
+	void RayTracingSceneManagerSystem::createMeshInstanceDescriptorSets() {
 		m_meshInstanceDescriptorSetLayout = DescriptorSetLayout::Builder(m_context)
 			.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, 1)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, 1) // arena vertices
+			.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, 1) // arena indices
 			.build();
 
-		m_descriptorAllocator->allocate(
-			m_meshInstanceDescriptorSetLayout->getDescriptorSetLayout(),
-			m_meshInstanceDescriptorSet
-		);
+		// one per frame in flight, each one points to the instance data of its frame
+		for (auto& frameTlas : m_frameTLASes) {
+			m_descriptorAllocator->allocate(
+				m_meshInstanceDescriptorSetLayout->getDescriptorSetLayout(),
+				frameTlas.meshInstanceDescriptorSet
+			);
+		}
 	}
 
-	void RayTracingSceneManagerSystem::updateMeshInstanceDescriptorSet() {
-		if (m_meshInstanceBuffer != nullptr) {
-			return;
-		}
+	void RayTracingSceneManagerSystem::updateMeshInstanceDescriptorSet(FrameTLAS& frameTlas) {
+		const GeometryArena& geometryArena = m_context.getGeometryArena();
 
-		VkDeviceSize bufferSize = sizeof(MeshInstanceData) * m_meshInstanceData.size();
+		auto bufferInfo = frameTlas.meshInstanceBuffer->descriptorInfo();
+		auto vertexBufferInfo = geometryArena.getVertexDescriptorInfo();
+		auto indexBufferInfo = geometryArena.getIndexDescriptorInfo();
 
-		Unique<VulkanBuffer> stagingBuffer = createUnique<VulkanBuffer>(
-			m_context,
-			bufferSize,
-			1,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-		);
-		stagingBuffer->map();
-		stagingBuffer->writeToBuffer(m_meshInstanceData.data(), bufferSize);
-		stagingBuffer->unmap();
+		DescriptorWriter(m_context, *m_meshInstanceDescriptorSetLayout)
+			.writeBuffer(0, &bufferInfo)
+			.writeBuffer(1, &vertexBufferInfo)
+			.writeBuffer(2, &indexBufferInfo)
+			.updateSet(frameTlas.meshInstanceDescriptorSet);
 
-		m_meshInstanceBuffer = createUnique<VulkanBuffer>(
-			m_context,
-			bufferSize,
-			1,
-			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-		);
+		frameTlas.geometryGeneration = geometryArena.getGeneration();
+	}
 
-		m_context.copyBuffer(stagingBuffer->getBuffer(), m_meshInstanceBuffer->getBuffer(), bufferSize);
+	const std::vector<glm::vec3>& RayTracingSceneManagerSystem::getFaceAreaVectors(const Shared<Mesh>& mesh) {
+		auto it = m_faceAreaVectors.find(mesh->id);
+		if (it != m_faceAreaVectors.end()) {
+			return it->second;
+		}
 
-		auto bufferInfo = m_meshInstanceBuffer->descriptorInfo();
+		// only emitter meshes are read back, and only once
+		std::vector<Mesh::Vertex> vertices;
+		std::vector<uint32_t> indices;
+		std::static_pointer_cast<VulkanMesh>(mesh)->readGeometry(vertices, indices);
 
-		DescriptorWriter(m_context, *m_meshInstanceDescriptorSetLayout)
-			.writeBuffer(0, &bufferInfo)
-			.updateSet(m_meshInstanceDescriptorSet);
+		std::vector<glm::vec3>& areaVectors = m_faceAreaVectors[mesh->id];
+		EmitterTableBuilder::calculateFaceAreaVectors(vertices, indices, areaVectors);
+
+		return areaVectors;
 	}
 
-	void RayTracingSceneManagerSystem::createEmittersDescriptorSet() {
+	void RayTracingSceneManagerSystem::createEmittersDescriptorSets() {
 		m_emittersDescriptorSetLayout = DescriptorSetLayout::Builder(m_context)
-			.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, 1)
+			// the miss shader reads the emitter count to weight the sky against its explicit samples
+			.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR, 1)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, 1)
 			.build();
-		m_descriptorAllocator->allocate(
-			m_emittersDescriptorSetLayout->getDescriptorSetLayout(),
-			m_emittersDescriptorSet
-		);
+
+		for (FrameEmitters& frameEmitters : m_frameEmitters) {
+			m_descriptorAllocator->allocate(
+				m_emittersDescriptorSetLayout->getDescriptorSetLayout(),
+				frameEmitters.descriptorSet
+			);
+		}
 	}
 
-	void RayTracingSceneManagerSystem::updateEmittersDescriptorSet() {
-		if (m_emittersBuffer != nullptr) {
+	void RayTracingSceneManagerSystem::updateEmittersDescriptorSet(FrameEmitters& frameEmitters) {
+		// the buffers of a frame are only written when the frame is no longer in use
+		if (frameEmitters.generation == m_emittersGeneration) {
 			return;
 		}
 
-		uint32_t emitterCount = static_cast<uint32_t>(m_emitters.size());
+		const std::vector<EmitterData>& emitters = m_emitterTables.getEmitters();
+		const std::vector<AliasTableEntry>& faceTable = m_emitterTables.getFaceTable();
+
+		uint32_t emitterCount = static_cast<uint32_t>(emitters.size());
 
 		VkDeviceSize emitterDataSize = sizeof(EmitterData) * emitterCount;
 		VkDeviceSize bufferSize = emitterDataSize + sizeof(emitterCount);
 
-		Unique<VulkanBuffer> stagingBuffer = createUnique<VulkanBuffer>(
-			m_context,
-			bufferSize,
-			1,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-		);
-		stagingBuffer->map();
-		stagingBuffer->writeToBuffer((void*) &emitterCount, sizeof(emitterCount));
-		stagingBuffer->writeToBuffer(m_emitters.data(), emitterDataSize, sizeof(emitterCount));
-		stagingBuffer->unmap();
+		// a storage buffer can't be empty, a scene without emitters still gets an entry
+		const VkDeviceSize faceTableSize = sizeof(AliasTableEntry) * faceTable.size();
+		const VkDeviceSize facesBufferSize = std::max<VkDeviceSize>(faceTableSize, sizeof(AliasTableEntry));
+
+		// the buffers are recreated when they are too small or much larger than needed
+		const auto needsResize = [](const Unique<VulkanBuffer>& buffer, const VkDeviceSize size) {
+			return buffer == nullptr || buffer->getBufferSize() < size || buffer->getBufferSize() > 4 * size;
+		};
+
+		const bool resized = needsResize(frameEmitters.buffer, bufferSize) || needsResize(frameEmitters.facesBuffer, facesBufferSize);
+
+		if (needsResize(frameEmitters.buffer, bufferSize)) {
+			frameEmitters.buffer = createUnique<VulkanBuffer>(
+				m_context,
+				bufferSize,
+				1,
+				VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			);
+		}
 
-		m_emittersBuffer = createUnique<VulkanBuffer>(
-			m_context,
-			bufferSize,
-			1,
-			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-		);
+		if (needsResize(frameEmitters.facesBuffer, facesBufferSize)) {
+			frameEmitters.facesBuffer = createUnique<VulkanBuffer>(
+				m_context,
+				facesBufferSize,
+				1,
+				VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			);
+		}
 
-		m_context.copyBuffer(stagingBuffer->getBuffer(), m_emittersBuffer->getBuffer(), bufferSize);
+		// all the copies end up in the same upload batch
+		m_context.getUploader().copyToBuffer(frameEmitters.buffer->getBuffer(), &emitterCount, sizeof(emitterCount));
+		if (emitterDataSize > 0) {
+			m_context.getUploader().copyToBuffer(frameEmitters.buffer->getBuffer(), emitters.data(), emitterDataSize, sizeof(emitterCount));
+		}
+		if (faceTableSize > 0) {
+			m_context.getUploader().copyToBuffer(frameEmitters.facesBuffer->getBuffer(), faceTable.data(), faceTableSize);
+		}
 
-		auto bufferInfo = m_emittersBuffer->descriptorInfo();
+		if (resized) {
+			auto bufferInfo = frameEmitters.buffer->descriptorInfo();
+			auto facesBufferInfo = frameEmitters.facesBuffer->descriptorInfo();
 
-		DescriptorWriter(m_context, *m_emittersDescriptorSetLayout)
-			.writeBuffer(0, &bufferInfo)
-			.updateSet(m_emittersDescriptorSet);
+			DescriptorWriter(m_context, *m_emittersDescriptorSetLayout)
+				.writeBuffer(0, &bufferInfo)
+				.writeBuffer(1, &facesBufferInfo)
+				.updateSet(frameEmitters.descriptorSet);
+		}
+
+		frameEmitters.generation = m_emittersGeneration;
 	}
-}
\ No newline at end of file
+}
@@ -3,25 +3,23 @@
 #include "core/pch.hpp"
 #include "graphics/resources/material_registry.hpp"
 #include "graphics/resources/blas_registry.hpp"
+#include "graphics/resources/tlas_change_tracker.hpp"
+#include "graphics/resources/emitter_tables.hpp"
 #include "graphics/resources/vk_buffer.hpp"
+#include "graphics/swap_chain.hpp"
 #include "graphics/frame_info.hpp"
+#include "graphics/render_list.hpp"
 #include "graphics/descriptors/descriptors.hpp"
 
 namespace PXTEngine {
 	struct alignas(16) MeshInstanceData {
-		VkDeviceAddress vertexBufferAddress;		// offset 0, size 8
-		VkDeviceAddress indexBufferAddress;			// offset 8, size 8
-		uint32_t materialIndex;						// offset 16, size 4
-		float textureTilingFactor;					// offset 20, size 4
-													// offset 24 -> 8 bit padding 
-		alignas(16) glm::vec4 textureTintColor;		// offset 32, size 16
-		alignas(16) glm::mat4 objectToWorldMatrix;				// offset 48, size 64 (4x4 matrix, 16 bytes per row)
-		alignas(16) glm::mat4 worldToObjectMatrix;				// offset 112, size 64 (4x4 matrix, 16 bytes per row)
-	};
-
-	struct alignas(uint32_t) EmitterData {
-		uint32_t instanceIndex;
-		uint32_t numberOfFaces;
+		uint32_t firstVertex;						// offset 0, size 4 (in the geometry arena vertex buffer)
+		uint32_t firstIndex;						// offset 4, size 4 (in the geometry arena index buffer)
+		uint32_t materialIndex;						// offset 8, size 4
+		float textureTilingFactor;					// offset 12, size 4
+		alignas(16) glm::vec4 textureTintColor;		// offset 16, size 16
+		alignas(16) glm::mat4 objectToWorldMatrix;				// offset 32, size 64 (4x4 matrix, 16 bytes per row)
+		alignas(16) glm::mat4 worldToObjectMatrix;				// offset 96, size 64 (4x4 matrix, 16 bytes per row)
 	};
 
 	class RayTracingSceneManagerSystem {
@@ -34,50 +32,145 @@ namespace PXTEngine {
 		RayTracingSceneManagerSystem(const RayTracingSceneManagerSystem&) = delete;
 		RayTracingSceneManagerSystem& operator=(const RayTracingSceneManagerSystem&) = delete;
 
-		void createTLAS(FrameInfo& frameInfo);
-		void updateTLAS() {} // to implement later
-		VkDescriptorSet getTLASDescriptorSet() const { return m_tlasDescriptorSet; }
+		/**
+		 * @brief Brings the frame TLAS up to date with the scene, recording the work in the frame command buffer.
+		 *
+		 * Every frame in flight has its own TLAS, with persistent grow-only buffers, so the build
+		 * never waits for the GPU and never touches a TLAS still used by the other frame.
+		 *
+		 * Only the instances changed since the frame TLAS was last synced are rewritten. When just
+		 * transforms changed the TLAS is refit, it is rebuilt from scratch when instances were added,
+		 * removed or replaced and every MAX_TLAS_REFITS refits, since refits degrade its quality.
+		 * The work is followed by a barrier that makes the TLAS visible to the ray tracing shaders.
+		 */
+		void buildTLAS(FrameInfo& frameInfo, const RenderList& renderList);
+		VkDescriptorSet getTLASDescriptorSet(int frameIndex) const { return m_frameTLASes[frameIndex].descriptorSet; }
 		VkDescriptorSetLayout getTLASDescriptorSetLayout() const { return m_tlasDescriptorSetLayout->getDescriptorSetLayout(); }
 
-		VkDescriptorSet getMeshInstanceDescriptorSet() const { return m_meshInstanceDescriptorSet; }
+		VkDescriptorSet getMeshInstanceDescriptorSet(int frameIndex) const { return m_frameTLASes[frameIndex].meshInstanceDescriptorSet; }
 		VkDescriptorSetLayout getMeshInstanceDescriptorSetLayout() const { return m_meshInstanceDescriptorSetLayout->getDescriptorSetLayout(); }
 
-		VkDescriptorSet getEmittersDescriptorSet() const { return m_emittersDescriptorSet; }
+		/**
+		 * @brief Changes whenever an instance is added, removed, replaced or moved.
+		 */
+		uint64_t getSceneChangeGeneration() const { return m_changeTracker.getLastChangeGeneration(); }
+
+		VkDescriptorSet getEmittersDescriptorSet(int frameIndex) const { return m_frameEmitters[frameIndex].descriptorSet; }
 		VkDescriptorSetLayout getEmittersDescriptorSetLayout() const { return m_emittersDescriptorSetLayout->getDescriptorSetLayout(); }
 	private:
-		void destroyTLAS();
+		// refits in a row after which the TLAS is rebuilt anyway
+		static constexpr uint32_t MAX_TLAS_REFITS = 64;
+
+		/**
+		 * @struct FrameTLAS
+		 *
+		 * @brief The TLAS of a frame in flight with the buffers used to build it and the instance data read by the shaders.
+		 */
+		struct FrameTLAS {
+			VkAccelerationStructureKHR handle = VK_NULL_HANDLE;
+			Unique<VulkanBuffer> buffer = nullptr;
+			Unique<VulkanBuffer> scratchBuffer = nullptr;
+			VkDeviceAddress scratchAddress = 0;
+
+			// host visible and persistently mapped, the instances are written straight into it
+			Unique<VulkanBuffer> instanceBuffer = nullptr;
+			uint32_t instanceCapacity = 0;
+
+			// device local, the changed entries are copied from the mapped staging buffer in the frame command buffer
+			Unique<VulkanBuffer> meshInstanceBuffer = nullptr;
+			Unique<VulkanBuffer> meshInstanceStagingBuffer = nullptr;
+
+			// generation of the change tracker the instances were last written at
+			uint64_t syncedGeneration = 0;
+			uint32_t refitCount = 0;
+
+			VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+			VkDescriptorSet meshInstanceDescriptorSet = VK_NULL_HANDLE;
+
+			// generation of the geometry arena the mesh instance set points to
+			uint64_t geometryGeneration = 0;
+		};
+
+		/**
+		 * @struct FrameEmitters
+		 *
+		 * @brief The emitter tables of a frame in flight, rewritten when the emitters changed since they were last written.
+		 */
+		struct FrameEmitters {
+			Unique<VulkanBuffer> buffer = nullptr;
+			Unique<VulkanBuffer> facesBuffer = nullptr;
+			VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+
+			// generation of the emitter tables written in the buffers, 0 before the first write
+			uint64_t generation = 0;
+		};
+
+		/**
+		 * @brief Walks the render list, refreshing the instances whose slot changed since the previous walk.
+		 *
+		 * The emitter tables are rebuilt when instances were added or removed, or when a changed slot
+		 * holds an emitter or held one.
+		 */
+		void gatherInstances(Scene& scene, const RenderList& renderList);
+
+		/**
+		 * @brief Writes the given instance slots of a frame and records the copy of their instance data.
+		 */
+		void writeInstances(VkCommandBuffer commandBuffer, FrameTLAS& frameTlas, std::span<const uint32_t> slots);
+
+		/**
+		 * @brief Recreates the buffers and the TLAS of a frame so that they can hold instanceCount instances.
+		 */
+		void reserveTLAS(FrameTLAS& frameTlas, uint32_t instanceCount);
+		void destroyTLAS(FrameTLAS& frameTlas);
 		VkTransformMatrixKHR glmToVkTransformMatrix(const glm::mat4& glmMatrix);
 
-		void createTLASDescriptorSet();
-		void updateTLASDescriptorSet(VkAccelerationStructureKHR& newTlas);
+		void createTLASDescriptorSets();
+		void updateTLASDescriptorSet(FrameTLAS& frameTlas);
 
-		void createMeshInstanceDescriptorSet();
-		void updateMeshInstanceDescriptorSet();
+		void createMeshInstanceDescriptorSets();
+		void updateMeshInstanceDescriptorSet(FrameTLAS& frameTlas);
 
-		void createEmittersDescriptorSet();
-		void updateEmittersDescriptorSet();
+		/**
+		 * @brief Returns the face area vectors of an emitter mesh, reading its geometry back the first time.
+		 */
+		const std::vector<glm::vec3>& getFaceAreaVectors(const Shared<Mesh>& mesh);
+
+		void createEmittersDescriptorSets();
+		void updateEmittersDescriptorSet(FrameEmitters& frameEmitters);
 
 		Context& m_context;
 		MaterialRegistry& m_materialRegistry;
 		BLASRegistry& m_blasRegistry;
 
-		VkAccelerationStructureKHR m_tlas = VK_NULL_HANDLE;
-		Unique<VulkanBuffer> m_tlasBuffer;
-		VkAccelerationStructureBuildSizesInfoKHR m_buildSizeInfo{};
-		VkAccelerationStructureCreateInfoKHR m_createInfo{};
+		std::array<FrameTLAS, SwapChain::MAX_FRAMES_IN_FLIGHT> m_frameTLASes;
+		VkDeviceSize m_scratchAlignment = 1;
+
+		// the instances of every slot, refreshed only for the slots that changed
+		TLASChangeTracker m_changeTracker;
+		std::vector<VkAccelerationStructureInstanceKHR> m_instances;
+		std::vector<MeshInstanceData> m_meshInstanceData;
+
+		// reused every frame to avoid reallocating
+		std::vector<uint32_t> m_changedSlots;
+		std::vector<VkBufferCopy> m_meshInstanceCopies;
 
 		Shared<DescriptorAllocatorGrowable> m_descriptorAllocator;
 		Shared<DescriptorSetLayout> m_tlasDescriptorSetLayout = nullptr;
-		VkDescriptorSet m_tlasDescriptorSet = VK_NULL_HANDLE;
 
-		std::vector<MeshInstanceData> m_meshInstanceData;
 		Shared<DescriptorSetLayout> m_meshInstanceDescriptorSetLayout = nullptr;
-		Unique<VulkanBuffer> m_meshInstanceBuffer = nullptr;
-		VkDescriptorSet m_meshInstanceDescriptorSet = VK_NULL_HANDLE;
 
-		std::vector<EmitterData> m_emitters;
+		// emitters and their alias tables, for the shaders to sample them proportionally to their power
+		EmitterTableBuilder m_emitterTables;
+		std::unordered_map<ResourceId, std::vector<glm::vec3>> m_faceAreaVectors;
+
+		// incremented at each rebuild of the emitter tables, with the slots holding an emitter at that time
+		// (the frames start at 0, so that the first one writes the tables even if they are empty)
+		uint64_t m_emittersGeneration = 1;
+		uint64_t m_emittersStructureGeneration = 0;
+		std::vector<bool> m_emitterSlots;
+
 		Shared<DescriptorSetLayout> m_emittersDescriptorSetLayout = nullptr;
-		Unique<VulkanBuffer> m_emittersBuffer = nullptr;
-		VkDescriptorSet m_emittersDescriptorSet = VK_NULL_HANDLE;
+		std::array<FrameEmitters, SwapChain::MAX_FRAMES_IN_FLIGHT> m_frameEmitters;
 	};
 }
\ No newline at end of file
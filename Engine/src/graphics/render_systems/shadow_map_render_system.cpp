@@ -6,8 +6,6 @@
 namespace PXTEngine {
 
     struct ShadowMapPushConstantData {
-		// it will be modified to translate the object to the light position (i think so?)
-        glm::mat4 modelMatrix{ 1.f };
 		// it will be modified to render the different faces
 		glm::mat4 cubeFaceView{ 1.f };
     };
@@ -22,7 +20,8 @@ namespace PXTEngine {
 
     ShadowMapRenderSystem::ShadowMapRenderSystem(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator, DescriptorSetLayout& setLayout)
 		: m_context(context),
-		  m_descriptorAllocator(std::move(descriptorAllocator)) {
+		  m_descriptorAllocator(std::move(descriptorAllocator)),
+		  m_instanceBuffer(context, m_descriptorAllocator, sizeof(glm::mat4), VK_SHADER_STAGE_VERTEX_BIT) {
 		createUniformBuffers();
 		createDescriptorSets(setLayout);
 		createRenderPass();
@@ -236,7 +235,10 @@ namespace PXTEngine {
         pushConstantRange.offset = 0;
         pushConstantRange.size = sizeof(ShadowMapPushConstantData);
 
-        std::vector<VkDescriptorSetLayout> descriptorSetLayouts{setLayout.getDescriptorSetLayout()};
+        std::vector<VkDescriptorSetLayout> descriptorSetLayouts{
+			setLayout.getDescriptorSetLayout(),
+			m_instanceBuffer.getDescriptorSetLayout().getDescriptorSetLayout()
+		};
 
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -273,7 +275,7 @@ namespace PXTEngine {
         );
     }
 
-	void ShadowMapRenderSystem::update(FrameInfo& frameInfo, GlobalUbo& ubo) {
+	void ShadowMapRenderSystem::update(FrameInfo& frameInfo, GlobalUbo& ubo, const RenderList& renderList) {
 		// Get the light position from the scene and set the other ubo values for offscreen rendering
 		glm::vec4 lightPos = ubo.pointLights[0].position;
 
@@ -292,24 +294,41 @@ namespace PXTEngine {
 
 		m_lightUniformBuffers[frameInfo.frameIndex]->writeToBuffer(&uboOffscreen, sizeof(ShadowUbo), 0);
 		m_lightUniformBuffers[frameInfo.frameIndex]->flush();
+
+		// the model matrices are the same for the six faces
+		auto* modelMatrices = static_cast<glm::mat4*>(
+			m_instanceBuffer.reserve(static_cast<uint32_t>(frameInfo.frameIndex), renderList.getInstanceCount()));
+
+		const std::span<const glm::mat4> worldMatrices = renderList.getWorldMatrices();
+		std::copy(worldMatrices.begin(), worldMatrices.end(), modelMatrices);
 	}
 
-    void ShadowMapRenderSystem::render(FrameInfo& frameInfo, Renderer& renderer) {
+    void ShadowMapRenderSystem::render(FrameInfo& frameInfo, Renderer& renderer, const RenderList& renderList) {
+		const uint32_t frameIndex = static_cast<uint32_t>(frameInfo.frameIndex);
+
+		// update() was not called for this frame slot yet
+		if (m_instanceBuffer.getDescriptorSet(frameIndex) == VK_NULL_HANDLE) return;
+
         m_pipeline->bind(frameInfo.commandBuffer);
 
+		std::array<VkDescriptorSet, 2> descriptorSets = {
+			m_lightDescriptorSets[frameIndex],
+			m_instanceBuffer.getDescriptorSet(frameIndex)
+		};
+
         vkCmdBindDescriptorSets(
             frameInfo.commandBuffer,
             VK_PIPELINE_BIND_POINT_GRAPHICS,
             m_pipelineLayout,
             0,
-            1,
-            &m_lightDescriptorSets[frameInfo.frameIndex],
+            static_cast<uint32_t>(descriptorSets.size()),
+            descriptorSets.data(),
             0,
             nullptr
         );
 
-		// get all the entities with a transform and model component (for later)
-        auto view = frameInfo.scene.getEntitiesWith<TransformComponent, MeshComponent>();
+		// every mesh is drawn from the geometry arena, bound once for all the faces
+		m_context.getGeometryArena().bind(frameInfo.commandBuffer);
 
 		// Loop through each face of the cube map and render the scene from that perspective
 		// we need one render pass per face of the cube map, each time we modify the view matrix
@@ -320,24 +339,18 @@ namespace PXTEngine {
 			ShadowMapPushConstantData push{};
 			push.cubeFaceView = this->getFaceViewMatrix(face);
 
-			for (auto entity : view) {
-
-				const auto& [transform, meshComponent] = view.get<TransformComponent, MeshComponent>(entity);
-
-				push.modelMatrix = transform.mat4();
-
-				vkCmdPushConstants(
-					frameInfo.commandBuffer,
-					m_pipelineLayout,
-					VK_SHADER_STAGE_VERTEX_BIT,
-					0,
-					sizeof(ShadowMapPushConstantData),
-					&push);
-
-				auto vulkanModel = std::static_pointer_cast<VulkanMesh>(meshComponent.mesh);
-
-				vulkanModel->bind(frameInfo.commandBuffer);
-				vulkanModel->draw(frameInfo.commandBuffer);
+			vkCmdPushConstants(
+				frameInfo.commandBuffer,
+				m_pipelineLayout,
+				VK_SHADER_STAGE_VERTEX_BIT,
+				0,
+				sizeof(ShadowMapPushConstantData),
+				&push);
+
+			for (const RenderList::Batch& batch : renderList.getBatches()) {
+				const GeometryRange& range = batch.mesh->getGeometryRange();
+				vkCmdDrawIndexed(frameInfo.commandBuffer, range.indexCount, batch.instanceCount, range.firstIndex,
+					static_cast<int32_t>(range.firstVertex), batch.firstInstance);
 			}
 
 			renderer.endRenderPass(frameInfo.commandBuffer, *m_renderPass, this->getCubeFaceFramebuffer(face));
@@ -8,6 +8,8 @@
 #include "graphics/frame_info.hpp"
 #include "graphics/resources/vk_buffer.hpp"
 #include "graphics/resources/cube_map.hpp"
+#include "graphics/resources/instance_buffer.hpp"
+#include "graphics/render_list.hpp"
 #include "graphics/descriptors/descriptors.hpp"
 #include "graphics/render_pass.hpp"
 
@@ -20,8 +22,15 @@ namespace PXTEngine {
         ShadowMapRenderSystem(const ShadowMapRenderSystem&) = delete;
         ShadowMapRenderSystem& operator=(const ShadowMapRenderSystem&) = delete;
 
-		void update(FrameInfo& frameInfo, GlobalUbo& ubo);
-        void render(FrameInfo& frameInfo, Renderer& renderer);
+		/**
+		 * @brief Writes the light ubo and the model matrices of the render list for the frame.
+		 */
+		void update(FrameInfo& frameInfo, GlobalUbo& ubo, const RenderList& renderList);
+
+		/**
+		 * @brief Renders the six faces of the cube map, with an instanced draw per mesh of the render list.
+		 */
+        void render(FrameInfo& frameInfo, Renderer& renderer, const RenderList& renderList);
         void updateUi();
 
 		FrameBuffer& getCubeFaceFramebuffer(uint32_t face_index) const { return *m_cubeFramebuffers[face_index]; }
@@ -53,6 +62,9 @@ namespace PXTEngine {
 
 		Shared<DescriptorAllocatorGrowable> m_descriptorAllocator;
 
+		// the model matrices of the render list, drawn six times
+		InstanceBuffer m_instanceBuffer;
+
         std::array<Unique<VulkanBuffer>, SwapChain::MAX_FRAMES_IN_FLIGHT> m_lightUniformBuffers;
         std::array<VkDescriptorSet, SwapChain::MAX_FRAMES_IN_FLIGHT> m_lightDescriptorSets;
 
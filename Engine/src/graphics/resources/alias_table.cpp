@@ -0,0 +1,68 @@
+#include "graphics/resources/alias_table.hpp"
+
+namespace PXTEngine {
+
+	void buildAliasTable(std::span<const float> weights, std::span<AliasTableEntry> table) {
+		PXT_ASSERT(weights.size() == table.size(), "Alias table and weights sizes differ");
+
+		const uint32_t count = static_cast<uint32_t>(weights.size());
+		if (count == 0) {
+			return;
+		}
+
+		double totalWeight = 0.0;
+		for (const float weight : weights) {
+			totalWeight += weight;
+		}
+
+		if (totalWeight <= 0.0) {
+			for (uint32_t i = 0; i < count; i++) {
+				table[i] = { 1.0f, i, 1.0f / static_cast<float>(count) };
+			}
+			return;
+		}
+
+		// weights scaled so that they average 1, an entry is then filled by an element under 1
+		// and topped up by an element over 1
+		std::vector<double> scaled(count);
+		std::vector<uint32_t> small;
+		std::vector<uint32_t> large;
+
+		for (uint32_t i = 0; i < count; i++) {
+			scaled[i] = static_cast<double>(weights[i]) * count / totalWeight;
+			table[i].pdf = static_cast<float>(weights[i] / totalWeight);
+
+			if (scaled[i] < 1.0) {
+				small.push_back(i);
+			} else {
+				large.push_back(i);
+			}
+		}
+
+		while (!small.empty() && !large.empty()) {
+			const uint32_t under = small.back();
+			small.pop_back();
+			const uint32_t over = large.back();
+
+			table[under].probability = static_cast<float>(scaled[under]);
+			table[under].alias = over;
+
+			scaled[over] = (scaled[over] + scaled[under]) - 1.0;
+
+			if (scaled[over] < 1.0) {
+				large.pop_back();
+				small.push_back(over);
+			}
+		}
+
+		// what is left is 1 up to rounding errors
+		for (const uint32_t i : large) {
+			table[i].probability = 1.0f;
+			table[i].alias = i;
+		}
+		for (const uint32_t i : small) {
+			table[i].probability = 1.0f;
+			table[i].alias = i;
+		}
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @struct AliasTableEntry
+	 *
+	 * @brief Entry of a Walker alias table, as read by the shaders.
+	 *
+	 * An element is sampled by picking an entry i uniformly and keeping i with the entry probability,
+	 * taking its alias otherwise. pdf is the probability of the element i being sampled.
+	 */
+	struct alignas(uint32_t) AliasTableEntry {
+		float probability;
+		uint32_t alias;
+		float pdf;
+	};
+
+	/**
+	 * @brief Builds the alias table of a set of weights (Vose's method), in O(n).
+	 *
+	 * If every weight is zero the table samples the elements uniformly.
+	 *
+	 * @param weights The non negative weights of the elements.
+	 * @param table Filled with an entry per weight.
+	 */
+	void buildAliasTable(std::span<const float> weights, std::span<AliasTableEntry> table);
+
+	/**
+	 * @brief Samples an alias table from a uniformly picked entry and a random number in [0, 1).
+	 */
+	inline uint32_t sampleAliasTable(std::span<const AliasTableEntry> table, const uint32_t index, const float coin) {
+		return coin < table[index].probability ? index : table[index].alias;
+	}
+}
@@ -1,7 +1,16 @@
 #include "graphics/resources/blas_registry.hpp"
 
 namespace PXTEngine {
-    BLASRegistry::BLASRegistry(Context& context) : m_context(context) {}
+    BLASRegistry::BLASRegistry(Context& context) : m_context(context) {
+        VkPhysicalDeviceAccelerationStructurePropertiesKHR accelStructProps{};
+        accelStructProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR;
+        VkPhysicalDeviceProperties2 deviceProps2{};
+        deviceProps2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        deviceProps2.pNext = &accelStructProps;
+        vkGetPhysicalDeviceProperties2(m_context.getPhysicalDevice(), &deviceProps2);
+
+        m_scratchAlignment = std::max<VkDeviceSize>(1, accelStructProps.minAccelerationStructureScratchOffsetAlignment);
+    }
 
     BLASRegistry::~BLASRegistry() {
 		// Clean up all BLAS resources
@@ -13,26 +22,291 @@ namespace PXTEngine {
 		}
 	}
     
-    Shared<BLAS> BLASRegistry::getOrCreateBLAS(Shared<Mesh>& mesh) {
-        VulkanMesh* vkMesh_ptr = dynamic_cast<VulkanMesh*>(mesh.get());
-		if (!vkMesh_ptr) {
-			PXT_ERROR("Failed to cast Mesh to VulkanMesh");
-			return nullptr;
-		}
+    void BLASRegistry::add(Shared<Mesh>& mesh) {
+        if (!dynamic_cast<VulkanMesh*>(mesh.get())) {
+            PXT_ERROR("Failed to cast Mesh to VulkanMesh");
+            return;
+        }
 
-		VulkanMesh& vkMesh = *vkMesh_ptr;
+        if (m_blasRegistry.contains(mesh->id)) {
+            return;
+        }
 
+        const bool isPending = std::any_of(m_pending.begin(), m_pending.end(),
+            [&](const Shared<Mesh>& pendingMesh) { return pendingMesh->id == mesh->id; });
+
+        if (!isPending) {
+            m_pending.push_back(mesh);
+        }
+    }
+
+    Shared<BLAS> BLASRegistry::getOrCreateBLAS(Shared<Mesh>& mesh) {
 		// Check if the BLAS already exists in the registry
-		auto it = m_blasRegistry.find(vkMesh.id);
+		auto it = m_blasRegistry.find(mesh->id);
 		if (it != m_blasRegistry.end()) {
 			return it->second;
 		}
-        
-        Shared<BLAS> newBlas = createBLAS(vkMesh);
 
-		// Store the new BLAS in the registry
-		m_blasRegistry[vkMesh.id] = newBlas;
-		return newBlas;
+        // built together with anything else still queued
+        add(mesh);
+        buildPending();
+
+        it = m_blasRegistry.find(mesh->id);
+        return it != m_blasRegistry.end() ? it->second : nullptr;
+    }
+
+    void BLASRegistry::buildPending() {
+        if (m_pending.empty()) {
+            return;
+        }
+
+        PXT_PROFILE_FN();
+
+        const auto startTime = std::chrono::high_resolution_clock::now();
+        VkDevice device = m_context.getDevice();
+
+        std::vector<PendingBuild> builds;
+        builds.reserve(m_pending.size());
+        for (const auto& mesh : m_pending) {
+            builds.push_back(createPendingBuild(mesh));
+        }
+        m_pending.clear();
+
+        const uint32_t buildCount = static_cast<uint32_t>(builds.size());
+
+        // every build gets its own range of the scratch arena so that they can run concurrently,
+        // past the budget the ranges start over and the following builds wait for the previous ones
+        std::vector<uint32_t> batchEnds;
+        VkDeviceSize scratchOffset = 0;
+        VkDeviceSize arenaSize = 0;
+        for (uint32_t i = 0; i < buildCount; i++) {
+            const VkDeviceSize scratchSize = (builds[i].blas->buildSizes.buildScratchSize + m_scratchAlignment - 1)
+                / m_scratchAlignment * m_scratchAlignment;
+
+            if (scratchOffset > 0 && scratchOffset + scratchSize > SCRATCH_ARENA_BUDGET) {
+                batchEnds.push_back(i);
+                scratchOffset = 0;
+            }
+
+            builds[i].scratchOffset = scratchOffset;
+            scratchOffset += scratchSize;
+            arenaSize = std::max(arenaSize, scratchOffset);
+        }
+        batchEnds.push_back(buildCount);
+
+        reserveScratch(arenaSize);
+
+        std::vector<VkAccelerationStructureBuildGeometryInfoKHR> buildInfos(buildCount);
+        std::vector<const VkAccelerationStructureBuildRangeInfoKHR*> pBuildRangeInfos(buildCount);
+        std::vector<VkAccelerationStructureKHR> handles(buildCount);
+        VkDeviceSize uncompactedSize = 0;
+
+        for (uint32_t i = 0; i < buildCount; i++) {
+            BLAS& blas = *builds[i].blas;
+
+            VkAccelerationStructureBuildGeometryInfoKHR& buildInfo = buildInfos[i];
+            buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+            buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+            buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+                VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
+            buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+            buildInfo.geometryCount = 1; // for now just one geometry
+            buildInfo.pGeometries = &blas.geometry;
+            buildInfo.dstAccelerationStructure = blas.handle;
+            buildInfo.scratchData.deviceAddress = m_scratchAddress + builds[i].scratchOffset;
+
+            pBuildRangeInfos[i] = &builds[i].range;
+            handles[i] = blas.handle;
+            uncompactedSize += blas.buildSizes.accelerationStructureSize;
+        }
+
+        VkQueryPoolCreateInfo queryPoolInfo{};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR;
+        queryPoolInfo.queryCount = buildCount;
+
+        VkQueryPool queryPool;
+        if (vkCreateQueryPool(device, &queryPoolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create BLAS compaction query pool!");
+        }
+
+        // the builds of every batch are recorded in a single submission
+        VkCommandBuffer commandBuffer = m_context.beginSingleTimeCommands();
+        vkCmdResetQueryPool(commandBuffer, queryPool, 0, buildCount);
+
+        // the builds read and write the scratch, and the size queries read the built BLAS
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+        barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+
+        uint32_t batchStart = 0;
+        for (const uint32_t batchEnd : batchEnds) {
+            if (batchStart > 0) {
+                vkCmdPipelineBarrier(
+                    commandBuffer,
+                    VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                    VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                    0,
+                    1, &barrier,
+                    0, nullptr,
+                    0, nullptr
+                );
+            }
+
+            vkCmdBuildAccelerationStructuresKHR(
+                commandBuffer,
+                batchEnd - batchStart,
+                buildInfos.data() + batchStart,
+                pBuildRangeInfos.data() + batchStart
+            );
+
+            batchStart = batchEnd;
+        }
+
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+            VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+            0,
+            1, &barrier,
+            0, nullptr,
+            0, nullptr
+        );
+
+        vkCmdWriteAccelerationStructuresPropertiesKHR(
+            commandBuffer,
+            buildCount,
+            handles.data(),
+            VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR,
+            queryPool,
+            0
+        );
+
+        m_context.endSingleTimeCommands(commandBuffer);
+
+        const VkDeviceSize compactedSize = compact(builds, queryPool);
+
+        vkDestroyQueryPool(device, queryPool, nullptr);
+
+        for (auto& build : builds) {
+            m_blasRegistry[build.mesh->id] = build.blas;
+        }
+
+        const auto endTime = std::chrono::high_resolution_clock::now();
+        const float elapsedTimeMs = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+
+        PXT_INFO("Built {} BLAS in {:.2f} ms, {:.2f} MiB compacted to {:.2f} MiB", buildCount, elapsedTimeMs,
+            uncompactedSize / (1024.0f * 1024.0f), compactedSize / (1024.0f * 1024.0f));
+    }
+
+    VkDeviceSize BLASRegistry::compact(std::vector<PendingBuild>& builds, VkQueryPool queryPool) {
+        VkDevice device = m_context.getDevice();
+        const uint32_t buildCount = static_cast<uint32_t>(builds.size());
+
+        std::vector<VkDeviceSize> compactedSizes(buildCount);
+        if (vkGetQueryPoolResults(device, queryPool, 0, buildCount, sizeof(VkDeviceSize) * buildCount,
+            compactedSizes.data(), sizeof(VkDeviceSize), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) != VK_SUCCESS) {
+            throw std::runtime_error("failed to get BLAS compacted sizes!");
+        }
+
+        VkDeviceSize totalSize = 0;
+        bool anyCompaction = false;
+        for (uint32_t i = 0; i < buildCount; i++) {
+            const VkDeviceSize size = builds[i].blas->buildSizes.accelerationStructureSize;
+            if (compactedSizes[i] == 0 || compactedSizes[i] >= size) {
+                compactedSizes[i] = size;
+            } else {
+                anyCompaction = true;
+            }
+            totalSize += compactedSizes[i];
+        }
+
+        if (!anyCompaction) {
+            return totalSize;
+        }
+
+        // the uncompacted BLAS are released once the copies are done
+        std::vector<std::pair<VkAccelerationStructureKHR, Unique<VulkanBuffer>>> uncompacted;
+
+        VkCommandBuffer commandBuffer = m_context.beginSingleTimeCommands();
+
+        for (uint32_t i = 0; i < buildCount; i++) {
+            BLAS& blas = *builds[i].blas;
+            if (compactedSizes[i] == blas.buildSizes.accelerationStructureSize) {
+                continue;
+            }
+
+            Unique<VulkanBuffer> buffer = createUnique<VulkanBuffer>(
+                m_context, compactedSizes[i], 1,
+                VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+            VkAccelerationStructureCreateInfoKHR createInfo{};
+            createInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
+            createInfo.buffer = buffer->getBuffer();
+            createInfo.offset = 0;
+            createInfo.size = compactedSizes[i];
+            createInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+
+            VkAccelerationStructureKHR handle = VK_NULL_HANDLE;
+            if (vkCreateAccelerationStructureKHR(device, &createInfo, nullptr, &handle) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create compacted BLAS!");
+            }
+
+            VkCopyAccelerationStructureInfoKHR copyInfo{};
+            copyInfo.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR;
+            copyInfo.src = blas.handle;
+            copyInfo.dst = handle;
+            copyInfo.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR;
+            vkCmdCopyAccelerationStructureKHR(commandBuffer, &copyInfo);
+
+            uncompacted.emplace_back(blas.handle, std::move(blas.buffer));
+            blas.handle = handle;
+            blas.buffer = std::move(buffer);
+        }
+
+        // makes the compacted BLAS visible to the TLAS builds
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+        barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+            VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+            0,
+            1, &barrier,
+            0, nullptr,
+            0, nullptr
+        );
+
+        m_context.endSingleTimeCommands(commandBuffer);
+
+        for (auto& [handle, buffer] : uncompacted) {
+            vkDestroyAccelerationStructureKHR(device, handle, nullptr);
+        }
+
+        return totalSize;
+    }
+
+    void BLASRegistry::reserveScratch(const VkDeviceSize size) {
+        if (m_scratchBuffer != nullptr && m_scratchSize >= size) {
+            return;
+        }
+
+        // not in use, every build waits for its submission
+        m_scratchBuffer = createUnique<VulkanBuffer>(
+            m_context, size + m_scratchAlignment, 1,
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        );
+        m_scratchSize = size;
+
+        // buffers are sub-allocated, so the scratch address is aligned by hand
+        const VkDeviceAddress scratchAddress = m_scratchBuffer->getDeviceAddress();
+        m_scratchAddress = (scratchAddress + m_scratchAlignment - 1) / m_scratchAlignment * m_scratchAlignment;
     }
 
     VkAccelerationStructureGeometryKHR BLASRegistry::getAccelerationStructureGeometry(VulkanMesh& mesh) {
@@ -61,118 +335,73 @@ namespace PXTEngine {
         return geometry;
     }
 
-    Shared<BLAS> BLASRegistry::createBLAS(VulkanMesh& mesh) {
-        Shared<BLAS> newBlas = createShared<BLAS>();
+    BLASRegistry::PendingBuild BLASRegistry::createPendingBuild(const Shared<Mesh>& mesh) {
+        VulkanMesh& vkMesh = static_cast<VulkanMesh&>(*mesh);
+
+        PendingBuild build{};
+        build.mesh = mesh;
+        build.blas = createShared<BLAS>();
+        BLAS& blas = *build.blas;
         VkDevice device = m_context.getDevice();
 
         // create Geometry Data BLAS
-        newBlas->geometry = getAccelerationStructureGeometry(mesh);
-
-        // for now just one geometry
-        std::vector<VkAccelerationStructureGeometryKHR> geometries = { newBlas->geometry };
+        blas.geometry = getAccelerationStructureGeometry(vkMesh);
 
-        // 2. Define Build Info (VkAccelerationStructureBuildGeometryInfoKHR)
+        // Define Build Info (VkAccelerationStructureBuildGeometryInfoKHR), must match the one recorded by buildPending
         VkAccelerationStructureBuildGeometryInfoKHR buildInfo{};
         buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
         buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
-        buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+        buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+            VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
         buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
-        buildInfo.geometryCount = static_cast<uint32_t>(geometries.size());
-        buildInfo.pGeometries = geometries.data();
+        buildInfo.geometryCount = 1;
+        buildInfo.pGeometries = &blas.geometry;
 
-        // 3. Query Build Sizes (vkGetAccelerationStructureBuildSizesKHR)
+        // Query Build Sizes (vkGetAccelerationStructureBuildSizesKHR)
         // to know how much space we need to store the BLAS AND how much space to create it (scratch buffer)
-		bool hasIndices = mesh.getIndexCount() > 0;
+		bool hasIndices = vkMesh.getIndexCount() > 0;
         uint32_t numTriangles = hasIndices 
-            ? (mesh.getIndexCount() / 3)
-            : (mesh.getVertexCount() / 3);
-        std::vector<uint32_t> maxPrimitiveCounts = { numTriangles };
+            ? (vkMesh.getIndexCount() / 3)
+            : (vkMesh.getVertexCount() / 3);
 
-        newBlas->buildSizes = {};
-        newBlas->buildSizes.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
+        blas.buildSizes = {};
+        blas.buildSizes.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
         vkGetAccelerationStructureBuildSizesKHR(
             device,
             VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
             &buildInfo,
-            maxPrimitiveCounts.data(),
-            &(newBlas->buildSizes)
+            &numTriangles,
+            &blas.buildSizes
         );
         
-        // 4. Allocate BLAS Buffer and Scratch Buffer
-        newBlas->buffer = createUnique<VulkanBuffer>(
-            m_context, newBlas->buildSizes.accelerationStructureSize, 1,
+        // Allocate the BLAS Buffer, it only lives until the compaction if the BLAS can be compacted
+        blas.buffer = createUnique<VulkanBuffer>(
+            m_context, blas.buildSizes.accelerationStructureSize, 1,
             VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-        Unique<VulkanBuffer> scratchBuffer = createUnique<VulkanBuffer>(
-            m_context, newBlas->buildSizes.buildScratchSize, 1,
-            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-        );
-
         // BUILD BLAS HANDLE
         VkAccelerationStructureCreateInfoKHR createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
-        createInfo.buffer = newBlas->buffer->getBuffer(); // The VkBuffer handle of the storage buffer
-        createInfo.offset = 0;                              // Offset within that buffer where the AS will be stored
-        createInfo.size = newBlas->buildSizes.accelerationStructureSize; // Total size of the AS
+        createInfo.buffer = blas.buffer->getBuffer(); // The VkBuffer handle of the storage buffer
+        createInfo.offset = 0;                         // Offset within that buffer where the AS will be stored
+        createInfo.size = blas.buildSizes.accelerationStructureSize; // Total size of the AS
         createInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
-        // createInfo.deviceAddress = 0; // Only if VK_ACCELERATION_STRUCTURE_CREATE_DEVICE_ADDRESS_CAPTURE_REPLAY_BIT_KHR is set
 
-        VkAccelerationStructureKHR blasHandle = VK_NULL_HANDLE;
-        // Call the Vulkan function (via your context's loaded function pointer)
         VkResult result = vkCreateAccelerationStructureKHR(
             device,
             &createInfo,
             nullptr, // pAllocator
-            &blasHandle
+            &blas.handle
         );
 
         PXT_ASSERT(result == VK_SUCCESS, "Blas Handle creation error");
-        
-        newBlas->handle = blasHandle;
-
-        // 5. Update Build Info with destination and scratch
-        buildInfo.dstAccelerationStructure = newBlas->handle;
-        buildInfo.scratchData.deviceAddress = scratchBuffer->getDeviceAddress();
-
-        // 6. Build Command (vkCmdBuildAccelerationStructuresKHR)
-        VkAccelerationStructureBuildRangeInfoKHR buildRangeInfo{};
-        buildRangeInfo.primitiveCount = numTriangles;
-        buildRangeInfo.primitiveOffset = 0;
-        buildRangeInfo.firstVertex = 0;
-        buildRangeInfo.transformOffset = 0; // Offset into transform data if used
-        std::vector<const VkAccelerationStructureBuildRangeInfoKHR*> pBuildRangeInfos = { &buildRangeInfo };
-
-        VkCommandBuffer commandBuffer = m_context.beginSingleTimeCommands();
-        vkCmdBuildAccelerationStructuresKHR(
-            commandBuffer,
-            1, // buildInfoCount
-            &buildInfo,
-            pBuildRangeInfos.data()
-        );
-
-        // 7. Add barrier to ensure BLAS build completes before use / scratch buffer reuse
-        VkMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-        barrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR; // What the build command did
-        barrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;  // What subsequent operations will do (e.g., TLAS build reading the BLAS address)
-
-        vkCmdPipelineBarrier(
-            commandBuffer,
-            VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, // Stage where writing happened
-            VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, // Stage where reading will happen (or other relevant stages like ray tracing shader stage)
-            0,
-            1, &barrier,
-            0, nullptr,
-            0, nullptr
-        );
-
-        m_context.endSingleTimeCommands(commandBuffer);
 
-        //TODO: Maybe use a global scratch buffer as a class member instead of creating
-        //      a new one every build, waiting for the build and then destroying it
+        build.range.primitiveCount = numTriangles;
+        build.range.primitiveOffset = 0;
+        build.range.firstVertex = 0;
+        build.range.transformOffset = 0; // Offset into transform data if used
 
-        return newBlas;
+        return build;
     }
 }
\ No newline at end of file
@@ -17,19 +17,71 @@ namespace PXTEngine {
 		}
 	};
 
+	/**
+	 * @class BLASRegistry
+	 *
+	 * @brief Builds and owns the BLAS of every mesh.
+	 *
+	 * Meshes are queued with add and built together by buildPending: all the builds are recorded in a
+	 * single submission sharing one scratch arena, then compacted into right-sized buffers in a second one.
+	 */
 	class BLASRegistry {
 	public:
+		// scratch memory the builds of a single submission share, larger batches wait for each other
+		static constexpr VkDeviceSize SCRATCH_ARENA_BUDGET = 256ull * 1024 * 1024;
+
 		BLASRegistry(Context& context);
 		~BLASRegistry();
 		BLASRegistry(const BLASRegistry&) = delete;
 		BLASRegistry& operator=(const BLASRegistry&) = delete;
 
+		/**
+		 * @brief Queues the BLAS build of a mesh, if it has none yet.
+		 */
+		void add(Shared<Mesh>& mesh);
+
+		/**
+		 * @brief Builds and compacts the BLAS of every queued mesh, waiting for the GPU.
+		 */
+		void buildPending();
+
+		/**
+		 * @brief Returns the BLAS of a mesh, building it right away if it wasn't built yet.
+		 */
 		Shared<BLAS> getOrCreateBLAS(Shared<Mesh>& mesh);
 	private:
+		/**
+		 * @struct PendingBuild
+		 *
+		 * @brief A BLAS being built: its uncompacted storage and where its build scratch lives.
+		 */
+		struct PendingBuild {
+			Shared<Mesh> mesh;
+			Shared<BLAS> blas;
+			VkAccelerationStructureBuildRangeInfoKHR range{};
+			VkDeviceSize scratchOffset = 0;
+		};
+
 		VkAccelerationStructureGeometryKHR getAccelerationStructureGeometry(VulkanMesh& mesh);
-		Shared<BLAS> createBLAS(VulkanMesh& mesh);
+		PendingBuild createPendingBuild(const Shared<Mesh>& mesh);
+
+		/**
+		 * @brief Recreates the shared scratch buffer if it is smaller than size.
+		 */
+		void reserveScratch(VkDeviceSize size);
+
+		/**
+		 * @brief Copies the built BLAS into buffers of their compacted size, returns the total compacted size.
+		 */
+		VkDeviceSize compact(std::vector<PendingBuild>& builds, VkQueryPool queryPool);
 
 		Context& m_context;
 		std::unordered_map<UUID, Shared<BLAS>> m_blasRegistry;
+		std::vector<Shared<Mesh>> m_pending;
+
+		Unique<VulkanBuffer> m_scratchBuffer = nullptr;
+		VkDeviceAddress m_scratchAddress = 0;
+		VkDeviceSize m_scratchSize = 0;
+		VkDeviceSize m_scratchAlignment = 1;
 	};
 }
\ No newline at end of file
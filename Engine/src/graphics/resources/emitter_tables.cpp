@@ -0,0 +1,73 @@
+#include "graphics/resources/emitter_tables.hpp"
+
+namespace PXTEngine {
+
+	static float luminance(const glm::vec3& color) {
+		return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+	}
+
+	void EmitterTableBuilder::calculateFaceAreaVectors(std::span<const Mesh::Vertex> vertices,
+		std::span<const uint32_t> indices, std::vector<glm::vec3>& areaVectors) {
+		const size_t faceCount = (indices.empty() ? vertices.size() : indices.size()) / 3;
+
+		areaVectors.resize(faceCount);
+
+		for (size_t face = 0; face < faceCount; face++) {
+			const size_t first = face * 3;
+			const glm::vec3 v0 = vertices[indices.empty() ? first + 0 : indices[first + 0]].position;
+			const glm::vec3 v1 = vertices[indices.empty() ? first + 1 : indices[first + 1]].position;
+			const glm::vec3 v2 = vertices[indices.empty() ? first + 2 : indices[first + 2]].position;
+
+			areaVectors[face] = glm::cross(v1 - v0, v2 - v0);
+		}
+	}
+
+	void EmitterTableBuilder::clear() {
+		m_emitters.clear();
+		m_emitterPowers.clear();
+		m_faceTable.clear();
+	}
+
+	void EmitterTableBuilder::addEmitter(const uint32_t instanceIndex, std::span<const glm::vec3> faceAreaVectors,
+		const glm::mat4& objectToWorld, const glm::vec4& emissiveColor) {
+		// M * a x M * b = cofactor(M) * (a x b), the columns of the cofactor matrix are the cross products of the columns of M
+		const glm::mat3 linear(objectToWorld);
+		const glm::mat3 cofactor(
+			glm::cross(linear[1], linear[2]),
+			glm::cross(linear[2], linear[0]),
+			glm::cross(linear[0], linear[1])
+		);
+
+		// the alpha channel is the intensity
+		const float radiance = luminance(glm::vec3(emissiveColor) * emissiveColor.a);
+
+		m_facePowers.resize(faceAreaVectors.size());
+
+		double emitterPower = 0.0;
+		for (size_t face = 0; face < faceAreaVectors.size(); face++) {
+			const float area = 0.5f * glm::length(cofactor * faceAreaVectors[face]);
+			m_facePowers[face] = area * radiance;
+			emitterPower += m_facePowers[face];
+		}
+
+		EmitterData emitter{};
+		emitter.instanceIndex = instanceIndex;
+		emitter.numberOfFaces = static_cast<uint32_t>(faceAreaVectors.size());
+		emitter.faceTableOffset = static_cast<uint32_t>(m_faceTable.size());
+
+		m_faceTable.resize(m_faceTable.size() + faceAreaVectors.size());
+		buildAliasTable(m_facePowers, std::span(m_faceTable).subspan(emitter.faceTableOffset));
+
+		m_emitters.push_back(emitter);
+		m_emitterPowers.push_back(static_cast<float>(emitterPower));
+	}
+
+	void EmitterTableBuilder::build() {
+		std::vector<AliasTableEntry> emitterTable(m_emitters.size());
+		buildAliasTable(m_emitterPowers, emitterTable);
+
+		for (size_t i = 0; i < m_emitters.size(); i++) {
+			m_emitters[i].aliasEntry = emitterTable[i];
+		}
+	}
+}
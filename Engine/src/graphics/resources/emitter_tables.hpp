@@ -0,0 +1,64 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "resources/types/mesh.hpp"
+#include "graphics/resources/alias_table.hpp"
+
+namespace PXTEngine {
+
+	struct alignas(uint32_t) EmitterData {
+		uint32_t instanceIndex;
+		uint32_t numberOfFaces;
+		uint32_t faceTableOffset;   // first entry of the emitter faces in the face alias table
+		AliasTableEntry aliasEntry; // entry of the emitter in the emitter alias table
+	};
+
+	/**
+	 * @class EmitterTableBuilder
+	 *
+	 * @brief Builds the alias tables used by next event estimation to sample emitters proportionally to their power.
+	 *
+	 * The power of a face is its world space area times the luminance of the emissive color of the material,
+	 * emissive maps are not accounted for (the pdfs stay exact, they only sample less effectively).
+	 * An emitter is picked with the emitter alias table, then one of its faces with its own face alias table.
+	 */
+	class EmitterTableBuilder {
+	public:
+		/**
+		 * @brief Computes the object space area vectors of the faces of a mesh: cross(v1 - v0, v2 - v0).
+		 *
+		 * Their length is twice the face area, the area in world space is computed from them for any transform.
+		 *
+		 * @param indices The indices of the mesh, the vertices are taken three by three when empty.
+		 */
+		static void calculateFaceAreaVectors(std::span<const Mesh::Vertex> vertices, std::span<const uint32_t> indices,
+			std::vector<glm::vec3>& areaVectors);
+
+		void clear();
+
+		/**
+		 * @brief Adds an emitter, the emitters are indexed in the order they are added.
+		 *
+		 * @param faceAreaVectors The face area vectors of the emitter mesh.
+		 */
+		void addEmitter(uint32_t instanceIndex, std::span<const glm::vec3> faceAreaVectors,
+			const glm::mat4& objectToWorld, const glm::vec4& emissiveColor);
+
+		/**
+		 * @brief Builds the emitter alias table, once every emitter has been added.
+		 */
+		void build();
+
+		const std::vector<EmitterData>& getEmitters() const { return m_emitters; }
+		const std::vector<AliasTableEntry>& getFaceTable() const { return m_faceTable; }
+
+	private:
+		std::vector<EmitterData> m_emitters;
+		std::vector<float> m_emitterPowers;
+
+		std::vector<AliasTableEntry> m_faceTable;
+
+		// reused between emitters to avoid reallocating
+		std::vector<float> m_facePowers;
+	};
+}
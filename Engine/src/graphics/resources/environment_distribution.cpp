@@ -0,0 +1,152 @@
+#include "graphics/resources/environment_distribution.hpp"
+
+#include "core/jobs/job_system.hpp"
+#include "scene/spatial/simd.hpp"
+
+namespace PXTEngine {
+
+	// offsets of the lanes of a SimdFloat, only the first SIMD_WIDTH are loaded
+	alignas(32) static constexpr float LANE_OFFSETS[8] = { 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f };
+
+	// the sampler decodes the sRGB faces, so must the weights
+	static const std::array<float, 256>& getSrgbToLinearTable() {
+		static const std::array<float, 256> table = [] {
+			std::array<float, 256> values;
+			for (uint32_t i = 0; i < values.size(); i++) {
+				const float c = static_cast<float>(i) / 255.0f;
+				values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+			return values;
+		}();
+
+		return table;
+	}
+
+	// direction of a point of a face, with face coordinates in [-1, 1] (inverse of the Vulkan face selection)
+	static glm::vec3 faceToDirection(const uint32_t face, const glm::vec2& st) {
+		switch (face) {
+			case 0: return { 1.0f, -st.y, -st.x };
+			case 1: return { -1.0f, -st.y, st.x };
+			case 2: return { st.x, 1.0f, st.y };
+			case 3: return { st.x, -1.0f, -st.y };
+			case 4: return { st.x, -st.y, 1.0f };
+			default: return { -st.x, -st.y, -1.0f };
+		}
+	}
+
+	// Vulkan face selection: the major axis picks the face, the other two components give its coordinates
+	static uint32_t directionToFace(const glm::vec3& direction, glm::vec2& st) {
+		const glm::vec3 absolute = glm::abs(direction);
+
+		if (absolute.x >= absolute.y && absolute.x >= absolute.z) {
+			st = glm::vec2(direction.x >= 0.0f ? -direction.z : direction.z, -direction.y) / absolute.x;
+			return direction.x >= 0.0f ? 0 : 1;
+		}
+
+		if (absolute.y >= absolute.z) {
+			st = glm::vec2(direction.x, direction.y >= 0.0f ? direction.z : -direction.z) / absolute.y;
+			return direction.y >= 0.0f ? 2 : 3;
+		}
+
+		st = glm::vec2(direction.z >= 0.0f ? direction.x : -direction.x, -direction.y) / absolute.z;
+		return direction.z >= 0.0f ? 4 : 5;
+	}
+
+	EnvironmentDistribution::EnvironmentDistribution(std::span<const uint8_t* const> faces, const uint32_t size)
+		: m_resolution(std::min(size, MAX_RESOLUTION)) {
+		PXT_PROFILE_FN();
+		PXT_ASSERT(faces.size() == 6, "A cube map has 6 faces");
+
+		const std::array<float, 256>& srgbToLinear = getSrgbToLinearTable();
+
+		const uint32_t resolution = m_resolution;
+		const float texelSize = 2.0f / static_cast<float>(size);
+		const float texelArea = texelSize * texelSize;
+
+		std::vector<float> weights(6 * resolution * resolution, 0.0f);
+
+		// a job per row of cells, so that no two jobs write the same cell
+		JobSystem::parallelFor(6 * resolution, 1, [&](const size_t begin, const size_t end) {
+			std::vector<float> luminances(size);
+			std::vector<float> texelWeights(size);
+
+			for (size_t cellRow = begin; cellRow < end; cellRow++) {
+				const uint32_t face = static_cast<uint32_t>(cellRow / resolution);
+				const uint32_t row = static_cast<uint32_t>(cellRow % resolution);
+				float* cellWeights = &weights[cellRow * resolution];
+
+				// the texel rows y with y * resolution / size == row
+				const uint32_t firstY = (row * size + resolution - 1) / resolution;
+				const uint32_t endY = ((row + 1) * size + resolution - 1) / resolution;
+
+				for (uint32_t y = firstY; y < endY; y++) {
+					const uint8_t* texels = faces[face] + static_cast<size_t>(y) * size * 4;
+
+					for (uint32_t x = 0; x < size; x++) {
+						const uint8_t* texel = texels + x * 4;
+						luminances[x] = 0.2126f * srgbToLinear[texel[0]] + 0.7152f * srgbToLinear[texel[1]] + 0.0722f * srgbToLinear[texel[2]];
+					}
+
+					// a texel at face coordinates (s, t) covers a solid angle of texelArea / (1 + s^2 + t^2)^(3/2)
+					const float t = (static_cast<float>(y) + 0.5f) * texelSize - 1.0f;
+					const SimdFloat distance2T(1.0f + t * t);
+					const SimdFloat laneS = SimdFloat::load(LANE_OFFSETS) * SimdFloat(texelSize);
+
+					uint32_t x = 0;
+					for (; x + SIMD_WIDTH <= size; x += SIMD_WIDTH) {
+						const SimdFloat s = SimdFloat((static_cast<float>(x) + 0.5f) * texelSize - 1.0f) + laneS;
+						const SimdFloat distance2 = distance2T + s * s;
+						const SimdFloat weight = SimdFloat::load(&luminances[x]) * SimdFloat(texelArea) / (distance2 * sqrt(distance2));
+						weight.store(&texelWeights[x]);
+					}
+
+					for (; x < size; x++) {
+						const float s = (static_cast<float>(x) + 0.5f) * texelSize - 1.0f;
+						const float distance2 = 1.0f + s * s + t * t;
+						texelWeights[x] = luminances[x] * texelArea / (distance2 * std::sqrt(distance2));
+					}
+
+					for (x = 0; x < size; x++) {
+						cellWeights[x * resolution / size] += texelWeights[x];
+					}
+				}
+			}
+		});
+
+		m_cells.resize(weights.size());
+		buildAliasTable(weights, m_cells);
+	}
+
+	glm::vec3 EnvironmentDistribution::sampleDirection(const uint32_t cellIndex, const float coin,
+		const glm::vec2& cellPoint, float& pdf) const {
+		const uint32_t cell = sampleAliasTable(m_cells, cellIndex, coin);
+
+		const uint32_t face = cell / (m_resolution * m_resolution);
+		const glm::vec2 cellCoords(cell % m_resolution, (cell / m_resolution) % m_resolution);
+
+		const glm::vec2 st = (cellCoords + cellPoint) * (2.0f / static_cast<float>(m_resolution)) - 1.0f;
+
+		pdf = cellToSolidAnglePdf(m_cells[cell].pdf, st);
+
+		return glm::normalize(faceToDirection(face, st));
+	}
+
+	float EnvironmentDistribution::pdf(const glm::vec3& direction) const {
+		glm::vec2 st;
+		const uint32_t face = directionToFace(direction, st);
+
+		const glm::uvec2 cellCoords = glm::min(glm::uvec2((st + 1.0f) * 0.5f * static_cast<float>(m_resolution)), glm::uvec2(m_resolution - 1));
+		const uint32_t cell = (face * m_resolution + cellCoords.y) * m_resolution + cellCoords.x;
+
+		return cellToSolidAnglePdf(m_cells[cell].pdf, st);
+	}
+
+	float EnvironmentDistribution::cellToSolidAnglePdf(const float cellProbability, const glm::vec2& facePoint) const {
+		// uniform over the cell area in face coordinates, then from face area to solid angle
+		const float cellSize = 2.0f / static_cast<float>(m_resolution);
+		const float cellArea = cellSize * cellSize;
+		const float distance2 = 1.0f + glm::dot(facePoint, facePoint);
+
+		return cellProbability / cellArea * distance2 * std::sqrt(distance2);
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "graphics/resources/alias_table.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class EnvironmentDistribution
+	 *
+	 * @brief Luminance based importance sampling distribution of a cube map, for explicit sky light samples.
+	 *
+	 * Every face is divided in a grid of cells (at most MAX_RESOLUTION per side), the weight of a cell is the
+	 * luminance of its texels integrated over their solid angle. A single alias table over the cells of all the
+	 * faces picks a cell, then a point is picked uniformly in the face coordinates of the cell.
+	 *
+	 * Cells are indexed face by face, row by row. sampleDirection and pdf are the CPU versions of
+	 * sampleSkyDirection and pdfSky of sky.glsl.
+	 */
+	class EnvironmentDistribution {
+	public:
+		static constexpr uint32_t MAX_RESOLUTION = 64;
+
+		/**
+		 * @brief Builds the distribution, the texel rows are processed in parallel as JobSystem jobs.
+		 *
+		 * @param faces The six faces in cube map layer order, RGBA8 sRGB texels.
+		 * @param size The width and height of the faces.
+		 */
+		EnvironmentDistribution(std::span<const uint8_t* const> faces, uint32_t size);
+
+		/**
+		 * @brief Samples a direction from a uniformly picked cell, a random number in [0, 1) and a point in the cell.
+		 *
+		 * @param pdf Set to the solid angle pdf of the direction.
+		 */
+		glm::vec3 sampleDirection(uint32_t cellIndex, float coin, const glm::vec2& cellPoint, float& pdf) const;
+
+		/**
+		 * @brief Returns the solid angle pdf of sampling a direction.
+		 */
+		float pdf(const glm::vec3& direction) const;
+
+		uint32_t getResolution() const { return m_resolution; }
+		const std::vector<AliasTableEntry>& getCells() const { return m_cells; }
+
+	private:
+		/**
+		 * @brief Converts the probability of a cell to the solid angle pdf at a point of the face.
+		 */
+		float cellToSolidAnglePdf(float cellProbability, const glm::vec2& facePoint) const;
+
+		uint32_t m_resolution = 0;
+		std::vector<AliasTableEntry> m_cells;
+	};
+}
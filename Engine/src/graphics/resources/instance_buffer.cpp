@@ -0,0 +1,47 @@
+#include "graphics/resources/instance_buffer.hpp"
+
+namespace PXTEngine {
+
+	InstanceBuffer::InstanceBuffer(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator,
+		const VkDeviceSize instanceSize, const VkShaderStageFlags stageFlags)
+		: m_context(context),
+		m_descriptorAllocator(std::move(descriptorAllocator)),
+		m_instanceSize(instanceSize) {
+		m_descriptorSetLayout = DescriptorSetLayout::Builder(m_context)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, stageFlags)
+			.build();
+	}
+
+	void* InstanceBuffer::reserve(const uint32_t frameIndex, const uint32_t instanceCount) {
+		Frame& frame = m_frames[frameIndex];
+
+		if (frame.buffer && instanceCount <= frame.capacity) {
+			return frame.buffer->getMappedMemory();
+		}
+
+		// grow geometrically so that a slowly growing scene doesn't recreate the buffer every frame
+		const uint32_t capacity = std::max({ instanceCount, frame.capacity * 2, 64u });
+
+		frame.buffer = createUnique<VulkanBuffer>(
+			m_context,
+			m_instanceSize,
+			capacity,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		);
+		frame.buffer->map();
+		frame.capacity = capacity;
+
+		// the set of this frame slot is not in use anymore, it can point to the new buffer
+		if (frame.descriptorSet == VK_NULL_HANDLE) {
+			m_descriptorAllocator->allocate(m_descriptorSetLayout->getDescriptorSetLayout(), frame.descriptorSet);
+		}
+
+		VkDescriptorBufferInfo bufferInfo = frame.buffer->descriptorInfo();
+		DescriptorWriter(m_context, *m_descriptorSetLayout)
+			.writeBuffer(0, &bufferInfo)
+			.updateSet(frame.descriptorSet);
+
+		return frame.buffer->getMappedMemory();
+	}
+}
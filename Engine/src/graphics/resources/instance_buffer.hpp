@@ -0,0 +1,59 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "graphics/context/context.hpp"
+#include "graphics/swap_chain.hpp"
+#include "graphics/descriptors/descriptors.hpp"
+#include "graphics/resources/vk_buffer.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class InstanceBuffer
+	 *
+	 * @brief Per frame storage buffers holding the per instance data of a render system.
+	 *
+	 * Every frame in flight has a persistently mapped buffer and a descriptor set with the buffer
+	 * at binding 0, read by the shaders with gl_InstanceIndex. The buffers only grow.
+	 */
+	class InstanceBuffer {
+	public:
+		/**
+		 * @param instanceSize The size of the data of an instance, matching the std430 layout of the shaders.
+		 * @param stageFlags The shader stages reading the instances.
+		 */
+		InstanceBuffer(Context& context, Shared<DescriptorAllocatorGrowable> descriptorAllocator,
+			VkDeviceSize instanceSize, VkShaderStageFlags stageFlags);
+
+		InstanceBuffer(const InstanceBuffer&) = delete;
+		InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+		/**
+		 * @brief Makes room for the instances of a frame, the fence of the frame slot must have been waited.
+		 *
+		 * @return The mapped memory of the frame buffer, to write the instances into.
+		 */
+		void* reserve(uint32_t frameIndex, uint32_t instanceCount);
+
+		/**
+		 * @brief Returns the descriptor set of a frame, VK_NULL_HANDLE if nothing was reserved for it yet.
+		 */
+		VkDescriptorSet getDescriptorSet(uint32_t frameIndex) const { return m_frames[frameIndex].descriptorSet; }
+
+		DescriptorSetLayout& getDescriptorSetLayout() const { return *m_descriptorSetLayout; }
+
+	private:
+		struct Frame {
+			Unique<VulkanBuffer> buffer = nullptr;
+			uint32_t capacity = 0;
+			VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+		};
+
+		Context& m_context;
+		Shared<DescriptorAllocatorGrowable> m_descriptorAllocator;
+
+		VkDeviceSize m_instanceSize;
+		Unique<DescriptorSetLayout> m_descriptorSetLayout = nullptr;
+		std::array<Frame, SwapChain::MAX_FRAMES_IN_FLIGHT> m_frames{};
+	};
+}
@@ -4,7 +4,6 @@ namespace PXTEngine {
 
 	MaterialRegistry::MaterialRegistry(Context& context, TextureRegistry& textureRegistry)
 		: m_context(context), m_textureRegistry(textureRegistry) {
-		m_materialDescriptorSet = VK_NULL_HANDLE;
 		m_materialDescriptorSetLayout = nullptr;
 		m_descriptorAllocator = nullptr;
 	}
@@ -14,6 +13,10 @@ namespace PXTEngine {
 	}
 
 	uint32_t MaterialRegistry::add(const Shared<Material>& material) {
+		if (const auto it = m_idToIndex.find(material->id); it != m_idToIndex.end()) {
+			return it->second;
+		}
+
 		const auto index = static_cast<uint32_t>(m_materials.size());
 		m_materials.push_back(material);
 		m_idToIndex[material->id] = index;
@@ -25,8 +28,21 @@ namespace PXTEngine {
 		return it != m_idToIndex.end() ? it->second : 0;
 	}
 
-	VkDescriptorSet MaterialRegistry::getDescriptorSet() {
-		return m_materialDescriptorSet;
+	void MaterialRegistry::update(const uint32_t frameIndex) {
+		// a handful of materials, cheaper to compare than to track their changes
+		std::vector<MaterialData> materialsData;
+		materialsData.reserve(m_materials.size());
+		for (const auto& material : m_materials) {
+			materialsData.push_back(getMaterialData(material));
+		}
+
+		if (materialsData != m_frames[frameIndex].uploadedData) {
+			upload(frameIndex, materialsData);
+		}
+	}
+
+	VkDescriptorSet MaterialRegistry::getDescriptorSet(const uint32_t frameIndex) {
+		return m_frames[frameIndex].descriptorSet;
 	}
 
 	VkDescriptorSetLayout MaterialRegistry::getDescriptorSetLayout() {
@@ -38,44 +54,43 @@ namespace PXTEngine {
 			.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, 1)
 			.build();
 
-		std::vector<MaterialData> materialsData;
-		for (const auto& material : m_materials) {
-			materialsData.push_back(getMaterialData(material));
+		for (uint32_t i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+			m_descriptorAllocator->allocate(
+				m_materialDescriptorSetLayout->getDescriptorSetLayout(),
+				m_frames[i].descriptorSet
+			);
+
+			update(i);
 		}
+	}
+
+	void MaterialRegistry::upload(const uint32_t frameIndex, const std::vector<MaterialData>& materialsData) {
+		FrameResources& frame = m_frames[frameIndex];
+
+		const VkDeviceSize bufferSize = sizeof(MaterialData) * materialsData.size();
+
+		// grown to the next power of two, so that materials added one by one don't recreate it each time
+		if (!frame.buffer || frame.buffer->getBufferSize() < bufferSize) {
+			const VkDeviceSize capacity = std::bit_ceil(std::max<size_t>(materialsData.size(), 16));
+
+			frame.buffer = createUnique<VulkanBuffer>(
+				m_context,
+				sizeof(MaterialData),
+				static_cast<uint32_t>(capacity),
+				VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			);
+
+			auto bufferInfo = frame.buffer->descriptorInfo();
+
+			DescriptorWriter(m_context, *m_materialDescriptorSetLayout)
+				.writeBuffer(0, &bufferInfo)
+				.updateSet(frame.descriptorSet);
+		}
+
+		m_context.getUploader().copyToBuffer(frame.buffer->getBuffer(), materialsData.data(), bufferSize);
 
-		VkDeviceSize bufferSize = sizeof(MaterialData) * materialsData.size();
-
-		Unique<VulkanBuffer> stagingBuffer = createUnique<VulkanBuffer>(
-			m_context,
-			bufferSize,
-			1,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-		);
-		stagingBuffer->map();
-		stagingBuffer->writeToBuffer(materialsData.data(), bufferSize);
-		stagingBuffer->unmap();
-
-		m_materialsGpuBuffer = createUnique<VulkanBuffer>(
-			m_context,
-			bufferSize,
-			1,
-			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-		);
-
-		m_context.copyBuffer(stagingBuffer->getBuffer(), m_materialsGpuBuffer->getBuffer(), bufferSize);
-
-		auto bufferInfo = m_materialsGpuBuffer->descriptorInfo();
-
-		m_descriptorAllocator->allocate(
-			m_materialDescriptorSetLayout->getDescriptorSetLayout(),
-			m_materialDescriptorSet
-		);
-
-		DescriptorWriter(m_context, *m_materialDescriptorSetLayout)
-			.writeBuffer(0, &bufferInfo)
-			.updateSet(m_materialDescriptorSet);
+		frame.uploadedData = materialsData;
 	}
 
 	MaterialData MaterialRegistry::getMaterialData(Shared<Material> material) {
@@ -88,6 +103,7 @@ namespace PXTEngine {
 		data.metallicMapIndex = m_textureRegistry.getIndex(material->getMetallicMap()->id);
 		data.roughnessMapIndex = m_textureRegistry.getIndex(material->getRoughnessMap()->id);
 		data.emissiveMapIndex = m_textureRegistry.getIndex(material->getEmissiveMap()->id);
+		data.normalMapChannels = material->getNormalMap()->getChannels();
 		return data;
 	}
 }
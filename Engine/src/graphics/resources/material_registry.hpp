@@ -6,6 +6,7 @@
 #include "graphics/descriptors/descriptors.hpp"
 #include "graphics/resources/vk_buffer.hpp"
 #include "graphics/resources/texture_registry.hpp"
+#include "graphics/swap_chain.hpp"
 
 namespace PXTEngine {
 
@@ -28,6 +29,9 @@ namespace PXTEngine {
 		int metallicMapIndex;
 		int roughnessMapIndex;
 		int emissiveMapIndex;
+		int normalMapChannels; // 2 for BC5 normal maps, whose z is reconstructed by the shaders
+
+		bool operator==(const MaterialData& other) const = default;
 	};
 
 	/**
@@ -36,6 +40,10 @@ namespace PXTEngine {
 	 * @brief This class is a central manager for all Material resources in the application.
 	 * It orchestrates the conversion of CPU-side Material objects into a GPU-consumable buffer and
 	 * provides the necessary Vulkan descriptors for shaders to access this data.
+	 *
+	 * Materials can be added or change their maps at any time, e.g. when their textures end
+	 * loading in the background: each frame in flight has its own buffer and descriptor set,
+	 * which update refreshes once the frame is no longer in use by the GPU.
 	 */
 	class MaterialRegistry {
 	public:
@@ -53,7 +61,7 @@ namespace PXTEngine {
 		 *
 		 * @param material Shared pointer to the material to add.
 		 *
-		 * @return Index of the added material in the registry.
+		 * @return Index of the added material in the registry, the existing one if it was already added.
 		 */
 		uint32_t add(const Shared<Material>& material);
 
@@ -67,11 +75,22 @@ namespace PXTEngine {
 		uint32_t getIndex(const ResourceId& id) const;
 
 		/**
-		 * @brief Gets the Vulkan descriptor set used for the materials.
+		 * @brief Uploads the materials of a frame again if any of them changed since its last update.
+		 *
+		 * Must be called once the frame is no longer in use by the GPU, before recording it.
+		 *
+		 * @param frameIndex Index of the frame in flight.
+		 */
+		void update(uint32_t frameIndex);
+
+		/**
+		 * @brief Gets the Vulkan descriptor set used for the materials of a frame.
+		 *
+		 * @param frameIndex Index of the frame in flight.
 		 *
 		 * @return The Vulkan descriptor set.
 		 */
-		VkDescriptorSet getDescriptorSet();
+		VkDescriptorSet getDescriptorSet(uint32_t frameIndex);
 
 		/**
 		 * @brief Gets the Vulkan descriptor set layout used for the materials.
@@ -81,14 +100,30 @@ namespace PXTEngine {
 		VkDescriptorSetLayout getDescriptorSetLayout();
 
 		/**
-		 * @brief Creates the descriptor set and GPU buffer for the registered materials.
+		 * @brief Creates the descriptor sets and GPU buffers for the registered materials, one per frame in flight.
 		 *
 		 * This method prepares the material data for use in shaders by uploading it to GPU memory
-		 * and writing it into a Vulkan descriptor set.
+		 * and writing it into the Vulkan descriptor sets.
 		 */
 		void createDescriptorSet();
 
 	private:
+		/**
+		 * @struct FrameResources
+		 *
+		 * @brief The material buffer of a frame in flight and the data last uploaded to it.
+		 */
+		struct FrameResources {
+			Unique<VulkanBuffer> buffer = nullptr;
+			VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+			std::vector<MaterialData> uploadedData;
+		};
+
+		/**
+		 * @brief Uploads the material data to the buffer of a frame, growing it if needed.
+		 */
+		void upload(uint32_t frameIndex, const std::vector<MaterialData>& materialsData);
+
 		/**
 		 * @brief Converts a Material object into its corresponding GPU-ready MaterialData structure.
 		 *
@@ -105,8 +140,7 @@ namespace PXTEngine {
 		std::vector<Shared<Material>> m_materials;
 		std::unordered_map<ResourceId, uint32_t> m_idToIndex;
 
-		Unique<VulkanBuffer> m_materialsGpuBuffer = nullptr;
-		VkDescriptorSet m_materialDescriptorSet = VK_NULL_HANDLE;
+		std::array<FrameResources, SwapChain::MAX_FRAMES_IN_FLIGHT> m_frames;
 		Shared<DescriptorSetLayout> m_materialDescriptorSetLayout = nullptr;
 	};
 }
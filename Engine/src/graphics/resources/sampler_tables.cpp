@@ -0,0 +1,209 @@
+#include "graphics/resources/sampler_tables.hpp"
+
+namespace PXTEngine {
+
+	// integer hash with a low bias (Wellons), decorrelates the seeds of the scrambles
+	static uint32_t hashUint(uint32_t x) {
+		x ^= x >> 16;
+		x *= 0x7feb352du;
+		x ^= x >> 15;
+		x *= 0x846ca68bu;
+		x ^= x >> 16;
+
+		return x;
+	}
+
+	static uint32_t hashCombine(const uint32_t seed, const uint32_t value) {
+		return hashUint(seed ^ (hashUint(value) + 0x9e3779b9u + (seed << 6) + (seed >> 2)));
+	}
+
+	static uint32_t reverseBits(uint32_t x) {
+		x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+		x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+		x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+		x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+
+		return (x >> 16) | (x << 16);
+	}
+
+	// every bit of the result only depends on the bits below it, the hash is a random permutation
+	// of every subtree of the bits (Laine-Karras, constants of Burley 2020)
+	static uint32_t laineKarrasPermutation(uint32_t x, const uint32_t seed) {
+		x ^= x * 0x3d20adeau;
+		x += seed;
+		x *= (seed >> 16) | 1u;
+		x ^= x * 0x05526c56u;
+		x ^= x * 0x53a22864u;
+
+		return x;
+	}
+
+	// Owen scramble: a bit is flipped depending on the bits above it
+	static uint32_t nestedUniformScramble(const uint32_t x, const uint32_t seed) {
+		return reverseBits(laineKarrasPermutation(reverseBits(x), seed));
+	}
+
+	// second dimension of the Sobol sequence, the first one is the bit reversal of the index (van der Corput)
+	static uint32_t sobolSecondDimension(uint32_t index) {
+		uint32_t result = 0;
+		for (uint32_t v = 1u << 31; index != 0; index >>= 1, v ^= v >> 1) {
+			if (index & 1) {
+				result ^= v;
+			}
+		}
+
+		return result;
+	}
+
+	SobolTable::SobolTable(const uint32_t sampleCount, const uint32_t dimensionCount, const uint32_t seed)
+		: m_sampleCount(sampleCount), m_dimensionCount(dimensionCount) {
+		PXT_PROFILE_FN();
+		PXT_ASSERT(dimensionCount % 2 == 0, "The Sobol table dimensions are generated in pairs");
+
+		m_samples.resize(static_cast<size_t>(sampleCount) * dimensionCount);
+
+		for (uint32_t pair = 0; pair < dimensionCount / 2; pair++) {
+			const uint32_t pairSeed = hashCombine(seed, pair);
+			const uint32_t shuffleSeed = hashCombine(pairSeed, 0);
+			const uint32_t xSeed = hashCombine(pairSeed, 1);
+			const uint32_t ySeed = hashCombine(pairSeed, 2);
+
+			for (uint32_t sample = 0; sample < sampleCount; sample++) {
+				// the scramble of the index only permutes its low bits within a power of two block,
+				// the shuffled prefixes are still aligned blocks of the sequence
+				const uint32_t index = nestedUniformScramble(sample, shuffleSeed);
+
+				uint32_t* values = &m_samples[static_cast<size_t>(sample) * dimensionCount + pair * 2];
+				values[0] = nestedUniformScramble(reverseBits(index), xSeed);
+				values[1] = nestedUniformScramble(sobolSecondDimension(index), ySeed);
+			}
+		}
+	}
+
+	BlueNoiseTexture::BlueNoiseTexture(const uint32_t size, const uint32_t seed)
+		: m_size(size) {
+		PXT_PROFILE_FN();
+		PXT_ASSERT(size > 0, "The blue noise texture can't be empty");
+
+		const uint32_t texelCount = size * size;
+
+		// toroidal gaussian kernel, indexed by the wrapped offset between two texels
+		constexpr float sigma = 1.5f;
+		std::vector<float> kernel(texelCount);
+		for (uint32_t y = 0; y < size; y++) {
+			for (uint32_t x = 0; x < size; x++) {
+				const float dx = static_cast<float>(std::min(x, size - x));
+				const float dy = static_cast<float>(std::min(y, size - y));
+				kernel[y * size + x] = std::exp(-(dx * dx + dy * dy) / (2.0f * sigma * sigma));
+			}
+		}
+
+		// the energy of a texel is the kernel summed over the set texels: high in clusters, low in voids
+		std::vector<uint8_t> pattern(texelCount, 0);
+		std::vector<float> energy(texelCount, 0.0f);
+
+		auto toggle = [&](std::vector<uint8_t>& bits, std::vector<float>& energies, const uint32_t texel) {
+			const float sign = bits[texel] ? -1.0f : 1.0f;
+			bits[texel] ^= 1;
+
+			const uint32_t texelX = texel % size;
+			const uint32_t texelY = texel / size;
+			for (uint32_t y = 0; y < size; y++) {
+				const float* kernelRow = &kernel[((y + size - texelY) % size) * size];
+				float* energyRow = &energies[y * size];
+
+				for (uint32_t x = 0; x < size; x++) {
+					energyRow[x] += sign * kernelRow[(x + size - texelX) % size];
+				}
+			}
+		};
+
+		// tightest cluster among the set texels, or largest void among the unset ones
+		auto findTexel = [&](const std::vector<uint8_t>& bits, const std::vector<float>& energies, const bool cluster) {
+			uint32_t found = 0;
+			float foundEnergy = cluster ? -std::numeric_limits<float>::max() : std::numeric_limits<float>::max();
+
+			for (uint32_t texel = 0; texel < texelCount; texel++) {
+				if (bits[texel] != static_cast<uint8_t>(cluster)) {
+					continue;
+				}
+
+				if (cluster ? energies[texel] > foundEnergy : energies[texel] < foundEnergy) {
+					found = texel;
+					foundEnergy = energies[texel];
+				}
+			}
+
+			return found;
+		};
+
+		// initial binary pattern, a tenth of the texels picked at random (mt19937 is the same everywhere)
+		std::mt19937 random(seed);
+		const uint32_t initialCount = std::max(1u, texelCount / 10);
+		for (uint32_t placed = 0; placed < initialCount;) {
+			const uint32_t texel = static_cast<uint32_t>(random() % texelCount);
+			if (!pattern[texel]) {
+				toggle(pattern, energy, texel);
+				placed++;
+			}
+		}
+
+		// spread the initial pattern: move the tightest cluster to the largest void, until it stays there
+		for (uint32_t iteration = 0; iteration < texelCount; iteration++) {
+			const uint32_t cluster = findTexel(pattern, energy, true);
+			toggle(pattern, energy, cluster);
+
+			const uint32_t largestVoid = findTexel(pattern, energy, false);
+			toggle(pattern, energy, largestVoid);
+
+			if (largestVoid == cluster) {
+				break;
+			}
+		}
+
+		m_ranks.resize(texelCount);
+
+		// ranks below the initial pattern: remove the tightest clusters first
+		{
+			std::vector<uint8_t> bits = pattern;
+			std::vector<float> energies = energy;
+
+			for (uint32_t rank = initialCount; rank-- > 0;) {
+				const uint32_t cluster = findTexel(bits, energies, true);
+				toggle(bits, energies, cluster);
+				m_ranks[cluster] = rank;
+			}
+		}
+
+		// ranks above: fill the largest voids first. Past half of the texels this is also the tightest
+		// cluster of the unset texels, since their energy is the total kernel weight minus this one
+		for (uint32_t rank = initialCount; rank < texelCount; rank++) {
+			const uint32_t largestVoid = findTexel(pattern, energy, false);
+			toggle(pattern, energy, largestVoid);
+			m_ranks[largestVoid] = rank;
+		}
+	}
+
+	uint16_t BlueNoiseTexture::getThreshold(const uint32_t x, const uint32_t y) const {
+		const uint64_t texelCount = static_cast<uint64_t>(m_size) * m_size;
+		return static_cast<uint16_t>(((2 * static_cast<uint64_t>(getRank(x, y)) + 1) << 16) / (2 * texelCount));
+	}
+
+	std::vector<uint8_t> BlueNoiseTexture::getRgba8Texels() const {
+		std::vector<uint8_t> texels(static_cast<size_t>(m_size) * m_size * 4);
+
+		for (uint32_t y = 0; y < m_size; y++) {
+			for (uint32_t x = 0; x < m_size; x++) {
+				const uint16_t threshold = getThreshold(x, y);
+				uint8_t* texel = &texels[(static_cast<size_t>(y) * m_size + x) * 4];
+
+				texel[0] = static_cast<uint8_t>(threshold >> 8);
+				texel[1] = static_cast<uint8_t>(threshold & 0xFF);
+				texel[2] = 0;
+				texel[3] = 0xFF;
+			}
+		}
+
+		return texels;
+	}
+}
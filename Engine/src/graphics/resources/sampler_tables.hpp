@@ -0,0 +1,80 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class SobolTable
+	 *
+	 * @brief Precomputed Owen scrambled Sobol samples for the low discrepancy sampler of the path tracer.
+	 *
+	 * The dimensions are taken two by two: every pair is the 2D Sobol (0, 2)-sequence with its own shuffle of
+	 * the sample indices and its own nested uniform (Owen) scramble of the values (Burley 2020), so the pairs
+	 * are decorrelated from each other while every power of two prefix stays stratified.
+	 *
+	 * Samples are stored sample by sample as 32 bit fixed point values in [0, 1): getSamples()[sample * dimensionCount + dimension].
+	 */
+	class SobolTable {
+	public:
+		static constexpr uint32_t SAMPLE_COUNT = 256;
+		static constexpr uint32_t DIMENSION_COUNT = 32;
+
+		/**
+		 * @param sampleCount The number of samples, a power of two keeps the table stratified as a whole.
+		 * @param dimensionCount The number of dimensions, even.
+		 * @param seed The seed of the scrambles, the same seed always gives the same table.
+		 */
+		SobolTable(uint32_t sampleCount = SAMPLE_COUNT, uint32_t dimensionCount = DIMENSION_COUNT, uint32_t seed = 0);
+
+		uint32_t get(const uint32_t sample, const uint32_t dimension) const { return m_samples[sample * m_dimensionCount + dimension]; }
+
+		uint32_t getSampleCount() const { return m_sampleCount; }
+		uint32_t getDimensionCount() const { return m_dimensionCount; }
+		const std::vector<uint32_t>& getSamples() const { return m_samples; }
+
+	private:
+		uint32_t m_sampleCount = 0;
+		uint32_t m_dimensionCount = 0;
+		std::vector<uint32_t> m_samples;
+	};
+
+	/**
+	 * @class BlueNoiseTexture
+	 *
+	 * @brief Tileable blue noise threshold map, generated with Ulichney's void-and-cluster method.
+	 *
+	 * Every texel gets a rank, the texels of rank below n are the n points spread the most evenly over the
+	 * (toroidal) texture, for every n. The sampler shifts the samples of each pixel by its threshold, which
+	 * moves the error of neighbouring pixels to high frequencies.
+	 */
+	class BlueNoiseTexture {
+	public:
+		static constexpr uint32_t SIZE = 64;
+
+		/**
+		 * @param size The width and height of the texture.
+		 * @param seed The seed of the initial pattern, the same seed always gives the same texture.
+		 */
+		BlueNoiseTexture(uint32_t size = SIZE, uint32_t seed = 0);
+
+		uint32_t getRank(const uint32_t x, const uint32_t y) const { return m_ranks[y * m_size + x]; }
+
+		/**
+		 * @brief Returns the rank of a texel as a 16 bit threshold, in the middle of its interval of [0, 1).
+		 */
+		uint16_t getThreshold(uint32_t x, uint32_t y) const;
+
+		/**
+		 * @brief Returns the texels in RGBA8 linear format: the threshold high byte in red and low byte in green.
+		 */
+		std::vector<uint8_t> getRgba8Texels() const;
+
+		uint32_t getSize() const { return m_size; }
+		const std::vector<uint32_t>& getRanks() const { return m_ranks; }
+
+	private:
+		uint32_t m_size = 0;
+		std::vector<uint32_t> m_ranks;
+	};
+}
@@ -11,61 +11,75 @@ namespace PXTEngine {
 		return createUnique<Texture2D>(context, info, buffer);
 	}
 
+	Unique<Texture2D> Texture2D::create(const ImageInfo& info, const std::span<const uint8_t> data) {
+		Context& context = Application::get().getContext();
+
+		return createUnique<Texture2D>(context, info, data);
+	}
+
 	Texture2D::Texture2D(Context& context, const ImageInfo& info, const Buffer& buffer)
-	: VulkanImage(context, info, buffer) {
-		createTextureImage(info, buffer);
+	: Texture2D(context, info, std::span<const uint8_t>(buffer.bytes, buffer.size)) {}
+
+	Texture2D::Texture2D(Context& context, const ImageInfo& info, const std::span<const uint8_t> data)
+	: VulkanImage(context, info, Buffer()) {
+		createTextureImage(info, data);
 		createTextureImageView();
 		createTextureSampler();
 	}
 
-	void Texture2D::createTextureImage(const ImageInfo& info, const Buffer& buffer) {
-		VkDeviceSize imageSize = info.width * info.height * info.channels;
-		// create a staging buffer visible to the host and copy the pixels to it
-		Unique<VulkanBuffer> stagingBuffer = createUnique<VulkanBuffer>(
-			m_context,
-			imageSize,
-			1,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-		);
-
-		stagingBuffer->map(imageSize);
-		stagingBuffer->writeToBuffer(buffer.bytes, imageSize, 0);
-		stagingBuffer->unmap();
+	void Texture2D::createTextureImage(const ImageInfo& info, const std::span<const uint8_t> data) {
+		// the buffer holds every mip level, tightly packed from the biggest one
+		VkDeviceSize imageSize = 0;
+		std::vector<VkBufferImageCopy> regions;
+
+		for (uint32_t level = 0; level < info.mipLevels; level++) {
+			const uint32_t levelWidth = std::max(1u, info.width >> level);
+			const uint32_t levelHeight = std::max(1u, info.height >> level);
+
+			VkBufferImageCopy region{};
+			region.bufferOffset = imageSize;
+			region.bufferRowLength = 0;
+			region.bufferImageHeight = 0;
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = level;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageOffset = { 0, 0, 0 };
+			region.imageExtent = { levelWidth, levelHeight, 1 };
+			regions.push_back(region);
+
+			imageSize += getImageLevelSize(info.format, levelWidth, levelHeight);
+		}
+
+		if (data.size() < imageSize) {
+			throw std::runtime_error("texture data is smaller than its mip levels");
+		}
 
 		// create an empty vkImage
 		createImage(info.width, info.height,
 			VK_IMAGE_TILING_OPTIMAL,
-			// we want the image to be a transfer destination and sampled to be used in the shaders
-			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+			// we want the image to be a transfer destination and sampled to be used in the shaders,
+			// it is a transfer source for the tools reading it back
+			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
 			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 			m_vkImage, m_imageMemory);
 
-		// we now change the layout of the image for better destination copy performance (VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-		transitionImageLayoutSingleTimeCmd(
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-			VK_PIPELINE_STAGE_TRANSFER_BIT
-		);
-
-		// then we copy the contents of the image (that were inside the stagingBuffer) into the vkImage
-		m_context.copyBufferToImage(
-			stagingBuffer->getBuffer(),
-			m_vkImage,
-			info.width,
-			info.height
-		);
-
-		// finally, we change the image layout again to be accessed from the shaders (VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-		transitionImageLayoutSingleTimeCmd(
-			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-			VK_PIPELINE_STAGE_TRANSFER_BIT,
-			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
-		);
+		VkImageSubresourceRange subresourceRange{};
+		subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		subresourceRange.baseMipLevel = 0;
+		subresourceRange.levelCount = info.mipLevels;
+		subresourceRange.baseArrayLayer = 0;
+		subresourceRange.layerCount = 1;
+
+		// the pixels are copied to the staging ring now, the copy to the vkImage (one region per mip level)
+		// and the transitions to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL are recorded in the open upload batch
+		m_context.getUploader().copyToImage(m_vkImage, data.data(), imageSize, regions, subresourceRange);
+
+		setImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 	}
 
 	void Texture2D::createImage(uint32_t width, uint32_t height, VkImageTiling tiling,
-		VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) {
+		VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, GpuAllocation& imageMemory) {
 
 		VkImageCreateInfo imageInfo{};
 		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -74,7 +88,7 @@ namespace PXTEngine {
 
 		// The number of mip levels (1 means no mip mapping).
 		// A full mipmap chain would be 1 + log2(max(width, height, depth)) levels
-		imageInfo.mipLevels = 1;
+		imageInfo.mipLevels = m_info.mipLevels;
 
 		// The number of layers in the image (1 means that it's a regular image).
 		// Values > 1 are used for array textures (e.g., for cube maps, 3D texture atlases, or layered framebuffers).
@@ -121,7 +135,7 @@ namespace PXTEngine {
 		viewInfo.format = m_imageFormat;
 		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 		viewInfo.subresourceRange.baseMipLevel = 0;
-		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.levelCount = m_info.mipLevels;
 		viewInfo.subresourceRange.baseArrayLayer = 0;
 		viewInfo.subresourceRange.layerCount = 1;
 
@@ -169,7 +183,7 @@ namespace PXTEngine {
 		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 		samplerInfo.mipLodBias = 0.0f;
 		samplerInfo.minLod = 0.0f;
-		samplerInfo.maxLod = 0.0f;
+		samplerInfo.maxLod = static_cast<float>(m_info.mipLevels);
 
 		if (vkCreateSampler(m_context.getDevice(), &samplerInfo, nullptr, &m_sampler) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create texture sampler!");
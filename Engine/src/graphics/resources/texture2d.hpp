@@ -16,9 +16,15 @@ namespace PXTEngine {
 	class Texture2D : public VulkanImage {
 	public:
 		static Unique<Texture2D> create(const ImageInfo& info, const Buffer& buffer);
+		static Unique<Texture2D> create(const ImageInfo& info, std::span<const uint8_t> data);
 
 		Texture2D(Context& context, const ImageInfo& info, const Buffer& buffer);
 
+		/**
+		 * @brief Creates the texture from data that is not owned by a Buffer (e.g. a memory mapped file).
+		 */
+		Texture2D(Context& context, const ImageInfo& info, std::span<const uint8_t> data);
+
 	private:
 
 		/**
@@ -27,15 +33,15 @@ namespace PXTEngine {
 		 * This function creates a Vulkan image and copies the pixel data from the provided buffer to the image.
 		 * It also transitions the image layout to be used as a texture.
 		 *
-		 * @param info The texture information, including width, height, channels
-		 * @param buffer The buffer containing the pixel data
+		 * @param info The texture information, including width, height, channels, format and mip levels
+		 * @param data The pixel (or block) data of every mip level, tightly packed from the biggest one
 		 */
-		void createTextureImage(const ImageInfo& info, const Buffer& buffer);
+		void createTextureImage(const ImageInfo& info, std::span<const uint8_t> data);
 
 		/**
 		 * @brief Creates a Vulkan image.
 		 */
-		void createImage(uint32_t width, uint32_t height, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
+		void createImage(uint32_t width, uint32_t height, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, GpuAllocation& imageMemory);
 
 		/**
 		 * @brief Creates an image view.
@@ -4,7 +4,6 @@ namespace PXTEngine {
 
 	TextureRegistry::TextureRegistry(Context& context)
 		: m_context(context) {
-		m_textureDescriptorSet = VK_NULL_HANDLE;
 		m_textureDescriptorSetLayout = nullptr;
 		m_descriptorAllocator = nullptr;
 	}
@@ -20,6 +19,15 @@ namespace PXTEngine {
 			return 0;
 		}
 
+		if (const auto it = m_idToIndex.find(image->id); it != m_idToIndex.end()) {
+			return it->second;
+		}
+
+		if (m_textures.size() >= MAX_TEXTURE_COUNT) {
+			PXT_ERROR("Texture registry is full ({} textures), the texture is not registered", MAX_TEXTURE_COUNT);
+			return 0;
+		}
+
 		const auto index = static_cast<uint32_t>(m_textures.size());
 		m_textures.push_back(image);
 		m_idToIndex[image->id] = index;
@@ -32,8 +40,16 @@ namespace PXTEngine {
 		return it != m_idToIndex.end() ? it->second : 0;
 	}
 
-	VkDescriptorSet TextureRegistry::getDescriptorSet() {
-		return m_textureDescriptorSet;
+	void TextureRegistry::update(const uint32_t frameIndex) {
+		if (m_writtenCounts[frameIndex] == m_textures.size()) {
+			return;
+		}
+
+		writeDescriptorSet(frameIndex);
+	}
+
+	VkDescriptorSet TextureRegistry::getDescriptorSet(const uint32_t frameIndex) {
+		return m_textureDescriptorSets[frameIndex];
 	}
 
 	VkDescriptorSetLayout TextureRegistry::getDescriptorSetLayout() {
@@ -42,10 +58,20 @@ namespace PXTEngine {
 
 	void TextureRegistry::createDescriptorSet() {
 		m_textureDescriptorSetLayout = DescriptorSetLayout::Builder(m_context)
-			.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, static_cast<uint32_t>(m_textures.size()))
+			.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, MAX_TEXTURE_COUNT)
 			.build();
 
+		for (uint32_t i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+			m_descriptorAllocator->allocate(m_textureDescriptorSetLayout->getDescriptorSetLayout(), m_textureDescriptorSets[i]);
+			writeDescriptorSet(i);
+		}
+	}
+
+	void TextureRegistry::writeDescriptorSet(const uint32_t frameIndex) {
+		PXT_ASSERT(!m_textures.empty(), "The default textures must be registered first");
+
 		std::vector<VkDescriptorImageInfo> imageInfos;
+		imageInfos.reserve(MAX_TEXTURE_COUNT);
 		for (const auto& image : m_textures) {
 			const auto texture = std::static_pointer_cast<Texture2D>(image);
 
@@ -56,10 +82,14 @@ namespace PXTEngine {
 			imageInfos.push_back(imageInfo);
 		}
 
-		m_descriptorAllocator->allocate(m_textureDescriptorSetLayout->getDescriptorSetLayout(), m_textureDescriptorSet);
+		// every descriptor of the binding must be valid, the free slots point to the first texture
+		const VkDescriptorImageInfo fallbackInfo = imageInfos.front();
+		imageInfos.resize(MAX_TEXTURE_COUNT, fallbackInfo);
 
 		DescriptorWriter(m_context, *m_textureDescriptorSetLayout)
 			.writeImages(0, imageInfos.data(), static_cast<uint32_t>(imageInfos.size()))
-			.updateSet(m_textureDescriptorSet);
+			.updateSet(m_textureDescriptorSets[frameIndex]);
+
+		m_writtenCounts[frameIndex] = static_cast<uint32_t>(m_textures.size());
 	}
 }
@@ -5,6 +5,7 @@
 #include "resources/types/image.hpp"
 #include "graphics/descriptors/descriptors.hpp"
 #include "graphics/resources/texture2d.hpp"
+#include "graphics/swap_chain.hpp"
 
 namespace PXTEngine {
 
@@ -12,9 +13,15 @@ namespace PXTEngine {
 	 * @class TextureRegistry
 	 *
 	 * @brief Manages a collection of textures and their binding to GPU descriptor sets.
+	 *
+	 * Textures can be added at any time, e.g. when a background import ends: there is a descriptor
+	 * set per frame in flight, with room for MAX_TEXTURE_COUNT textures, and update rewrites the set
+	 * of a frame once that frame is no longer in use by the GPU.
 	 */
 	class TextureRegistry {
 	public:
+		static constexpr uint32_t MAX_TEXTURE_COUNT = 1024;
+
 		explicit TextureRegistry(Context& context);
 
 		/**
@@ -28,7 +35,8 @@ namespace PXTEngine {
 		 * @brief Adds a texture to the registry.
 		 *
 		 * Only 2D textures (Texture2D) are supported. 
-		 * If the provided image is not a Texture2D, the function returns 0.
+		 * If the provided image is not a Texture2D, or the registry is full, the function returns 0.
+		 * The texture is visible to the shaders from the next update of each frame.
 		 *
 		 * @param image Shared pointer to the image.
 		 *
@@ -50,11 +58,22 @@ namespace PXTEngine {
 		}
 
 		/**
-		 * @brief Returns the Vulkan descriptor set that holds all texture bindings.
+		 * @brief Writes the textures added since the last update of the frame into its descriptor set.
+		 *
+		 * Must be called once the frame is no longer in use by the GPU, before recording it.
+		 *
+		 * @param frameIndex Index of the frame in flight.
+		 */
+		void update(uint32_t frameIndex);
+
+		/**
+		 * @brief Returns the Vulkan descriptor set that holds all texture bindings for a frame.
+		 *
+		 * @param frameIndex Index of the frame in flight.
 		 *
 		 * @return Vulkan descriptor set.
 		 */
-		VkDescriptorSet getDescriptorSet();
+		VkDescriptorSet getDescriptorSet(uint32_t frameIndex);
 
 		/**
 		 * @brief Returns the Vulkan descriptor set layout used for texture bindings.
@@ -64,20 +83,28 @@ namespace PXTEngine {
 		VkDescriptorSetLayout getDescriptorSetLayout();
 
 		/**
-		 * @brief Creates a Vulkan descriptor set for all registered textures.
+		 * @brief Creates the Vulkan descriptor sets for the textures, one per frame in flight.
 		 *
-		 * This function constructs a descriptor set layout with a combined image sampler binding,
-		 * prepares image info for each texture, allocates the descriptor set, and writes all image bindings to it.
+		 * This function constructs a descriptor set layout with a combined image sampler binding of
+		 * MAX_TEXTURE_COUNT descriptors, allocates the descriptor sets and writes the registered textures to them.
 		 */
 		void createDescriptorSet();
 
 	private:
+		/**
+		 * @brief Writes every texture into the descriptor set of a frame, the unused slots get the first texture.
+		 */
+		void writeDescriptorSet(uint32_t frameIndex);
+
 		std::vector<Shared<Image>> m_textures;
 		std::unordered_map<ResourceId, uint32_t> m_idToIndex;
 
 		Context& m_context;
 		Shared<DescriptorAllocatorGrowable> m_descriptorAllocator;
 		Shared<DescriptorSetLayout> m_textureDescriptorSetLayout;
-		VkDescriptorSet m_textureDescriptorSet;
+		std::array<VkDescriptorSet, SwapChain::MAX_FRAMES_IN_FLIGHT> m_textureDescriptorSets{};
+
+		// number of textures written in the descriptor set of each frame
+		std::array<uint32_t, SwapChain::MAX_FRAMES_IN_FLIGHT> m_writtenCounts{};
 	};
 }
@@ -0,0 +1,74 @@
+#include "graphics/resources/tlas_change_tracker.hpp"
+
+namespace PXTEngine {
+
+	void TLASChangeTracker::beginWalk() {
+		PXT_ASSERT(!m_walking, "Walk already started");
+
+		m_walking = true;
+		m_cursor = 0;
+		m_generation++;
+	}
+
+	bool TLASChangeTracker::track(const uint64_t key, const glm::mat4& transform, const uint64_t geometry, const uint64_t content) {
+		PXT_ASSERT(m_walking, "Instance tracked outside of a walk");
+
+		const uint32_t slotIndex = m_cursor++;
+
+		if (slotIndex == m_slots.size()) {
+			m_slots.push_back({ key, geometry, content, transform, m_generation });
+			m_structureGeneration = m_generation;
+			m_lastChangeGeneration = m_generation;
+			return true;
+		}
+
+		Slot& slot = m_slots[slotIndex];
+
+		if (slot.key != key || slot.geometry != geometry) {
+			slot = { key, geometry, content, transform, m_generation };
+			m_structureGeneration = m_generation;
+			m_lastChangeGeneration = m_generation;
+			return true;
+		}
+
+		if (slot.transform != transform || slot.content != content) {
+			slot.transform = transform;
+			slot.content = content;
+			slot.changedGeneration = m_generation;
+			m_lastChangeGeneration = m_generation;
+			return true;
+		}
+
+		return false;
+	}
+
+	void TLASChangeTracker::endWalk() {
+		PXT_ASSERT(m_walking, "Walk not started");
+
+		m_walking = false;
+
+		if (m_cursor != m_slots.size()) {
+			m_slots.resize(m_cursor);
+			m_structureGeneration = m_generation;
+			m_lastChangeGeneration = m_generation;
+		}
+	}
+
+	bool TLASChangeTracker::collectChangedSlots(const uint64_t since, std::vector<uint32_t>& slots) const {
+		slots.clear();
+
+		if (since < m_structureGeneration) {
+			slots.resize(m_slots.size());
+			std::iota(slots.begin(), slots.end(), 0);
+			return false;
+		}
+
+		for (uint32_t i = 0; i < m_slots.size(); i++) {
+			if (m_slots[i].changedGeneration > since) {
+				slots.push_back(i);
+			}
+		}
+
+		return true;
+	}
+}
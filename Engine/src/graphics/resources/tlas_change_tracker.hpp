@@ -0,0 +1,91 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class TLASChangeTracker
+	 *
+	 * @brief Tracks which TLAS instance slots changed between walks of the scene.
+	 *
+	 * Every frame the instances are given to track in the order of the scene walk, the n-th
+	 * instance tracked takes slot n. The tracker keeps the last transform and content of every
+	 * slot and stamps a slot with the generation of the walk that changed it, so each consumer
+	 * (e.g. the TLAS of a frame in flight) can catch up from the generation it last synced.
+	 *
+	 * A different instance taking a slot, the instance count changing or the geometry of an
+	 * instance changing (its mesh, so its BLAS) are structural changes: the slots no longer
+	 * describe the same instances and everything must be rewritten and rebuilt.
+	 * A transform or content change (its material, its tint...) only dirties its slot, which
+	 * allows the TLAS to be refit.
+	 *
+	 * Components are modified in place through references, so changes are detected by comparing
+	 * with the previous walk instead of relying on registry update signals.
+	 */
+	class TLASChangeTracker {
+	public:
+		/**
+		 * @brief Starts a new walk, the following calls to track fill the slots from the first one.
+		 */
+		void beginWalk();
+
+		/**
+		 * @brief Tracks the next instance of the walk.
+		 *
+		 * @param key Identifies the instance across walks (e.g. the entity).
+		 * @param transform The object to world transform of the instance.
+		 * @param geometry Identifies the BLAS of the instance (e.g. the mesh).
+		 * @param content Hash of everything else written for the instance (material, tint...).
+		 *
+		 * @return true if the slot changed in this walk and must be rewritten.
+		 */
+		bool track(uint64_t key, const glm::mat4& transform, uint64_t geometry, uint64_t content);
+
+		/**
+		 * @brief Ends the walk, instances not tracked in it are removed.
+		 */
+		void endWalk();
+
+		/**
+		 * @brief Collects the slots changed after a generation.
+		 *
+		 * @param since The generation the caller last synced at, 0 if it never did.
+		 * @param slots Filled with the slots to rewrite, in increasing order.
+		 *
+		 * @return false if the structure changed after since: the TLAS must be rebuilt and slots
+		 *         holds every slot.
+		 */
+		bool collectChangedSlots(uint64_t since, std::vector<uint32_t>& slots) const;
+
+		uint64_t getGeneration() const { return m_generation; }
+
+		/**
+		 * @brief The generation of the last walk that added, removed or replaced instances.
+		 */
+		uint64_t getStructureGeneration() const { return m_structureGeneration; }
+
+		/**
+		 * @brief The generation of the last walk that changed anything, e.g. to restart an accumulation.
+		 */
+		uint64_t getLastChangeGeneration() const { return m_lastChangeGeneration; }
+		uint32_t getInstanceCount() const { return static_cast<uint32_t>(m_slots.size()); }
+
+	private:
+		struct Slot {
+			uint64_t key = 0;
+			uint64_t geometry = 0;
+			uint64_t content = 0;
+			glm::mat4 transform{1.0f};
+			uint64_t changedGeneration = 0;
+		};
+
+		std::vector<Slot> m_slots;
+		uint32_t m_cursor = 0;
+		bool m_walking = false;
+
+		uint64_t m_generation = 0;
+		uint64_t m_structureGeneration = 0;
+		uint64_t m_lastChangeGeneration = 0;
+	};
+}
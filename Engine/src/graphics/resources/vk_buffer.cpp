@@ -22,26 +22,29 @@ namespace PXTEngine {
           m_memoryPropertyFlags{memoryPropertyFlags} {
         m_alignmentSize = getAlignment(instanceSize, minOffsetAlignment);
         m_bufferSize = m_alignmentSize * instanceCount;
-        context.createBuffer(m_bufferSize, usageFlags, memoryPropertyFlags, m_buffer, m_memory);
+        context.createBuffer(m_bufferSize, usageFlags, memoryPropertyFlags, m_buffer, m_allocation);
     }
 
     VulkanBuffer::~VulkanBuffer() {
         unmap();
         vkDestroyBuffer(m_context.getDevice(), m_buffer, nullptr);
-        vkFreeMemory(m_context.getDevice(), m_memory, nullptr);
+        m_context.getAllocator().free(m_allocation);
     }
 
     VkResult VulkanBuffer::map(VkDeviceSize size, VkDeviceSize offset) {
-        PXT_ASSERT(m_buffer && m_memory, "Called map on buffer before create");
+        PXT_ASSERT(m_buffer && m_allocation.isValid(), "Called map on buffer before create");
 
-        return vkMapMemory(m_context.getDevice(), m_memory, offset, size, 0, &m_mapped);
+        // the memory is shared with other resources, so it is mapped once by the allocator
+        if (!m_allocation.mapped) {
+            return VK_ERROR_MEMORY_MAP_FAILED;
+        }
+
+        m_mapped = static_cast<uint8_t*>(m_allocation.mapped) + offset;
+        return VK_SUCCESS;
     }
 
     void VulkanBuffer::unmap() {
-        if (m_mapped) {
-            vkUnmapMemory(m_context.getDevice(), m_memory);
-            m_mapped = nullptr;
-        }
+        m_mapped = nullptr;
     }
 
 	// TODO: add "if NDEBUG ... we avoid checks"
@@ -65,21 +68,11 @@ namespace PXTEngine {
 	}
 
     VkResult VulkanBuffer::flush(VkDeviceSize size, VkDeviceSize offset) {
-        VkMappedMemoryRange mappedRange = {};
-        mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mappedRange.memory = m_memory;
-        mappedRange.offset = offset;
-        mappedRange.size = size;
-        return vkFlushMappedMemoryRanges(m_context.getDevice(), 1, &mappedRange);
+        return m_context.getAllocator().flush(m_allocation, offset, size);
     }
 
     VkResult VulkanBuffer::invalidate(VkDeviceSize size, VkDeviceSize offset) {
-        VkMappedMemoryRange mappedRange = {};
-        mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mappedRange.memory = m_memory;
-        mappedRange.offset = offset;
-        mappedRange.size = size;
-        return vkInvalidateMappedMemoryRanges(m_context.getDevice(), 1, &mappedRange);
+        return m_context.getAllocator().invalidate(m_allocation, offset, size);
     }
 
     VkDescriptorBufferInfo VulkanBuffer::descriptorInfo(VkDeviceSize size, VkDeviceSize offset) {
@@ -48,6 +48,8 @@ namespace PXTEngine {
         /**
          * @brief Map a memory range of this buffer. If successful, mapped points to the specified buffer range.
          *
+         * Host visible memory is kept mapped by the GpuAllocator, so this only exposes the range.
+         *
          * @param size (Optional) The size of the memory to map. Defaults to the entire buffer size.
          *             Pass VK_WHOLE_SIZE to map the complete buffer range.
          * @param offset (Optional) The offset from the beginning of the buffer to start mapping.
@@ -216,7 +218,7 @@ namespace PXTEngine {
         Context& m_context;
         void* m_mapped = nullptr;
         VkBuffer m_buffer = VK_NULL_HANDLE;
-        VkDeviceMemory m_memory = VK_NULL_HANDLE;
+        GpuAllocation m_allocation{};
 
         VkDeviceSize m_bufferSize;
         uint32_t m_instanceCount;
@@ -1,29 +1,17 @@
 #include "graphics/resources/vk_image.hpp"
 
+#include "graphics/resources/vk_buffer.hpp"
+
 namespace PXTEngine {
 	VulkanImage::VulkanImage(Context& context, const ImageInfo& info, const Buffer& buffer) :
 	m_context(context),
 	m_info(info) {
 		// set other members as VK_NULL_HANDLE
 		m_vkImage = VK_NULL_HANDLE;
-		m_imageMemory = VK_NULL_HANDLE;
 		m_imageView = VK_NULL_HANDLE;
 		m_sampler = VK_NULL_HANDLE;
 
-		switch (info.format)
-		{
-		case RGB8_LINEAR:
-			m_imageFormat = VK_FORMAT_R8G8B8_UNORM;
-			break;
-		case RGBA8_LINEAR:
-			m_imageFormat = VK_FORMAT_R8G8B8A8_UNORM;
-			break;
-		case RGB8_SRGB:
-			m_imageFormat = VK_FORMAT_R8G8B8_SRGB;
-			break;
-		case RGBA8_SRGB:
-			m_imageFormat = VK_FORMAT_R8G8B8A8_SRGB;
-		}
+		m_imageFormat = pxtToVulkanImageFormat(info.format);
 	}
 
 	VulkanImage::VulkanImage(Context& context, const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags memoryFlags)
@@ -32,12 +20,51 @@ namespace PXTEngine {
 		m_context.createImageWithInfo(imageInfo, memoryFlags, m_vkImage, m_imageMemory);
 	}
 
+	Shared<VulkanImage> VulkanImage::createStorageImage2D(Context& context, const VkExtent2D extent, const VkFormat format) {
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.extent = { extent.width, extent.height, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.format = format;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+		auto image = createShared<VulkanImage>(context, imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		image->m_imageFormat = format;
+
+		image->transitionImageLayoutSingleTimeCmd(
+			VK_IMAGE_LAYOUT_GENERAL,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			VK_PIPELINE_STAGE_ALL_COMMANDS_BIT
+		);
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = image->getVkImage();
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = format;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+
+		image->createImageView(viewInfo);
+
+		return image;
+	}
+
 	VulkanImage::~VulkanImage() {
 		vkDestroySampler(m_context.getDevice(), m_sampler, nullptr);
 		vkDestroyImageView(m_context.getDevice(), m_imageView, nullptr);
 
 		vkDestroyImage(m_context.getDevice(), m_vkImage, nullptr);
-		vkFreeMemory(m_context.getDevice(), m_imageMemory, nullptr);
+		m_context.getAllocator().free(m_imageMemory);
 	}
 
 	VulkanImage& VulkanImage::createImageView(const VkImageViewCreateInfo& viewInfo) {
@@ -336,4 +363,89 @@ namespace PXTEngine {
 		// command buffer
 		setImageLayout(newLayout);
 	}
+
+	std::vector<uint16_t> VulkanImage::readTexels(const uint32_t layer) {
+		VkFormatProperties formatProperties;
+		vkGetPhysicalDeviceFormatProperties(m_context.getPhysicalDevice(), m_imageFormat, &formatProperties);
+
+		if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_SRC_BIT)) {
+			throw std::runtime_error("image format can't be blitted to be read back!");
+		}
+
+		const uint32_t width = m_info.width;
+		const uint32_t height = m_info.height;
+
+		VkImageCreateInfo decodedInfo{};
+		decodedInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		decodedInfo.imageType = VK_IMAGE_TYPE_2D;
+		decodedInfo.format = VK_FORMAT_R16G16B16A16_SFLOAT; // blit destination support is mandatory for it
+		decodedInfo.extent = { width, height, 1 };
+		decodedInfo.mipLevels = 1;
+		decodedInfo.arrayLayers = 1;
+		decodedInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		decodedInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		decodedInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		decodedInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		decodedInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		VulkanImage decoded(m_context, decodedInfo);
+
+		VulkanBuffer readbackBuffer(
+			m_context,
+			sizeof(uint16_t) * 4,
+			width * height,
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		);
+
+		VkImageSubresourceRange layerRange{};
+		layerRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		layerRange.baseMipLevel = 0;
+		layerRange.levelCount = 1;
+		layerRange.baseArrayLayer = layer;
+		layerRange.layerCount = 1;
+
+		const VkImageLayout originalLayout = m_currentLayout;
+
+		VkCommandBuffer commandBuffer = m_context.beginSingleTimeCommands();
+
+		transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, layerRange);
+		decoded.transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+		VkImageBlit blit{};
+		blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, layer, 1 };
+		blit.srcOffsets[1] = { static_cast<int32_t>(width), static_cast<int32_t>(height), 1 };
+		blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		blit.dstOffsets[1] = blit.srcOffsets[1];
+
+		vkCmdBlitImage(commandBuffer,
+			m_vkImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			decoded.getVkImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			1, &blit, VK_FILTER_NEAREST);
+
+		decoded.transitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+		VkBufferImageCopy region{};
+		region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.imageExtent = { width, height, 1 };
+
+		vkCmdCopyImageToBuffer(commandBuffer, decoded.getVkImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			readbackBuffer.getBuffer(), 1, &region);
+
+		transitionImageLayout(commandBuffer, originalLayout,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, layerRange);
+
+		m_context.endSingleTimeCommands(commandBuffer);
+
+		std::vector<uint16_t> texels(static_cast<size_t>(width) * height * 4);
+
+		readbackBuffer.map();
+		std::memcpy(texels.data(), readbackBuffer.getMappedMemory(), texels.size() * sizeof(uint16_t));
+		readbackBuffer.unmap();
+
+		return texels;
+	}
 }
@@ -16,6 +16,14 @@ namespace PXTEngine {
 			return  VK_FORMAT_R8G8B8_SRGB;
 		case RGBA8_SRGB:
 			return  VK_FORMAT_R8G8B8A8_SRGB;
+		case BC4_LINEAR:
+			return VK_FORMAT_BC4_UNORM_BLOCK;
+		case BC5_LINEAR:
+			return VK_FORMAT_BC5_UNORM_BLOCK;
+		case BC7_LINEAR:
+			return VK_FORMAT_BC7_UNORM_BLOCK;
+		case BC7_SRGB:
+			return VK_FORMAT_BC7_SRGB_BLOCK;
 		}
 
 		return VK_FORMAT_R8G8B8A8_SRGB;
@@ -31,6 +39,14 @@ namespace PXTEngine {
 			return  RGB8_SRGB;
 		case VK_FORMAT_R8G8B8A8_SRGB:
 			return  RGBA8_SRGB;
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+			return BC4_LINEAR;
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+			return BC5_LINEAR;
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+			return BC7_LINEAR;
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			return BC7_SRGB;
 		default:
 			return RGBA8_SRGB;
 		}
@@ -52,6 +68,17 @@ namespace PXTEngine {
 
 		~VulkanImage() override;
 
+		/**
+		 * @brief Creates a 2D image read and written by shaders as a storage image.
+		 *
+		 * The image is left in VK_IMAGE_LAYOUT_GENERAL with a view of its only mip level; its content is undefined.
+		 *
+		 * @param context The Vulkan context.
+		 * @param extent The size of the image.
+		 * @param format The format of the texels, it has to support storage usage.
+		 */
+		static Shared<VulkanImage> createStorageImage2D(Context& context, VkExtent2D extent, VkFormat format);
+
 		VulkanImage(const VulkanImage&) = delete;
 		VulkanImage& operator=(const VulkanImage&) = delete;
 		VulkanImage(VulkanImage&&) = delete;
@@ -123,6 +150,17 @@ namespace PXTEngine {
 		 */
 		void transitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout, VkPipelineStageFlags sourceStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VkPipelineStageFlags destinationStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, std::optional<VkImageSubresourceRange> subresourceRange = std::nullopt);
 
+		/**
+		 * @brief Reads the biggest mip level of a layer back to the host, decoded to linear RGBA half floats.
+		 *
+		 * The level is blitted to a RGBA16F image, so compressed and sRGB formats come back as the
+		 * values a shader samples. It waits for the device, it is meant for tools, not for the frame loop.
+		 *
+		 * @param layer The array layer (or cube face) to read.
+		 * @return Four half floats per texel, row by row.
+		 */
+		std::vector<uint16_t> readTexels(uint32_t layer = 0);
+
 
 	protected:
 		Context& m_context;
@@ -131,7 +169,7 @@ namespace PXTEngine {
 
 		ImageInfo m_info;
 		VkImage m_vkImage; // the raw image pixels
-		VkDeviceMemory m_imageMemory; // the memory occupied by the image
+		GpuAllocation m_imageMemory{}; // the memory occupied by the image
 		VkImageView m_imageView; // an abstraction to view the same raw image in different "ways"
 		VkSampler m_sampler; // an abstraction (and tool) to help fragment shader pick the right color and
 									// apply useful transformations (e.g. bilinear filtering, anisotropic filtering etc.)
@@ -1,109 +1,87 @@
 #include "graphics/resources/vk_mesh.hpp"
 
 #include "application.hpp"
+#include "graphics/resources/vk_buffer.hpp"
 
 namespace PXTEngine {
 
-    Unique<VulkanMesh> VulkanMesh::create(std::vector<Mesh::Vertex>& vertices, 
-        std::vector<uint32_t>& indices) {
+    Unique<VulkanMesh> VulkanMesh::create(std::span<const Mesh::Vertex> vertices,
+        std::span<const uint32_t> indices) {
         Context& context = Application::get().getContext();
 
         return createUnique<VulkanMesh>(context, vertices, indices);
     }
 
-    VulkanMesh::VulkanMesh(Context& context, std::vector<Mesh::Vertex>& vertices, 
-        std::vector<uint32_t>& indices)
-        : m_context(context) {
-        createVertexBuffers(vertices);
-        createIndexBuffers(indices);
-    }
-
-    VulkanMesh::~VulkanMesh() = default;
-
-    void VulkanMesh::createVertexBuffers(std::vector<Mesh::Vertex>& vertices) {
+    VulkanMesh::VulkanMesh(Context& context, std::span<const Mesh::Vertex> vertices,
+        std::span<const uint32_t> indices)
+        : m_context(context), m_geometryArena(context.getGeometryArena()) {
         m_vertexCount = static_cast<uint32_t>(vertices.size());
 
         PXT_ASSERT(m_vertexCount >= 3, "Vertex count must be at least 3");
 
-        VkDeviceSize bufferSize = sizeof(vertices[0]) * m_vertexCount;
+        for (const Mesh::Vertex& vertex : vertices) {
+            m_localBounds.grow(glm::vec3(vertex.position));
+        }
+
+        // every mesh is indexed in the arena, a mesh without indices draws its vertices in order
+        std::vector<uint32_t> sequentialIndices;
+        if (indices.empty()) {
+            sequentialIndices.resize(m_vertexCount);
+            std::iota(sequentialIndices.begin(), sequentialIndices.end(), 0u);
+            indices = sequentialIndices;
+        }
+
+        m_indexCount = static_cast<uint32_t>(indices.size());
+        m_geometryHandle = m_geometryArena.allocate(vertices, indices);
+    }
+
+    VulkanMesh::~VulkanMesh() {
+        m_geometryArena.free(m_geometryHandle);
+    }
 
-        uint32_t vertexSize = sizeof(vertices[0]);
+    void VulkanMesh::readGeometry(std::vector<Mesh::Vertex>& vertices, std::vector<uint32_t>& indices) const {
+        const GeometryRange& range = getGeometryRange();
+        const VkDeviceSize vertexBytes = sizeof(Mesh::Vertex) * range.vertexCount;
+        const VkDeviceSize indexBytes = sizeof(uint32_t) * range.indexCount;
 
-        VulkanBuffer stagingBuffer{
+        // a single host visible buffer receives both, the indices after the vertices
+        VulkanBuffer readbackBuffer(
             m_context,
-            vertexSize,
-            m_vertexCount, 
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
+            vertexBytes + indexBytes,
+            1,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-        };
-
-        stagingBuffer.map();
-        stagingBuffer.writeToBuffer((void*) vertices.data());
-
-        m_vertexBuffer = createUnique<VulkanBuffer>(
-            m_context, 
-            vertexSize,
-            m_vertexCount, 
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
-            VK_BUFFER_USAGE_TRANSFER_DST_BIT  |
-            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |                           // to create BLASes
-            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, // to create BLASes
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
         );
 
-        m_context.copyBuffer(stagingBuffer.getBuffer(), m_vertexBuffer->getBuffer(), bufferSize);
-    }
+        VkCommandBuffer commandBuffer = m_context.beginSingleTimeCommands();
 
-    void VulkanMesh::createIndexBuffers(std::vector<uint32_t>& indices) {
-        m_indexCount = static_cast<uint32_t>(indices.size());
-        m_hasIndexBuffer = m_indexCount > 0;
+        VkBufferCopy vertexRegion{ sizeof(Mesh::Vertex) * range.firstVertex, 0, vertexBytes };
+        vkCmdCopyBuffer(commandBuffer, m_geometryArena.getVertexBuffer(), readbackBuffer.getBuffer(), 1, &vertexRegion);
 
-        if (!m_hasIndexBuffer) return;
+        VkBufferCopy indexRegion{ sizeof(uint32_t) * range.firstIndex, vertexBytes, indexBytes };
+        vkCmdCopyBuffer(commandBuffer, m_geometryArena.getIndexBuffer(), readbackBuffer.getBuffer(), 1, &indexRegion);
 
-        VkDeviceSize bufferSize = sizeof(indices[0]) * m_indexCount;
-        uint32_t indexSize = sizeof(indices[0]);
+        m_context.endSingleTimeCommands(commandBuffer);
 
-        VulkanBuffer stagingBuffer{
-            m_context,
-            indexSize,
-            m_indexCount, 
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-        };
-
-        stagingBuffer.map();
-        stagingBuffer.writeToBuffer((void*)indices.data());
-
-        m_indexBuffer = createUnique<VulkanBuffer>(
-            m_context, 
-            indexSize, 
-            m_indexCount, 
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
-            VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |                           // to create BLASes
-            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, // to create BLASes
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-        );
+        readbackBuffer.map();
+        const auto* data = static_cast<const uint8_t*>(readbackBuffer.getMappedMemory());
 
-        m_context.copyBuffer(stagingBuffer.getBuffer(), m_indexBuffer->getBuffer(), bufferSize);
+        vertices.resize(range.vertexCount);
+        std::memcpy(vertices.data(), data, vertexBytes);
+
+        indices.resize(range.indexCount);
+        std::memcpy(indices.data(), data + vertexBytes, indexBytes);
+
+        readbackBuffer.unmap();
     }
 
     void VulkanMesh::draw(VkCommandBuffer commandBuffer) {
-        if (m_hasIndexBuffer) {
-            vkCmdDrawIndexed(commandBuffer, m_indexCount, 1, 0, 0, 0);
-        } else {
-            vkCmdDraw(commandBuffer, m_vertexCount, 1, 0, 0);
-        }
+        const GeometryRange& range = getGeometryRange();
+        vkCmdDrawIndexed(commandBuffer, range.indexCount, 1, range.firstIndex, static_cast<int32_t>(range.firstVertex), 0);
     }
 
     void VulkanMesh::bind(VkCommandBuffer commandBuffer) {
-        VkBuffer buffers[] = {m_vertexBuffer->getBuffer()};
-        VkDeviceSize offsets[] = {0};
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
-
-        if (m_hasIndexBuffer) {
-            vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
-        }
+        m_geometryArena.bind(commandBuffer);
     }
 
     std::vector<VkVertexInputBindingDescription> VulkanMesh::getVertexBindingDescriptions() {
@@ -3,7 +3,8 @@
 #include "core/pch.hpp"
 #include "graphics/context/context.hpp"
 #include "resources/types/mesh.hpp"
-#include "graphics/resources/vk_buffer.hpp"
+#include "graphics/memory/geometry_arena.hpp"
+#include "scene/spatial/aabb.hpp"
 
 namespace PXTEngine {
 
@@ -23,9 +24,18 @@ namespace PXTEngine {
          */
         static std::vector<VkVertexInputAttributeDescription> getVertexAttributeDescriptions();
 
-        static Unique<VulkanMesh> create(std::vector<Mesh::Vertex>& vertices, std::vector<uint32_t>& indices);
+        /**
+         * @brief Creates a mesh and uploads its vertices and indices to the GeometryArena of the context.
+         *
+         * The spans can point to any host memory (e.g. a std::vector or a memory mapped
+         * cooked mesh file), they are copied straight into the staging buffers.
+         *
+         * @param vertices The vertices of the mesh.
+         * @param indices The indices of the mesh (can be empty, the vertices are then drawn in order).
+         */
+        static Unique<VulkanMesh> create(std::span<const Mesh::Vertex> vertices, std::span<const uint32_t> indices);
 
-        VulkanMesh(Context& context, std::vector<Mesh::Vertex>& vertices, std::vector<uint32_t>& indices);
+        VulkanMesh(Context& context, std::span<const Mesh::Vertex> vertices, std::span<const uint32_t> indices);
 
         ~VulkanMesh() override;
 
@@ -33,19 +43,31 @@ namespace PXTEngine {
         VulkanMesh& operator=(const VulkanMesh&) = delete;
 
         /**
-         * @brief Binds the model's vertex and index buffers to a command buffer.
+         * @brief Binds the vertex and index buffers of the geometry arena, shared by every mesh.
+         *
+         * Passes drawing many meshes should bind the arena once, see GeometryArena::bind.
          * 
          * @param commandBuffer The Vulkan command buffer.
          */
         void bind(VkCommandBuffer commandBuffer);
         
         /**
-         * @brief Draws the model using the bound buffers.
+         * @brief Draws the model from its ranges of the bound geometry arena.
          * 
          * @param commandBuffer The Vulkan command buffer.
          */
         void draw(VkCommandBuffer commandBuffer);
 
+        /**
+         * @brief Reads the vertices and indices back from device memory.
+         *
+         * It waits for the device, it is meant for tools (e.g. the CPU reference renderer), not for the frame loop.
+         *
+         * @param vertices Filled with the vertices of the mesh.
+         * @param indices Filled with the indices of the mesh, relative to its first vertex.
+         */
+        void readGeometry(std::vector<Mesh::Vertex>& vertices, std::vector<uint32_t>& indices) const;
+
         const uint32_t getVertexCount() const override {
 			return m_vertexCount;
         }
@@ -54,38 +76,54 @@ namespace PXTEngine {
 			return m_indexCount;
         }
 
-		VkDeviceAddress getVertexBufferDeviceAddress() const {
-            return m_vertexBuffer->getDeviceAddress();
-		}
+        /**
+         * @brief Returns the object space bounds of the vertices.
+         */
+        const Aabb& getLocalBounds() const {
+            return m_localBounds;
+        }
 
-        VkDeviceAddress getIndexBufferDeviceAddress() const {
-            return m_indexBuffer->getDeviceAddress();
+        /**
+         * @brief Returns the handle of the mesh ranges, dense and unique among the live meshes.
+         */
+        GeometryArena::Handle getGeometryHandle() const {
+            return m_geometryHandle;
         }
 
-        Type getType() const override {
-            return Type::Mesh;
+        /**
+         * @brief Returns where the mesh is in the geometry arena, it changes when the arena is compacted.
+         */
+        const GeometryRange& getGeometryRange() const {
+            return m_geometryArena.getRange(m_geometryHandle);
         }
 
-    private:
         /**
-         * @brief Creates and allocates vertex buffers.
+         * @brief Returns the device address of the first vertex of the mesh, to build its BLAS.
          */
-        void createVertexBuffers(std::vector<Mesh::Vertex>& vertices);
+        VkDeviceAddress getVertexBufferDeviceAddress() const {
+            return m_geometryArena.getVertexBufferDeviceAddress() + sizeof(Mesh::Vertex) * getGeometryRange().firstVertex;
+        }
 
         /**
-         * @brief Creates and allocates index buffers.
+         * @brief Returns the device address of the first index of the mesh, to build its BLAS.
          */
-        void createIndexBuffers(std::vector<uint32_t>& indices);
+        VkDeviceAddress getIndexBufferDeviceAddress() const {
+            return m_geometryArena.getIndexBufferDeviceAddress() + sizeof(uint32_t) * getGeometryRange().firstIndex;
+        }
 
+        Type getType() const override {
+            return Type::Mesh;
+        }
+
+    private:
         Context& m_context;
+        GeometryArena& m_geometryArena;
+        GeometryArena::Handle m_geometryHandle = GeometryArena::INVALID_HANDLE;
 
 		float m_tilingFactor = 1.0f;
+        Aabb m_localBounds;
 
-        Unique<VulkanBuffer> m_vertexBuffer;
         uint32_t m_vertexCount;
-
-        bool m_hasIndexBuffer = false;
-        Unique<VulkanBuffer> m_indexBuffer;
         uint32_t m_indexCount;
     };
 }
@@ -57,76 +57,91 @@ namespace PXTEngine {
             }
         }
 
+		createDistribution(pixels);
+
 		VkDeviceSize faceImageSizes = m_size * m_size * 4;
-        VkDeviceSize totalImageSize = faceImageSizes * 6;
 
         m_cubeMap = createUnique<CubeMap>(
             m_context, 
             m_size, 
             format,
-            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
         );
 
-        VulkanBuffer stagingBuffer(
-            m_context,
-            totalImageSize,
-            1, // instance count
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-        );
-        stagingBuffer.map();
+        // every face is uploaded to its own layer, straight from the decoded pixels
+        for (uint32_t i = 0; i < 6; ++i) {
+            VkImageSubresourceRange faceSubresourceRange{};
+            faceSubresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            faceSubresourceRange.baseMipLevel = 0;
+            faceSubresourceRange.levelCount = 1;
+            faceSubresourceRange.baseArrayLayer = i;
+            faceSubresourceRange.layerCount = 1;
+
+            VkBufferImageCopy region{};
+            region.bufferOffset = 0;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = 0;
+            region.imageSubresource.baseArrayLayer = i;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = { 0, 0, 0 };
+            region.imageExtent = { m_size, m_size, 1 };
+
+            m_context.getUploader().copyToImage(
+                m_cubeMap->getVkImage(),
+                pixels[i],
+                faceImageSizes,
+                std::span(&region, 1),
+                faceSubresourceRange
+            );
 
-        VkDeviceSize currentOffset = 0;
-        for (int i = 0; i < 6; ++i) {
-            stagingBuffer.writeToBuffer((void*) pixels[i], faceImageSizes, currentOffset);
             stbi_image_free(pixels[i]); // Free CPU-side image data
             pixels[i] = nullptr; // Avoid double free
-            currentOffset += faceImageSizes;
         }
 
-        VkImageSubresourceRange cubemapSubresourceRange{};
-        cubemapSubresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        cubemapSubresourceRange.baseMipLevel = 0;
-        cubemapSubresourceRange.levelCount = 1;
-        cubemapSubresourceRange.baseArrayLayer = 0;
-        cubemapSubresourceRange.layerCount = 6;
-
-        m_cubeMap->transitionImageLayoutSingleTimeCmd(
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
-            cubemapSubresourceRange
-        );
+        m_cubeMap->setImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}
 
-        m_context.copyBufferToImage(
-            stagingBuffer.getBuffer(),
-            m_cubeMap->getVkImage(),
-            m_size,
-            m_size,
-            6
-        );
+    void VulkanSkybox::createDistribution(std::span<const uint8_t* const> faces) {
+        const auto start = std::chrono::high_resolution_clock::now();
 
-        m_cubeMap->transitionImageLayoutSingleTimeCmd(
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
-            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-            cubemapSubresourceRange
+        m_distribution = createUnique<EnvironmentDistribution>(faces, m_size);
+
+        const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        PXT_INFO("Skybox sampling distribution ({0}x{0} cells per face) built in {1:.2f} ms", m_distribution->getResolution(), milliseconds);
+
+        // the resolution comes first, followed by the alias table of the cells
+        const uint32_t resolution = m_distribution->getResolution();
+        const std::vector<AliasTableEntry>& cells = m_distribution->getCells();
+        const VkDeviceSize cellsSize = sizeof(AliasTableEntry) * cells.size();
+
+        m_distributionBuffer = createUnique<VulkanBuffer>(
+            m_context,
+            sizeof(resolution) + cellsSize,
+            1,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
         );
-	}
+
+        m_context.getUploader().copyToBuffer(m_distributionBuffer->getBuffer(), &resolution, sizeof(resolution));
+        m_context.getUploader().copyToBuffer(m_distributionBuffer->getBuffer(), cells.data(), cellsSize, sizeof(resolution));
+    }
 
     void VulkanSkybox::createDescriptorSet(Shared<DescriptorAllocatorGrowable> descriptorAllocator) {
         m_skyboxDescriptorSetLayout = DescriptorSetLayout::Builder(m_context)
             .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
                 VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_MISS_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR)
+            .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_MISS_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR)
             .build();
 
         descriptorAllocator->allocate(m_skyboxDescriptorSetLayout->getDescriptorSetLayout(), m_skyboxDescriptorSet);
 
         // Get the VkDescriptorImageInfo from the Skybox object
         VkDescriptorImageInfo skyboxImageInfo = getDescriptorImageInfo();
+        VkDescriptorBufferInfo distributionInfo = m_distributionBuffer->descriptorInfo();
 
         DescriptorWriter(m_context, *m_skyboxDescriptorSetLayout)
             .writeImage(0, &skyboxImageInfo)
+            .writeBuffer(1, &distributionInfo)
             .updateSet(m_skyboxDescriptorSet);
     }
 
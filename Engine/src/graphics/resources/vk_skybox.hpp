@@ -2,6 +2,8 @@
 
 #include "core/pch.hpp"
 #include "graphics/resources/cube_map.hpp"
+#include "graphics/resources/environment_distribution.hpp"
+#include "graphics/resources/vk_buffer.hpp"
 #include "graphics/descriptors/descriptors.hpp"
 #include "scene/skybox.hpp"
 
@@ -20,15 +22,25 @@ namespace PXTEngine {
 		VkDescriptorImageInfo getDescriptorImageInfo() const;
 		VkDescriptorSet getDescriptorSet() const { return m_skyboxDescriptorSet; }
 		VkDescriptorSetLayout getDescriptorSetLayout() const { return m_skyboxDescriptorSetLayout->getDescriptorSetLayout(); }
+		CubeMap& getCubeMap() const { return *m_cubeMap; }
+		const EnvironmentDistribution& getDistribution() const { return *m_distribution; }
 
 	private:
 		void loadTextures(const std::array<std::string, 6>& paths);
 
+		/**
+		 * @brief Builds the importance sampling distribution of the faces and uploads it for the ray tracing shaders.
+		 */
+		void createDistribution(std::span<const uint8_t* const> faces);
+
 		Context& m_context;
 		
 		uint32_t m_size = 0;
 		Unique<CubeMap> m_cubeMap;
 
+		Unique<EnvironmentDistribution> m_distribution;
+		Unique<VulkanBuffer> m_distributionBuffer;
+
 		VkDescriptorSet m_skyboxDescriptorSet;
 		Unique<DescriptorSetLayout> m_skyboxDescriptorSetLayout;
 	};
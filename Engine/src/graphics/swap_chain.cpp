@@ -42,7 +42,7 @@ namespace PXTEngine {
         for (int i = 0; i < m_depthImages.size(); i++) {
             vkDestroyImageView(m_context.getDevice(), m_depthImageViews[i], nullptr);
             vkDestroyImage(m_context.getDevice(), m_depthImages[i], nullptr);
-            vkFreeMemory(m_context.getDevice(), m_depthImageMemorys[i], nullptr);
+            m_context.getAllocator().free(m_depthImageMemorys[i]);
         }
 
         for (auto framebuffer : m_swapChainFramebuffers) {
@@ -95,8 +95,8 @@ namespace PXTEngine {
 
         vkResetFences(m_context.getDevice(), 1, &m_inFlightFences[m_currentFrame]);
 
-        VkResult vkResult = vkQueueSubmit(m_context.getGraphicsQueue(), 1, &submitInfo,
-            m_inFlightFences[m_currentFrame]);
+        // after the uploads recorded during the frame, the graphics queue is shared with the loading threads
+        VkResult vkResult = m_context.getUploader().submitFrame(submitInfo, m_inFlightFences[m_currentFrame]);
 
         if (vkResult != VK_SUCCESS) {
 			PXT_ERROR("Failed to submit draw command buffer: {}", STR_VK_RESULT(vkResult));
@@ -115,7 +115,7 @@ namespace PXTEngine {
 
         presentInfo.pImageIndices = imageIndex;
 
-        auto result = vkQueuePresentKHR(m_context.getPresentQueue(), &presentInfo);
+        auto result = m_context.getUploader().present(m_context.getPresentQueue(), presentInfo);
 
         m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 
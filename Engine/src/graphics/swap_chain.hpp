@@ -264,7 +264,7 @@ namespace PXTEngine {
         VkRenderPass m_renderPass;
 
         std::vector<VkImage> m_depthImages;
-        std::vector<VkDeviceMemory> m_depthImageMemorys;
+        std::vector<GpuAllocation> m_depthImageMemorys;
         std::vector<VkImageView> m_depthImageViews;
         std::vector<VkImage> m_swapChainImages;
         std::vector<VkImageView> m_swapChainImageViews;
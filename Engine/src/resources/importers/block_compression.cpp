@@ -0,0 +1,515 @@
+#include "resources/importers/block_compression.hpp"
+
+#include "core/jobs/job_system.hpp"
+
+namespace PXTEngine {
+
+    namespace {
+        constexpr uint32_t BLOCK_TEXELS = 16;
+
+        // interpolation weights of the 4 bit BC7 indices, in 64ths
+        constexpr std::array<uint32_t, 16> BC7_WEIGHTS = {
+            0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64
+        };
+
+        /**
+         * @brief Writes values in a block, least significant bit first.
+         */
+        struct BitWriter {
+            uint8_t* output;
+            uint32_t position = 0;
+
+            void write(const uint32_t value, const uint32_t bitCount) {
+                for (uint32_t i = 0; i < bitCount; i++, position++) {
+                    if ((value >> i) & 1) {
+                        output[position >> 3] |= static_cast<uint8_t>(1 << (position & 7));
+                    }
+                }
+            }
+        };
+
+        /**
+         * @brief Reads values from a block, least significant bit first.
+         */
+        struct BitReader {
+            const uint8_t* input;
+            uint32_t position = 0;
+
+            uint32_t read(const uint32_t bitCount) {
+                uint32_t value = 0;
+                for (uint32_t i = 0; i < bitCount; i++, position++) {
+                    value |= ((input[position >> 3] >> (position & 7)) & 1u) << i;
+                }
+                return value;
+            }
+        };
+
+        /**
+         * @brief BC7 mode 6 endpoint pair, 7 bits per channel plus a p-bit shared by the channels.
+         */
+        struct BC7Endpoints {
+            std::array<std::array<uint8_t, 4>, 2> colors{};
+            std::array<uint8_t, 2> pBits{};
+
+            uint8_t expanded(const uint32_t endpoint, const uint32_t channel) const {
+                return static_cast<uint8_t>((colors[endpoint][channel] << 1) | pBits[endpoint]);
+            }
+        };
+
+        using FloatColor = std::array<float, 4>;
+
+        /**
+         * @brief Quantizes an endpoint to 7 bits per channel, picking the p-bit with the lowest error.
+         */
+        void quantizeEndpoint(const FloatColor& color, BC7Endpoints& endpoints, const uint32_t endpoint) {
+            float bestError = std::numeric_limits<float>::max();
+
+            for (uint8_t pBit = 0; pBit < 2; pBit++) {
+                std::array<uint8_t, 4> quantized{};
+                float error = 0.0f;
+
+                for (uint32_t c = 0; c < 4; c++) {
+                    const float value = std::clamp(color[c], 0.0f, 255.0f);
+                    quantized[c] = static_cast<uint8_t>(std::clamp(std::lround((value - pBit) * 0.5f), 0l, 127l));
+
+                    const float difference = static_cast<float>((quantized[c] << 1) | pBit) - value;
+                    error += difference * difference;
+                }
+
+                if (error < bestError) {
+                    bestError = error;
+                    endpoints.colors[endpoint] = quantized;
+                    endpoints.pBits[endpoint] = pBit;
+                }
+            }
+        }
+
+        /**
+         * @brief Picks the closest palette entry for every texel.
+         *
+         * @return The total squared error of the block.
+         */
+        uint32_t findBC7Indices(const uint8_t texels[64], const BC7Endpoints& endpoints,
+            std::array<uint8_t, BLOCK_TEXELS>& indices) {
+
+            std::array<std::array<int32_t, 4>, 16> palette{};
+            for (uint32_t i = 0; i < 16; i++) {
+                for (uint32_t c = 0; c < 4; c++) {
+                    palette[i][c] = static_cast<int32_t>(((64 - BC7_WEIGHTS[i]) * endpoints.expanded(0, c) +
+                        BC7_WEIGHTS[i] * endpoints.expanded(1, c) + 32) >> 6);
+                }
+            }
+
+            uint32_t totalError = 0;
+            for (uint32_t t = 0; t < BLOCK_TEXELS; t++) {
+                uint32_t bestError = std::numeric_limits<uint32_t>::max();
+
+                for (uint32_t i = 0; i < 16; i++) {
+                    uint32_t error = 0;
+                    for (uint32_t c = 0; c < 4; c++) {
+                        const int32_t difference = palette[i][c] - texels[t * 4 + c];
+                        error += static_cast<uint32_t>(difference * difference);
+                    }
+
+                    if (error < bestError) {
+                        bestError = error;
+                        indices[t] = static_cast<uint8_t>(i);
+                    }
+                }
+
+                totalError += bestError;
+            }
+
+            return totalError;
+        }
+
+        /**
+         * @brief Finds the endpoints on the principal axis of the block colors.
+         */
+        void principalAxisEndpoints(const uint8_t texels[64], FloatColor& low, FloatColor& high) {
+            FloatColor mean{};
+            for (uint32_t t = 0; t < BLOCK_TEXELS; t++) {
+                for (uint32_t c = 0; c < 4; c++) mean[c] += texels[t * 4 + c];
+            }
+            for (float& value : mean) value /= BLOCK_TEXELS;
+
+            std::array<std::array<float, 4>, 4> covariance{};
+            for (uint32_t t = 0; t < BLOCK_TEXELS; t++) {
+                for (uint32_t i = 0; i < 4; i++) {
+                    for (uint32_t j = 0; j < 4; j++) {
+                        covariance[i][j] += (texels[t * 4 + i] - mean[i]) * (texels[t * 4 + j] - mean[j]);
+                    }
+                }
+            }
+
+            // power iteration, a handful of steps is enough to separate the dominant axis
+            FloatColor axis = { 1.0f, 1.0f, 1.0f, 1.0f };
+            for (uint32_t iteration = 0; iteration < 8; iteration++) {
+                FloatColor next{};
+                for (uint32_t i = 0; i < 4; i++) {
+                    for (uint32_t j = 0; j < 4; j++) next[i] += covariance[i][j] * axis[j];
+                }
+
+                const float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + next[3] * next[3]);
+                if (length < 1e-6f) {
+                    low = mean;
+                    high = mean;
+                    return;
+                }
+
+                for (uint32_t i = 0; i < 4; i++) axis[i] = next[i] / length;
+            }
+
+            float minProjection = std::numeric_limits<float>::max();
+            float maxProjection = std::numeric_limits<float>::lowest();
+            for (uint32_t t = 0; t < BLOCK_TEXELS; t++) {
+                float projection = 0.0f;
+                for (uint32_t c = 0; c < 4; c++) projection += (texels[t * 4 + c] - mean[c]) * axis[c];
+
+                minProjection = std::min(minProjection, projection);
+                maxProjection = std::max(maxProjection, projection);
+            }
+
+            for (uint32_t c = 0; c < 4; c++) {
+                low[c] = mean[c] + axis[c] * minProjection;
+                high[c] = mean[c] + axis[c] * maxProjection;
+            }
+        }
+
+        /**
+         * @brief Least squares endpoints for the given indices.
+         *
+         * @return false if the indices don't define a solvable system (every texel on the same weight).
+         */
+        bool refitEndpoints(const uint8_t texels[64], const std::array<uint8_t, BLOCK_TEXELS>& indices,
+            FloatColor& low, FloatColor& high) {
+
+            float a = 0.0f, b = 0.0f, c = 0.0f;
+            FloatColor lowSum{}, highSum{};
+
+            for (uint32_t t = 0; t < BLOCK_TEXELS; t++) {
+                const float weight = BC7_WEIGHTS[indices[t]] / 64.0f;
+                const float inverse = 1.0f - weight;
+
+                a += inverse * inverse;
+                b += inverse * weight;
+                c += weight * weight;
+
+                for (uint32_t i = 0; i < 4; i++) {
+                    lowSum[i] += inverse * texels[t * 4 + i];
+                    highSum[i] += weight * texels[t * 4 + i];
+                }
+            }
+
+            const float determinant = a * c - b * b;
+            if (std::abs(determinant) < 1e-6f) return false;
+
+            for (uint32_t i = 0; i < 4; i++) {
+                low[i] = (c * lowSum[i] - b * highSum[i]) / determinant;
+                high[i] = (a * highSum[i] - b * lowSum[i]) / determinant;
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Copies a 4x4 block out of an RGBA8 image, repeating the edge texels.
+         */
+        void fetchBlock(const uint8_t* rgba, const uint32_t width, const uint32_t height,
+            const uint32_t blockX, const uint32_t blockY, uint8_t texels[64]) {
+
+            for (uint32_t y = 0; y < BlockCompression::BLOCK_SIZE; y++) {
+                const uint32_t sourceY = std::min(blockY * BlockCompression::BLOCK_SIZE + y, height - 1);
+
+                for (uint32_t x = 0; x < BlockCompression::BLOCK_SIZE; x++) {
+                    const uint32_t sourceX = std::min(blockX * BlockCompression::BLOCK_SIZE + x, width - 1);
+
+                    std::memcpy(&texels[(y * BlockCompression::BLOCK_SIZE + x) * 4],
+                        &rgba[(static_cast<size_t>(sourceY) * width + sourceX) * 4], 4);
+                }
+            }
+        }
+    }
+
+    ImageFormat BlockCompression::chooseFormat(const uint8_t* rgba, const size_t texelCount, const ImageInfo& imageInfo) {
+        if (imageInfo.usage == NORMAL_MAP) return BC5_LINEAR;
+        if (isSrgbFormat(imageInfo.format)) return BC7_SRGB;
+
+        for (size_t i = 0; i < texelCount; i++) {
+            const uint8_t* texel = rgba + i * 4;
+
+            if (texel[0] != texel[1] || texel[0] != texel[2] || texel[3] != 255) {
+                return BC7_LINEAR;
+            }
+        }
+
+        return BC4_LINEAR;
+    }
+
+    void BlockCompression::compress(const uint8_t* rgba, const uint32_t width, const uint32_t height,
+        const ImageFormat format, uint8_t* output) {
+        PXT_PROFILE_FN();
+
+        if (!isBlockCompressed(format)) {
+            throw std::runtime_error("BlockCompression - format is not block compressed");
+        }
+
+        const uint32_t blocksX = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const uint32_t blocksY = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const size_t blockBytes = format == BC4_LINEAR ? 8 : 16;
+
+        // a job per block row, rows write disjoint parts of the output
+        JobSystem::parallelFor(blocksY, 1, [&](const size_t begin, const size_t end) {
+            uint8_t texels[64];
+            uint8_t channel[16];
+
+            for (size_t blockY = begin; blockY < end; blockY++) {
+                for (uint32_t blockX = 0; blockX < blocksX; blockX++) {
+                    uint8_t* block = output + (blockY * blocksX + blockX) * blockBytes;
+
+                    fetchBlock(rgba, width, height, blockX, static_cast<uint32_t>(blockY), texels);
+
+                    switch (format) {
+                        case BC4_LINEAR:
+                            for (uint32_t t = 0; t < BLOCK_TEXELS; t++) channel[t] = texels[t * 4];
+                            encodeBC4Block(channel, block);
+                            break;
+
+                        case BC5_LINEAR:
+                            for (uint32_t c = 0; c < 2; c++) {
+                                for (uint32_t t = 0; t < BLOCK_TEXELS; t++) channel[t] = texels[t * 4 + c];
+                                encodeBC4Block(channel, block + c * 8);
+                            }
+                            break;
+
+                        default:
+                            encodeBC7Block(texels, block);
+                            break;
+                    }
+                }
+            }
+        });
+    }
+
+    void BlockCompression::encodeBC4Block(const uint8_t values[16], uint8_t output[8]) {
+        uint8_t minValue = 255, maxValue = 0;
+        for (uint32_t t = 0; t < BLOCK_TEXELS; t++) {
+            minValue = std::min(minValue, values[t]);
+            maxValue = std::max(maxValue, values[t]);
+        }
+
+        // red0 > red1 selects the 8 value mode, with 6 interpolated values between the endpoints
+        output[0] = maxValue;
+        output[1] = minValue;
+        std::memset(output + 2, 0, 6);
+
+        if (maxValue == minValue) return;
+
+        std::array<int32_t, 8> palette{};
+        palette[0] = maxValue;
+        palette[1] = minValue;
+        for (int32_t i = 2; i < 8; i++) {
+            palette[i] = ((8 - i) * maxValue + (i - 1) * minValue + 3) / 7;
+        }
+
+        uint64_t indexBits = 0;
+        for (uint32_t t = 0; t < BLOCK_TEXELS; t++) {
+            uint64_t bestIndex = 0;
+            int32_t bestError = std::numeric_limits<int32_t>::max();
+
+            for (uint32_t i = 0; i < 8; i++) {
+                const int32_t error = std::abs(palette[i] - values[t]);
+                if (error < bestError) {
+                    bestError = error;
+                    bestIndex = i;
+                }
+            }
+
+            indexBits |= bestIndex << (3 * t);
+        }
+
+        for (uint32_t i = 0; i < 6; i++) {
+            output[2 + i] = static_cast<uint8_t>(indexBits >> (8 * i));
+        }
+    }
+
+    void BlockCompression::encodeBC7Block(const uint8_t texels[64], uint8_t output[16]) {
+        // candidate endpoints: the bounding box and the principal axis of the colors,
+        // each refined once with a least squares fit on the indices it produced
+        std::array<FloatColor, 2> boxEndpoints{};
+        boxEndpoints[0].fill(255.0f);
+        boxEndpoints[1].fill(0.0f);
+        for (uint32_t t = 0; t < BLOCK_TEXELS; t++) {
+            for (uint32_t c = 0; c < 4; c++) {
+                boxEndpoints[0][c] = std::min(boxEndpoints[0][c], static_cast<float>(texels[t * 4 + c]));
+                boxEndpoints[1][c] = std::max(boxEndpoints[1][c], static_cast<float>(texels[t * 4 + c]));
+            }
+        }
+
+        std::array<FloatColor, 2> axisEndpoints{};
+        principalAxisEndpoints(texels, axisEndpoints[0], axisEndpoints[1]);
+
+        BC7Endpoints best{};
+        std::array<uint8_t, BLOCK_TEXELS> bestIndices{};
+        uint32_t bestError = std::numeric_limits<uint32_t>::max();
+
+        auto tryEndpoints = [&](const FloatColor& low, const FloatColor& high,
+            std::array<uint8_t, BLOCK_TEXELS>& indices) {
+
+            BC7Endpoints endpoints{};
+            quantizeEndpoint(low, endpoints, 0);
+            quantizeEndpoint(high, endpoints, 1);
+
+            const uint32_t error = findBC7Indices(texels, endpoints, indices);
+            if (error < bestError) {
+                bestError = error;
+                best = endpoints;
+                bestIndices = indices;
+            }
+        };
+
+        for (const auto& candidate : { boxEndpoints, axisEndpoints }) {
+            std::array<uint8_t, BLOCK_TEXELS> indices{};
+            tryEndpoints(candidate[0], candidate[1], indices);
+
+            FloatColor low, high;
+            if (bestError > 0 && refitEndpoints(texels, indices, low, high)) {
+                tryEndpoints(low, high, indices);
+            }
+        }
+
+        // the first index is stored without its most significant bit, which must be 0
+        if (bestIndices[0] >= 8) {
+            std::swap(best.colors[0], best.colors[1]);
+            std::swap(best.pBits[0], best.pBits[1]);
+
+            for (uint8_t& index : bestIndices) index = static_cast<uint8_t>(15 - index);
+        }
+
+        std::memset(output, 0, 16);
+        BitWriter writer{ output };
+
+        writer.write(1 << 6, 7); // mode 6: six 0 bits followed by a 1
+
+        for (uint32_t c = 0; c < 4; c++) {
+            writer.write(best.colors[0][c], 7);
+            writer.write(best.colors[1][c], 7);
+        }
+
+        writer.write(best.pBits[0], 1);
+        writer.write(best.pBits[1], 1);
+
+        writer.write(bestIndices[0], 3);
+        for (uint32_t t = 1; t < BLOCK_TEXELS; t++) {
+            writer.write(bestIndices[t], 4);
+        }
+    }
+
+    void BlockCompression::decompress(const uint8_t* blocks, const uint32_t width, const uint32_t height,
+        const ImageFormat format, uint8_t* rgba) {
+
+        if (!isBlockCompressed(format)) {
+            throw std::runtime_error("BlockCompression - format is not block compressed");
+        }
+
+        const uint32_t blocksX = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const uint32_t blocksY = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        const size_t blockBytes = format == BC4_LINEAR ? 8 : 16;
+
+        uint8_t texels[64];
+        uint8_t channel[16];
+
+        for (uint32_t blockY = 0; blockY < blocksY; blockY++) {
+            for (uint32_t blockX = 0; blockX < blocksX; blockX++) {
+                const uint8_t* block = blocks + (static_cast<size_t>(blockY) * blocksX + blockX) * blockBytes;
+
+                switch (format) {
+                    case BC4_LINEAR:
+                    case BC5_LINEAR:
+                        for (uint32_t t = 0; t < BLOCK_TEXELS; t++) {
+                            texels[t * 4 + 1] = 0;
+                            texels[t * 4 + 2] = 0;
+                            texels[t * 4 + 3] = 255;
+                        }
+
+                        for (uint32_t c = 0; c < (format == BC4_LINEAR ? 1u : 2u); c++) {
+                            decodeBC4Block(block + c * 8, channel);
+                            for (uint32_t t = 0; t < BLOCK_TEXELS; t++) texels[t * 4 + c] = channel[t];
+                        }
+                        break;
+
+                    default:
+                        decodeBC7Block(block, texels);
+                        break;
+                }
+
+                // the texels of the edge blocks outside of the image are dropped
+                for (uint32_t y = 0; y < BLOCK_SIZE && blockY * BLOCK_SIZE + y < height; y++) {
+                    for (uint32_t x = 0; x < BLOCK_SIZE && blockX * BLOCK_SIZE + x < width; x++) {
+                        const size_t texel = static_cast<size_t>(blockY * BLOCK_SIZE + y) * width + blockX * BLOCK_SIZE + x;
+                        std::memcpy(&rgba[texel * 4], &texels[(y * BLOCK_SIZE + x) * 4], 4);
+                    }
+                }
+            }
+        }
+    }
+
+    void BlockCompression::decodeBC4Block(const uint8_t input[8], uint8_t values[16]) {
+        const int32_t red0 = input[0];
+        const int32_t red1 = input[1];
+
+        std::array<int32_t, 8> palette{};
+        palette[0] = red0;
+        palette[1] = red1;
+
+        if (red0 > red1) {
+            for (int32_t i = 2; i < 8; i++) {
+                palette[i] = ((8 - i) * red0 + (i - 1) * red1 + 3) / 7;
+            }
+        } else {
+            // 6 value mode, with the two extremes of the range as the last entries
+            for (int32_t i = 2; i < 6; i++) {
+                palette[i] = ((6 - i) * red0 + (i - 1) * red1 + 2) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        uint64_t indexBits = 0;
+        for (uint32_t i = 0; i < 6; i++) {
+            indexBits |= static_cast<uint64_t>(input[2 + i]) << (8 * i);
+        }
+
+        for (uint32_t t = 0; t < BLOCK_TEXELS; t++) {
+            values[t] = static_cast<uint8_t>(palette[(indexBits >> (3 * t)) & 7]);
+        }
+    }
+
+    void BlockCompression::decodeBC7Block(const uint8_t input[16], uint8_t texels[64]) {
+        // the mode is the number of 0 bits before the first 1
+        if ((input[0] & 0x7F) != (1 << 6)) {
+            throw std::runtime_error("BlockCompression - only the BC7 blocks of mode 6 can be decoded");
+        }
+
+        BitReader reader{ input };
+        reader.read(7);
+
+        BC7Endpoints endpoints{};
+        for (uint32_t c = 0; c < 4; c++) {
+            endpoints.colors[0][c] = static_cast<uint8_t>(reader.read(7));
+            endpoints.colors[1][c] = static_cast<uint8_t>(reader.read(7));
+        }
+
+        endpoints.pBits[0] = static_cast<uint8_t>(reader.read(1));
+        endpoints.pBits[1] = static_cast<uint8_t>(reader.read(1));
+
+        for (uint32_t t = 0; t < BLOCK_TEXELS; t++) {
+            const uint32_t weight = BC7_WEIGHTS[reader.read(t == 0 ? 3 : 4)];
+
+            for (uint32_t c = 0; c < 4; c++) {
+                texels[t * 4 + c] = static_cast<uint8_t>(((64 - weight) * endpoints.expanded(0, c) +
+                    weight * endpoints.expanded(1, c) + 32) >> 6);
+            }
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "resources/types/image.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class BlockCompression
+	 *
+	 * @brief CPU encoders for the block compressed texture formats.
+	 *
+	 * Every format splits the image in 4x4 texel blocks, blocks on the right and bottom
+	 * edges of images whose size is not a multiple of 4 repeat their last row/column.
+	 *
+	 * - BC4: the red channel, two 8 bit endpoints and 3 bit indices (8 bytes per block).
+	 * - BC5: the red and green channels, as two BC4 blocks (16 bytes per block).
+	 * - BC7: RGBA, encoded in mode 6 only (single subset, 7 bit endpoints with a p-bit,
+	 *        4 bit indices). It is the best single mode for smooth textures and keeps the
+	 *        encoder fast enough to cook at import time.
+	 *
+	 * The decoders read back what the encoders write. They are used to measure the quality of
+	 * the encoders, the GPU decodes the blocks when the textures are sampled.
+	 */
+	class BlockCompression {
+	public:
+		static constexpr uint32_t BLOCK_SIZE = 4;
+
+		/**
+		 * @brief Chooses the block compressed format of an RGBA8 image.
+		 *
+		 * - sRGB images are encoded in BC7_SRGB;
+		 * - normal maps are encoded in BC5 (x and y only);
+		 * - grayscale opaque images (roughness, metallic, ao) are encoded in BC4;
+		 * - everything else is encoded in BC7_LINEAR.
+		 *
+		 * @param rgba The texels, 4 bytes each.
+		 * @param texelCount The number of texels.
+		 * @param imageInfo The image info, its format gives the color space.
+		 */
+		static ImageFormat chooseFormat(const uint8_t* rgba, size_t texelCount, const ImageInfo& imageInfo);
+
+		/**
+		 * @brief Encodes a whole RGBA8 image.
+		 *
+		 * Block rows are encoded in parallel by the JobSystem.
+		 *
+		 * @param rgba The texels, 4 bytes each, row by row.
+		 * @param width The width of the image in texels.
+		 * @param height The height of the image in texels.
+		 * @param format The block compressed destination format.
+		 * @param output Destination of the blocks, getImageLevelSize(format, width, height) bytes.
+		 */
+		static void compress(const uint8_t* rgba, uint32_t width, uint32_t height, ImageFormat format, uint8_t* output);
+
+		/**
+		 * @brief Encodes 16 single channel values in a BC4 block.
+		 *
+		 * @param values The 4x4 block values, row by row.
+		 * @param output Destination of the 8 bytes block.
+		 */
+		static void encodeBC4Block(const uint8_t values[16], uint8_t output[8]);
+
+		/**
+		 * @brief Encodes 16 RGBA8 texels in a BC7 (mode 6) block.
+		 *
+		 * @param texels The 4x4 block texels, row by row, 4 bytes each.
+		 * @param output Destination of the 16 bytes block.
+		 */
+		static void encodeBC7Block(const uint8_t texels[64], uint8_t output[16]);
+
+		/**
+		 * @brief Decodes a whole block compressed image to RGBA8.
+		 *
+		 * The channels a format doesn't store are filled like the GPU does: 0 for green and
+		 * blue, 255 for alpha.
+		 *
+		 * @param blocks The blocks, getImageLevelSize(format, width, height) bytes.
+		 * @param width The width of the image in texels.
+		 * @param height The height of the image in texels.
+		 * @param format The block compressed format of the blocks.
+		 * @param rgba Destination of the texels, 4 bytes each.
+		 */
+		static void decompress(const uint8_t* blocks, uint32_t width, uint32_t height, ImageFormat format, uint8_t* rgba);
+
+		/**
+		 * @brief Decodes a BC4 block, in either of its two modes.
+		 *
+		 * @param input The 8 bytes block.
+		 * @param values Destination of the 4x4 block values, row by row.
+		 */
+		static void decodeBC4Block(const uint8_t input[8], uint8_t values[16]);
+
+		/**
+		 * @brief Decodes a BC7 block.
+		 *
+		 * Only mode 6 is supported, the blocks of the other modes throw.
+		 *
+		 * @param input The 16 bytes block.
+		 * @param texels Destination of the 4x4 block texels, row by row, 4 bytes each.
+		 */
+		static void decodeBC7Block(const uint8_t input[16], uint8_t texels[64]);
+	};
+}
@@ -0,0 +1,47 @@
+#include "resources/importers/cooked_asset.hpp"
+
+namespace PXTEngine {
+
+	std::filesystem::path CookedAsset::getPath(const std::filesystem::path& sourcePath, const std::string& extension,
+		const std::string& variant) {
+
+		std::filesystem::path cookedPath = sourcePath;
+		return cookedPath.replace_extension(variant.empty() ? extension : "." + variant + extension);
+	}
+
+	bool CookedAsset::isUpToDate(const std::filesystem::path& sourcePath, const std::filesystem::path& cookedPath) {
+		std::error_code error;
+
+		const auto cookedTime = std::filesystem::last_write_time(cookedPath, error);
+		if (error) return false;
+
+		const auto sourceTime = std::filesystem::last_write_time(sourcePath, error);
+		if (error) return true; // only the cooked asset has been shipped
+
+		return cookedTime >= sourceTime;
+	}
+
+	void CookedAsset::write(const std::filesystem::path& cookedPath,
+		const std::initializer_list<std::span<const std::byte>> sections) {
+
+		std::filesystem::path tempPath = cookedPath;
+		tempPath += ".tmp";
+
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file) {
+				throw std::runtime_error("failed to open file for writing: " + tempPath.string());
+			}
+
+			for (const std::span<const std::byte> section : sections) {
+				file.write(reinterpret_cast<const char*>(section.data()), static_cast<std::streamsize>(section.size()));
+			}
+
+			if (!file) {
+				throw std::runtime_error("failed to write cooked asset: " + tempPath.string());
+			}
+		}
+
+		std::filesystem::rename(tempPath, cookedPath);
+	}
+}
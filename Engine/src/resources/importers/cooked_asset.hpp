@@ -0,0 +1,41 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class CookedAsset
+	 *
+	 * @brief File helpers shared by the importers that cook their source files.
+	 *
+	 * A cooked asset is written next to its source file and replaces it as long as it is
+	 * newer. It can also be shipped without the source file.
+	 */
+	class CookedAsset {
+	public:
+		/**
+		 * @brief Returns the path of the cooked asset of a source file.
+		 *
+		 * @param sourcePath The path of the source file.
+		 * @param extension The extension of the cooked files, with its dot.
+		 * @param variant Inserted before the extension ("albedo.srgb.pxtex"), so that the cooks of a
+		 *                source file imported with different settings don't overwrite each other.
+		 */
+		static std::filesystem::path getPath(const std::filesystem::path& sourcePath, const std::string& extension,
+			const std::string& variant = "");
+
+		/**
+		 * @brief Returns true if the cooked asset exists and is not older than its source file.
+		 */
+		static bool isUpToDate(const std::filesystem::path& sourcePath, const std::filesystem::path& cookedPath);
+
+		/**
+		 * @brief Writes the sections one after the other in the cooked asset.
+		 *
+		 * The sections are written to a temporary file which is then renamed, so that a crash
+		 * never leaves a half written cooked asset.
+		 */
+		static void write(const std::filesystem::path& cookedPath, std::initializer_list<std::span<const std::byte>> sections);
+	};
+}
@@ -0,0 +1,76 @@
+#include "resources/importers/mesh_importer.hpp"
+
+#include "core/mapped_file.hpp"
+#include "resources/importers/cooked_asset.hpp"
+
+// the cooked mesh files make no Vulkan call either, they are apart from the rest of MeshImporter so that the
+// benchmarks can build them
+
+namespace PXTEngine {
+
+    Shared<MappedFile> MeshImporter::mapCooked(const std::filesystem::path& filePath) {
+        auto file = createShared<MappedFile>(filePath);
+
+        if (file->size() < sizeof(CookedMeshHeader)) {
+            throw std::runtime_error("cooked mesh is too small: " + filePath.string());
+        }
+
+        const auto* header = file->get<CookedMeshHeader>();
+
+        if (header->magic != CookedMeshHeader::MAGIC || header->version != CookedMeshHeader::VERSION ||
+            header->vertexSize != sizeof(Mesh::Vertex)) {
+            throw std::runtime_error("cooked mesh has an incompatible format: " + filePath.string());
+        }
+
+        const uint64_t vertexBytes = static_cast<uint64_t>(header->vertexCount) * sizeof(Mesh::Vertex);
+        const uint64_t indexBytes = static_cast<uint64_t>(header->indexCount) * sizeof(uint32_t);
+
+        if (header->vertexOffset + vertexBytes > file->size() || header->indexOffset + indexBytes > file->size()) {
+            throw std::runtime_error("cooked mesh is truncated: " + filePath.string());
+        }
+
+        return file;
+    }
+
+    std::filesystem::path MeshImporter::cookObj(const std::filesystem::path& filePath) {
+        std::vector<Mesh::Vertex> vertices{};
+        std::vector<uint32_t> indices{};
+
+        parseObj(filePath, vertices, indices);
+
+        const std::filesystem::path cookedPath = getCookedPath(filePath);
+        writeCooked(cookedPath, vertices, indices);
+
+        return cookedPath;
+    }
+
+    std::filesystem::path MeshImporter::getCookedPath(const std::filesystem::path& filePath) {
+        return CookedAsset::getPath(filePath, COOKED_MESH_EXTENSION);
+    }
+
+    void MeshImporter::writeCooked(const std::filesystem::path& cookedPath, const std::vector<Mesh::Vertex>& vertices,
+        const std::vector<uint32_t>& indices) {
+
+        CookedMeshHeader header{};
+        header.vertexCount = static_cast<uint32_t>(vertices.size());
+        header.indexCount = static_cast<uint32_t>(indices.size());
+        header.vertexOffset = sizeof(CookedMeshHeader);
+        header.indexOffset = header.vertexOffset + sizeof(Mesh::Vertex) * vertices.size();
+
+        if (!vertices.empty()) {
+            header.boundsMin = glm::vec4(std::numeric_limits<float>::max());
+            header.boundsMax = glm::vec4(std::numeric_limits<float>::lowest());
+
+            for (const auto& vertex : vertices) {
+                header.boundsMin = glm::min(header.boundsMin, vertex.position);
+                header.boundsMax = glm::max(header.boundsMax, vertex.position);
+            }
+        }
+
+        CookedAsset::write(cookedPath, {
+            std::as_bytes(std::span(&header, 1)),
+            std::as_bytes(std::span(vertices)),
+            std::as_bytes(std::span(indices))
+        });
+    }
+}
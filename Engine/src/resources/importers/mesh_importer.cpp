@@ -1,108 +1,71 @@
 #include "resources/importers/mesh_importer.hpp"
 
+#include "core/mapped_file.hpp"
 #include "graphics/resources/vk_mesh.hpp"
+#include "resources/importers/cooked_asset.hpp"
 #include "resources/types/material.hpp"
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader.h>
 
 namespace PXTEngine {
 
 	Shared<Mesh> MeshImporter::importObj(ResourceManager& rm, const std::filesystem::path& filePath,
         ResourceInfo* resourceInfo) {
 
-	    std::vector<Mesh::Vertex> vertices{};  // List of vertices in the model.
-	    std::vector<uint32_t> indices{}; // List of indices for indexed rendering.
+        return std::static_pointer_cast<Mesh>(loadObj(filePath, resourceInfo)());
+	}
 
-		tinyobj::attrib_t attrib;
-        std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
-        std::string warn, err;
+    Shared<Mesh> MeshImporter::importCooked(ResourceManager& rm, const std::filesystem::path& filePath,
+        ResourceInfo* resourceInfo) {
 
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filePath.string().c_str())) {
-            throw std::runtime_error(warn + err);
-        }
+        return std::static_pointer_cast<Mesh>(loadCooked(filePath, resourceInfo)());
+    }
+
+    ResourceFinalizer MeshImporter::loadObj(const std::filesystem::path& filePath, ResourceInfo* resourceInfo) {
+        PXT_PROFILE_FN();
+
+        const std::filesystem::path cookedPath = getCookedPath(filePath);
 
-        vertices.clear();
-        indices.clear();
-
-        std::unordered_map<Mesh::Vertex, uint32_t> uniqueVertices{};
-        for (const auto& shape : shapes) {
-            for (const auto& index : shape.mesh.indices) {
-                Mesh::Vertex vertex{};
-
-                if (index.vertex_index >= 0) {
-                    vertex.position = {
-                        attrib.vertices[3 * index.vertex_index + 0],
-                        attrib.vertices[3 * index.vertex_index + 1],
-                        attrib.vertices[3 * index.vertex_index + 2],
-                        1.0f // unused
-                    };
-
-                    /*vertex.color = {
-                        attrib.colors[3 * index.vertex_index + 0],
-                        attrib.colors[3 * index.vertex_index + 1],
-                        attrib.colors[3 * index.vertex_index + 2],
-                    };*/
-                }
-
-                if (index.normal_index >= 0) {
-                    vertex.normal = {
-                        attrib.normals[3 * index.normal_index + 0],
-                        attrib.normals[3 * index.normal_index + 1],
-                        attrib.normals[3 * index.normal_index + 2],
-                        1.0f // unused
-                    };
-                }
-
-                if (index.texcoord_index >= 0) {
-                    vertex.uv = {
-
-						attrib.texcoords[2 * index.texcoord_index + 0],
-	                    1.0f - attrib.texcoords[2 * index.texcoord_index + 1],
-                        1.0f, 1.0f // unused
-                    };
-                }
-
-				if (!uniqueVertices.contains(vertex)) {
-				    uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-				    vertices.push_back(vertex);
-				}
-				indices.push_back(uniqueVertices[vertex]);
+        if (CookedAsset::isUpToDate(filePath, cookedPath)) {
+            try {
+                return loadCooked(cookedPath, resourceInfo);
+            } catch (const std::exception& e) {
+                PXT_WARN("Invalid cooked mesh '{}', falling back to OBJ: {}", cookedPath.string(), e.what());
             }
         }
 
-        // Iterate through triangles and calculate per-triangle tangents and bitangents
-        for (size_t i = 0; i < indices.size(); i += 3) {
-            Mesh::Vertex& v0 = vertices[indices[i + 0]];
-            Mesh::Vertex& v1 = vertices[indices[i + 1]];
-            Mesh::Vertex& v2 = vertices[indices[i + 2]];
+        struct MeshData {
+	        std::vector<Mesh::Vertex> vertices{};  // List of vertices in the model.
+	        std::vector<uint32_t> indices{}; // List of indices for indexed rendering.
+        };
 
-            glm::vec3 edge1 = v1.position - v0.position;
-            glm::vec3 edge2 = v2.position - v0.position;
+        auto data = createShared<MeshData>();
 
-            glm::vec2 deltaUV1 = v1.uv - v0.uv;
-            glm::vec2 deltaUV2 = v2.uv - v0.uv;
+        parseObj(filePath, data->vertices, data->indices);
 
-            float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
+        // cook on first run, a failure here only means that the next launch will parse the OBJ again
+        try {
+            writeCooked(cookedPath, data->vertices, data->indices);
+        } catch (const std::exception& e) {
+            PXT_WARN("Failed to write cooked mesh '{}': {}", cookedPath.string(), e.what());
+        }
 
-            glm::vec3 tangent;
-            tangent.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
-            tangent.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
-            tangent.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
+        return [data]() -> Shared<Resource> {
+		    return VulkanMesh::create(data->vertices, data->indices);
+        };
+	}
 
-            tangent = glm::normalize(tangent);
+    ResourceFinalizer MeshImporter::loadCooked(const std::filesystem::path& filePath, ResourceInfo* resourceInfo) {
+        PXT_PROFILE_FN();
 
-            float handedness =
-                (glm::dot(glm::cross(glm::vec3(v0.normal), glm::vec3(v1.normal)), tangent) < 0.0f) ? -1.0f : 1.0f;
+        Shared<MappedFile> file = mapCooked(filePath);
+        const auto* header = file->get<CookedMeshHeader>();
 
-            glm::vec4 tangent4 = glm::vec4(tangent, handedness);
+        // the mapped arrays are handed to the staging buffers as they are, the finalizer keeps the file mapped
+        return [file, header]() -> Shared<Resource> {
+            const std::span<const Mesh::Vertex> vertices{ file->get<Mesh::Vertex>(header->vertexOffset), header->vertexCount };
+            const std::span<const uint32_t> indices{ file->get<uint32_t>(header->indexOffset), header->indexCount };
 
-            v0.tangent = tangent4;
-            v1.tangent = tangent4;
-            v2.tangent = tangent4;
-        }
-
-		return VulkanMesh::create(vertices, indices);
-	}
-}
\ No newline at end of file
+            return VulkanMesh::create(vertices, indices);
+        };
+    }
+}
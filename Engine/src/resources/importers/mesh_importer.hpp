@@ -6,9 +6,128 @@
 
 namespace PXTEngine {
 
+	class MappedFile;
+
+	/**
+	 * @brief Extension of the cooked (binary) mesh files.
+	 */
+	const std::string COOKED_MESH_EXTENSION = ".pxmesh";
+
+	/**
+	 * @struct CookedMeshHeader
+	 *
+	 * @brief Header of a cooked mesh file.
+	 *
+	 * A cooked mesh file is laid out as:
+	 * [CookedMeshHeader][Mesh::Vertex * vertexCount][uint32_t * indexCount]
+	 *
+	 * The vertex array starts right after the header (the header size is a multiple of
+	 * alignof(Mesh::Vertex)), so a memory mapped file can be handed to the GPU upload
+	 * without any parsing or copy.
+	 */
+	struct alignas(16) CookedMeshHeader {
+		static constexpr uint32_t MAGIC = 0x4853454D; // "MESH" (little-endian)
+		static constexpr uint32_t VERSION = 1;
+
+		uint32_t magic = MAGIC;
+		uint32_t version = VERSION;
+		uint32_t vertexSize = sizeof(Mesh::Vertex);
+		uint32_t vertexCount = 0;
+		uint32_t indexCount = 0;
+		uint32_t reserved[3] = {};
+		uint64_t vertexOffset = 0;
+		uint64_t indexOffset = 0;
+		glm::vec4 boundsMin{ 0.0f };
+		glm::vec4 boundsMax{ 0.0f };
+	};
+
+	PXT_STATIC_ASSERT(sizeof(CookedMeshHeader) % alignof(Mesh::Vertex) == 0,
+		"CookedMeshHeader size must keep the vertex array aligned");
+
 	class MeshImporter {
 	public:
+		/**
+		 * @brief Imports a Wavefront OBJ file.
+		 *
+		 * If a cooked mesh exists next to the source file and is newer than it, the cooked
+		 * mesh is loaded instead. Otherwise the OBJ is parsed and a cooked mesh is written
+		 * next to it, so the next launch skips the parsing.
+		 */
 		static Shared<Mesh> importObj(ResourceManager& rm, const std::filesystem::path& filePath,
 			ResourceInfo* resourceInfo = nullptr);
+
+		/**
+		 * @brief Imports a cooked mesh file by memory mapping it.
+		 *
+		 * The mapped vertex and index arrays are copied directly into the staging buffers.
+		 */
+		static Shared<Mesh> importCooked(ResourceManager& rm, const std::filesystem::path& filePath,
+			ResourceInfo* resourceInfo = nullptr);
+
+		/**
+		 * @brief CPU side of importObj, can be called from any thread.
+		 *
+		 * @return The finalizer creating the mesh, to be called on the main thread.
+		 */
+		static ResourceFinalizer loadObj(const std::filesystem::path& filePath, ResourceInfo* resourceInfo = nullptr);
+
+		/**
+		 * @brief CPU side of importCooked, can be called from any thread.
+		 *
+		 * The file stays mapped until the returned finalizer is destroyed.
+		 *
+		 * @return The finalizer creating the mesh, to be called on the main thread.
+		 */
+		static ResourceFinalizer loadCooked(const std::filesystem::path& filePath, ResourceInfo* resourceInfo = nullptr);
+
+		/**
+		 * @brief Maps a cooked mesh file and checks its header against the arrays it describes.
+		 *
+		 * Defined in cooked_mesh.cpp with cookObj() and getCookedPath(), which make no Vulkan call.
+		 *
+		 * @return The mapped file, starting with its CookedMeshHeader.
+		 *
+		 * @throws std::runtime_error if the file is truncated or of another format or version.
+		 */
+		static Shared<MappedFile> mapCooked(const std::filesystem::path& filePath);
+
+		/**
+		 * @brief Cooks an OBJ file and writes the result next to the source file.
+		 *
+		 * Can be used offline to cook assets before shipping them.
+		 *
+		 * @param filePath The path of the OBJ file.
+		 *
+		 * @return The path of the written cooked mesh.
+		 */
+		static std::filesystem::path cookObj(const std::filesystem::path& filePath);
+
+		/**
+		 * @brief Returns the path of the cooked mesh associated with a source file.
+		 */
+		static std::filesystem::path getCookedPath(const std::filesystem::path& filePath);
+
+		/**
+		 * @brief Parses an OBJ file into deduplicated vertices and indices, with tangents.
+		 *
+		 * Vertex assembly, deduplication and the tangent pass are split in jobs (per shape,
+		 * then per chunk of indices) run by the JobSystem. The result is identical to the
+		 * single threaded path whatever the thread count.
+		 *
+		 * Defined in obj_parser.cpp, which makes no Vulkan call.
+		 *
+		 * @param filePath The path of the OBJ file.
+		 * @param vertices Output unique vertices, in order of first appearance.
+		 * @param indices Output indices into vertices.
+		 * @param threadCount Maximum number of jobs running at once, 0 to use every worker of the
+		 *                    JobSystem and the calling thread, 1 to run the single threaded path.
+		 */
+		static void parseObj(const std::filesystem::path& filePath, std::vector<Mesh::Vertex>& vertices,
+			std::vector<uint32_t>& indices, uint32_t threadCount = 0);
+
+	private:
+
+		static void writeCooked(const std::filesystem::path& cookedPath, const std::vector<Mesh::Vertex>& vertices,
+			const std::vector<uint32_t>& indices);
 	};
 }
@@ -0,0 +1,226 @@
+#include "resources/importers/mip_generator.hpp"
+
+#include "core/jobs/job_system.hpp"
+#include "scene/spatial/simd.hpp"
+
+namespace PXTEngine {
+
+    namespace {
+        // levels smaller than this are not worth splitting in jobs
+        constexpr size_t PARALLEL_TEXEL_THRESHOLD = 1 << 16;
+        constexpr size_t ROWS_PER_JOB = 16;
+
+        // resolution of the linear to sRGB table, enough to round trip every 8 bit value
+        constexpr uint32_t LINEAR_TO_SRGB_SIZE = 4096;
+
+        /**
+         * @brief The rows are filtered in floats on a 0-255 scale, linear for the sRGB color channels.
+         */
+        struct FilterTables {
+            std::array<float, 256> toFloat{};
+            std::array<float, 256> srgbToLinear{};
+            std::array<uint8_t, LINEAR_TO_SRGB_SIZE + 1> linearToSrgb{};
+        };
+
+        const FilterTables& getFilterTables() {
+            static const FilterTables tables = []() {
+                FilterTables result;
+
+                for (uint32_t i = 0; i < 256; i++) {
+                    const float srgb = i / 255.0f;
+                    const float linear = srgb <= 0.04045f ? srgb / 12.92f : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+
+                    result.toFloat[i] = static_cast<float>(i);
+                    result.srgbToLinear[i] = linear * 255.0f;
+                }
+
+                for (uint32_t i = 0; i <= LINEAR_TO_SRGB_SIZE; i++) {
+                    const float linear = static_cast<float>(i) / LINEAR_TO_SRGB_SIZE;
+                    const float srgb = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+
+                    result.linearToSrgb[i] = static_cast<uint8_t>(std::clamp(srgb * 255.0f + 0.5f, 0.0f, 255.0f));
+                }
+
+                return result;
+            }();
+
+            return tables;
+        }
+
+        /**
+         * @brief Float rows of a job, reused for all its destination rows.
+         */
+        struct FilterRows {
+            std::vector<float> even; // texels 0, 2, 4... of a source row
+            std::vector<float> odd;  // texels 1, 3, 5... (the even ones again for 1 texel wide sources)
+            std::vector<float> sums; // sum of the texel pairs over the source rows of a destination row
+            std::array<float, 4> lastColumn{}; // sum of the last source column when the width is odd
+
+            explicit FilterRows(const uint32_t destinationWidth)
+                : even(destinationWidth * 4), odd(destinationWidth * 4), sums(destinationWidth * 4) {}
+        };
+
+        /**
+         * @brief Splits a source row in its even and odd texels, as floats, and adds its last column if the width is odd.
+         */
+        void decodeRow(const uint8_t* row, const uint32_t width, const std::array<const float*, 4>& channelTables,
+            FilterRows& rows) {
+
+            const size_t count = rows.even.size();
+            const size_t oddOffset = width > 1 ? 4 : 0;
+
+            for (size_t i = 0; i < count; i++) {
+                const float* table = channelTables[i & 3];
+                const size_t s = (i >> 2) * 8 + (i & 3);
+
+                rows.even[i] = table[row[s]];
+                rows.odd[i] = table[row[s + oddOffset]];
+            }
+
+            if (width > 1 && width % 2 == 1) {
+                const uint8_t* last = row + (width - 1) * 4;
+                for (size_t c = 0; c < 4; c++) {
+                    rows.lastColumn[c] += channelTables[c][last[c]];
+                }
+            }
+        }
+
+        void accumulatePairs(FilterRows& rows) {
+            const size_t count = rows.sums.size();
+            float* sums = rows.sums.data();
+            const float* even = rows.even.data();
+            const float* odd = rows.odd.data();
+
+            size_t i = 0;
+            for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH) {
+                (SimdFloat::load(sums + i) + SimdFloat::load(even + i) + SimdFloat::load(odd + i)).store(sums + i);
+            }
+
+            for (; i < count; i++) {
+                sums[i] += even[i] + odd[i];
+            }
+        }
+
+        void scaleSums(FilterRows& rows, const float scale) {
+            const size_t count = rows.sums.size();
+            float* sums = rows.sums.data();
+
+            size_t i = 0;
+            for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH) {
+                (SimdFloat::load(sums + i) * SimdFloat(scale)).store(sums + i);
+            }
+
+            for (; i < count; i++) {
+                sums[i] *= scale;
+            }
+        }
+
+        /**
+         * @brief Converts the averaged row back to 8 bits, through the sRGB table for the color channels.
+         */
+        void encodeRow(const std::vector<float>& values, const bool srgb, uint8_t* destination) {
+            const FilterTables& tables = getFilterTables();
+            constexpr float toTableIndex = LINEAR_TO_SRGB_SIZE / 255.0f;
+
+            for (size_t i = 0; i < values.size(); i++) {
+                const float value = values[i];
+
+                if (srgb && (i & 3) != 3) {
+                    destination[i] = tables.linearToSrgb[static_cast<uint32_t>(value * toTableIndex + 0.5f)];
+                } else {
+                    destination[i] = static_cast<uint8_t>(value + 0.5f);
+                }
+            }
+        }
+    }
+
+    Shared<Buffer> MipGenerator::generate(const Buffer& pixels, ImageInfo& imageInfo) {
+        PXT_PROFILE_FN();
+
+        PXT_ASSERT(!isBlockCompressed(imageInfo.format), "MipGenerator works on RGBA8 images only");
+
+        const uint32_t mipLevels = getMipLevelCount(imageInfo.width, imageInfo.height);
+        const bool srgb = isSrgbFormat(imageInfo.format);
+
+        size_t dataSize = 0;
+        for (uint32_t level = 0; level < mipLevels; level++) {
+            dataSize += getImageLevelSize(imageInfo.format,
+                std::max(1u, imageInfo.width >> level), std::max(1u, imageInfo.height >> level));
+        }
+
+        const size_t baseSize = getImageLevelSize(imageInfo.format, imageInfo.width, imageInfo.height);
+        if (pixels.size < baseSize) {
+            throw std::runtime_error("MipGenerator - pixel buffer is smaller than the image");
+        }
+
+        auto levels = createShared<Buffer>(dataSize);
+        std::memcpy(levels->bytes, pixels.bytes, baseSize);
+
+        size_t sourceOffset = 0;
+        size_t offset = baseSize;
+
+        for (uint32_t level = 1; level < mipLevels; level++) {
+            const uint32_t sourceWidth = std::max(1u, imageInfo.width >> (level - 1));
+            const uint32_t sourceHeight = std::max(1u, imageInfo.height >> (level - 1));
+
+            downsample(levels->bytes + sourceOffset, sourceWidth, sourceHeight, levels->bytes + offset, srgb);
+
+            sourceOffset = offset;
+            offset += getImageLevelSize(imageInfo.format,
+                std::max(1u, imageInfo.width >> level), std::max(1u, imageInfo.height >> level));
+        }
+
+        imageInfo.mipLevels = mipLevels;
+
+        return levels;
+    }
+
+    void MipGenerator::downsample(const uint8_t* source, const uint32_t width, const uint32_t height,
+        uint8_t* destination, const bool srgb) {
+
+        const uint32_t destinationWidth = std::max(1u, width / 2);
+        const uint32_t destinationHeight = std::max(1u, height / 2);
+
+        const FilterTables& tables = getFilterTables();
+        const float* colorTable = srgb ? tables.srgbToLinear.data() : tables.toFloat.data();
+        const std::array<const float*, 4> channelTables = { colorTable, colorTable, colorTable, tables.toFloat.data() };
+
+        const bool foldsLastColumn = width > 1 && width % 2 == 1;
+        const bool foldsLastRow = height > 1 && height % 2 == 1;
+
+        auto processRows = [&](const size_t begin, const size_t end) {
+            FilterRows rows(destinationWidth);
+
+            for (size_t y = begin; y < end; y++) {
+                // 1 texel tall sources average a row with itself
+                const uint32_t firstRow = height > 1 ? static_cast<uint32_t>(y) * 2 : 0;
+                const uint32_t rowCount = height == 1 ? 1 : (foldsLastRow && y == destinationHeight - 1 ? 3 : 2);
+
+                std::fill(rows.sums.begin(), rows.sums.end(), 0.0f);
+                rows.lastColumn.fill(0.0f);
+
+                for (uint32_t r = 0; r < rowCount; r++) {
+                    decodeRow(source + static_cast<size_t>(firstRow + r) * width * 4, width, channelTables, rows);
+                    accumulatePairs(rows);
+                }
+
+                if (foldsLastColumn) {
+                    // the last destination texel averages 3 columns, scaled here to the weight of a pair
+                    float* last = rows.sums.data() + (destinationWidth - 1) * 4;
+                    for (size_t c = 0; c < 4; c++) {
+                        last[c] = (last[c] + rows.lastColumn[c]) * (2.0f / 3.0f);
+                    }
+                }
+
+                scaleSums(rows, 1.0f / static_cast<float>(rowCount * 2));
+                encodeRow(rows.sums, srgb, destination + y * destinationWidth * 4);
+            }
+        };
+
+        if (static_cast<size_t>(destinationWidth) * destinationHeight >= PARALLEL_TEXEL_THRESHOLD) {
+            JobSystem::parallelFor(destinationHeight, ROWS_PER_JOB, processRows);
+        } else {
+            processRows(0, destinationHeight);
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "core/buffer.hpp"
+#include "resources/types/image.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class MipGenerator
+	 *
+	 * @brief Builds mip chains of RGBA8 images on the CPU.
+	 *
+	 * Every level is a 2x2 box filter of the previous one. When a side of the previous level
+	 * is odd, the last texel of the new level averages 3 texels on that side instead of 2,
+	 * so that the last row/column still contributes. The color channels of sRGB images are
+	 * averaged in linear space (through lookup tables), so that the smaller levels don't get
+	 * darker, alpha is always averaged as it is.
+	 * Rows are decoded to floats and summed with SimdFloat, and the rows of big levels are
+	 * split in jobs.
+	 */
+	class MipGenerator {
+	public:
+		/**
+		 * @brief Generates the full mip chain of an RGBA8 image.
+		 *
+		 * @param pixels The RGBA8 pixels of the biggest level.
+		 * @param imageInfo The image info (width, height and format), mipLevels is updated.
+		 *
+		 * @return Every level, tightly packed from the biggest one (the first is a copy of pixels).
+		 */
+		static Shared<Buffer> generate(const Buffer& pixels, ImageInfo& imageInfo);
+
+		/**
+		 * @brief Halves an RGBA8 image.
+		 *
+		 * Odd sizes fold their last row/column into the last destination texels, a size of 1 stays 1.
+		 *
+		 * @param source The RGBA8 pixels of the source level.
+		 * @param width The width of the source level.
+		 * @param height The height of the source level.
+		 * @param destination Destination of the max(1, width / 2) * max(1, height / 2) texels.
+		 * @param srgb true to filter the color channels in linear space.
+		 */
+		static void downsample(const uint8_t* source, uint32_t width, uint32_t height, uint8_t* destination, bool srgb);
+	};
+}
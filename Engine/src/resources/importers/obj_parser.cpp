@@ -0,0 +1,324 @@
+#include "resources/importers/mesh_importer.hpp"
+
+#include "core/jobs/job_system.hpp"
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+
+// the OBJ parsing makes no Vulkan call, it is apart from the rest of MeshImporter so that the CPU tests can build it
+
+namespace PXTEngine {
+
+    namespace {
+        constexpr size_t PARALLEL_CORNER_THRESHOLD = 1 << 16;
+        constexpr size_t CORNERS_PER_CHUNK = 1 << 14;
+        constexpr size_t TRIANGLES_PER_CHUNK = 1 << 14;
+        constexpr uint32_t DEDUP_SHARD_COUNT = 64;
+
+        /**
+         * @brief Runs task(0) ... task(taskCount - 1) as up to threadCount jobs and waits for them.
+         *
+         * The jobs pick the tasks from a shared counter, so no more than threadCount tasks run at once.
+         */
+        void parallelFor(const size_t taskCount, const uint32_t threadCount, const std::function<void(size_t)>& task) {
+            std::atomic<size_t> nextTask = 0;
+
+            const size_t jobCount = std::min<size_t>(threadCount, taskCount);
+            JobSystem::parallelFor(jobCount, 1, [&](const size_t, const size_t) {
+                for (size_t i = nextTask++; i < taskCount; i = nextTask++) {
+                    task(i);
+                }
+            });
+        }
+
+        Mesh::Vertex makeVertex(const tinyobj::attrib_t& attrib, const tinyobj::index_t& index) {
+            Mesh::Vertex vertex{};
+
+            if (index.vertex_index >= 0) {
+                vertex.position = {
+                    attrib.vertices[3 * index.vertex_index + 0],
+                    attrib.vertices[3 * index.vertex_index + 1],
+                    attrib.vertices[3 * index.vertex_index + 2],
+                    1.0f // unused
+                };
+
+                /*vertex.color = {
+                    attrib.colors[3 * index.vertex_index + 0],
+                    attrib.colors[3 * index.vertex_index + 1],
+                    attrib.colors[3 * index.vertex_index + 2],
+                };*/
+            }
+
+            if (index.normal_index >= 0) {
+                vertex.normal = {
+                    attrib.normals[3 * index.normal_index + 0],
+                    attrib.normals[3 * index.normal_index + 1],
+                    attrib.normals[3 * index.normal_index + 2],
+                    1.0f // unused
+                };
+            }
+
+            if (index.texcoord_index >= 0) {
+                vertex.uv = {
+                    attrib.texcoords[2 * index.texcoord_index + 0],
+                    1.0f - attrib.texcoords[2 * index.texcoord_index + 1],
+                    1.0f, 1.0f // unused
+                };
+            }
+
+            return vertex;
+        }
+
+        glm::vec4 computeTangent(const Mesh::Vertex& v0, const Mesh::Vertex& v1, const Mesh::Vertex& v2) {
+            glm::vec3 edge1 = v1.position - v0.position;
+            glm::vec3 edge2 = v2.position - v0.position;
+
+            glm::vec2 deltaUV1 = v1.uv - v0.uv;
+            glm::vec2 deltaUV2 = v2.uv - v0.uv;
+
+            float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y);
+
+            glm::vec3 tangent;
+            tangent.x = f * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
+            tangent.y = f * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
+            tangent.z = f * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
+
+            tangent = glm::normalize(tangent);
+
+            float handedness =
+                (glm::dot(glm::cross(glm::vec3(v0.normal), glm::vec3(v1.normal)), tangent) < 0.0f) ? -1.0f : 1.0f;
+
+            return glm::vec4(tangent, handedness);
+        }
+
+        void assembleSerial(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes,
+            std::vector<Mesh::Vertex>& vertices, std::vector<uint32_t>& indices) {
+
+            std::unordered_map<Mesh::Vertex, uint32_t> uniqueVertices{};
+            for (const auto& shape : shapes) {
+                for (const auto& index : shape.mesh.indices) {
+                    Mesh::Vertex vertex = makeVertex(attrib, index);
+
+                    if (!uniqueVertices.contains(vertex)) {
+                        uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+                        vertices.push_back(vertex);
+                    }
+                    indices.push_back(uniqueVertices[vertex]);
+                }
+            }
+        }
+
+        /**
+         * @brief Parallel version of assembleSerial, producing the exact same vertices and indices.
+         *
+         * Corners (shape indices) are split per shape and then in fixed size chunks:
+         * 1. every chunk builds its vertices and distributes them to hash shards;
+         * 2. every shard finds, in global order, the first corner holding each unique vertex;
+         * 3. unique vertices are numbered with a prefix sum over the chunks, so they get the
+         *    same ids the serial first-come numbering would give them.
+         */
+        void assembleParallel(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes,
+            const size_t cornerCount, const uint32_t threadCount, std::vector<Mesh::Vertex>& vertices,
+            std::vector<uint32_t>& indices) {
+
+            struct Chunk {
+                const tinyobj::shape_t* shape;
+                size_t begin;       // first index in the shape
+                size_t end;         // one past the last index in the shape
+                size_t cornerBegin; // global position of the first corner
+                uint32_t uniqueCount = 0;
+                uint32_t firstVertexId = 0;
+                std::array<std::vector<uint32_t>, DEDUP_SHARD_COUNT> shardCorners{};
+            };
+
+            std::vector<Chunk> chunks;
+            size_t cornerBegin = 0;
+            for (const auto& shape : shapes) {
+                const size_t shapeCornerCount = shape.mesh.indices.size();
+
+                for (size_t begin = 0; begin < shapeCornerCount; begin += CORNERS_PER_CHUNK) {
+                    chunks.push_back({
+                        &shape, begin, std::min(begin + CORNERS_PER_CHUNK, shapeCornerCount), cornerBegin + begin
+                    });
+                }
+
+                cornerBegin += shapeCornerCount;
+            }
+
+            std::vector<Mesh::Vertex> corners(cornerCount);
+            std::vector<size_t> hashes(cornerCount);
+            std::vector<uint32_t> firstCorners(cornerCount);
+
+            parallelFor(chunks.size(), threadCount, [&](const size_t c) {
+                Chunk& chunk = chunks[c];
+
+                for (size_t i = chunk.begin; i < chunk.end; i++) {
+                    const size_t corner = chunk.cornerBegin + i - chunk.begin;
+
+                    corners[corner] = makeVertex(attrib, chunk.shape->mesh.indices[i]);
+                    hashes[corner] = std::hash<Mesh::Vertex>{}(corners[corner]);
+
+                    chunk.shardCorners[hashes[corner] % DEDUP_SHARD_COUNT].push_back(static_cast<uint32_t>(corner));
+                }
+            });
+
+            // the sets store corner positions, hashing and comparing the vertices they point to
+            auto cornerHash = [&](const uint32_t corner) { return hashes[corner]; };
+            auto cornerEqual = [&](const uint32_t a, const uint32_t b) { return corners[a] == corners[b]; };
+
+            parallelFor(DEDUP_SHARD_COUNT, threadCount, [&](const size_t shard) {
+                std::unordered_set<uint32_t, decltype(cornerHash), decltype(cornerEqual)> uniqueCorners(
+                    0, cornerHash, cornerEqual);
+
+                // chunks are visited in global order, so the first insertion is the first occurrence
+                for (const auto& chunk : chunks) {
+                    for (const uint32_t corner : chunk.shardCorners[shard]) {
+                        firstCorners[corner] = *uniqueCorners.insert(corner).first;
+                    }
+                }
+            });
+
+            parallelFor(chunks.size(), threadCount, [&](const size_t c) {
+                Chunk& chunk = chunks[c];
+
+                for (size_t corner = chunk.cornerBegin; corner < chunk.cornerBegin + chunk.end - chunk.begin; corner++) {
+                    chunk.uniqueCount += firstCorners[corner] == corner ? 1 : 0;
+                }
+            });
+
+            uint32_t vertexCount = 0;
+            for (auto& chunk : chunks) {
+                chunk.firstVertexId = vertexCount;
+                vertexCount += chunk.uniqueCount;
+            }
+
+            vertices.resize(vertexCount);
+            indices.resize(cornerCount);
+
+            // vertex ids are written in the slot of their first corner
+            std::vector<uint32_t>& vertexIds = indices;
+
+            parallelFor(chunks.size(), threadCount, [&](const size_t c) {
+                const Chunk& chunk = chunks[c];
+                uint32_t vertexId = chunk.firstVertexId;
+
+                for (size_t corner = chunk.cornerBegin; corner < chunk.cornerBegin + chunk.end - chunk.begin; corner++) {
+                    if (firstCorners[corner] == corner) {
+                        vertices[vertexId] = corners[corner];
+                        vertexIds[corner] = vertexId++;
+                    }
+                }
+            });
+
+            parallelFor(chunks.size(), threadCount, [&](const size_t c) {
+                const Chunk& chunk = chunks[c];
+
+                for (size_t corner = chunk.cornerBegin; corner < chunk.cornerBegin + chunk.end - chunk.begin; corner++) {
+                    if (firstCorners[corner] != corner) {
+                        indices[corner] = vertexIds[firstCorners[corner]];
+                    }
+                }
+            });
+        }
+
+        void computeTangentsSerial(std::vector<Mesh::Vertex>& vertices, const std::vector<uint32_t>& indices) {
+            // Iterate through triangles and calculate per-triangle tangents and bitangents
+            for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+                Mesh::Vertex& v0 = vertices[indices[i + 0]];
+                Mesh::Vertex& v1 = vertices[indices[i + 1]];
+                Mesh::Vertex& v2 = vertices[indices[i + 2]];
+
+                glm::vec4 tangent4 = computeTangent(v0, v1, v2);
+
+                v0.tangent = tangent4;
+                v1.tangent = tangent4;
+                v2.tangent = tangent4;
+            }
+        }
+
+        /**
+         * @brief Parallel version of computeTangentsSerial.
+         *
+         * In the serial loop the last triangle referencing a vertex decides its tangent,
+         * so every vertex records the highest triangle touching it and takes that tangent.
+         */
+        void computeTangentsParallel(std::vector<Mesh::Vertex>& vertices, const std::vector<uint32_t>& indices,
+            const uint32_t threadCount) {
+
+            const size_t triangleCount = indices.size() / 3;
+
+            std::vector<glm::vec4> triangleTangents(triangleCount);
+            std::vector<std::atomic<uint32_t>> lastTriangles(vertices.size()); // triangle + 1, 0 if unused
+
+            const size_t triangleChunkCount = (triangleCount + TRIANGLES_PER_CHUNK - 1) / TRIANGLES_PER_CHUNK;
+            parallelFor(triangleChunkCount, threadCount, [&](const size_t c) {
+                const size_t end = std::min((c + 1) * TRIANGLES_PER_CHUNK, triangleCount);
+
+                for (size_t t = c * TRIANGLES_PER_CHUNK; t < end; t++) {
+                    const uint32_t* triangle = &indices[t * 3];
+
+                    triangleTangents[t] = computeTangent(
+                        vertices[triangle[0]], vertices[triangle[1]], vertices[triangle[2]]);
+
+                    for (uint32_t i = 0; i < 3; i++) {
+                        auto& last = lastTriangles[triangle[i]];
+                        uint32_t current = last.load(std::memory_order_relaxed);
+
+                        while (current < t + 1 &&
+                            !last.compare_exchange_weak(current, static_cast<uint32_t>(t + 1), std::memory_order_relaxed)) {
+                        }
+                    }
+                }
+            });
+
+            const size_t vertexChunkCount = (vertices.size() + CORNERS_PER_CHUNK - 1) / CORNERS_PER_CHUNK;
+            parallelFor(vertexChunkCount, threadCount, [&](const size_t c) {
+                const size_t end = std::min((c + 1) * CORNERS_PER_CHUNK, vertices.size());
+
+                for (size_t v = c * CORNERS_PER_CHUNK; v < end; v++) {
+                    const uint32_t last = lastTriangles[v].load(std::memory_order_relaxed);
+
+                    if (last > 0) {
+                        vertices[v].tangent = triangleTangents[last - 1];
+                    }
+                }
+            });
+        }
+    }
+
+    void MeshImporter::parseObj(const std::filesystem::path& filePath, std::vector<Mesh::Vertex>& vertices,
+        std::vector<uint32_t>& indices, uint32_t threadCount) {
+        PXT_PROFILE_FN();
+
+		tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warn, err;
+
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filePath.string().c_str())) {
+            throw std::runtime_error(warn + err);
+        }
+
+        vertices.clear();
+        indices.clear();
+
+        // the workers of the JobSystem and the calling thread, which runs jobs while it waits
+        if (threadCount == 0) {
+            threadCount = JobSystem::getWorkerCount() + 1;
+        }
+
+        size_t cornerCount = 0;
+        for (const auto& shape : shapes) {
+            cornerCount += shape.mesh.indices.size();
+        }
+
+        // small meshes are not worth the thread start up cost
+        if (threadCount == 1 || cornerCount < PARALLEL_CORNER_THRESHOLD) {
+            assembleSerial(attrib, shapes, vertices, indices);
+            computeTangentsSerial(vertices, indices);
+        } else {
+            assembleParallel(attrib, shapes, cornerCount, threadCount, vertices, indices);
+            computeTangentsParallel(vertices, indices, threadCount);
+        }
+	}
+}
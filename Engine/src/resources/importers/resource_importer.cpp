@@ -7,31 +7,37 @@
 namespace PXTEngine {
 
     namespace {
-        using ResourceImportFunction = std::function<Shared<Resource>(
-            ResourceManager&,
-            const std::filesystem::path,
+        using ResourceLoadFunction = std::function<ResourceFinalizer(
+            const std::filesystem::path&,
             ResourceInfo* resourceInfo
         )>;
 
-        std::unordered_map<std::string, ResourceImportFunction> extensionToImportFunction = {
-            {".png", TextureImporter::import},
-            {".jpg", TextureImporter::import},
-            {".jpeg", TextureImporter::import},
-            {".obj", MeshImporter::importObj}
+        const std::unordered_map<std::string, ResourceLoadFunction> extensionToLoadFunction = {
+            {".png", TextureImporter::load},
+            {".jpg", TextureImporter::load},
+            {".jpeg", TextureImporter::load},
+            {COOKED_TEXTURE_EXTENSION, TextureImporter::loadCooked},
+            {".obj", MeshImporter::loadObj},
+            {COOKED_MESH_EXTENSION, MeshImporter::loadCooked}
         };
     }
 
     Shared<Resource> ResourceImporter::import(ResourceManager& rm, const std::filesystem::path& filePath,
         ResourceInfo* resourceInfo) {
 
+        return load(filePath, resourceInfo)();
+    }
+
+    ResourceFinalizer ResourceImporter::load(const std::filesystem::path& filePath, ResourceInfo* resourceInfo) {
+
         std::string extension = filePath.extension().string();
 
-        auto it = extensionToImportFunction.find(extension);
+        auto it = extensionToLoadFunction.find(extension);
 
-        if (it == extensionToImportFunction.end()) {
+        if (it == extensionToLoadFunction.end()) {
             throw std::runtime_error("Unsupported file extension: " + extension);
         }
 
-        return it->second(rm, filePath, resourceInfo);
+        return it->second(filePath, resourceInfo);
     }
 }
\ No newline at end of file
@@ -10,5 +10,17 @@ namespace PXTEngine {
     public:
         static Shared<Resource> import(ResourceManager& rm, const std::filesystem::path& filePath,
             ResourceInfo* resourceInfo = nullptr);
+
+        /**
+         * @brief Decodes a file without creating any GPU object, can be called from any thread.
+         *
+         * @param filePath The path of the file to load.
+         * @param resourceInfo Optional additional information about the resource.
+         *
+         * @return The finalizer creating the resource, to be called on the main thread.
+         *
+         * @throws std::runtime_error if the extension is not supported or the file cannot be decoded.
+         */
+        static ResourceFinalizer load(const std::filesystem::path& filePath, ResourceInfo* resourceInfo = nullptr);
     };
-}
\ No newline at end of file
+}
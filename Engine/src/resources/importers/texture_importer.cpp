@@ -1,53 +1,269 @@
 #include "resources/importers/texture_importer.hpp"
 
 #include "core/pch.hpp"
-#include "core/buffer.hpp"
+#include "core/mapped_file.hpp"
+#include "application.hpp"
 #include "graphics/resources/texture2d.hpp"
+#include "resources/importers/block_compression.hpp"
+#include "resources/importers/cooked_asset.hpp"
+#include "resources/importers/mip_generator.hpp"
 
 #include <stb_image.h>
 
 namespace PXTEngine {
 
+	namespace {
+		ImageInfo getRequestedInfo(ResourceInfo* resourceInfo) {
+			if (resourceInfo == nullptr) {
+				return ImageInfo(0, 0, 0, RGBA8_LINEAR);
+			}
+
+			if (const auto* info = dynamic_cast<ImageInfo*>(resourceInfo)) {
+				return *info;
+			}
+
+			throw std::runtime_error("TextureImporter - Invalid resourceInfo type: not ImageInfo");
+		}
+
+		uint16_t getChannelCount(const ImageFormat format) {
+			switch (format) {
+				case BC4_LINEAR: return 1;
+				case BC5_LINEAR: return 2;
+				default: return 4;
+			}
+		}
+
+		/**
+		 * @brief Name of the cooks of an ImageInfo, the cooked format depends on the usage and color space.
+		 */
+		std::string getCookedVariant(const ImageInfo& imageInfo) {
+			if (imageInfo.usage == NORMAL_MAP) return "normal";
+			return isSrgbFormat(imageInfo.format) ? "srgb" : "linear";
+		}
+	}
+
 	Shared<Image> TextureImporter::import(ResourceManager& rm, const std::filesystem::path& filePath,
 		ResourceInfo* resourceInfo) {
 
+		return std::static_pointer_cast<Image>(load(filePath, resourceInfo)());
+	}
+
+	ResourceFinalizer TextureImporter::load(const std::filesystem::path& filePath, ResourceInfo* resourceInfo) {
+		PXT_PROFILE_FN();
+
+		ImageInfo imageInfo = getRequestedInfo(resourceInfo);
+
+		// devices without BC support upload the decoded RGBA8 pixels, with the mip chain built here
+		if (!Application::get().getContext().supportsBlockCompression()) {
+			Shared<Buffer> pixels = decode(filePath, imageInfo);
+			Shared<Buffer> levels = MipGenerator::generate(*pixels, imageInfo);
+
+			return [imageInfo, levels]() -> Shared<Resource> {
+				return Texture2D::create(imageInfo, *levels);
+			};
+		}
+
+		const std::filesystem::path cookedPath = getCookedPath(filePath, imageInfo);
+
+		if (CookedAsset::isUpToDate(filePath, cookedPath)) {
+			try {
+				return loadCooked(cookedPath, resourceInfo);
+			} catch (const std::exception& e) {
+				PXT_WARN("Invalid cooked texture '{}', cooking it again: {}", cookedPath.string(), e.what());
+			}
+		}
+
+		Shared<Buffer> pixels = decode(filePath, imageInfo);
+		Shared<Buffer> blocks = compress(*pixels, imageInfo);
+
+		// cook on first run, a failure here only means that the next launch will compress the image again
+		try {
+			writeCooked(cookedPath, imageInfo, *blocks);
+		} catch (const std::exception& e) {
+			PXT_WARN("Failed to write cooked texture '{}': {}", cookedPath.string(), e.what());
+		}
+
+		return [imageInfo, blocks]() -> Shared<Resource> {
+			return Texture2D::create(imageInfo, *blocks);
+		};
+	}
+
+	ResourceFinalizer TextureImporter::loadCooked(const std::filesystem::path& filePath, ResourceInfo* resourceInfo) {
+		PXT_PROFILE_FN();
+
+		auto file = createShared<MappedFile>(filePath);
+
+		if (file->size() < sizeof(CookedTextureHeader)) {
+			throw std::runtime_error("cooked texture is too small: " + filePath.string());
+		}
+
+		const auto* header = file->get<CookedTextureHeader>();
+		const auto format = static_cast<ImageFormat>(header->format);
+
+		if (header->magic != CookedTextureHeader::MAGIC || header->version != CookedTextureHeader::VERSION ||
+			!isBlockCompressed(format) || header->mipLevels == 0) {
+			throw std::runtime_error("cooked texture has an incompatible format: " + filePath.string());
+		}
+
+		ImageInfo imageInfo = getRequestedInfo(resourceInfo);
+
+		if (isSrgbFormat(imageInfo.format) != isSrgbFormat(format)) {
+			throw std::runtime_error("cooked texture has a different color space: " + filePath.string());
+		}
+
+		if ((imageInfo.usage == NORMAL_MAP) != (format == BC5_LINEAR)) {
+			throw std::runtime_error("cooked texture has a different usage: " + filePath.string());
+		}
+
+		const uint64_t levelsEnd = sizeof(CookedTextureHeader) + sizeof(CookedTextureLevel) * header->mipLevels;
+
+		if (levelsEnd > file->size() || header->dataOffset < levelsEnd ||
+			header->dataOffset + header->dataSize > file->size()) {
+			throw std::runtime_error("cooked texture is truncated: " + filePath.string());
+		}
+
+		// the upload expects the levels packed one after the other
+		const auto* levels = file->get<CookedTextureLevel>(sizeof(CookedTextureHeader));
+		uint64_t offset = header->dataOffset;
+
+		for (uint32_t level = 0; level < header->mipLevels; level++) {
+			const uint64_t size = getImageLevelSize(format,
+				std::max(1u, header->width >> level), std::max(1u, header->height >> level));
+
+			if (levels[level].offset != offset || levels[level].size != size) {
+				throw std::runtime_error("cooked texture has an invalid level index: " + filePath.string());
+			}
+
+			offset += size;
+		}
+
+		if (offset != header->dataOffset + header->dataSize) {
+			throw std::runtime_error("cooked texture has an invalid level index: " + filePath.string());
+		}
+
+		imageInfo.width = header->width;
+		imageInfo.height = header->height;
+		imageInfo.format = format;
+		imageInfo.channels = getChannelCount(format);
+		imageInfo.mipLevels = header->mipLevels;
+
+		// the blocks are handed to the staging buffer as they are, the finalizer keeps the file mapped
+		return [file, header, imageInfo]() -> Shared<Resource> {
+			return Texture2D::create(imageInfo,
+				std::span<const uint8_t>(file->data() + header->dataOffset, header->dataSize));
+		};
+	}
+
+	std::filesystem::path TextureImporter::cook(const std::filesystem::path& filePath, ResourceInfo* resourceInfo) {
+		ImageInfo imageInfo = getRequestedInfo(resourceInfo);
+		const std::filesystem::path cookedPath = getCookedPath(filePath, imageInfo);
+
+		Shared<Buffer> pixels = decode(filePath, imageInfo);
+		Shared<Buffer> blocks = compress(*pixels, imageInfo);
+
+		writeCooked(cookedPath, imageInfo, *blocks);
+
+		return cookedPath;
+	}
+
+	std::filesystem::path TextureImporter::getCookedPath(const std::filesystem::path& filePath, const ImageInfo& imageInfo) {
+		return CookedAsset::getPath(filePath, COOKED_TEXTURE_EXTENSION, getCookedVariant(imageInfo));
+	}
+
+	Shared<Buffer> TextureImporter::decode(const std::filesystem::path& filePath, ImageInfo& imageInfo) {
+		PXT_PROFILE_FN();
+
 		int width, height, channels;
 
-        // Currently every image is loaded as RGBA
+		// Currently every image is loaded as RGBA
 		constexpr uint16_t requestedChannels = STBI_rgb_alpha;
 
-		Buffer pixels;
-
-		pixels.bytes = stbi_load(
-                    filePath.string().c_str(),
-                    &width,
-                    &height,
-                    &channels,
-                    requestedChannels
-        );
+		// shared so that the finalizer doesn't deep copy the pixels when it is moved around
+		auto pixels = createShared<Buffer>();
 
-		pixels.size = width * height * requestedChannels;
+		pixels->bytes = stbi_load(
+			filePath.string().c_str(),
+			&width,
+			&height,
+			&channels,
+			requestedChannels
+		);
 
-		if (!pixels) {
-            pixels.release();
+		if (!pixels->bytes) {
 			throw std::runtime_error("failed to load image from file: " + filePath.string());
 		}
 
-		ImageInfo imageInfo;
+		pixels->size = static_cast<size_t>(width) * height * requestedChannels;
+
+		imageInfo.width = width;
+		imageInfo.height = height;
+		imageInfo.channels = requestedChannels;
+		imageInfo.mipLevels = 1;
+
+		return pixels;
+	}
+
+	Shared<Buffer> TextureImporter::compress(const Buffer& pixels, ImageInfo& imageInfo) {
+		PXT_PROFILE_FN();
+
+		const ImageFormat format = BlockCompression::chooseFormat(pixels.bytes, pixels.size / 4, imageInfo);
+
+		// the mips are filtered from the RGBA8 pixels (in linear space for sRGB images) and then compressed
+		Shared<Buffer> levels = MipGenerator::generate(pixels, imageInfo);
+
+		size_t dataSize = 0;
+		for (uint32_t level = 0; level < imageInfo.mipLevels; level++) {
+			dataSize += getImageLevelSize(format,
+				std::max(1u, imageInfo.width >> level), std::max(1u, imageInfo.height >> level));
+		}
+
+		auto blocks = createShared<Buffer>(dataSize);
+
+		size_t sourceOffset = 0;
+		size_t offset = 0;
+
+		for (uint32_t level = 0; level < imageInfo.mipLevels; level++) {
+			const uint32_t width = std::max(1u, imageInfo.width >> level);
+			const uint32_t height = std::max(1u, imageInfo.height >> level);
+
+			BlockCompression::compress(levels->bytes + sourceOffset, width, height, format, blocks->bytes + offset);
+
+			sourceOffset += getImageLevelSize(imageInfo.format, width, height);
+			offset += getImageLevelSize(format, width, height);
+		}
+
+		imageInfo.format = format;
+		imageInfo.channels = getChannelCount(format);
+
+		return blocks;
+	}
+
+	void TextureImporter::writeCooked(const std::filesystem::path& cookedPath, const ImageInfo& imageInfo,
+		const Buffer& data) {
+
+		CookedTextureHeader header{};
+		header.format = imageInfo.format;
+		header.width = imageInfo.width;
+		header.height = imageInfo.height;
+		header.mipLevels = imageInfo.mipLevels;
+		header.dataOffset = sizeof(CookedTextureHeader) + sizeof(CookedTextureLevel) * imageInfo.mipLevels;
+		header.dataSize = data.size;
+
+		std::vector<CookedTextureLevel> levels(imageInfo.mipLevels);
+		uint64_t offset = header.dataOffset;
 
-        if (resourceInfo != nullptr) {
-            if (const auto* info = dynamic_cast<ImageInfo*>(resourceInfo)) {
-                imageInfo = *info;
-                imageInfo.width = width;
-                imageInfo.height = height;
-                imageInfo.channels = requestedChannels;
-            } else {
-                throw std::runtime_error("TextureImporter - Invalid resourceInfo type: not ImageInfo");
-            }
-        } else {
-            imageInfo = ImageInfo(width, height, requestedChannels, RGBA8_LINEAR);
-        }
+		for (uint32_t level = 0; level < imageInfo.mipLevels; level++) {
+			levels[level].offset = offset;
+			levels[level].size = getImageLevelSize(imageInfo.format,
+				std::max(1u, imageInfo.width >> level), std::max(1u, imageInfo.height >> level));
+
+			offset += levels[level].size;
+		}
 
-		return Texture2D::create(imageInfo, pixels);
+		CookedAsset::write(cookedPath, {
+			std::as_bytes(std::span(&header, 1)),
+			std::as_bytes(std::span(levels)),
+			std::span(reinterpret_cast<const std::byte*>(data.bytes), data.size)
+		});
 	}
 }
\ No newline at end of file
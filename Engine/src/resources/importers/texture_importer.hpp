@@ -1,14 +1,115 @@
 #pragma once
 
 #include "core/pch.hpp"
+#include "core/buffer.hpp"
 #include "resources/types/image.hpp"
 #include "resources/resource_manager.hpp"
 
 namespace PXTEngine {
 
+	/**
+	 * @brief Extension of the cooked (block compressed) texture files.
+	 */
+	const std::string COOKED_TEXTURE_EXTENSION = ".pxtex";
+
+	/**
+	 * @struct CookedTextureHeader
+	 *
+	 * @brief Header of a cooked texture file.
+	 *
+	 * A cooked texture file is laid out as (similarly to KTX2):
+	 * [CookedTextureHeader][CookedTextureLevel * mipLevels][level 0 blocks][level 1 blocks]...
+	 *
+	 * The levels are tightly packed from the biggest one, so the data can be handed to the
+	 * GPU upload as a single range of the memory mapped file.
+	 */
+	struct CookedTextureHeader {
+		static constexpr uint32_t MAGIC = 0x58455450; // "PTEX" (little-endian)
+		static constexpr uint32_t VERSION = 3; // 2: mips of sRGB textures filtered in linear space, 3: odd edges folded in the mips
+
+		uint32_t magic = MAGIC;
+		uint32_t version = VERSION;
+		uint32_t format = 0; // ImageFormat
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevels = 0;
+		uint64_t dataOffset = 0;
+		uint64_t dataSize = 0;
+	};
+
+	/**
+	 * @struct CookedTextureLevel
+	 *
+	 * @brief Position of a mip level in a cooked texture file.
+	 */
+	struct CookedTextureLevel {
+		uint64_t offset = 0; // from the beginning of the file
+		uint64_t size = 0;
+	};
+
 	class TextureImporter {
 	public:
-		static Shared<Image> import(ResourceManager& rm, const std::filesystem::path& filePath, 
+		static Shared<Image> import(ResourceManager& rm, const std::filesystem::path& filePath,
 			ResourceInfo* resourceInfo = nullptr);
+
+		/**
+		 * @brief Decodes an image file, can be called from any thread.
+		 *
+		 * If the device supports block compression the image is cooked on first import and the
+		 * cooked texture is loaded instead of the source file from then on.
+		 *
+		 * @return The finalizer creating the texture, to be called on the main thread.
+		 */
+		static ResourceFinalizer load(const std::filesystem::path& filePath, ResourceInfo* resourceInfo = nullptr);
+
+		/**
+		 * @brief Loads a cooked texture by memory mapping it, can be called from any thread.
+		 *
+		 * The file stays mapped until the returned finalizer is destroyed.
+		 *
+		 * @return The finalizer creating the texture, to be called on the main thread.
+		 */
+		static ResourceFinalizer loadCooked(const std::filesystem::path& filePath, ResourceInfo* resourceInfo = nullptr);
+
+		/**
+		 * @brief Cooks an image file and writes the result next to the source file.
+		 *
+		 * The destination format is chosen from the image and its usage, see BlockCompression::chooseFormat.
+		 *
+		 * A full mip chain is generated and stored with the texture.
+		 * Can be used offline to cook assets before shipping them.
+		 *
+		 * @param filePath The path of the image file.
+		 * @param resourceInfo The ImageInfo the texture is imported with, used for its color space and usage.
+		 *
+		 * @return The path of the written cooked texture.
+		 */
+		static std::filesystem::path cook(const std::filesystem::path& filePath, ResourceInfo* resourceInfo = nullptr);
+
+		/**
+		 * @brief Returns the path of the cooked texture associated with a source file.
+		 *
+		 * The color space and the usage are part of the name ("albedo.srgb.pxtex", "normal.normal.pxtex"),
+		 * so that importing an image with another ImageInfo cooks it again instead of loading the wrong format.
+		 */
+		static std::filesystem::path getCookedPath(const std::filesystem::path& filePath, const ImageInfo& imageInfo);
+
+	private:
+		/**
+		 * @brief Decodes an image file to RGBA8.
+		 */
+		static Shared<Buffer> decode(const std::filesystem::path& filePath, ImageInfo& imageInfo);
+
+		/**
+		 * @brief Generates the mip chain of an RGBA8 image and block compresses it.
+		 *
+		 * @param pixels The RGBA8 pixels of the image.
+		 * @param imageInfo The image info, format, channels and mip levels are updated.
+		 *
+		 * @return The blocks of every mip level.
+		 */
+		static Shared<Buffer> compress(const Buffer& pixels, ImageInfo& imageInfo);
+
+		static void writeCooked(const std::filesystem::path& cookedPath, const ImageInfo& imageInfo, const Buffer& data);
 	};
-}
\ No newline at end of file
+}
@@ -17,6 +17,11 @@ namespace PXTEngine {
 	struct ResourceInfo
 	{
 		virtual ~ResourceInfo() = default;
+
+		/**
+		 * @brief Returns a copy of the info, used when the import outlives the caller (async loads).
+		 */
+		virtual Unique<ResourceInfo> clone() const { return createUnique<ResourceInfo>(*this); }
 	};
 
 	/**
@@ -42,4 +47,12 @@ namespace PXTEngine {
 		ResourceId id;
 	};
 
+	/**
+	 * @brief Second half of an import, creating the resource from the data decoded by the first half.
+	 *
+	 * Decoding is CPU only and can run on any thread, while the finalizer creates the GPU objects
+	 * and must run on the main thread.
+	 */
+	using ResourceFinalizer = std::function<Shared<Resource>()>;
+
 }
\ No newline at end of file
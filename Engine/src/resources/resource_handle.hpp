@@ -0,0 +1,115 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "core/jobs/job_system.hpp"
+#include "resources/resource.hpp"
+
+namespace PXTEngine {
+
+	class ResourceManager;
+
+	/**
+	 * @class ResourceRequest
+	 *
+	 * @brief Shared state of an import started by the ResourceManager.
+	 *
+	 * The file is decoded by a job, then the resource is created and published by the
+	 * ResourceManager on the main thread. Until then get() returns the placeholder.
+	 */
+	class ResourceRequest {
+	public:
+		using Callback = std::function<void(const Shared<Resource>&)>;
+
+		ResourceRequest(std::string alias, Shared<Resource> placeholder)
+			: m_alias(std::move(alias)), m_placeholder(std::move(placeholder)) {}
+
+		ResourceRequest(const ResourceRequest&) = delete;
+		ResourceRequest& operator=(const ResourceRequest&) = delete;
+
+		const std::string& getAlias() const { return m_alias; }
+
+		/**
+		 * @brief Returns true once the request has been resolved, successfully or not.
+		 */
+		bool isReady() const { return m_ready.load(std::memory_order_acquire); }
+
+		/**
+		 * @brief Returns true if the import failed, get() keeps returning the placeholder.
+		 */
+		bool hasFailed() const { return isReady() && m_resource == nullptr; }
+
+		/**
+		 * @brief Returns the loaded resource, or the placeholder while it is loading or if it failed.
+		 */
+		Shared<Resource> get() const {
+			return isReady() && m_resource ? m_resource : m_placeholder;
+		}
+
+		/**
+		 * @brief Registers a function called with the loaded resource once it is available.
+		 *
+		 * The function always runs on the main thread: when the request is resolved, or right
+		 * away if it already is and the caller is the main thread, otherwise in the next
+		 * ResourceManager::processCompletedLoads. It is not called if the import fails.
+		 */
+		void onReady(Callback callback);
+
+	private:
+		ResourceManager* m_manager = nullptr;
+		std::string m_alias;
+		Shared<Resource> m_placeholder;
+		Shared<Resource> m_resource = nullptr;
+		std::atomic<bool> m_ready = false;
+
+		// guards the callbacks and makes sure the request is resolved once
+		std::mutex m_mutex;
+		std::vector<Callback> m_callbacks;
+
+		// written by the loading job, read by the resolving thread once m_counter is done
+		JobCounter m_counter;
+		Unique<ResourceInfo> m_resourceInfo = nullptr;
+		ResourceFinalizer m_finalizer = nullptr;
+		std::string m_error;
+
+		friend class ResourceManager;
+	};
+
+	/**
+	 * @class ResourceHandle
+	 *
+	 * @brief Typed view over a ResourceRequest.
+	 *
+	 * @tparam T The type of the requested resource.
+	 */
+	template<typename T>
+	class ResourceHandle {
+	public:
+		ResourceHandle() = default;
+		explicit ResourceHandle(Shared<ResourceRequest> request) : m_request(std::move(request)) {}
+
+		/**
+		 * @brief Returns the loaded resource, or the placeholder while it is loading.
+		 */
+		Shared<T> get() const {
+			return m_request ? std::static_pointer_cast<T>(m_request->get()) : nullptr;
+		}
+
+		bool isReady() const { return m_request && m_request->isReady(); }
+
+		/**
+		 * @brief Registers a function called when the resource is loaded.
+		 */
+		void onReady(std::function<void(const Shared<T>&)> callback) const {
+			if (!m_request) return;
+
+			m_request->onReady([callback = std::move(callback)](const Shared<Resource>& resource) {
+				callback(std::static_pointer_cast<T>(resource));
+			});
+		}
+
+		const Shared<ResourceRequest>& getRequest() const { return m_request; }
+
+	private:
+		Shared<ResourceRequest> m_request = nullptr;
+	};
+}
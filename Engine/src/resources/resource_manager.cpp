@@ -1,51 +1,303 @@
 #include "resources/resource_manager.hpp"
 
 #include "resources/importers/resource_importer.hpp"
+#include "resources/types/material.hpp"
 
 namespace PXTEngine {
 
 	Shared<Material> ResourceManager::defaultMaterial = nullptr;
 
 	ResourceManager::~ResourceManager() {
+		std::vector<Shared<ResourceRequest>> pendingRequests;
+		{
+			std::lock_guard lock(m_pendingMutex);
+			for (const auto& request : m_pendingRequests | std::views::values) {
+				pendingRequests.push_back(request);
+			}
+		}
+
+		// the loading jobs reference the manager, they must end before it is destroyed
+		for (const auto& request : pendingRequests) {
+			JobSystem::wait(request->m_counter);
+		}
+
 		defaultMaterial = nullptr;
 	}
 
 	Shared<Resource> ResourceManager::get(const std::string& alias, ResourceInfo* resourceInfo) {
 
-		auto aliasIt = m_aliases.find(alias);
+		if (auto resource = find(alias)) {
+			return resource;
+		}
 
-		const ResourceId id = aliasIt != m_aliases.end()
-			? aliasIt->second    // Retrieve the ID from the alias map.
-			: ResourceId(alias); // Try using the alias as a UUID string.
+		// join the import of the alias if one is running, otherwise start it and wait for it
+		// (the waiting thread usually ends up running the import job itself)
+		return wait(getAsync(alias, resourceInfo, nullptr));
+	}
 
-		if (const auto it = m_resources.find(id); it != m_resources.end()) {
-			return it->second;
+	Shared<Resource> ResourceManager::wait(const Shared<ResourceRequest>& request) {
+		JobSystem::wait(request->m_counter);
+
+		if (isMainThread()) {
+			resolve(request);
+		} else {
+			// the finalizer uses the Context queue, the main thread runs it in processCompletedLoads
+			request->m_ready.wait(false, std::memory_order_acquire);
+		}
+
+		return request->m_resource;
+	}
+
+	Shared<ResourceRequest> ResourceManager::getAsync(const std::string& alias, ResourceInfo* resourceInfo,
+		const Shared<Resource>& placeholder) {
+
+		auto request = createShared<ResourceRequest>(alias, placeholder);
+		request->m_manager = this;
+		{
+			std::lock_guard lock(m_pendingMutex);
+
+			if (const auto it = m_pendingRequests.find(alias); it != m_pendingRequests.end()) {
+				// the import in flight keeps the info and the placeholder of its first request
+				const ResourceRequest& pending = *it->second;
+				const bool isInfoDifferent = resourceInfo &&
+					(!pending.m_resourceInfo || typeid(*resourceInfo) != typeid(*pending.m_resourceInfo));
+
+				if (isInfoDifferent || (placeholder && placeholder != pending.m_placeholder)) {
+					PXT_WARN("Resource '{}' is already being imported, its resource info and placeholder are kept", alias);
+				}
+
+				return it->second;
+			}
+
+			// checked under the lock: resolve adds the resource before removing the pending request
+			if (auto resource = find(alias)) {
+				request->m_resource = resource;
+				request->m_ready = true;
+				return request;
+			}
+
+			request->m_resourceInfo = resourceInfo ? resourceInfo->clone() : nullptr;
+			m_pendingRequests[alias] = request;
+		}
+
+		JobSystem::run([this, request]() {
+			try {
+				request->m_finalizer = ResourceImporter::load(request->m_alias, request->m_resourceInfo.get());
+			} catch (const std::exception& e) {
+				request->m_error = e.what();
+			}
+
+			std::lock_guard lock(m_completedMutex);
+			m_completedRequests.push_back(request);
+		}, &request->m_counter);
+
+		return request;
+	}
+
+	void ResourceManager::processCompletedLoads() {
+		PXT_ASSERT(isMainThread(), "The resources are created on the main thread");
+
+		std::vector<Shared<ResourceRequest>> completedRequests;
+		{
+			std::lock_guard lock(m_completedMutex);
+			completedRequests.swap(m_completedRequests);
+		}
+
+		for (const auto& request : completedRequests) {
+			resolve(request);
+		}
+
+		std::vector<std::pair<ResourceRequest::Callback, Shared<Resource>>> queuedCallbacks;
+		{
+			std::lock_guard lock(m_callbackMutex);
+			queuedCallbacks.swap(m_queuedCallbacks);
+		}
+
+		for (const auto& [callback, resource] : queuedCallbacks) {
+			callback(resource);
 		}
+	}
 
-		const auto filePath = std::filesystem::path(alias);
+	void ResourceManager::waitForPendingLoads() {
+		PXT_PROFILE_FN();
+		PXT_ASSERT(isMainThread(), "The resources are created on the main thread");
 
-		try {
-			auto importedResource = ResourceImporter::import(*this, filePath, resourceInfo);
+		// resolving a request can run callbacks starting new ones, so loop until none is left
+		while (true) {
+			Shared<ResourceRequest> request;
+			{
+				std::lock_guard lock(m_pendingMutex);
+				if (m_pendingRequests.empty()) break;
 
-			add(importedResource, alias);
+				request = m_pendingRequests.begin()->second;
+			}
 
-			return importedResource;
-		} catch (const std::exception& e) {
-			std::cerr << "Failed to import resource: " << e.what() << '\n';
-			return nullptr;
+			JobSystem::wait(request->m_counter);
+			resolve(request);
 		}
+
+		// drop the requests already resolved above
+		processCompletedLoads();
+	}
+
+	bool ResourceManager::hasPendingLoads() const {
+		std::lock_guard lock(m_pendingMutex);
+		return !m_pendingRequests.empty();
 	}
 
 	ResourceId ResourceManager::add(const Shared<Resource>& resource, const std::string& alias) {
 		const ResourceId id = resource->id;
-		m_resources[id] = resource;
-		m_aliases[alias] = id;
+		{
+			Shard& shard = getShard(id);
+			std::unique_lock lock(shard.mutex);
+			shard.resources[id] = resource;
+		}
+		{
+			Shard& shard = getShard(alias);
+			std::unique_lock lock(shard.mutex);
+			shard.aliases[alias] = id;
+		}
+
+		ResourceRequest::Callback callback;
+		{
+			std::lock_guard lock(m_callbackMutex);
+			callback = m_resourceAddedCallback;
+		}
+
+		if (callback) {
+			if (isMainThread()) {
+				callback(resource);
+			} else {
+				queueCallback(std::move(callback), resource);
+			}
+		}
+
 		return id;
 	}
 
+	void ResourceManager::setResourceAddedCallback(ResourceRequest::Callback callback) {
+		std::lock_guard lock(m_callbackMutex);
+		m_resourceAddedCallback = std::move(callback);
+	}
+
 	void ResourceManager::foreach(const std::function<void(const Shared<Resource>&)>& function) {
-		for (const auto& resource : m_resources | std::views::values) {
-			function(resource);
+		for (const auto& shard : m_shards) {
+			std::shared_lock lock(shard.mutex);
+
+			for (const auto& resource : shard.resources | std::views::values) {
+				function(resource);
+			}
+		}
+	}
+
+	Shared<Resource> ResourceManager::find(const std::string& alias) const {
+		const Shard& aliasShard = getShard(alias);
+		std::shared_lock aliasLock(aliasShard.mutex);
+
+		auto aliasIt = aliasShard.aliases.find(alias);
+
+		const ResourceId id = aliasIt != aliasShard.aliases.end()
+			? aliasIt->second    // Retrieve the ID from the alias map.
+			: ResourceId(alias); // Try using the alias as a UUID string.
+
+		aliasLock.unlock();
+
+		const Shard& shard = getShard(id);
+		std::shared_lock lock(shard.mutex);
+
+		if (const auto it = shard.resources.find(id); it != shard.resources.end()) {
+			return it->second;
+		}
+
+		return nullptr;
+	}
+
+	Shared<Resource> ResourceManager::getDefaultResource(const Resource::Type type) const {
+		switch (type) {
+			case Resource::Type::Image:
+				return find(WHITE_PIXEL);
+			case Resource::Type::Material:
+				return defaultMaterial;
+			default:
+				return nullptr;
+		}
+	}
+
+	void ResourceManager::resolve(const Shared<ResourceRequest>& request) {
+		PXT_ASSERT(isMainThread(), "The resources are created on the main thread");
+
+		std::vector<ResourceRequest::Callback> callbacks;
+		{
+			std::lock_guard lock(request->m_mutex);
+
+			// already resolved, by a get() of the same alias
+			if (request->isReady()) return;
+
+			if (request->m_finalizer) {
+				try {
+					request->m_resource = request->m_finalizer();
+				} catch (const std::exception& e) {
+					request->m_error = e.what();
+				}
+			}
+
+			if (!request->m_error.empty()) {
+				PXT_ERROR("Failed to import resource '{}': {}", request->m_alias, request->m_error);
+				request->m_resource = nullptr;
+			}
+
+			if (request->m_resource) {
+				add(request->m_resource, request->m_alias);
+			}
+
+			// release the decoded data and the copied info
+			request->m_finalizer = nullptr;
+			request->m_resourceInfo = nullptr;
+
+			request->m_ready.store(true, std::memory_order_release);
+			callbacks.swap(request->m_callbacks);
+		}
+
+		// wake up the get() of the other threads
+		request->m_ready.notify_all();
+
+		{
+			std::lock_guard lock(m_pendingMutex);
+
+			if (const auto it = m_pendingRequests.find(request->m_alias);
+				it != m_pendingRequests.end() && it->second == request) {
+				m_pendingRequests.erase(it);
+			}
+		}
+
+		if (request->m_resource) {
+			for (const auto& callback : callbacks) {
+				callback(request->m_resource);
+			}
+		}
+	}
+
+	void ResourceManager::queueCallback(ResourceRequest::Callback callback, const Shared<Resource>& resource) {
+		std::lock_guard lock(m_callbackMutex);
+		m_queuedCallbacks.emplace_back(std::move(callback), resource);
+	}
+
+	void ResourceRequest::onReady(Callback callback) {
+		{
+			std::lock_guard lock(m_mutex);
+
+			if (!isReady()) {
+				m_callbacks.push_back(std::move(callback));
+				return;
+			}
+		}
+
+		if (!m_resource) return;
+
+		if (m_manager->isMainThread()) {
+			callback(m_resource);
+		} else {
+			m_manager->queueCallback(std::move(callback), m_resource);
 		}
 	}
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 
 #include "core/pch.hpp"
 #include "resources/resource.hpp"
+#include "resources/resource_handle.hpp"
 
 namespace PXTEngine {
 
@@ -12,6 +13,14 @@ namespace PXTEngine {
 	 * @class ResourceManager
 	 *
 	 * @brief Manages resources in the engine, allowing for retrieval and storage of resources.
+	 *
+	 * The registry is split in shards, each guarded by a reader/writer lock, so it can be used
+	 * from any thread. Imports are tracked by alias: concurrent requests for a resource that is
+	 * being imported wait for that import instead of starting another one.
+	 *
+	 * Files are decoded by the JobSystem, but the finalizers (which record GPU commands on the
+	 * Context queue) and the onReady callbacks only run on the main thread, the thread that
+	 * created the manager: the other threads queue them for processCompletedLoads.
 	 */
 	class ResourceManager {
 	public:
@@ -39,6 +48,13 @@ namespace PXTEngine {
 		 * If the alias is not found, it tries to load the resource using the provided string
 		 * as resourceId. If the resource is not found, it returns a nullptr.
 		 *
+		 * Thread safe. On the main thread the resource is created right away, on another thread
+		 * the call blocks until the main thread creates it in processCompletedLoads, so the main
+		 * thread must not be waiting for the calling job meanwhile.
+		 *
+		 * If the alias is already being imported, that import is waited for with the resourceInfo
+		 * it was started with, see getAsync.
+		 *
 		 * @param alias The alias of the resource to retrieve.
 		 * @param resourceInfo Optional pointer to store additional resource information.
 		 *
@@ -46,6 +62,89 @@ namespace PXTEngine {
 		 */
 		Shared<Resource> get(const std::string& alias, ResourceInfo* resourceInfo = nullptr);
 
+		/**
+		 * @brief Starts importing a resource in the background and returns a handle to it.
+		 *
+		 * The file is decoded by the JobSystem while the caller keeps going, the handle returns
+		 * the placeholder until the resource is created by processCompletedLoads (or by a get()
+		 * of the same alias). Concurrent requests for the same alias share the same import.
+		 *
+		 * If the alias is already being imported, the request of that import is returned as it is:
+		 * the resourceInfo and placeholder of the first request are kept and the ones passed here
+		 * are ignored, a warning is logged if the placeholder or the type of the info differs.
+		 *
+		 * @tparam T The type of the resource to retrieve.
+		 * @param alias The alias (file path) of the resource to retrieve.
+		 * @param resourceInfo Optional additional information, copied by the request.
+		 * @param placeholder Resource returned until the import ends, if null a default resource
+		 *                    of the same type is used (WHITE_PIXEL, DEFAULT_MATERIAL).
+		 *
+		 * @return A handle to the requested resource.
+		 */
+		template<typename T>
+		ResourceHandle<T> getAsync(const std::string& alias, ResourceInfo* resourceInfo = nullptr,
+			const Shared<T>& placeholder = nullptr) {
+
+			Shared<Resource> fallback = placeholder ? placeholder : getDefaultResource(T::getStaticType());
+			return ResourceHandle<T>(getAsync(alias, resourceInfo, fallback));
+		}
+
+		/**
+		 * @brief Untyped version of getAsync.
+		 */
+		Shared<ResourceRequest> getAsync(const std::string& alias, ResourceInfo* resourceInfo,
+			const Shared<Resource>& placeholder);
+
+		/**
+		 * @brief Waits for the import of a handle and returns the resource, like get() does.
+		 *
+		 * @tparam T The type of the requested resource.
+		 * @param handle The handle returned by getAsync.
+		 *
+		 * @return The loaded resource, or nullptr if the import failed.
+		 */
+		template<typename T>
+		Shared<T> wait(const ResourceHandle<T>& handle) {
+			return std::static_pointer_cast<T>(wait(handle.getRequest()));
+		}
+
+		/**
+		 * @brief Waits for the import of a request and returns the resource.
+		 *
+		 * On the main thread the resource is created right away, on another thread the call
+		 * blocks until the main thread creates it in processCompletedLoads.
+		 *
+		 * @param request The request returned by getAsync.
+		 *
+		 * @return The loaded resource, or nullptr if the import failed.
+		 */
+		Shared<Resource> wait(const Shared<ResourceRequest>& request);
+
+		/**
+		 * @brief Creates the resources whose decoding ended, resolves their requests and runs
+		 * the onReady callbacks queued by the other threads.
+		 *
+		 * Must be called on the main thread, once per frame.
+		 */
+		void processCompletedLoads();
+
+		/**
+		 * @brief Waits for every asynchronous import and resolves it, running jobs in the meantime.
+		 *
+		 * Must be called on the main thread.
+		 */
+		void waitForPendingLoads();
+
+		/**
+		 * @brief Returns true if some asynchronous import has not been resolved yet.
+		 */
+		bool hasPendingLoads() const;
+
+		/**
+		 * @brief Returns true on the thread that created the manager, the only one creating resources.
+		 */
+		bool isMainThread() const { return std::this_thread::get_id() == m_mainThread; }
+
 		/**
 		 * @brief Adds a resource to the manager.
 		 * 
@@ -56,6 +155,16 @@ namespace PXTEngine {
 		 */
 		ResourceId add(const Shared<Resource>& resource, const std::string& alias);
 
+		/**
+		 * @brief Sets a function called with every resource added from now on, e.g. by an import.
+		 *
+		 * The function runs on the main thread: right away for the resources added by the main
+		 * thread, in the next processCompletedLoads for the ones added by the other threads.
+		 *
+		 * @param callback The function to call, nullptr to remove it.
+		 */
+		void setResourceAddedCallback(ResourceRequest::Callback callback);
+
 		/**
 		 * @brief Iterates over all resources and applies the given function to each.
 		 * 
@@ -66,7 +175,51 @@ namespace PXTEngine {
 		static Shared<Material> defaultMaterial;
 	          
 	private:
-	    std::unordered_map<ResourceId, Shared<Resource>> m_resources;
-		std::unordered_map<std::string, ResourceId> m_aliases;
+		static constexpr uint32_t SHARD_COUNT = 16;
+
+		/**
+		 * @struct Shard
+		 *
+		 * @brief Part of the registry with its own lock, aliases and ids are spread by hash.
+		 */
+		struct Shard {
+			mutable std::shared_mutex mutex;
+			std::unordered_map<ResourceId, Shared<Resource>> resources;
+			std::unordered_map<std::string, ResourceId> aliases;
+		};
+
+		Shard& getShard(const ResourceId& id) { return m_shards[std::hash<ResourceId>{}(id) % SHARD_COUNT]; }
+		const Shard& getShard(const ResourceId& id) const { return m_shards[std::hash<ResourceId>{}(id) % SHARD_COUNT]; }
+		Shard& getShard(const std::string& alias) { return m_shards[std::hash<std::string>{}(alias) % SHARD_COUNT]; }
+		const Shard& getShard(const std::string& alias) const { return m_shards[std::hash<std::string>{}(alias) % SHARD_COUNT]; }
+
+		Shared<Resource> find(const std::string& alias) const;
+		Shared<Resource> getDefaultResource(Resource::Type type) const;
+		void resolve(const Shared<ResourceRequest>& request);
+
+		/**
+		 * @brief Queues a callback of a resolved request for the next processCompletedLoads.
+		 */
+		void queueCallback(ResourceRequest::Callback callback, const Shared<Resource>& resource);
+
+		std::array<Shard, SHARD_COUNT> m_shards;
+
+		// imports not resolved yet, by alias
+		mutable std::mutex m_pendingMutex;
+		std::unordered_map<std::string, Shared<ResourceRequest>> m_pendingRequests;
+
+		// requests whose decoding ended, filled by the jobs and drained by processCompletedLoads
+		std::mutex m_completedMutex;
+		std::vector<Shared<ResourceRequest>> m_completedRequests;
+
+		// onReady callbacks registered on other threads after their request was resolved
+		std::mutex m_callbackMutex;
+		std::vector<std::pair<ResourceRequest::Callback, Shared<Resource>>> m_queuedCallbacks;
+		ResourceRequest::Callback m_resourceAddedCallback = nullptr;
+
+		// the finalizers and the callbacks run on this thread
+		std::thread::id m_mainThread = std::this_thread::get_id();
+
+		friend class ResourceRequest;
 	};
 }
\ No newline at end of file
@@ -16,8 +16,64 @@ namespace PXTEngine {
 		RGBA8_SRGB,
 		RGB8_LINEAR,
 		RGBA8_LINEAR,
+
+		// block compressed formats, 4x4 texel blocks
+		BC4_LINEAR,  // single channel (roughness, metallic, ao), 8 bytes per block
+		BC5_LINEAR,  // two channels (tangent space normal xy), 16 bytes per block
+		BC7_LINEAR,  // RGBA, 16 bytes per block
+		BC7_SRGB,    // RGBA with sRGB color, 16 bytes per block
+	};
+
+	/**
+	 * @enum ImageUsage
+	 *
+	 * @brief What the texels of an image represent, the importers choose the stored format from it.
+	 */
+	enum ImageUsage : uint8_t {
+		COLOR_IMAGE = 0, // colors or data (roughness, metallic, ao) read as they are
+		NORMAL_MAP,      // tangent space normals, only x and y are kept when the map is compressed
 	};
 
+	/**
+	 * @brief Returns true if the format stores 4x4 texel blocks.
+	 */
+	inline bool isBlockCompressed(const ImageFormat format) {
+		return format == BC4_LINEAR || format == BC5_LINEAR || format == BC7_LINEAR || format == BC7_SRGB;
+	}
+
+	/**
+	 * @brief Returns true if the color channels of the format are sRGB encoded.
+	 */
+	inline bool isSrgbFormat(const ImageFormat format) {
+		return format == RGB8_SRGB || format == RGBA8_SRGB || format == BC7_SRGB;
+	}
+
+	/**
+	 * @brief Returns the number of levels of a full mip chain, down to 1x1.
+	 */
+	inline uint32_t getMipLevelCount(const uint32_t width, const uint32_t height) {
+		uint32_t levels = 1;
+		for (uint32_t size = std::max(width, height); size > 1; size >>= 1) {
+			levels++;
+		}
+
+		return levels;
+	}
+
+	/**
+	 * @brief Returns the size in bytes of a single mip level of the given format and extent.
+	 *
+	 * Uncompressed formats are assumed to be stored as RGBA (4 bytes per texel), as the importers do.
+	 */
+	inline size_t getImageLevelSize(const ImageFormat format, const uint32_t width, const uint32_t height) {
+		if (!isBlockCompressed(format)) {
+			return static_cast<size_t>(width) * height * 4;
+		}
+
+		const size_t blockCount = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+		return blockCount * (format == BC4_LINEAR ? 8 : 16);
+	}
+
 	/**
 	 * @struct ImageInfo
 	 *
@@ -29,13 +85,16 @@ namespace PXTEngine {
 		uint32_t height = 0;
 		uint16_t channels = 0;
 		ImageFormat format = RGBA8_SRGB;
-
+		uint32_t mipLevels = 1; // number of levels stored in the image data, from the biggest
+		ImageUsage usage = COLOR_IMAGE;
 
 		ImageInfo() = default;
 		ImageInfo(const uint32_t width, const uint32_t height, const uint16_t channels, 
 				  const ImageFormat format = RGBA8_SRGB)
 			: width(width), height(height), channels(channels), format(format) {}
 		ImageInfo(const ImageInfo& other) = default;
+
+		Unique<ResourceInfo> clone() const override { return createUnique<ImageInfo>(*this); }
 	};
 
 	/**
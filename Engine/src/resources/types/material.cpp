@@ -54,26 +54,51 @@ namespace PXTEngine {
         return *this;
     }
 
+    Material::Builder& Material::Builder::setAlbedoMap(const ResourceHandle<Image>& map) {
+        setMap(m_albedoMap, &Material::m_albedoMap, map);
+        return *this;
+    }
+
     Material::Builder& Material::Builder::setMetallicMap(Shared<Image> map) {
         m_metallicMap = map;
         return *this;
     }
 
+    Material::Builder& Material::Builder::setMetallicMap(const ResourceHandle<Image>& map) {
+        setMap(m_metallicMap, &Material::m_metallicMap, map);
+        return *this;
+    }
+
     Material::Builder& Material::Builder::setRoughnessMap(Shared<Image> map) {
         m_roughnessMap = map;
         return *this;
     }
 
+    Material::Builder& Material::Builder::setRoughnessMap(const ResourceHandle<Image>& map) {
+        setMap(m_roughnessMap, &Material::m_roughnessMap, map);
+        return *this;
+    }
+
     Material::Builder& Material::Builder::setNormalMap(Shared<Image> map) {
         m_normalMap = map;
         return *this;
     }
 
+    Material::Builder& Material::Builder::setNormalMap(const ResourceHandle<Image>& map) {
+        setMap(m_normalMap, &Material::m_normalMap, map);
+        return *this;
+    }
+
     Material::Builder& Material::Builder::setAmbientOcclusionMap(Shared<Image> map) {
         m_ambientOcclusionMap = map;
         return *this;
     }
 
+    Material::Builder& Material::Builder::setAmbientOcclusionMap(const ResourceHandle<Image>& map) {
+        setMap(m_ambientOcclusionMap, &Material::m_ambientOcclusionMap, map);
+        return *this;
+    }
+
     Material::Builder& Material::Builder::setEmissiveColor(const glm::vec4& color) {
         m_emissiveColor = color;
         return *this;
@@ -84,6 +109,11 @@ namespace PXTEngine {
         return *this;
     }
 
+    Material::Builder& Material::Builder::setEmissiveMap(const ResourceHandle<Image>& map) {
+        setMap(m_emissiveMap, &Material::m_emissiveMap, map);
+        return *this;
+    }
+
     Shared<Material> Material::Builder::build() {
         if (!m_albedoMap) m_albedoMap = ResourceManager::defaultMaterial->getAlbedoMap();
         if (!m_normalMap) m_normalMap = ResourceManager::defaultMaterial->getNormalMap();
@@ -92,7 +122,7 @@ namespace PXTEngine {
         if (!m_ambientOcclusionMap) m_ambientOcclusionMap = ResourceManager::defaultMaterial->getAmbientOcclusionMap();
         if (!m_emissiveMap) m_emissiveMap = ResourceManager::defaultMaterial->getEmissiveMap();
 
-        return createShared<Material>(
+        auto material = createShared<Material>(
             m_albedoColor,
             m_albedoMap,
             m_normalMap,
@@ -102,5 +132,28 @@ namespace PXTEngine {
             m_emissiveColor,
             m_emissiveMap
         );
+
+        // the callbacks run on the main thread, like the renderers reading the maps
+        const std::weak_ptr<Material> weakMaterial = material;
+        for (const auto& [member, handle] : m_pendingMaps) {
+            handle.onReady([weakMaterial, member](const Shared<Image>& image) {
+                if (const auto material = weakMaterial.lock()) {
+                    (*material).*member = image;
+                }
+            });
+        }
+
+        return material;
+    }
+
+    void Material::Builder::setMap(Shared<Image>& map, const MapMember member, const ResourceHandle<Image>& handle) {
+        // a failed import keeps the default map
+        if (handle.isReady()) {
+            map = handle.getRequest()->hasFailed() ? nullptr : handle.get();
+            return;
+        }
+
+        map = nullptr;
+        m_pendingMaps.emplace_back(member, handle);
     }
 }
\ No newline at end of file
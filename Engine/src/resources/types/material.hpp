@@ -2,6 +2,7 @@
 
 #include "core/pch.hpp"
 #include "resources/resource.hpp"
+#include "resources/resource_handle.hpp"
 #include "resources/types/image.hpp"
 
 namespace PXTEngine {
@@ -15,19 +16,43 @@ namespace PXTEngine {
 	 */
     class Material : public Resource {
     public:
+        /**
+         * @class Builder
+         *
+         * @brief Builds a material, the maps that are not set use the ones of the default material.
+         *
+         * The maps can also be given as handles of asynchronous imports: until an import ends the
+         * material uses the map of the default material, then the loaded one is swapped in.
+         */
         class Builder {
         public:
             Builder& setAlbedoColor(const glm::vec4& color);
             Builder& setAlbedoMap(Shared<Image> map);
+            Builder& setAlbedoMap(const ResourceHandle<Image>& map);
             Builder& setMetallicMap(Shared<Image> map);
+            Builder& setMetallicMap(const ResourceHandle<Image>& map);
             Builder& setRoughnessMap(Shared<Image> map);
+            Builder& setRoughnessMap(const ResourceHandle<Image>& map);
             Builder& setNormalMap(Shared<Image> map);
+            Builder& setNormalMap(const ResourceHandle<Image>& map);
             Builder& setAmbientOcclusionMap(Shared<Image> map);
+            Builder& setAmbientOcclusionMap(const ResourceHandle<Image>& map);
             Builder& setEmissiveColor(const glm::vec4& color);
             Builder& setEmissiveMap(Shared<Image> map);
+            Builder& setEmissiveMap(const ResourceHandle<Image>& map);
             Shared<Material> build();
 
         protected:
+            using MapMember = Shared<Image> Material::*;
+
+            /**
+             * @brief Sets a map from a handle: right away if it is loaded, once built otherwise.
+             */
+            void setMap(Shared<Image>& map, MapMember member, const ResourceHandle<Image>& handle);
+
+            // maps still loading, swapped into the built material when their import ends
+            std::vector<std::pair<MapMember, ResourceHandle<Image>>> m_pendingMaps;
+
             glm::vec4 m_albedoColor{ 1.0f };
             Shared<Image> m_albedoMap{ nullptr };
             Shared<Image> m_normalMap{ nullptr };
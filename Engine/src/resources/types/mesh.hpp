@@ -13,6 +13,7 @@ namespace PXTEngine {
 	 * This struct can be used to store metadata or other relevant information about the mesh.
 	 */
 	struct MeshInfo : public ResourceInfo {
+		Unique<ResourceInfo> clone() const override { return createUnique<MeshInfo>(*this); }
 	};
 
 	/**
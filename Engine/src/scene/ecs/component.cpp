@@ -1,16 +1,8 @@
 #include "scene/ecs/component.hpp"
 
-#include "application.hpp"  
-
 namespace PXTEngine
 {
-	// --- MaterialComponent ---
-	MaterialComponent::MaterialComponent()
-		: tilingFactor(1.0f), tint(1.0f)
-	{
-		auto& rm = Application::get().getResourceManager();
-		material = rm.get<Material>(DEFAULT_MATERIAL);
-	}
+	// MaterialComponent() is in material_component.cpp, it needs the Application
 
 	// --- Transform2dComponent ---
 	glm::mat2 Transform2dComponent::mat2() {
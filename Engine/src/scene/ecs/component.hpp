@@ -154,6 +154,34 @@ namespace PXTEngine
 		operator glm::mat4() { return mat4(); }
 	};
 
+	/**
+	 * @brief The matrices of a TransformComponent, cached until the transform changes.
+	 *
+	 * It is added and removed along with the TransformComponent. The dirty ones are recomputed
+	 * in batches by WorldTransformSystem at the end of Scene::onUpdate, so read it after that.
+	 */
+	struct WorldTransformComponent {
+		glm::mat4 matrix{ 1.0f };
+		glm::mat4 inverse{ 1.0f };
+		glm::mat3 normalMatrix{ 1.0f };
+
+		// the transform the matrices were computed from: transforms are written in place through
+		// Entity::get, without notifying the registry, so a change is detected by comparing them
+		glm::vec3 translation{};
+		glm::vec3 scale{ 1.f, 1.f, 1.f };
+		glm::vec3 rotation{};
+
+		// set when the transform is replaced through the registry, forces the recomputation
+		bool isDirty = true;
+
+		WorldTransformComponent() = default;
+		WorldTransformComponent(const WorldTransformComponent&) = default;
+
+		bool isUpToDate(const TransformComponent& transform) const {
+			return !isDirty && transform.translation == translation && transform.rotation == rotation && transform.scale == scale;
+		}
+	};
+
 	struct MeshComponent {
 		Shared<Mesh> mesh;
 
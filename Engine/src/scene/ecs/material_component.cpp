@@ -0,0 +1,14 @@
+#include "scene/ecs/component.hpp"
+
+#include "application.hpp"
+
+namespace PXTEngine
+{
+	// --- MaterialComponent ---
+	MaterialComponent::MaterialComponent()
+		: tilingFactor(1.0f), tint(1.0f)
+	{
+		auto& rm = Application::get().getResourceManager();
+		material = rm.get<Material>(DEFAULT_MATERIAL);
+	}
+}
@@ -0,0 +1,148 @@
+#include "scene/ecs/world_transform_system.hpp"
+
+#include "core/jobs/job_system.hpp"
+#include "scene/ecs/component.hpp"
+#include "scene/spatial/simd.hpp"
+
+namespace PXTEngine {
+
+	void WorldTransformSystem::TransformBatch::resize(const size_t count) {
+		m_count = count;
+
+		// the last group is read whole, its unused lanes must not produce NaNs
+		const size_t paddedCount = (count + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			translation[axis].resize(paddedCount, 0.0f);
+			rotation[axis].resize(paddedCount, 0.0f);
+			scale[axis].resize(paddedCount, 1.0f);
+		}
+	}
+
+	void WorldTransformSystem::TransformBatch::set(const size_t index, const glm::vec3& t, const glm::vec3& r, const glm::vec3& s) {
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			translation[axis][index] = t[axis];
+			rotation[axis][index] = r[axis];
+			scale[axis][index] = s[axis];
+		}
+	}
+
+	void WorldTransformSystem::update(entt::registry& registry) {
+		PXT_PROFILE_FN();
+
+		m_dirty.clear();
+
+		auto view = registry.view<TransformComponent, WorldTransformComponent>();
+		for (auto entity : view) {
+			auto [transform, worldTransform] = view.get<TransformComponent, WorldTransformComponent>(entity);
+			if (worldTransform.isUpToDate(transform)) continue;
+
+			worldTransform.translation = transform.translation;
+			worldTransform.rotation = transform.rotation;
+			worldTransform.scale = transform.scale;
+			worldTransform.isDirty = false;
+
+			m_dirty.push_back(&worldTransform);
+		}
+
+		const size_t count = m_dirty.size();
+		if (count == 0) return;
+
+		m_batch.resize(count);
+		for (size_t i = 0; i < count; i++) {
+			const WorldTransformComponent& worldTransform = *m_dirty[i];
+			m_batch.set(i, worldTransform.translation, worldTransform.rotation, worldTransform.scale);
+		}
+
+		if (count < PARALLEL_THRESHOLD) {
+			computeWorldTransforms(m_batch, 0, count, m_dirty);
+			return;
+		}
+
+		// the jobs split the batch on whole SIMD groups
+		const size_t groupCount = (count + SIMD_WIDTH - 1) / SIMD_WIDTH;
+		JobSystem::parallelFor(groupCount, GRAIN_SIZE / SIMD_WIDTH, [&](const size_t begin, const size_t end) {
+			computeWorldTransforms(m_batch, begin * SIMD_WIDTH, std::min(end * SIMD_WIDTH, count), m_dirty);
+		});
+	}
+
+	void WorldTransformSystem::computeWorldTransforms(const TransformBatch& batch, const size_t begin, const size_t end,
+		std::span<WorldTransformComponent* const> outputs) {
+		PXT_ASSERT(begin % SIMD_WIDTH == 0, "The world transforms are computed from the start of a SIMD group");
+
+		// the elements of the group matrices, one array of SIMD_WIDTH lanes per element
+		enum Element {
+			M00, M01, M02, M10, M11, M12, M20, M21, M22, // model columns
+			N00, N01, N02, N10, N11, N12, N20, N21, N22, // normal matrix columns
+			TX, TY, TZ, // translation
+			IX, IY, IZ, // inverse translation
+			ELEMENT_COUNT
+		};
+		alignas(32) float elements[ELEMENT_COUNT][SIMD_WIDTH];
+
+		for (size_t first = begin; first < end; first += SIMD_WIDTH) {
+			// same rotation as TransformComponent::mat4(): Ry * Rx * Rz
+			SimdFloat s1, c1, s2, c2, s3, c3;
+			sincos(SimdFloat::load(&batch.rotation[1][first]), s1, c1);
+			sincos(SimdFloat::load(&batch.rotation[0][first]), s2, c2);
+			sincos(SimdFloat::load(&batch.rotation[2][first]), s3, c3);
+
+			const SimdFloat s1s2 = s1 * s2;
+			const SimdFloat c1s2 = c1 * s2;
+
+			const std::array<SimdVec3, 3> rotation = {
+				SimdVec3(c1 * c3 + s1s2 * s3, c2 * s3, c1s2 * s3 - c3 * s1),
+				SimdVec3(s1s2 * c3 - c1 * s3, c2 * c3, c1s2 * c3 + s1 * s3),
+				SimdVec3(c2 * s1, -s2, c1 * c2)
+			};
+
+			const SimdVec3 translation(
+				SimdFloat::load(&batch.translation[0][first]),
+				SimdFloat::load(&batch.translation[1][first]),
+				SimdFloat::load(&batch.translation[2][first])
+			);
+
+			// T * R * S, the normal matrix is R * S^-1 and the inverse S^-1 * R^T * T^-1
+			for (uint32_t column = 0; column < 3; column++) {
+				const SimdFloat scale = SimdFloat::load(&batch.scale[column][first]);
+				const SimdVec3 model = rotation[column] * scale;
+				const SimdVec3 normal = rotation[column] * (SimdFloat(1.0f) / scale);
+
+				model.x.store(elements[M00 + column * 3]);
+				model.y.store(elements[M01 + column * 3]);
+				model.z.store(elements[M02 + column * 3]);
+				normal.x.store(elements[N00 + column * 3]);
+				normal.y.store(elements[N01 + column * 3]);
+				normal.z.store(elements[N02 + column * 3]);
+				(-dot(normal, translation)).store(elements[IX + column]);
+			}
+			translation.x.store(elements[TX]);
+			translation.y.store(elements[TY]);
+			translation.z.store(elements[TZ]);
+
+			const size_t laneCount = std::min<size_t>(SIMD_WIDTH, end - first);
+			for (size_t lane = 0; lane < laneCount; lane++) {
+				WorldTransformComponent& output = *outputs[first + lane];
+				const auto element = [&](const uint32_t e) { return elements[e][lane]; };
+
+				output.matrix = {
+					{ element(M00), element(M01), element(M02), 0.0f },
+					{ element(M10), element(M11), element(M12), 0.0f },
+					{ element(M20), element(M21), element(M22), 0.0f },
+					{ element(TX), element(TY), element(TZ), 1.0f }
+				};
+				output.normalMatrix = {
+					{ element(N00), element(N01), element(N02) },
+					{ element(N10), element(N11), element(N12) },
+					{ element(N20), element(N21), element(N22) }
+				};
+				// the rotation part is the transposed normal matrix
+				output.inverse = {
+					{ element(N00), element(N10), element(N20), 0.0f },
+					{ element(N01), element(N11), element(N21), 0.0f },
+					{ element(N02), element(N12), element(N22), 0.0f },
+					{ element(IX), element(IY), element(IZ), 1.0f }
+				};
+			}
+		}
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+namespace PXTEngine {
+
+	struct WorldTransformComponent;
+
+	/**
+	 * @class WorldTransformSystem
+	 *
+	 * @brief Recomputes the WorldTransformComponent of the transforms changed since the last update.
+	 *
+	 * The changed transforms are gathered into a TransformBatch, then their matrices are computed
+	 * SIMD_WIDTH at a time (sines and cosines included) and scattered back to the components.
+	 * Static entities only cost the comparison of their transform.
+	 */
+	class WorldTransformSystem {
+	public:
+		/**
+		 * @struct TransformBatch
+		 *
+		 * @brief Translations, rotations and scales with one array per coordinate, padded to SIMD_WIDTH.
+		 */
+		struct TransformBatch {
+			std::array<std::vector<float>, 3> translation;
+			std::array<std::vector<float>, 3> rotation;
+			std::array<std::vector<float>, 3> scale;
+
+			/**
+			 * @brief Resizes the arrays, the padding is an identity transform.
+			 */
+			void resize(size_t count);
+
+			void set(size_t index, const glm::vec3& t, const glm::vec3& r, const glm::vec3& s);
+
+			size_t size() const { return m_count; }
+
+		private:
+			size_t m_count = 0;
+		};
+
+		/**
+		 * @brief Updates the world transforms of the changed entities of a registry.
+		 */
+		void update(entt::registry& registry);
+
+		/**
+		 * @brief Computes the matrices of the transforms in [begin, end) of a batch into outputs[begin, end).
+		 *
+		 * @note begin must be a multiple of SIMD_WIDTH.
+		 */
+		static void computeWorldTransforms(const TransformBatch& batch, size_t begin, size_t end,
+			std::span<WorldTransformComponent* const> outputs);
+
+		/**
+		 * @brief Returns the number of world transforms recomputed by the last update.
+		 */
+		uint32_t getUpdatedCount() const { return static_cast<uint32_t>(m_dirty.size()); }
+
+	private:
+		// batches below this count are computed on the calling thread
+		static constexpr size_t PARALLEL_THRESHOLD = 4096;
+		static constexpr size_t GRAIN_SIZE = 1024;
+
+		TransformBatch m_batch;
+		std::vector<WorldTransformComponent*> m_dirty;
+	};
+}
@@ -6,6 +6,25 @@
 
 namespace PXTEngine {
 
+    static void addWorldTransform(entt::registry& registry, const entt::entity entity) {
+        registry.emplace_or_replace<WorldTransformComponent>(entity);
+    }
+
+    static void removeWorldTransform(entt::registry& registry, const entt::entity entity) {
+        registry.remove<WorldTransformComponent>(entity);
+    }
+
+    static void markWorldTransformDirty(entt::registry& registry, const entt::entity entity) {
+        registry.get<WorldTransformComponent>(entity).isDirty = true;
+    }
+
+    Scene::Scene() {
+        // every transform gets its cached matrices, replace() and patch() on it mark them dirty
+        m_registry.on_construct<TransformComponent>().connect<&addWorldTransform>();
+        m_registry.on_update<TransformComponent>().connect<&markWorldTransformDirty>();
+        m_registry.on_destroy<TransformComponent>().connect<&removeWorldTransform>();
+    }
+
     Entity Scene::createEntity(const std::string& name) {
         Entity entity = { m_registry.create(), this };
 
@@ -54,5 +73,11 @@ namespace PXTEngine {
             scriptComponent.script->onUpdate(delta);
             
         });
+
+        updateWorldTransforms();
+    }
+
+    void Scene::updateWorldTransforms() {
+        m_worldTransformSystem.update(m_registry);
     }
 }
\ No newline at end of file
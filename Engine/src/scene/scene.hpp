@@ -4,6 +4,7 @@
 #include "core/uuid.hpp"
 
 #include "scene/environment.hpp"
+#include "scene/ecs/world_transform_system.hpp"
 
 namespace PXTEngine {
 
@@ -18,7 +19,7 @@ namespace PXTEngine {
      */
     class Scene {
     public:
-        Scene() = default;
+        Scene();
         ~Scene() = default;
         
         /**
@@ -50,10 +51,22 @@ namespace PXTEngine {
         
         /**
          * @brief Called every frame to update the scene.
+         *
+         * Runs the scripts, then updates the world transforms.
          * @param delta Time elapsed since the last update.
          */
         void onUpdate(float delta);
 
+        /**
+         * @brief Recomputes the world transforms of the entities whose transform changed.
+         */
+        void updateWorldTransforms();
+
+        /**
+         * @brief Gets the system updating the world transforms, for its statistics.
+         */
+        const WorldTransformSystem& getWorldTransformSystem() const { return m_worldTransformSystem; }
+
         /**
          * @brief Retrieves all entities that have the specified components.
          * @tparam T Component types to filter entities.
@@ -84,6 +97,8 @@ namespace PXTEngine {
 
 		Shared<Environment> m_environment = createShared<Environment>();
 
+        WorldTransformSystem m_worldTransformSystem;
+
         friend class Entity;
     };
 }
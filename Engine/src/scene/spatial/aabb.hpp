@@ -0,0 +1,66 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @struct Aabb
+	 *
+	 * @brief Axis aligned bounding box, empty (inverted) until something is added to it.
+	 */
+	struct Aabb {
+		glm::vec3 min{ std::numeric_limits<float>::max() };
+		glm::vec3 max{ std::numeric_limits<float>::lowest() };
+
+		void grow(const glm::vec3& point) {
+			min = glm::min(min, point);
+			max = glm::max(max, point);
+		}
+
+		void grow(const Aabb& other) {
+			min = glm::min(min, other.min);
+			max = glm::max(max, other.max);
+		}
+
+		bool isEmpty() const {
+			return min.x > max.x || min.y > max.y || min.z > max.z;
+		}
+
+		glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+		glm::vec3 getExtent() const { return max - min; }
+
+		/**
+		 * @brief Returns the surface area of the box, 0 if it is empty.
+		 */
+		float getSurfaceArea() const {
+			if (isEmpty()) {
+				return 0.0f;
+			}
+
+			const glm::vec3 extent = getExtent();
+			return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+		}
+
+		/**
+		 * @brief Returns the box enclosing this one once transformed.
+		 */
+		Aabb transformed(const glm::mat4& transform) const {
+			Aabb result;
+			if (isEmpty()) {
+				return result;
+			}
+
+			for (uint32_t corner = 0; corner < 8; corner++) {
+				const glm::vec3 point{
+					(corner & 1) ? max.x : min.x,
+					(corner & 2) ? max.y : min.y,
+					(corner & 4) ? max.z : min.z
+				};
+				result.grow(glm::vec3(transform * glm::vec4(point, 1.0f)));
+			}
+
+			return result;
+		}
+	};
+}
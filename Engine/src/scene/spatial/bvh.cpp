@@ -0,0 +1,210 @@
+#include "scene/spatial/bvh.hpp"
+
+#include "core/jobs/job_system.hpp"
+#include "scene/spatial/bvh_traversal.hpp"
+
+namespace PXTEngine {
+
+	// triangles processed by a single job when preparing the build
+	static constexpr size_t TRIANGLE_GRAIN_SIZE = 16384;
+
+	void Bvh::build(std::span<const Mesh::Vertex> vertices, std::span<const uint32_t> indices,
+		const BvhBuilder::Settings& settings) {
+		PXT_PROFILE_FN();
+
+		const bool hasIndices = !indices.empty();
+		const size_t triangleCount = hasIndices ? indices.size() / 3 : vertices.size() / 3;
+
+		auto getVertex = [&](const size_t triangle, const uint32_t corner) {
+			const size_t index = hasIndices ? indices[triangle * 3 + corner] : triangle * 3 + corner;
+			return glm::vec3(vertices[index].position);
+		};
+
+		std::vector<Aabb> triangleBounds(triangleCount);
+		JobSystem::parallelFor(triangleCount, TRIANGLE_GRAIN_SIZE, [&](const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				for (uint32_t corner = 0; corner < 3; corner++) {
+					triangleBounds[i].grow(getVertex(i, corner));
+				}
+			}
+		});
+
+		BvhBuilder::build(triangleBounds, m_nodes, m_primitiveIndices, settings);
+
+		m_bounds = m_nodes.empty() ? Aabb{} : Aabb{ m_nodes[0].boundsMin, m_nodes[0].boundsMax };
+
+		// the padding is made of zeros, degenerate triangles never hit
+		for (auto& stream : m_triangles) {
+			stream.assign(triangleCount + SIMD_WIDTH - 1, 0.0f);
+		}
+
+		JobSystem::parallelFor(triangleCount, TRIANGLE_GRAIN_SIZE, [&](const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const size_t triangle = m_primitiveIndices[i];
+				const glm::vec3 v0 = getVertex(triangle, 0);
+				const glm::vec3 edge1 = getVertex(triangle, 1) - v0;
+				const glm::vec3 edge2 = getVertex(triangle, 2) - v0;
+
+				for (uint32_t axis = 0; axis < 3; axis++) {
+					m_triangles[V0_X + axis][i] = v0[axis];
+					m_triangles[EDGE1_X + axis][i] = edge1[axis];
+					m_triangles[EDGE2_X + axis][i] = edge2[axis];
+				}
+			}
+		});
+	}
+
+	bool Bvh::intersect(const Ray& ray, RayHit& hit) const {
+		float tMax = std::min(ray.tMax, hit.t);
+		bool updated = false;
+
+		const SimdVec3 origin(ray.origin);
+		const SimdVec3 direction(ray.direction);
+		const SimdFloat tMin(ray.tMin);
+
+		traverseBvh(m_nodes, ray, tMax, [&](const uint32_t first, const uint32_t count) {
+			for (uint32_t i = first; i < first + count; i += SIMD_WIDTH) {
+				SimdVec3 v0, edge1, edge2;
+				loadTriangles(i, v0, edge1, edge2);
+
+				SimdFloat t, u, v;
+				const uint32_t laneCount = std::min(SIMD_WIDTH, first + count - i);
+				const SimdMask mask = intersectTriangles(origin, direction, v0, edge1, edge2, tMin, SimdFloat(tMax), t, u, v)
+					& SimdMask::fromBits((1u << laneCount) - 1);
+
+				uint32_t bits = mask.getBits();
+				if (bits == 0) {
+					continue;
+				}
+
+				std::array<float, SIMD_WIDTH> ts, us, vs;
+				t.store(ts.data());
+				u.store(us.data());
+				v.store(vs.data());
+
+				while (bits != 0) {
+					const uint32_t lane = static_cast<uint32_t>(std::countr_zero(bits));
+					bits &= bits - 1;
+
+					if (ts[lane] < tMax) {
+						tMax = ts[lane];
+						hit.t = ts[lane];
+						hit.u = us[lane];
+						hit.v = vs[lane];
+						hit.primitiveIndex = m_primitiveIndices[i + lane];
+						updated = true;
+					}
+				}
+			}
+
+			return false;
+		});
+
+		return updated;
+	}
+
+	bool Bvh::isOccluded(const Ray& ray) const {
+		bool occluded = false;
+
+		const SimdVec3 origin(ray.origin);
+		const SimdVec3 direction(ray.direction);
+		const SimdFloat tMin(ray.tMin);
+		const SimdFloat tMax(ray.tMax);
+
+		traverseBvh(m_nodes, ray, ray.tMax, [&](const uint32_t first, const uint32_t count) {
+			for (uint32_t i = first; i < first + count; i += SIMD_WIDTH) {
+				SimdVec3 v0, edge1, edge2;
+				loadTriangles(i, v0, edge1, edge2);
+
+				SimdFloat t, u, v;
+				const uint32_t laneCount = std::min(SIMD_WIDTH, first + count - i);
+				const SimdMask mask = intersectTriangles(origin, direction, v0, edge1, edge2, tMin, tMax, t, u, v)
+					& SimdMask::fromBits((1u << laneCount) - 1);
+
+				if (mask.any()) {
+					occluded = true;
+					return true;
+				}
+			}
+
+			return false;
+		});
+
+		return occluded;
+	}
+
+	uint32_t Bvh::intersect(const RayPacket& packet, RayPacketHit& hit) const {
+		const SimdVec3 origin{
+			SimdFloat::load(packet.originX.data()), SimdFloat::load(packet.originY.data()), SimdFloat::load(packet.originZ.data()) };
+		const SimdVec3 direction{
+			SimdFloat::load(packet.directionX.data()), SimdFloat::load(packet.directionY.data()), SimdFloat::load(packet.directionZ.data()) };
+		const SimdFloat tMin = SimdFloat::load(packet.tMin.data());
+
+		SimdFloat tMax = min(SimdFloat::load(packet.tMax.data()), SimdFloat::load(hit.t.data()));
+		SimdFloat hitU = SimdFloat::load(hit.u.data());
+		SimdFloat hitV = SimdFloat::load(hit.v.data());
+		SimdMask updated = SimdMask::fromBits(0);
+
+		traverseBvh(m_nodes, origin, direction, tMin, tMax, [&](const uint32_t first, const uint32_t count, const SimdMask& active) {
+			for (uint32_t i = first; i < first + count; i++) {
+				SimdVec3 v0, edge1, edge2;
+				broadcastTriangle(i, v0, edge1, edge2);
+
+				SimdFloat t, u, v;
+				const SimdMask mask = intersectTriangles(origin, direction, v0, edge1, edge2, tMin, tMax, t, u, v) & active;
+
+				uint32_t bits = mask.getBits();
+				if (bits == 0) {
+					continue;
+				}
+
+				tMax = select(mask, t, tMax);
+				hitU = select(mask, u, hitU);
+				hitV = select(mask, v, hitV);
+				updated = updated | mask;
+
+				while (bits != 0) {
+					const uint32_t lane = static_cast<uint32_t>(std::countr_zero(bits));
+					bits &= bits - 1;
+					hit.primitiveIndex[lane] = m_primitiveIndices[i];
+				}
+			}
+		});
+
+		const uint32_t updatedBits = updated.getBits();
+		if (updatedBits == 0) {
+			return 0;
+		}
+
+		// only the updated lanes are written back, the others keep their hit (or its absence)
+		std::array<float, SIMD_WIDTH> ts, us, vs;
+		tMax.store(ts.data());
+		hitU.store(us.data());
+		hitV.store(vs.data());
+
+		for (uint32_t lane = 0; lane < SIMD_WIDTH; lane++) {
+			if (updatedBits & (1u << lane)) {
+				hit.t[lane] = ts[lane];
+				hit.u[lane] = us[lane];
+				hit.v[lane] = vs[lane];
+			}
+		}
+
+		return updatedBits;
+	}
+
+	void Bvh::loadTriangles(const uint32_t index, SimdVec3& v0, SimdVec3& edge1, SimdVec3& edge2) const {
+		v0 = { SimdFloat::load(&m_triangles[V0_X][index]), SimdFloat::load(&m_triangles[V0_Y][index]),
+			SimdFloat::load(&m_triangles[V0_Z][index]) };
+		edge1 = { SimdFloat::load(&m_triangles[EDGE1_X][index]), SimdFloat::load(&m_triangles[EDGE1_Y][index]),
+			SimdFloat::load(&m_triangles[EDGE1_Z][index]) };
+		edge2 = { SimdFloat::load(&m_triangles[EDGE2_X][index]), SimdFloat::load(&m_triangles[EDGE2_Y][index]),
+			SimdFloat::load(&m_triangles[EDGE2_Z][index]) };
+	}
+
+	void Bvh::broadcastTriangle(const uint32_t index, SimdVec3& v0, SimdVec3& edge1, SimdVec3& edge2) const {
+		v0 = { m_triangles[V0_X][index], m_triangles[V0_Y][index], m_triangles[V0_Z][index] };
+		edge1 = { m_triangles[EDGE1_X][index], m_triangles[EDGE1_Y][index], m_triangles[EDGE1_Z][index] };
+		edge2 = { m_triangles[EDGE2_X][index], m_triangles[EDGE2_Y][index], m_triangles[EDGE2_Z][index] };
+	}
+}
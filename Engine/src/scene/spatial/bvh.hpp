@@ -0,0 +1,79 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "resources/types/mesh.hpp"
+#include "scene/spatial/bvh_builder.hpp"
+#include "scene/spatial/ray.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @class Bvh
+	 *
+	 * @brief CPU BVH over the triangles of a mesh, answering ray queries without the GPU.
+	 *
+	 * The triangles are stored in BVH order as one stream per component (v0, v1 - v0, v2 - v0),
+	 * so a single ray is tested against SIMD_WIDTH triangles of a leaf at once, while a packet
+	 * tests each triangle against SIMD_WIDTH rays at once.
+	 */
+	class Bvh {
+	public:
+		/**
+		 * @brief Builds the BVH, replacing any previous content.
+		 *
+		 * @param vertices The vertices of the mesh, only their position is used.
+		 * @param indices Three indices per triangle, if empty every three vertices make a triangle.
+		 */
+		void build(std::span<const Mesh::Vertex> vertices, std::span<const uint32_t> indices,
+			const BvhBuilder::Settings& settings = {});
+
+		/**
+		 * @brief Finds the closest hit of a ray, only accepting hits closer than hit.t.
+		 *
+		 * @return true if hit was updated.
+		 */
+		bool intersect(const Ray& ray, RayHit& hit) const;
+
+		/**
+		 * @brief Returns true if the ray hits any triangle in [tMin, tMax).
+		 */
+		bool isOccluded(const Ray& ray) const;
+
+		/**
+		 * @brief Finds the closest hit of every lane of a packet, only accepting hits closer than their hit.t.
+		 *
+		 * @return The bits of the lanes whose hit was updated.
+		 */
+		uint32_t intersect(const RayPacket& packet, RayPacketHit& hit) const;
+
+		const Aabb& getBounds() const { return m_bounds; }
+		uint32_t getTriangleCount() const { return static_cast<uint32_t>(m_primitiveIndices.size()); }
+		std::span<const BvhNode> getNodes() const { return m_nodes; }
+
+	private:
+		enum TriangleStream : uint32_t {
+			V0_X, V0_Y, V0_Z,
+			EDGE1_X, EDGE1_Y, EDGE1_Z,
+			EDGE2_X, EDGE2_Y, EDGE2_Z,
+			STREAM_COUNT
+		};
+
+		/**
+		 * @brief Loads SIMD_WIDTH consecutive triangles starting at index, in BVH order.
+		 */
+		void loadTriangles(uint32_t index, SimdVec3& v0, SimdVec3& edge1, SimdVec3& edge2) const;
+
+		/**
+		 * @brief Loads a triangle in every lane.
+		 */
+		void broadcastTriangle(uint32_t index, SimdVec3& v0, SimdVec3& edge1, SimdVec3& edge2) const;
+
+		std::vector<BvhNode> m_nodes;
+		std::vector<uint32_t> m_primitiveIndices; // BVH order -> triangle index in the mesh
+
+		// padded with SIMD_WIDTH - 1 degenerate triangles, so that any leaf can be loaded as whole registers
+		std::array<std::vector<float>, STREAM_COUNT> m_triangles;
+
+		Aabb m_bounds;
+	};
+}
@@ -0,0 +1,239 @@
+#include "scene/spatial/bvh_builder.hpp"
+
+#include "core/jobs/job_system.hpp"
+
+namespace PXTEngine {
+
+	// primitives processed by a single job when binning in parallel
+	static constexpr size_t BINNING_GRAIN_SIZE = 4096;
+
+	void BvhBuilder::build(std::span<const Aabb> primitiveBounds, std::vector<BvhNode>& nodes,
+		std::vector<uint32_t>& primitiveIndices, const Settings& settings) {
+		PXT_PROFILE_FN();
+
+		nodes.clear();
+		primitiveIndices.clear();
+
+		if (primitiveBounds.empty()) {
+			return;
+		}
+
+		PXT_ASSERT(settings.binCount >= 2, "The BVH builder needs at least two bins");
+
+		const uint32_t primitiveCount = static_cast<uint32_t>(primitiveBounds.size());
+
+		primitiveIndices.resize(primitiveCount);
+		std::iota(primitiveIndices.begin(), primitiveIndices.end(), 0);
+
+		// a binary tree with a primitive per leaf has at most 2n - 1 nodes
+		nodes.resize(2 * static_cast<size_t>(primitiveCount) - 1);
+
+		BvhBuilder builder(primitiveBounds, nodes, primitiveIndices, settings);
+		builder.buildNode(0, 0, primitiveCount);
+
+		nodes.resize(builder.m_nodeCount.load());
+	}
+
+	BvhBuilder::BvhBuilder(std::span<const Aabb> primitiveBounds, std::vector<BvhNode>& nodes,
+		std::vector<uint32_t>& primitiveIndices, const Settings& settings)
+		: m_primitiveBounds(primitiveBounds),
+		m_nodes(nodes),
+		m_primitiveIndices(primitiveIndices),
+		m_settings(settings) {
+
+		m_centroids.resize(primitiveBounds.size());
+
+		JobSystem::parallelFor(primitiveBounds.size(), BINNING_GRAIN_SIZE, [&](const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				m_centroids[i] = primitiveBounds[i].getCenter();
+			}
+		});
+	}
+
+	void BvhBuilder::buildNode(const uint32_t nodeIndex, const uint32_t first, const uint32_t count) {
+		BvhNode& node = m_nodes[nodeIndex];
+
+		Aabb bounds;
+		Aabb centroidBounds;
+		computeBounds(first, count, bounds, centroidBounds);
+
+		node.boundsMin = bounds.min;
+		node.boundsMax = bounds.max;
+		node.leftOrFirst = first;
+		node.count = count;
+
+		if (count == 1) {
+			return;
+		}
+
+		std::vector<Bin> bins(3 * static_cast<size_t>(m_settings.binCount));
+		fillBins(first, count, centroidBounds, bins);
+
+		Split split = findBestSplit(bins, centroidBounds);
+
+		const float parentArea = bounds.getSurfaceArea();
+		const float splitCost = parentArea > 0.0f
+			? m_settings.traversalCost + m_settings.intersectionCost * split.cost / parentArea
+			: std::numeric_limits<float>::max();
+		const float leafCost = m_settings.intersectionCost * static_cast<float>(count);
+
+		if (count <= m_settings.maxLeafSize && splitCost >= leafCost) {
+			return;
+		}
+
+		auto begin = m_primitiveIndices.begin() + first;
+		auto end = begin + count;
+
+		uint32_t leftCount = 0;
+		if (split.cost < std::numeric_limits<float>::max()) {
+			auto middle = std::partition(begin, end, [&](const uint32_t primitive) {
+				return getBinIndex(m_centroids[primitive], split.axis, centroidBounds) <= split.bin;
+			});
+			leftCount = static_cast<uint32_t>(middle - begin);
+		}
+
+		// the centroids can't be told apart (e.g. they all coincide), any split is as good as the others
+		if (leftCount == 0 || leftCount == count) {
+			leftCount = count / 2;
+		}
+
+		const uint32_t childIndex = m_nodeCount.fetch_add(2);
+		node.leftOrFirst = childIndex;
+		node.count = 0;
+
+		if (count >= m_settings.parallelThreshold) {
+			JobCounter counter;
+			JobSystem::run([this, childIndex, first, leftCount]() {
+				buildNode(childIndex, first, leftCount);
+			}, &counter);
+
+			buildNode(childIndex + 1, first + leftCount, count - leftCount);
+
+			JobSystem::wait(counter);
+		} else {
+			buildNode(childIndex, first, leftCount);
+			buildNode(childIndex + 1, first + leftCount, count - leftCount);
+		}
+	}
+
+	void BvhBuilder::computeBounds(const uint32_t first, const uint32_t count, Aabb& bounds, Aabb& centroidBounds) const {
+		auto accumulate = [&](const size_t begin, const size_t end, Aabb& chunkBounds, Aabb& chunkCentroidBounds) {
+			for (size_t i = begin; i < end; i++) {
+				const uint32_t primitive = m_primitiveIndices[first + i];
+				chunkBounds.grow(m_primitiveBounds[primitive]);
+				chunkCentroidBounds.grow(m_centroids[primitive]);
+			}
+		};
+
+		if (count < m_settings.parallelThreshold) {
+			accumulate(0, count, bounds, centroidBounds);
+			return;
+		}
+
+		const size_t chunkCount = (count + BINNING_GRAIN_SIZE - 1) / BINNING_GRAIN_SIZE;
+		std::vector<std::pair<Aabb, Aabb>> chunks(chunkCount);
+
+		JobSystem::parallelFor(count, BINNING_GRAIN_SIZE, [&](const size_t begin, const size_t end) {
+			auto& [chunkBounds, chunkCentroidBounds] = chunks[begin / BINNING_GRAIN_SIZE];
+			accumulate(begin, end, chunkBounds, chunkCentroidBounds);
+		});
+
+		for (const auto& [chunkBounds, chunkCentroidBounds] : chunks) {
+			bounds.grow(chunkBounds);
+			centroidBounds.grow(chunkCentroidBounds);
+		}
+	}
+
+	void BvhBuilder::fillBins(const uint32_t first, const uint32_t count, const Aabb& centroidBounds,
+		std::vector<Bin>& bins) const {
+		const uint32_t binCount = m_settings.binCount;
+
+		auto accumulate = [&](const size_t begin, const size_t end, std::vector<Bin>& chunkBins) {
+			for (size_t i = begin; i < end; i++) {
+				const uint32_t primitive = m_primitiveIndices[first + i];
+				for (uint32_t axis = 0; axis < 3; axis++) {
+					Bin& bin = chunkBins[axis * binCount + getBinIndex(m_centroids[primitive], axis, centroidBounds)];
+					bin.bounds.grow(m_primitiveBounds[primitive]);
+					bin.count++;
+				}
+			}
+		};
+
+		if (count < m_settings.parallelThreshold) {
+			accumulate(0, count, bins);
+			return;
+		}
+
+		const size_t chunkCount = (count + BINNING_GRAIN_SIZE - 1) / BINNING_GRAIN_SIZE;
+		std::vector<std::vector<Bin>> chunks(chunkCount, std::vector<Bin>(bins.size()));
+
+		JobSystem::parallelFor(count, BINNING_GRAIN_SIZE, [&](const size_t begin, const size_t end) {
+			accumulate(begin, end, chunks[begin / BINNING_GRAIN_SIZE]);
+		});
+
+		for (const auto& chunkBins : chunks) {
+			for (size_t i = 0; i < bins.size(); i++) {
+				bins[i].bounds.grow(chunkBins[i].bounds);
+				bins[i].count += chunkBins[i].count;
+			}
+		}
+	}
+
+	BvhBuilder::Split BvhBuilder::findBestSplit(const std::vector<Bin>& bins, const Aabb& centroidBounds) const {
+		const uint32_t binCount = m_settings.binCount;
+		const glm::vec3 extent = centroidBounds.getExtent();
+
+		// area * count and count of the right side of every plane, swept from the last bin
+		std::vector<float> rightCosts(binCount);
+		std::vector<uint32_t> rightCounts(binCount);
+
+		Split best;
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			if (extent[axis] <= 0.0f) {
+				continue;
+			}
+
+			const Bin* axisBins = &bins[axis * binCount];
+
+			Aabb rightBounds;
+			uint32_t rightCount = 0;
+			for (uint32_t i = binCount - 1; i > 0; i--) {
+				rightBounds.grow(axisBins[i].bounds);
+				rightCount += axisBins[i].count;
+				rightCosts[i] = rightBounds.getSurfaceArea() * static_cast<float>(rightCount);
+				rightCounts[i] = rightCount;
+			}
+
+			// the plane after bin i splits [0, i] from [i + 1, binCount)
+			Aabb leftBounds;
+			uint32_t leftCount = 0;
+			for (uint32_t i = 0; i < binCount - 1; i++) {
+				leftBounds.grow(axisBins[i].bounds);
+				leftCount += axisBins[i].count;
+
+				if (leftCount == 0 || rightCounts[i + 1] == 0) {
+					continue;
+				}
+
+				const float cost = leftBounds.getSurfaceArea() * static_cast<float>(leftCount) + rightCosts[i + 1];
+				if (cost < best.cost) {
+					best = { axis, i, cost };
+				}
+			}
+		}
+
+		return best;
+	}
+
+	uint32_t BvhBuilder::getBinIndex(const glm::vec3& centroid, const uint32_t axis, const Aabb& centroidBounds) const {
+		const float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+		if (extent <= 0.0f) {
+			return 0;
+		}
+
+		const float scale = static_cast<float>(m_settings.binCount) / extent;
+		const int32_t bin = static_cast<int32_t>((centroid[axis] - centroidBounds.min[axis]) * scale);
+
+		return static_cast<uint32_t>(std::clamp(bin, 0, static_cast<int32_t>(m_settings.binCount) - 1));
+	}
+}
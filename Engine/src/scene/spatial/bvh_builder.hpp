@@ -0,0 +1,91 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "scene/spatial/aabb.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @struct BvhNode
+	 *
+	 * @brief A node of a binary BVH, 32 bytes.
+	 *
+	 * Interior nodes have their two children next to each other at leftOrFirst and leftOrFirst + 1,
+	 * leaves reference count primitives starting at leftOrFirst in the BVH primitive order.
+	 */
+	struct BvhNode {
+		glm::vec3 boundsMin;
+		uint32_t leftOrFirst;
+		glm::vec3 boundsMax;
+		uint32_t count;
+
+		bool isLeaf() const { return count > 0; }
+	};
+
+	/**
+	 * @struct BvhBuildSettings
+	 *
+	 * @brief Tuning of a BvhBuilder build.
+	 */
+	struct BvhBuildSettings {
+		uint32_t binCount = 16;
+		// leaves are only made larger than this when their primitives can't be split
+		uint32_t maxLeafSize = 8;
+		// costs of a traversal step and of a primitive test, relative to each other
+		float traversalCost = 1.0f;
+		float intersectionCost = 1.0f;
+		// nodes with more primitives than this are binned and split in parallel
+		uint32_t parallelThreshold = 8192;
+	};
+
+	/**
+	 * @class BvhBuilder
+	 *
+	 * @brief Builds a BVH over primitive bounds with the binned surface area heuristic.
+	 *
+	 * Nodes are split on the best of binCount planes per axis, placed by the primitive centroids.
+	 * Large nodes are binned in parallel and their subtrees are built as separate jobs, so the
+	 * build scales with the JobSystem workers (and runs serially when it isn't started).
+	 */
+	class BvhBuilder {
+	public:
+		using Settings = BvhBuildSettings;
+
+		/**
+		 * @param primitiveBounds The bounds of every primitive.
+		 * @param nodes Filled with the nodes, the root is the first one.
+		 * @param primitiveIndices Filled with the primitive indices in the order referenced by the leaves.
+		 */
+		static void build(std::span<const Aabb> primitiveBounds, std::vector<BvhNode>& nodes,
+			std::vector<uint32_t>& primitiveIndices, const Settings& settings = {});
+
+	private:
+		struct Bin {
+			Aabb bounds;
+			uint32_t count = 0;
+		};
+
+		struct Split {
+			uint32_t axis = 0;
+			uint32_t bin = 0;
+			float cost = std::numeric_limits<float>::max();
+		};
+
+		BvhBuilder(std::span<const Aabb> primitiveBounds, std::vector<BvhNode>& nodes,
+			std::vector<uint32_t>& primitiveIndices, const Settings& settings);
+
+		void buildNode(uint32_t nodeIndex, uint32_t first, uint32_t count);
+		void computeBounds(uint32_t first, uint32_t count, Aabb& bounds, Aabb& centroidBounds) const;
+		void fillBins(uint32_t first, uint32_t count, const Aabb& centroidBounds, std::vector<Bin>& bins) const;
+		Split findBestSplit(const std::vector<Bin>& bins, const Aabb& centroidBounds) const;
+		uint32_t getBinIndex(const glm::vec3& centroid, uint32_t axis, const Aabb& centroidBounds) const;
+
+		std::span<const Aabb> m_primitiveBounds;
+		std::vector<glm::vec3> m_centroids;
+		std::vector<BvhNode>& m_nodes;
+		std::vector<uint32_t>& m_primitiveIndices;
+		Settings m_settings;
+
+		std::atomic<uint32_t> m_nodeCount = 1;
+	};
+}
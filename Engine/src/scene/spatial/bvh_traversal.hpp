@@ -0,0 +1,211 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "scene/spatial/bvh_builder.hpp"
+#include "scene/spatial/ray.hpp"
+#include "scene/spatial/simd.hpp"
+
+namespace PXTEngine {
+
+	// deep enough for any BVH built by BvhBuilder on meshes of a sane size
+	inline constexpr uint32_t BVH_STACK_SIZE = 128;
+
+	/**
+	 * @brief Slab test of a single ray against a box.
+	 *
+	 * @return The distance the ray enters the box at, infinity if it misses it in [tMin, tMax).
+	 */
+	inline float intersectAabb(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::vec3& origin,
+		const glm::vec3& inverseDirection, const float tMin, const float tMax) {
+		const glm::vec3 t0 = (boundsMin - origin) * inverseDirection;
+		const glm::vec3 t1 = (boundsMax - origin) * inverseDirection;
+		const glm::vec3 tNear = glm::min(t0, t1);
+		const glm::vec3 tFar = glm::max(t0, t1);
+
+		const float enter = std::max({ tNear.x, tNear.y, tNear.z, tMin });
+		const float exit = std::min({ tFar.x, tFar.y, tFar.z, tMax });
+
+		return enter <= exit ? enter : std::numeric_limits<float>::infinity();
+	}
+
+	/**
+	 * @brief Slab test of every lane of a packet against a box.
+	 *
+	 * @param tEnter Set to the distance each lane enters the box at.
+	 * @return The lanes hitting the box in [tMin, tMax).
+	 */
+	inline SimdMask intersectAabb(const BvhNode& node, const SimdVec3& origin, const SimdVec3& inverseDirection,
+		const SimdFloat& tMin, const SimdFloat& tMax, SimdFloat& tEnter) {
+		const SimdFloat tx0 = (SimdFloat(node.boundsMin.x) - origin.x) * inverseDirection.x;
+		const SimdFloat tx1 = (SimdFloat(node.boundsMax.x) - origin.x) * inverseDirection.x;
+		const SimdFloat ty0 = (SimdFloat(node.boundsMin.y) - origin.y) * inverseDirection.y;
+		const SimdFloat ty1 = (SimdFloat(node.boundsMax.y) - origin.y) * inverseDirection.y;
+		const SimdFloat tz0 = (SimdFloat(node.boundsMin.z) - origin.z) * inverseDirection.z;
+		const SimdFloat tz1 = (SimdFloat(node.boundsMax.z) - origin.z) * inverseDirection.z;
+
+		tEnter = max(max(min(tx0, tx1), min(ty0, ty1)), max(min(tz0, tz1), tMin));
+		const SimdFloat tExit = min(min(max(tx0, tx1), max(ty0, ty1)), min(max(tz0, tz1), tMax));
+
+		return tEnter <= tExit;
+	}
+
+	/**
+	 * @brief Möller-Trumbore ray-triangle test on every lane.
+	 *
+	 * The lanes either pair SIMD_WIDTH triangles with the same ray (broadcast) or the same
+	 * triangle (broadcast) with SIMD_WIDTH rays.
+	 *
+	 * @return The lanes whose ray hits the triangle with t in [tMin, tMax), their t, u and v are set.
+	 */
+	inline SimdMask intersectTriangles(const SimdVec3& origin, const SimdVec3& direction,
+		const SimdVec3& v0, const SimdVec3& edge1, const SimdVec3& edge2,
+		const SimdFloat& tMin, const SimdFloat& tMax, SimdFloat& t, SimdFloat& u, SimdFloat& v) {
+		const SimdVec3 p = cross(direction, edge2);
+		const SimdFloat determinant = dot(edge1, p);
+		const SimdFloat inverseDeterminant = SimdFloat(1.0f) / determinant;
+
+		const SimdVec3 s = origin - v0;
+		u = dot(s, p) * inverseDeterminant;
+
+		const SimdVec3 q = cross(s, edge1);
+		v = dot(direction, q) * inverseDeterminant;
+		t = dot(edge2, q) * inverseDeterminant;
+
+		// NaNs of degenerate triangles fail every comparison
+		return (abs(determinant) > SimdFloat(1e-12f)) & (u >= SimdFloat(0.0f)) & (v >= SimdFloat(0.0f)) &
+			(u + v <= SimdFloat(1.0f)) & (t >= tMin) & (t < tMax);
+	}
+
+	/**
+	 * @brief Visits the leaves of a BVH hit by a ray, nearest child first.
+	 *
+	 * @param tMax The current closest hit distance, read again after every leaf so that the leaves can shrink it.
+	 * @param leaf Called with the first and count of every leaf hit, returns true to end the traversal.
+	 */
+	template <typename LeafFunction>
+	void traverseBvh(std::span<const BvhNode> nodes, const Ray& ray, const float& tMax, LeafFunction&& leaf) {
+		if (nodes.empty()) {
+			return;
+		}
+
+		const glm::vec3 inverseDirection = 1.0f / ray.direction;
+
+		struct StackEntry {
+			const BvhNode* node;
+			float distance;
+		};
+		std::array<StackEntry, BVH_STACK_SIZE> stack;
+		uint32_t stackSize = 0;
+
+		const BvhNode* node = &nodes[0];
+		if (intersectAabb(node->boundsMin, node->boundsMax, ray.origin, inverseDirection, ray.tMin, tMax) ==
+			std::numeric_limits<float>::infinity()) {
+			return;
+		}
+
+		while (true) {
+			if (node->isLeaf()) {
+				if (leaf(node->leftOrFirst, node->count)) {
+					return;
+				}
+			} else {
+				const BvhNode* nearChild = &nodes[node->leftOrFirst];
+				const BvhNode* farChild = nearChild + 1;
+
+				float nearDistance = intersectAabb(nearChild->boundsMin, nearChild->boundsMax, ray.origin, inverseDirection, ray.tMin, tMax);
+				float farDistance = intersectAabb(farChild->boundsMin, farChild->boundsMax, ray.origin, inverseDirection, ray.tMin, tMax);
+
+				if (farDistance < nearDistance) {
+					std::swap(nearChild, farChild);
+					std::swap(nearDistance, farDistance);
+				}
+
+				if (nearDistance != std::numeric_limits<float>::infinity()) {
+					if (farDistance != std::numeric_limits<float>::infinity()) {
+						PXT_ASSERT(stackSize < BVH_STACK_SIZE, "BVH traversal stack overflow");
+						stack[stackSize++] = { farChild, farDistance };
+					}
+
+					node = nearChild;
+					continue;
+				}
+			}
+
+			// skip the nodes entered past a hit found after they were pushed
+			do {
+				if (stackSize == 0) {
+					return;
+				}
+				node = stack[--stackSize].node;
+			} while (stack[stackSize].distance >= tMax);
+		}
+	}
+
+	/**
+	 * @brief Visits the leaves of a BVH hit by any lane of a packet.
+	 *
+	 * @param tMax The current closest hit distance of every lane, read again after every leaf.
+	 * @param leaf Called with the first and count of every leaf and the lanes hitting it.
+	 */
+	template <typename LeafFunction>
+	void traverseBvh(std::span<const BvhNode> nodes, const SimdVec3& origin, const SimdVec3& direction,
+		const SimdFloat& tMin, const SimdFloat& tMax, LeafFunction&& leaf) {
+		if (nodes.empty()) {
+			return;
+		}
+
+		const SimdVec3 inverseDirection{
+			SimdFloat(1.0f) / direction.x, SimdFloat(1.0f) / direction.y, SimdFloat(1.0f) / direction.z };
+
+		std::array<const BvhNode*, BVH_STACK_SIZE> stack;
+		uint32_t stackSize = 0;
+
+		// the smallest entry distance of the lanes hitting a box, to visit the nearest child first
+		auto getNearest = [](const SimdMask& mask, const SimdFloat& tEnter) {
+			std::array<float, SIMD_WIDTH> distances;
+			select(mask, tEnter, SimdFloat(std::numeric_limits<float>::infinity())).store(distances.data());
+			return *std::min_element(distances.begin(), distances.end());
+		};
+
+		stack[stackSize++] = &nodes[0];
+
+		while (stackSize > 0) {
+			const BvhNode* node = stack[--stackSize];
+
+			SimdFloat tEnter;
+			const SimdMask mask = intersectAabb(*node, origin, inverseDirection, tMin, tMax, tEnter);
+			if (mask.none()) {
+				continue;
+			}
+
+			if (node->isLeaf()) {
+				leaf(node->leftOrFirst, node->count, mask);
+				continue;
+			}
+
+			const BvhNode* nearChild = &nodes[node->leftOrFirst];
+			const BvhNode* farChild = nearChild + 1;
+
+			SimdFloat nearEnter, farEnter;
+			const SimdMask nearMask = intersectAabb(*nearChild, origin, inverseDirection, tMin, tMax, nearEnter);
+			const SimdMask farMask = intersectAabb(*farChild, origin, inverseDirection, tMin, tMax, farEnter);
+
+			const bool nearHit = nearMask.any();
+			const bool farHit = farMask.any();
+
+			if (nearHit && farHit && getNearest(farMask, farEnter) < getNearest(nearMask, nearEnter)) {
+				std::swap(nearChild, farChild);
+			}
+
+			PXT_ASSERT(stackSize + 2 <= BVH_STACK_SIZE, "BVH traversal stack overflow");
+
+			// the children are tested again when popped, against the hits found in the meantime
+			if (farHit) {
+				stack[stackSize++] = farChild;
+			}
+			if (nearHit) {
+				stack[stackSize++] = nearChild;
+			}
+		}
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "scene/spatial/simd.hpp"
+
+namespace PXTEngine {
+
+	inline constexpr uint32_t INVALID_PRIMITIVE = std::numeric_limits<uint32_t>::max();
+
+	/**
+	 * @struct Ray
+	 *
+	 * @brief A ray accepting hits with t in [tMin, tMax), the direction doesn't need to be normalized.
+	 */
+	struct Ray {
+		glm::vec3 origin{ 0.0f };
+		float tMin = 0.0f;
+		glm::vec3 direction{ 0.0f, 0.0f, 1.0f };
+		float tMax = std::numeric_limits<float>::infinity();
+	};
+
+	/**
+	 * @struct RayHit
+	 *
+	 * @brief The closest hit found so far, queries only accept hits closer than t.
+	 */
+	struct RayHit {
+		float t = std::numeric_limits<float>::infinity();
+		float u = 0.0f; // barycentric coordinates of the hit on the triangle
+		float v = 0.0f;
+		uint32_t primitiveIndex = INVALID_PRIMITIVE; // index of the triangle in the mesh
+		uint32_t instanceIndex = INVALID_PRIMITIVE;  // index of the instance, only for two-level queries
+
+		bool isHit() const { return primitiveIndex != INVALID_PRIMITIVE; }
+	};
+
+	/**
+	 * @struct RayPacket
+	 *
+	 * @brief SIMD_WIDTH rays traced together, one lane each.
+	 *
+	 * Lanes can be disabled by giving them a tMax lower than their tMin.
+	 * Coherent rays (e.g. from neighbouring pixels) make the most of packets.
+	 */
+	struct RayPacket {
+		std::array<float, SIMD_WIDTH> originX, originY, originZ;
+		std::array<float, SIMD_WIDTH> directionX, directionY, directionZ;
+		std::array<float, SIMD_WIDTH> tMin, tMax;
+
+		void setRay(const uint32_t lane, const Ray& ray) {
+			originX[lane] = ray.origin.x;
+			originY[lane] = ray.origin.y;
+			originZ[lane] = ray.origin.z;
+			directionX[lane] = ray.direction.x;
+			directionY[lane] = ray.direction.y;
+			directionZ[lane] = ray.direction.z;
+			tMin[lane] = ray.tMin;
+			tMax[lane] = ray.tMax;
+		}
+
+		Ray getRay(const uint32_t lane) const {
+			return { { originX[lane], originY[lane], originZ[lane] }, tMin[lane],
+				{ directionX[lane], directionY[lane], directionZ[lane] }, tMax[lane] };
+		}
+
+		void disable(const uint32_t lane) {
+			tMin[lane] = 1.0f;
+			tMax[lane] = 0.0f;
+		}
+	};
+
+	/**
+	 * @struct RayPacketHit
+	 *
+	 * @brief The closest hit of every lane of a RayPacket, like RayHit.
+	 */
+	struct RayPacketHit {
+		std::array<float, SIMD_WIDTH> t, u, v;
+		std::array<uint32_t, SIMD_WIDTH> primitiveIndex, instanceIndex;
+
+		RayPacketHit() {
+			t.fill(std::numeric_limits<float>::infinity());
+			u.fill(0.0f);
+			v.fill(0.0f);
+			primitiveIndex.fill(INVALID_PRIMITIVE);
+			instanceIndex.fill(INVALID_PRIMITIVE);
+		}
+
+		RayHit getHit(const uint32_t lane) const {
+			return { t[lane], u[lane], v[lane], primitiveIndex[lane], instanceIndex[lane] };
+		}
+	};
+}
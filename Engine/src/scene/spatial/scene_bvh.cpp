@@ -0,0 +1,142 @@
+#include "scene/spatial/scene_bvh.hpp"
+
+#include "scene/spatial/bvh_traversal.hpp"
+
+namespace PXTEngine {
+
+	void SceneBvh::build(std::span<const BvhInstance> instances, const BvhBuilder::Settings& settings) {
+		PXT_PROFILE_FN();
+
+		// instances of empty meshes would have empty bounds, they can never be hit anyway
+		std::vector<uint32_t> validInstances;
+		std::vector<Aabb> instanceBounds;
+		validInstances.reserve(instances.size());
+		instanceBounds.reserve(instances.size());
+
+		for (uint32_t i = 0; i < instances.size(); i++) {
+			const BvhInstance& instance = instances[i];
+			if (instance.bvh == nullptr || instance.bvh->getBounds().isEmpty()) {
+				continue;
+			}
+
+			validInstances.push_back(i);
+			instanceBounds.push_back(instance.bvh->getBounds().transformed(instance.objectToWorld));
+		}
+
+		BvhBuilder::build(instanceBounds, m_nodes, m_instanceIndices, settings);
+
+		m_bounds = m_nodes.empty() ? Aabb{} : Aabb{ m_nodes[0].boundsMin, m_nodes[0].boundsMax };
+
+		m_instances.resize(m_instanceIndices.size());
+		for (size_t i = 0; i < m_instanceIndices.size(); i++) {
+			m_instanceIndices[i] = validInstances[m_instanceIndices[i]];
+
+			const BvhInstance& instance = instances[m_instanceIndices[i]];
+			m_instances[i] = { instance.bvh, glm::inverse(instance.objectToWorld) };
+		}
+	}
+
+	bool SceneBvh::intersect(const Ray& ray, RayHit& hit) const {
+		float tMax = std::min(ray.tMax, hit.t);
+		bool updated = false;
+
+		traverseBvh(m_nodes, ray, tMax, [&](const uint32_t first, const uint32_t count) {
+			for (uint32_t i = first; i < first + count; i++) {
+				if (m_instances[i].bvh->intersect(toObjectSpace(m_instances[i], ray), hit)) {
+					hit.instanceIndex = m_instanceIndices[i];
+					tMax = hit.t;
+					updated = true;
+				}
+			}
+
+			return false;
+		});
+
+		return updated;
+	}
+
+	bool SceneBvh::isOccluded(const Ray& ray) const {
+		bool occluded = false;
+
+		traverseBvh(m_nodes, ray, ray.tMax, [&](const uint32_t first, const uint32_t count) {
+			for (uint32_t i = first; i < first + count; i++) {
+				if (m_instances[i].bvh->isOccluded(toObjectSpace(m_instances[i], ray))) {
+					occluded = true;
+					return true;
+				}
+			}
+
+			return false;
+		});
+
+		return occluded;
+	}
+
+	uint32_t SceneBvh::intersect(const RayPacket& packet, RayPacketHit& hit) const {
+		const SimdVec3 origin{
+			SimdFloat::load(packet.originX.data()), SimdFloat::load(packet.originY.data()), SimdFloat::load(packet.originZ.data()) };
+		const SimdVec3 direction{
+			SimdFloat::load(packet.directionX.data()), SimdFloat::load(packet.directionY.data()), SimdFloat::load(packet.directionZ.data()) };
+		const SimdFloat tMin = SimdFloat::load(packet.tMin.data());
+
+		SimdFloat tMax = min(SimdFloat::load(packet.tMax.data()), SimdFloat::load(hit.t.data()));
+		uint32_t updated = 0;
+
+		traverseBvh(m_nodes, origin, direction, tMin, tMax, [&](const uint32_t first, const uint32_t count, const SimdMask& active) {
+			for (uint32_t i = first; i < first + count; i++) {
+				const glm::mat4& worldToObject = m_instances[i].worldToObject;
+
+				// the lanes missing the instance box are disabled, they can't hit the instance
+				RayPacket localPacket;
+				const SimdVec3 localOrigin{
+					SimdFloat(worldToObject[0][0]) * origin.x + SimdFloat(worldToObject[1][0]) * origin.y +
+						SimdFloat(worldToObject[2][0]) * origin.z + SimdFloat(worldToObject[3][0]),
+					SimdFloat(worldToObject[0][1]) * origin.x + SimdFloat(worldToObject[1][1]) * origin.y +
+						SimdFloat(worldToObject[2][1]) * origin.z + SimdFloat(worldToObject[3][1]),
+					SimdFloat(worldToObject[0][2]) * origin.x + SimdFloat(worldToObject[1][2]) * origin.y +
+						SimdFloat(worldToObject[2][2]) * origin.z + SimdFloat(worldToObject[3][2])
+				};
+				const SimdVec3 localDirection{
+					SimdFloat(worldToObject[0][0]) * direction.x + SimdFloat(worldToObject[1][0]) * direction.y +
+						SimdFloat(worldToObject[2][0]) * direction.z,
+					SimdFloat(worldToObject[0][1]) * direction.x + SimdFloat(worldToObject[1][1]) * direction.y +
+						SimdFloat(worldToObject[2][1]) * direction.z,
+					SimdFloat(worldToObject[0][2]) * direction.x + SimdFloat(worldToObject[1][2]) * direction.y +
+						SimdFloat(worldToObject[2][2]) * direction.z
+				};
+
+				localOrigin.x.store(localPacket.originX.data());
+				localOrigin.y.store(localPacket.originY.data());
+				localOrigin.z.store(localPacket.originZ.data());
+				localDirection.x.store(localPacket.directionX.data());
+				localDirection.y.store(localPacket.directionY.data());
+				localDirection.z.store(localPacket.directionZ.data());
+				tMin.store(localPacket.tMin.data());
+				select(active, tMax, SimdFloat(-1.0f)).store(localPacket.tMax.data());
+
+				uint32_t bits = m_instances[i].bvh->intersect(localPacket, hit);
+				if (bits == 0) {
+					continue;
+				}
+
+				updated |= bits;
+				tMax = min(tMax, SimdFloat::load(hit.t.data()));
+
+				while (bits != 0) {
+					const uint32_t lane = static_cast<uint32_t>(std::countr_zero(bits));
+					bits &= bits - 1;
+					hit.instanceIndex[lane] = m_instanceIndices[i];
+				}
+			}
+		});
+
+		return updated;
+	}
+
+	Ray SceneBvh::toObjectSpace(const Instance& instance, const Ray& ray) const {
+		Ray localRay = ray;
+		localRay.origin = glm::vec3(instance.worldToObject * glm::vec4(ray.origin, 1.0f));
+		localRay.direction = glm::vec3(instance.worldToObject * glm::vec4(ray.direction, 0.0f));
+		return localRay;
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "scene/spatial/bvh.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @struct BvhInstance
+	 *
+	 * @brief A placement of a mesh BVH in the world, like an instance of a TLAS.
+	 */
+	struct BvhInstance {
+		const Bvh* bvh = nullptr;
+		glm::mat4 objectToWorld{ 1.0f };
+	};
+
+	/**
+	 * @class SceneBvh
+	 *
+	 * @brief Two-level CPU BVH: a BVH over instances, each referencing the BVH of its mesh.
+	 *
+	 * Rays reaching an instance are moved to its object space and traced in the mesh BVH.
+	 * Directions are transformed without normalizing them, so hit distances stay in world units.
+	 * The mesh BVHs must outlive the SceneBvh, any number of instances can share one.
+	 */
+	class SceneBvh {
+	public:
+		/**
+		 * @brief Builds the instance BVH, replacing any previous content.
+		 *
+		 * The hits report the index of their instance in instances.
+		 */
+		void build(std::span<const BvhInstance> instances, const BvhBuilder::Settings& settings = {});
+
+		/**
+		 * @brief Finds the closest hit of a ray, only accepting hits closer than hit.t.
+		 *
+		 * @return true if hit was updated.
+		 */
+		bool intersect(const Ray& ray, RayHit& hit) const;
+
+		/**
+		 * @brief Returns true if the ray hits any instance in [tMin, tMax).
+		 */
+		bool isOccluded(const Ray& ray) const;
+
+		/**
+		 * @brief Finds the closest hit of every lane of a packet, only accepting hits closer than their hit.t.
+		 *
+		 * @return The bits of the lanes whose hit was updated.
+		 */
+		uint32_t intersect(const RayPacket& packet, RayPacketHit& hit) const;
+
+		const Aabb& getBounds() const { return m_bounds; }
+		uint32_t getInstanceCount() const { return static_cast<uint32_t>(m_instances.size()); }
+
+	private:
+		struct Instance {
+			const Bvh* bvh;
+			glm::mat4 worldToObject;
+		};
+
+		Ray toObjectSpace(const Instance& instance, const Ray& ray) const;
+
+		std::vector<BvhNode> m_nodes;
+		std::vector<uint32_t> m_instanceIndices; // BVH order -> index of the instance given to build
+		std::vector<Instance> m_instances;       // in BVH order
+
+		Aabb m_bounds;
+	};
+}
@@ -0,0 +1,285 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+// PXT_SIMD_FORCE_SSE and PXT_SIMD_FORCE_SCALAR select a narrower backend than the target allows,
+// the tests are built once per backend with them
+#if defined(__AVX2__) && !defined(PXT_SIMD_FORCE_SSE) && !defined(PXT_SIMD_FORCE_SCALAR)
+	#include <immintrin.h>
+	#define PXT_SIMD_AVX2
+#elif (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(PXT_SIMD_FORCE_SCALAR)
+	#include <emmintrin.h>
+	#define PXT_SIMD_SSE
+#endif
+
+namespace PXTEngine {
+
+	/**
+	 * @brief Number of lanes of SimdFloat: 8 with AVX2, 4 with SSE and in the scalar fallback.
+	 */
+#if defined(PXT_SIMD_AVX2)
+	inline constexpr uint32_t SIMD_WIDTH = 8;
+#else
+	inline constexpr uint32_t SIMD_WIDTH = 4;
+#endif
+
+	/**
+	 * @struct SimdMask
+	 *
+	 * @brief Per lane boolean produced by the comparisons of SimdFloat.
+	 */
+	struct SimdMask {
+#if defined(PXT_SIMD_AVX2)
+		__m256 value;
+
+		static SimdMask fromBits(const uint32_t bits) {
+			const __m256i lanes = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+			const __m256i set = _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(bits)), lanes);
+			return { _mm256_castsi256_ps(_mm256_cmpeq_epi32(set, lanes)) };
+		}
+
+		uint32_t getBits() const { return static_cast<uint32_t>(_mm256_movemask_ps(value)); }
+
+		SimdMask operator&(const SimdMask& other) const { return { _mm256_and_ps(value, other.value) }; }
+		SimdMask operator|(const SimdMask& other) const { return { _mm256_or_ps(value, other.value) }; }
+
+		/** @brief Lanes set in this mask and not in other. */
+		SimdMask andNot(const SimdMask& other) const { return { _mm256_andnot_ps(other.value, value) }; }
+#elif defined(PXT_SIMD_SSE)
+		__m128 value;
+
+		static SimdMask fromBits(const uint32_t bits) {
+			const __m128i lanes = _mm_setr_epi32(1, 2, 4, 8);
+			const __m128i set = _mm_and_si128(_mm_set1_epi32(static_cast<int>(bits)), lanes);
+			return { _mm_castsi128_ps(_mm_cmpeq_epi32(set, lanes)) };
+		}
+
+		uint32_t getBits() const { return static_cast<uint32_t>(_mm_movemask_ps(value)); }
+
+		SimdMask operator&(const SimdMask& other) const { return { _mm_and_ps(value, other.value) }; }
+		SimdMask operator|(const SimdMask& other) const { return { _mm_or_ps(value, other.value) }; }
+
+		/** @brief Lanes set in this mask and not in other. */
+		SimdMask andNot(const SimdMask& other) const { return { _mm_andnot_ps(other.value, value) }; }
+#else
+		uint32_t value;
+
+		static SimdMask fromBits(const uint32_t bits) { return { bits & ((1u << SIMD_WIDTH) - 1) }; }
+
+		uint32_t getBits() const { return value; }
+
+		SimdMask operator&(const SimdMask& other) const { return { value & other.value }; }
+		SimdMask operator|(const SimdMask& other) const { return { value | other.value }; }
+
+		/** @brief Lanes set in this mask and not in other. */
+		SimdMask andNot(const SimdMask& other) const { return { value & ~other.value }; }
+#endif
+
+		bool any() const { return getBits() != 0; }
+		bool none() const { return getBits() == 0; }
+	};
+
+	/**
+	 * @struct SimdFloat
+	 *
+	 * @brief SIMD_WIDTH floats processed together, with the few operations the ray queries and the image passes need.
+	 */
+	struct SimdFloat {
+#if defined(PXT_SIMD_AVX2)
+		__m256 value;
+
+		SimdFloat() = default;
+		SimdFloat(const __m256 v) : value(v) {}
+		SimdFloat(const float v) : value(_mm256_set1_ps(v)) {}
+
+		static SimdFloat load(const float* data) { return { _mm256_loadu_ps(data) }; }
+		void store(float* data) const { _mm256_storeu_ps(data, value); }
+
+		SimdFloat operator+(const SimdFloat& other) const { return { _mm256_add_ps(value, other.value) }; }
+		SimdFloat operator-(const SimdFloat& other) const { return { _mm256_sub_ps(value, other.value) }; }
+		SimdFloat operator*(const SimdFloat& other) const { return { _mm256_mul_ps(value, other.value) }; }
+		SimdFloat operator/(const SimdFloat& other) const { return { _mm256_div_ps(value, other.value) }; }
+		SimdFloat operator-() const { return { _mm256_xor_ps(value, _mm256_set1_ps(-0.0f)) }; }
+
+		SimdMask operator<(const SimdFloat& other) const { return { _mm256_cmp_ps(value, other.value, _CMP_LT_OQ) }; }
+		SimdMask operator<=(const SimdFloat& other) const { return { _mm256_cmp_ps(value, other.value, _CMP_LE_OQ) }; }
+		SimdMask operator>(const SimdFloat& other) const { return { _mm256_cmp_ps(value, other.value, _CMP_GT_OQ) }; }
+		SimdMask operator>=(const SimdFloat& other) const { return { _mm256_cmp_ps(value, other.value, _CMP_GE_OQ) }; }
+
+		friend SimdFloat min(const SimdFloat& a, const SimdFloat& b) { return { _mm256_min_ps(a.value, b.value) }; }
+		friend SimdFloat max(const SimdFloat& a, const SimdFloat& b) { return { _mm256_max_ps(a.value, b.value) }; }
+		friend SimdFloat abs(const SimdFloat& a) { return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.value) }; }
+		friend SimdFloat sqrt(const SimdFloat& a) { return { _mm256_sqrt_ps(a.value) }; }
+		friend SimdFloat round(const SimdFloat& a) { return { _mm256_round_ps(a.value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+
+		/** @brief Takes a where mask is set, b elsewhere. */
+		friend SimdFloat select(const SimdMask& mask, const SimdFloat& a, const SimdFloat& b) {
+			return { _mm256_blendv_ps(b.value, a.value, mask.value) };
+		}
+#elif defined(PXT_SIMD_SSE)
+		__m128 value;
+
+		SimdFloat() = default;
+		SimdFloat(const __m128 v) : value(v) {}
+		SimdFloat(const float v) : value(_mm_set1_ps(v)) {}
+
+		static SimdFloat load(const float* data) { return { _mm_loadu_ps(data) }; }
+		void store(float* data) const { _mm_storeu_ps(data, value); }
+
+		SimdFloat operator+(const SimdFloat& other) const { return { _mm_add_ps(value, other.value) }; }
+		SimdFloat operator-(const SimdFloat& other) const { return { _mm_sub_ps(value, other.value) }; }
+		SimdFloat operator*(const SimdFloat& other) const { return { _mm_mul_ps(value, other.value) }; }
+		SimdFloat operator/(const SimdFloat& other) const { return { _mm_div_ps(value, other.value) }; }
+		SimdFloat operator-() const { return { _mm_xor_ps(value, _mm_set1_ps(-0.0f)) }; }
+
+		SimdMask operator<(const SimdFloat& other) const { return { _mm_cmplt_ps(value, other.value) }; }
+		SimdMask operator<=(const SimdFloat& other) const { return { _mm_cmple_ps(value, other.value) }; }
+		SimdMask operator>(const SimdFloat& other) const { return { _mm_cmpgt_ps(value, other.value) }; }
+		SimdMask operator>=(const SimdFloat& other) const { return { _mm_cmpge_ps(value, other.value) }; }
+
+		friend SimdFloat min(const SimdFloat& a, const SimdFloat& b) { return { _mm_min_ps(a.value, b.value) }; }
+		friend SimdFloat max(const SimdFloat& a, const SimdFloat& b) { return { _mm_max_ps(a.value, b.value) }; }
+		friend SimdFloat abs(const SimdFloat& a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.value) }; }
+		friend SimdFloat sqrt(const SimdFloat& a) { return { _mm_sqrt_ps(a.value) }; }
+		// SSE2 has no rounding instruction, the conversion rounds to nearest (exact below 2^31)
+		friend SimdFloat round(const SimdFloat& a) { return { _mm_cvtepi32_ps(_mm_cvtps_epi32(a.value)) }; }
+
+		/** @brief Takes a where mask is set, b elsewhere. */
+		friend SimdFloat select(const SimdMask& mask, const SimdFloat& a, const SimdFloat& b) {
+			return { _mm_or_ps(_mm_and_ps(mask.value, a.value), _mm_andnot_ps(mask.value, b.value)) };
+		}
+#else
+		std::array<float, SIMD_WIDTH> value;
+
+		SimdFloat() = default;
+		SimdFloat(const float v) { value.fill(v); }
+
+		static SimdFloat load(const float* data) {
+			SimdFloat result;
+			std::copy_n(data, SIMD_WIDTH, result.value.begin());
+			return result;
+		}
+
+		void store(float* data) const { std::copy_n(value.begin(), SIMD_WIDTH, data); }
+
+		template <typename Op>
+		static SimdFloat map(const SimdFloat& a, const SimdFloat& b, Op op) {
+			SimdFloat result;
+			for (uint32_t i = 0; i < SIMD_WIDTH; i++) {
+				result.value[i] = op(a.value[i], b.value[i]);
+			}
+			return result;
+		}
+
+		template <typename Op>
+		static SimdMask compare(const SimdFloat& a, const SimdFloat& b, Op op) {
+			uint32_t bits = 0;
+			for (uint32_t i = 0; i < SIMD_WIDTH; i++) {
+				bits |= op(a.value[i], b.value[i]) ? (1u << i) : 0u;
+			}
+			return { bits };
+		}
+
+		SimdFloat operator+(const SimdFloat& other) const { return map(*this, other, std::plus<float>()); }
+		SimdFloat operator-(const SimdFloat& other) const { return map(*this, other, std::minus<float>()); }
+		SimdFloat operator*(const SimdFloat& other) const { return map(*this, other, std::multiplies<float>()); }
+		SimdFloat operator/(const SimdFloat& other) const { return map(*this, other, std::divides<float>()); }
+		SimdFloat operator-() const { return SimdFloat(0.0f) - *this; }
+
+		SimdMask operator<(const SimdFloat& other) const { return compare(*this, other, std::less<float>()); }
+		SimdMask operator<=(const SimdFloat& other) const { return compare(*this, other, std::less_equal<float>()); }
+		SimdMask operator>(const SimdFloat& other) const { return compare(*this, other, std::greater<float>()); }
+		SimdMask operator>=(const SimdFloat& other) const { return compare(*this, other, std::greater_equal<float>()); }
+
+		// like the SSE instructions, the second operand is returned when either is NaN
+		friend SimdFloat min(const SimdFloat& a, const SimdFloat& b) {
+			return map(a, b, [](const float x, const float y) { return x < y ? x : y; });
+		}
+		friend SimdFloat max(const SimdFloat& a, const SimdFloat& b) {
+			return map(a, b, [](const float x, const float y) { return x > y ? x : y; });
+		}
+		friend SimdFloat abs(const SimdFloat& a) {
+			return map(a, a, [](const float x, float) { return std::fabs(x); });
+		}
+		friend SimdFloat sqrt(const SimdFloat& a) {
+			return map(a, a, [](const float x, float) { return std::sqrt(x); });
+		}
+		friend SimdFloat round(const SimdFloat& a) {
+			return map(a, a, [](const float x, float) { return std::nearbyint(x); });
+		}
+
+		/** @brief Takes a where mask is set, b elsewhere. */
+		friend SimdFloat select(const SimdMask& mask, const SimdFloat& a, const SimdFloat& b) {
+			SimdFloat result;
+			for (uint32_t i = 0; i < SIMD_WIDTH; i++) {
+				result.value[i] = (mask.value & (1u << i)) ? a.value[i] : b.value[i];
+			}
+			return result;
+		}
+#endif
+	};
+
+	/**
+	 * @brief Sine and cosine of every lane, within 1e-6 of std::sin and std::cos for angles of a few turns.
+	 *
+	 * The angle is reduced to [-pi, pi] and reflected into [-pi/2, pi/2], where the Taylor
+	 * polynomials of sine (degree 11) and cosine (degree 12) are accurate to float precision.
+	 */
+	inline void sincos(const SimdFloat& angle, SimdFloat& sine, SimdFloat& cosine) {
+		// 2 pi split in an exact high part and a low part, so that the reduction doesn't lose bits
+		const SimdFloat turns = round(angle * SimdFloat(0.159154943f));
+		SimdFloat x = angle - turns * SimdFloat(6.28125f) - turns * SimdFloat(1.93530717e-3f);
+
+		// sin(x) = sin(pi - x) and cos(x) = -cos(pi - x)
+		const SimdMask above = x > SimdFloat(1.57079633f);
+		const SimdMask below = x < SimdFloat(-1.57079633f);
+		x = select(above, SimdFloat(3.14159265f) - x, select(below, SimdFloat(-3.14159265f) - x, x));
+
+		const SimdFloat x2 = x * x;
+
+		SimdFloat s = SimdFloat(-2.50521084e-8f);
+		s = s * x2 + SimdFloat(2.75573192e-6f);
+		s = s * x2 + SimdFloat(-1.98412698e-4f);
+		s = s * x2 + SimdFloat(8.33333333e-3f);
+		s = s * x2 + SimdFloat(-1.66666667e-1f);
+		sine = (s * x2 + SimdFloat(1.0f)) * x;
+
+		SimdFloat c = SimdFloat(2.08767570e-9f);
+		c = c * x2 + SimdFloat(-2.75573192e-7f);
+		c = c * x2 + SimdFloat(2.48015873e-5f);
+		c = c * x2 + SimdFloat(-1.38888889e-3f);
+		c = c * x2 + SimdFloat(4.16666667e-2f);
+		c = c * x2 + SimdFloat(-0.5f);
+		c = c * x2 + SimdFloat(1.0f);
+		cosine = select(above | below, -c, c);
+	}
+
+	/**
+	 * @struct SimdVec3
+	 *
+	 * @brief SIMD_WIDTH vectors stored as one SimdFloat per component.
+	 */
+	struct SimdVec3 {
+		SimdFloat x, y, z;
+
+		SimdVec3() = default;
+		SimdVec3(const SimdFloat& vx, const SimdFloat& vy, const SimdFloat& vz) : x(vx), y(vy), z(vz) {}
+		explicit SimdVec3(const glm::vec3& v) : x(v.x), y(v.y), z(v.z) {}
+
+		SimdVec3 operator+(const SimdVec3& other) const { return { x + other.x, y + other.y, z + other.z }; }
+		SimdVec3 operator-(const SimdVec3& other) const { return { x - other.x, y - other.y, z - other.z }; }
+		SimdVec3 operator*(const SimdFloat& s) const { return { x * s, y * s, z * s }; }
+	};
+
+	inline SimdFloat dot(const SimdVec3& a, const SimdVec3& b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	inline SimdVec3 cross(const SimdVec3& a, const SimdVec3& b) {
+		return {
+			a.y * b.z - a.z * b.y,
+			a.z * b.x - a.x * b.z,
+			a.x * b.y - a.y * b.x
+		};
+	}
+}
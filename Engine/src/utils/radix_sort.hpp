@@ -0,0 +1,62 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+namespace PXTEngine {
+
+	/**
+	 * @brief Sorts 64 bit keys with a least significant digit radix sort, 8 bits per pass.
+	 *
+	 * The sort is stable and the bits below firstBit are not looked at, so a payload (e.g. an
+	 * index) packed in the low bits keeps its original order among equal keys.
+	 * The histograms of every pass are counted in a single read of the keys, and the passes whose
+	 * digit is the same for every key are skipped: small keys cost a single pass.
+	 *
+	 * @param keys The keys to sort.
+	 * @param scratch Working memory, resized to the key count (reuse it to avoid the allocation).
+	 * @param firstBit The first bit of the sort key, it must be a multiple of 8.
+	 */
+	inline void radixSort(std::vector<uint64_t>& keys, std::vector<uint64_t>& scratch, const uint32_t firstBit = 0) {
+		static constexpr uint32_t DIGIT_BITS = 8;
+		static constexpr uint32_t DIGIT_COUNT = 1u << DIGIT_BITS;
+		static constexpr uint32_t MAX_PASS_COUNT = 64 / DIGIT_BITS;
+
+		PXT_ASSERT(firstBit % DIGIT_BITS == 0 && firstBit < 64, "The first bit of the radix sort must be a digit boundary");
+
+		const size_t count = keys.size();
+		if (count < 2) return;
+
+		const uint32_t firstPass = firstBit / DIGIT_BITS;
+
+		std::array<std::array<uint32_t, DIGIT_COUNT>, MAX_PASS_COUNT> histograms{};
+		for (const uint64_t key : keys) {
+			for (uint32_t pass = firstPass; pass < MAX_PASS_COUNT; pass++) {
+				histograms[pass][(key >> (pass * DIGIT_BITS)) & (DIGIT_COUNT - 1)]++;
+			}
+		}
+
+		scratch.resize(count);
+
+		for (uint32_t pass = firstPass; pass < MAX_PASS_COUNT; pass++) {
+			std::array<uint32_t, DIGIT_COUNT>& histogram = histograms[pass];
+
+			// every key has the same digit, the order doesn't change
+			const uint32_t firstKeyDigit = (keys[0] >> (pass * DIGIT_BITS)) & (DIGIT_COUNT - 1);
+			if (histogram[firstKeyDigit] == count) continue;
+
+			// the histogram becomes the offset of the first key of every digit
+			uint32_t offset = 0;
+			for (uint32_t& digitCount : histogram) {
+				const uint32_t digitKeys = digitCount;
+				digitCount = offset;
+				offset += digitKeys;
+			}
+
+			for (const uint64_t key : keys) {
+				scratch[histogram[(key >> (pass * DIGIT_BITS)) & (DIGIT_COUNT - 1)]++] = key;
+			}
+
+			keys.swap(scratch);
+		}
+	}
+}
@@ -0,0 +1,113 @@
+#include "test_framework.hpp"
+
+#include "graphics/memory/tlsf_allocator.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	/**
+	 * @brief Sizes like the ones of the engine resources: mostly small uniform and geometry
+	 * buffers, some textures of a few MB.
+	 */
+	uint64_t randomResourceSize(std::mt19937& random) {
+		if (random() % 16 == 0) {
+			return (1 + random() % 8) * 1024 * 1024;
+		}
+		return (1 + random() % 256) * 256;
+	}
+
+	/**
+	 * @brief Largest range allocate still returns, found by bisection on a copy of the allocator.
+	 */
+	uint64_t findLargestAllocatable(const TlsfAllocator& allocator) {
+		uint64_t low = 0;
+		uint64_t high = allocator.getFreeSize();
+
+		while (low < high) {
+			const uint64_t middle = (low + high + 1) / 2;
+			TlsfAllocator probe = allocator;
+			if (probe.allocate(middle).isValid()) {
+				low = middle;
+			} else {
+				high = middle - 1;
+			}
+		}
+		return low;
+	}
+}
+
+PXT_BENCHMARK(tlsfAllocatorThroughput) {
+	constexpr uint64_t blockSize = 256ull * 1024 * 1024;
+	constexpr uint32_t liveCount = 4096;
+	constexpr uint32_t operationCount = 1 << 20;
+
+	TlsfAllocator allocator(blockSize);
+	std::mt19937 random(7);
+
+	std::vector<TlsfAllocator::Allocation> allocations;
+	for (uint32_t i = 0; i < liveCount; i++) {
+		allocations.push_back(allocator.allocate((1 + random() % 256) * 256, 256));
+	}
+
+	// precomputed, so that only the allocator is measured
+	std::vector<uint32_t> slots(operationCount);
+	std::vector<uint64_t> sizes(operationCount);
+	for (uint32_t i = 0; i < operationCount; i++) {
+		slots[i] = random() % liveCount;
+		sizes[i] = (1 + random() % 256) * 256;
+	}
+
+	// every iteration frees a random live range and allocates a new one in its place
+	const double seconds = Tests::measureSeconds(5, [&] {
+		for (uint32_t i = 0; i < operationCount; i++) {
+			TlsfAllocator::Allocation& allocation = allocations[slots[i]];
+			allocator.free(allocation);
+			allocation = allocator.allocate(sizes[i], 256);
+		}
+	});
+
+	Tests::report(std::format("{} live ranges: {:.1f} M free+allocate/s ({:.1f} ns per pair)",
+		liveCount, operationCount / seconds * 1e-6, seconds / operationCount * 1e9));
+}
+
+PXT_BENCHMARK(tlsfAllocatorFragmentation) {
+	constexpr uint64_t blockSize = 256ull * 1024 * 1024;
+
+	TlsfAllocator allocator(blockSize);
+	std::mt19937 random(11);
+
+	std::vector<TlsfAllocator::Allocation> allocations;
+	uint32_t failedCount = 0;
+
+	// fill the block to about 75%, then churn around that level like a streaming scene
+	for (uint32_t step = 0; step < 200000; step++) {
+		const double usage = 1.0 - static_cast<double>(allocator.getFreeSize()) / blockSize;
+		const bool shouldAllocate = allocations.empty() || (usage < 0.75 && random() % 2 == 0) || random() % 4 == 0;
+
+		if (shouldAllocate) {
+			const TlsfAllocator::Allocation allocation = allocator.allocate(randomResourceSize(random), 256);
+			if (allocation.isValid()) {
+				allocations.push_back(allocation);
+			} else {
+				failedCount++;
+			}
+		} else {
+			const size_t index = random() % allocations.size();
+			allocator.free(allocations[index]);
+			allocations[index] = allocations.back();
+			allocations.pop_back();
+		}
+
+		if (step % 50000 == 49999) {
+			const uint64_t freeSize = allocator.getFreeSize();
+			const uint64_t largest = findLargestAllocatable(allocator);
+
+			// 0% when the whole free space is one allocatable range
+			const double fragmentation = freeSize > 0 ? 100.0 * (1.0 - static_cast<double>(largest) / freeSize) : 0.0;
+
+			Tests::report(std::format("step {}: {} live ranges, {:.1f} MB free, largest allocatable {:.1f} MB, fragmentation {:.1f}%, {} failed allocations",
+				step + 1, allocations.size(), freeSize / (1024.0 * 1024.0), largest / (1024.0 * 1024.0), fragmentation, failedCount));
+		}
+	}
+}
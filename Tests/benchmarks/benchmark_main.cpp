@@ -0,0 +1,20 @@
+#include "test_framework.hpp"
+
+#include "core/jobs/job_system.hpp"
+
+using namespace PXTEngine;
+
+// pxt_benchmarks [filter]: runs the benchmarks whose name contains filter, from the repository root
+// so that the assets are found
+int main(const int argc, char** argv) {
+	Logger::init();
+	JobSystem::init();
+
+	const std::string filter = argc > 1 ? argv[1] : "";
+	const uint32_t failureCount = Tests::runCases(Tests::getBenchmarks(), filter);
+
+	JobSystem::shutdown();
+	Logger::shutdown();
+
+	return failureCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+#include "test_framework.hpp"
+
+#include "resources/importers/mesh_importer.hpp"
+#include "scene/spatial/bvh.hpp"
+#include "scene/spatial/scene_bvh.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	constexpr uint32_t IMAGE_SIZE = 512;
+
+	/**
+	 * @brief Primary rays of a pinhole camera looking at the center of bounds, one per pixel, in row order.
+	 *
+	 * @param viewOffset The camera position from the center, in units of the radius of bounds.
+	 */
+	std::vector<Ray> makeCameraRays(const Aabb& bounds, const glm::vec3& viewOffset) {
+		const glm::vec3 center = bounds.getCenter();
+		const float radius = glm::length(bounds.getExtent()) * 0.5f;
+
+		const glm::vec3 origin = center + radius * viewOffset;
+		const glm::vec3 forward = glm::normalize(center - origin);
+		const glm::vec3 right = glm::normalize(glm::cross(forward, glm::vec3(0.0f, 1.0f, 0.0f)));
+		const glm::vec3 up = glm::cross(right, forward);
+
+		std::vector<Ray> rays(IMAGE_SIZE * IMAGE_SIZE);
+		for (uint32_t y = 0; y < IMAGE_SIZE; y++) {
+			for (uint32_t x = 0; x < IMAGE_SIZE; x++) {
+				const glm::vec2 ndc = (glm::vec2(x, y) + 0.5f) / static_cast<float>(IMAGE_SIZE) * 2.0f - 1.0f;
+				Ray& ray = rays[y * IMAGE_SIZE + x];
+				ray.origin = origin;
+				ray.direction = glm::normalize(forward + 0.6f * (ndc.x * right - ndc.y * up));
+			}
+		}
+		return rays;
+	}
+
+	/**
+	 * @brief Traces the rays one by one then as packets of SIMD_WIDTH neighbouring pixels, reports Mrays/s.
+	 */
+	template <typename Accelerator>
+	void reportTraversal(const std::string& name, const Accelerator& accelerator, const std::vector<Ray>& rays) {
+		uint32_t hitCount = 0;
+		const double singleSeconds = Tests::measureSeconds(3, [&] {
+			hitCount = 0;
+			for (const Ray& ray : rays) {
+				RayHit hit;
+				hitCount += accelerator.intersect(ray, hit) ? 1 : 0;
+			}
+		});
+
+		uint32_t packetHitCount = 0;
+		const double packetSeconds = Tests::measureSeconds(3, [&] {
+			packetHitCount = 0;
+			for (size_t first = 0; first < rays.size(); first += SIMD_WIDTH) {
+				RayPacket packet;
+				for (uint32_t lane = 0; lane < SIMD_WIDTH; lane++) {
+					packet.setRay(lane, rays[first + lane]);
+				}
+
+				RayPacketHit hit;
+				packetHitCount += std::popcount(accelerator.intersect(packet, hit));
+			}
+		});
+
+		PXT_CHECK_EQ(packetHitCount, hitCount);
+
+		const double rayCount = static_cast<double>(rays.size());
+		Tests::report(std::format("{}: {:.1f}% hits, single rays {:.2f} Mrays/s, packets of {} {:.2f} Mrays/s",
+			name, 100.0 * hitCount / rayCount, rayCount / singleSeconds * 1e-6, SIMD_WIDTH, rayCount / packetSeconds * 1e-6));
+	}
+}
+
+PXT_BENCHMARK(bvhModelBuildAndTraversal) {
+	for (const char* path : { "assets/models/stanford_bunny.obj", "assets/models/utah_teapot.obj" }) {
+		std::vector<Mesh::Vertex> vertices;
+		std::vector<uint32_t> indices;
+		MeshImporter::parseObj(path, vertices, indices);
+
+		Bvh bvh;
+		const double buildSeconds = Tests::measureSeconds(5, [&] { bvh.build(vertices, indices); });
+
+		const std::string name = std::filesystem::path(path).filename().string();
+		Tests::report(std::format("{}: {} triangles, {} nodes, built in {:.2f} ms",
+			name, bvh.getTriangleCount(), bvh.getNodes().size(), buildSeconds * 1e3));
+
+		reportTraversal(name, bvh, makeCameraRays(bvh.getBounds(), glm::vec3(0.4f, 0.6f, 1.8f)));
+	}
+}
+
+PXT_BENCHMARK(sceneBvhInstancedBuildAndTraversal) {
+	std::array<std::vector<Mesh::Vertex>, 2> vertices;
+	std::array<std::vector<uint32_t>, 2> indices;
+	MeshImporter::parseObj("assets/models/stanford_bunny.obj", vertices[0], indices[0]);
+	MeshImporter::parseObj("assets/models/utah_teapot.obj", vertices[1], indices[1]);
+
+	std::array<Bvh, 2> bvhs;
+	for (uint32_t mesh = 0; mesh < bvhs.size(); mesh++) {
+		bvhs[mesh].build(vertices[mesh], indices[mesh]);
+	}
+
+	// a field of rotated and scaled copies, each one about a unit wide
+	constexpr uint32_t side = 32;
+	std::vector<BvhInstance> instances;
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	for (uint32_t i = 0; i < side * side; i++) {
+		const Bvh& bvh = bvhs[i % 2];
+		const float scale = (0.6f + 0.4f * unit(random)) / glm::length(bvh.getBounds().getExtent());
+
+		glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(i % side, 0.0f, i / side) * 1.2f);
+		transform = glm::rotate(transform, unit(random) * 6.28f, glm::vec3(0.0f, 1.0f, 0.0f));
+		transform = glm::scale(transform, glm::vec3(scale));
+		transform = glm::translate(transform, -bvh.getBounds().getCenter());
+
+		instances.push_back({ &bvh, transform });
+	}
+
+	SceneBvh scene;
+	const double buildSeconds = Tests::measureSeconds(5, [&] { scene.build(instances); });
+	Tests::report(std::format("{} instances, {} triangles: instance BVH built in {:.3f} ms",
+		instances.size(), (side * side / 2) * (bvhs[0].getTriangleCount() + bvhs[1].getTriangleCount()), buildSeconds * 1e3));
+
+	// low over the edge of the field, the rays skim over many instances before hitting one
+	reportTraversal("instanced field", scene, makeCameraRays(scene.getBounds(), glm::vec3(0.0f, 0.1f, 0.9f)));
+}
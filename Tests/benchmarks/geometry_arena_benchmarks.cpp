@@ -0,0 +1,112 @@
+#include "test_framework.hpp"
+
+#include "graphics/memory/geometry_range_allocator.hpp"
+#include "resources/types/mesh.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+
+	struct MeshSize {
+		uint32_t vertexCount;
+		uint32_t indexCount;
+	};
+
+	/**
+	 * @brief The sizes of a scene of many small and a few large meshes, from a cube to a detailed prop.
+	 */
+	std::vector<MeshSize> createMeshSizes(const uint32_t count, const uint32_t seed) {
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> exponent(std::log2(24.0f), std::log2(8192.0f));
+
+		std::vector<MeshSize> sizes(count);
+		for (MeshSize& size : sizes) {
+			size.vertexCount = static_cast<uint32_t>(std::exp2(exponent(random)));
+			size.indexCount = size.vertexCount * 3 / 2;
+		}
+		return sizes;
+	}
+
+	// the default capacities of the GeometryArena of the Context
+	constexpr uint32_t VERTEX_CAPACITY = 1u << 20;
+	constexpr uint32_t INDEX_CAPACITY = 1u << 22;
+
+	/**
+	 * @brief Allocates the ranges of a mesh, growing and repacking the capacities when it doesn't fit as GeometryArena::allocate does.
+	 */
+	GeometryRangeAllocator::Handle allocateGrowing(GeometryRangeAllocator& allocator, const MeshSize& size, uint32_t& growthCount) {
+		GeometryRangeAllocator::Handle handle = allocator.allocate(size.vertexCount, size.indexCount);
+		if (handle == GeometryRangeAllocator::INVALID_HANDLE) {
+			uint64_t vertexCapacity = 0;
+			uint64_t indexCapacity = 0;
+			allocator.calculateGrownCapacities(size.vertexCount, size.indexCount, vertexCapacity, indexCapacity);
+
+			std::vector<GeometryMove> moves;
+			allocator.repack(static_cast<uint32_t>(vertexCapacity), static_cast<uint32_t>(indexCapacity), moves);
+			growthCount++;
+
+			handle = allocator.allocate(size.vertexCount, size.indexCount);
+		}
+
+		PXT_CHECK(handle != GeometryRangeAllocator::INVALID_HANDLE);
+		return handle;
+	}
+}
+
+PXT_BENCHMARK(geometryArenaManyMeshes) {
+	for (const uint32_t meshCount : { 1000u, 10000u }) {
+		const std::vector<MeshSize> sizes = createMeshSizes(meshCount, meshCount);
+
+		// the loading of the scene, every mesh in the same arena instead of a vertex and an index buffer each
+		uint32_t loadGrowthCount = 0;
+		const double loadSeconds = Tests::measureSeconds(5, [&] {
+			GeometryRangeAllocator allocator(VERTEX_CAPACITY, INDEX_CAPACITY, FRAMES_IN_FLIGHT);
+			loadGrowthCount = 0;
+			for (const MeshSize& size : sizes) {
+				allocateGrowing(allocator, size, loadGrowthCount);
+			}
+		});
+
+		GeometryRangeAllocator allocator(VERTEX_CAPACITY, INDEX_CAPACITY, FRAMES_IN_FLIGHT);
+		std::vector<GeometryRangeAllocator::Handle> handles;
+		uint32_t growthCount = 0;
+		for (const MeshSize& size : sizes) {
+			handles.push_back(allocateGrowing(allocator, size, growthCount));
+		}
+		growthCount = 0;
+
+		// streaming: a mesh in a hundred is unloaded and replaced every frame
+		std::mt19937 random(meshCount);
+		const uint32_t streamedCount = std::max(1u, meshCount / 100);
+		const double frameSeconds = Tests::measureSeconds(200, [&] {
+			for (uint32_t i = 0; i < streamedCount; i++) {
+				const size_t mesh = random() % handles.size();
+				allocator.free(handles[mesh]);
+				handles[mesh] = allocateGrowing(allocator, sizes[mesh], growthCount);
+			}
+			allocator.advanceFrame();
+		});
+
+		// unloading half of the scene, then compacting what is left
+		for (size_t mesh = 0; mesh < handles.size(); mesh += 2) {
+			allocator.free(handles[mesh]);
+		}
+		std::vector<GeometryMove> moves;
+		const auto repackStart = std::chrono::steady_clock::now();
+		allocator.repack(allocator.getVertexCapacity(), allocator.getIndexCapacity(), moves);
+		const double repackSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - repackStart).count();
+
+		uint64_t movedBytes = 0;
+		for (const GeometryMove& move : moves) {
+			movedBytes += static_cast<uint64_t>(move.source.vertexCount) * sizeof(Mesh::Vertex) +
+				static_cast<uint64_t>(move.source.indexCount) * sizeof(uint32_t);
+		}
+
+		Tests::report(std::format("{} meshes: loaded in {:.3f} ms ({} growths), {} streamed per frame in {:.1f} us "
+			"({} growths), repack of half of them {:.3f} ms, {} moves, {:.1f} MB to copy",
+			meshCount, loadSeconds * 1e3, loadGrowthCount, streamedCount, frameSeconds * 1e6, growthCount,
+			repackSeconds * 1e3, moves.size(), movedBytes / (1024.0 * 1024.0)));
+	}
+}
@@ -0,0 +1,135 @@
+#include "test_framework.hpp"
+
+#include "core/jobs/job_system.hpp"
+
+#include <future>
+
+using namespace PXTEngine;
+
+namespace {
+
+	/**
+	 * @brief A few hundred nanoseconds of work the compiler can't remove.
+	 */
+	uint32_t doSmallWork(uint32_t seed) {
+		for (uint32_t i = 0; i < 64; i++) {
+			seed = seed * 1664525u + 1013904223u;
+		}
+		return seed;
+	}
+}
+
+PXT_BENCHMARK(jobSystemSpawnOverhead) {
+	constexpr uint32_t jobCount = 100000;
+	std::atomic<uint32_t> sink = 0;
+
+	// every job is pushed by the main thread, so the workers only get work by stealing it
+	const double jobSeconds = Tests::measureSeconds(5, [&] {
+		JobCounter counter;
+		for (uint32_t i = 0; i < jobCount; i++) {
+			JobSystem::run([&sink, i]() { sink += doSmallWork(i); }, &counter);
+		}
+		JobSystem::wait(counter);
+	});
+
+	// std::async starts a thread per task, so it gets fewer tasks to keep the run short
+	constexpr uint32_t asyncCount = jobCount / 20;
+	const double asyncSeconds = Tests::measureSeconds(5, [&] {
+		std::vector<std::future<void>> futures;
+		futures.reserve(asyncCount);
+		for (uint32_t i = 0; i < asyncCount; i++) {
+			futures.push_back(std::async(std::launch::async, [&sink, i]() { sink += doSmallWork(i); }));
+		}
+		for (std::future<void>& future : futures) {
+			future.wait();
+		}
+	});
+
+	const double serialSeconds = Tests::measureSeconds(5, [&] {
+		for (uint32_t i = 0; i < jobCount; i++) {
+			sink += doSmallWork(i);
+		}
+	});
+
+	Tests::report(std::format("{} workers, small jobs: JobSystem::run {:.0f} ns/job, std::async {:.0f} ns/task, inline {:.0f} ns/call",
+		JobSystem::getWorkerCount(), jobSeconds / jobCount * 1e9, asyncSeconds / asyncCount * 1e9, serialSeconds / jobCount * 1e9));
+}
+
+PXT_BENCHMARK(jobSystemNestedSpawnOverhead) {
+	constexpr uint32_t parentCount = 256;
+	constexpr uint32_t childCount = 256;
+	std::atomic<uint32_t> sink = 0;
+
+	// the jobs spawn their children on their own queue: pops by the owner, steals by the others
+	const double jobSeconds = Tests::measureSeconds(5, [&] {
+		JobCounter counter;
+		for (uint32_t parent = 0; parent < parentCount; parent++) {
+			JobSystem::run([&, parent]() {
+				for (uint32_t child = 0; child < childCount; child++) {
+					const uint32_t seed = parent * childCount + child;
+					JobSystem::run([&sink, seed]() { sink += doSmallWork(seed); }, &counter);
+				}
+			}, &counter);
+		}
+		JobSystem::wait(counter);
+	});
+
+	// a smaller tree with std::async, every task is a thread and the parents block on their children
+	constexpr uint32_t asyncParentCount = parentCount / 8;
+	constexpr uint32_t asyncChildCount = childCount / 16;
+	const double asyncSeconds = Tests::measureSeconds(3, [&] {
+		std::vector<std::future<void>> parents;
+		for (uint32_t parent = 0; parent < asyncParentCount; parent++) {
+			parents.push_back(std::async(std::launch::async, [&, parent]() {
+				std::vector<std::future<void>> children;
+				for (uint32_t child = 0; child < asyncChildCount; child++) {
+					const uint32_t seed = parent * childCount + child;
+					children.push_back(std::async(std::launch::async, [&sink, seed]() { sink += doSmallWork(seed); }));
+				}
+				for (std::future<void>& future : children) {
+					future.wait();
+				}
+			}));
+		}
+		for (std::future<void>& future : parents) {
+			future.wait();
+		}
+	});
+
+	const uint32_t jobCount = parentCount * (childCount + 1);
+	const uint32_t asyncCount = asyncParentCount * (asyncChildCount + 1);
+	Tests::report(std::format("{} jobs: JobSystem {:.0f} ns/job, std::async {:.0f} ns/task",
+		jobCount, jobSeconds / jobCount * 1e9, asyncSeconds / asyncCount * 1e9));
+}
+
+PXT_BENCHMARK(jobSystemParallelForScaling) {
+	constexpr size_t count = 1 << 22;
+	std::vector<uint32_t> values(count);
+
+	const auto fill = [&](const size_t begin, const size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			values[i] = doSmallWork(static_cast<uint32_t>(i));
+		}
+	};
+
+	const double serialSeconds = Tests::measureSeconds(3, [&] { fill(0, count); });
+
+	for (const size_t grainSize : { 256ull, 4096ull, 65536ull }) {
+		const double jobSeconds = Tests::measureSeconds(3, [&] { JobSystem::parallelFor(count, grainSize, fill); });
+
+		// std::async with one task per hardware thread, the usual hand written split
+		const uint32_t taskCount = JobSystem::getWorkerCount() + 1;
+		const double asyncSeconds = Tests::measureSeconds(3, [&] {
+			std::vector<std::future<void>> futures;
+			for (uint32_t task = 0; task < taskCount; task++) {
+				futures.push_back(std::async(std::launch::async, fill, count * task / taskCount, count * (task + 1) / taskCount));
+			}
+			for (std::future<void>& future : futures) {
+				future.wait();
+			}
+		});
+
+		Tests::report(std::format("grain {}: parallelFor {:.2f}x, std::async split {:.2f}x over serial",
+			grainSize, serialSeconds / jobSeconds, serialSeconds / asyncSeconds));
+	}
+}
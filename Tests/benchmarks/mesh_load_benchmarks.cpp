@@ -0,0 +1,86 @@
+#include "test_framework.hpp"
+
+#include "core/mapped_file.hpp"
+#include "resources/importers/mesh_importer.hpp"
+
+#if defined(PXT_PLATFORM_LINUX)
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+using namespace PXTEngine;
+
+namespace {
+
+	/**
+	 * @brief Drops the pages of a file from the page cache, so that the next load reads the disk.
+	 *
+	 * Only on Linux, elsewhere the cold loads are the first loads of the process, from the page cache.
+	 */
+	void evictFromPageCache(const std::filesystem::path& path) {
+#if defined(PXT_PLATFORM_LINUX)
+		const int fileDescriptor = open(path.c_str(), O_RDONLY);
+		if (fileDescriptor >= 0) {
+			posix_fadvise(fileDescriptor, 0, 0, POSIX_FADV_DONTNEED);
+			close(fileDescriptor);
+		}
+#endif
+	}
+
+	/**
+	 * @brief Times a single call, Tests::measureSeconds() would warm the caches first.
+	 */
+	template <typename Function>
+	double measureOnceSeconds(Function&& function) {
+		const auto start = std::chrono::steady_clock::now();
+		function();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	/**
+	 * @brief The CPU side of MeshImporter::loadCooked, the arrays copied as they are into the staging buffers.
+	 */
+	void loadCooked(const std::filesystem::path& cookedPath, std::vector<Mesh::Vertex>& vertices, std::vector<uint32_t>& indices) {
+		const Shared<MappedFile> file = MeshImporter::mapCooked(cookedPath);
+		const auto* header = file->get<CookedMeshHeader>();
+
+		const Mesh::Vertex* firstVertex = file->get<Mesh::Vertex>(header->vertexOffset);
+		const uint32_t* firstIndex = file->get<uint32_t>(header->indexOffset);
+		vertices.assign(firstVertex, firstVertex + header->vertexCount);
+		indices.assign(firstIndex, firstIndex + header->indexCount);
+	}
+}
+
+PXT_BENCHMARK(meshLoadObjVersusCooked) {
+	std::vector<std::filesystem::path> paths;
+	for (const auto& entry : std::filesystem::directory_iterator("assets/models")) {
+		if (entry.path().extension() == ".obj") {
+			paths.push_back(entry.path());
+		}
+	}
+	std::sort(paths.begin(), paths.end());
+
+	std::vector<Mesh::Vertex> vertices;
+	std::vector<uint32_t> indices;
+
+	for (const std::filesystem::path& path : paths) {
+		// the first run of the engine cooks the meshes next to their OBJ, as here
+		std::filesystem::path cookedPath;
+		const double cookSeconds = measureOnceSeconds([&] { cookedPath = MeshImporter::cookObj(path); });
+
+		evictFromPageCache(path);
+		const double objColdSeconds = measureOnceSeconds([&] { MeshImporter::parseObj(path, vertices, indices); });
+		const double objWarmSeconds = Tests::measureSeconds(5, [&] { MeshImporter::parseObj(path, vertices, indices); });
+		const size_t vertexCount = vertices.size();
+
+		evictFromPageCache(cookedPath);
+		const double cookedColdSeconds = measureOnceSeconds([&] { loadCooked(cookedPath, vertices, indices); });
+		const double cookedWarmSeconds = Tests::measureSeconds(5, [&] { loadCooked(cookedPath, vertices, indices); });
+		PXT_CHECK_EQ(vertices.size(), vertexCount);
+
+		Tests::report(std::format("{}: {} vertices, cooked in {:.2f} ms, OBJ cold {:.2f} ms warm {:.2f} ms, "
+			"cooked cold {:.3f} ms warm {:.3f} ms ({:.0f}x warm)",
+			path.filename().string(), vertexCount, cookSeconds * 1e3, objColdSeconds * 1e3, objWarmSeconds * 1e3,
+			cookedColdSeconds * 1e3, cookedWarmSeconds * 1e3, objWarmSeconds / cookedWarmSeconds));
+	}
+}
@@ -0,0 +1,36 @@
+#include "test_framework.hpp"
+
+#include "core/jobs/job_system.hpp"
+#include "resources/importers/mip_generator.hpp"
+
+using namespace PXTEngine;
+
+PXT_BENCHMARK(mipGeneratorThroughput) {
+	std::mt19937 random(5);
+
+	for (const uint32_t size : { 1024u, 2048u, 2047u }) {
+		Buffer pixels(static_cast<size_t>(size) * size * 4);
+		for (size_t i = 0; i < pixels.size; i++) {
+			pixels.bytes[i] = static_cast<uint8_t>(random() & 0xFF);
+		}
+
+		for (const ImageFormat format : { RGBA8_LINEAR, RGBA8_SRGB }) {
+			const uint32_t destinationSize = size / 2;
+			std::vector<uint8_t> destination(static_cast<size_t>(destinationSize) * destinationSize * 4);
+
+			// MPix/s counts the source texels, the big levels are split across the workers
+			const double levelSeconds = Tests::measureSeconds(10, [&] {
+				MipGenerator::downsample(pixels.bytes, size, size, destination.data(), isSrgbFormat(format));
+			});
+
+			const double chainSeconds = Tests::measureSeconds(10, [&] {
+				ImageInfo imageInfo(size, size, 4, format);
+				const Shared<Buffer> levels = MipGenerator::generate(pixels, imageInfo);
+			});
+
+			Tests::report(std::format("{}x{} {}: first level {:.0f} MPix/s, whole chain {:.2f} ms ({} workers)",
+				size, size, isSrgbFormat(format) ? "sRGB" : "linear", static_cast<double>(size) * size / levelSeconds * 1e-6,
+				chainSeconds * 1e3, JobSystem::getWorkerCount()));
+		}
+	}
+}
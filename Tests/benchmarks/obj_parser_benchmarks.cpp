@@ -0,0 +1,38 @@
+#include "test_framework.hpp"
+
+#include "core/jobs/job_system.hpp"
+#include "resources/importers/mesh_importer.hpp"
+
+using namespace PXTEngine;
+
+PXT_BENCHMARK(objParserThreadScaling) {
+	// every sample model, the ones the engine actually loads
+	std::vector<std::filesystem::path> paths;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator("assets/models")) {
+		if (entry.path().extension() == ".obj") {
+			paths.push_back(entry.path());
+		}
+	}
+	std::sort(paths.begin(), paths.end());
+
+	std::vector<Mesh::Vertex> vertices;
+	std::vector<uint32_t> indices;
+
+	const uint32_t maxThreadCount = JobSystem::getWorkerCount() + 1;
+	for (const std::filesystem::path& path : paths) {
+		std::string line = std::format("{}:", path.filename().string());
+
+		for (const uint32_t threadCount : { 1u, 2u, 4u, 8u }) {
+			if (threadCount > maxThreadCount) break;
+
+			const double seconds = Tests::measureSeconds(3, [&] {
+				MeshImporter::parseObj(path, vertices, indices, threadCount);
+			});
+
+			line += std::format(" {} threads {:.2f} ms ({:.1f} M corners/s),", threadCount, seconds * 1e3, indices.size() / seconds * 1e-6);
+		}
+
+		line.pop_back();
+		Tests::report(line);
+	}
+}
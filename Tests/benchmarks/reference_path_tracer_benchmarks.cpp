@@ -0,0 +1,200 @@
+#include "test_framework.hpp"
+#include "test_scenes.hpp"
+
+#include "graphics/reference/reference_denoiser.hpp"
+#include "graphics/reference/reference_path_tracer.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	constexpr uint32_t IMAGE_SIZE = 64;
+	constexpr uint32_t REFERENCE_SAMPLES = 1024;
+
+	// frameIndex of the reference passes, far from the ones of the measured renders so their paths differ
+	constexpr uint32_t REFERENCE_FRAME_INDEX = 1 << 20;
+
+	/**
+	 * @brief Renders the reference image of a scene with many samples per pixel.
+	 */
+	std::vector<glm::vec4> renderReference(const ReferenceScene& scene, const Camera& camera,
+		ReferencePathTracer::Settings settings) {
+		settings.samplesPerPixel = 64;
+
+		ReferencePathTracer pathTracer(settings);
+		pathTracer.resize(IMAGE_SIZE, IMAGE_SIZE);
+
+		while (pathTracer.getAccumulatedSamples() < REFERENCE_SAMPLES) {
+			pathTracer.render(scene, camera, REFERENCE_FRAME_INDEX + pathTracer.getAccumulatedSamples());
+		}
+
+		std::vector<glm::vec4> image;
+		pathTracer.resolve(image);
+		return image;
+	}
+
+	/**
+	 * @brief Reports the RMSE against the reference and the render time at every power of four samples per pixel.
+	 */
+	void reportConvergence(const std::string& name, const ReferenceScene& scene, const Camera& camera,
+		const ReferencePathTracer::Settings& settings, const std::vector<glm::vec4>& reference) {
+		ReferencePathTracer pathTracer(settings);
+		pathTracer.resize(IMAGE_SIZE, IMAGE_SIZE);
+
+		std::vector<glm::vec4> image;
+		std::string line = name + ":";
+		double seconds = 0.0;
+
+		for (uint32_t samples = 1; samples <= 256; samples *= 4) {
+			while (pathTracer.getAccumulatedSamples() < samples) {
+				seconds += pathTracer.render(scene, camera, pathTracer.getAccumulatedSamples()).seconds;
+			}
+
+			pathTracer.resolve(image);
+			line += std::format(" {} spp {:.4f} ({:.0f} ms),", samples, ReferenceDenoiser::computeRmse(image, reference), seconds * 1e3);
+		}
+
+		line.pop_back();
+		Tests::report(line);
+	}
+}
+
+PXT_BENCHMARK(pathTracerEmitterSelectionConvergence) {
+	// a floor lit by a ring of dim lights and a single bright one of the same size,
+	// the case where picking the emitters by power pays the most
+	Tests::QuadScene lights;
+	lights.addQuad(12.0f, false, glm::vec3(0.0f));
+
+	constexpr uint32_t lightCount = 32;
+	for (uint32_t i = 0; i < lightCount; i++) {
+		const float angle = glm::two_pi<float>() * static_cast<float>(i) / static_cast<float>(lightCount);
+		const glm::vec4 emissiveColor = i == 0 ? glm::vec4(1.0f, 1.0f, 1.0f, 60.0f) : glm::vec4(1.0f, 0.9f, 0.8f, 0.5f);
+		lights.addQuad(0.5f, true, glm::vec3(4.0f * std::cos(angle), -3.0f, 4.0f * std::sin(angle)), emissiveColor);
+	}
+	lights.build(glm::vec3(0.0f, -5.0f, -9.0f));
+
+	const std::vector<glm::vec4> reference = renderReference(lights.scene, lights.camera, {});
+
+	for (const bool useEmitterAliasTables : { false, true }) {
+		ReferencePathTracer::Settings settings;
+		settings.useEmitterAliasTables = useEmitterAliasTables;
+
+		reportConvergence(std::format("RMSE, {} emitters", useEmitterAliasTables ? "alias table" : "uniform"),
+			lights.scene, lights.camera, settings, reference);
+	}
+}
+
+PXT_BENCHMARK(pathTracerSamplerConvergence) {
+	Tests::QuadScene shadows;
+	Tests::buildSoftShadowScene(shadows);
+
+	// a white noise reference, the low discrepancy renders must not share its samples
+	ReferencePathTracer::Settings referenceSettings;
+	referenceSettings.useLowDiscrepancySamples = false;
+	const std::vector<glm::vec4> reference = renderReference(shadows.scene, shadows.camera, referenceSettings);
+
+	for (const bool useLowDiscrepancySamples : { false, true }) {
+		ReferencePathTracer::Settings settings;
+		settings.useLowDiscrepancySamples = useLowDiscrepancySamples;
+
+		reportConvergence(std::format("RMSE, {} samples", useLowDiscrepancySamples ? "blue noise/Sobol" : "white noise (tea)"),
+			shadows.scene, shadows.camera, settings, reference);
+	}
+}
+
+PXT_BENCHMARK(denoiserErrorAndTimings) {
+	Tests::QuadScene shadows;
+	Tests::buildSoftShadowScene(shadows);
+
+	// the denoised image is saturated, the images it is compared with too
+	const auto saturate = [](std::vector<glm::vec4>& image) {
+		for (glm::vec4& pixel : image) {
+			pixel = glm::clamp(pixel, 0.0f, 1.0f);
+		}
+	};
+
+	std::vector<glm::vec4> reference = renderReference(shadows.scene, shadows.camera, {});
+	saturate(reference);
+
+	ReferencePathTracer::Settings settings;
+	settings.samplesPerPixel = 1;
+	ReferencePathTracer pathTracer(settings);
+	pathTracer.resize(IMAGE_SIZE, IMAGE_SIZE);
+
+	ReferenceDenoiser denoiser;
+	std::vector<glm::vec4> accumulated;
+	std::vector<glm::vec4> denoised;
+
+	for (uint32_t frame = 0; frame < 16; frame++) {
+		pathTracer.render(shadows.scene, shadows.camera, frame);
+		const DenoiserTimings timings = denoiser.denoise(pathTracer.getFeatures(), IMAGE_SIZE, IMAGE_SIZE, denoised);
+
+		if (std::has_single_bit(frame + 1)) {
+			pathTracer.resolve(accumulated);
+			saturate(accumulated);
+
+			Tests::report(std::format("frame {}: RMSE accumulated {:.4f}, denoised {:.4f}, "
+				"reproject {:.2f} ms, filter {:.2f} ms, modulate {:.2f} ms",
+				frame + 1, ReferenceDenoiser::computeRmse(accumulated, reference), ReferenceDenoiser::computeRmse(denoised, reference),
+				timings.reprojectMs, timings.filterMs, timings.modulateMs));
+		}
+	}
+}
+
+PXT_BENCHMARK(pathTracerAdaptiveSamplingTimeToError) {
+	Tests::QuadScene shadows;
+	Tests::buildSoftShadowScene(shadows);
+
+	ReferencePathTracer::Settings referenceSettings;
+	referenceSettings.useLowDiscrepancySamples = false;
+	const std::vector<glm::vec4> reference = renderReference(shadows.scene, shadows.camera, referenceSettings);
+
+	constexpr uint32_t maxPasses = 256;
+	constexpr std::array<float, 3> targetRmses = { 0.1f, 0.07f, 0.05f };
+
+	// no threshold is the uniform accumulation
+	for (const float threshold : { 0.0f, 0.1f, 0.05f }) {
+		ReferencePathTracer::Settings settings;
+		settings.useAdaptiveSampling = threshold > 0.0f;
+		settings.convergenceThreshold = threshold;
+
+		ReferencePathTracer pathTracer(settings);
+		pathTracer.resize(IMAGE_SIZE, IMAGE_SIZE);
+
+		std::vector<glm::vec4> image;
+		std::string line = settings.useAdaptiveSampling ? std::format("adaptive, threshold {}:", threshold) : "uniform:";
+		size_t nextTarget = 0;
+		double seconds = 0.0;
+		uint64_t tracedSamples = 0;
+		ReferencePathTracer::PassStats stats;
+
+		for (uint32_t pass = 0; pass < maxPasses; pass++) {
+			stats = pathTracer.render(shadows.scene, shadows.camera, pass);
+			seconds += stats.seconds;
+			tracedSamples += stats.tracedSamples;
+
+			pathTracer.resolve(image);
+			const float rmse = ReferenceDenoiser::computeRmse(image, reference);
+			const double averageSamples = static_cast<double>(tracedSamples) / (IMAGE_SIZE * IMAGE_SIZE);
+
+			for (; nextTarget < targetRmses.size() && rmse <= targetRmses[nextTarget]; nextTarget++) {
+				line += std::format(" RMSE {} in {:.0f} ms ({:.0f} spp),", targetRmses[nextTarget], seconds * 1e3, averageSamples);
+			}
+
+			if (stats.activePixelCount == 0) {
+				line += std::format(" converged in {:.0f} ms ({:.0f} spp) at RMSE {:.4f},", seconds * 1e3, averageSamples, rmse);
+				break;
+			}
+		}
+
+		for (; nextTarget < targetRmses.size(); nextTarget++) {
+			line += std::format(" RMSE {} not reached,", targetRmses[nextTarget]);
+		}
+		if (stats.activePixelCount != 0) {
+			line += std::format(" {} pixels still sampled after {} passes,", stats.activePixelCount, maxPasses);
+		}
+
+		line.pop_back();
+		Tests::report(line);
+	}
+}
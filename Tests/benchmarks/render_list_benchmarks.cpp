@@ -0,0 +1,271 @@
+#include "test_framework.hpp"
+
+#include "core/jobs/job_system.hpp"
+#include "scene/scene.hpp"
+#include "scene/ecs/entity.hpp"
+#include "scene/ecs/component.hpp"
+#include "scene/spatial/aabb.hpp"
+#include "utils/radix_sort.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	/**
+	 * @brief Builds the sort keys of RenderList::build: the geometry handle of the mesh above the walk index.
+	 */
+	void buildSortKeys(const std::vector<uint32_t>& meshHandles, std::vector<uint64_t>& keys) {
+		keys.clear();
+		for (uint32_t walkIndex = 0; walkIndex < meshHandles.size(); walkIndex++) {
+			keys.push_back(static_cast<uint64_t>(meshHandles[walkIndex]) << 32 | walkIndex);
+		}
+	}
+
+	/**
+	 * @brief Counts the instanced draws of sorted keys, one per run of the same mesh.
+	 */
+	uint32_t countBatches(const std::vector<uint64_t>& keys) {
+		uint32_t batchCount = 0;
+		for (size_t i = 0; i < keys.size(); i++) {
+			batchCount += i == 0 || keys[i] >> 32 != keys[i - 1] >> 32 ? 1 : 0;
+		}
+		return batchCount;
+	}
+
+	// the walks of the scene before the render list: the material, debug and TLAS passes, then a cube face each
+	constexpr uint32_t SHADOW_FACE_COUNT = 6;
+	constexpr uint32_t MESH_COUNT = 3;
+
+	/**
+	 * @brief The per instance outputs of the render systems: the material instance data, the debug and shadow
+	 *        model matrices and the TLAS instance transforms, row major 3x4 as VkTransformMatrixKHR.
+	 */
+	struct ConsumerOutputs {
+		struct MaterialInstance {
+			glm::mat4 modelMatrix;
+			glm::mat4 normalMatrix;
+		};
+
+		std::vector<MaterialInstance> materialInstances;
+		std::vector<glm::mat4> debugMatrices;
+		std::vector<std::array<float, 12>> tlasTransforms;
+		std::vector<glm::mat4> shadowMatrices;
+
+		void resize(const size_t count) {
+			materialInstances.resize(count);
+			debugMatrices.resize(count);
+			tlasTransforms.resize(count);
+			shadowMatrices.resize(count * SHADOW_FACE_COUNT);
+		}
+	};
+
+	void writeTlasTransform(const glm::mat4& matrix, std::array<float, 12>& transform) {
+		for (uint32_t row = 0; row < 3; row++) {
+			for (uint32_t column = 0; column < 4; column++) {
+				transform[row * 4 + column] = matrix[column][row];
+			}
+		}
+	}
+
+	/**
+	 * @brief The render systems before the render list: every walk of the scene recomputes the transforms.
+	 */
+	void renderWithSceneWalks(Scene& scene, ConsumerOutputs& outputs) {
+		auto view = scene.getEntitiesWith<TransformComponent, MeshComponent>();
+
+		uint32_t instance = 0;
+		for (auto entity : view) {
+			TransformComponent& transform = view.get<TransformComponent>(entity);
+			outputs.materialInstances[instance++] = { transform.mat4(), glm::mat4(transform.normalMatrix()) };
+		}
+
+		instance = 0;
+		for (auto entity : view) {
+			outputs.debugMatrices[instance++] = view.get<TransformComponent>(entity).mat4();
+		}
+
+		instance = 0;
+		for (auto entity : view) {
+			writeTlasTransform(view.get<TransformComponent>(entity).mat4(), outputs.tlasTransforms[instance++]);
+		}
+
+		instance = 0;
+		for (uint32_t face = 0; face < SHADOW_FACE_COUNT; face++) {
+			for (auto entity : view) {
+				outputs.shadowMatrices[instance++] = view.get<TransformComponent>(entity).mat4();
+			}
+		}
+	}
+
+	/**
+	 * @brief The CPU side of RenderList::build, without the meshes and the materials of the GPU.
+	 */
+	class PackedRenderList {
+	public:
+		void build(Scene& scene) {
+			m_sortKeys.clear();
+			m_walk.clear();
+
+			auto view = scene.getEntitiesWith<WorldTransformComponent, MeshComponent>();
+			for (auto entity : view) {
+				const uint64_t meshHandle = entt::to_integral(entity) % MESH_COUNT;
+				m_sortKeys.push_back(meshHandle << 32 | m_walk.size());
+				m_walk.push_back(&view.get<WorldTransformComponent>(entity));
+			}
+			radixSort(m_sortKeys, m_sortScratch, 32);
+
+			const size_t count = m_sortKeys.size();
+			m_worldMatrices.resize(count);
+			m_normalMatrices.resize(count);
+			m_worldBounds.resize(count);
+
+			JobSystem::parallelFor(count, 1024, [&](const size_t begin, const size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					const WorldTransformComponent& transform = *m_walk[static_cast<uint32_t>(m_sortKeys[i])];
+					m_worldMatrices[i] = transform.matrix;
+					m_normalMatrices[i] = glm::mat4(transform.normalMatrix);
+					m_worldBounds[i] = m_localBounds.transformed(transform.matrix);
+				}
+			});
+		}
+
+		/**
+		 * @brief The render systems reading the list: the shadow pass draws every face from the same instances.
+		 */
+		void render(ConsumerOutputs& outputs) const {
+			const size_t count = m_worldMatrices.size();
+			for (size_t i = 0; i < count; i++) {
+				outputs.materialInstances[i] = { m_worldMatrices[i], m_normalMatrices[i] };
+			}
+			std::copy(m_worldMatrices.begin(), m_worldMatrices.end(), outputs.debugMatrices.begin());
+			for (size_t i = 0; i < count; i++) {
+				writeTlasTransform(m_worldMatrices[i], outputs.tlasTransforms[i]);
+			}
+			std::copy(m_worldMatrices.begin(), m_worldMatrices.end(), outputs.shadowMatrices.begin());
+		}
+
+	private:
+		Aabb m_localBounds{ glm::vec3(-1.0f), glm::vec3(1.0f) };
+
+		std::vector<uint64_t> m_sortKeys;
+		std::vector<uint64_t> m_sortScratch;
+		std::vector<const WorldTransformComponent*> m_walk;
+
+		std::vector<glm::mat4> m_worldMatrices;
+		std::vector<glm::mat4> m_normalMatrices;
+		std::vector<Aabb> m_worldBounds;
+	};
+}
+
+PXT_BENCHMARK(renderListGroupingByMesh) {
+	for (const uint32_t entityCount : { 1000u, 10000u, 100000u }) {
+		for (const uint32_t meshCount : { 3u, 64u }) {
+			// the props cycle through the meshes as in the stress grid, every group is spread over the whole walk
+			std::vector<uint32_t> meshHandles(entityCount);
+			for (uint32_t i = 0; i < entityCount; i++) {
+				meshHandles[i] = i % meshCount;
+			}
+
+			std::vector<uint64_t> keys;
+			std::vector<uint64_t> scratch;
+			uint32_t batchCount = 0;
+
+			// only the mesh is sorted, the walk index below it is already in order
+			const double radixSeconds = Tests::measureSeconds(20, [&] {
+				buildSortKeys(meshHandles, keys);
+				radixSort(keys, scratch, 32);
+				batchCount = countBatches(keys);
+			});
+			const std::vector<uint64_t> radixKeys = keys;
+
+			const double sortSeconds = Tests::measureSeconds(20, [&] {
+				buildSortKeys(meshHandles, keys);
+				std::sort(keys.begin(), keys.end());
+				PXT_CHECK_EQ(countBatches(keys), batchCount);
+			});
+			PXT_CHECK(keys == radixKeys);
+
+			// a list of walk indices per mesh, rebuilt every frame
+			std::map<uint32_t, std::vector<uint32_t>> groups;
+			std::vector<uint32_t> order;
+			const double mapSeconds = Tests::measureSeconds(20, [&] {
+				groups.clear();
+				for (uint32_t walkIndex = 0; walkIndex < entityCount; walkIndex++) {
+					groups[meshHandles[walkIndex]].push_back(walkIndex);
+				}
+
+				order.clear();
+				for (const auto& [meshHandle, walkIndices] : groups) {
+					order.insert(order.end(), walkIndices.begin(), walkIndices.end());
+				}
+				PXT_CHECK_EQ(static_cast<uint32_t>(groups.size()), batchCount);
+			});
+			for (size_t i = 0; i < order.size(); i++) {
+				PXT_CHECK_EQ(order[i], static_cast<uint32_t>(radixKeys[i]));
+			}
+
+			Tests::report(std::format("{} props, {} meshes: {} draws instead of {}, radix sort {:.3f} ms, "
+				"std::sort {:.3f} ms, std::map {:.3f} ms",
+				entityCount, meshCount, batchCount, entityCount, radixSeconds * 1e3, sortSeconds * 1e3, mapSeconds * 1e3));
+		}
+	}
+}
+
+PXT_BENCHMARK(renderExtractionBeforeAfter) {
+	for (const uint32_t entityCount : { 10000u, 50000u }) {
+		Scene scene;
+		std::vector<Entity> entities;
+		for (uint32_t i = 0; i < entityCount; i++) {
+			Entity entity = scene.createEntity();
+			entity.add<TransformComponent>(glm::vec3(static_cast<float>(i), 0.0f, 0.0f), glm::vec3(1.0f), glm::vec3(0.1f * i));
+			entity.add<MeshComponent>();
+			entities.push_back(entity);
+		}
+		scene.updateWorldTransforms();
+
+		ConsumerOutputs outputs;
+		outputs.resize(entityCount);
+
+		const double walksSeconds = Tests::measureSeconds(10, [&] {
+			renderWithSceneWalks(scene, outputs);
+		});
+
+		PackedRenderList renderList;
+		double updateSeconds = 0.0;
+		double extractionSeconds = 0.0;
+		double consumersSeconds = 0.0;
+
+		// nothing moves: the world transforms are only compared
+		const double staticSeconds = Tests::measureSeconds(10, [&] {
+			const auto start = std::chrono::steady_clock::now();
+			scene.updateWorldTransforms();
+			const auto updated = std::chrono::steady_clock::now();
+			renderList.build(scene);
+			const auto extracted = std::chrono::steady_clock::now();
+			renderList.render(outputs);
+
+			updateSeconds += std::chrono::duration<double>(updated - start).count();
+			extractionSeconds += std::chrono::duration<double>(extracted - updated).count();
+			consumersSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - extracted).count();
+		});
+
+		// every entity moves, the world transforms are recomputed too
+		float offset = 0.0f;
+		const double movingSeconds = Tests::measureSeconds(10, [&] {
+			offset += 1.0f;
+			for (Entity& entity : entities) {
+				entity.get<TransformComponent>().translation.y = offset;
+			}
+			scene.updateWorldTransforms();
+			renderList.build(scene);
+			renderList.render(outputs);
+		});
+
+		// one warm-up and ten measured runs were summed
+		constexpr double runCount = 11.0;
+		Tests::report(std::format("{} entities: {} scene walks {:.3f} ms, render list static {:.3f} ms "
+			"(world transforms {:.3f} ms, extraction {:.3f} ms, consumers {:.3f} ms), all moving {:.3f} ms",
+			entityCount, 3 + SHADOW_FACE_COUNT, walksSeconds * 1e3, staticSeconds * 1e3, updateSeconds / runCount * 1e3,
+			extractionSeconds / runCount * 1e3, consumersSeconds / runCount * 1e3, movingSeconds * 1e3));
+	}
+}
@@ -0,0 +1,113 @@
+#include "test_framework.hpp"
+
+#include "resources/resource_manager.hpp"
+#include "resources/importers/resource_importer.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	class FakeResource : public Resource {
+	public:
+		Type getType() const override { return Type::Mesh; }
+	};
+
+	/**
+	 * @brief The registry of ResourceManager before the shards: an alias map and a resource map,
+	 *        a single mutex around both when shared by several threads.
+	 */
+	class SingleMapRegistry {
+	public:
+		void add(const Shared<Resource>& resource, const std::string& alias) {
+			m_resources[resource->id] = resource;
+			m_aliases[alias] = resource->id;
+		}
+
+		Shared<Resource> find(const std::string& alias) const {
+			const auto aliasIt = m_aliases.find(alias);
+			const ResourceId id = aliasIt != m_aliases.end() ? aliasIt->second : ResourceId(alias);
+
+			const auto it = m_resources.find(id);
+			return it != m_resources.end() ? it->second : nullptr;
+		}
+
+		Shared<Resource> findLocked(const std::string& alias) const {
+			std::lock_guard lock(m_mutex);
+			return find(alias);
+		}
+
+	private:
+		std::unordered_map<ResourceId, Shared<Resource>> m_resources;
+		std::unordered_map<std::string, ResourceId> m_aliases;
+		mutable std::mutex m_mutex;
+	};
+
+	/**
+	 * @brief Runs lookup(alias) lookupsPerThread times on every thread, returns the lookups per second.
+	 */
+	template <typename Lookup>
+	double measureLookups(const uint32_t threadCount, const std::vector<std::string>& aliases,
+		const uint32_t lookupsPerThread, Lookup&& lookup) {
+		std::atomic<uint32_t> misses = 0;
+
+		const double seconds = Tests::measureSeconds(3, [&] {
+			std::vector<std::thread> threads;
+			for (uint32_t t = 0; t < threadCount; t++) {
+				threads.emplace_back([&, t] {
+					std::mt19937 random(t);
+					uint32_t threadMisses = 0;
+					for (uint32_t i = 0; i < lookupsPerThread; i++) {
+						threadMisses += lookup(aliases[random() % aliases.size()]) ? 0 : 1;
+					}
+					misses += threadMisses;
+				});
+			}
+			for (std::thread& thread : threads) {
+				thread.join();
+			}
+		});
+
+		PXT_CHECK_EQ(misses.load(), 0u);
+		return static_cast<double>(threadCount) * lookupsPerThread / seconds;
+	}
+}
+
+namespace PXTEngine {
+
+	// every alias of the benchmark is added up front, no import runs
+	ResourceFinalizer ResourceImporter::load(const std::filesystem::path& filePath, ResourceInfo* resourceInfo) {
+		throw std::runtime_error("Unexpected import: " + filePath.string());
+	}
+}
+
+PXT_BENCHMARK(resourceManagerLookupThroughput) {
+	// the aliases of a large scene: file paths of meshes, textures and materials
+	constexpr uint32_t resourceCount = 4096;
+	constexpr uint32_t lookupsPerThread = 200000;
+
+	ResourceManager manager;
+	SingleMapRegistry registry;
+	std::vector<std::string> aliases;
+
+	for (uint32_t i = 0; i < resourceCount; i++) {
+		aliases.push_back(std::format("assets/textures/material_{}/albedo_{}.png", i / 4, i % 4));
+
+		const Shared<Resource> resource = createShared<FakeResource>();
+		manager.add(resource, aliases.back());
+		registry.add(resource, aliases.back());
+	}
+
+	const double singleThreaded = measureLookups(1, aliases, lookupsPerThread,
+		[&](const std::string& alias) { return registry.find(alias) != nullptr; });
+	Tests::report(std::format("single map, no lock, 1 thread: {:.2f} M lookups/s", singleThreaded * 1e-6));
+
+	for (const uint32_t threadCount : { 1u, 2u, 4u, 8u }) {
+		const double locked = measureLookups(threadCount, aliases, lookupsPerThread,
+			[&](const std::string& alias) { return registry.findLocked(alias) != nullptr; });
+		const double sharded = measureLookups(threadCount, aliases, lookupsPerThread,
+			[&](const std::string& alias) { return manager.get(alias) != nullptr; });
+
+		Tests::report(std::format("{} threads: single map under a mutex {:.2f} M lookups/s, sharded ResourceManager {:.2f} M lookups/s",
+			threadCount, locked * 1e-6, sharded * 1e-6));
+	}
+}
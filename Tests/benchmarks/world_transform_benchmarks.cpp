@@ -0,0 +1,82 @@
+#include "test_framework.hpp"
+
+#include "scene/scene.hpp"
+#include "scene/ecs/entity.hpp"
+#include "scene/ecs/component.hpp"
+#include "scene/ecs/world_transform_system.hpp"
+#include "scene/spatial/simd.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	const char* getSimdBackendName() {
+#if defined(PXT_SIMD_AVX2)
+		return "AVX2";
+#elif defined(PXT_SIMD_SSE)
+		return "SSE2";
+#else
+		return "scalar";
+#endif
+	}
+
+	std::vector<Entity> createMovingEntities(Scene& scene, const uint32_t count) {
+		std::vector<Entity> entities;
+		entities.reserve(count);
+
+		for (uint32_t i = 0; i < count; i++) {
+			Entity entity = scene.createEntity();
+			entity.add<TransformComponent>(glm::vec3(static_cast<float>(i), 0.0f, 0.0f), glm::vec3(1.0f), glm::vec3(0.1f * i));
+			entities.push_back(entity);
+		}
+		return entities;
+	}
+}
+
+PXT_BENCHMARK(worldTransformKernelThroughput) {
+	constexpr uint32_t count = 1 << 16;
+
+	WorldTransformSystem::TransformBatch batch;
+	batch.resize(count);
+	for (uint32_t i = 0; i < count; i++) {
+		batch.set(i, glm::vec3(static_cast<float>(i)), glm::vec3(0.001f * i), glm::vec3(1.0f + 0.001f * i));
+	}
+
+	std::vector<WorldTransformComponent> worldTransforms(count);
+	std::vector<WorldTransformComponent*> outputs;
+	for (WorldTransformComponent& worldTransform : worldTransforms) {
+		outputs.push_back(&worldTransform);
+	}
+
+	const double seconds = Tests::measureSeconds(20, [&] {
+		WorldTransformSystem::computeWorldTransforms(batch, 0, count, outputs);
+	});
+
+	Tests::report(std::format("{} kernel, one thread: {:.1f} M transforms/s", getSimdBackendName(), count / seconds * 1e-6));
+}
+
+PXT_BENCHMARK(worldTransformUpdateThroughput) {
+	for (const uint32_t count : { 1000u, 10000u, 100000u }) {
+		Scene scene;
+		std::vector<Entity> entities = createMovingEntities(scene, count);
+		scene.updateWorldTransforms();
+
+		// every entity moves each update, written in place like the scripts do
+		float offset = 0.0f;
+		const double movingSeconds = Tests::measureSeconds(20, [&] {
+			offset += 1.0f;
+			for (Entity& entity : entities) {
+				entity.get<TransformComponent>().translation.y = offset;
+			}
+			scene.updateWorldTransforms();
+		});
+
+		// nothing moves, only the comparisons are left
+		const double staticSeconds = Tests::measureSeconds(20, [&] {
+			scene.updateWorldTransforms();
+		});
+
+		Tests::report(std::format("{} entities: all moving {:.3f} ms ({:.1f} M transforms/s), static {:.3f} ms",
+			count, movingSeconds * 1e3, count / movingSeconds * 1e-6, staticSeconds * 1e3));
+	}
+}
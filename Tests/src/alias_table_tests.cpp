@@ -0,0 +1,192 @@
+#include "test_framework.hpp"
+
+#include "graphics/resources/alias_table.hpp"
+#include "graphics/resources/emitter_tables.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	/**
+	 * @brief The exact probability of every element: kept by its own entry, or reached as the alias of another one.
+	 */
+	std::vector<double> getSamplingProbabilities(const std::vector<AliasTableEntry>& table) {
+		std::vector<double> probabilities(table.size(), 0.0);
+		for (uint32_t i = 0; i < table.size(); i++) {
+			const double probability = std::clamp(static_cast<double>(table[i].probability), 0.0, 1.0);
+			probabilities[i] += probability / table.size();
+			probabilities[table[i].alias] += (1.0 - probability) / table.size();
+		}
+		return probabilities;
+	}
+
+	std::vector<AliasTableEntry> buildTable(const std::vector<float>& weights) {
+		std::vector<AliasTableEntry> table(weights.size());
+		buildAliasTable(weights, table);
+		return table;
+	}
+
+	/**
+	 * @brief Checks that the table samples the weights and that every pdf matches its weight.
+	 */
+	void checkDistribution(const std::vector<float>& weights) {
+		const std::vector<AliasTableEntry> table = buildTable(weights);
+		const double totalWeight = std::accumulate(weights.begin(), weights.end(), 0.0);
+		const std::vector<double> probabilities = getSamplingProbabilities(table);
+
+		for (uint32_t i = 0; i < weights.size(); i++) {
+			PXT_CHECK(table[i].alias < weights.size());
+			PXT_CHECK_NEAR(probabilities[i], weights[i] / totalWeight, 1e-6);
+			PXT_CHECK_NEAR(static_cast<double>(table[i].pdf), weights[i] / totalWeight, 1e-6);
+		}
+	}
+
+	/**
+	 * @brief Samples a table like the shaders do and checks every frequency against its pdf, 5 standard deviations wide.
+	 */
+	void checkSampledFrequencies(const std::vector<AliasTableEntry>& table, const uint32_t sampleCount, const uint32_t seed) {
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> coin(0.0f, 1.0f);
+
+		std::vector<uint32_t> counts(table.size(), 0);
+		for (uint32_t sample = 0; sample < sampleCount; sample++) {
+			const uint32_t index = random() % table.size();
+			counts[sampleAliasTable(table, index, coin(random))]++;
+		}
+
+		for (uint32_t i = 0; i < table.size(); i++) {
+			const double pdf = table[i].pdf;
+			const double deviation = std::sqrt(pdf * (1.0 - pdf) / sampleCount);
+			PXT_CHECK_NEAR(static_cast<double>(counts[i]) / sampleCount, pdf, 5.0 * deviation + 1e-9);
+		}
+	}
+
+	std::vector<glm::vec3> getFaceAreaVectors(const std::vector<glm::vec3>& positions) {
+		std::vector<Mesh::Vertex> vertices(positions.size());
+		for (size_t i = 0; i < positions.size(); i++) {
+			vertices[i].position = glm::vec4(positions[i], 1.0f);
+		}
+
+		std::vector<glm::vec3> areaVectors;
+		EmitterTableBuilder::calculateFaceAreaVectors(vertices, {}, areaVectors);
+		return areaVectors;
+	}
+}
+
+PXT_TEST(aliasTableMatchesTheWeights) {
+	checkDistribution({ 1.0f });
+	checkDistribution({ 1.0f, 1.0f, 1.0f, 1.0f });
+	checkDistribution({ 1.0f, 2.0f, 3.0f, 4.0f });
+	// one element carrying almost everything, and zero weights that are never sampled
+	checkDistribution({ 1000.0f, 0.001f, 0.0f, 1.0f, 0.0f });
+
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> weight(0.0f, 10.0f);
+	for (const uint32_t count : { 7u, 64u, 1000u }) {
+		std::vector<float> weights(count);
+		for (float& value : weights) {
+			value = random() % 4 == 0 ? 0.0f : weight(random);
+		}
+		checkDistribution(weights);
+	}
+
+	const std::vector<AliasTableEntry> table = buildTable({ 5.0f, 0.0f, 3.0f, 0.0f });
+	for (const uint32_t zero : { 1u, 3u }) {
+		PXT_CHECK_EQ(table[zero].pdf, 0.0f);
+		PXT_CHECK_EQ(table[zero].probability, 0.0f);
+		PXT_CHECK(table[zero].alias != zero);
+	}
+}
+
+PXT_TEST(aliasTableIsUniformWithoutWeight) {
+	const std::vector<AliasTableEntry> table = buildTable({ 0.0f, 0.0f, 0.0f });
+	for (uint32_t i = 0; i < table.size(); i++) {
+		PXT_CHECK_EQ(sampleAliasTable(table, i, 0.99f), i);
+		PXT_CHECK_NEAR(table[i].pdf, 1.0f / 3.0f, 1e-7f);
+	}
+
+	// an empty table is left alone
+	buildAliasTable({}, {});
+}
+
+PXT_TEST(aliasTableSamplingConverges) {
+	// the skewed weights of emitter powers: a few bright faces among many dim ones
+	std::vector<float> weights(50);
+	for (uint32_t i = 0; i < weights.size(); i++) {
+		weights[i] = i % 10 == 0 ? 100.0f : 1.0f + i * 0.1f;
+	}
+	checkSampledFrequencies(buildTable(weights), 2'000'000, 1);
+
+	checkSampledFrequencies(buildTable({ 1.0f, 0.0f, 2.0f, 0.5f }), 1'000'000, 2);
+}
+
+PXT_TEST(emitterTablesWeightFacesByWorldAreaAndRadiance) {
+	// a unit right triangle in the xy plane and one twice as big, area 0.5 and 2
+	const std::vector<glm::vec3> quadAreas = getFaceAreaVectors({
+		{ 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 },
+		{ 0, 0, 0 }, { 2, 0, 0 }, { 0, 2, 0 } });
+	PXT_CHECK_NEAR(glm::length(quadAreas[0]), 1.0f, 1e-6f);
+	PXT_CHECK_NEAR(glm::length(quadAreas[1]), 4.0f, 1e-6f);
+
+	// a non uniform scale stretching only the first face direction, and a rotation that must not change the areas
+	const glm::mat4 stretched = glm::scale(glm::mat4(1.0f), glm::vec3(3.0f, 1.0f, 5.0f));
+	const glm::mat4 rotated = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(4.0f, -2.0f, 1.0f)), 1.1f, glm::vec3(0.0f, 1.0f, 0.0f));
+
+	EmitterTableBuilder builder;
+	builder.addEmitter(7, quadAreas, stretched, glm::vec4(1.0f, 1.0f, 1.0f, 2.0f)); // areas 1.5 and 6, radiance 2
+	builder.addEmitter(3, quadAreas, rotated, glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));   // areas 0.5 and 2, radiance 0.2126
+	builder.build();
+
+	const std::vector<EmitterData>& emitters = builder.getEmitters();
+	const std::vector<AliasTableEntry>& faceTable = builder.getFaceTable();
+	PXT_CHECK_EQ(emitters.size(), size_t{ 2 });
+	PXT_CHECK_EQ(faceTable.size(), size_t{ 4 });
+
+	PXT_CHECK_EQ(emitters[0].instanceIndex, 7u);
+	PXT_CHECK_EQ(emitters[1].instanceIndex, 3u);
+	PXT_CHECK_EQ(emitters[1].faceTableOffset, 2u);
+	PXT_CHECK_EQ(emitters[1].numberOfFaces, 2u);
+
+	// the selection pdf of a face, as the shaders compute it, is its share of the total power
+	const std::array<double, 4> powers = { 1.5 * 2.0, 6.0 * 2.0, 0.5 * 0.2126, 2.0 * 0.2126 };
+	const double totalPower = powers[0] + powers[1] + powers[2] + powers[3];
+
+	double pdfSum = 0.0;
+	for (uint32_t emitter = 0; emitter < emitters.size(); emitter++) {
+		for (uint32_t face = 0; face < emitters[emitter].numberOfFaces; face++) {
+			const double selectionPdf = static_cast<double>(emitters[emitter].aliasEntry.pdf) *
+				faceTable[emitters[emitter].faceTableOffset + face].pdf;
+			PXT_CHECK_NEAR(selectionPdf, powers[emitter * 2 + face] / totalPower, 1e-5);
+			pdfSum += selectionPdf;
+		}
+	}
+	PXT_CHECK_NEAR(pdfSum, 1.0, 1e-5);
+
+	// sampling the emitter table then the face table of the picked emitter, like the closest hit shader
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> coin(0.0f, 1.0f);
+	std::vector<AliasTableEntry> emitterTable;
+	for (const EmitterData& emitter : emitters) {
+		emitterTable.push_back(emitter.aliasEntry);
+	}
+
+	constexpr uint32_t sampleCount = 1'000'000;
+	std::array<uint32_t, 4> counts{};
+	for (uint32_t sample = 0; sample < sampleCount; sample++) {
+		const uint32_t emitter = sampleAliasTable(emitterTable, random() % emitters.size(), coin(random));
+		const std::span<const AliasTableEntry> faces =
+			std::span(faceTable).subspan(emitters[emitter].faceTableOffset, emitters[emitter].numberOfFaces);
+		counts[emitter * 2 + sampleAliasTable(faces, random() % faces.size(), coin(random))]++;
+	}
+
+	for (uint32_t i = 0; i < counts.size(); i++) {
+		const double pdf = powers[i] / totalPower;
+		PXT_CHECK_NEAR(static_cast<double>(counts[i]) / sampleCount, pdf, 5.0 * std::sqrt(pdf * (1.0 - pdf) / sampleCount));
+	}
+
+	// clear keeps nothing from the previous scene
+	builder.clear();
+	builder.build();
+	PXT_CHECK(builder.getEmitters().empty());
+	PXT_CHECK(builder.getFaceTable().empty());
+}
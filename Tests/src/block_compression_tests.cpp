@@ -0,0 +1,278 @@
+#include "test_framework.hpp"
+
+#include "resources/importers/block_compression.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	struct TestImage {
+		uint32_t width;
+		uint32_t height;
+		std::vector<uint8_t> rgba;
+	};
+
+	uint8_t toByte(const float value) {
+		return static_cast<uint8_t>(std::clamp(std::lround(value * 255.0f), 0l, 255l));
+	}
+
+	/**
+	 * @brief Smooth color and alpha gradients, the content of most albedo maps at the block scale.
+	 */
+	TestImage makeGradient(const uint32_t width, const uint32_t height) {
+		TestImage image{ width, height, std::vector<uint8_t>(static_cast<size_t>(width) * height * 4) };
+
+		for (uint32_t y = 0; y < height; y++) {
+			for (uint32_t x = 0; x < width; x++) {
+				const float u = static_cast<float>(x) / width;
+				const float v = static_cast<float>(y) / height;
+				uint8_t* texel = &image.rgba[(static_cast<size_t>(y) * width + x) * 4];
+
+				texel[0] = toByte(u);
+				texel[1] = toByte(v);
+				texel[2] = toByte(0.5f + 0.5f * std::sin(6.0f * u + 4.0f * v));
+				texel[3] = toByte(1.0f - 0.5f * u * v);
+			}
+		}
+		return image;
+	}
+
+	/**
+	 * @brief Grayscale opaque noise over a gradient, like roughness maps.
+	 */
+	TestImage makeGrayscale(const uint32_t width, const uint32_t height) {
+		TestImage image{ width, height, std::vector<uint8_t>(static_cast<size_t>(width) * height * 4) };
+		std::mt19937 random(7);
+		std::uniform_int_distribution<int32_t> noise(-12, 12);
+
+		for (uint32_t y = 0; y < height; y++) {
+			for (uint32_t x = 0; x < width; x++) {
+				const int32_t value = std::clamp(static_cast<int32_t>(255 * x / width) + noise(random), 0, 255);
+				uint8_t* texel = &image.rgba[(static_cast<size_t>(y) * width + x) * 4];
+
+				texel[0] = texel[1] = texel[2] = static_cast<uint8_t>(value);
+				texel[3] = 255;
+			}
+		}
+		return image;
+	}
+
+	/**
+	 * @brief Tangent space normals of a field of bumps, encoded in [0, 255].
+	 */
+	TestImage makeNormalMap(const uint32_t width, const uint32_t height) {
+		TestImage image{ width, height, std::vector<uint8_t>(static_cast<size_t>(width) * height * 4) };
+
+		for (uint32_t y = 0; y < height; y++) {
+			for (uint32_t x = 0; x < width; x++) {
+				const float u = 8.0f * x / width;
+				const float v = 8.0f * y / height;
+				const glm::vec3 normal = glm::normalize(glm::vec3(0.6f * std::cos(u) * std::sin(v), 0.6f * std::sin(u) * std::cos(v), 1.0f));
+				uint8_t* texel = &image.rgba[(static_cast<size_t>(y) * width + x) * 4];
+
+				texel[0] = toByte(normal.x * 0.5f + 0.5f);
+				texel[1] = toByte(normal.y * 0.5f + 0.5f);
+				texel[2] = toByte(normal.z * 0.5f + 0.5f);
+				texel[3] = 255;
+			}
+		}
+		return image;
+	}
+
+	std::vector<uint8_t> roundTrip(const TestImage& image, const ImageFormat format) {
+		std::vector<uint8_t> blocks(getImageLevelSize(format, image.width, image.height));
+		BlockCompression::compress(image.rgba.data(), image.width, image.height, format, blocks.data());
+
+		std::vector<uint8_t> decoded(image.rgba.size());
+		BlockCompression::decompress(blocks.data(), image.width, image.height, format, decoded.data());
+		return decoded;
+	}
+
+	/**
+	 * @brief Peak signal to noise ratio of the first channelCount channels, in dB.
+	 */
+	double computePsnr(const std::vector<uint8_t>& reference, const std::vector<uint8_t>& decoded, const uint32_t channelCount) {
+		double squaredError = 0.0;
+		for (size_t i = 0; i < reference.size(); i += 4) {
+			for (uint32_t c = 0; c < channelCount; c++) {
+				const double difference = static_cast<double>(reference[i + c]) - decoded[i + c];
+				squaredError += difference * difference;
+			}
+		}
+
+		const double meanSquaredError = squaredError / (reference.size() / 4 * channelCount);
+		if (meanSquaredError == 0.0) {
+			return std::numeric_limits<double>::infinity();
+		}
+		return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+	}
+}
+
+PXT_TEST(blockCompressionBC7GradientPsnr) {
+	const TestImage image = makeGradient(128, 128);
+	const std::vector<uint8_t> decoded = roundTrip(image, BC7_LINEAR);
+
+	const double psnr = computePsnr(image.rgba, decoded, 4);
+	Tests::report(std::format("BC7 gradient RGBA PSNR {:.2f} dB", psnr));
+	PXT_CHECK(psnr >= 40.0);
+}
+
+PXT_TEST(blockCompressionBC4GrayscalePsnr) {
+	const TestImage image = makeGrayscale(128, 128);
+	const std::vector<uint8_t> decoded = roundTrip(image, BC4_LINEAR);
+
+	const double psnr = computePsnr(image.rgba, decoded, 1);
+	Tests::report(std::format("BC4 grayscale PSNR {:.2f} dB", psnr));
+	PXT_CHECK(psnr >= 35.0);
+
+	// the GPU reads BC4 as (r, 0, 0, 1)
+	PXT_CHECK_EQ(decoded[1], uint8_t{ 0 });
+	PXT_CHECK_EQ(decoded[3], uint8_t{ 255 });
+}
+
+PXT_TEST(blockCompressionBC5NormalMapPsnr) {
+	const TestImage image = makeNormalMap(128, 128);
+	const std::vector<uint8_t> decoded = roundTrip(image, BC5_LINEAR);
+
+	const double psnr = computePsnr(image.rgba, decoded, 2);
+
+	// the shaders rebuild z from x and y
+	double maxAngle = 0.0;
+	for (size_t i = 0; i < image.rgba.size(); i += 4) {
+		const glm::vec3 reference = glm::normalize(glm::vec3(image.rgba[i], image.rgba[i + 1], image.rgba[i + 2]) / 127.5f - 1.0f);
+
+		const glm::vec2 xy = glm::vec2(decoded[i], decoded[i + 1]) / 127.5f - 1.0f;
+		const glm::vec3 normal = glm::normalize(glm::vec3(xy.x, xy.y, std::sqrt(std::max(1.0f - glm::dot(xy, xy), 0.0f))));
+
+		maxAngle = std::max(maxAngle, static_cast<double>(std::acos(std::min(glm::dot(reference, normal), 1.0f))));
+	}
+
+	Tests::report(std::format("BC5 normal map xy PSNR {:.2f} dB, max normal error {:.2f} degrees", psnr, glm::degrees(maxAngle)));
+	PXT_CHECK(psnr >= 40.0);
+	PXT_CHECK(glm::degrees(maxAngle) <= 3.0);
+}
+
+PXT_TEST(blockCompressionEdgeBlocksCoverOddSizes) {
+	// 13x7 has partial blocks on the right and bottom edges, cropped from the gradient of the PSNR test
+	const TestImage gradient = makeGradient(128, 128);
+	TestImage image{ 13, 7 };
+	for (uint32_t y = 0; y < image.height; y++) {
+		const auto row = gradient.rgba.begin() + static_cast<ptrdiff_t>(y) * gradient.width * 4;
+		image.rgba.insert(image.rgba.end(), row, row + image.width * 4);
+	}
+
+	for (const ImageFormat format : { BC4_LINEAR, BC5_LINEAR, BC7_LINEAR }) {
+		std::vector<uint8_t> blocks(getImageLevelSize(format, image.width, image.height));
+		PXT_CHECK_EQ(blocks.size(), size_t{ 4 * 2 } * (format == BC4_LINEAR ? 8 : 16));
+		BlockCompression::compress(image.rgba.data(), image.width, image.height, format, blocks.data());
+
+		// the decoder doesn't write past the image
+		std::vector<uint8_t> decoded(image.rgba.size() + 4, 0xCD);
+		BlockCompression::decompress(blocks.data(), image.width, image.height, format, decoded.data());
+		PXT_CHECK(std::all_of(decoded.end() - 4, decoded.end(), [](const uint8_t value) { return value == 0xCD; }));
+
+		decoded.resize(image.rgba.size());
+		const uint32_t channelCount = format == BC4_LINEAR ? 1 : format == BC5_LINEAR ? 2 : 4;
+		PXT_CHECK(computePsnr(image.rgba, decoded, channelCount) >= 35.0);
+	}
+}
+
+PXT_TEST(blockCompressionBC4IsExactOnItsPalette) {
+	// the endpoints and the interpolated values are decoded exactly
+	std::array<uint8_t, 16> values{};
+	for (uint32_t t = 0; t < 16; t++) {
+		values[t] = t % 2 == 0 ? uint8_t{ 10 } : uint8_t{ 220 };
+	}
+	values[5] = static_cast<uint8_t>((4 * 220 + 3 * 10 + 3) / 7);
+
+	std::array<uint8_t, 8> block{};
+	BlockCompression::encodeBC4Block(values.data(), block.data());
+
+	std::array<uint8_t, 16> decoded{};
+	BlockCompression::decodeBC4Block(block.data(), decoded.data());
+	PXT_CHECK(decoded == values);
+
+	// a constant block
+	values.fill(77);
+	BlockCompression::encodeBC4Block(values.data(), block.data());
+	BlockCompression::decodeBC4Block(block.data(), decoded.data());
+	PXT_CHECK(decoded == values);
+}
+
+PXT_TEST(blockCompressionBC4DecodesTheSixValueMode) {
+	// red0 <= red1: indices 6 and 7 are 0 and 255, 2 to 5 interpolate in fifths
+	const uint64_t indices = 0 | (1ull << 3) | (6ull << 6) | (7ull << 9) | (2ull << 12) | (5ull << 15);
+	std::array<uint8_t, 8> block{ 50, 100 };
+	for (uint32_t i = 0; i < 6; i++) {
+		block[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+	}
+
+	std::array<uint8_t, 16> decoded{};
+	BlockCompression::decodeBC4Block(block.data(), decoded.data());
+
+	PXT_CHECK_EQ(decoded[0], uint8_t{ 50 });
+	PXT_CHECK_EQ(decoded[1], uint8_t{ 100 });
+	PXT_CHECK_EQ(decoded[2], uint8_t{ 0 });
+	PXT_CHECK_EQ(decoded[3], uint8_t{ 255 });
+	PXT_CHECK_EQ(decoded[4], uint8_t{ 60 });
+	PXT_CHECK_EQ(decoded[5], uint8_t{ 90 });
+}
+
+PXT_TEST(blockCompressionBC7ConstantBlocks) {
+	std::mt19937 random(3);
+	uint32_t maxError = 0;
+
+	for (uint32_t i = 0; i < 256; i++) {
+		std::array<uint8_t, 4> color{};
+		for (uint8_t& channel : color) channel = static_cast<uint8_t>(random());
+
+		std::array<uint8_t, 64> texels{};
+		for (uint32_t t = 0; t < 16; t++) std::memcpy(&texels[t * 4], color.data(), 4);
+
+		std::array<uint8_t, 16> block{};
+		BlockCompression::encodeBC7Block(texels.data(), block.data());
+
+		std::array<uint8_t, 64> decoded{};
+		BlockCompression::decodeBC7Block(block.data(), decoded.data());
+
+		for (uint32_t t = 0; t < 64; t++) {
+			maxError = std::max(maxError, static_cast<uint32_t>(std::abs(decoded[t] - texels[t])));
+		}
+	}
+
+	// the 7 bit endpoints with a p-bit shared by the channels can miss a value by one
+	PXT_CHECK(maxError <= 1u);
+}
+
+PXT_TEST(blockCompressionBC7DecoderRejectsOtherModes) {
+	std::array<uint8_t, 16> block{};
+	std::array<uint8_t, 64> decoded{};
+	block[0] = 1; // mode 0
+
+	bool thrown = false;
+	try {
+		BlockCompression::decodeBC7Block(block.data(), decoded.data());
+	} catch (const std::runtime_error&) {
+		thrown = true;
+	}
+	PXT_CHECK(thrown);
+}
+
+PXT_TEST(blockCompressionFormatFollowsTheUsage) {
+	const TestImage gray = makeGrayscale(8, 8);
+	const TestImage color = makeGradient(8, 8);
+	const size_t texelCount = 64;
+
+	ImageInfo linearInfo(8, 8, 4, RGBA8_LINEAR);
+	ImageInfo srgbInfo(8, 8, 4, RGBA8_SRGB);
+	ImageInfo normalInfo(8, 8, 4, RGBA8_LINEAR);
+	normalInfo.usage = NORMAL_MAP;
+
+	PXT_CHECK_EQ(BlockCompression::chooseFormat(gray.rgba.data(), texelCount, linearInfo), BC4_LINEAR);
+	PXT_CHECK_EQ(BlockCompression::chooseFormat(color.rgba.data(), texelCount, linearInfo), BC7_LINEAR);
+	PXT_CHECK_EQ(BlockCompression::chooseFormat(gray.rgba.data(), texelCount, srgbInfo), BC7_SRGB);
+
+	// the usage decides, not the name of the file or the content
+	PXT_CHECK_EQ(BlockCompression::chooseFormat(gray.rgba.data(), texelCount, normalInfo), BC5_LINEAR);
+	PXT_CHECK_EQ(BlockCompression::chooseFormat(color.rgba.data(), texelCount, normalInfo), BC5_LINEAR);
+}
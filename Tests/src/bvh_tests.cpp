@@ -0,0 +1,350 @@
+#include "test_framework.hpp"
+
+#include "scene/spatial/bvh.hpp"
+#include "scene/spatial/scene_bvh.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	struct Triangle {
+		glm::vec3 v0, v1, v2;
+	};
+
+	/**
+	 * @brief Random triangles of various sizes in a cube, with a few big ones crossing many BVH nodes.
+	 */
+	std::vector<Mesh::Vertex> makeTriangleSoup(const uint32_t triangleCount, const uint32_t seed) {
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+		std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+		std::vector<Mesh::Vertex> vertices(triangleCount * 3);
+		for (uint32_t i = 0; i < triangleCount; i++) {
+			const glm::vec3 center(position(random), position(random), position(random));
+			const float size = i % 50 == 0 ? 8.0f : 0.5f;
+
+			for (uint32_t corner = 0; corner < 3; corner++) {
+				const glm::vec3 vertex = center + size * glm::vec3(offset(random), offset(random), offset(random));
+				vertices[i * 3 + corner].position = glm::vec4(vertex, 1.0f);
+			}
+		}
+		return vertices;
+	}
+
+	std::vector<Triangle> getTriangles(const std::vector<Mesh::Vertex>& vertices, const glm::mat4& transform = glm::mat4(1.0f)) {
+		std::vector<Triangle> triangles(vertices.size() / 3);
+		for (size_t i = 0; i < triangles.size(); i++) {
+			triangles[i] = {
+				glm::vec3(transform * glm::vec4(glm::vec3(vertices[i * 3].position), 1.0f)),
+				glm::vec3(transform * glm::vec4(glm::vec3(vertices[i * 3 + 1].position), 1.0f)),
+				glm::vec3(transform * glm::vec4(glm::vec3(vertices[i * 3 + 2].position), 1.0f)) };
+		}
+		return triangles;
+	}
+
+	/**
+	 * @brief The Möller-Trumbore test of the traversal, in double precision.
+	 */
+	bool intersectTriangle(const Ray& ray, const Triangle& triangle, double& t, double& u, double& v) {
+		const glm::dvec3 origin(ray.origin), direction(ray.direction);
+		const glm::dvec3 v0(triangle.v0);
+		const glm::dvec3 edge1 = glm::dvec3(triangle.v1) - v0;
+		const glm::dvec3 edge2 = glm::dvec3(triangle.v2) - v0;
+
+		const glm::dvec3 p = glm::cross(direction, edge2);
+		const double determinant = glm::dot(edge1, p);
+		if (std::abs(determinant) < 1e-12) return false;
+
+		const glm::dvec3 s = origin - v0;
+		const glm::dvec3 q = glm::cross(s, edge1);
+		u = glm::dot(s, p) / determinant;
+		v = glm::dot(direction, q) / determinant;
+		t = glm::dot(edge2, q) / determinant;
+
+		return u >= 0.0 && v >= 0.0 && u + v <= 1.0 && t >= ray.tMin && t < ray.tMax;
+	}
+
+	struct BruteForceHit {
+		double t = std::numeric_limits<double>::infinity();
+		uint32_t primitiveIndex = INVALID_PRIMITIVE;
+		uint32_t instanceIndex = INVALID_PRIMITIVE;
+		// distance of the hit to the closest triangle edge, in barycentric units
+		double edgeDistance = std::numeric_limits<double>::infinity();
+	};
+
+	BruteForceHit intersectBruteForce(const Ray& ray, const std::vector<std::vector<Triangle>>& instances) {
+		BruteForceHit hit;
+		for (uint32_t instance = 0; instance < instances.size(); instance++) {
+			for (uint32_t i = 0; i < instances[instance].size(); i++) {
+				double t, u, v;
+				if (intersectTriangle(ray, instances[instance][i], t, u, v) && t < hit.t) {
+					hit = { t, i, instance, std::min({ u, v, 1.0 - u - v }) };
+				}
+			}
+		}
+		return hit;
+	}
+
+	/**
+	 * @brief Rays from around the soup: half of them aimed at a triangle, the others random.
+	 */
+	std::vector<Ray> makeRays(const std::vector<Triangle>& triangles, const uint32_t count, const uint32_t seed) {
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		std::vector<Ray> rays(count);
+		for (uint32_t i = 0; i < count; i++) {
+			Ray& ray = rays[i];
+			ray.origin = glm::vec3(position(random), position(random), position(random));
+
+			if (i % 2 == 0) {
+				const Triangle& target = triangles[random() % triangles.size()];
+				const float a = unit(random) * 0.8f + 0.1f;
+				const float b = unit(random) * (0.9f - a);
+				ray.direction = target.v0 + a * (target.v1 - target.v0) + b * (target.v2 - target.v0) - ray.origin;
+			} else {
+				ray.direction = glm::vec3(position(random), position(random), position(random));
+			}
+
+			// some rays start inside the soup or stop before reaching far
+			if (i % 5 == 1) ray.tMin = 0.3f;
+			if (i % 7 == 3) ray.tMax = 0.6f;
+		}
+		return rays;
+	}
+
+	double getEdgeDistance(const RayHit& hit) {
+		return std::min({ static_cast<double>(hit.u), static_cast<double>(hit.v), 1.0 - hit.u - hit.v });
+	}
+
+	/**
+	 * @brief Checks a BVH hit against the brute force one, hits within 1e-4 of an edge may go either way.
+	 */
+	void checkHit(const RayHit& hit, const BruteForceHit& expected, const std::vector<std::vector<Triangle>>& instances,
+		const Ray& ray, const bool isTwoLevel) {
+
+		const bool isExpectedHit = expected.primitiveIndex != INVALID_PRIMITIVE;
+		if (hit.isHit() != isExpectedHit) {
+			PXT_CHECK((isExpectedHit ? expected.edgeDistance : getEdgeDistance(hit)) < 1e-4);
+			return;
+		}
+		if (!hit.isHit()) return;
+
+		const double tolerance = 1e-3 * std::max(1.0, expected.t);
+		if (std::abs(hit.t - expected.t) > tolerance) {
+			// one of them grazed an edge the other one missed
+			PXT_CHECK(expected.edgeDistance < 1e-4 || getEdgeDistance(hit) < 1e-4);
+			return;
+		}
+
+		// a different triangle must be a tie at the same distance
+		const uint32_t instance = isTwoLevel ? hit.instanceIndex : 0;
+		PXT_CHECK(instance < instances.size() && hit.primitiveIndex < instances[instance].size());
+
+		double t, u, v;
+		if (!intersectTriangle(ray, instances[instance][hit.primitiveIndex], t, u, v)) {
+			PXT_CHECK(getEdgeDistance(hit) < 1e-4);
+			return;
+		}
+		PXT_CHECK_NEAR(t, hit.t, tolerance);
+
+		// the float barycentrics lose precision as the ray grazes the triangle
+		const Triangle& triangle = instances[instance][hit.primitiveIndex];
+		const glm::dvec3 normal = glm::normalize(glm::cross(glm::dvec3(triangle.v1 - triangle.v0), glm::dvec3(triangle.v2 - triangle.v0)));
+		const double cosine = std::abs(glm::dot(normal, glm::normalize(glm::dvec3(ray.direction))));
+		const double barycentricTolerance = 1e-4 / std::max(cosine, 1e-3);
+
+		PXT_CHECK_NEAR(u, hit.u, barycentricTolerance);
+		PXT_CHECK_NEAR(v, hit.v, barycentricTolerance);
+	}
+}
+
+PXT_TEST(bvhClosestHitMatchesBruteForce) {
+	const std::vector<Mesh::Vertex> vertices = makeTriangleSoup(2000, 1);
+	const std::vector<std::vector<Triangle>> instances = { getTriangles(vertices) };
+	const std::vector<Ray> rays = makeRays(instances[0], 2000, 2);
+
+	// the defaults, single triangle leaves, few bins and a parallel build down to small nodes
+	std::vector<BvhBuilder::Settings> settingsList(4);
+	settingsList[1].maxLeafSize = 1;
+	settingsList[2].binCount = 4;
+	settingsList[3].parallelThreshold = 64;
+
+	for (const BvhBuilder::Settings& settings : settingsList) {
+		Bvh bvh;
+		bvh.build(vertices, {}, settings);
+		PXT_CHECK_EQ(bvh.getTriangleCount(), 2000u);
+
+		for (const Ray& ray : rays) {
+			RayHit hit;
+			bvh.intersect(ray, hit);
+			checkHit(hit, intersectBruteForce(ray, instances), instances, ray, false);
+		}
+	}
+}
+
+PXT_TEST(bvhOcclusionMatchesBruteForce) {
+	const std::vector<Mesh::Vertex> vertices = makeTriangleSoup(1500, 3);
+	const std::vector<std::vector<Triangle>> instances = { getTriangles(vertices) };
+
+	Bvh bvh;
+	bvh.build(vertices, {});
+
+	for (const Ray& ray : makeRays(instances[0], 2000, 4)) {
+		const BruteForceHit expected = intersectBruteForce(ray, instances);
+		if (expected.edgeDistance < 1e-4) continue;
+
+		PXT_CHECK_EQ(bvh.isOccluded(ray), expected.primitiveIndex != INVALID_PRIMITIVE);
+	}
+}
+
+PXT_TEST(bvhOnlyAcceptsCloserHits) {
+	const std::vector<Mesh::Vertex> vertices = makeTriangleSoup(500, 5);
+	const std::vector<std::vector<Triangle>> instances = { getTriangles(vertices) };
+
+	Bvh bvh;
+	bvh.build(vertices, {});
+
+	for (const Ray& ray : makeRays(instances[0], 500, 6)) {
+		const BruteForceHit expected = intersectBruteForce(ray, instances);
+		if (expected.primitiveIndex == INVALID_PRIMITIVE) continue;
+
+		// a hit already found in front of every triangle is kept
+		RayHit hit;
+		hit.t = static_cast<float>(expected.t) * 0.5f;
+		hit.primitiveIndex = 12345;
+		PXT_CHECK(!bvh.intersect(ray, hit));
+		PXT_CHECK_EQ(hit.primitiveIndex, 12345u);
+	}
+}
+
+PXT_TEST(bvhPacketsMatchSingleRays) {
+	const std::vector<Mesh::Vertex> vertices = makeTriangleSoup(2000, 7);
+	const std::vector<std::vector<Triangle>> instances = { getTriangles(vertices) };
+	const std::vector<Ray> rays = makeRays(instances[0], 64 * SIMD_WIDTH, 8);
+
+	Bvh bvh;
+	bvh.build(vertices, {});
+
+	for (size_t first = 0; first < rays.size(); first += SIMD_WIDTH) {
+		RayPacket packet;
+		for (uint32_t lane = 0; lane < SIMD_WIDTH; lane++) {
+			packet.setRay(lane, rays[first + lane]);
+		}
+		// a disabled lane stays untouched
+		const uint32_t disabledLane = (first / SIMD_WIDTH) % SIMD_WIDTH;
+		packet.disable(disabledLane);
+
+		RayPacketHit packetHit;
+		const uint32_t updatedLanes = bvh.intersect(packet, packetHit);
+
+		for (uint32_t lane = 0; lane < SIMD_WIDTH; lane++) {
+			const RayHit laneHit = packetHit.getHit(lane);
+
+			if (lane == disabledLane) {
+				PXT_CHECK(!laneHit.isHit());
+				PXT_CHECK((updatedLanes & (1u << lane)) == 0);
+				continue;
+			}
+
+			PXT_CHECK_EQ((updatedLanes & (1u << lane)) != 0, laneHit.isHit());
+			checkHit(laneHit, intersectBruteForce(rays[first + lane], instances), instances, rays[first + lane], false);
+		}
+	}
+}
+
+PXT_TEST(bvhIndexedMeshesShareVertices) {
+	// a grid of quads, every vertex is shared by up to 6 triangles
+	constexpr uint32_t side = 40;
+	std::vector<Mesh::Vertex> vertices((side + 1) * (side + 1));
+	for (uint32_t y = 0; y <= side; y++) {
+		for (uint32_t x = 0; x <= side; x++) {
+			const float height = std::sin(x * 0.3f) * std::cos(y * 0.2f);
+			vertices[y * (side + 1) + x].position = glm::vec4(static_cast<float>(x), height, static_cast<float>(y), 1.0f);
+		}
+	}
+
+	std::vector<uint32_t> indices;
+	std::vector<Mesh::Vertex> unindexed;
+	for (uint32_t y = 0; y < side; y++) {
+		for (uint32_t x = 0; x < side; x++) {
+			const uint32_t corner = y * (side + 1) + x;
+			for (const uint32_t index : { corner, corner + side + 1, corner + 1, corner + 1, corner + side + 1, corner + side + 2 }) {
+				indices.push_back(index);
+				unindexed.push_back(vertices[index]);
+			}
+		}
+	}
+
+	Bvh bvh;
+	bvh.build(vertices, indices);
+	PXT_CHECK_EQ(bvh.getTriangleCount(), side * side * 2);
+
+	// rays straight down hit the triangle under them
+	const std::vector<std::vector<Triangle>> instances = { getTriangles(unindexed) };
+	std::mt19937 random(9);
+	std::uniform_real_distribution<float> coordinate(0.0f, static_cast<float>(side));
+
+	for (uint32_t i = 0; i < 500; i++) {
+		Ray ray;
+		ray.origin = glm::vec3(coordinate(random), 5.0f, coordinate(random));
+		ray.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+
+		const BruteForceHit expected = intersectBruteForce(ray, instances);
+		PXT_CHECK(expected.primitiveIndex != INVALID_PRIMITIVE);
+
+		RayHit hit;
+		bvh.intersect(ray, hit);
+		checkHit(hit, expected, instances, ray, false);
+	}
+}
+
+PXT_TEST(sceneBvhMatchesBruteForceOverInstances) {
+	const std::vector<Mesh::Vertex> rocks = makeTriangleSoup(300, 10);
+	const std::vector<Mesh::Vertex> trees = makeTriangleSoup(200, 11);
+
+	Bvh rockBvh, treeBvh;
+	rockBvh.build(rocks, {});
+	treeBvh.build(trees, {});
+
+	// rotated, scaled and translated copies, the hit distances must stay in world units
+	std::vector<BvhInstance> bvhInstances;
+	std::vector<std::vector<Triangle>> instances;
+	std::mt19937 random(12);
+	std::uniform_real_distribution<float> position(-40.0f, 40.0f);
+	std::uniform_real_distribution<float> angle(0.0f, 6.28f);
+
+	for (uint32_t i = 0; i < 24; i++) {
+		glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(position(random), position(random) * 0.2f, position(random)));
+		transform = glm::rotate(transform, angle(random), glm::normalize(glm::vec3(0.3f, 1.0f, 0.2f * i)));
+		transform = glm::scale(transform, glm::vec3(0.5f + 0.1f * (i % 10)));
+
+		const bool isRock = i % 3 != 0;
+		bvhInstances.push_back({ isRock ? &rockBvh : &treeBvh, transform });
+		instances.push_back(getTriangles(isRock ? rocks : trees, transform));
+	}
+
+	SceneBvh scene;
+	scene.build(bvhInstances);
+	PXT_CHECK_EQ(scene.getInstanceCount(), 24u);
+
+	std::vector<Triangle> allTriangles;
+	for (const auto& triangles : instances) {
+		allTriangles.insert(allTriangles.end(), triangles.begin(), triangles.end());
+	}
+
+	for (const Ray& ray : makeRays(allTriangles, 1000, 13)) {
+		const BruteForceHit expected = intersectBruteForce(ray, instances);
+
+		// a tie between two instances is fine, checkHit only compares the distances
+		RayHit hit;
+		scene.intersect(ray, hit);
+		checkHit(hit, expected, instances, ray, true);
+
+		if (expected.edgeDistance >= 1e-4) {
+			PXT_CHECK_EQ(scene.isOccluded(ray), expected.primitiveIndex != INVALID_PRIMITIVE);
+		}
+	}
+}
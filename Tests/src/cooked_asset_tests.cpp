@@ -0,0 +1,78 @@
+#include "test_framework.hpp"
+
+#include "resources/importers/cooked_asset.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	std::filesystem::path makeTestDirectory() {
+		const std::filesystem::path directory = std::filesystem::temp_directory_path() / "pxt_cooked_asset_test";
+		std::filesystem::remove_all(directory);
+		std::filesystem::create_directories(directory);
+		return directory;
+	}
+
+	void touch(const std::filesystem::path& path) {
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file << "source";
+	}
+}
+
+PXT_TEST(cookedAssetPathKeepsTheVariants) {
+	const std::filesystem::path source = std::filesystem::path("textures") / "wood" / "albedo.png";
+
+	PXT_CHECK(CookedAsset::getPath(source, ".pxtex") == std::filesystem::path("textures") / "wood" / "albedo.pxtex");
+	PXT_CHECK(CookedAsset::getPath(source, ".pxtex", "srgb") == std::filesystem::path("textures") / "wood" / "albedo.srgb.pxtex");
+	PXT_CHECK(CookedAsset::getPath(source, ".pxtex", "srgb") != CookedAsset::getPath(source, ".pxtex", "linear"));
+}
+
+PXT_TEST(cookedAssetWritesTheSectionsInOrder) {
+	const std::filesystem::path directory = makeTestDirectory();
+	const std::filesystem::path cookedPath = directory / "mesh.pxmesh";
+
+	const uint32_t header = 0x12345678;
+	const std::vector<float> values = { 1.0f, 2.0f, 3.0f };
+	CookedAsset::write(cookedPath, { std::as_bytes(std::span(&header, 1)), std::as_bytes(std::span(values)) });
+
+	std::ifstream file(cookedPath, std::ios::binary);
+	std::vector<char> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	PXT_CHECK_EQ(content.size(), sizeof(header) + sizeof(float) * values.size());
+	PXT_CHECK(std::memcmp(content.data(), &header, sizeof(header)) == 0);
+	PXT_CHECK(std::memcmp(content.data() + sizeof(header), values.data(), sizeof(float) * values.size()) == 0);
+
+	// the temporary file has been renamed
+	std::filesystem::path tempPath = cookedPath;
+	tempPath += ".tmp";
+	PXT_CHECK(!std::filesystem::exists(tempPath));
+
+	file.close();
+	std::filesystem::remove_all(directory);
+}
+
+PXT_TEST(cookedAssetIsUpToDateFollowsTheSource) {
+	const std::filesystem::path directory = makeTestDirectory();
+	const std::filesystem::path source = directory / "albedo.png";
+	const std::filesystem::path cooked = CookedAsset::getPath(source, ".pxtex", "srgb");
+
+	touch(source);
+	PXT_CHECK(!CookedAsset::isUpToDate(source, cooked));
+
+	const uint32_t data = 0;
+	CookedAsset::write(cooked, { std::as_bytes(std::span(&data, 1)) });
+
+	const auto cookedTime = std::filesystem::last_write_time(cooked);
+	std::filesystem::last_write_time(source, cookedTime - std::chrono::seconds(10));
+	PXT_CHECK(CookedAsset::isUpToDate(source, cooked));
+
+	// the source has been edited after the cook
+	std::filesystem::last_write_time(source, cookedTime + std::chrono::seconds(10));
+	PXT_CHECK(!CookedAsset::isUpToDate(source, cooked));
+
+	// only the cooked asset has been shipped
+	std::filesystem::remove(source);
+	PXT_CHECK(CookedAsset::isUpToDate(source, cooked));
+
+	std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,210 @@
+#include "test_framework.hpp"
+
+#include "graphics/resources/environment_distribution.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	/**
+	 * @brief Six RGBA8 faces of random texels with a bright spot, like a sun in a sky.
+	 */
+	std::vector<std::vector<uint8_t>> makeFaces(const uint32_t size, const uint32_t seed) {
+		std::mt19937 random(seed);
+		std::vector<std::vector<uint8_t>> faces(6, std::vector<uint8_t>(static_cast<size_t>(size) * size * 4));
+
+		for (uint32_t face = 0; face < 6; face++) {
+			for (uint32_t texel = 0; texel < size * size; texel++) {
+				uint8_t* rgba = &faces[face][texel * 4];
+				const bool isSun = face == 2 && texel % size < size / 4 && texel / size < size / 4;
+
+				for (uint32_t c = 0; c < 3; c++) {
+					rgba[c] = isSun ? 255 : static_cast<uint8_t>(random() % 128);
+				}
+				rgba[3] = 255;
+			}
+		}
+		return faces;
+	}
+
+	std::vector<const uint8_t*> getFacePointers(const std::vector<std::vector<uint8_t>>& faces) {
+		std::vector<const uint8_t*> pointers;
+		for (const std::vector<uint8_t>& face : faces) {
+			pointers.push_back(face.data());
+		}
+		return pointers;
+	}
+
+	double getLuminance(const uint8_t* rgba) {
+		const auto toLinear = [](const uint8_t value) {
+			const double c = value / 255.0;
+			return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+		};
+		return 0.2126 * toLinear(rgba[0]) + 0.7152 * toLinear(rgba[1]) + 0.0722 * toLinear(rgba[2]);
+	}
+
+	/**
+	 * @brief Solid angle of a texel of a cube face, exact (the area of the projected rectangle on the sphere).
+	 */
+	double getTexelSolidAngle(const uint32_t x, const uint32_t y, const uint32_t size) {
+		const auto areaElement = [](const double s, const double t) { return std::atan2(s * t, std::sqrt(s * s + t * t + 1.0)); };
+
+		const double s0 = 2.0 * x / size - 1.0, s1 = 2.0 * (x + 1) / size - 1.0;
+		const double t0 = 2.0 * y / size - 1.0, t1 = 2.0 * (y + 1) / size - 1.0;
+		return areaElement(s1, t1) - areaElement(s0, t1) - areaElement(s1, t0) + areaElement(s0, t0);
+	}
+}
+
+PXT_TEST(environmentDistributionCdfsAreMonotonic) {
+	const std::vector<std::vector<uint8_t>> faces = makeFaces(128, 1);
+	const EnvironmentDistribution distribution(getFacePointers(faces), 128);
+
+	const uint32_t resolution = distribution.getResolution();
+	const std::vector<AliasTableEntry>& cells = distribution.getCells();
+	PXT_CHECK_EQ(resolution, EnvironmentDistribution::MAX_RESOLUTION);
+	PXT_CHECK_EQ(cells.size(), size_t{ 6 } * resolution * resolution);
+
+	// the alias table is the flattened 2D distribution: a marginal CDF over the rows of cells of every face
+	// and a conditional CDF within every row, both built from the cell pdfs
+	const uint32_t rowCount = 6 * resolution;
+	std::vector<double> rowProbabilities(rowCount, 0.0);
+	for (uint32_t row = 0; row < rowCount; row++) {
+		double conditionalCdf = 0.0;
+		double rowProbability = 0.0;
+		for (uint32_t x = 0; x < resolution; x++) {
+			rowProbability += cells[row * resolution + x].pdf;
+		}
+
+		for (uint32_t x = 0; x < resolution; x++) {
+			const float pdf = cells[row * resolution + x].pdf;
+			PXT_CHECK(pdf >= 0.0f);
+
+			const double next = conditionalCdf + pdf / rowProbability;
+			PXT_CHECK(next >= conditionalCdf);
+			conditionalCdf = next;
+		}
+		PXT_CHECK_NEAR(conditionalCdf, 1.0, 1e-5);
+		rowProbabilities[row] = rowProbability;
+	}
+
+	double marginalCdf = 0.0;
+	for (const double rowProbability : rowProbabilities) {
+		PXT_CHECK(rowProbability > 0.0);
+		marginalCdf += rowProbability;
+	}
+	PXT_CHECK_NEAR(marginalCdf, 1.0, 1e-4);
+
+	// the alias table samples the cells with these probabilities
+	std::vector<double> sampled(cells.size(), 0.0);
+	for (uint32_t i = 0; i < cells.size(); i++) {
+		sampled[i] += cells[i].probability / cells.size();
+		sampled[cells[i].alias] += (1.0 - cells[i].probability) / cells.size();
+	}
+	for (uint32_t i = 0; i < cells.size(); i++) {
+		PXT_CHECK_NEAR(sampled[i], cells[i].pdf, 1e-6);
+	}
+}
+
+PXT_TEST(environmentDistributionPdfIsLuminanceTimesSolidAngle) {
+	// one texel per cell, and sizes that aren't a multiple of the SIMD width
+	for (const uint32_t size : { 16u, 13u }) {
+		const std::vector<std::vector<uint8_t>> faces = makeFaces(size, size);
+		const EnvironmentDistribution distribution(getFacePointers(faces), size);
+		PXT_CHECK_EQ(distribution.getResolution(), size);
+
+		double total = 0.0;
+		for (uint32_t face = 0; face < 6; face++) {
+			for (uint32_t texel = 0; texel < size * size; texel++) {
+				total += getLuminance(&faces[face][texel * 4]) * getTexelSolidAngle(texel % size, texel / size, size);
+			}
+		}
+
+		const std::vector<AliasTableEntry>& cells = distribution.getCells();
+		for (uint32_t face = 0; face < 6; face++) {
+			for (uint32_t texel = 0; texel < size * size; texel++) {
+				const double expected = getLuminance(&faces[face][texel * 4]) * getTexelSolidAngle(texel % size, texel / size, size) / total;
+				// the builder takes the solid angle at the texel center, about 1% off on the coarsest texels
+				PXT_CHECK_NEAR(cells[face * size * size + texel].pdf, expected, 0.02 * expected + 1e-7);
+			}
+		}
+	}
+
+	// bigger faces: the cells sum the texels they cover, 100 texels don't split evenly over 64 cells
+	const std::vector<std::vector<uint8_t>> faces = makeFaces(100, 3);
+	const EnvironmentDistribution distribution(getFacePointers(faces), 100);
+	const uint32_t resolution = distribution.getResolution();
+
+	std::vector<double> expected(6 * resolution * resolution, 0.0);
+	double total = 0.0;
+	for (uint32_t face = 0; face < 6; face++) {
+		for (uint32_t y = 0; y < 100; y++) {
+			for (uint32_t x = 0; x < 100; x++) {
+				const double weight = getLuminance(&faces[face][(y * 100 + x) * 4]) * getTexelSolidAngle(x, y, 100);
+				expected[(face * resolution + y * resolution / 100) * resolution + x * resolution / 100] += weight;
+				total += weight;
+			}
+		}
+	}
+	for (uint32_t cell = 0; cell < expected.size(); cell++) {
+		PXT_CHECK_NEAR(distribution.getCells()[cell].pdf, expected[cell] / total, 0.01 * expected[cell] / total + 1e-7);
+	}
+}
+
+PXT_TEST(environmentDistributionPdfIntegratesToOne) {
+	const std::vector<std::vector<uint8_t>> faces = makeFaces(64, 4);
+	const EnvironmentDistribution distribution(getFacePointers(faces), 64);
+
+	// midpoint rule in spherical coordinates, the grid doesn't follow the cube cells
+	constexpr uint32_t thetaSteps = 1024;
+	constexpr uint32_t phiSteps = 2048;
+	const double dTheta = glm::pi<double>() / thetaSteps;
+	const double dPhi = 2.0 * glm::pi<double>() / phiSteps;
+
+	double integral = 0.0;
+	for (uint32_t i = 0; i < thetaSteps; i++) {
+		const double theta = (i + 0.5) * dTheta;
+		double ring = 0.0;
+		for (uint32_t j = 0; j < phiSteps; j++) {
+			const double phi = (j + 0.5) * dPhi;
+			const glm::vec3 direction(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+			ring += distribution.pdf(direction);
+		}
+		integral += ring * std::sin(theta) * dTheta * dPhi;
+	}
+	PXT_CHECK_NEAR(integral, 1.0, 5e-3);
+
+	// the sampled directions report the pdf of pdf(), and land in the bright corner as often as its cells weigh
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	uint32_t sunCount = 0;
+	constexpr uint32_t sampleCount = 20000;
+
+	for (uint32_t sample = 0; sample < sampleCount; sample++) {
+		const uint32_t cellIndex = random() % distribution.getCells().size();
+		const glm::vec2 cellPoint(0.05f + 0.9f * unit(random), 0.05f + 0.9f * unit(random));
+
+		float pdf;
+		const glm::vec3 direction = distribution.sampleDirection(cellIndex, unit(random), cellPoint, pdf);
+		PXT_CHECK_NEAR(glm::length(direction), 1.0f, 1e-5f);
+		PXT_CHECK_NEAR(pdf, distribution.pdf(direction), 1e-3f * pdf);
+
+		// the bright corner of the +Y face, at s, t < -0.5
+		if (direction.y > std::abs(direction.x) && direction.y > std::abs(direction.z) &&
+			direction.x / direction.y < -0.5f && direction.z / direction.y < -0.5f) {
+			sunCount++;
+		}
+	}
+
+	const uint32_t resolution = distribution.getResolution();
+	double sunProbability = 0.0;
+	for (uint32_t y = 0; y < resolution / 4; y++) {
+		for (uint32_t x = 0; x < resolution / 4; x++) {
+			sunProbability += distribution.getCells()[(2 * resolution + y) * resolution + x].pdf;
+		}
+	}
+
+	// far more than the 1/96 of the cube area the corner covers, within 5 standard deviations of its weight
+	PXT_CHECK(sunProbability > 0.05);
+	const double deviation = std::sqrt(sampleCount * sunProbability * (1.0 - sunProbability));
+	PXT_CHECK_NEAR(static_cast<double>(sunCount), sampleCount * sunProbability, 5.0 * deviation);
+}
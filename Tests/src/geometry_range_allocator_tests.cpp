@@ -0,0 +1,269 @@
+#include "test_framework.hpp"
+
+#include "graphics/memory/geometry_range_allocator.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+
+	/**
+	 * @brief Checks that the live ranges don't overlap and lie inside the capacities, on both sides.
+	 */
+	void checkNoOverlap(const GeometryRangeAllocator& allocator, const std::vector<GeometryRangeAllocator::Handle>& handles) {
+		std::vector<std::pair<uint32_t, uint32_t>> vertexRanges;
+		std::vector<std::pair<uint32_t, uint32_t>> indexRanges;
+		for (const GeometryRangeAllocator::Handle handle : handles) {
+			const GeometryRange& range = allocator.getRange(handle);
+			vertexRanges.emplace_back(range.firstVertex, range.firstVertex + range.vertexCount);
+			indexRanges.emplace_back(range.firstIndex, range.firstIndex + range.indexCount);
+		}
+
+		for (auto* ranges : { &vertexRanges, &indexRanges }) {
+			const uint32_t capacity = ranges == &vertexRanges ? allocator.getVertexCapacity() : allocator.getIndexCapacity();
+			std::sort(ranges->begin(), ranges->end());
+
+			for (size_t i = 0; i < ranges->size(); i++) {
+				PXT_CHECK((*ranges)[i].second <= capacity);
+				if (i > 0) {
+					PXT_CHECK((*ranges)[i - 1].second <= (*ranges)[i].first);
+				}
+			}
+		}
+	}
+}
+
+PXT_TEST(geometryRangesAreSubAllocated) {
+	GeometryRangeAllocator allocator(1000, 3000, FRAMES_IN_FLIGHT);
+
+	std::vector<GeometryRangeAllocator::Handle> handles;
+	for (uint32_t i = 1; i <= 10; i++) {
+		const GeometryRangeAllocator::Handle handle = allocator.allocate(i * 10, i * 30);
+		PXT_CHECK(handle != GeometryRangeAllocator::INVALID_HANDLE);
+		PXT_CHECK_EQ(allocator.getRange(handle).vertexCount, i * 10);
+		PXT_CHECK_EQ(allocator.getRange(handle).indexCount, i * 30);
+		handles.push_back(handle);
+	}
+
+	checkNoOverlap(allocator, handles);
+	PXT_CHECK_EQ(allocator.getLiveCount(), 10u);
+	PXT_CHECK_EQ(allocator.getFreeVertexCount(), 1000u - 550u);
+	PXT_CHECK_EQ(allocator.getFreeIndexCount(), 3000u - 1650u);
+}
+
+PXT_TEST(geometryRangesAreRetiredForTheFramesInFlight) {
+	GeometryRangeAllocator allocator(100, 300, FRAMES_IN_FLIGHT);
+
+	const GeometryRangeAllocator::Handle first = allocator.allocate(60, 180);
+	const GeometryRange firstRange = allocator.getRange(first);
+	allocator.free(first);
+
+	PXT_CHECK_EQ(allocator.getLiveCount(), 0u);
+	PXT_CHECK_EQ(allocator.getRetiredCount(), 1u);
+
+	// the frames in flight may still draw the mesh: its ranges and its handle stay taken
+	const GeometryRangeAllocator::Handle second = allocator.allocate(10, 10);
+	PXT_CHECK(second != first);
+
+	for (uint32_t frame = 0; frame < FRAMES_IN_FLIGHT; frame++) {
+		allocator.advanceFrame();
+		PXT_CHECK_EQ(allocator.getRetiredCount(), 1u);
+		PXT_CHECK_EQ(allocator.getFreeVertexCount(), 30u);
+		PXT_CHECK_EQ(allocator.allocate(60, 10), GeometryRangeAllocator::INVALID_HANDLE);
+	}
+
+	// the frame the mesh was freed in is over
+	allocator.advanceFrame();
+	PXT_CHECK_EQ(allocator.getRetiredCount(), 0u);
+	PXT_CHECK_EQ(allocator.getFreeVertexCount(), 90u);
+	PXT_CHECK_EQ(allocator.getFreeIndexCount(), 290u);
+
+	// the handle and the space are reused
+	const GeometryRangeAllocator::Handle reused = allocator.allocate(50, 100);
+	PXT_CHECK_EQ(reused, first);
+	PXT_CHECK_EQ(allocator.getRange(reused).firstVertex, firstRange.firstVertex);
+}
+
+PXT_TEST(geometryRangesThatDontFitLeaveNoTrace) {
+	GeometryRangeAllocator allocator(100, 300, FRAMES_IN_FLIGHT);
+	const GeometryRangeAllocator::Handle handle = allocator.allocate(50, 50);
+
+	// the index side fits and the vertex side doesn't: the index range must be given back
+	PXT_CHECK_EQ(allocator.allocate(51, 100), GeometryRangeAllocator::INVALID_HANDLE);
+	PXT_CHECK_EQ(allocator.allocate(10, 251), GeometryRangeAllocator::INVALID_HANDLE);
+	PXT_CHECK_EQ(allocator.getFreeVertexCount(), 50u);
+	PXT_CHECK_EQ(allocator.getFreeIndexCount(), 250u);
+	PXT_CHECK_EQ(allocator.getLiveCount(), 1u);
+
+	PXT_CHECK(allocator.allocate(50, 200) != GeometryRangeAllocator::INVALID_HANDLE);
+	PXT_CHECK_EQ(allocator.getRange(handle).vertexCount, 50u);
+}
+
+PXT_TEST(geometryRangesGrowTheFullSide) {
+	GeometryRangeAllocator allocator(100, 300, FRAMES_IN_FLIGHT);
+	allocator.allocate(80, 100);
+
+	uint64_t vertexCapacity, indexCapacity;
+
+	// only the vertices are full, they double and the indices keep their capacity
+	allocator.calculateGrownCapacities(30, 100, vertexCapacity, indexCapacity);
+	PXT_CHECK_EQ(vertexCapacity, 200ull);
+	PXT_CHECK_EQ(indexCapacity, 300ull);
+
+	// a mesh bigger than the doubled capacity keeps doubling
+	allocator.calculateGrownCapacities(500, 10, vertexCapacity, indexCapacity);
+	PXT_CHECK_EQ(vertexCapacity, 800ull);
+	PXT_CHECK_EQ(indexCapacity, 300ull);
+
+	// the probes didn't take anything
+	PXT_CHECK_EQ(allocator.getFreeVertexCount(), 20u);
+	PXT_CHECK_EQ(allocator.getFreeIndexCount(), 200u);
+
+	// a retired range is dropped by the repack, it doesn't count
+	const GeometryRangeAllocator::Handle retired = allocator.allocate(20, 10);
+	allocator.free(retired);
+	allocator.calculateGrownCapacities(50, 10, vertexCapacity, indexCapacity);
+	PXT_CHECK_EQ(vertexCapacity, 200ull);
+}
+
+PXT_TEST(geometryRangesArePackedInHandleOrder) {
+	GeometryRangeAllocator allocator(1000, 1000, FRAMES_IN_FLIGHT);
+
+	std::vector<GeometryRangeAllocator::Handle> handles;
+	for (uint32_t i = 0; i < 8; i++) {
+		handles.push_back(allocator.allocate(100, 50 + i));
+	}
+
+	// holes between the live ranges, the freed ranges are still in flight
+	for (uint32_t i = 0; i < 8; i += 2) {
+		allocator.free(handles[i]);
+	}
+	std::vector<GeometryRange> before;
+	for (uint32_t i = 1; i < 8; i += 2) {
+		before.push_back(allocator.getRange(handles[i]));
+	}
+
+	std::vector<GeometryMove> moves;
+	allocator.repack(2000, 500, moves);
+
+	PXT_CHECK_EQ(allocator.getVertexCapacity(), 2000u);
+	PXT_CHECK_EQ(allocator.getIndexCapacity(), 500u);
+	PXT_CHECK_EQ(allocator.getRetiredCount(), 0u);
+	PXT_CHECK_EQ(moves.size(), size_t{ 4 });
+
+	uint32_t nextVertex = 0;
+	uint32_t nextIndex = 0;
+	for (uint32_t i = 0; i < moves.size(); i++) {
+		const GeometryRange& range = allocator.getRange(handles[i * 2 + 1]);
+
+		// the moves copy the old ranges to the current ones, which follow each other from the start
+		PXT_CHECK_EQ(moves[i].source.firstVertex, before[i].firstVertex);
+		PXT_CHECK_EQ(moves[i].source.firstIndex, before[i].firstIndex);
+		PXT_CHECK_EQ(moves[i].destination.firstVertex, range.firstVertex);
+		PXT_CHECK_EQ(moves[i].destination.indexCount, before[i].indexCount);
+
+		PXT_CHECK_EQ(range.firstVertex, nextVertex);
+		PXT_CHECK_EQ(range.firstIndex, nextIndex);
+		nextVertex += range.vertexCount;
+		nextIndex += range.indexCount;
+	}
+
+	PXT_CHECK_EQ(allocator.getFreeVertexCount(), 2000u - nextVertex);
+	PXT_CHECK_EQ(allocator.getFreeIndexCount(), 500u - nextIndex);
+	// the vertices left are a single range (the TLSF rounds the sizes up, so the whole index space left may not fit)
+	PXT_CHECK(allocator.allocate(2000 - nextVertex, 256) != GeometryRangeAllocator::INVALID_HANDLE);
+}
+
+PXT_TEST(geometryRangesSurviveAStreamingScene) {
+	GeometryRangeAllocator allocator(4096, 8192, FRAMES_IN_FLIGHT);
+
+	// the two buffers of the arena: every live mesh is stamped with its own id to catch overlaps and lost moves
+	std::vector<uint32_t> vertexMemory(allocator.getVertexCapacity(), 0);
+	std::vector<uint32_t> indexMemory(allocator.getIndexCapacity(), 0);
+
+	const auto stamp = [&](const GeometryRange& range, const uint32_t id) {
+		std::fill_n(vertexMemory.begin() + range.firstVertex, range.vertexCount, id);
+		std::fill_n(indexMemory.begin() + range.firstIndex, range.indexCount, id);
+	};
+	const auto isStamped = [&](const GeometryRange& range, const uint32_t id) {
+		const auto vertices = vertexMemory.begin() + range.firstVertex;
+		const auto indices = indexMemory.begin() + range.firstIndex;
+		return std::all_of(vertices, vertices + range.vertexCount, [&](const uint32_t value) { return value == id; }) &&
+			std::all_of(indices, indices + range.indexCount, [&](const uint32_t value) { return value == id; });
+	};
+
+	std::vector<GeometryRangeAllocator::Handle> handles;
+	std::vector<uint32_t> ids;
+	std::mt19937 random(17);
+	uint32_t nextId = 1;
+	uint32_t repackCount = 0;
+
+	for (uint32_t step = 0; step < 20000; step++) {
+		if (step % 7 == 0) {
+			allocator.advanceFrame();
+		}
+
+		if (handles.empty() || random() % 100 < 55) {
+			const uint32_t vertexCount = 1 + random() % 300;
+			const uint32_t indexCount = 3 * (1 + random() % 200);
+
+			GeometryRangeAllocator::Handle handle = allocator.allocate(vertexCount, indexCount);
+			if (handle == GeometryRangeAllocator::INVALID_HANDLE) {
+				// what GeometryArena::allocate does, the copies of the device are done on the stamped memory
+				uint64_t vertexCapacity, indexCapacity;
+				allocator.calculateGrownCapacities(vertexCount, indexCount, vertexCapacity, indexCapacity);
+
+				std::vector<GeometryMove> moves;
+				allocator.repack(static_cast<uint32_t>(vertexCapacity), static_cast<uint32_t>(indexCapacity), moves);
+				repackCount++;
+
+				std::vector<uint32_t> newVertexMemory(vertexCapacity, 0);
+				std::vector<uint32_t> newIndexMemory(indexCapacity, 0);
+				for (const GeometryMove& move : moves) {
+					std::copy_n(vertexMemory.begin() + move.source.firstVertex, move.source.vertexCount,
+						newVertexMemory.begin() + move.destination.firstVertex);
+					std::copy_n(indexMemory.begin() + move.source.firstIndex, move.source.indexCount,
+						newIndexMemory.begin() + move.destination.firstIndex);
+				}
+				vertexMemory = std::move(newVertexMemory);
+				indexMemory = std::move(newIndexMemory);
+
+				handle = allocator.allocate(vertexCount, indexCount);
+				PXT_CHECK(handle != GeometryRangeAllocator::INVALID_HANDLE);
+			}
+
+			stamp(allocator.getRange(handle), nextId);
+			handles.push_back(handle);
+			ids.push_back(nextId++);
+		} else {
+			const size_t index = random() % handles.size();
+
+			// nobody wrote over the mesh while it was alive, and the repacks carried it along
+			PXT_CHECK(isStamped(allocator.getRange(handles[index]), ids[index]));
+
+			allocator.free(handles[index]);
+			handles[index] = handles.back();
+			ids[index] = ids.back();
+			handles.pop_back();
+			ids.pop_back();
+		}
+	}
+
+	PXT_CHECK(repackCount > 0);
+	PXT_CHECK_EQ(allocator.getLiveCount(), static_cast<uint32_t>(handles.size()));
+	checkNoOverlap(allocator, handles);
+	for (size_t i = 0; i < handles.size(); i++) {
+		PXT_CHECK(isStamped(allocator.getRange(handles[i]), ids[i]));
+	}
+
+	// once the frames in flight are over, only the live ranges are taken
+	for (uint32_t frame = 0; frame <= FRAMES_IN_FLIGHT; frame++) {
+		allocator.advanceFrame();
+	}
+	uint64_t liveVertexCount = 0;
+	for (const GeometryRangeAllocator::Handle handle : handles) {
+		liveVertexCount += allocator.getRange(handle).vertexCount;
+	}
+	PXT_CHECK_EQ(uint64_t{ allocator.getVertexCapacity() - allocator.getFreeVertexCount() }, liveVertexCount);
+}
@@ -0,0 +1,347 @@
+#include "test_framework.hpp"
+
+#include "graphics/memory/gpu_allocator.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	constexpr VkDeviceSize DEVICE_HEAP_SIZE = 4ull * 1024 * 1024 * 1024;
+	constexpr VkDeviceSize HOST_HEAP_SIZE = 256ull * 1024 * 1024;
+	constexpr VkDeviceSize ATOM_SIZE = 64;
+
+	constexpr uint32_t DEVICE_LOCAL_TYPE = 0;
+	constexpr uint32_t HOST_COHERENT_TYPE = 1;
+	constexpr uint32_t HOST_CACHED_TYPE = 2;
+
+	template <typename Handle>
+	Handle makeHandle(const uintptr_t value) {
+		return reinterpret_cast<Handle>(value);
+	}
+
+	/**
+	 * @brief GpuMemoryBackend of a fake device: memory objects are counters, host visible ones are backed by
+	 * CPU bytes, and the allocations, frees and flushes are recorded for the checks.
+	 */
+	class FakeMemoryBackend : public GpuMemoryBackend {
+	public:
+		struct Resource {
+			VkMemoryRequirements requirements{};
+			bool prefersDedicated = false;
+		};
+
+		struct AllocateCall {
+			VkDeviceMemory memory;
+			VkDeviceSize size;
+			uint32_t memoryType;
+			bool hasDeviceAddressFlag = false;
+			VkBuffer dedicatedBuffer = VK_NULL_HANDLE;
+			VkImage dedicatedImage = VK_NULL_HANDLE;
+			bool isDedicated = false;
+		};
+
+		FakeMemoryBackend() {
+			m_memoryProperties.memoryHeapCount = 2;
+			m_memoryProperties.memoryHeaps[0] = { DEVICE_HEAP_SIZE, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT };
+			m_memoryProperties.memoryHeaps[1] = { HOST_HEAP_SIZE, 0 };
+
+			m_memoryProperties.memoryTypeCount = 3;
+			m_memoryProperties.memoryTypes[DEVICE_LOCAL_TYPE] = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0 };
+			m_memoryProperties.memoryTypes[HOST_COHERENT_TYPE] = {
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1 };
+			m_memoryProperties.memoryTypes[HOST_CACHED_TYPE] = {
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, 1 };
+		}
+
+		VkBuffer createBuffer(const VkDeviceSize size, const VkDeviceSize alignment = 256, const bool prefersDedicated = false) {
+			const VkBuffer buffer = makeHandle<VkBuffer>(++m_nextHandle);
+			m_resources[buffer] = { { size, alignment, ~0u }, prefersDedicated };
+			return buffer;
+		}
+
+		VkImage createImage(const VkDeviceSize size, const VkDeviceSize alignment = 4096, const bool prefersDedicated = false) {
+			const VkImage image = makeHandle<VkImage>(++m_nextHandle);
+			m_resources[image] = { { size, alignment, ~0u }, prefersDedicated };
+			return image;
+		}
+
+		const VkPhysicalDeviceMemoryProperties& getMemoryProperties() const override { return m_memoryProperties; }
+		VkDeviceSize getNonCoherentAtomSize() const override { return ATOM_SIZE; }
+
+		void getBufferMemoryRequirements(VkBuffer buffer, VkMemoryRequirements2& requirements) override {
+			fillRequirements(m_resources.at(buffer), requirements);
+		}
+
+		void getImageMemoryRequirements(VkImage image, VkMemoryRequirements2& requirements) override {
+			fillRequirements(m_resources.at(image), requirements);
+		}
+
+		VkResult allocateMemory(const VkMemoryAllocateInfo& allocateInfo, VkDeviceMemory& memory) override {
+			memory = makeHandle<VkDeviceMemory>(++m_nextHandle);
+
+			AllocateCall call{ memory, allocateInfo.allocationSize, allocateInfo.memoryTypeIndex };
+			for (auto* next = static_cast<const VkBaseInStructure*>(allocateInfo.pNext); next; next = next->pNext) {
+				if (next->sType == VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO) {
+					const auto* flagsInfo = reinterpret_cast<const VkMemoryAllocateFlagsInfo*>(next);
+					call.hasDeviceAddressFlag = flagsInfo->flags & VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+				} else if (next->sType == VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO) {
+					const auto* dedicatedInfo = reinterpret_cast<const VkMemoryDedicatedAllocateInfo*>(next);
+					call.isDedicated = true;
+					call.dedicatedBuffer = dedicatedInfo->buffer;
+					call.dedicatedImage = dedicatedInfo->image;
+				}
+			}
+			allocateCalls.push_back(call);
+
+			if (m_memoryProperties.memoryTypes[allocateInfo.memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+				m_hostMemory[memory].resize(allocateInfo.allocationSize);
+			}
+			liveMemories.insert(memory);
+			return VK_SUCCESS;
+		}
+
+		void freeMemory(VkDeviceMemory memory) override {
+			PXT_CHECK(liveMemories.erase(memory) == 1);
+			m_hostMemory.erase(memory);
+		}
+
+		VkResult mapMemory(VkDeviceMemory memory, void** data) override {
+			*data = m_hostMemory.at(memory).data();
+			return VK_SUCCESS;
+		}
+
+		VkResult bindBufferMemory(VkBuffer buffer, VkDeviceMemory memory, const VkDeviceSize offset) override {
+			return bind(buffer, memory, offset);
+		}
+
+		VkResult bindImageMemory(VkImage image, VkDeviceMemory memory, const VkDeviceSize offset) override {
+			return bind(image, memory, offset);
+		}
+
+		VkResult flushMappedMemoryRange(const VkMappedMemoryRange& range) override {
+			flushedRanges.push_back(range);
+			return VK_SUCCESS;
+		}
+
+		VkResult invalidateMappedMemoryRange(const VkMappedMemoryRange& range) override {
+			invalidatedRanges.push_back(range);
+			return VK_SUCCESS;
+		}
+
+		std::vector<AllocateCall> allocateCalls;
+		std::set<VkDeviceMemory> liveMemories;
+		std::vector<VkMappedMemoryRange> flushedRanges;
+		std::vector<VkMappedMemoryRange> invalidatedRanges;
+
+	private:
+		void fillRequirements(const Resource& resource, VkMemoryRequirements2& requirements) {
+			requirements.memoryRequirements = resource.requirements;
+
+			// the allocator must chain the dedicated requirements
+			auto* dedicated = static_cast<VkMemoryDedicatedRequirements*>(requirements.pNext);
+			PXT_CHECK(dedicated != nullptr && dedicated->sType == VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS);
+			dedicated->prefersDedicatedAllocation = resource.prefersDedicated;
+			dedicated->requiresDedicatedAllocation = false;
+		}
+
+		VkResult bind(const void* resource, VkDeviceMemory memory, const VkDeviceSize offset) {
+			const Resource& bound = m_resources.at(resource);
+			PXT_CHECK(liveMemories.contains(memory));
+			PXT_CHECK_EQ(offset % bound.requirements.alignment, 0ull);
+			return VK_SUCCESS;
+		}
+
+		VkPhysicalDeviceMemoryProperties m_memoryProperties{};
+		uintptr_t m_nextHandle = 0;
+		std::unordered_map<const void*, Resource> m_resources;
+		std::unordered_map<VkDeviceMemory, std::vector<std::byte>> m_hostMemory;
+	};
+
+	/**
+	 * @brief A GpuAllocator on a FakeMemoryBackend, the backend stays reachable for the checks.
+	 */
+	struct FakeDevice {
+		FakeMemoryBackend* backend;
+		GpuAllocator allocator;
+
+		FakeDevice() : FakeDevice(createUnique<FakeMemoryBackend>()) {}
+
+	private:
+		explicit FakeDevice(Unique<FakeMemoryBackend> fakeBackend)
+			: backend(fakeBackend.get()), allocator(std::move(fakeBackend)) {}
+	};
+}
+
+PXT_TEST(gpuAllocatorSubAllocatesSmallResources) {
+	FakeDevice device;
+
+	std::vector<GpuAllocation> allocations;
+	for (uint32_t i = 0; i < 100; i++) {
+		allocations.push_back(device.allocator.allocateBuffer(
+			device.backend->createBuffer(64 * 1024 + i), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+	}
+
+	// a single block, the ranges don't overlap
+	PXT_CHECK_EQ(device.backend->allocateCalls.size(), size_t{ 1 });
+	std::sort(allocations.begin(), allocations.end(), [](const auto& a, const auto& b) { return a.offset < b.offset; });
+	for (size_t i = 0; i < allocations.size(); i++) {
+		PXT_CHECK(allocations[i].memory == allocations[0].memory);
+		PXT_CHECK(allocations[i].block != nullptr);
+		if (i > 0) {
+			PXT_CHECK(allocations[i - 1].offset + allocations[i - 1].size <= allocations[i].offset);
+		}
+	}
+
+	GpuAllocator::Stats stats = device.allocator.getStats();
+	PXT_CHECK_EQ(stats.blockCount, 1u);
+	PXT_CHECK_EQ(stats.dedicatedCount, 0u);
+	PXT_CHECK_EQ(stats.allocationCount, 100u);
+	PXT_CHECK_EQ(stats.reservedBytes, 64ull * 1024 * 1024);
+
+	// images get their own pool, even on the same memory type
+	GpuAllocation image = device.allocator.allocateImage(device.backend->createImage(4096), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	PXT_CHECK(image.memory != allocations[0].memory);
+	PXT_CHECK_EQ(device.allocator.getStats().blockCount, 2u);
+
+	for (GpuAllocation& allocation : allocations) {
+		device.allocator.free(allocation);
+		PXT_CHECK(!allocation.isValid());
+	}
+	device.allocator.free(image);
+
+	// the empty blocks are kept for the next resources
+	stats = device.allocator.getStats();
+	PXT_CHECK_EQ(stats.allocationCount, 0u);
+	PXT_CHECK_EQ(stats.usedBytes, 0ull);
+	PXT_CHECK_EQ(stats.blockCount, 2u);
+	PXT_CHECK_EQ(device.backend->liveMemories.size(), size_t{ 2 });
+}
+
+PXT_TEST(gpuAllocatorKeepsOneEmptyBlockPerPool) {
+	FakeDevice device;
+
+	// three ranges fit a 64MB block
+	constexpr VkDeviceSize size = 20ull * 1024 * 1024;
+	std::vector<GpuAllocation> allocations;
+	for (uint32_t i = 0; i < 9; i++) {
+		allocations.push_back(device.allocator.allocateBuffer(device.backend->createBuffer(size), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+	}
+	PXT_CHECK_EQ(device.allocator.getStats().blockCount, 3u);
+
+	for (GpuAllocation& allocation : allocations) {
+		device.allocator.free(allocation);
+	}
+
+	PXT_CHECK_EQ(device.allocator.getStats().blockCount, 1u);
+	PXT_CHECK_EQ(device.backend->liveMemories.size(), size_t{ 1 });
+
+	// the kept block is reused instead of asking the driver again
+	const size_t allocateCallCount = device.backend->allocateCalls.size();
+	GpuAllocation allocation = device.allocator.allocateBuffer(device.backend->createBuffer(size), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	PXT_CHECK_EQ(device.backend->allocateCalls.size(), allocateCallCount);
+	device.allocator.free(allocation);
+}
+
+PXT_TEST(gpuAllocatorChainsTheDedicatedAllocationInfo) {
+	FakeDevice device;
+	FakeMemoryBackend& backend = *device.backend;
+
+	// a render target the driver prefers alone in its memory
+	const VkImage renderTarget = backend.createImage(8 * 1024 * 1024, 4096, true);
+	GpuAllocation image = device.allocator.allocateImage(renderTarget, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	PXT_CHECK(image.block == nullptr);
+	PXT_CHECK(backend.allocateCalls.back().isDedicated);
+	PXT_CHECK(backend.allocateCalls.back().dedicatedImage == renderTarget);
+	PXT_CHECK(backend.allocateCalls.back().dedicatedBuffer == VK_NULL_HANDLE);
+	PXT_CHECK(!backend.allocateCalls.back().hasDeviceAddressFlag);
+
+	// a buffer too big for the blocks, the device address flag stays in the chain
+	const VkBuffer bigBuffer = backend.createBuffer(48ull * 1024 * 1024);
+	GpuAllocation buffer = device.allocator.allocateBuffer(bigBuffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	PXT_CHECK(buffer.block == nullptr);
+	PXT_CHECK(backend.allocateCalls.back().isDedicated);
+	PXT_CHECK(backend.allocateCalls.back().dedicatedBuffer == bigBuffer);
+	PXT_CHECK(backend.allocateCalls.back().dedicatedImage == VK_NULL_HANDLE);
+	PXT_CHECK(backend.allocateCalls.back().hasDeviceAddressFlag);
+
+	// the shared blocks name no resource
+	GpuAllocation small = device.allocator.allocateBuffer(backend.createBuffer(1024), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	PXT_CHECK(small.block != nullptr);
+	PXT_CHECK(!backend.allocateCalls.back().isDedicated);
+	PXT_CHECK(backend.allocateCalls.back().hasDeviceAddressFlag);
+
+	PXT_CHECK_EQ(device.allocator.getStats().dedicatedCount, 2u);
+
+	const VkDeviceMemory imageMemory = image.memory;
+	device.allocator.free(image);
+	device.allocator.free(buffer);
+	device.allocator.free(small);
+
+	PXT_CHECK(!backend.liveMemories.contains(imageMemory));
+	PXT_CHECK_EQ(device.allocator.getStats().dedicatedCount, 0u);
+	PXT_CHECK_EQ(backend.liveMemories.size(), size_t{ 1 });
+}
+
+PXT_TEST(gpuAllocatorMapsAndFlushesHostMemory) {
+	FakeDevice device;
+	FakeMemoryBackend& backend = *device.backend;
+
+	constexpr VkMemoryPropertyFlags coherent = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	constexpr VkMemoryPropertyFlags cached = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+	GpuAllocation first = device.allocator.allocateBuffer(backend.createBuffer(1000), coherent);
+	GpuAllocation second = device.allocator.allocateBuffer(backend.createBuffer(1000), coherent);
+	PXT_CHECK_EQ(first.memoryType, HOST_COHERENT_TYPE);
+
+	// both ranges point into the single mapping of their block
+	PXT_CHECK(first.mapped != nullptr && second.mapped != nullptr);
+	PXT_CHECK(first.memory == second.memory);
+	PXT_CHECK_EQ(static_cast<std::byte*>(second.mapped) - static_cast<std::byte*>(first.mapped),
+		static_cast<ptrdiff_t>(second.offset) - static_cast<ptrdiff_t>(first.offset));
+	std::memset(first.mapped, 0xAB, 1000);
+	std::memset(second.mapped, 0xCD, 1000);
+	PXT_CHECK_EQ(static_cast<uint8_t*>(first.mapped)[999], 0xABu);
+
+	// coherent memory needs no flush
+	PXT_CHECK(device.allocator.flush(first) == VK_SUCCESS);
+	PXT_CHECK(backend.flushedRanges.empty());
+
+	GpuAllocation readback = device.allocator.allocateBuffer(backend.createBuffer(1000, 16), cached);
+	PXT_CHECK_EQ(readback.memoryType, HOST_CACHED_TYPE);
+
+	// the ranges are widened to the atom size
+	PXT_CHECK(device.allocator.flush(readback, 10, 100) == VK_SUCCESS);
+	PXT_CHECK(device.allocator.invalidate(readback) == VK_SUCCESS);
+	PXT_CHECK_EQ(backend.flushedRanges.size(), size_t{ 1 });
+	PXT_CHECK_EQ(backend.invalidatedRanges.size(), size_t{ 1 });
+
+	for (const VkMappedMemoryRange& range : { backend.flushedRanges[0], backend.invalidatedRanges[0] }) {
+		PXT_CHECK(range.memory == readback.memory);
+		PXT_CHECK_EQ(range.offset % ATOM_SIZE, 0ull);
+		PXT_CHECK_EQ(range.size % ATOM_SIZE, 0ull);
+		PXT_CHECK(range.offset <= readback.offset);
+		PXT_CHECK(range.offset + range.size >= readback.offset + 110);
+	}
+	PXT_CHECK(backend.invalidatedRanges[0].offset + backend.invalidatedRanges[0].size >= readback.offset + readback.size);
+
+	device.allocator.free(first);
+	device.allocator.free(second);
+	device.allocator.free(readback);
+}
+
+PXT_TEST(gpuAllocatorThrowsWithoutAMatchingMemoryType) {
+	FakeDevice device;
+
+	bool hasThrown = false;
+	try {
+		device.allocator.allocateBuffer(device.backend->createBuffer(1024),
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+	} catch (const std::runtime_error&) {
+		hasThrown = true;
+	}
+
+	PXT_CHECK(hasThrown);
+	PXT_CHECK(device.backend->allocateCalls.empty());
+}
@@ -0,0 +1,122 @@
+#include "test_framework.hpp"
+
+#include "core/jobs/job_system.hpp"
+
+using namespace PXTEngine;
+
+PXT_TEST(jobSystemRunsContinuationsAfterTheirDependency) {
+	constexpr uint32_t groupSize = 64;
+	constexpr uint32_t stageCount = 4;
+
+	// every stage is a group of jobs depending on the whole previous group
+	std::array<JobCounter, stageCount> counters;
+	std::array<std::atomic<uint32_t>, stageCount> finishedCounts{};
+	std::atomic<uint32_t> outOfOrderCount = 0;
+
+	for (uint32_t stage = 0; stage < stageCount; stage++) {
+		JobCounter* dependency = stage > 0 ? &counters[stage - 1] : nullptr;
+
+		for (uint32_t i = 0; i < groupSize; i++) {
+			JobSystem::run([&, stage]() {
+				if (stage > 0 && finishedCounts[stage - 1].load() != groupSize) {
+					outOfOrderCount++;
+				}
+				// long enough for the other stages to be submitted while this one runs
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+				finishedCounts[stage]++;
+			}, &counters[stage], dependency);
+		}
+	}
+
+	JobSystem::wait(counters.back());
+
+	PXT_CHECK_EQ(outOfOrderCount.load(), 0u);
+	for (uint32_t stage = 0; stage < stageCount; stage++) {
+		PXT_CHECK(counters[stage].isDone());
+		PXT_CHECK_EQ(finishedCounts[stage].load(), groupSize);
+	}
+
+	// a dependency already done doesn't hold the job back
+	std::atomic<bool> hasRun = false;
+	JobCounter counter;
+	JobSystem::run([&]() { hasRun = true; }, &counter, &counters[0]);
+	JobSystem::wait(counter);
+	PXT_CHECK(hasRun.load());
+}
+
+PXT_TEST(jobSystemParallelForCoversEveryIndexOnce) {
+	for (const auto& [count, grainSize] : std::vector<std::pair<size_t, size_t>>{
+		{ 0, 16 }, { 1, 16 }, { 17, 1 }, { 1000, 7 }, { 1000, 1000 }, { 1000, 5000 }, { 100003, 64 }, { 10, 0 } }) {
+
+		std::vector<std::atomic<uint32_t>> visits(count);
+		std::atomic<uint32_t> jobCount = 0;
+		std::atomic<uint32_t> badRangeCount = 0;
+
+		JobSystem::parallelFor(count, grainSize, [&](const size_t begin, const size_t end) {
+			if (begin >= end || end - begin > std::max<size_t>(1, grainSize)) badRangeCount++;
+			jobCount++;
+			for (size_t i = begin; i < end; i++) {
+				visits[i]++;
+			}
+		});
+
+		PXT_CHECK_EQ(badRangeCount.load(), 0u);
+		PXT_CHECK(std::all_of(visits.begin(), visits.end(), [](const std::atomic<uint32_t>& v) { return v.load() == 1; }));
+
+		const size_t grain = std::max<size_t>(1, grainSize);
+		PXT_CHECK_EQ(jobCount.load(), static_cast<uint32_t>((count + grain - 1) / grain));
+	}
+}
+
+PXT_TEST(jobSystemLosesNoJobUnderContention) {
+	constexpr uint32_t threadCount = 8;
+	constexpr uint32_t jobsPerThread = 5000;
+	constexpr uint32_t childrenPerJob = 3;
+
+	// external threads submit into the worker queues at the same time, every job spawns children from
+	// inside the pool, so pushes, pops and steals all race with each other
+	std::atomic<uint32_t> executedCount = 0;
+	std::vector<std::thread> threads;
+
+	for (uint32_t thread = 0; thread < threadCount; thread++) {
+		threads.emplace_back([&]() {
+			JobCounter counter;
+			for (uint32_t i = 0; i < jobsPerThread; i++) {
+				JobSystem::run([&]() {
+					executedCount++;
+					for (uint32_t child = 0; child < childrenPerJob; child++) {
+						JobSystem::run([&]() { executedCount++; }, &counter);
+					}
+				}, &counter);
+			}
+			JobSystem::wait(counter);
+		});
+	}
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	PXT_CHECK_EQ(executedCount.load(), threadCount * jobsPerThread * (1 + childrenPerJob));
+}
+
+PXT_TEST(jobSystemWaitsInsideJobs) {
+	// a job waiting on nested jobs keeps running queued jobs, even with a single worker nothing deadlocks
+	constexpr uint32_t outerCount = 32;
+	constexpr uint32_t innerCount = 32;
+	std::atomic<uint32_t> innerRunCount = 0;
+
+	JobSystem::parallelFor(outerCount, 1, [&](size_t, size_t) {
+		JobSystem::parallelFor(innerCount, 4, [&](const size_t begin, const size_t end) {
+			innerRunCount += static_cast<uint32_t>(end - begin);
+		});
+	});
+
+	PXT_CHECK_EQ(innerRunCount.load(), outerCount * innerCount);
+
+	// a throwing job is logged, its counter still ends
+	JobCounter counter;
+	JobSystem::run([]() { throw std::runtime_error("job failure expected by the test"); }, &counter);
+	JobSystem::wait(counter);
+	PXT_CHECK(counter.isDone());
+}
@@ -0,0 +1,175 @@
+#include "test_framework.hpp"
+
+#include "resources/importers/mip_generator.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	std::vector<uint8_t> makeRandomImage(const uint32_t width, const uint32_t height, const uint32_t seed) {
+		std::mt19937 random(seed);
+		std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+		for (uint8_t& value : pixels) {
+			value = static_cast<uint8_t>(random() & 0xFF);
+		}
+		return pixels;
+	}
+
+	/**
+	 * @brief Box filter of the texels a destination texel covers: 2 per side, 3 for the last one of an odd side.
+	 */
+	std::vector<uint8_t> downsampleReference(const std::vector<uint8_t>& source, const uint32_t width, const uint32_t height) {
+		const uint32_t destinationWidth = std::max(1u, width / 2);
+		const uint32_t destinationHeight = std::max(1u, height / 2);
+
+		const auto getRange = [](const uint32_t index, const uint32_t size, const uint32_t destinationSize) {
+			if (size == 1) return std::pair<uint32_t, uint32_t>(0, 1);
+			const uint32_t count = (size % 2 == 1 && index == destinationSize - 1) ? 3 : 2;
+			return std::pair<uint32_t, uint32_t>(index * 2, index * 2 + count);
+		};
+
+		std::vector<uint8_t> destination(static_cast<size_t>(destinationWidth) * destinationHeight * 4);
+		for (uint32_t y = 0; y < destinationHeight; y++) {
+			for (uint32_t x = 0; x < destinationWidth; x++) {
+				const auto [x0, x1] = getRange(x, width, destinationWidth);
+				const auto [y0, y1] = getRange(y, height, destinationHeight);
+
+				for (uint32_t c = 0; c < 4; c++) {
+					double sum = 0.0;
+					for (uint32_t sy = y0; sy < y1; sy++) {
+						for (uint32_t sx = x0; sx < x1; sx++) {
+							sum += source[(static_cast<size_t>(sy) * width + sx) * 4 + c];
+						}
+					}
+					destination[(static_cast<size_t>(y) * destinationWidth + x) * 4 + c] =
+						static_cast<uint8_t>(sum / ((x1 - x0) * (y1 - y0)) + 0.5);
+				}
+			}
+		}
+		return destination;
+	}
+
+	int getMaxDifference(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+		int maxDifference = 0;
+		for (size_t i = 0; i < a.size(); i++) {
+			maxDifference = std::max(maxDifference, std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i])));
+		}
+		return maxDifference;
+	}
+}
+
+PXT_TEST(mipGeneratorEvenSizesMatchTheIntegerBoxFilter) {
+	constexpr uint32_t width = 64;
+	constexpr uint32_t height = 32;
+	const std::vector<uint8_t> source = makeRandomImage(width, height, 1);
+
+	std::vector<uint8_t> destination(width / 2 * height / 2 * 4);
+	MipGenerator::downsample(source.data(), width, height, destination.data(), false);
+
+	for (uint32_t y = 0; y < height / 2; y++) {
+		for (uint32_t x = 0; x < width / 2; x++) {
+			for (uint32_t c = 0; c < 4; c++) {
+				const auto at = [&](const uint32_t sx, const uint32_t sy) { return source[(sy * width + sx) * 4 + c]; };
+				const uint32_t sum = at(2 * x, 2 * y) + at(2 * x + 1, 2 * y) + at(2 * x, 2 * y + 1) + at(2 * x + 1, 2 * y + 1);
+
+				PXT_CHECK_EQ(static_cast<uint32_t>(destination[(y * width / 2 + x) * 4 + c]), (sum + 2) >> 2);
+			}
+		}
+	}
+}
+
+PXT_TEST(mipGeneratorFoldsTheOddEdges) {
+	// the sizes around the SIMD width, odd and even, and the 1 texel wide/tall sources
+	for (const auto& [width, height] : std::vector<std::pair<uint32_t, uint32_t>>{
+		{ 3, 3 }, { 5, 4 }, { 4, 5 }, { 7, 9 }, { 17, 15 }, { 33, 1 }, { 1, 33 }, { 1, 1 }, { 2, 1 }, { 3, 1 } }) {
+
+		const std::vector<uint8_t> source = makeRandomImage(width, height, width * 100 + height);
+		const uint32_t destinationWidth = std::max(1u, width / 2);
+		const uint32_t destinationHeight = std::max(1u, height / 2);
+
+		std::vector<uint8_t> destination(static_cast<size_t>(destinationWidth) * destinationHeight * 4);
+		MipGenerator::downsample(source.data(), width, height, destination.data(), false);
+
+		PXT_CHECK(getMaxDifference(destination, downsampleReference(source, width, height)) <= 1);
+	}
+
+	// a bright last row and column used to be dropped
+	constexpr uint32_t size = 3;
+	std::vector<uint8_t> source(size * size * 4, 0);
+	for (uint32_t i = 0; i < size; i++) {
+		std::fill_n(source.begin() + (i * size + size - 1) * 4, 4, uint8_t{ 255 });
+		std::fill_n(source.begin() + ((size - 1) * size + i) * 4, 4, uint8_t{ 255 });
+	}
+
+	std::array<uint8_t, 4> texel{};
+	MipGenerator::downsample(source.data(), size, size, texel.data(), false);
+	PXT_CHECK_EQ(static_cast<uint32_t>(texel[0]), 142u); // 5 bright texels out of 9
+}
+
+PXT_TEST(mipGeneratorAveragesSrgbInLinearSpace) {
+	// a black and white checkerboard is half the light, which is about 188 in sRGB, not 128
+	constexpr uint32_t size = 16;
+	std::vector<uint8_t> source(size * size * 4);
+	for (uint32_t y = 0; y < size; y++) {
+		for (uint32_t x = 0; x < size; x++) {
+			const uint8_t value = (x + y) % 2 == 0 ? 255 : 0;
+			uint8_t* texel = &source[(y * size + x) * 4];
+			texel[0] = texel[1] = texel[2] = value;
+			texel[3] = value;
+		}
+	}
+
+	std::vector<uint8_t> destination(size / 2 * size / 2 * 4);
+	MipGenerator::downsample(source.data(), size, size, destination.data(), true);
+
+	for (size_t i = 0; i < destination.size(); i += 4) {
+		PXT_CHECK(destination[i] >= 187 && destination[i] <= 189);
+		PXT_CHECK_EQ(destination[i], destination[i + 1]);
+		PXT_CHECK_EQ(destination[i], destination[i + 2]);
+		// alpha is not sRGB encoded
+		PXT_CHECK_EQ(static_cast<uint32_t>(destination[i + 3]), 128u);
+	}
+
+	// every 8 bit value survives a round trip through the tables
+	for (uint32_t value = 0; value < 256; value++) {
+		const std::vector<uint8_t> flat(size * size * 4, static_cast<uint8_t>(value));
+		std::vector<uint8_t> flatDestination((size / 2) * ((size - 1) / 2) * 4);
+		MipGenerator::downsample(flat.data(), size, size - 1, flatDestination.data(), true);
+		PXT_CHECK(std::all_of(flatDestination.begin(), flatDestination.end(), [&](const uint8_t v) { return v == value; }));
+	}
+}
+
+PXT_TEST(mipGeneratorBuildsTheWholeChain) {
+	constexpr uint32_t width = 601;
+	constexpr uint32_t height = 517;
+	const std::vector<uint8_t> pixels = makeRandomImage(width, height, 3);
+
+	ImageInfo imageInfo;
+	imageInfo.width = width;
+	imageInfo.height = height;
+	imageInfo.format = RGBA8_LINEAR;
+
+	const Buffer source(pixels.data(), pixels.size());
+	const Shared<Buffer> levels = MipGenerator::generate(source, imageInfo);
+
+	PXT_CHECK_EQ(imageInfo.mipLevels, 10u);
+	PXT_CHECK(std::memcmp(levels->bytes, pixels.data(), pixels.size()) == 0);
+
+	// every level is the filter of the previous one, the big ones go through the jobs
+	std::vector<uint8_t> previous = pixels;
+	size_t offset = pixels.size();
+
+	for (uint32_t level = 1; level < imageInfo.mipLevels; level++) {
+		const uint32_t previousWidth = std::max(1u, width >> (level - 1));
+		const uint32_t previousHeight = std::max(1u, height >> (level - 1));
+
+		const std::vector<uint8_t> expected = downsampleReference(previous, previousWidth, previousHeight);
+		const std::vector<uint8_t> actual(levels->bytes + offset, levels->bytes + offset + expected.size());
+		PXT_CHECK(getMaxDifference(actual, expected) <= 1);
+
+		previous = actual;
+		offset += expected.size();
+	}
+
+	PXT_CHECK_EQ(offset, levels->size);
+}
@@ -0,0 +1,68 @@
+#include "test_framework.hpp"
+#include "test_meshes.hpp"
+
+#include "resources/importers/mesh_importer.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	struct ParsedMesh {
+		std::vector<Mesh::Vertex> vertices;
+		std::vector<uint32_t> indices;
+	};
+
+	ParsedMesh parse(const std::filesystem::path& path, const uint32_t threadCount) {
+		ParsedMesh mesh;
+		MeshImporter::parseObj(path, mesh.vertices, mesh.indices, threadCount);
+		return mesh;
+	}
+
+	bool isBitIdentical(const ParsedMesh& a, const ParsedMesh& b) {
+		return a.vertices.size() == b.vertices.size() && a.indices.size() == b.indices.size() &&
+			std::memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(Mesh::Vertex)) == 0 &&
+			std::memcmp(a.indices.data(), b.indices.data(), a.indices.size() * sizeof(uint32_t)) == 0;
+	}
+}
+
+PXT_TEST(objParserParallelIsBitIdenticalToSerial) {
+	// 160 * 160 quads are 153600 corners, above the threshold of the parallel path, in 7 uneven shapes
+	const std::filesystem::path path = Tests::writeGridObj("pxt_obj_parser_test.obj", 160, 7);
+
+	const ParsedMesh serial = parse(path, 1);
+	PXT_CHECK_EQ(serial.indices.size(), size_t{ 160 * 160 * 6 });
+	PXT_CHECK_EQ(serial.vertices.size(), size_t{ 161 * 161 });
+
+	for (const uint32_t threadCount : { 2u, 4u, 8u, 0u }) {
+		const ParsedMesh parallel = parse(path, threadCount);
+		PXT_CHECK(isBitIdentical(parallel, serial));
+	}
+
+	std::filesystem::remove(path);
+}
+
+PXT_TEST(objParserSmallMeshUsesTheSerialPath) {
+	const ParsedMesh serial = parse("assets/models/cube.obj", 1);
+	const ParsedMesh parallel = parse("assets/models/cube.obj", 8);
+
+	PXT_CHECK(!serial.indices.empty());
+	PXT_CHECK(isBitIdentical(parallel, serial));
+
+	// every index points to a vertex and every vertex is used
+	std::vector<bool> used(serial.vertices.size(), false);
+	for (const uint32_t index : serial.indices) {
+		PXT_CHECK(index < serial.vertices.size());
+		used[index] = true;
+	}
+	PXT_CHECK(std::ranges::all_of(used, [](const bool isUsed) { return isUsed; }));
+}
+
+PXT_TEST(objParserMissingFileThrows) {
+	bool thrown = false;
+	try {
+		parse("assets/models/missing.obj", 0);
+	} catch (const std::runtime_error&) {
+		thrown = true;
+	}
+	PXT_CHECK(thrown);
+}
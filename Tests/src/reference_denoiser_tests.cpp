@@ -0,0 +1,99 @@
+#include "test_framework.hpp"
+#include "test_scenes.hpp"
+
+#include "graphics/reference/reference_denoiser.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	constexpr uint32_t IMAGE_SIZE = 32;
+
+	std::vector<glm::vec4> saturate(std::vector<glm::vec4> image) {
+		for (glm::vec4& pixel : image) {
+			pixel = glm::clamp(pixel, 0.0f, 1.0f);
+		}
+		return image;
+	}
+}
+
+PXT_TEST(referenceDenoiserComputeRmse) {
+	const std::vector<glm::vec4> reference(16, glm::vec4(0.25f, 0.5f, 0.75f, 1.0f));
+	PXT_CHECK_EQ(ReferenceDenoiser::computeRmse(reference, reference), 0.0f);
+
+	// the alpha is ignored
+	std::vector<glm::vec4> image = reference;
+	for (glm::vec4& pixel : image) {
+		pixel += glm::vec4(0.1f, -0.1f, 0.1f, 0.5f);
+	}
+	PXT_CHECK_NEAR(ReferenceDenoiser::computeRmse(image, reference), 0.1f, 1e-6f);
+
+	// a single wrong channel of a single pixel
+	image = reference;
+	image[3].g += 0.6f;
+	PXT_CHECK_NEAR(ReferenceDenoiser::computeRmse(image, reference), std::sqrt(0.36f / 48.0f), 1e-6f);
+}
+
+PXT_TEST(referenceDenoiserKeepsConstantImage) {
+	// a flat, static, uniformly lit wall: nothing to filter, in the first frame and once the history builds up
+	const glm::vec4 albedo(0.8f, 0.6f, 0.4f, 1.0f);
+	const glm::vec4 radiance = albedo * 0.75f;
+
+	const size_t pixelCount = static_cast<size_t>(IMAGE_SIZE) * IMAGE_SIZE;
+	ReferencePathTracer::Features features;
+	features.radiance.assign(pixelCount, glm::vec4(glm::vec3(radiance), 1.0f));
+	features.normalDepth.assign(pixelCount, glm::vec4(0.0f, 0.0f, -1.0f, 5.0f));
+	features.albedo.assign(pixelCount, albedo);
+	features.motion.assign(pixelCount, glm::vec4(0.0f));
+
+	ReferenceDenoiser denoiser;
+	std::vector<glm::vec4> output;
+
+	for (uint32_t frame = 0; frame < 8; frame++) {
+		denoiser.denoise(features, IMAGE_SIZE, IMAGE_SIZE, output);
+		PXT_CHECK_EQ(output.size(), pixelCount);
+
+		for (const glm::vec4& pixel : output) {
+			PXT_CHECK_NEAR(pixel.r, radiance.r, 1e-4f);
+			PXT_CHECK_NEAR(pixel.g, radiance.g, 1e-4f);
+			PXT_CHECK_NEAR(pixel.b, radiance.b, 1e-4f);
+		}
+	}
+}
+
+PXT_TEST(referenceDenoiserLowersErrorAgainstReference) {
+	Tests::QuadScene shadows;
+	Tests::buildSoftShadowScene(shadows);
+
+	// the denoised image is saturated, the images it is compared with too
+	ReferencePathTracer::Settings settings;
+	settings.samplesPerPixel = 64;
+	ReferencePathTracer referenceTracer(settings);
+	referenceTracer.resize(IMAGE_SIZE, IMAGE_SIZE);
+	for (uint32_t frame = 0; frame < 4; frame++) {
+		referenceTracer.render(shadows.scene, shadows.camera, (1 << 20) + frame * settings.samplesPerPixel);
+	}
+
+	std::vector<glm::vec4> reference;
+	referenceTracer.resolve(reference);
+	reference = saturate(std::move(reference));
+
+	settings.samplesPerPixel = 1;
+	ReferencePathTracer pathTracer(settings);
+	pathTracer.resize(IMAGE_SIZE, IMAGE_SIZE);
+
+	ReferenceDenoiser denoiser;
+	std::vector<glm::vec4> noisy;
+	std::vector<glm::vec4> denoised;
+
+	for (uint32_t frame = 0; frame < 4; frame++) {
+		pathTracer.render(shadows.scene, shadows.camera, frame);
+		denoiser.denoise(pathTracer.getFeatures(), IMAGE_SIZE, IMAGE_SIZE, denoised);
+
+		// the filter beats the accumulated samples it was given, in the first frame and with its history
+		pathTracer.resolve(noisy);
+		const float noisyRmse = ReferenceDenoiser::computeRmse(saturate(noisy), reference);
+		const float denoisedRmse = ReferenceDenoiser::computeRmse(denoised, reference);
+		PXT_CHECK(denoisedRmse < 0.75f * noisyRmse);
+	}
+}
@@ -0,0 +1,292 @@
+#include "test_framework.hpp"
+
+#include "resources/resource_manager.hpp"
+#include "resources/importers/resource_importer.hpp"
+#include "resources/types/material.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	class FakeResource : public Resource {
+	public:
+		explicit FakeResource(std::string alias) : alias(std::move(alias)) {}
+
+		static Type getStaticType() { return Type::Mesh; }
+		Type getType() const override { return Type::Mesh; }
+
+		std::string alias;
+	};
+
+	class FakeImage : public Image {
+	public:
+		uint32_t getWidth() override { return 1; }
+		uint32_t getHeight() override { return 1; }
+		uint16_t getChannels() override { return 4; }
+		ImageFormat getFormat() override { return RGBA8_LINEAR; }
+
+		Type getType() const override { return Type::Image; }
+	};
+
+	std::atomic<uint32_t> g_finalizerCount = 0;
+	std::atomic<uint32_t> g_offMainThreadCount = 0;
+	std::thread::id g_mainThread;
+
+	void resetFakeImporter() {
+		g_finalizerCount = 0;
+		g_offMainThreadCount = 0;
+		g_mainThread = std::this_thread::get_id();
+	}
+}
+
+namespace PXTEngine {
+
+	// stands in for the engine importers, which need a Vulkan context: the aliases containing
+	// "missing" fail to decode, the .png ones create a FakeImage, the others a FakeResource,
+	// and the creating thread is recorded
+	ResourceFinalizer ResourceImporter::load(const std::filesystem::path& filePath, ResourceInfo* resourceInfo) {
+		const std::string alias = filePath.string();
+		if (alias.find("missing") != std::string::npos) {
+			throw std::runtime_error("File not found: " + alias);
+		}
+
+		return [alias]() -> Shared<Resource> {
+			g_finalizerCount++;
+			if (std::this_thread::get_id() != g_mainThread) {
+				g_offMainThreadCount++;
+			}
+			if (alias.ends_with(".png")) {
+				return createShared<FakeImage>();
+			}
+			return createShared<FakeResource>(alias);
+		};
+	}
+}
+
+PXT_TEST(resourceManagerGetOnMainThreadCreatesOnce) {
+	resetFakeImporter();
+	ResourceManager manager;
+
+	const Shared<Resource> first = manager.get("a.fake");
+	const Shared<Resource> second = manager.get("a.fake");
+
+	PXT_CHECK(first != nullptr);
+	PXT_CHECK(first == second);
+	PXT_CHECK_EQ(g_finalizerCount.load(), 1u);
+	PXT_CHECK(manager.get("missing.fake") == nullptr);
+	PXT_CHECK(!manager.hasPendingLoads());
+}
+
+PXT_TEST(resourceManagerAsyncResolvesOnProcessCompletedLoads) {
+	resetFakeImporter();
+	ResourceManager manager;
+
+	const Shared<Resource> placeholder = createShared<FakeResource>("placeholder");
+	const Shared<ResourceRequest> request = manager.getAsync("b.fake", nullptr, placeholder);
+
+	std::thread::id callbackThread;
+	request->onReady([&](const Shared<Resource>&) { callbackThread = std::this_thread::get_id(); });
+
+	// the decoding ends in the background, the resource is only created by the frame loop
+	while (!request->isReady()) {
+		PXT_CHECK(request->get() == placeholder);
+		manager.processCompletedLoads();
+	}
+
+	PXT_CHECK(request->get() != placeholder);
+	PXT_CHECK(callbackThread == std::this_thread::get_id());
+	PXT_CHECK(manager.get("b.fake") == request->get());
+	PXT_CHECK_EQ(g_finalizerCount.load(), 1u);
+}
+
+PXT_TEST(resourceManagerJoinedRequestKeepsTheFirstPlaceholder) {
+	resetFakeImporter();
+	ResourceManager manager;
+
+	// the import stays pending until the frame loop resolves it, the second request joins it
+	const Shared<Resource> first = createShared<FakeResource>("first");
+	const Shared<Resource> second = createShared<FakeResource>("second");
+	const Shared<ResourceRequest> request = manager.getAsync("f.fake", nullptr, first);
+	const Shared<ResourceRequest> joined = manager.getAsync("f.fake", nullptr, second);
+
+	PXT_CHECK(joined == request);
+	PXT_CHECK(joined->get() == first);
+
+	manager.waitForPendingLoads();
+	PXT_CHECK(joined->isReady());
+	PXT_CHECK_EQ(g_finalizerCount.load(), 1u);
+}
+
+PXT_TEST(resourceManagerStressFromManyThreads) {
+	resetFakeImporter();
+	ResourceManager manager;
+
+	constexpr uint32_t threadCount = 8;
+	constexpr uint32_t requestCount = 400;
+	constexpr uint32_t aliasCount = 64;
+
+	std::atomic<uint32_t> runningThreads = threadCount;
+	std::atomic<uint32_t> registeredCallbacks = 0;
+	std::atomic<uint32_t> calledCallbacks = 0;
+	std::atomic<uint32_t> offMainThreadCallbacks = 0;
+	std::atomic<uint32_t> wrongResources = 0;
+
+	std::mutex requestedMutex;
+	std::set<std::string> requestedAliases;
+
+	const std::thread::id mainThread = std::this_thread::get_id();
+	const auto onReady = [&](const Shared<Resource>&) {
+		calledCallbacks++;
+		if (std::this_thread::get_id() != mainThread) {
+			offMainThreadCallbacks++;
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < threadCount; t++) {
+		threads.emplace_back([&, t]() {
+			std::mt19937 random(t);
+
+			for (uint32_t i = 0; i < requestCount; i++) {
+				const std::string alias = std::format("stress/{}.fake", random() % aliasCount);
+				const uint32_t action = random() % 3;
+
+				if (action != 2) {
+					std::lock_guard lock(requestedMutex);
+					requestedAliases.insert(alias);
+				}
+
+				switch (action) {
+					case 0: {
+						// blocks until the main thread has created the resource
+						const auto resource = std::static_pointer_cast<FakeResource>(manager.get(alias));
+						if (!resource || resource->alias != alias) wrongResources++;
+						break;
+					}
+					case 1: {
+						registeredCallbacks++;
+						manager.getAsync(alias, nullptr, nullptr)->onReady(onReady);
+						break;
+					}
+					default: {
+						// a failing import resolves with nullptr, it doesn't block the others
+						if (i % 50 == 0 && manager.get("stress/missing.fake") != nullptr) wrongResources++;
+						break;
+					}
+				}
+			}
+
+			runningThreads--;
+		});
+	}
+
+	// the frame loop of the main thread
+	while (runningThreads > 0 || manager.hasPendingLoads()) {
+		manager.processCompletedLoads();
+		std::this_thread::yield();
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	manager.processCompletedLoads();
+
+	PXT_CHECK_EQ(wrongResources.load(), 0u);
+	PXT_CHECK_EQ(g_offMainThreadCount.load(), 0u);
+	PXT_CHECK_EQ(offMainThreadCallbacks.load(), 0u);
+	PXT_CHECK_EQ(calledCallbacks.load(), registeredCallbacks.load());
+
+	// every alias has been imported once, whatever the number of concurrent requests
+	PXT_CHECK_EQ(g_finalizerCount.load(), static_cast<uint32_t>(requestedAliases.size()));
+	for (const std::string& alias : requestedAliases) {
+		const auto resource = std::static_pointer_cast<FakeResource>(manager.get(alias));
+		PXT_CHECK(resource && resource->alias == alias);
+	}
+	PXT_CHECK_EQ(g_finalizerCount.load(), static_cast<uint32_t>(requestedAliases.size()));
+}
+
+PXT_TEST(resourceManagerWaitResolvesAHandle) {
+	resetFakeImporter();
+	ResourceManager manager;
+
+	const ResourceHandle<FakeResource> handle = manager.getAsync<FakeResource>("c.fake", nullptr, createShared<FakeResource>("placeholder"));
+	const Shared<FakeResource> resource = manager.wait(handle);
+
+	PXT_CHECK(resource != nullptr && resource->alias == "c.fake");
+	PXT_CHECK(handle.isReady());
+	PXT_CHECK(handle.get() == resource);
+	PXT_CHECK(!manager.hasPendingLoads());
+
+	const ResourceHandle<FakeResource> missing = manager.getAsync<FakeResource>("missing.fake", nullptr, createShared<FakeResource>("placeholder"));
+	PXT_CHECK(manager.wait(missing) == nullptr);
+	PXT_CHECK(missing.getRequest()->hasFailed());
+}
+
+PXT_TEST(resourceManagerReportsTheResourcesAddedByImports) {
+	resetFakeImporter();
+	ResourceManager manager;
+
+	// the registries of the application register the late resources through this callback
+	std::vector<Shared<Resource>> addedResources;
+	std::thread::id callbackThread;
+	manager.setResourceAddedCallback([&](const Shared<Resource>& resource) {
+		addedResources.push_back(resource);
+		callbackThread = std::this_thread::get_id();
+	});
+
+	const ResourceHandle<FakeResource> handle = manager.getAsync<FakeResource>("d.fake", nullptr, createShared<FakeResource>("placeholder"));
+	manager.getAsync("missing.fake", nullptr, nullptr);
+	while (manager.hasPendingLoads()) {
+		manager.processCompletedLoads();
+	}
+
+	// the failed import adds nothing
+	PXT_CHECK_EQ(addedResources.size(), size_t{ 1 });
+	PXT_CHECK(addedResources.front() == handle.get());
+	PXT_CHECK(callbackThread == std::this_thread::get_id());
+
+	// the resources added by another thread are reported on the main thread
+	std::thread([&]() { manager.add(createShared<FakeResource>("e"), "e.fake"); }).join();
+	PXT_CHECK_EQ(addedResources.size(), size_t{ 1 });
+	manager.processCompletedLoads();
+	PXT_CHECK_EQ(addedResources.size(), size_t{ 2 });
+	PXT_CHECK(callbackThread == std::this_thread::get_id());
+}
+
+PXT_TEST(materialSwapsInItsMapsWhenTheyAreLoaded) {
+	resetFakeImporter();
+	ResourceManager manager;
+
+	const Shared<Image> defaultMap = createShared<FakeImage>();
+	ResourceManager::defaultMaterial = createShared<Material>(glm::vec4(1.0f), defaultMap, defaultMap, defaultMap,
+		defaultMap, defaultMap, glm::vec4(0.0f), defaultMap);
+
+	const Shared<Image> loadedMap = manager.get<Image>("loaded.png");
+	const ResourceHandle<Image> albedoMap = manager.getAsync<Image>("albedo.png");
+	const ResourceHandle<Image> normalMap = manager.getAsync<Image>("normal.png");
+	const ResourceHandle<Image> missingMap = manager.getAsync<Image>("missing.png");
+
+	const Shared<Material> material = Material::Builder()
+		.setAlbedoMap(albedoMap)
+		.setNormalMap(normalMap)
+		.setRoughnessMap(missingMap)
+		.setMetallicMap(manager.getAsync<Image>("loaded.png"))
+		.build();
+
+	// the maps already loaded are set right away, the others keep the default until processCompletedLoads
+	PXT_CHECK(material->getMetallicMap() == loadedMap);
+	if (!albedoMap.isReady()) {
+		PXT_CHECK(material->getAlbedoMap() == defaultMap);
+	}
+
+	while (manager.hasPendingLoads()) {
+		manager.processCompletedLoads();
+	}
+
+	PXT_CHECK(material->getAlbedoMap() == albedoMap.get());
+	PXT_CHECK(material->getAlbedoMap() != defaultMap);
+	PXT_CHECK(material->getNormalMap() == normalMap.get());
+	PXT_CHECK(material->getRoughnessMap() == defaultMap);
+	PXT_CHECK(material->getAmbientOcclusionMap() == defaultMap);
+
+	ResourceManager::defaultMaterial = nullptr;
+}
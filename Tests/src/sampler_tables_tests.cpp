@@ -0,0 +1,206 @@
+#include "test_framework.hpp"
+
+#include "graphics/reference/reference_sampler.hpp"
+#include "graphics/resources/sampler_tables.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	/**
+	 * @brief Checks that n = 2^m points of a pair of dimensions are a (0, m, 2)-net: every elementary
+	 * interval of area 1/n, from 1 x 1/n to 1/n x 1, holds exactly one of them.
+	 */
+	bool isNet(const std::vector<glm::uvec2>& points) {
+		const uint32_t log2Count = std::countr_zero(static_cast<uint32_t>(points.size()));
+
+		for (uint32_t xBits = 0; xBits <= log2Count; xBits++) {
+			const uint32_t yBits = log2Count - xBits;
+
+			std::vector<uint8_t> isOccupied(points.size(), 0);
+			for (const glm::uvec2& point : points) {
+				// the 0 bit shifts are done in 64 bits, a 32 bit shift by 32 is undefined
+				const uint64_t cellX = static_cast<uint64_t>(point.x) >> (32 - xBits);
+				const uint64_t cellY = static_cast<uint64_t>(point.y) >> (32 - yBits);
+				const uint64_t cell = (cellY << xBits) | cellX;
+
+				if (isOccupied[cell]) return false;
+				isOccupied[cell] = 1;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Distance to the closest other point of the set, on the torus of the texture.
+	 */
+	float getMinimumDistance(const std::vector<glm::ivec2>& points, const int32_t size) {
+		float minimum = std::numeric_limits<float>::max();
+		for (size_t i = 0; i < points.size(); i++) {
+			for (size_t j = i + 1; j < points.size(); j++) {
+				const int32_t dx = std::abs(points[i].x - points[j].x);
+				const int32_t dy = std::abs(points[i].y - points[j].y);
+				const glm::vec2 offset(std::min(dx, size - dx), std::min(dy, size - dy));
+				minimum = std::min(minimum, glm::length(offset));
+			}
+		}
+		return minimum;
+	}
+}
+
+PXT_TEST(sobolTablePairsAreNetsForEveryPowerOfTwoBlock) {
+	const SobolTable table;
+	PXT_CHECK_EQ(table.getSampleCount(), SobolTable::SAMPLE_COUNT);
+	PXT_CHECK_EQ(table.getDimensionCount(), SobolTable::DIMENSION_COUNT);
+	PXT_CHECK_EQ(table.getSamples().size(), size_t{ SobolTable::SAMPLE_COUNT } * SobolTable::DIMENSION_COUNT);
+
+	// the prefixes the sampler walks through as the accumulation goes on, and the aligned blocks after them
+	for (uint32_t dimension = 0; dimension < table.getDimensionCount(); dimension += 2) {
+		for (uint32_t count = 1; count <= table.getSampleCount(); count *= 2) {
+			for (uint32_t first = 0; first < table.getSampleCount(); first += count) {
+				std::vector<glm::uvec2> points(count);
+				for (uint32_t i = 0; i < count; i++) {
+					points[i] = { table.get(first + i, dimension), table.get(first + i, dimension + 1) };
+				}
+				PXT_CHECK(isNet(points));
+			}
+		}
+	}
+}
+
+PXT_TEST(sobolTablePairsAreDecorrelated) {
+	const SobolTable table;
+
+	// the pairs are scrambled differently, their first samples differ and no pair repeats another one
+	for (uint32_t a = 0; a < table.getDimensionCount(); a += 2) {
+		for (uint32_t b = a + 2; b < table.getDimensionCount(); b += 2) {
+			uint32_t sameCount = 0;
+			for (uint32_t sample = 0; sample < table.getSampleCount(); sample++) {
+				sameCount += table.get(sample, a) == table.get(sample, b);
+			}
+			PXT_CHECK(sameCount < 4);
+		}
+	}
+
+	// two dimensions of different pairs taken together are not a net, but still fill the square evenly
+	constexpr uint32_t gridSize = 4;
+	std::array<uint32_t, gridSize * gridSize> counts{};
+	for (uint32_t sample = 0; sample < table.getSampleCount(); sample++) {
+		const uint32_t x = table.get(sample, 0) >> 30;
+		const uint32_t y = table.get(sample, 3) >> 30;
+		counts[y * gridSize + x]++;
+	}
+	for (const uint32_t count : counts) {
+		PXT_CHECK(count >= 4 && count <= 28);
+	}
+
+	// the seed picks the scramble, the same seed gives the same table
+	PXT_CHECK(SobolTable(64, 4, 1).getSamples() == SobolTable(64, 4, 1).getSamples());
+	PXT_CHECK(SobolTable(64, 4, 1).getSamples() != SobolTable(64, 4, 2).getSamples());
+}
+
+PXT_TEST(blueNoiseRanksSpreadEvenly) {
+	const BlueNoiseTexture blueNoise;
+	const uint32_t size = blueNoise.getSize();
+	const uint32_t texelCount = size * size;
+
+	// every rank appears once, so the thresholds are a stratified 1D sequence over the texture
+	std::vector<uint32_t> ranks = blueNoise.getRanks();
+	std::sort(ranks.begin(), ranks.end());
+	for (uint32_t i = 0; i < texelCount; i++) {
+		PXT_CHECK_EQ(ranks[i], i);
+	}
+
+	// the texels under any threshold keep apart from each other, white noise of the same density has
+	// neighbours touching each other
+	std::mt19937 random(1);
+	for (const uint32_t pointCount : { texelCount / 16, texelCount / 8, texelCount / 4 }) {
+		std::vector<glm::ivec2> blueNoisePoints;
+		for (uint32_t y = 0; y < size; y++) {
+			for (uint32_t x = 0; x < size; x++) {
+				if (blueNoise.getRank(x, y) < pointCount) {
+					blueNoisePoints.emplace_back(x, y);
+				}
+			}
+		}
+		PXT_CHECK_EQ(blueNoisePoints.size(), size_t{ pointCount });
+
+		std::vector<glm::ivec2> whiteNoisePoints(pointCount);
+		for (glm::ivec2& point : whiteNoisePoints) {
+			point = glm::ivec2(random() % size, random() % size);
+		}
+
+		// the spacing of a perfect grid of pointCount points
+		const float gridSpacing = std::sqrt(static_cast<float>(texelCount) / pointCount);
+		const float blueNoiseDistance = getMinimumDistance(blueNoisePoints, static_cast<int32_t>(size));
+
+		PXT_CHECK(blueNoiseDistance >= 0.5f * gridSpacing);
+		PXT_CHECK(blueNoiseDistance > 2.0f * getMinimumDistance(whiteNoisePoints, static_cast<int32_t>(size)));
+	}
+
+	// the texture stores the 16 bit threshold in red and green
+	const std::vector<uint8_t> texels = blueNoise.getRgba8Texels();
+	for (uint32_t y = 0; y < size; y += 7) {
+		for (uint32_t x = 0; x < size; x += 5) {
+			const uint8_t* texel = &texels[(y * size + x) * 4];
+			PXT_CHECK_EQ(static_cast<uint32_t>(texel[0] << 8 | texel[1]), static_cast<uint32_t>(blueNoise.getThreshold(x, y)));
+			PXT_CHECK_EQ(blueNoise.getThreshold(x, y) * uint64_t{ texelCount } >> 16, uint64_t{ blueNoise.getRank(x, y) });
+		}
+	}
+}
+
+PXT_TEST(referenceSamplerStratifiesPixelsAndSamples) {
+	const ReferenceSampler sampler;
+	constexpr uint32_t tileSize = BlueNoiseTexture::SIZE;
+	constexpr uint32_t sampleCount = SobolTable::SAMPLE_COUNT;
+
+	// a sample of a dimension over a blue noise tile: the shifts are the thresholds, so every pixel
+	// lands in its own 1 / (tileSize * tileSize) stratum
+	for (const uint32_t dimension : { 0u, 1u, 6u, 31u }) {
+		for (const uint32_t sampleIndex : { 0u, 5u, sampleCount + 3 }) {
+			std::vector<uint8_t> isOccupied(tileSize * tileSize, 0);
+			uint32_t seed = 0;
+
+			for (uint32_t y = 0; y < tileSize; y++) {
+				for (uint32_t x = 0; x < tileSize; x++) {
+					const float value = sampler.sampleDimension({ x + 128, y + 64 }, sampleIndex, dimension, seed);
+					PXT_CHECK(value >= 0.0f && value < 1.0f);
+
+					const uint32_t stratum = static_cast<uint32_t>(value * (tileSize * tileSize));
+					PXT_CHECK(!isOccupied[stratum]);
+					isOccupied[stratum] = 1;
+				}
+			}
+		}
+	}
+
+	// the samples of a pixel are the table shifted modulo 1, the gaps between them stay under two strata
+	for (const glm::uvec2 pixel : { glm::uvec2(0, 0), glm::uvec2(17, 300), glm::uvec2(1919, 1079) }) {
+		for (uint32_t dimension = 0; dimension < SobolTable::DIMENSION_COUNT; dimension++) {
+			uint32_t seed = 0;
+			std::vector<float> values(sampleCount);
+			for (uint32_t sampleIndex = 0; sampleIndex < sampleCount; sampleIndex++) {
+				values[sampleIndex] = sampler.sampleDimension(pixel, sampleIndex, dimension, seed);
+			}
+			std::sort(values.begin(), values.end());
+
+			float maxGap = values.front() + 1.0f - values.back();
+			for (uint32_t i = 1; i < sampleCount; i++) {
+				maxGap = std::max(maxGap, values[i] - values[i - 1]);
+			}
+			PXT_CHECK(maxGap <= 2.0f / sampleCount);
+		}
+	}
+
+	// 2D samples start on an even dimension, the dimensions past the table fall back to white noise
+	uint32_t dimension = 1;
+	uint32_t seed = 0;
+	sampler.sample2D({ 3, 4 }, 0, dimension, seed);
+	PXT_CHECK_EQ(dimension, 4u);
+	PXT_CHECK_EQ(seed, 0u);
+
+	dimension = SobolTable::DIMENSION_COUNT;
+	const float whiteNoise = sampler.sample1D({ 3, 4 }, 0, dimension, seed);
+	PXT_CHECK(whiteNoise >= 0.0f && whiteNoise <= 1.0f);
+	PXT_CHECK_EQ(seed, 1u);
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+namespace PXTEngine::Tests {
+
+	/**
+	 * @struct TestCase
+	 *
+	 * @brief A test or a benchmark registered by PXT_TEST or PXT_BENCHMARK.
+	 */
+	struct TestCase {
+		std::string name;
+		void (*function)();
+	};
+
+	inline std::vector<TestCase>& getTests() {
+		static std::vector<TestCase> tests;
+		return tests;
+	}
+
+	inline std::vector<TestCase>& getBenchmarks() {
+		static std::vector<TestCase> benchmarks;
+		return benchmarks;
+	}
+
+	struct TestRegistrar {
+		TestRegistrar(std::vector<TestCase>& cases, const char* name, void (*function)()) {
+			cases.push_back({ name, function });
+		}
+	};
+
+	/**
+	 * @brief Thrown by a failed check, the runner reports it and goes on with the next test.
+	 */
+	class TestFailure : public std::runtime_error {
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+	[[noreturn]] inline void fail(const char* file, const int line, const std::string& message) {
+		throw TestFailure(std::format("{}:{}: {}", std::filesystem::path(file).filename().string(), line, message));
+	}
+
+	/**
+	 * @brief Runs the registered cases whose name contains filter, returns the number of failures.
+	 */
+	inline uint32_t runCases(const std::vector<TestCase>& cases, const std::string& filter) {
+		uint32_t runCount = 0;
+		uint32_t failureCount = 0;
+
+		for (const TestCase& testCase : cases) {
+			if (testCase.name.find(filter) == std::string::npos) continue;
+
+			runCount++;
+			std::cout << "[ RUN  ] " << testCase.name << std::endl;
+
+			try {
+				testCase.function();
+				std::cout << "[  OK  ] " << testCase.name << std::endl;
+			} catch (const std::exception& e) {
+				failureCount++;
+				std::cout << "[ FAIL ] " << testCase.name << "\n         " << e.what() << std::endl;
+			}
+		}
+
+		std::cout << std::format("{} run, {} failed\n", runCount, failureCount);
+		return failureCount;
+	}
+
+	/**
+	 * @brief Runs fn once to warm up, then repetitions times, returns the average duration of a run in seconds.
+	 */
+	template <typename Function>
+	double measureSeconds(const uint32_t repetitions, Function&& function) {
+		function();
+
+		const auto start = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < repetitions; i++) {
+			function();
+		}
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		return elapsed.count() / repetitions;
+	}
+
+	/**
+	 * @brief Prints a benchmark result line, aligned under the runner output.
+	 */
+	inline void report(const std::string& line) {
+		std::cout << "         " << line << std::endl;
+	}
+}
+
+#define PXT_TEST_CONCAT_IMPL(a, b) a##b
+#define PXT_TEST_CONCAT(a, b) PXT_TEST_CONCAT_IMPL(a, b)
+
+#define PXT_TEST_CASE_IMPL(cases, name) \
+	static void name(); \
+	static const PXTEngine::Tests::TestRegistrar PXT_TEST_CONCAT(name, Registrar)(cases, #name, &name); \
+	static void name()
+
+// Defines a test, run by pxt_tests
+#define PXT_TEST(name) PXT_TEST_CASE_IMPL(PXTEngine::Tests::getTests(), name)
+
+// Defines a benchmark, run by pxt_benchmarks
+#define PXT_BENCHMARK(name) PXT_TEST_CASE_IMPL(PXTEngine::Tests::getBenchmarks(), name)
+
+#define PXT_CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			PXTEngine::Tests::fail(__FILE__, __LINE__, "check `" #condition "` failed"); \
+		} \
+	} while (0)
+
+#define PXT_CHECK_EQ(actual, expected) \
+	do { \
+		if (!((actual) == (expected))) { \
+			PXTEngine::Tests::fail(__FILE__, __LINE__, "check `" #actual " == " #expected "` failed"); \
+		} \
+	} while (0)
+
+#define PXT_CHECK_NEAR(actual, expected, tolerance) \
+	do { \
+		const double pxtActual = static_cast<double>(actual); \
+		const double pxtExpected = static_cast<double>(expected); \
+		if (!(std::abs(pxtActual - pxtExpected) <= static_cast<double>(tolerance))) { \
+			PXTEngine::Tests::fail(__FILE__, __LINE__, std::format("`" #actual "` = {} is not within {} of `" #expected "` = {}", \
+				pxtActual, static_cast<double>(tolerance), pxtExpected)); \
+		} \
+	} while (0)
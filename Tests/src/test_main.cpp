@@ -0,0 +1,47 @@
+#include "test_framework.hpp"
+
+#include "core/jobs/job_system.hpp"
+#include "scene/spatial/simd.hpp"
+
+#if defined(PXT_SIMD_AVX2) && defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+using namespace PXTEngine;
+
+namespace {
+
+	// ctest reports the tests as skipped with this exit code
+	constexpr int SKIP_RETURN_CODE = 77;
+
+	bool isSimdBackendSupported() {
+#if defined(PXT_SIMD_AVX2) && defined(_MSC_VER)
+		int registers[4];
+		__cpuidex(registers, 7, 0);
+		return (registers[1] & (1 << 5)) != 0;
+#elif defined(PXT_SIMD_AVX2)
+		return __builtin_cpu_supports("avx2");
+#else
+		return true;
+#endif
+	}
+}
+
+// pxt_tests [filter]: runs the tests whose name contains filter
+int main(const int argc, char** argv) {
+	if (!isSimdBackendSupported()) {
+		std::cout << "The CPU doesn't support the SIMD backend of these tests, skipped" << std::endl;
+		return SKIP_RETURN_CODE;
+	}
+
+	Logger::init();
+	JobSystem::init();
+
+	const std::string filter = argc > 1 ? argv[1] : "";
+	const uint32_t failureCount = Tests::runCases(Tests::getTests(), filter);
+
+	JobSystem::shutdown();
+	Logger::shutdown();
+
+	return failureCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "core/pch.hpp"
+
+namespace PXTEngine::Tests {
+
+	/**
+	 * @brief Writes a wavy grid of side * side quads as an OBJ file, split in shapeCount shapes.
+	 *
+	 * The corners share their positions, uvs and normals with the neighbouring quads, so the parser
+	 * has to deduplicate them. Returns the path of the file, in the temporary directory.
+	 */
+	inline std::filesystem::path writeGridObj(const std::string& name, const uint32_t side, const uint32_t shapeCount) {
+		const std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+		std::ofstream file(path);
+
+		const uint32_t rowSize = side + 1;
+		for (uint32_t y = 0; y <= side; y++) {
+			for (uint32_t x = 0; x <= side; x++) {
+				const float u = static_cast<float>(x) / side;
+				const float v = static_cast<float>(y) / side;
+				const float height = 0.1f * std::sin(12.0f * u) * std::cos(9.0f * v);
+
+				file << std::format("v {} {} {}\n", u, height, v);
+				file << std::format("vt {} {}\n", u, v);
+				file << std::format("vn {} {} {}\n", -std::cos(12.0f * u), 1.0f, std::sin(9.0f * v));
+			}
+		}
+
+		const uint32_t rowsPerShape = (side + shapeCount - 1) / shapeCount;
+		for (uint32_t y = 0; y < side; y++) {
+			if (y % rowsPerShape == 0) {
+				file << std::format("o grid_{}\n", y / rowsPerShape);
+			}
+
+			for (uint32_t x = 0; x < side; x++) {
+				// OBJ indices start at 1
+				const uint32_t a = y * rowSize + x + 1;
+				const uint32_t b = a + 1;
+				const uint32_t c = a + rowSize;
+				const uint32_t d = c + 1;
+
+				file << std::format("f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2}\n", a, b, d);
+				file << std::format("f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2}\n", a, d, c);
+			}
+		}
+
+		return path;
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "core/pch.hpp"
+#include "graphics/reference/reference_scene.hpp"
+#include "scene/camera.hpp"
+
+namespace PXTEngine::Tests {
+
+	/**
+	 * @brief A reference scene of horizontal quads, diffuse or emissive, built on the host.
+	 */
+	struct QuadScene {
+		// 1x1 white emissive map, four half floats of 1.0
+		ReferenceTexture white{ 1, 1, { 0x3C00, 0x3C00, 0x3C00, 0x3C00 } };
+		std::vector<Unique<ReferenceScene::MeshData>> meshes;
+		std::deque<ReferenceScene::MaterialData> materials;
+
+		ReferenceScene scene;
+		Camera camera;
+
+		/**
+		 * @brief Adds a square facing +y (down to the floor) or -y (up to the lights), emissive if the alpha
+		 *        (intensity) of emissiveColor isn't 0.
+		 */
+		void addQuad(const float size, const bool facesDown, const glm::vec3& position, const glm::vec4& emissiveColor = glm::vec4(0.0f)) {
+			std::vector<Mesh::Vertex> vertices(4);
+			for (uint32_t corner = 0; corner < 4; corner++) {
+				const glm::vec2 uv(corner & 1, corner >> 1);
+				vertices[corner].position = glm::vec4((uv.x - 0.5f) * size, 0.0f, (uv.y - 0.5f) * size, 1.0f);
+				vertices[corner].normal = glm::vec4(0.0f, facesDown ? 1.0f : -1.0f, 0.0f, 0.0f);
+				vertices[corner].tangent = glm::vec4(1.0f, 0.0f, 0.0f, 1.0f);
+				vertices[corner].uv = glm::vec4(uv, 0.0f, 0.0f);
+			}
+			meshes.push_back(ReferenceScene::createMeshData(std::move(vertices), { 0, 1, 3, 0, 3, 2 }));
+
+			ReferenceScene::MaterialData& material = materials.emplace_back();
+			const bool isEmissive = emissiveColor.a > 0.0f;
+			if (isEmissive) {
+				material.emissiveMap = &white;
+				material.emissiveColor = emissiveColor;
+			}
+
+			const glm::mat4 transform = glm::translate(glm::mat4(1.0f), position);
+			scene.addInstance({ meshes.back().get(), &material, transform, glm::inverse(transform), glm::vec3(1.0f), 1.0f }, isEmissive);
+		}
+
+		/**
+		 * @brief Builds the scene, the camera looks at the origin from position.
+		 */
+		void build(const glm::vec3& cameraPosition) {
+			scene.build();
+
+			// -y is up, as the default up vector of the camera
+			camera.setPerspective(glm::radians(50.0f), 1.0f, 0.1f, 100.0f);
+			camera.setViewTarget(cameraPosition, glm::vec3(0.0f));
+		}
+	};
+
+	/**
+	 * @brief The soft shadow of a blocker under a large light, the camera sees its edges and the penumbra.
+	 */
+	inline void buildSoftShadowScene(QuadScene& shadows) {
+		shadows.addQuad(12.0f, false, glm::vec3(0.0f));
+		shadows.addQuad(2.0f, false, glm::vec3(0.5f, -1.0f, 0.0f));
+		shadows.addQuad(2.5f, true, glm::vec3(0.0f, -4.0f, 0.0f), glm::vec4(1.0f, 1.0f, 1.0f, 8.0f));
+		shadows.build(glm::vec3(0.0f, -6.0f, -6.0f));
+	}
+}
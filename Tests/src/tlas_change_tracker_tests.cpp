@@ -0,0 +1,190 @@
+#include "test_framework.hpp"
+
+#include "graphics/resources/tlas_change_tracker.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	struct TestInstance {
+		uint64_t key;
+		glm::mat4 transform{ 1.0f };
+		uint64_t geometry = 1;
+		uint64_t content = 1;
+	};
+
+	struct WalkResult {
+		// the slots refreshed on the CPU during the walk (track returned true)
+		std::vector<uint32_t> trackedSlots;
+		// the slots the consumer rewrites, and if it can refit
+		std::vector<uint32_t> rewrittenSlots;
+		bool canRefit;
+	};
+
+	/**
+	 * @brief Walks the instances like RayTracingSceneManagerSystem, then syncs a consumer last synced at since.
+	 */
+	WalkResult walk(TLASChangeTracker& tracker, const std::vector<TestInstance>& instances, const uint64_t since) {
+		WalkResult result;
+
+		tracker.beginWalk();
+		for (uint32_t slot = 0; slot < instances.size(); slot++) {
+			const TestInstance& instance = instances[slot];
+			if (tracker.track(instance.key, instance.transform, instance.geometry, instance.content)) {
+				result.trackedSlots.push_back(slot);
+			}
+		}
+		tracker.endWalk();
+
+		result.canRefit = tracker.collectChangedSlots(since, result.rewrittenSlots);
+		return result;
+	}
+
+	std::vector<TestInstance> makeScene() {
+		return { { 10 }, { 11 }, { 12 }, { 13 } };
+	}
+}
+
+PXT_TEST(tlasTrackerFirstWalkRewritesEverySlot) {
+	TLASChangeTracker tracker;
+
+	const WalkResult result = walk(tracker, makeScene(), 0);
+
+	PXT_CHECK(!result.canRefit);
+	PXT_CHECK_EQ(result.trackedSlots, (std::vector<uint32_t>{ 0, 1, 2, 3 }));
+	PXT_CHECK_EQ(result.rewrittenSlots, (std::vector<uint32_t>{ 0, 1, 2, 3 }));
+	PXT_CHECK_EQ(tracker.getInstanceCount(), 4u);
+}
+
+PXT_TEST(tlasTrackerUnchangedWalkRewritesNothing) {
+	TLASChangeTracker tracker;
+	std::vector<TestInstance> scene = makeScene();
+
+	walk(tracker, scene, 0);
+	const uint64_t synced = tracker.getGeneration();
+	const uint64_t lastChange = tracker.getLastChangeGeneration();
+
+	const WalkResult result = walk(tracker, scene, synced);
+
+	PXT_CHECK(result.canRefit);
+	PXT_CHECK(result.trackedSlots.empty());
+	PXT_CHECK(result.rewrittenSlots.empty());
+	PXT_CHECK_EQ(tracker.getLastChangeGeneration(), lastChange);
+}
+
+PXT_TEST(tlasTrackerAddRebuildsWithEverySlot) {
+	TLASChangeTracker tracker;
+	std::vector<TestInstance> scene = makeScene();
+
+	walk(tracker, scene, 0);
+	const uint64_t synced = tracker.getGeneration();
+
+	scene.push_back({ 14 });
+	const WalkResult result = walk(tracker, scene, synced);
+
+	// only the new slot is refreshed, but the instance count changed so the TLAS is rebuilt
+	PXT_CHECK(!result.canRefit);
+	PXT_CHECK_EQ(result.trackedSlots, (std::vector<uint32_t>{ 4 }));
+	PXT_CHECK_EQ(result.rewrittenSlots, (std::vector<uint32_t>{ 0, 1, 2, 3, 4 }));
+	PXT_CHECK_EQ(tracker.getStructureGeneration(), tracker.getGeneration());
+}
+
+PXT_TEST(tlasTrackerRemoveRebuildsWithEverySlot) {
+	TLASChangeTracker tracker;
+	std::vector<TestInstance> scene = makeScene();
+
+	walk(tracker, scene, 0);
+	const uint64_t synced = tracker.getGeneration();
+
+	// the instances after the removed one shift down a slot
+	scene.erase(scene.begin() + 1);
+	const WalkResult result = walk(tracker, scene, synced);
+
+	PXT_CHECK(!result.canRefit);
+	PXT_CHECK_EQ(result.trackedSlots, (std::vector<uint32_t>{ 1, 2 }));
+	PXT_CHECK_EQ(result.rewrittenSlots, (std::vector<uint32_t>{ 0, 1, 2 }));
+	PXT_CHECK_EQ(tracker.getInstanceCount(), 3u);
+}
+
+PXT_TEST(tlasTrackerRemoveLastRebuilds) {
+	TLASChangeTracker tracker;
+	std::vector<TestInstance> scene = makeScene();
+
+	walk(tracker, scene, 0);
+	const uint64_t synced = tracker.getGeneration();
+
+	scene.pop_back();
+	const WalkResult result = walk(tracker, scene, synced);
+
+	// no remaining slot changed, the TLAS is rebuilt for the smaller count
+	PXT_CHECK(!result.canRefit);
+	PXT_CHECK(result.trackedSlots.empty());
+	PXT_CHECK_EQ(result.rewrittenSlots, (std::vector<uint32_t>{ 0, 1, 2 }));
+}
+
+PXT_TEST(tlasTrackerMoveRefitsItsSlot) {
+	TLASChangeTracker tracker;
+	std::vector<TestInstance> scene = makeScene();
+
+	walk(tracker, scene, 0);
+	const uint64_t synced = tracker.getGeneration();
+
+	scene[2].transform = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	const WalkResult result = walk(tracker, scene, synced);
+
+	PXT_CHECK(result.canRefit);
+	PXT_CHECK_EQ(result.trackedSlots, (std::vector<uint32_t>{ 2 }));
+	PXT_CHECK_EQ(result.rewrittenSlots, (std::vector<uint32_t>{ 2 }));
+}
+
+PXT_TEST(tlasTrackerMaterialChangeRefitsItsSlot) {
+	TLASChangeTracker tracker;
+	std::vector<TestInstance> scene = makeScene();
+
+	walk(tracker, scene, 0);
+	const uint64_t synced = tracker.getGeneration();
+
+	scene[1].content = 2;
+	const WalkResult result = walk(tracker, scene, synced);
+
+	PXT_CHECK(result.canRefit);
+	PXT_CHECK_EQ(result.trackedSlots, (std::vector<uint32_t>{ 1 }));
+	PXT_CHECK_EQ(result.rewrittenSlots, (std::vector<uint32_t>{ 1 }));
+}
+
+PXT_TEST(tlasTrackerMeshChangeRebuilds) {
+	TLASChangeTracker tracker;
+	std::vector<TestInstance> scene = makeScene();
+
+	walk(tracker, scene, 0);
+	const uint64_t synced = tracker.getGeneration();
+
+	scene[3].geometry = 2;
+	const WalkResult result = walk(tracker, scene, synced);
+
+	PXT_CHECK(!result.canRefit);
+	PXT_CHECK_EQ(result.trackedSlots, (std::vector<uint32_t>{ 3 }));
+	PXT_CHECK_EQ(result.rewrittenSlots, (std::vector<uint32_t>{ 0, 1, 2, 3 }));
+}
+
+PXT_TEST(tlasTrackerFramesCatchUpFromTheirGeneration) {
+	TLASChangeTracker tracker;
+	std::vector<TestInstance> scene = makeScene();
+
+	walk(tracker, scene, 0);
+	const uint64_t frameA = tracker.getGeneration();
+
+	// frame B syncs after a first move
+	scene[0].transform = glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+	walk(tracker, scene, frameA);
+	const uint64_t frameB = tracker.getGeneration();
+
+	scene[3].transform = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	const WalkResult result = walk(tracker, scene, frameB);
+	PXT_CHECK_EQ(result.rewrittenSlots, (std::vector<uint32_t>{ 3 }));
+
+	// frame A missed both moves
+	std::vector<uint32_t> slots;
+	PXT_CHECK(tracker.collectChangedSlots(frameA, slots));
+	PXT_CHECK_EQ(slots, (std::vector<uint32_t>{ 0, 3 }));
+}
@@ -0,0 +1,151 @@
+#include "test_framework.hpp"
+
+#include "graphics/memory/tlsf_allocator.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	/**
+	 * @brief Checks that no two live ranges overlap and that they all lie inside the block.
+	 */
+	void checkNoOverlap(const std::vector<TlsfAllocator::Allocation>& allocations, const uint64_t blockSize) {
+		std::vector<TlsfAllocator::Allocation> sorted = allocations;
+		std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.offset < b.offset; });
+
+		for (size_t i = 0; i < sorted.size(); i++) {
+			PXT_CHECK(sorted[i].offset + sorted[i].size <= blockSize);
+			if (i > 0) {
+				PXT_CHECK(sorted[i - 1].offset + sorted[i - 1].size <= sorted[i].offset);
+			}
+		}
+	}
+}
+
+PXT_TEST(tlsfAllocatorRespectsTheAlignment) {
+	TlsfAllocator allocator(1 << 20);
+
+	// an odd size first, so that the next offsets are misaligned unless the allocator pads them
+	const TlsfAllocator::Allocation first = allocator.allocate(13);
+	PXT_CHECK(first.isValid());
+
+	for (const uint64_t alignment : { 1ull, 4ull, 16ull, 256ull, 4096ull, 65536ull }) {
+		const TlsfAllocator::Allocation allocation = allocator.allocate(100, alignment);
+		PXT_CHECK(allocation.isValid());
+		PXT_CHECK_EQ(allocation.offset % alignment, 0ull);
+		PXT_CHECK(allocation.size >= 100);
+	}
+}
+
+PXT_TEST(tlsfAllocatorReturnsInvalidWhenFull) {
+	TlsfAllocator allocator(1024);
+
+	PXT_CHECK(!allocator.allocate(2048).isValid());
+
+	const TlsfAllocator::Allocation whole = allocator.allocate(1024);
+	PXT_CHECK(whole.isValid());
+	PXT_CHECK_EQ(allocator.getFreeSize(), 0ull);
+	PXT_CHECK(!allocator.allocate(1).isValid());
+
+	allocator.free(whole);
+	PXT_CHECK(allocator.isEmpty());
+	PXT_CHECK(allocator.allocate(1024).isValid());
+}
+
+PXT_TEST(tlsfAllocatorMergesTheFreedNeighbours) {
+	constexpr uint64_t blockSize = 64 * 1024;
+	TlsfAllocator allocator(blockSize);
+
+	std::vector<TlsfAllocator::Allocation> allocations;
+	for (uint32_t i = 0; i < 64; i++) {
+		allocations.push_back(allocator.allocate(1024));
+		PXT_CHECK(allocations.back().isValid());
+	}
+	PXT_CHECK(!allocator.allocate(1).isValid());
+
+	// every other range first, then the rest: the holes only fit the whole block once merged
+	for (size_t i = 0; i < allocations.size(); i += 2) {
+		allocator.free(allocations[i]);
+	}
+	PXT_CHECK(!allocator.allocate(2048).isValid());
+
+	for (size_t i = 1; i < allocations.size(); i += 2) {
+		allocator.free(allocations[i]);
+	}
+
+	PXT_CHECK(allocator.isEmpty());
+	PXT_CHECK_EQ(allocator.getFreeSize(), blockSize);
+
+	const TlsfAllocator::Allocation whole = allocator.allocate(blockSize);
+	PXT_CHECK(whole.isValid());
+	PXT_CHECK_EQ(whole.offset, 0ull);
+}
+
+PXT_TEST(tlsfAllocatorRandomChurnNeverOverlaps) {
+	constexpr uint64_t blockSize = 4 * 1024 * 1024;
+	TlsfAllocator allocator(blockSize);
+
+	// the managed memory, every live range is stamped with its own id to catch overlaps
+	std::vector<uint32_t> memory(blockSize / sizeof(uint32_t), 0);
+	std::vector<TlsfAllocator::Allocation> allocations;
+	std::vector<uint32_t> ids;
+
+	const auto stamp = [&](const TlsfAllocator::Allocation& allocation, const uint32_t id) {
+		std::fill_n(memory.begin() + allocation.offset / sizeof(uint32_t), allocation.size / sizeof(uint32_t), id);
+	};
+	const auto isStamped = [&](const TlsfAllocator::Allocation& allocation, const uint32_t id) {
+		const auto begin = memory.begin() + allocation.offset / sizeof(uint32_t);
+		return std::all_of(begin, begin + allocation.size / sizeof(uint32_t), [&](const uint32_t value) { return value == id; });
+	};
+
+	std::mt19937 random(42);
+	uint32_t nextId = 1;
+
+	for (uint32_t step = 0; step < 20000; step++) {
+		const bool shouldAllocate = allocations.empty() || random() % 100 < 55;
+
+		if (shouldAllocate) {
+			const uint64_t size = (1 + random() % 1024) * sizeof(uint32_t) * (random() % 8 == 0 ? 16 : 1);
+			const uint64_t alignment = uint64_t{ sizeof(uint32_t) } << (random() % 8);
+
+			const TlsfAllocator::Allocation allocation = allocator.allocate(size, alignment);
+			if (!allocation.isValid()) continue;
+
+			PXT_CHECK_EQ(allocation.offset % alignment, 0ull);
+			PXT_CHECK(allocation.size >= size);
+
+			stamp(allocation, nextId);
+			allocations.push_back(allocation);
+			ids.push_back(nextId++);
+		} else {
+			const size_t index = random() % allocations.size();
+
+			// nobody wrote over the range while it was alive
+			PXT_CHECK(isStamped(allocations[index], ids[index]));
+
+			allocator.free(allocations[index]);
+			allocations[index] = allocations.back();
+			ids[index] = ids.back();
+			allocations.pop_back();
+			ids.pop_back();
+		}
+	}
+
+	checkNoOverlap(allocations, blockSize);
+	for (size_t i = 0; i < allocations.size(); i++) {
+		PXT_CHECK(isStamped(allocations[i], ids[i]));
+	}
+
+	uint64_t usedSize = 0;
+	for (const TlsfAllocator::Allocation& allocation : allocations) {
+		usedSize += allocation.size;
+	}
+	PXT_CHECK_EQ(allocator.getAllocationCount(), static_cast<uint32_t>(allocations.size()));
+	PXT_CHECK_EQ(allocator.getFreeSize(), blockSize - usedSize);
+
+	for (const TlsfAllocator::Allocation& allocation : allocations) {
+		allocator.free(allocation);
+	}
+	PXT_CHECK(allocator.isEmpty());
+	PXT_CHECK(allocator.allocate(blockSize).isValid());
+}
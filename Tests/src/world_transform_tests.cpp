@@ -0,0 +1,201 @@
+#include "test_framework.hpp"
+
+#include "scene/scene.hpp"
+#include "scene/ecs/entity.hpp"
+#include "scene/ecs/component.hpp"
+#include "scene/ecs/world_transform_system.hpp"
+#include "scene/spatial/simd.hpp"
+
+using namespace PXTEngine;
+
+namespace {
+
+	// the kernel and TransformComponent::mat4() evaluate the same products, only sin and cos differ
+	constexpr float MATRIX_TOLERANCE = 1e-5f;
+
+	std::vector<TransformComponent> makeTransforms(const size_t count, const uint32_t seed) {
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> translation(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> rotation(-10.0f, 10.0f);
+		std::uniform_real_distribution<float> scale(0.1f, 4.0f);
+
+		std::vector<TransformComponent> transforms(count);
+		for (TransformComponent& transform : transforms) {
+			transform.translation = { translation(random), translation(random), translation(random) };
+			transform.rotation = { rotation(random), rotation(random), rotation(random) };
+			transform.scale = { scale(random), scale(random), scale(random) };
+		}
+		return transforms;
+	}
+
+	/**
+	 * @brief Runs the SIMD kernel over the transforms, in a single call like update() below the parallel threshold.
+	 */
+	std::vector<WorldTransformComponent> computeWorldTransforms(const std::vector<TransformComponent>& transforms) {
+		WorldTransformSystem::TransformBatch batch;
+		batch.resize(transforms.size());
+		for (size_t i = 0; i < transforms.size(); i++) {
+			batch.set(i, transforms[i].translation, transforms[i].rotation, transforms[i].scale);
+		}
+
+		std::vector<WorldTransformComponent> worldTransforms(transforms.size());
+		std::vector<WorldTransformComponent*> outputs;
+		for (WorldTransformComponent& worldTransform : worldTransforms) {
+			outputs.push_back(&worldTransform);
+		}
+
+		WorldTransformSystem::computeWorldTransforms(batch, 0, transforms.size(), outputs);
+		return worldTransforms;
+	}
+
+	template <int C, int R>
+	float maxDifference(const glm::mat<C, R, float>& a, const glm::mat<C, R, float>& b) {
+		float difference = 0.0f;
+		for (int column = 0; column < C; column++) {
+			for (int row = 0; row < R; row++) {
+				difference = std::max(difference, std::abs(a[column][row] - b[column][row]));
+			}
+		}
+		return difference;
+	}
+
+	const char* getSimdBackendName() {
+#if defined(PXT_SIMD_AVX2)
+		return "AVX2";
+#elif defined(PXT_SIMD_SSE)
+		return "SSE2";
+#else
+		return "scalar";
+#endif
+	}
+}
+
+PXT_TEST(simdSincosIsWithinItsErrorBound) {
+	// a few turns each way, the range the transform rotations stay in
+	constexpr uint32_t sampleCount = 1 << 16;
+	constexpr double range = 20.0;
+
+	std::array<float, SIMD_WIDTH> angles;
+	std::array<float, SIMD_WIDTH> sines;
+	std::array<float, SIMD_WIDTH> cosines;
+	double maxError = 0.0;
+
+	for (uint32_t first = 0; first < sampleCount; first += SIMD_WIDTH) {
+		for (uint32_t lane = 0; lane < SIMD_WIDTH; lane++) {
+			angles[lane] = static_cast<float>(-range + 2.0 * range * (first + lane) / (sampleCount - 1));
+		}
+
+		SimdFloat sine, cosine;
+		sincos(SimdFloat::load(angles.data()), sine, cosine);
+		sine.store(sines.data());
+		cosine.store(cosines.data());
+
+		for (uint32_t lane = 0; lane < SIMD_WIDTH; lane++) {
+			const double angle = angles[lane];
+			maxError = std::max(maxError, std::abs(sines[lane] - std::sin(angle)));
+			maxError = std::max(maxError, std::abs(cosines[lane] - std::cos(angle)));
+		}
+	}
+
+	Tests::report(std::format("{} sincos max error {:.3g}", getSimdBackendName(), maxError));
+	PXT_CHECK(maxError <= 1e-6);
+}
+
+PXT_TEST(worldTransformKernelMatchesTransformComponent) {
+	// not a multiple of SIMD_WIDTH, so that the last group is partial
+	std::vector<TransformComponent> transforms = makeTransforms(8 * 37 + 3, 1);
+	transforms[0] = TransformComponent{};
+	transforms[1] = TransformComponent({ 1.0f, 2.0f, 3.0f }, { 2.0f, 0.5f, 1.0f }, { glm::half_pi<float>(), 0.0f, glm::pi<float>() });
+
+	const std::vector<WorldTransformComponent> worldTransforms = computeWorldTransforms(transforms);
+
+	for (size_t i = 0; i < transforms.size(); i++) {
+		TransformComponent& transform = transforms[i];
+		const WorldTransformComponent& worldTransform = worldTransforms[i];
+
+		// the translation is copied, the error of the other elements grows with the scale
+		const float scale = std::max({ transform.scale.x, transform.scale.y, transform.scale.z, 1.0f });
+		PXT_CHECK(maxDifference(worldTransform.matrix, transform.mat4()) <= MATRIX_TOLERANCE * scale);
+		PXT_CHECK(maxDifference(worldTransform.normalMatrix, transform.normalMatrix()) <= MATRIX_TOLERANCE / glm::min(transform.scale.x, glm::min(transform.scale.y, transform.scale.z)));
+	}
+}
+
+PXT_TEST(worldTransformInverseTimesModelIsIdentity) {
+	const std::vector<TransformComponent> transforms = makeTransforms(8 * 16 + 5, 2);
+	const std::vector<WorldTransformComponent> worldTransforms = computeWorldTransforms(transforms);
+
+	float maxError = 0.0f;
+	for (const WorldTransformComponent& worldTransform : worldTransforms) {
+		maxError = std::max(maxError, maxDifference(worldTransform.inverse * worldTransform.matrix, glm::mat4(1.0f)));
+		maxError = std::max(maxError, maxDifference(worldTransform.matrix * worldTransform.inverse, glm::mat4(1.0f)));
+	}
+
+	Tests::report(std::format("{} inverse * model max error {:.3g}", getSimdBackendName(), maxError));
+	PXT_CHECK(maxError <= 1e-4f);
+}
+
+PXT_TEST(worldTransformDetectsInPlaceWrites) {
+	Scene scene;
+	Entity moving = scene.createEntity("moving");
+	moving.add<TransformComponent>(glm::vec3(1.0f, 0.0f, 0.0f));
+	Entity fixed = scene.createEntity("fixed");
+	fixed.add<TransformComponent>(glm::vec3(0.0f, 1.0f, 0.0f));
+
+	const WorldTransformSystem& system = scene.getWorldTransformSystem();
+
+	// a new transform is computed once
+	PXT_CHECK(moving.has<WorldTransformComponent>());
+	scene.updateWorldTransforms();
+	PXT_CHECK_EQ(system.getUpdatedCount(), 2u);
+	scene.updateWorldTransforms();
+	PXT_CHECK_EQ(system.getUpdatedCount(), 0u);
+
+	// the scripts write the transforms in place, through Entity::get
+	moving.get<TransformComponent>().translation.y = 5.0f;
+	scene.updateWorldTransforms();
+	PXT_CHECK_EQ(system.getUpdatedCount(), 1u);
+	PXT_CHECK(maxDifference(moving.get<WorldTransformComponent>().matrix, moving.get<TransformComponent>().mat4()) <= MATRIX_TOLERANCE);
+
+	moving.get<TransformComponent>().rotation.z = 1.0f;
+	scene.updateWorldTransforms();
+	PXT_CHECK_EQ(system.getUpdatedCount(), 1u);
+
+	moving.get<TransformComponent>().scale.x = 2.0f;
+	scene.updateWorldTransforms();
+	PXT_CHECK_EQ(system.getUpdatedCount(), 1u);
+	PXT_CHECK(maxDifference(moving.get<WorldTransformComponent>().matrix, moving.get<TransformComponent>().mat4()) <= MATRIX_TOLERANCE);
+
+	// writing back the same value is not a change
+	moving.get<TransformComponent>().scale.x = 2.0f;
+	scene.updateWorldTransforms();
+	PXT_CHECK_EQ(system.getUpdatedCount(), 0u);
+
+	// the cached matrices follow the transform component
+	fixed.remove<TransformComponent>();
+	PXT_CHECK(!fixed.has<WorldTransformComponent>());
+	fixed.add<TransformComponent>(glm::vec3(0.0f, 2.0f, 0.0f));
+	scene.updateWorldTransforms();
+	PXT_CHECK_EQ(system.getUpdatedCount(), 1u);
+	PXT_CHECK_EQ(fixed.get<WorldTransformComponent>().matrix[3], glm::vec4(0.0f, 2.0f, 0.0f, 1.0f));
+}
+
+PXT_TEST(worldTransformParallelUpdateMatchesTransformComponent) {
+	// above the parallel threshold, the jobs split the batch on SIMD groups
+	Scene scene;
+	std::vector<Entity> entities;
+	const std::vector<TransformComponent> transforms = makeTransforms(10000 + 3, 3);
+	for (const TransformComponent& transform : transforms) {
+		Entity entity = scene.createEntity();
+		entity.add<TransformComponent>(transform);
+		entities.push_back(entity);
+	}
+
+	scene.updateWorldTransforms();
+	PXT_CHECK_EQ(scene.getWorldTransformSystem().getUpdatedCount(), static_cast<uint32_t>(entities.size()));
+
+	for (Entity& entity : entities) {
+		TransformComponent& transform = entity.get<TransformComponent>();
+		const float scale = std::max({ transform.scale.x, transform.scale.y, transform.scale.z, 1.0f });
+		PXT_CHECK(maxDifference(entity.get<WorldTransformComponent>().matrix, transform.mat4()) <= MATRIX_TOLERANCE * scale);
+	}
+}
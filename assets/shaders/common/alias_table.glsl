@@ -0,0 +1,12 @@
+#ifndef _ALIAS_TABLE_
+#define _ALIAS_TABLE_
+
+// Entry of a Walker alias table: entry i keeps i with the given probability, otherwise it gives the alias.
+// pdf is the probability of sampling the element i.
+struct AliasTableEntry {
+    float probability;
+    uint alias;
+    float pdf;
+};
+
+#endif
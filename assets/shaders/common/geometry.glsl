@@ -17,21 +17,20 @@ struct Triangle {
 };
 
 /**
- * References of the vertex buffers.
- * It can be used to access vertex data using the buffer address (uint64_t)
+ * Vertex buffer of the geometry arena, shared by every mesh (binding 1 of the mesh instances set).
+ * A mesh starts at its firstVertex, its indices are relative to it.
  */
-layout(buffer_reference, buffer_reference_align = 16, std430) readonly buffer VertexBuffer {
+layout(set = 6, binding = 1, std430) readonly buffer vertexArenaSSBO {
     Vertex v[];
-};
+} vertexArena;
 
 /**
- * References of the index buffers.
- * It can be used to access index data using the buffer address (uint64_t)
+ * Index buffer of the geometry arena, shared by every mesh (binding 2 of the mesh instances set).
  * The indices are stored as uint32 values, and each triangle is represented by 3 indices.
  */
-layout(buffer_reference, buffer_reference_align = 16, std430) readonly buffer IndexBuffer {
+layout(set = 6, binding = 2, std430) readonly buffer indexArenaSSBO {
     uint i[];
-};
+} indexArena;
 
 /*vec3 tangentToWorld(mat3 TBN, vec3 tangentVector) {
     return normalize(TBN * tangentVector);
@@ -41,20 +40,17 @@ vec3 worldToTangent(mat3 TBN, vec3 worldVector) {
     return normalize(transpose(TBN) * worldVector);
 }*/
 
-Triangle getTriangle(uint64_t indexAddress, uint64_t vertexAddress, uint faceIndex) {
-    IndexBuffer indices = IndexBuffer(indexAddress);
-    VertexBuffer vertices = VertexBuffer(vertexAddress);
-
+Triangle getTriangle(uint firstIndex, uint firstVertex, uint faceIndex) {
     // Retrieve the indices of the triangle being hit.
-    uint i0 = indices.i[faceIndex * 3 + 0];
-    uint i1 = indices.i[faceIndex * 3 + 1];
-    uint i2 = indices.i[faceIndex * 3 + 2];
+    uint i0 = indexArena.i[firstIndex + faceIndex * 3 + 0];
+    uint i1 = indexArena.i[firstIndex + faceIndex * 3 + 1];
+    uint i2 = indexArena.i[firstIndex + faceIndex * 3 + 2];
 
     Triangle triangle;
     // Retrieve the vertices of the triangle using the indices.
-    triangle.v0 = vertices.v[i0];
-    triangle.v1 = vertices.v[i1];
-    triangle.v2 = vertices.v[i2];
+    triangle.v0 = vertexArena.v[firstVertex + i0];
+    triangle.v1 = vertexArena.v[firstVertex + i1];
+    triangle.v2 = vertexArena.v[firstVertex + i2];
 
     return triangle;
 }
@@ -59,6 +59,45 @@ float maxComponent(vec3 v) {
     return max(max(v.r, v.g), v.b);
 }
 
+/**
+ * @brief Calculates the luminance of a given color.
+ *
+ * This function converts an RGB color to a single luminance value,
+ * which can be useful for weighting or perceptual calculations.
+ * Uses standard ITU-R BT.709 coefficients.
+ *
+ * @param color The input vec3 color in RGB space.
+ * @return The luminance value of the color.
+ */
+float luminance(vec3 color) {
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+/**
+ * Power Heuristic for combining multiple sampling strategies.
+ * This heuristic is used to balance the contributions of different sampling methods
+ * based on their probability density functions (PDFs).
+ * 
+ * The generic power heurisitc is: w_i = pow(pdf_i, beta) / sum(pow(pdf_j, beta))
+ *
+ * The power heuristic, particularly with beta=2 was extensively studied and empirically shown to be 
+ * highly effective by Eric Veach in his Ph.D. thesis. 
+ * While not always strictly "optimal" in a mathematical sense for every single scenario, it provides
+ * a very robust and generally well-performing solution across a wide range of rendering situations.
+ * @see https://graphics.stanford.edu/papers/veach_thesis/thesis.pdf
+ *
+ * @param pdfA The PDF of the first sampling method.
+ * @param pdfB The PDF of the second sampling method.
+
+ * @return The weight for the first sampling method.
+ */
+float powerHeuristic(float pdfA, float pdfB) {
+    const float pdfASq = pow2(pdfA);
+    const float pdfBSq = pow2(pdfB);
+
+    return pdfASq / (pdfASq + pdfBSq);
+}
+
 vec2 barycentricLerp(vec2 a, vec2 b, vec2 c, vec2 barycentrics) {
     const float bZ = (1.0 - barycentrics.x - barycentrics.y);
     return bZ * a + barycentrics.x * b + barycentrics.y * c;
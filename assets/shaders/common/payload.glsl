@@ -27,7 +27,20 @@ struct PathTracePayload {
     // A seed for the random number generator, updated at each bounce.
     uint seed;
 
+    // The index and next dimension of the low discrepancy sample of the path, see sampler.glsl.
+    uint sampleIndex;
+    uint sampleDimension;
+
     bool isSpecularBounce;
+
+    // The pdf of the BSDF sample that gave the current direction, to weight the sky against its explicit samples.
+    float bsdfPdf;
+
+    // Features of the primary hit written for the denoiser: shading normal and albedo in world space,
+    // distance along the camera ray (0 if the camera ray missed).
+    vec3 primaryNormal;
+    float primaryDistance;
+    vec3 primaryAlbedo;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef _SAMPLER_
+#define _SAMPLER_
+
+#include "../ubo/global_ubo.glsl"
+#include "random.glsl"
+
+// Low discrepancy sampler: the dimensions of a path read an Owen scrambled Sobol table, shifted per pixel
+// by a blue noise threshold so that the error of neighbouring pixels is spread to high frequencies.
+// Dimensions past the table fall back to the white noise generator of random.glsl.
+
+// R2 sequence, offsets the blue noise of every dimension to decorrelate them
+#define SAMPLER_R2_OFFSET vec2(0.75487766624, 0.56984029099)
+
+// Tileable blue noise thresholds, 16 bits split in the red (high byte) and green (low byte) channels
+layout(set = 8, binding = 0) uniform sampler2D blueNoiseSampler;
+
+// Samples stored sample by sample as 32 bit fixed point values in [0, 1)
+layout(set = 8, binding = 1, std430) readonly buffer sobolSSBO {
+    uint sampleCount;
+    uint dimensionCount;
+    uint samples[];
+} sobol;
+
+/**
+ * Returns the index of the sample of the current frame, restarting with the accumulation
+ * so that the accumulated samples are the stratified prefixes of the sequence.
+ */
+uint getSampleIndex() {
+    return ubo.accumulationEnabled ? ubo.ptAccumulationCount : ubo.frameCount;
+}
+
+/**
+ * Returns the blue noise threshold of a pixel for a dimension, as a 32 bit fixed point value.
+ */
+uint blueNoiseThreshold(uvec2 pixel, uint dimension) {
+    const ivec2 size = textureSize(blueNoiseSampler, 0);
+    const ivec2 offset = ivec2(fract(float(dimension) * SAMPLER_R2_OFFSET) * vec2(size));
+    const ivec2 texel = (ivec2(pixel) + offset) % size;
+
+    const uvec2 bytes = uvec2(texelFetch(blueNoiseSampler, texel, 0).rg * 255.0 + 0.5);
+
+    return ((bytes.x << 8) | bytes.y) << 16;
+}
+
+/**
+ * Returns the value of a dimension of a sample of a pixel, in [0, 1).
+ *
+ * The table sample is shifted (modulo 1) by the blue noise threshold of the pixel, and by a hash of
+ * the pass every time the table wraps around so that the passes don't repeat the same samples.
+ *
+ * @param seed The seed of the random number generator, used past the table dimensions.
+ */
+float sampleDimension(uvec2 pixel, uint sampleIndex, uint dimension, inout uint seed) {
+    if (dimension >= sobol.dimensionCount) {
+        return randomFloat(seed);
+    }
+
+    const uint passIndex = sampleIndex / sobol.sampleCount;
+    const uint tableSample = sobol.samples[(sampleIndex % sobol.sampleCount) * sobol.dimensionCount + dimension];
+
+    const uint value = tableSample + blueNoiseThreshold(pixel, dimension) + pcgHash(passIndex * sobol.dimensionCount + dimension);
+
+    // 24 bits keep the float strictly under 1
+    return float(value >> 8) * (1.0 / 16777216.0);
+}
+
+/**
+ * Returns the next dimension of a sample, the dimension counter is advanced.
+ */
+float sample1D(uvec2 pixel, uint sampleIndex, inout uint dimension, inout uint seed) {
+    return sampleDimension(pixel, sampleIndex, dimension++, seed);
+}
+
+/**
+ * Returns the next pair of dimensions of a sample, the dimension counter is advanced.
+ * The table pairs are stratified together, so the pair starts at an even dimension.
+ */
+vec2 sample2D(uvec2 pixel, uint sampleIndex, inout uint dimension, inout uint seed) {
+    dimension = (dimension + 1) & ~1u;
+
+    const float x = sampleDimension(pixel, sampleIndex, dimension, seed);
+    const float y = sampleDimension(pixel, sampleIndex, dimension + 1, seed);
+    dimension += 2;
+
+    return vec2(x, y);
+}
+
+#endif
@@ -11,16 +11,19 @@ layout(location = 3) in vec4 uv;
 layout(location = 0) out vec3 fragPosWorld;
 layout(location = 1) out vec3 fragLightPos;
 
+// model matrices written by ShadowMapRenderSystem, indexed by gl_InstanceIndex
+layout(set = 1, binding = 0) readonly buffer shadowInstancesSSBO {
+  mat4 modelMatrices[];
+} instances;
+
 layout(push_constant) uniform Push {
-  // it will be modified to translate the object to the light position (i think so?)
-  mat4 modelMatrix;
   // it will be modified to render the different faces
   mat4 cubeFaceView;
 } push;
 
 
 void main() {
-  vec4 posWorld = push.modelMatrix * position;
+  vec4 posWorld = instances.modelMatrices[gl_InstanceIndex] * position;
   vec4 posWorldFromLight = ubo.lightOriginModel * posWorld;
   gl_Position = ubo.projection * push.cubeFaceView * posWorldFromLight;
 
@@ -10,28 +10,38 @@ layout(location = 0) in vec3 fragPosWorld;
 layout(location = 1) in vec3 fragNormalWorld;
 layout(location = 2) in vec2 fragUV;
 layout(location = 3) in mat3 fragTBN;
+layout(location = 6) flat in uint fragInstanceIndex;
 
 layout(location = 0) out vec4 outColor;
 
 layout(set = 1, binding = 0) uniform sampler2D textures[];
 
-layout(push_constant) uniform Push {
+// DebugInstanceData of DebugRenderSystem, see debug_shader.vert
+struct DebugInstance {
 	mat4 modelMatrix;
 	mat4 normalMatrix;
-    vec4 color;
-	int enableWireframe;
-	int enableNormalsColor;
+	vec4 color;
 	int textureIndex;
 	int normalMapIndex;
 	int ambientOcclusionMapIndex;
 	float tilingFactor;
+	int normalMapChannels;
+};
+
+layout(set = 2, binding = 0) readonly buffer debugInstancesSSBO {
+	DebugInstance i[];
+} instances;
+
+layout(push_constant) uniform Push {
+	int enableWireframe;
+	int enableNormalsColor;
 } push;
 
 /*
  * Applies ambient occlusion to the given color using the ambient occlusion map.
  */
-void applyAmbientOcclusion(inout vec3 color, vec2 texCoords) {
-    float ao = texture(textures[push.ambientOcclusionMapIndex], texCoords).r;
+void applyAmbientOcclusion(inout vec3 color, vec2 texCoords, int ambientOcclusionMapIndex) {
+    float ao = texture(textures[nonuniformEXT(ambientOcclusionMapIndex)], texCoords).r;
     color *= ao;
 }
 
@@ -42,12 +52,15 @@ void main() {
         return;
     }
 
-    vec2 texCoords = fragUV * push.tilingFactor;
+    // the instances of a draw can use different textures
+    DebugInstance instance = instances.i[fragInstanceIndex];
+
+    vec2 texCoords = fragUV * instance.tilingFactor;
 
     vec3 surfaceNormal = normalize(fragNormalWorld);
 
-    if (push.normalMapIndex != -1) {
-        surfaceNormal = calculateSurfaceNormal(textures[push.normalMapIndex], texCoords, fragTBN);
+    if (instance.normalMapIndex != -1) {
+        surfaceNormal = calculateSurfaceNormal(textures[nonuniformEXT(instance.normalMapIndex)], texCoords, fragTBN, instance.normalMapChannels);
     }
 
     if (push.enableNormalsColor == 1) {
@@ -65,16 +78,16 @@ void main() {
         shininess, specularIntensity, diffuseLight, specularLight);
 
     vec3 imageColor = vec3(1.0, 1.0, 1.0); // Default color
-    if (push.textureIndex != -1) {
-        imageColor = texture(textures[push.textureIndex], texCoords).rgb;
+    if (instance.textureIndex != -1) {
+        imageColor = texture(textures[nonuniformEXT(instance.textureIndex)], texCoords).rgb;
     }
 
     // we need to add control coefficients to regulate both terms (diffuse/specular)
     // for now we use fragColor for both which is ideal for metallic objects
-    vec3 baseColor = (diffuseLight * push.color.rgb + specularLight * push.color.rgb) * imageColor;
+    vec3 baseColor = (diffuseLight * instance.color.rgb + specularLight * instance.color.rgb) * imageColor;
 
-    if (push.ambientOcclusionMapIndex != -1) {
-        applyAmbientOcclusion(baseColor, texCoords);
+    if (instance.ambientOcclusionMapIndex != -1) {
+        applyAmbientOcclusion(baseColor, texCoords, instance.ambientOcclusionMapIndex);
     }
 
     outColor = vec4(baseColor, 1.0);
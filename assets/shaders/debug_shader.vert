@@ -13,30 +13,38 @@ layout(location = 0) out vec3 fragPosWorld;
 layout(location = 1) out vec3 fragNormalWorld;
 layout(location = 2) out vec2 fragUV;
 layout(location = 3) out mat3 fragTBN;
+layout(location = 6) flat out uint fragInstanceIndex;
 
-layout(push_constant) uniform Push {
+// DebugInstanceData of DebugRenderSystem, indexed by gl_InstanceIndex
+struct DebugInstance {
 	mat4 modelMatrix;
 	mat4 normalMatrix;
 	vec4 color;
-	int enableWireframe;
-	int enableNormalsColor;
 	int textureIndex;
 	int normalMapIndex;
 	int ambientOcclusionMapIndex;
 	float tilingFactor;
-} push;
+	int normalMapChannels;
+};
+
+layout(set = 2, binding = 0) readonly buffer debugInstancesSSBO {
+	DebugInstance i[];
+} instances;
 
 
 void main() {
-	vec4 positionWorld = push.modelMatrix * position;
+	DebugInstance instance = instances.i[gl_InstanceIndex];
+
+	vec4 positionWorld = instance.modelMatrix * position;
 	gl_Position = ubo.projectionMatrix * ubo.viewMatrix * positionWorld;
  
-	mat3 TBN = calculateTBN(normal, tangent, mat3(push.normalMatrix));
+	mat3 TBN = calculateTBN(normal, tangent, mat3(instance.normalMatrix));
 
-	vec3 worldNormal = normalize(vec3(push.normalMatrix * normal));
+	vec3 worldNormal = normalize(vec3(instance.normalMatrix * normal));
 
 	fragPosWorld = positionWorld.xyz;
 	fragNormalWorld = worldNormal;
 	fragUV = uv.xy;
 	fragTBN = TBN;
+	fragInstanceIndex = gl_InstanceIndex;
 }
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef _SVGF_
+#define _SVGF_
+
+#include "../common/math.glsl"
+
+// Spatiotemporal variance-guided filtering (Schied et al. 2017) of the path traced image.
+// The radiance is demodulated by the albedo of the primary hit, accumulated over time with reprojection,
+// then filtered by a few iterations of an edge-avoiding a-trous wavelet guided by its variance.
+
+#define SVGF_WORKGROUP_SIZE 8
+
+// under this number of frames of history the variance is estimated spatially
+#define SVGF_MIN_HISTORY_LENGTH 4.0
+
+layout(local_size_x = SVGF_WORKGROUP_SIZE, local_size_y = SVGF_WORKGROUP_SIZE) in;
+
+// Written by pathtracing.rgen
+layout(set = 0, binding = 0, rgba16f) uniform readonly image2D radianceImage;
+layout(set = 0, binding = 1, rgba16f) uniform readonly image2D normalDepthImage;  // world normal, distance (0 if none)
+layout(set = 0, binding = 2, rgba8) uniform readonly image2D albedoImage;
+layout(set = 0, binding = 3, rgba16f) uniform readonly image2D motionImage;       // offset to the previous pixel
+
+// History of the previous frame
+layout(set = 0, binding = 4, rgba16f) uniform image2D previousNormalDepthImage;
+layout(set = 0, binding = 5, rgba16f) uniform image2D historyColorImage;          // demodulated color
+layout(set = 0, binding = 6, rgba16f) uniform image2D historyMomentsImage;        // luminance moments, history length
+
+// Moments of this frame, they become the history once the frame is done
+layout(set = 0, binding = 7, rgba16f) uniform image2D integratedMomentsImage;
+
+// Ping-pong images of the wavelet iterations: demodulated color and its variance
+layout(set = 0, binding = 8, rgba16f) uniform image2D filterPingImage;
+layout(set = 0, binding = 9, rgba16f) uniform image2D filterPongImage;
+
+// The scene image shown in the viewport
+layout(set = 0, binding = 10, rgba16f) uniform writeonly image2D outputImage;
+
+layout(push_constant) uniform DenoiserPushConstants {
+    int stepSize;          // distance in pixels between the taps of the wavelet iteration
+    uint readPong;         // 1 if the pass reads the pong image (and the wavelet writes the ping one)
+    uint writeHistory;     // 1 if the wavelet iteration output is the color history of the next frame
+    uint historyValid;     // 0 if the history was cleared
+    float temporalAlpha;   // minimum weight of the new frame in the color history
+    float momentsAlpha;    // minimum weight of the new frame in the moments history
+    float colorPhi;        // luminance edge stopping, in standard deviations
+    float normalPhi;       // normal edge stopping exponent
+    float depthPhi;        // relative depth edge stopping, per pixel of distance
+} pc;
+
+bool isInsideImage(ivec2 pixel, ivec2 size) {
+    return all(greaterThanEqual(pixel, ivec2(0))) && all(lessThan(pixel, size));
+}
+
+bool hasPrimaryHit(vec4 normalDepth) {
+    return normalDepth.w > 0.0;
+}
+
+vec3 demodulate(vec3 radiance, vec3 albedo) {
+    return radiance / max(albedo, vec3(1e-3));
+}
+
+/**
+ * Weight of a neighbour from the similarity of its normal and depth, shared by the spatial variance
+ * estimate and the wavelet.
+ *
+ * @param distance The distance in pixels between the two pixels.
+ */
+float geometryWeight(vec4 normalDepth, vec4 otherNormalDepth, float distance) {
+    const float normalWeight = pow(max(dot(normalDepth.xyz, otherNormalDepth.xyz), 0.0), pc.normalPhi);
+    const float depthWeight = exp(-abs(normalDepth.w - otherNormalDepth.w) / (pc.depthPhi * normalDepth.w * distance + 1e-4));
+
+    return normalWeight * depthWeight;
+}
+
+#endif
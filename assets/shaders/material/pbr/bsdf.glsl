@@ -12,20 +12,6 @@ struct SurfaceData {
     float specularProbability;
 };
 
-/**
- * @brief Calculates the luminance of a given color.
- *
- * This function converts an RGB color to a single luminance value,
- * which can be useful for weighting or perceptual calculations.
- * Uses standard ITU-R BT.709 coefficients.
- *
- * @param color The input vec3 color in RGB space.
- * @return The luminance value of the color.
- */
-float luminance(vec3 color) {
-    return dot(color, vec3(0.2126, 0.7152, 0.0722));
-}
-
 /**
  * @brief Calculates the probability of sampling a specular lobe versus a diffuse lobe.
  *
@@ -264,25 +250,25 @@ float pdfBSDF(SurfaceData surface, vec3 outLightDir, vec3 inLightDir, vec3 halfV
  * @param outLightDir The outgoing (view) direction from the surface point.
  * @param inLightDir Output: The sampled incoming light direction.
  * @param pdf Output: The PDF of the sampled direction.
- * @param seed Inout: A seed for the random number generator, updated by the function.
+ * @param lobeSample A uniform random number in [0,1) choosing the lobe.
+ * @param directionSample A vec2 with two uniform random numbers in [0,1) sampling the direction in the lobe.
  * @return The evaluated BRDF value for the sampled direction, weighted by cosine and inverse PDF.
  */
-vec3 sampleBSDF(SurfaceData surface, vec3 outLightDir, out vec3 inLightDir, out float pdf, out bool isSpecular, inout uint seed) {
+vec3 sampleBSDF(SurfaceData surface, vec3 outLightDir, out vec3 inLightDir, out float pdf, out bool isSpecular,
+    float lobeSample, vec2 directionSample) {
     // Half vector between the outgoing light direction and the incoming light direction
     vec3 halfVector;
 
-    vec3 rand3 = randomVec3(seed);
-
     isSpecular = false;
 
-    if (rand3.z < surface.specularProbability) {
+    if (lobeSample < surface.specularProbability) {
         // Sample specular reflection
-        halfVector = importanceSampleGGX(rand3.xy, surface.roughness);
+        halfVector = importanceSampleGGX(directionSample, surface.roughness);
         inLightDir = -reflect(outLightDir, halfVector);
         isSpecular = true;
     } else {
         // Sample diffuse reflection
-        inLightDir = sampleCosineWeightedHemisphere(rand3.xy);
+        inLightDir = sampleCosineWeightedHemisphere(directionSample);
         halfVector = normalize(outLightDir + inLightDir);
     }
 
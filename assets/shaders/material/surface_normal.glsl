@@ -35,18 +35,22 @@ mat3 calculateTBN(vec4 objectNormal, vec4 objectTangent, mat3 normalMatrix) {
  *
  * Samples the normal from a normal map, converts it from [0,1] to [-1,1],
  * and transforms it into world space using the TBN matrix.
+ * Two channel (BC5) normal maps only store x and y, z is then reconstructed from them.
  *
  * @param normalMap The sampler 2D normal map.
  * @param uv The texture coordinates.
  * @param TBN the Tangent-Bitangent-Normal (TBN) matrix.
+ * @param normalMapChannels The number of channels stored by the normal map.
  *
  * @return The surface normal in world space.
  */
-vec3 calculateSurfaceNormal(sampler2D normalMap, vec2 uv, mat3 TBN) {
-    vec3 normalMapValue = texture(normalMap, uv).rgb;
+vec3 calculateSurfaceNormal(sampler2D normalMap, vec2 uv, mat3 TBN, int normalMapChannels) {
+    vec3 normalMapValue = texture(normalMap, uv).rgb * 2.0 - 1.0;
 
-    // tangent space normal
-    normalMapValue = normalMapValue * 2.0 - 1.0;
+    if (normalMapChannels == 2) {
+        // tangent space normal, the normal is unit length and points out of the surface
+        normalMapValue.z = sqrt(max(1.0 - dot(normalMapValue.xy, normalMapValue.xy), 0.0));
+    }
 
     return normalize(TBN * normalMapValue);
 }
@@ -11,6 +11,8 @@ layout(location = 0) in vec3 fragPosWorld;
 layout(location = 1) in vec3 fragNormalWorld;
 layout(location = 2) in vec2 fragUV;
 layout(location = 3) in mat3 fragTBN;
+layout(location = 6) flat in uint fragMaterialIndex;
+layout(location = 7) flat in vec4 fragTint;
 
 layout(location = 0) out vec4 outColor;
 
@@ -20,47 +22,56 @@ layout(location = 0) out vec4 outColor;
 layout(set = 1, binding = 0) uniform sampler2D textures[];
 layout(set = 2, binding = 0) uniform samplerCube shadowCubeMap;
 
-layout(push_constant) uniform Push {
-    mat4 modelMatrix;
-    mat4 normalMatrix;
-    vec4 color;
-    float specularIntensity;
-    float shininess;
-    int textureIndex;
+struct Material {
+    vec4 albedoColor;
+    vec4 emissiveColor;
+    int albedoMapIndex;
     int normalMapIndex;
     int ambientOcclusionMapIndex;
     int metallicMapIndex;
-	int roughnessMapIndex;
-    float tilingFactor;
-} push;
+    int roughnessMapIndex;
+    int emissiveMapIndex;
+    int normalMapChannels; // 2 if z is not stored, see calculateSurfaceNormal
+};
+
+layout(set = 4, binding = 0) readonly buffer materialsSSBO {
+    Material m[];
+} materials;
+
+// the rasterizer has no specular term yet
+const float SPECULAR_INTENSITY = 0.0;
+const float SHININESS = 1.0;
 
 /*
  * Applies ambient occlusion to the given color using the ambient occlusion map.
  */
-void applyAmbientOcclusion(inout vec3 color, vec2 texCoords) {
-    float ao = texture(textures[push.ambientOcclusionMapIndex], texCoords).r;
+void applyAmbientOcclusion(inout vec3 color, const Material material, vec2 texCoords) {
+    float ao = texture(textures[nonuniformEXT(material.ambientOcclusionMapIndex)], texCoords).r;
     color *= ao;
 }
 
 void main() {
-    vec2 texCoords = fragUV * push.tilingFactor;
+    // instances of the same draw can have different materials
+    const Material material = materials.m[fragMaterialIndex];
+    vec2 texCoords = fragUV;
 
-    vec3 surfaceNormal = calculateSurfaceNormal(textures[push.normalMapIndex], texCoords, fragTBN);
+    vec3 surfaceNormal = calculateSurfaceNormal(textures[nonuniformEXT(material.normalMapIndex)], texCoords, fragTBN, material.normalMapChannels);
 
     vec3 cameraPosWorld = ubo.inverseViewMatrix[3].xyz;
     vec3 viewDirection = normalize(cameraPosWorld - fragPosWorld);
 
     vec3 diffuseLight, specularLight;
     computeBlinnPhongLighting(surfaceNormal, viewDirection, fragPosWorld, 
-        push.shininess, push.specularIntensity, diffuseLight, specularLight);
+        SHININESS, SPECULAR_INTENSITY, diffuseLight, specularLight);
 
-    vec3 imageColor = texture(textures[push.textureIndex], texCoords).rgb;
+    vec3 imageColor = texture(textures[nonuniformEXT(material.albedoMapIndex)], texCoords).rgb;
 
     // we need to add control coefficients to regulate both terms (diffuse/specular)
     // for now we use fragColor for both which is ideal for metallic objects
-    vec3 baseColor = (diffuseLight * push.color.rgb + specularLight * push.color.rgb) * imageColor;
+    vec3 color = material.albedoColor.rgb * fragTint.rgb;
+    vec3 baseColor = (diffuseLight * color + specularLight * color) * imageColor;
 
-    applyAmbientOcclusion(baseColor, texCoords);
+    applyAmbientOcclusion(baseColor, material, texCoords);
 
     float shadow = computeShadowFactor(shadowCubeMap, surfaceNormal, fragPosWorld);
 
@@ -14,29 +14,36 @@ layout(location = 1) out vec3 fragNormalWorld;
 layout(location = 2) out vec2 fragUV;
 layout(location = 3) out mat3 fragTBN;
 
-layout(push_constant) uniform Push {
+layout(location = 6) flat out uint fragMaterialIndex;
+layout(location = 7) flat out vec4 fragTint;
+
+// MaterialInstanceData of MaterialRenderSystem, indexed by gl_InstanceIndex
+struct MaterialInstance {
 	mat4 modelMatrix;
 	mat4 normalMatrix;
-	vec4 color;
-	float specularIntensity;
-	float shininess;
-	int textureIndex;
-	int normalMapIndex;
-	int ambientOcclusionMapIndex;
-	int metallicMapIndex;
-	int roughnessMapIndex;
+	vec4 tint;
+	uint materialIndex;
 	float tilingFactor;
-} push;
+};
+
+layout(set = 3, binding = 0) readonly buffer materialInstancesSSBO {
+	MaterialInstance i[];
+} instances;
 
 
 void main() {
-	vec4 positionWorld = push.modelMatrix * position;
+	MaterialInstance instance = instances.i[gl_InstanceIndex];
+
+	vec4 positionWorld = instance.modelMatrix * position;
 	gl_Position = ubo.projectionMatrix * ubo.viewMatrix * positionWorld;
 
-	mat3 TBN = calculateTBN(normal, tangent, mat3(push.normalMatrix));
+	mat3 TBN = calculateTBN(normal, tangent, mat3(instance.normalMatrix));
  
 	fragPosWorld = positionWorld.xyz;
 	fragNormalWorld = vec3(normal);
-	fragUV = uv.xy;
+	// the tiling scales the coordinates linearly, it can be applied before the interpolation
+	fragUV = uv.xy * instance.tilingFactor;
 	fragTBN = TBN;
+	fragMaterialIndex = instance.materialIndex;
+	fragTint = instance.tint;
 }
\ No newline at end of file
@@ -2,12 +2,21 @@
 #define _SKY_
 
 #include "../ubo/global_ubo.glsl"
+#include "../common/random.glsl"
+#include "../common/alias_table.glsl"
 
 // Enable the usage of the sky as a Next Event Estimation emitter
-#define USE_SKY_AS_NEE_EMITTER 0
+#define USE_SKY_AS_NEE_EMITTER 1
 
 layout(set = 5, binding = 0) uniform samplerCube skyboxSampler;
 
+// Every face is divided in resolution x resolution cells, the alias table picks the cells proportionally
+// to their luminance integrated over their solid angle. Cells are indexed face by face, row by row.
+layout(set = 5, binding = 1, std430) readonly buffer skyDistributionSSBO {
+    uint resolution;
+    AliasTableEntry cells[];
+} skyDistribution;
+
 vec3 getSkyRadiance(vec3 rayDir) {
 
 	vec3 skyColor = texture(skyboxSampler, rayDir).rgb;
@@ -15,4 +24,85 @@ vec3 getSkyRadiance(vec3 rayDir) {
 	return skyColor * ubo.ambientLightColor.xyz * ubo.ambientLightColor.w;
 }
 
-#endif
\ No newline at end of file
+/**
+ * Converts the probability of a sky cell to the solid angle pdf at a point of its face.
+ * The point is uniform over the cell area, the solid angle covered by a face area falls off with
+ * (1 + s^2 + t^2)^(3/2) for face coordinates (s, t).
+ *
+ * @param cellProbability The probability of the cell being sampled.
+ * @param facePoint The face coordinates of the point, in [-1, 1].
+ */
+float skyCellToSolidAnglePdf(float cellProbability, vec2 facePoint) {
+    const float cellArea = pow2(2.0 / float(skyDistribution.resolution));
+    const float distance2 = 1.0 + dot(facePoint, facePoint);
+
+    return cellProbability / cellArea * distance2 * sqrt(distance2);
+}
+
+/**
+ * Samples a direction of the sky proportionally to its luminance.
+ *
+ * @param seed The seed of the random number generator, picks the cell.
+ * @param cellPoint A vec2 with two uniform random numbers in [0,1), the point in the cell.
+ * @param pdf The solid angle pdf of the sampled direction.
+ * @return The sampled direction in world space.
+ */
+vec3 sampleSkyDirection(inout uint seed, vec2 cellPoint, out float pdf) {
+    const uint resolution = skyDistribution.resolution;
+    const uint cellCount = 6 * resolution * resolution;
+
+    uint cell = nextUint(seed, cellCount);
+    const AliasTableEntry entry = skyDistribution.cells[cell];
+    cell = randomFloat(seed) < entry.probability ? cell : entry.alias;
+
+    const uint face = cell / (resolution * resolution);
+    const vec2 cellCoords = vec2(cell % resolution, (cell / resolution) % resolution);
+
+    const vec2 st = (cellCoords + cellPoint) * (2.0 / float(resolution)) - 1.0;
+
+    pdf = skyCellToSolidAnglePdf(skyDistribution.cells[cell].pdf, st);
+
+    // inverse of the cube map face selection
+    vec3 direction;
+    switch (face) {
+        case 0: direction = vec3(1.0, -st.y, -st.x); break;
+        case 1: direction = vec3(-1.0, -st.y, st.x); break;
+        case 2: direction = vec3(st.x, 1.0, st.y); break;
+        case 3: direction = vec3(st.x, -1.0, -st.y); break;
+        case 4: direction = vec3(st.x, -st.y, 1.0); break;
+        default: direction = vec3(-st.x, -st.y, -1.0); break;
+    }
+
+    return normalize(direction);
+}
+
+/**
+ * Returns the solid angle pdf of sampling a sky direction with sampleSkyDirection.
+ *
+ * @param direction The direction in world space.
+ */
+float pdfSky(vec3 direction) {
+    const vec3 absolute = abs(direction);
+
+    // cube map face selection: the major axis picks the face, the other two components give its coordinates
+    uint face;
+    vec2 st;
+    if (absolute.x >= absolute.y && absolute.x >= absolute.z) {
+        face = direction.x >= 0.0 ? 0 : 1;
+        st = vec2(direction.x >= 0.0 ? -direction.z : direction.z, -direction.y) / absolute.x;
+    } else if (absolute.y >= absolute.z) {
+        face = direction.y >= 0.0 ? 2 : 3;
+        st = vec2(direction.x, direction.y >= 0.0 ? direction.z : -direction.z) / absolute.y;
+    } else {
+        face = direction.z >= 0.0 ? 4 : 5;
+        st = vec2(direction.z >= 0.0 ? direction.x : -direction.x, -direction.y) / absolute.z;
+    }
+
+    const uint resolution = skyDistribution.resolution;
+    const uvec2 cellCoords = min(uvec2((st + 1.0) * 0.5 * float(resolution)), uvec2(resolution - 1));
+    const uint cell = (face * resolution + cellCoords.y) * resolution + cellCoords.x;
+
+    return skyCellToSolidAnglePdf(skyDistribution.cells[cell].pdf, st);
+}
+
+#endif
@@ -9,12 +9,17 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
     mat4 projectionMatrix;
     mat4 viewMatrix;
     mat4 inverseViewMatrix;
+    // projection * view of the previous frame, to reproject the path tracing history
+    mat4 previousProjectionViewMatrix;
     vec4 ambientLightColor;
     PointLight pointLights[MAX_LIGHTS];
     int numLights;
     uint frameCount;
     uint ptAccumulationCount;
     bool accumulationEnabled;
+    // adaptive sampling of the accumulation: a pixel stops when its relative error is under the threshold
+    float convergenceThreshold;
+    bool adaptiveSamplingEnabled;
 } ubo;
 
 #endif
\ No newline at end of file
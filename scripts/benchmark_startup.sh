@@ -0,0 +1,16 @@
+#!/bin/bash
+# Compares the startup with the synchronous and the asynchronous scene loading.
+# Run it from the scripts folder after building with start.sh, the engine quits once every
+# asset is loaded and logs the time to its first frame and to the last asset.
+#
+# usage: ./benchmark_startup.sh [runs] [engine binary, relative to the out folder]
+RUNS=${1:-3}
+BINARY=${2:-../out/build/gcc/bin/PXT_Engine}
+
+cd ../out
+
+for MODE in --sync-loading ""; do
+    for ((i = 0; i < RUNS; i++)); do
+        $BINARY --benchmark-startup $MODE | grep "Startup"
+    done
+done
@@ -0,0 +1,14 @@
+#!/bin/bash
+# Compares waiting for every upload with a single batched submission of the same uploads.
+# Run it from the scripts folder after building with start.sh, the engine quits once the
+# uploads are measured and logs the time and the throughput of both.
+#
+# usage: ./benchmark_uploads.sh [runs] [engine binary, relative to the out folder]
+RUNS=${1:-3}
+BINARY=${2:-../out/build/gcc/bin/PXT_Engine}
+
+cd ../out
+
+for ((i = 0; i < RUNS; i++)); do
+    $BINARY --benchmark-uploads | grep "Uploads"
+done